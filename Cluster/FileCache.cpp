@@ -0,0 +1,251 @@
+/***********************************************************************
+FileCache - Class for node-local caches of content-addressed file blocks
+to avoid re-sending unchanged file contents from the master node to the
+slave nodes of a cluster.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Cluster Abstraction Library (Cluster).
+
+The Cluster Abstraction Library is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Cluster Abstraction Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Cluster Abstraction Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Cluster/FileCache.h>
+
+#include <string.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <Misc/ThrowStdErr.h>
+
+namespace Cluster {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline Misc::UInt64 rotl64(Misc::UInt64 x,int r)
+	{
+	return (x<<r)|(x>>(64-r));
+	}
+
+inline Misc::UInt64 fmix64(Misc::UInt64 k) // Final avalanche mix of MurmurHash3
+	{
+	k^=k>>33;
+	k*=0xff51afd7ed558ccdULL;
+	k^=k>>33;
+	k*=0xc4ceb9fe1a85ec53ULL;
+	k^=k>>33;
+	return k;
+	}
+
+bool readAll(int fd,void* data,size_t dataSize) // Reads the given amount of data from a file; returns false on error or early end-of-file
+	{
+	char* dPtr=static_cast<char*>(data);
+	while(dataSize>0)
+		{
+		ssize_t readResult=::read(fd,dPtr,dataSize);
+		if(readResult>0)
+			{
+			dPtr+=readResult;
+			dataSize-=readResult;
+			}
+		else if(readResult==0||(errno!=EAGAIN&&errno!=EWOULDBLOCK&&errno!=EINTR))
+			return false;
+		}
+	return true;
+	}
+
+bool writeAll(int fd,const void* data,size_t dataSize) // Writes the given amount of data to a file; returns false on error
+	{
+	const char* dPtr=static_cast<const char*>(data);
+	while(dataSize>0)
+		{
+		ssize_t writeResult=::write(fd,dPtr,dataSize);
+		if(writeResult>0)
+			{
+			dPtr+=writeResult;
+			dataSize-=writeResult;
+			}
+		else if(writeResult==0||(errno!=EAGAIN&&errno!=EWOULDBLOCK&&errno!=EINTR))
+			return false;
+		}
+	return true;
+	}
+
+}
+
+/**************************
+Methods of class FileCache:
+**************************/
+
+std::string FileCache::getBlockFileName(const FileCache::BlockHash& hash) const
+	{
+	char hashString[33];
+	snprintf(hashString,sizeof(hashString),"%016llx%016llx",(unsigned long long)hash.h[0],(unsigned long long)hash.h[1]);
+	return cacheDirectory+hashString;
+	}
+
+FileCache::FileCache(const char* sCacheDirectory,size_t sBlockSize)
+	:cacheDirectory(sCacheDirectory),blockSize(sBlockSize)
+	{
+	/* Reset the usage statistics: */
+	memset(&statistics,0,sizeof(Statistics));
+	
+	/* Create the cache directory if it does not exist yet: */
+	if(mkdir(cacheDirectory.c_str(),S_IRWXU|S_IRGRP|S_IXGRP|S_IROTH|S_IXOTH)<0&&errno!=EEXIST)
+		{
+		int errorCode=errno;
+		Misc::throwStdErr("Cluster::FileCache: Unable to create cache directory %s due to error %d (%s)",cacheDirectory.c_str(),errorCode,strerror(errorCode));
+		}
+	
+	/* Add a trailing slash to the directory name: */
+	if(cacheDirectory.empty()||cacheDirectory[cacheDirectory.size()-1]!='/')
+		cacheDirectory.push_back('/');
+	}
+
+FileCache::BlockHash FileCache::hashBlock(const void* data,size_t dataSize)
+	{
+	/* Calculate the 128-bit x64 variant of MurmurHash3 with a zero seed: */
+	const Misc::UInt64 c1=0x87c37b91114253d5ULL;
+	const Misc::UInt64 c2=0x4cf5ad432745937fULL;
+	Misc::UInt64 h1=0;
+	Misc::UInt64 h2=0;
+	
+	/* Process the data in 16-byte chunks: */
+	const unsigned char* dPtr=static_cast<const unsigned char*>(data);
+	size_t numChunks=dataSize/16;
+	for(size_t i=0;i<numChunks;++i,dPtr+=16)
+		{
+		Misc::UInt64 k1,k2;
+		memcpy(&k1,dPtr,sizeof(Misc::UInt64));
+		memcpy(&k2,dPtr+8,sizeof(Misc::UInt64));
+		
+		k1*=c1;
+		k1=rotl64(k1,31);
+		k1*=c2;
+		h1^=k1;
+		h1=rotl64(h1,27);
+		h1+=h2;
+		h1=h1*5+0x52dce729;
+		
+		k2*=c2;
+		k2=rotl64(k2,33);
+		k2*=c1;
+		h2^=k2;
+		h2=rotl64(h2,31);
+		h2+=h1;
+		h2=h2*5+0x38495ab5;
+		}
+	
+	/* Process the remaining bytes: */
+	Misc::UInt64 k1=0;
+	Misc::UInt64 k2=0;
+	size_t tailSize=dataSize&15;
+	for(size_t i=tailSize;i>8;--i)
+		k2^=Misc::UInt64(dPtr[i-1])<<((i-9)*8);
+	if(tailSize>8)
+		{
+		k2*=c2;
+		k2=rotl64(k2,33);
+		k2*=c1;
+		h2^=k2;
+		}
+	for(size_t i=tailSize<8?tailSize:8;i>0;--i)
+		k1^=Misc::UInt64(dPtr[i-1])<<((i-1)*8);
+	if(tailSize>0)
+		{
+		k1*=c1;
+		k1=rotl64(k1,31);
+		k1*=c2;
+		h1^=k1;
+		}
+	
+	/* Finalize the hash: */
+	h1^=Misc::UInt64(dataSize);
+	h2^=Misc::UInt64(dataSize);
+	h1+=h2;
+	h2+=h1;
+	h1=fmix64(h1);
+	h2=fmix64(h2);
+	h1+=h2;
+	h2+=h1;
+	
+	BlockHash result;
+	result.h[0]=h1;
+	result.h[1]=h2;
+	return result;
+	}
+
+bool FileCache::loadBlock(const FileCache::BlockHash& hash,size_t dataSize,void* data) const
+	{
+	/* Open the block's cache file: */
+	int fd=open(getBlockFileName(hash).c_str(),O_RDONLY);
+	if(fd<0)
+		return false;
+	
+	/* Check the cache file's size and read its contents: */
+	struct stat statBuffer;
+	bool result=fstat(fd,&statBuffer)==0&&size_t(statBuffer.st_size)==dataSize&&readAll(fd,data,dataSize);
+	close(fd);
+	
+	/* Verify the block's contents to guard against corrupted cache files: */
+	return result&&hashBlock(data,dataSize)==hash;
+	}
+
+void FileCache::storeBlock(const FileCache::BlockHash& hash,size_t dataSize,const void* data) const
+	{
+	/* Write the block into a temporary file first so that concurrent readers never see partial blocks: */
+	std::string blockFileName=getBlockFileName(hash);
+	char suffix[32];
+	snprintf(suffix,sizeof(suffix),".tmp%d",int(getpid()));
+	std::string tempFileName=blockFileName+suffix;
+	int fd=open(tempFileName.c_str(),O_WRONLY|O_CREAT|O_TRUNC,S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+	if(fd<0)
+		return;
+	bool ok=writeAll(fd,data,dataSize);
+	ok=close(fd)==0&&ok;
+	
+	/* Atomically move the temporary file into place: */
+	if(!ok||rename(tempFileName.c_str(),blockFileName.c_str())<0)
+		unlink(tempFileName.c_str());
+	}
+
+void FileCache::countBlock(size_t dataSize,bool hit)
+	{
+	Threads::Spinlock::Lock statisticsLock(statisticsMutex);
+	++statistics.numBlocks;
+	if(hit)
+		++statistics.numHits;
+	statistics.numBytes+=dataSize;
+	}
+
+void FileCache::countSentBytes(size_t numBytes)
+	{
+	Threads::Spinlock::Lock statisticsLock(statisticsMutex);
+	statistics.numBytesSent+=numBytes;
+	}
+
+FileCache::Statistics FileCache::getStatistics(void) const
+	{
+	Threads::Spinlock::Lock statisticsLock(statisticsMutex);
+	return statistics;
+	}
+
+}
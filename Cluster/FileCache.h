@@ -0,0 +1,102 @@
+/***********************************************************************
+FileCache - Class for node-local caches of content-addressed file blocks
+to avoid re-sending unchanged file contents from the master node to the
+slave nodes of a cluster.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Cluster Abstraction Library (Cluster).
+
+The Cluster Abstraction Library is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Cluster Abstraction Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Cluster Abstraction Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef CLUSTER_FILECACHE_INCLUDED
+#define CLUSTER_FILECACHE_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <Misc/SizedTypes.h>
+#include <Threads/Spinlock.h>
+
+namespace Cluster {
+
+class FileCache
+	{
+	/* Embedded classes: */
+	public:
+	struct BlockHash // Structure for 128-bit content hashes of file blocks
+		{
+		/* Elements: */
+		public:
+		Misc::UInt64 h[2]; // The two halves of the hash value
+		
+		/* Methods: */
+		bool operator==(const BlockHash& other) const
+			{
+			return h[0]==other.h[0]&&h[1]==other.h[1];
+			}
+		bool operator!=(const BlockHash& other) const
+			{
+			return h[0]!=other.h[0]||h[1]!=other.h[1];
+			}
+		};
+	
+	struct Statistics // Structure to report cache usage
+		{
+		/* Elements: */
+		public:
+		Misc::UInt64 numBlocks; // Number of file blocks that were announced or looked up
+		Misc::UInt64 numHits; // Number of file blocks that did not have to be sent (master) or were found in the local cache (slave)
+		Misc::UInt64 numBytes; // Total number of bytes in all file blocks
+		Misc::UInt64 numBytesSent; // Number of file bytes that were sent (master) or received (slave) over the network
+		};
+	
+	/* Elements: */
+	private:
+	std::string cacheDirectory; // Name of the node-local directory holding cached blocks, with trailing slash
+	size_t blockSize; // Size of file blocks shared through the cache in bytes
+	mutable Threads::Spinlock statisticsMutex; // Mutex serializing access to the usage statistics
+	Statistics statistics; // Usage statistics since the cache was created
+	
+	/* Private methods: */
+	std::string getBlockFileName(const BlockHash& hash) const; // Returns the name of the cache file holding the block of the given hash
+	
+	/* Constructors and destructors: */
+	public:
+	FileCache(const char* sCacheDirectory,size_t sBlockSize); // Creates a file cache in the given directory, which is created if it does not exist
+	private:
+	FileCache(const FileCache& source); // Prohibit copy constructor
+	FileCache& operator=(const FileCache& source); // Prohibit assignment operator
+	
+	/* Methods: */
+	public:
+	const std::string& getCacheDirectory(void) const // Returns the cache directory
+		{
+		return cacheDirectory;
+		}
+	size_t getBlockSize(void) const // Returns the size of file blocks shared through the cache
+		{
+		return blockSize;
+		}
+	static BlockHash hashBlock(const void* data,size_t dataSize); // Returns the content hash of the given block of data
+	bool loadBlock(const BlockHash& hash,size_t dataSize,void* data) const; // Reads the block of the given hash and size from the cache; returns false if the block is not cached or fails verification
+	void storeBlock(const BlockHash& hash,size_t dataSize,const void* data) const; // Writes the given block into the cache; silently ignores errors
+	void countBlock(size_t dataSize,bool hit); // Updates the usage statistics for a file block
+	void countSentBytes(size_t numBytes); // Updates the usage statistics for file bytes sent or received over the network
+	Statistics getStatistics(void) const; // Returns the current usage statistics
+	};
+
+}
+
+#endif
@@ -49,7 +49,7 @@ Methods of class Opener:
 
 Opener::Opener(bool install)
 	:Comm::Opener(false),
-	 multiplexer(0)
+	 multiplexer(0),fileCache(0)
 	{
 	if(install)
 		{
@@ -110,12 +110,12 @@ IO::FilePtr Opener::openFile(const char* fileName,IO::File::AccessMode accessMod
 		else if(multiplexer->isMaster())
 			{
 			/* Open a master-side shared standard file: */
-			result=new StandardFileMaster(multiplexer,fileName,accessMode);
+			result=new StandardFileMaster(multiplexer,fileName,accessMode,fileCache);
 			}
 		else
 			{
 			/* Open a slave-side shared standard file: */
-			result=new StandardFileSlave(multiplexer,fileName,accessMode);
+			result=new StandardFileSlave(multiplexer,fileName,accessMode,fileCache);
 			}
 		
 		/* Check if the file name has the .gz extension: */
@@ -308,6 +308,12 @@ void Opener::setMultiplexer(Multiplexer* newMultiplexer)
 		}
 	}
 
+void Opener::setFileCache(FileCache* newFileCache)
+	{
+	/* Store the given file cache: */
+	fileCache=newFileCache;
+	}
+
 IO::FilePtr Opener::openFile(Multiplexer* multiplexer,const char* fileName,IO::File::AccessMode accessMode)
 	{
 	IO::FilePtr result;
@@ -29,6 +29,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 /* Forward declarations: */
 namespace Cluster {
 class Multiplexer;
+class FileCache;
 }
 
 namespace Cluster {
@@ -39,6 +40,7 @@ class Opener:public Comm::Opener
 	private:
 	static Opener theOpener; // Static opener object created and activated when the Cluster library is loaded
 	Multiplexer* multiplexer; // Pointer to a multiplexer connecting a cluster
+	FileCache* fileCache; // Pointer to a node-local cache for blocks of shared read-only files, or null
 	IO::DirectoryPtr previousCurrentDirectory; // Pointer to previous current directory when a multiplexer is set
 	
 	/* Constructors and destructors: */
@@ -67,6 +69,11 @@ class Opener:public Comm::Opener
 		return result;
 		}
 	void setMultiplexer(Multiplexer* newMultiplexer); // Sets the cluster multiplexer to be used to forward files
+	FileCache* getFileCache(void) const // Returns the node-local file cache
+		{
+		return fileCache;
+		}
+	void setFileCache(FileCache* newFileCache); // Sets the node-local cache used to share read-only files; does not take ownership
 	static IO::FilePtr openFile(Multiplexer* multiplexer,const char* fileName,IO::File::AccessMode accessMode); // Method to open a file shared via the given cluster multiplexer
 	};
 
@@ -31,9 +31,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/ThrowStdErr.h>
 #include <Cluster/Packet.h>
 #include <Cluster/Multiplexer.h>
+#include <Cluster/FileCache.h>
 
 #ifdef __APPLE__
 #define lseek64 lseek
+#define pread64 pread
 #endif
 
 namespace Cluster {
@@ -58,6 +60,10 @@ Methods of class StandardFileMaster:
 
 size_t StandardFileMaster::readData(IO::File::Byte* buffer,size_t bufferSize)
 	{
+	/* Read through the cache block if the file is shared through the file cache: */
+	if(block!=0&&isReadCoupled())
+		return readDataCached(buffer,bufferSize);
+	
 	/* Collect error codes: */
 	int errorType=0;
 	int errorCode=0;
@@ -325,11 +331,17 @@ void StandardFileMaster::openFile(const char* fileName,IO::File::AccessMode acce
 	fd=open(fileName,flags,mode);
 	int errorCode=fd<0?errno:0;
 	
+	/* Share read-only files through the file cache if there is one: */
+	if(errorCode!=0||accessMode!=ReadOnly)
+		fileCache=0;
+	size_t cacheBlockSize=fileCache!=0?fileCache->getBlockSize():0;
+	
 	/* Send a status message to the slaves: */
 	Packet* statusPacket=multiplexer->newPacket();
 	{
 	Packet::Writer writer(statusPacket);
 	writer.write<int>(errorCode);
+	writer.write<Misc::UInt32>(Misc::UInt32(cacheBlockSize));
 	}
 	multiplexer->sendPacket(pipeId,statusPacket);
 	
@@ -344,12 +356,103 @@ void StandardFileMaster::openFile(const char* fileName,IO::File::AccessMode acce
 	canReadThrough=false;
 	if(accessMode==ReadOnly||accessMode==ReadWrite)
 		IO::SeekableFile::resizeReadBuffer(Packet::maxPacketSize);
+	
+	/* Allocate the cache block buffer: */
+	if(fileCache!=0)
+		block=new Byte[cacheBlockSize];
+	}
+
+size_t StandardFileMaster::readDataCached(IO::File::Byte* buffer,size_t bufferSize)
+	{
+	/* Check if the read position is outside the current cache block: */
+	if(readPos<blockStart||readPos>=blockStart+Offset(blockDataSize))
+		{
+		/* Read the entire cache block containing the read position: */
+		size_t cacheBlockSize=fileCache->getBlockSize();
+		blockStart=readPos-readPos%Offset(cacheBlockSize);
+		blockDataSize=0;
+		int errorType=0;
+		int errorCode=0;
+		while(blockDataSize<cacheBlockSize)
+			{
+			ssize_t readResult=pread64(fd,block+blockDataSize,cacheBlockSize-blockDataSize,blockStart+Offset(blockDataSize));
+			if(readResult>0)
+				blockDataSize+=size_t(readResult);
+			else if(readResult==0)
+				break;
+			else if(errno!=EAGAIN&&errno!=EWOULDBLOCK&&errno!=EINTR)
+				{
+				errorType=3; // Fatal error
+				errorCode=errno;
+				break;
+				}
+			}
+		if(errorType==0&&readPos>=blockStart+Offset(blockDataSize))
+			errorType=2; // End of file
+		
+		/* Calculate the block's content hash: */
+		FileCache::BlockHash hash;
+		hash.h[0]=hash.h[1]=0;
+		if(errorType==0)
+			hash=FileCache::hashBlock(block,blockDataSize);
+		else
+			blockDataSize=0;
+		
+		/* Announce the new cache block to the slaves: */
+		Packet* packet=multiplexer->newPacket();
+		{
+		Packet::Writer writer(packet);
+		writer.write<int>(errorType);
+		writer.write<int>(errorCode);
+		writer.write<Offset>(blockStart);
+		writer.write<Misc::UInt32>(Misc::UInt32(blockDataSize));
+		writer.write<Misc::UInt64>(hash.h[0]);
+		writer.write<Misc::UInt64>(hash.h[1]);
+		}
+		multiplexer->sendPacket(pipeId,packet);
+		
+		/* Handle errors: */
+		if(errorType==3)
+			{
+			char buffer[512];
+			throw Error(Misc::printStdErrMsgReentrant(buffer,sizeof(buffer),fileReadErrorString,errorCode,strerror(errorCode)));
+			}
+		else if(errorType==2)
+			return 0;
+		
+		/* Check whether all slaves can serve the block from their local caches: */
+		blockShared=gather(1U,GatherOperation::AND)!=0U;
+		fileCache->countBlock(blockDataSize,blockShared);
+		}
+	
+	/* Copy data from the cache block: */
+	size_t blockOffset=size_t(readPos-blockStart);
+	size_t readSize=blockDataSize-blockOffset;
+	if(readSize>bufferSize)
+		readSize=bufferSize;
+	memcpy(buffer,block+blockOffset,readSize);
+	
+	if(!blockShared)
+		{
+		/* Forward the data to the slaves: */
+		Packet* packet=multiplexer->newPacket();
+		packet->packetSize=readSize;
+		memcpy(packet->packet,buffer,readSize);
+		multiplexer->sendPacket(pipeId,packet);
+		fileCache->countSentBytes(readSize);
+		}
+	
+	/* Advance the read pointer: */
+	readPos+=readSize;
+	
+	return readSize;
 	}
 
-StandardFileMaster::StandardFileMaster(Multiplexer* sMultiplexer,const char* fileName,IO::File::AccessMode accessMode)
+StandardFileMaster::StandardFileMaster(Multiplexer* sMultiplexer,const char* fileName,IO::File::AccessMode accessMode,FileCache* sFileCache)
 	:IO::SeekableFile(disableRead(accessMode)),ClusterPipe(sMultiplexer),
 	 fd(-1),
-	 filePos(0)
+	 filePos(0),
+	 fileCache(sFileCache),block(0),blockStart(0),blockDataSize(0),blockShared(false)
 	{
 	/* Create flags and mode to open the file: */
 	int flags=O_CREAT;
@@ -364,7 +467,8 @@ StandardFileMaster::StandardFileMaster(Multiplexer* sMultiplexer,const char* fil
 StandardFileMaster::StandardFileMaster(Multiplexer* sMultiplexer,const char* fileName,IO::File::AccessMode accessMode,int flags,int mode)
 	:SeekableFile(disableRead(accessMode)),ClusterPipe(sMultiplexer),
 	 fd(-1),
-	 filePos(0)
+	 filePos(0),
+	 fileCache(0),block(0),blockStart(0),blockDataSize(0),blockShared(false)
 	{
 	/* Open the file: */
 	openFile(fileName,accessMode,flags,mode);
@@ -376,6 +480,7 @@ StandardFileMaster::~StandardFileMaster(void)
 	flush();
 	if(fd>=0)
 		close(fd);
+	delete[] block;
 	}
 
 int StandardFileMaster::getFd(void) const
@@ -423,14 +528,113 @@ IO::SeekableFile::Offset StandardFileMaster::getSize(void) const
 	return fileSize;
 	}
 
+void StandardFileMaster::couple(bool newReadCoupled,bool newWriteCoupled)
+	{
+	ClusterPipe::couple(newReadCoupled,newWriteCoupled);
+	
+	/* Invalidate the current cache block, which the slaves might not have seen: */
+	blockDataSize=0;
+	}
+
 /**********************************
 Methods of class StandardFileSlave:
 **********************************/
 
+size_t StandardFileSlave::readDataCached(void)
+	{
+	/* Check if the read position is outside the current cache block: */
+	if(readPos<blockStart||readPos>=blockStart+Offset(blockDataSize))
+		{
+		/* Receive the new cache block's announcement from the master: */
+		Packet* packet=multiplexer->receivePacket(pipeId);
+		Packet::Reader reader(packet);
+		int errorType=reader.read<int>();
+		int errorCode=reader.read<int>();
+		Offset newBlockStart=reader.read<Offset>();
+		size_t newBlockDataSize=reader.read<Misc::UInt32>();
+		FileCache::BlockHash hash;
+		hash.h[0]=reader.read<Misc::UInt64>();
+		hash.h[1]=reader.read<Misc::UInt64>();
+		multiplexer->deletePacket(packet);
+		
+		/* Handle errors: */
+		blockDataSize=0;
+		if(errorType==3)
+			{
+			char buffer[512];
+			throw Error(Misc::printStdErrMsgReentrant(buffer,sizeof(buffer),fileReadErrorString,errorCode,strerror(errorCode)));
+			}
+		else if(errorType==2)
+			return 0;
+		
+		/* Try loading the block from the local cache: */
+		blockStart=newBlockStart;
+		blockDataSize=newBlockDataSize;
+		blockHash[0]=hash.h[0];
+		blockHash[1]=hash.h[1];
+		blockCached=fileCache!=0&&fileCache->loadBlock(hash,blockDataSize,block);
+		blockFill=0;
+		if(fileCache!=0)
+			fileCache->countBlock(blockDataSize,blockCached);
+		
+		/* Check whether all slaves can serve the block from their local caches: */
+		blockShared=gather(blockCached?1U:0U,GatherOperation::AND)!=0U;
+		}
+	
+	size_t blockOffset=size_t(readPos-blockStart);
+	size_t readSize;
+	if(blockShared)
+		{
+		/* Serve the data from the cache block: */
+		readSize=blockDataSize-blockOffset;
+		if(readSize>Packet::maxPacketSize)
+			readSize=Packet::maxPacketSize;
+		}
+	else
+		{
+		/* Receive a data packet from the master: */
+		Packet* packet=multiplexer->receivePacket(pipeId);
+		readSize=packet->packetSize;
+		if(!blockCached)
+			{
+			/* Copy the data into the cache block: */
+			memcpy(block+blockOffset,packet->packet,readSize);
+			
+			/* Store the block in the local cache once it has been received completely: */
+			if(blockOffset==blockFill)
+				{
+				blockFill+=readSize;
+				if(blockFill==blockDataSize&&fileCache!=0)
+					{
+					FileCache::BlockHash hash;
+					hash.h[0]=blockHash[0];
+					hash.h[1]=blockHash[1];
+					fileCache->storeBlock(hash,blockDataSize,block);
+					}
+				}
+			}
+		multiplexer->deletePacket(packet);
+		if(fileCache!=0)
+			fileCache->countSentBytes(readSize);
+		}
+	
+	/* Install the read data as the file's read buffer: */
+	setReadBuffer(readSize,block+blockOffset,false);
+	
+	/* Advance the read pointer: */
+	readPos+=readSize;
+	
+	return readSize;
+	}
+
 size_t StandardFileSlave::readData(IO::File::Byte* buffer,size_t bufferSize)
 	{
 	if(isReadCoupled())
 		{
+		/* Read through the cache block if the master shares the file through the file cache: */
+		if(block!=0)
+			return readDataCached();
+		
 		/* Receive a data packet from the master: */
 		Packet* newPacket=multiplexer->receivePacket(pipeId);
 		
@@ -550,14 +754,17 @@ size_t StandardFileSlave::writeDataUpTo(const IO::File::Byte* buffer,size_t buff
 		return 0;
 	}
 
-StandardFileSlave::StandardFileSlave(Multiplexer* sMultiplexer,const char* fileName,IO::File::AccessMode accessMode)
+StandardFileSlave::StandardFileSlave(Multiplexer* sMultiplexer,const char* fileName,IO::File::AccessMode accessMode,FileCache* sFileCache)
 	:IO::SeekableFile(disableRead(accessMode)),ClusterPipe(sMultiplexer),
-	 packet(0)
+	 packet(0),
+	 fileCache(sFileCache),cacheBlockSize(0),block(0),blockStart(0),blockDataSize(0),
+	 blockCached(false),blockShared(false),blockFill(0)
 	{
 	/* Read the status packet from the master node: */
 	Packet* statusPacket=multiplexer->receivePacket(pipeId);
 	Packet::Reader reader(statusPacket);
 	int errorCode=reader.read<int>();
+	cacheBlockSize=reader.read<Misc::UInt32>();
 	multiplexer->deletePacket(statusPacket);
 	
 	/* Check for errors: */
@@ -568,6 +775,13 @@ StandardFileSlave::StandardFileSlave(Multiplexer* sMultiplexer,const char* fileN
 		}
 	
 	canReadThrough=false;
+	
+	if(cacheBlockSize!=0)
+		{
+		/* Replace the default read buffer with the cache block buffer: */
+		block=new Byte[cacheBlockSize];
+		setReadBuffer(0,0,true);
+		}
 	}
 
 StandardFileSlave::~StandardFileSlave(void)
@@ -578,6 +792,13 @@ StandardFileSlave::~StandardFileSlave(void)
 		multiplexer->deletePacket(packet);
 		setReadBuffer(0,0,false);
 		}
+	
+	/* Delete the cache block buffer: */
+	if(block!=0)
+		{
+		setReadBuffer(0,0,false);
+		delete[] block;
+		}
 	}
 
 int StandardFileSlave::getFd(void) const
@@ -629,4 +850,12 @@ IO::SeekableFile::Offset StandardFileSlave::getSize(void) const
 		}
 	}
 
+void StandardFileSlave::couple(bool newReadCoupled,bool newWriteCoupled)
+	{
+	ClusterPipe::couple(newReadCoupled,newWriteCoupled);
+	
+	/* Invalidate the current cache block to stay in sync with the master: */
+	blockDataSize=0;
+	}
+
 }
@@ -23,12 +23,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef CLUSTER_STANDARDFILE_INCLUDED
 #define CLUSTER_STANDARDFILE_INCLUDED
 
+#include <Misc/SizedTypes.h>
 #include <IO/SeekableFile.h>
 #include <Cluster/ClusterPipe.h>
 
 /* Forward declarations: */
 namespace Cluster {
 class Packet;
+class FileCache;
 }
 
 namespace Cluster {
@@ -39,6 +41,11 @@ class StandardFileMaster:public IO::SeekableFile,public ClusterPipe // Class to
 	private:
 	int fd; // File descriptor of the underlying file
 	Offset filePos; // Current position of the underlying file's read/write pointer
+	FileCache* fileCache; // Pointer to the node-local file cache, or null if file blocks are not shared through the cache
+	Byte* block; // Buffer holding the current cache block
+	Offset blockStart; // File position of the beginning of the current cache block
+	size_t blockDataSize; // Amount of file data in the current cache block; zero if there is no current block
+	bool blockShared; // Flag if all slaves have the current cache block in their local caches
 	
 	/* Protected methods from IO::File: */
 	protected:
@@ -48,10 +55,11 @@ class StandardFileMaster:public IO::SeekableFile,public ClusterPipe // Class to
 	
 	/* Private methods: */
 	void openFile(const char* fileName,AccessMode accessMode,int flags,int mode); // Opens a file and handles errors
+	size_t readDataCached(Byte* buffer,size_t bufferSize); // Reads data through the current cache block, announcing a new block to the slaves if necessary
 	
 	/* Constructors and destructors: */
 	public:
-	StandardFileMaster(Multiplexer* sMultiplexer,const char* fileName,AccessMode accessMode =ReadOnly); // Opens a standard file with "DontCare" endianness setting and default flags and permissions
+	StandardFileMaster(Multiplexer* sMultiplexer,const char* fileName,AccessMode accessMode =ReadOnly,FileCache* sFileCache =0); // Opens a standard file with "DontCare" endianness setting and default flags and permissions; shares read-only files through the given file cache if not null
 	StandardFileMaster(Multiplexer* sMultiplexer,const char* fileName,AccessMode accessMode,int flags,int mode =0); // Opens a standard file with "DontCare" endianness setting
 	virtual ~StandardFileMaster(void);
 	
@@ -61,6 +69,9 @@ class StandardFileMaster:public IO::SeekableFile,public ClusterPipe // Class to
 	
 	/* Methods from IO::SeekableFile: */
 	virtual Offset getSize(void) const;
+	
+	/* Methods from ClusterPipe: */
+	virtual void couple(bool newReadCoupled,bool newWriteCoupled);
 	};
 
 class StandardFileSlave:public IO::SeekableFile,public ClusterPipe // Class to represent cluster-transparent standard files on the slave nodes
@@ -68,6 +79,15 @@ class StandardFileSlave:public IO::SeekableFile,public ClusterPipe // Class to r
 	/* Elements: */
 	private:
 	Packet* packet; // Pointer to most recently received multicast packet; doubles as file's read buffer
+	FileCache* fileCache; // Pointer to the node-local file cache, or null if this node has none
+	size_t cacheBlockSize; // Size of cache blocks announced by the master, or zero if file blocks are not shared through the cache
+	Byte* block; // Buffer holding the current cache block; doubles as file's read buffer while blocks are shared
+	Offset blockStart; // File position of the beginning of the current cache block
+	size_t blockDataSize; // Amount of file data in the current cache block; zero if there is no current block
+	Misc::UInt64 blockHash[2]; // Content hash of the current cache block
+	bool blockCached; // Flag if the current cache block was loaded from the local cache
+	bool blockShared; // Flag if all slaves have the current cache block in their local caches
+	size_t blockFill; // Amount of contiguous data received from the master from the beginning of the current cache block
 	
 	/* Protected methods from IO::File: */
 	protected:
@@ -75,9 +95,12 @@ class StandardFileSlave:public IO::SeekableFile,public ClusterPipe // Class to r
 	virtual void writeData(const Byte* buffer,size_t bufferSize);
 	virtual size_t writeDataUpTo(const Byte* buffer,size_t bufferSize);
 	
+	/* Private methods: */
+	size_t readDataCached(void); // Reads data through the current cache block, receiving a new block announcement from the master if necessary
+	
 	/* Constructors and destructors: */
 	public:
-	StandardFileSlave(Multiplexer* sMultiplexer,const char* fileName,AccessMode accessMode =ReadOnly); // Opens a standard file with "DontCare" endianness setting
+	StandardFileSlave(Multiplexer* sMultiplexer,const char* fileName,AccessMode accessMode =ReadOnly,FileCache* sFileCache =0); // Opens a standard file with "DontCare" endianness setting; uses the given file cache if the master shares the file's blocks
 	virtual ~StandardFileSlave(void);
 	
 	/* Methods from IO::File: */
@@ -87,6 +110,9 @@ class StandardFileSlave:public IO::SeekableFile,public ClusterPipe // Class to r
 	
 	/* Methods from IO::SeekableFile: */
 	virtual Offset getSize(void) const;
+	
+	/* Methods from ClusterPipe: */
+	virtual void couple(bool newReadCoupled,bool newWriteCoupled);
 	};
 
 }
@@ -25,11 +25,13 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
+#include <unistd.h>
 #include <string>
 #include <iostream>
 #include <algorithm>
 #include <Misc/ThrowStdErr.h>
 #include <Misc/FileNameExtensions.h>
+#include <Threads/TaskScheduler.h>
 #include <IO/ValueSource.h>
 #include <Math/Math.h>
 #include <Math/Constants.h>
@@ -123,6 +125,246 @@ inline double parseDateTime(const char* date,const char* time)
 	return double(mktime(&dateTime));
 	}
 
+/***************************************************************
+Helper classes and functions to update back-to-front orderings:
+***************************************************************/
+
+typedef EarthquakeSet::Point Point;
+typedef EarthquakeSet::Event Event;
+
+const int numTaskLevels=5; // Number of kd-tree levels traversed serially before the remaining subtrees are updated as independent tasks
+const size_t parallelSortThreshold=262144; // Minimum number of events to update orderings in multiple threads
+const size_t changedRangeGap=1024; // Maximum gap between changed ranges of an ordering that are merged to upload them together
+
+struct ChangedRange // Structure for a range of changed ordering entries
+	{
+	/* Elements: */
+	public:
+	size_t begin,end; // Half-open range of changed entries
+	
+	/* Constructors and destructors: */
+	ChangedRange(size_t sBegin,size_t sEnd)
+		:begin(sBegin),end(sEnd)
+		{
+		}
+	
+	/* Methods: */
+	friend bool operator<(const ChangedRange& cr1,const ChangedRange& cr2)
+		{
+		return cr1.begin<cr2.begin;
+		}
+	};
+
+void addChangedRange(std::vector<ChangedRange>& changedRanges,size_t begin,size_t end) // Adds a changed range that starts behind all previously added ranges
+	{
+	if(!changedRanges.empty()&&changedRanges.back().end+changedRangeGap>=begin)
+		{
+		/* Extend the last range: */
+		if(changedRanges.back().end<end)
+			changedRanges.back().end=end;
+		}
+	else
+		changedRanges.push_back(ChangedRange(begin,end));
+	}
+
+void writeBackToFront(const Event* nodes,int left,int right,int splitDimension,const Point& eyePos,GLuint*& bufferPtr) // Writes the indices of the given kd-tree subtree in back-to-front order
+	{
+	/* Get the current node index: */
+	int mid=(left+right)>>1;
+	
+	int childSplitDimension=splitDimension+1;
+	if(childSplitDimension==3)
+		childSplitDimension=0;
+	
+	/* Traverse into the subtree on the far side of the split plane first: */
+	if(eyePos[splitDimension]>nodes[mid][splitDimension])
+		{
+		if(left<mid)
+			writeBackToFront(nodes,left,mid-1,childSplitDimension,eyePos,bufferPtr);
+		*bufferPtr=GLuint(mid);
+		++bufferPtr;
+		if(right>mid)
+			writeBackToFront(nodes,mid+1,right,childSplitDimension,eyePos,bufferPtr);
+		}
+	else
+		{
+		if(right>mid)
+			writeBackToFront(nodes,mid+1,right,childSplitDimension,eyePos,bufferPtr);
+		*bufferPtr=GLuint(mid);
+		++bufferPtr;
+		if(left<mid)
+			writeBackToFront(nodes,left,mid-1,childSplitDimension,eyePos,bufferPtr);
+		}
+	}
+
+void updateBackToFront(const Event* nodes,int left,int right,int splitDimension,const Point& cellMin,const Point& cellMax,const Point& oldEyePos,const Point& newEyePos,GLuint* order,size_t offset,std::vector<ChangedRange>& changedRanges) // Updates the back-to-front order of the given kd-tree subtree, whose points are inside the given cell and whose indices start at the given offset, from the old to the new eye position
+	{
+	/* Bail out if the split planes of the subtree's nodes cannot lie between the old and new eye positions: */
+	bool mayCross=false;
+	for(int i=0;i<3&&!mayCross;++i)
+		{
+		float min=Math::min(oldEyePos[i],newEyePos[i]);
+		float max=Math::max(oldEyePos[i],newEyePos[i]);
+		mayCross=min<max&&cellMin[i]<=max&&cellMax[i]>=min;
+		}
+	if(!mayCross)
+		return;
+	
+	/* Get the current node index: */
+	int mid=(left+right)>>1;
+	float split=nodes[mid][splitDimension];
+	bool goLeftFirst=newEyePos[splitDimension]>split;
+	if((oldEyePos[splitDimension]>split)!=goLeftFirst)
+		{
+		/* The eye crossed the node's split plane; rewrite the entire subtree: */
+		GLuint* bufferPtr=order+offset;
+		writeBackToFront(nodes,left,right,splitDimension,newEyePos,bufferPtr);
+		addChangedRange(changedRanges,offset,offset+size_t(right-left+1));
+		return;
+		}
+	
+	int childSplitDimension=splitDimension+1;
+	if(childSplitDimension==3)
+		childSplitDimension=0;
+	
+	/* Calculate the children's cells: */
+	Point leftCellMax=cellMax;
+	leftCellMax[splitDimension]=split;
+	Point rightCellMin=cellMin;
+	rightCellMin[splitDimension]=split;
+	
+	/* Update the children in their unchanged positions, in order of increasing offset: */
+	if(goLeftFirst)
+		{
+		if(left<mid)
+			updateBackToFront(nodes,left,mid-1,childSplitDimension,cellMin,leftCellMax,oldEyePos,newEyePos,order,offset,changedRanges);
+		if(right>mid)
+			updateBackToFront(nodes,mid+1,right,childSplitDimension,rightCellMin,cellMax,oldEyePos,newEyePos,order,offset+size_t(mid-left+1),changedRanges);
+		}
+	else
+		{
+		if(right>mid)
+			updateBackToFront(nodes,mid+1,right,childSplitDimension,rightCellMin,cellMax,oldEyePos,newEyePos,order,offset,changedRanges);
+		if(left<mid)
+			updateBackToFront(nodes,left,mid-1,childSplitDimension,cellMin,leftCellMax,oldEyePos,newEyePos,order,offset+size_t(right-mid+1),changedRanges);
+		}
+	}
+
+struct OrderTask // Structure describing a kd-tree subtree whose back-to-front order is updated independently
+	{
+	/* Elements: */
+	public:
+	int left,right; // Index range of the subtree
+	int splitDimension; // Split dimension of the subtree's root
+	Point cellMin,cellMax; // Cell containing the subtree's points
+	size_t offset; // Index of the subtree's first entry in the ordering
+	bool rewrite; // Flag whether the subtree's entries need to be rewritten entirely
+	};
+
+void collectOrderTasks(const Event* nodes,int left,int right,int splitDimension,const Point& cellMin,const Point& cellMax,const Point& oldEyePos,const Point& newEyePos,bool rewrite,int numLevels,GLuint* order,size_t offset,std::vector<OrderTask>& tasks,std::vector<ChangedRange>& changedRanges) // Updates the top levels of the given kd-tree subtree and collects tasks to update the remaining subtrees
+	{
+	if(numLevels==0||right-left<64)
+		{
+		/* Create a task for the subtree: */
+		OrderTask task;
+		task.left=left;
+		task.right=right;
+		task.splitDimension=splitDimension;
+		task.cellMin=cellMin;
+		task.cellMax=cellMax;
+		task.offset=offset;
+		task.rewrite=rewrite;
+		tasks.push_back(task);
+		return;
+		}
+	
+	/* Get the current node index and check whether the eye crossed its split plane: */
+	int mid=(left+right)>>1;
+	float split=nodes[mid][splitDimension];
+	bool goLeftFirst=newEyePos[splitDimension]>split;
+	if((oldEyePos[splitDimension]>split)!=goLeftFirst)
+		rewrite=true;
+	
+	int childSplitDimension=splitDimension+1;
+	if(childSplitDimension==3)
+		childSplitDimension=0;
+	
+	/* Calculate the children's cells and offsets: */
+	Point leftCellMax=cellMax;
+	leftCellMax[splitDimension]=split;
+	Point rightCellMin=cellMin;
+	rightCellMin[splitDimension]=split;
+	size_t leftOffset=goLeftFirst?offset:offset+size_t(right-mid+1);
+	size_t rightOffset=goLeftFirst?offset+size_t(mid-left+1):offset;
+	
+	/* Write the node itself if its position changed: */
+	if(rewrite)
+		{
+		size_t midOffset=goLeftFirst?offset+size_t(mid-left):offset+size_t(right-mid);
+		order[midOffset]=GLuint(mid);
+		changedRanges.push_back(ChangedRange(midOffset,midOffset+1));
+		}
+	
+	/* Recurse into the children: */
+	if(left<mid)
+		collectOrderTasks(nodes,left,mid-1,childSplitDimension,cellMin,leftCellMax,oldEyePos,newEyePos,rewrite,numLevels-1,order,leftOffset,tasks,changedRanges);
+	if(right>mid)
+		collectOrderTasks(nodes,mid+1,right,childSplitDimension,rightCellMin,cellMax,oldEyePos,newEyePos,rewrite,numLevels-1,order,rightOffset,tasks,changedRanges);
+	}
+
+struct OrderJob // Structure describing the set of order tasks processed by one thread
+	{
+	/* Elements: */
+	public:
+	const Event* nodes; // The kd-tree's nodes
+	const Point* oldEyePos; // The eye position for which the ordering was sorted
+	const Point* newEyePos; // The new eye position
+	GLuint* order; // The updated ordering
+	const std::vector<OrderTask>* tasks; // The list of all tasks
+	size_t firstTask,taskStride; // Index of the first task processed by this job, and stride to the next task
+	std::vector<ChangedRange> changedRanges; // Ranges of ordering entries changed by this job, in increasing order
+	};
+
+void processOrderJob(OrderJob* job) // Processes a set of order tasks
+	{
+	for(size_t taskIndex=job->firstTask;taskIndex<job->tasks->size();taskIndex+=job->taskStride)
+		{
+		const OrderTask& task=(*job->tasks)[taskIndex];
+		if(task.rewrite)
+			{
+			/* Rewrite the task's subtree: */
+			GLuint* bufferPtr=job->order+task.offset;
+			writeBackToFront(job->nodes,task.left,task.right,task.splitDimension,*job->newEyePos,bufferPtr);
+			addChangedRange(job->changedRanges,task.offset,task.offset+size_t(task.right-task.left+1));
+			}
+		else
+			{
+			/* Update the task's subtree incrementally: */
+			updateBackToFront(job->nodes,task.left,task.right,task.splitDimension,task.cellMin,task.cellMax,*job->oldEyePos,*job->newEyePos,job->order,task.offset,job->changedRanges);
+			}
+		}
+	}
+
+class OrderJobFunctor // Functor class to process a range of order jobs in a task scheduler's parallel loop
+	{
+	/* Elements: */
+	private:
+	std::vector<OrderJob>& jobs; // The list of all order jobs
+	
+	/* Constructors and destructors: */
+	public:
+	OrderJobFunctor(std::vector<OrderJob>& sJobs)
+		:jobs(sJobs)
+		{
+		}
+	
+	/* Methods: */
+	void operator()(size_t jobBegin,size_t jobEnd)
+		{
+		for(size_t jobIndex=jobBegin;jobIndex<jobEnd;++jobIndex)
+			processOrderJob(&jobs[jobIndex]);
+		}
+	};
 }
 
 /****************************************
@@ -136,7 +378,8 @@ EarthquakeSet::DataItem::DataItem(void)
 	 currentTimeLocation(-1),pointTextureLocation(-1),
 	 pointTextureObjectId(0),
 	 eyePos(Point::origin),
-	 sortedPointIndicesBufferObjectId(0)
+	 sortedPointIndicesBufferObjectId(0),
+	 sortCounter(0)
 	{
 	/* Check if the vertex buffer object extension is supported: */
 	if(GLARBVertexBufferObject::isSupported())
@@ -161,8 +404,10 @@ EarthquakeSet::DataItem::DataItem(void)
 			/* Create the point texture object: */
 			glGenTextures(1,&pointTextureObjectId);
 
-			/* Create the sorted point index buffer: */
+			/* Create the sorted point index buffers: */
 			glGenBuffersARB(1,&sortedPointIndicesBufferObjectId);
+			for(int i=0;i<2;++i)
+				glGenBuffersARB(1,&sortStates[i].indexBufferObjectId);
 			}
 		}
 	}
@@ -184,8 +429,10 @@ EarthquakeSet::DataItem::~DataItem(void)
 			/* Delete the point texture object: */
 			glDeleteTextures(1,&pointTextureObjectId);
 			
-			/* Delete the sorted point index buffer: */
+			/* Delete the sorted point index buffers: */
 			glDeleteBuffersARB(1,&sortedPointIndicesBufferObjectId);
+			for(int i=0;i<2;++i)
+				glDeleteBuffersARB(1,&sortStates[i].indexBufferObjectId);
 			}
 		}
 	}
@@ -600,6 +847,164 @@ void EarthquakeSet::drawBackToFront(int left,int right,int splitDimension,const
 
 #endif
 
+void EarthquakeSet::createSortScheduler(void)
+	{
+	/* Shut down the current worker threads: */
+	delete sortScheduler;
+	sortScheduler=0;
+	
+	/* Update small event sets serially, as waking up worker threads would cost more than it saves: */
+	if(size_t(events.getNumNodes())<parallelSortThreshold)
+		return;
+	
+	/* Determine the number of threads: */
+	unsigned int numThreads=numSortThreads;
+	if(numThreads==0)
+		{
+		long numCpus=sysconf(_SC_NPROCESSORS_ONLN);
+		numThreads=numCpus>0?(unsigned int)(numCpus):1U;
+		}
+	
+	/* Create worker threads for all but the thread updating an ordering, which helps while waiting: */
+	if(numThreads>1)
+		sortScheduler=new Threads::TaskScheduler(numThreads-1);
+	}
+
+void EarthquakeSet::updateSortState(EarthquakeSet::SortState& state,const EarthquakeSet::Point& eyePos) const
+	{
+	size_t numEvents=events.getNumNodes();
+	const Event* nodes=events.accessPoints();
+	
+	/* Bail out if there are no events to order: */
+	if(numEvents==0)
+		{
+		state.order.clear();
+		state.valid=true;
+		state.eyePos=eyePos;
+		state.indexBufferValid=true;
+		return;
+		}
+	
+	/* Check if the ordering needs to be rewritten entirely: */
+	bool rewrite=!state.valid||!state.indexBufferValid;
+	if(state.order.size()!=numEvents)
+		{
+		state.order.resize(numEvents);
+		rewrite=true;
+		}
+	
+	/* Update the top levels of the kd-tree and collect tasks to update the remaining subtrees: */
+	Point cellMin,cellMax;
+	for(int i=0;i<3;++i)
+		{
+		cellMin[i]=-Math::Constants<float>::max;
+		cellMax[i]=Math::Constants<float>::max;
+		}
+	std::vector<OrderTask> tasks;
+	std::vector<ChangedRange> changedRanges;
+	collectOrderTasks(nodes,0,int(numEvents)-1,0,cellMin,cellMax,state.eyePos,eyePos,rewrite,numTaskLevels,&state.order[0],0,tasks,changedRanges);
+	
+	/* Determine the number of jobs; the calling thread helps the sort scheduler's worker threads: */
+	unsigned int numThreads=1;
+	if(sortScheduler!=0)
+		{
+		numThreads=sortScheduler->getNumWorkers()+1;
+		if(numThreads>tasks.size())
+			numThreads=(unsigned int)(tasks.size());
+		}
+	
+	/* Process all tasks, serially or in the sort scheduler's worker threads: */
+	std::vector<OrderJob> jobs(numThreads);
+	for(unsigned int i=0;i<numThreads;++i)
+		{
+		OrderJob& job=jobs[i];
+		job.nodes=nodes;
+		job.oldEyePos=&state.eyePos;
+		job.newEyePos=&eyePos;
+		job.order=&state.order[0];
+		job.tasks=&tasks;
+		job.firstTask=i;
+		job.taskStride=numThreads;
+		}
+	if(numThreads>1)
+		{
+		OrderJobFunctor functor(jobs);
+		sortScheduler->parallelFor(size_t(0),size_t(numThreads),size_t(1),functor);
+		}
+	else if(numThreads==1)
+		processOrderJob(&jobs[0]);
+	
+	if(!state.indexBufferValid)
+		{
+		/* Upload the entire ordering: */
+		glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,numEvents*sizeof(GLuint),&state.order[0],GL_DYNAMIC_DRAW_ARB);
+		}
+	else
+		{
+		/* Merge the changed ranges of all jobs: */
+		for(unsigned int i=0;i<numThreads;++i)
+			changedRanges.insert(changedRanges.end(),jobs[i].changedRanges.begin(),jobs[i].changedRanges.end());
+		std::sort(changedRanges.begin(),changedRanges.end());
+		std::vector<ChangedRange> uploadRanges;
+		for(std::vector<ChangedRange>::iterator crIt=changedRanges.begin();crIt!=changedRanges.end();++crIt)
+			addChangedRange(uploadRanges,crIt->begin,crIt->end);
+		
+		/* Upload only the changed parts of the ordering: */
+		for(std::vector<ChangedRange>::iterator urIt=uploadRanges.begin();urIt!=uploadRanges.end();++urIt)
+			glBufferSubDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,urIt->begin*sizeof(GLuint),(urIt->end-urIt->begin)*sizeof(GLuint),&state.order[urIt->begin]);
+		}
+	
+	state.valid=true;
+	state.eyePos=eyePos;
+	state.indexBufferValid=true;
+	}
+
+void EarthquakeSet::bindSortState(EarthquakeSet::DataItem* dataItem,const EarthquakeSet::Point& eyePos) const
+	{
+	/* Find an ordering for the exact eye position, the ordering closest to the eye position, and the most recently used ordering: */
+	SortState* exact=0;
+	SortState* closest=0;
+	float closestDist2=0.0f;
+	SortState* mostRecent=&dataItem->sortStates[0];
+	for(int i=0;i<2;++i)
+		{
+		SortState& ss=dataItem->sortStates[i];
+		if(ss.valid)
+			{
+			if(ss.eyePos==eyePos)
+				exact=&ss;
+			float dist2=Geometry::sqrDist(ss.eyePos,eyePos);
+			if(closest==0||closestDist2>dist2)
+				{
+				closest=&ss;
+				closestDist2=dist2;
+				}
+			}
+		if(mostRecent->lastUsed<ss.lastUsed)
+			mostRecent=&ss;
+		}
+	
+	SortState* state=exact;
+	if(state!=0)
+		{
+		/* Bind the ordering's index buffer: */
+		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,state->indexBufferObjectId);
+		}
+	else
+		{
+		/* Update the closest ordering unless it was just used, which happens when rendering the other eye of a stereo pair: */
+		state=closest;
+		if(state==0||state==mostRecent)
+			state=state==&dataItem->sortStates[0]?&dataItem->sortStates[1]:&dataItem->sortStates[0];
+		
+		/* Update the ordering and its index buffer: */
+		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,state->indexBufferObjectId);
+		updateSortState(*state,eyePos);
+		}
+	
+	state->lastUsed=++dataItem->sortCounter;
+	}
+
 void EarthquakeSet::createShader(EarthquakeSet::DataItem* dataItem,const GLClipPlaneTracker& cpt) const
 	{
 	/* Start creating the point rendering vertex shader: */
@@ -750,7 +1155,8 @@ EarthquakeSet::EarthquakeSet(IO::DirectoryPtr directory,const char* earthquakeFi
 	:GLObject(false),
 	 colorMap(sColorMap),
 	 layeredRendering(false),
-	 highlightTime(1.0),currentTime(0.0)
+	 highlightTime(1.0),currentTime(0.0),
+	 coherentSorting(true),numSortThreads(0),sortScheduler(0)
 	{
 	/* Open the earthquake file: */
 	IO::FilePtr earthquakeFile=directory->openFile(earthquakeFileName);
@@ -781,11 +1187,15 @@ EarthquakeSet::EarthquakeSet(IO::DirectoryPtr directory,const char* earthquakeFi
 		Misc::throwStdErr("EarthquakeSet::EarthquakeSet: Error \"%s\" while reading file %s",err.what(),earthquakeFileName);
 		}
 	
+	/* Create worker threads to update back-to-front orderings: */
+	createSortScheduler();
+	
 	GLObject::init();
 	}
 
 EarthquakeSet::~EarthquakeSet(void)
 	{
+	delete sortScheduler;
 	}
 
 void EarthquakeSet::initContext(GLContextData& contextData) const
@@ -892,6 +1302,19 @@ void EarthquakeSet::setCurrentTime(double newCurrentTime)
 	currentTime=newCurrentTime;
 	}
 
+void EarthquakeSet::setCoherentSorting(bool newCoherentSorting)
+	{
+	coherentSorting=newCoherentSorting;
+	}
+
+void EarthquakeSet::setNumSortThreads(unsigned int newNumSortThreads)
+	{
+	numSortThreads=newNumSortThreads;
+	
+	/* Re-create the worker threads: */
+	createSortScheduler();
+	}
+
 void EarthquakeSet::glRenderAction(float pointRadius,GLContextData& contextData) const
 	{
 	/* Get a pointer to the data item: */
@@ -1039,7 +1462,18 @@ void EarthquakeSet::glRenderAction(const EarthquakeSet::Point& eyePos,bool front
 		GLVertexArrayParts::enable(Vertex::getPartsMask());
 		glVertexPointer(static_cast<Vertex*>(0));
 		
-		if(dataItem->sortedPointIndicesBufferObjectId>0)
+		if(dataItem->sortedPointIndicesBufferObjectId>0&&coherentSorting)
+			{
+			/* Bind an index buffer containing the points in back-to-front order from the eye position: */
+			bindSortState(dataItem,eyePos);
+			
+			/* Render the vertex array in back-to-front order: */
+			glDrawElements(GL_POINTS,events.getNumNodes(),GL_UNSIGNED_INT,0);
+			
+			/* Protect the point indices buffer: */
+			glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
+			}
+		else if(dataItem->sortedPointIndicesBufferObjectId>0)
 			{
 			/* Bind the point indices buffer: */
 			glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,dataItem->sortedPointIndicesBufferObjectId);
@@ -39,6 +39,9 @@ class Vector;
 template <class ScalarParam>
 class Geoid;
 }
+namespace Threads {
+class TaskScheduler;
+}
 class GLClipPlaneTracker;
 class GLShader;
 
@@ -63,6 +66,25 @@ class EarthquakeSet:public GLObject
 	private:
 	typedef Geometry::ArrayKdTree<Event> EventTree; // Type for kd-trees containing earthquake events
 	
+	struct SortState // Structure holding a back-to-front ordering of events that is incrementally updated as the eye position moves
+		{
+		/* Elements: */
+		public:
+		bool valid; // Flag whether the ordering has been initialized
+		Point eyePos; // The eye position for which the ordering is sorted
+		unsigned int lastUsed; // Value of the data item's sort counter when the ordering was last used
+		std::vector<GLuint> order; // Indices of events in back-to-front order
+		GLuint indexBufferObjectId; // ID of index buffer holding the ordering
+		bool indexBufferValid; // Flag whether the index buffer holds the current ordering
+		
+		/* Constructors and destructors: */
+		SortState(void)
+			:valid(false),eyePos(Point::origin),lastUsed(0),
+			 indexBufferObjectId(0),indexBufferValid(false)
+			{
+			}
+		};
+	
 	struct DataItem:public GLObject::DataItem
 		{
 		/* Elements: */
@@ -82,6 +104,8 @@ class EarthquakeSet:public GLObject
 		GLuint pointTextureObjectId; // ID of the point texture object
 		Point eyePos; // The eye position for which the points have been sorted in depth order
 		GLuint sortedPointIndicesBufferObjectId; // ID of index buffer containing the indices of points, sorted in depth order from the current eye position
+		SortState sortStates[2]; // Incrementally updated orderings for up to two eye positions, i.e., both eyes of a stereo window
+		unsigned int sortCounter; // Counter to find the least recently used ordering
 		
 		/* Constructors and destructors: */
 		public:
@@ -96,6 +120,9 @@ class EarthquakeSet:public GLObject
 	Point earthCenter; // Position of earth's center point for layered rendering
 	double highlightTime; // Time span (in real time) for which earthquake events are highlighted during animation
 	double currentTime; // Current event time during animation
+	bool coherentSorting; // Flag whether to update previous back-to-front orderings incrementally instead of traversing the entire kd-tree for every new eye position
+	unsigned int numSortThreads; // Number of threads to update back-to-front orderings; 0 uses one thread per CPU
+	Threads::TaskScheduler* sortScheduler; // Worker threads shared by all updates of back-to-front orderings, or null if orderings are updated serially
 	
 	/* Private methods: */
 	void loadANSSFile(IO::FilePtr earthquakeFile,const Geometry::Geoid<double>& referenceEllipsoid,const Geometry::Vector<double,3>& offset,std::vector<Event>& eventList); // Loads an earthquake event file in ANSS readable database snapshot format into the given event list
@@ -105,6 +132,9 @@ class EarthquakeSet:public GLObject
 	#else
 	void drawBackToFront(int left,int right,int splitDimension,const Point& eyePos,GLuint*& bufferPtr) const; // Renders the given kd-tree subtree in back-to-front order
 	#endif
+	void createSortScheduler(void); // Creates worker threads to update back-to-front orderings if the event set is large enough and more than one thread is requested
+	void updateSortState(SortState& state,const Point& eyePos) const; // Updates the given ordering for the given eye position by re-ordering only the kd-tree subtrees whose split planes the eye crossed, and uploads the changed parts into the currently bound index buffer
+	void bindSortState(DataItem* dataItem,const Point& eyePos) const; // Binds an index buffer holding the events in back-to-front order for the given eye position
 	void createShader(DataItem* dataItem,const GLClipPlaneTracker& cpt) const; // Creates the particle rendering shader based on current OpenGL settings
 	
 	/* Constructors and destructors: */
@@ -121,6 +151,8 @@ class EarthquakeSet:public GLObject
 	void disableLayeredRendering(void); // Disables layered rendering
 	void setHighlightTime(double newHighlightTime); // Sets the time span for which events are highlighted during animation
 	void setCurrentTime(double newCurrentTime); // Sets the current event time during animation
+	void setCoherentSorting(bool newCoherentSorting); // Enables or disables incremental updates of back-to-front orderings
+	void setNumSortThreads(unsigned int newNumSortThreads); // Sets the number of threads updating back-to-front orderings; 0 uses one thread per CPU
 	void glRenderAction(float pointRadius,GLContextData& contextData) const; // Renders the earthquake set
 	void glRenderAction(const Point& eyePos,bool front,float pointRadius,GLContextData& contextData) const; // Renders the earthquake set in blending order from the given eye point
 	void glRenderAction(const Point& eyePos,float pointRadius,GLContextData& contextData) const // Shortcut method to render the front and back halves of the earthquake set whether or not layered rendering is enabled
@@ -19,8 +19,11 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 
 #include "ImageViewer.h"
 
+#include <stdlib.h>
 #include <string.h>
+#include <string>
 #include <stdexcept>
+#include <Misc/FunctionCalls.h>
 #include <Misc/MessageLogger.h>
 #include <Math/Math.h>
 #include <Math/Constants.h>
@@ -34,6 +37,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <GL/GLGeometryWrappers.h>
 #include <Images/RGBImage.h>
 #include <Images/ReadImageFile.h>
+#include <Images/GetImageFileSize.h>
 #include <Images/WriteImageFile.h>
 #include <Vrui/Vrui.h>
 #include <Vrui/ToolManager.h>
@@ -818,18 +822,39 @@ ImageViewer::Color ImageViewer::getPixel(unsigned int x,unsigned int y) const
 		}
 	}
 
+void ImageViewer::tileLoadedCallback(const Images::ImagePyramidRenderer* renderer)
+	{
+	/* Render another frame to display the loaded tiles: */
+	Vrui::requestUpdate();
+	}
+
 ImageViewer::ImageViewer(int& argc,char**& argv)
-	:Vrui::Application(argc,argv)
+	:Vrui::Application(argc,argv),
+	 image(0),pyramid(0),pyramidRenderer(0)
 	{
 	/* Parse the command line: */
 	const char* imageFileName=0;
 	bool printInfo=false;
+	int usePyramid=-1;
+	unsigned int tileSize=256;
+	size_t cacheSize=1024;
+	size_t textureCacheSize=256;
 	for(int i=1;i<argc;++i)
 		{
 		if(argv[i][0]=='-')
 			{
 			if(strcasecmp(argv[i]+1,"p")==0)
 				printInfo=true;
+			else if(strcasecmp(argv[i]+1,"pyramid")==0)
+				usePyramid=1;
+			else if(strcasecmp(argv[i]+1,"noPyramid")==0)
+				usePyramid=0;
+			else if(strcasecmp(argv[i]+1,"tileSize")==0&&i+1<argc)
+				tileSize=(unsigned int)(atoi(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"cacheSize")==0&&i+1<argc)
+				cacheSize=size_t(atoi(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"textureCacheSize")==0&&i+1<argc)
+				textureCacheSize=size_t(atoi(argv[++i]));
 			}
 		else if(imageFileName==0)
 			imageFileName=argv[i];
@@ -837,17 +862,69 @@ ImageViewer::ImageViewer(int& argc,char**& argv)
 	if(imageFileName==0)
 		throw std::runtime_error("ImageViewer: No image file name provided");
 	
-	/* Load the image into the texture set: */
-	Images::BaseImage loadImage=Images::readGenericImageFile(imageFileName);
-	Images::TextureSet::Texture& tex=textures.addTexture(loadImage,GL_TEXTURE_2D,loadImage.getInternalFormat(),0U);
-	image=&tex.getImage();
+	/* Page images that are too big to be uploaded as a single texture from an image pyramid unless told otherwise: */
+	if(usePyramid<0)
+		{
+		usePyramid=0;
+		try
+			{
+			unsigned int width,height;
+			Images::getImageFileSize(imageFileName,width,height);
+			if(width>16384U||height>16384U)
+				usePyramid=1;
+			}
+		catch(const std::runtime_error&)
+			{
+			/* Load the image in its entirety if its size can not be determined up front: */
+			}
+		}
+	
+	unsigned int numChannels,channelSize;
+	GLenum scalarType;
+	if(usePyramid!=0)
+		{
+		/* Build the image pyramid cache file unless it is current: */
+		std::string pyramidFileName=imageFileName;
+		pyramidFileName.append(".pyramid");
+		if(!Images::ImagePyramid::isCurrent(pyramidFileName.c_str(),imageFileName))
+			{
+			Misc::formattedConsoleNote("ImageViewer: Building image pyramid %s",pyramidFileName.c_str());
+			Images::ImagePyramid::build(imageFileName,pyramidFileName.c_str(),tileSize);
+			}
+		
+		/* Open the image pyramid and create a renderer for it: */
+		pyramid=new Images::ImagePyramid(pyramidFileName.c_str());
+		pyramidRenderer=new Images::ImagePyramidRenderer(*pyramid,cacheSize<<20,textureCacheSize<<20);
+		pyramidRenderer->setTileLoadedCallback(Misc::createFunctionCall(&ImageViewer::tileLoadedCallback));
+		for(int i=0;i<2;++i)
+			imageSize[i]=pyramid->getSize(i);
+		numChannels=pyramid->getNumChannels();
+		channelSize=pyramid->getChannelSize();
+		scalarType=pyramid->getScalarType();
+		}
+	else
+		{
+		/* Load the image into the texture set: */
+		Images::BaseImage loadImage=Images::readGenericImageFile(imageFileName);
+		Images::TextureSet::Texture& tex=textures.addTexture(loadImage,GL_TEXTURE_2D,loadImage.getInternalFormat(),0U);
+		image=&tex.getImage();
+		for(int i=0;i<2;++i)
+			imageSize[i]=image->getSize(i);
+		numChannels=image->getNumChannels();
+		channelSize=image->getChannelSize();
+		scalarType=image->getScalarType();
+		
+		/* Set clamping and filtering parameters for mip-mapped linear interpolation: */
+		tex.setMipmapRange(0,1000);
+		tex.setWrapModes(GL_CLAMP_TO_EDGE,GL_CLAMP_TO_EDGE);
+		tex.setFilterModes(GL_LINEAR_MIPMAP_LINEAR,GL_LINEAR);
+		}
 	
 	if(printInfo)
 		{
 		/* Display image size and format: */
-		char messageText[2048];
 		const char* componentScalarType=0;
-		switch(image->getScalarType())
+		switch(scalarType)
 			{
 			case GL_BYTE:
 				componentScalarType="signed 8-bit integer";
@@ -884,21 +961,28 @@ ImageViewer::ImageViewer(int& argc,char**& argv)
 			default:
 				componentScalarType="<unknown>";
 			}
-		Misc::formattedUserNote("Image: %s\nSize: %u x %u pixels\nFormat: %u %s of %u %s%s\nComponent type: %s",imageFileName,image->getSize(0),image->getSize(1),image->getNumChannels(),image->getNumChannels()!=1?"channels":"channel",image->getChannelSize(),image->getChannelSize()!=1?"bytes":"byte",image->getNumChannels()!=1?" each":"",componentScalarType);
+		Misc::formattedUserNote("Image: %s\nSize: %u x %u pixels\nFormat: %u %s of %u %s%s\nComponent type: %s",imageFileName,imageSize[0],imageSize[1],numChannels,numChannels!=1?"channels":"channel",channelSize,channelSize!=1?"bytes":"byte",numChannels!=1?" each":"",componentScalarType);
 		}
 	
-	/* Set clamping and filtering parameters for mip-mapped linear interpolation: */
-	tex.setMipmapRange(0,1000);
-	tex.setWrapModes(GL_CLAMP_TO_EDGE,GL_CLAMP_TO_EDGE);
-	tex.setFilterModes(GL_LINEAR_MIPMAP_LINEAR,GL_LINEAR);
-	
-	/* Initialize the tool class: */
-	PipetteTool::initClass();
-	HomographySamplerTool::initClass();
+	/* Initialize the tool classes, which need access to the entire image: */
+	if(image!=0)
+		{
+		PipetteTool::initClass();
+		HomographySamplerTool::initClass();
+		}
 	}
 
 ImageViewer::~ImageViewer(void)
 	{
+	delete pyramidRenderer;
+	delete pyramid;
+	}
+
+void ImageViewer::frame(void)
+	{
+	/* Start a new frame for the image pyramid renderer: */
+	if(pyramidRenderer!=0)
+		pyramidRenderer->startFrame();
 	}
 
 void ImageViewer::display(GLContextData& contextData) const
@@ -908,31 +992,38 @@ void ImageViewer::display(GLContextData& contextData) const
 	glEnable(GL_TEXTURE_2D);
 	glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_REPLACE);
 	
-	/* Get the texture set's GL state: */
-	Images::TextureSet::GLState* texGLState=textures.getGLState(contextData);
-	
-	/* Bind the texture object: */
-	const Images::TextureSet::GLState::Texture& tex=texGLState->bindTexture(0U);
-	const Images::BaseImage& image=tex.getImage();
-	
-	/* Query the range of texture coordinates: */
-	const GLfloat* texMin=tex.getTexCoordMin();
-	const GLfloat* texMax=tex.getTexCoordMax();
-	
-	/* Draw the image: */
-	glBegin(GL_QUADS);
-	glTexCoord2f(texMin[0],texMin[1]);
-	glVertex2i(0,0);
-	glTexCoord2f(texMax[0],texMin[1]);
-	glVertex2i(image.getSize(0),0);
-	glTexCoord2f(texMax[0],texMax[1]);
-	glVertex2i(image.getSize(0),image.getSize(1));
-	glTexCoord2f(texMin[0],texMax[1]);
-	glVertex2i(0,image.getSize(1));
-	glEnd();
-	
-	/* Protect the texture object: */
-	glBindTexture(GL_TEXTURE_2D,0);
+	if(pyramidRenderer!=0)
+		{
+		/* Render the visible parts of the image pyramid: */
+		pyramidRenderer->glRenderAction(contextData);
+		}
+	else
+		{
+		/* Get the texture set's GL state: */
+		Images::TextureSet::GLState* texGLState=textures.getGLState(contextData);
+		
+		/* Bind the texture object: */
+		const Images::TextureSet::GLState::Texture& tex=texGLState->bindTexture(0U);
+		
+		/* Query the range of texture coordinates: */
+		const GLfloat* texMin=tex.getTexCoordMin();
+		const GLfloat* texMax=tex.getTexCoordMax();
+		
+		/* Draw the image: */
+		glBegin(GL_QUADS);
+		glTexCoord2f(texMin[0],texMin[1]);
+		glVertex2i(0,0);
+		glTexCoord2f(texMax[0],texMin[1]);
+		glVertex2i(imageSize[0],0);
+		glTexCoord2f(texMax[0],texMax[1]);
+		glVertex2i(imageSize[0],imageSize[1]);
+		glTexCoord2f(texMin[0],texMax[1]);
+		glVertex2i(0,imageSize[1]);
+		glEnd();
+		
+		/* Protect the texture object: */
+		glBindTexture(GL_TEXTURE_2D,0);
+		}
 	
 	/* Draw the image's backside: */
 	glDisable(GL_TEXTURE_2D);
@@ -941,9 +1032,9 @@ void ImageViewer::display(GLContextData& contextData) const
 	glBegin(GL_QUADS);
 	glNormal3f(0.0f,0.0f,-1.0f);
 	glVertex2i(0,0);
-	glVertex2i(0,image.getSize(1));
-	glVertex2i(image.getSize(0),image.getSize(1));
-	glVertex2i(image.getSize(0),0);
+	glVertex2i(0,imageSize[1]);
+	glVertex2i(imageSize[0],imageSize[1]);
+	glVertex2i(imageSize[0],0);
 	glEnd();
 	
 	/* Restore OpenGL state: */
@@ -952,12 +1043,9 @@ void ImageViewer::display(GLContextData& contextData) const
 
 void ImageViewer::resetNavigation(void)
 	{
-	/* Access the image: */
-	const Images::BaseImage& image=textures.getTexture(0U).getImage();
-	
 	/* Reset the Vrui navigation transformation: */
-	Vrui::Scalar w(image.getSize(0));
-	Vrui::Scalar h(image.getSize(1));
+	Vrui::Scalar w(imageSize[0]);
+	Vrui::Scalar h(imageSize[1]);
 	Vrui::Point center(Math::div2(w),Math::div2(h),Vrui::Scalar(0.05));
 	Vrui::Scalar size=Math::sqrt(Math::sqr(w)+Math::sqr(h));
 	Vrui::setNavigationTransformation(center,size,Vrui::Vector(0,1,0));
@@ -25,6 +25,8 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <GL/gl.h>
 #include <GL/GLColor.h>
 #include <Images/TextureSet.h>
+#include <Images/ImagePyramid.h>
+#include <Images/ImagePyramidRenderer.h>
 #include <Vrui/Application.h>
 #include <Vrui/Tool.h>
 #include <Vrui/GenericToolFactory.h>
@@ -108,11 +110,15 @@ class ImageViewer:public Vrui::Application
 	friend class HomographySamplerTool;
 	
 	/* Elements: */
-	Images::TextureSet textures; // Texture set containing the image to be displayed
-	const Images::BaseImage* image; // Pointer to the image
+	unsigned int imageSize[2]; // Width and height of the displayed image in pixels
+	Images::TextureSet textures; // Texture set containing the image to be displayed if it is loaded in its entirety
+	const Images::BaseImage* image; // Pointer to the image if it is loaded in its entirety, or null
+	Images::ImagePyramid* pyramid; // Out-of-core image pyramid if the image is too big to be loaded in its entirety, or null
+	Images::ImagePyramidRenderer* pyramidRenderer; // Renderer for the out-of-core image pyramid, or null
 	
 	/* Private methods: */
 	Color getPixel(unsigned int x,unsigned int y) const; // Returns an RGBA color for the given pixel position
+	static void tileLoadedCallback(const Images::ImagePyramidRenderer* renderer); // Callback called when image pyramid tiles are waiting to be displayed
 	
 	/* Constructors and destructors: */
 	public:
@@ -120,6 +126,7 @@ class ImageViewer:public Vrui::Application
 	virtual ~ImageViewer(void);
 	
 	/* Methods from Vrui::Application: */
+	virtual void frame(void);
 	virtual void display(GLContextData& contextData) const;
 	virtual void resetNavigation(void);
 	};
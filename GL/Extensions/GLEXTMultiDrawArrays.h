@@ -0,0 +1,85 @@
+/***********************************************************************
+GLEXTMultiDrawArrays - OpenGL extension class for the
+GL_EXT_multi_draw_arrays extension.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the OpenGL Support Library (GLSupport).
+
+The OpenGL Support Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The OpenGL Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the OpenGL Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef GLEXTENSIONS_GLEXTMULTIDRAWARRAYS_INCLUDED
+#define GLEXTENSIONS_GLEXTMULTIDRAWARRAYS_INCLUDED
+
+#include <GL/gl.h>
+#include <GL/TLSHelper.h>
+#include <GL/Extensions/GLExtension.h>
+
+/********************************
+Extension-specific parts of gl.h:
+********************************/
+
+#ifndef GL_EXT_multi_draw_arrays
+#define GL_EXT_multi_draw_arrays 1
+
+/* Extension-specific functions: */
+typedef void (APIENTRY * PFNGLMULTIDRAWARRAYSEXTPROC) (GLenum mode, const GLint* first, const GLsizei* count, GLsizei primcount);
+typedef void (APIENTRY * PFNGLMULTIDRAWELEMENTSEXTPROC) (GLenum mode, const GLsizei* count, GLenum type, const GLvoid* const* indices, GLsizei primcount);
+
+#endif
+
+/* Forward declarations of friend functions: */
+void glMultiDrawArraysEXT(GLenum mode,const GLint* first,const GLsizei* count,GLsizei primcount);
+void glMultiDrawElementsEXT(GLenum mode,const GLsizei* count,GLenum type,const GLvoid* const* indices,GLsizei primcount);
+
+class GLEXTMultiDrawArrays:public GLExtension
+	{
+	/* Elements: */
+	private:
+	static GL_THREAD_LOCAL(GLEXTMultiDrawArrays*) current; // Pointer to extension object for current OpenGL context
+	static const char* name; // Extension name
+	PFNGLMULTIDRAWARRAYSEXTPROC glMultiDrawArraysEXTProc;
+	PFNGLMULTIDRAWELEMENTSEXTPROC glMultiDrawElementsEXTProc;
+	
+	/* Constructors and destructors: */
+	private:
+	GLEXTMultiDrawArrays(void);
+	public:
+	virtual ~GLEXTMultiDrawArrays(void);
+	
+	/* Methods: */
+	public:
+	virtual const char* getExtensionName(void) const;
+	virtual void activate(void);
+	virtual void deactivate(void);
+	static bool isSupported(void); // Returns true if the extension is supported in the current OpenGL context
+	static void initExtension(void); // Initializes the extension in the current OpenGL context
+	
+	/* Extension entry points: */
+	inline friend void glMultiDrawArraysEXT(GLenum mode,const GLint* first,const GLsizei* count,GLsizei primcount)
+		{
+		GLEXTMultiDrawArrays::current->glMultiDrawArraysEXTProc(mode,first,count,primcount);
+		}
+	inline friend void glMultiDrawElementsEXT(GLenum mode,const GLsizei* count,GLenum type,const GLvoid* const* indices,GLsizei primcount)
+		{
+		GLEXTMultiDrawArrays::current->glMultiDrawElementsEXTProc(mode,count,type,indices,primcount);
+		}
+	};
+
+/*******************************
+Extension-specific entry points:
+*******************************/
+
+#endif
@@ -1,6 +1,6 @@
 /***********************************************************************
 GLModels - Helper functions to render simple models using OpenGL.
-Copyright (c) 2004-2013 Oliver Kreylos
+Copyright (c) 2004-2021 Oliver Kreylos
 
 This file is part of the OpenGL Support Library (GLSupport).
 
@@ -23,217 +23,185 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <GL/GLModels.h>
 
-void glDrawCube(GLfloat size)
-	{
-	GLfloat s=0.5f*size;
-	
-	glBegin(GL_QUADS);
-	glNormal3f(-1.0f,0.0f,0.0f);
-	glVertex3f(-s,-s,-s);
-	glVertex3f(-s,-s, s);
-	glVertex3f(-s, s, s);
-	glVertex3f(-s, s,-s);
-	glNormal3f(1.0f,0.0f,0.0f);
-	glVertex3f( s,-s,-s);
-	glVertex3f( s, s,-s);
-	glVertex3f( s, s, s);
-	glVertex3f( s,-s, s);
-	glNormal3f(0.0f,-1.0f,0.0f);
-	glVertex3f(-s,-s,-s);
-	glVertex3f( s,-s,-s);
-	glVertex3f( s,-s, s);
-	glVertex3f(-s,-s, s);
-	glNormal3f(0.0f,1.0f,0.0f);
-	glVertex3f(-s, s,-s);
-	glVertex3f(-s, s, s);
-	glVertex3f( s, s, s);
-	glVertex3f( s, s,-s);
-	glNormal3f(0.0f,0.0f,-1.0f);
-	glVertex3f(-s,-s,-s);
-	glVertex3f(-s, s,-s);
-	glVertex3f( s, s,-s);
-	glVertex3f( s,-s,-s);
-	glNormal3f(0.0f,0.0f,1.0f);
-	glVertex3f(-s,-s, s);
-	glVertex3f( s,-s, s);
-	glVertex3f( s, s, s);
-	glVertex3f(-s, s, s);
-	glEnd();
-	}
+namespace {
 
-void glDrawBox(const GLfloat min[3],const GLfloat max[3])
-	{
-	glBegin(GL_QUADS);
-	glNormal3f(-1.0f,0.0f,0.0f);
-	glVertex3f(min[0],min[1],min[2]);
-	glVertex3f(min[0],min[1],max[2]);
-	glVertex3f(min[0],max[1],max[2]);
-	glVertex3f(min[0],max[1],min[2]);
-	glNormal3f(1.0f,0.0f,0.0f);
-	glVertex3f(max[0],min[1],min[2]);
-	glVertex3f(max[0],max[1],min[2]);
-	glVertex3f(max[0],max[1],max[2]);
-	glVertex3f(max[0],min[1],max[2]);
-	glNormal3f(0.0f,-1.0f,0.0f);
-	glVertex3f(min[0],min[1],min[2]);
-	glVertex3f(max[0],min[1],min[2]);
-	glVertex3f(max[0],min[1],max[2]);
-	glVertex3f(min[0],min[1],max[2]);
-	glNormal3f(0.0f,1.0f,0.0f);
-	glVertex3f(min[0],max[1],min[2]);
-	glVertex3f(min[0],max[1],max[2]);
-	glVertex3f(max[0],max[1],max[2]);
-	glVertex3f(max[0],max[1],min[2]);
-	glNormal3f(0.0f,0.0f,-1.0f);
-	glVertex3f(min[0],min[1],min[2]);
-	glVertex3f(min[0],max[1],min[2]);
-	glVertex3f(max[0],max[1],min[2]);
-	glVertex3f(max[0],min[1],min[2]);
-	glNormal3f(0.0f,0.0f,1.0f);
-	glVertex3f(min[0],min[1],max[2]);
-	glVertex3f(max[0],min[1],max[2]);
-	glVertex3f(max[0],max[1],max[2]);
-	glVertex3f(min[0],max[1],max[2]);
-	glEnd();
-	}
+/***************************************************************
+Helper class to pass model geometry to OpenGL in immediate mode:
+***************************************************************/
 
-void glDrawSphereMercator(GLfloat radius,GLsizei numStrips,GLsizei numQuads)
+class GLImmediateModelSink:public GLModelSink
 	{
-	const GLfloat pi=GLfloat(M_PI);
-	
-	GLfloat lat1=1.0f*pi/GLfloat(numStrips)-0.5f*pi;
-	GLfloat r1=cosf(lat1);
-	GLfloat z1=sinf(lat1);
-	
-	/* Draw "southern polar cap": */
-	glBegin(GL_TRIANGLE_FAN);
-	glNormal3f(0.0f,0.0f,-1.0f);
-	glVertex3f(0.0f,0.0f,-radius);
-	for(int j=numQuads;j>=0;--j)
+	/* Methods from GLModelSink: */
+	public:
+	virtual void begin(GLenum primitive)
 		{
-		GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numQuads);
-		GLfloat x1=cosf(lng)*r1;
-		GLfloat y1=sinf(lng)*r1;
-		glNormal3f(x1,y1,z1);
-		glVertex3f(x1*radius,y1*radius,z1*radius);
+		glBegin(primitive);
 		}
-	glEnd();
-	
-	/* Draw quad strips: */
-	for(int i=2;i<numStrips;++i)
+	virtual void normal(GLfloat x,GLfloat y,GLfloat z)
 		{
-		GLfloat r0=r1;
-		GLfloat z0=z1;
-		lat1=GLfloat(i)*pi/GLfloat(numStrips)-0.5f*pi;
-		r1=cosf(lat1);
-		z1=sinf(lat1);
-		
-		glBegin(GL_QUAD_STRIP);
-		for(int j=0;j<=numQuads;++j)
-			{
-			GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numQuads);
-			GLfloat x1=cosf(lng)*r1;
-			GLfloat y1=sinf(lng)*r1;
-			glNormal3f(x1,y1,z1);
-			glVertex3f(x1*radius,y1*radius,z1*radius);
-			GLfloat x0=cosf(lng)*r0;
-			GLfloat y0=sinf(lng)*r0;
-			glNormal3f(x0,y0,z0);
-			glVertex3f(x0*radius,y0*radius,z0*radius);
-			}
-		glEnd();
+		glNormal3f(x,y,z);
 		}
-	
-	/* Draw "northern polar cap": */
-	glBegin(GL_TRIANGLE_FAN);
-	glNormal3f(0.0f,0.0f,1.0f);
-	glVertex3f(0.0f,0.0f,radius);
-	for(int j=0;j<=numQuads;++j)
+	virtual void vertex(GLfloat x,GLfloat y,GLfloat z)
 		{
-		GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numQuads);
-		GLfloat x1=cosf(lng)*r1;
-		GLfloat y1=sinf(lng)*r1;
-		glNormal3f(x1,y1,z1);
-		glVertex3f(x1*radius,y1*radius,z1*radius);
+		glVertex3f(x,y,z);
 		}
-	glEnd();
+	virtual void end(void)
+		{
+		glEnd();
+		}
+	};
+
+}
+
+/****************************
+Methods of class GLModelSink:
+****************************/
+
+GLModelSink::~GLModelSink(void)
+	{
 	}
 
-void glDrawSphereMercatorWithTexture(GLfloat radius,GLsizei numStrips,GLsizei numQuads)
+/************************************************
+Functions to pass model geometry to a model sink:
+************************************************/
+
+void glDrawCube(GLfloat size,GLModelSink& sink)
+	{
+	GLfloat s=0.5f*size;
+	
+	sink.begin(GL_QUADS);
+	sink.normal(-1.0f,0.0f,0.0f);
+	sink.vertex(-s,-s,-s);
+	sink.vertex(-s,-s, s);
+	sink.vertex(-s, s, s);
+	sink.vertex(-s, s,-s);
+	sink.normal(1.0f,0.0f,0.0f);
+	sink.vertex( s,-s,-s);
+	sink.vertex( s, s,-s);
+	sink.vertex( s, s, s);
+	sink.vertex( s,-s, s);
+	sink.normal(0.0f,-1.0f,0.0f);
+	sink.vertex(-s,-s,-s);
+	sink.vertex( s,-s,-s);
+	sink.vertex( s,-s, s);
+	sink.vertex(-s,-s, s);
+	sink.normal(0.0f,1.0f,0.0f);
+	sink.vertex(-s, s,-s);
+	sink.vertex(-s, s, s);
+	sink.vertex( s, s, s);
+	sink.vertex( s, s,-s);
+	sink.normal(0.0f,0.0f,-1.0f);
+	sink.vertex(-s,-s,-s);
+	sink.vertex(-s, s,-s);
+	sink.vertex( s, s,-s);
+	sink.vertex( s,-s,-s);
+	sink.normal(0.0f,0.0f,1.0f);
+	sink.vertex(-s,-s, s);
+	sink.vertex( s,-s, s);
+	sink.vertex( s, s, s);
+	sink.vertex(-s, s, s);
+	sink.end();
+	}
+
+void glDrawBox(const GLfloat min[3],const GLfloat max[3],GLModelSink& sink)
+	{
+	sink.begin(GL_QUADS);
+	sink.normal(-1.0f,0.0f,0.0f);
+	sink.vertex(min[0],min[1],min[2]);
+	sink.vertex(min[0],min[1],max[2]);
+	sink.vertex(min[0],max[1],max[2]);
+	sink.vertex(min[0],max[1],min[2]);
+	sink.normal(1.0f,0.0f,0.0f);
+	sink.vertex(max[0],min[1],min[2]);
+	sink.vertex(max[0],max[1],min[2]);
+	sink.vertex(max[0],max[1],max[2]);
+	sink.vertex(max[0],min[1],max[2]);
+	sink.normal(0.0f,-1.0f,0.0f);
+	sink.vertex(min[0],min[1],min[2]);
+	sink.vertex(max[0],min[1],min[2]);
+	sink.vertex(max[0],min[1],max[2]);
+	sink.vertex(min[0],min[1],max[2]);
+	sink.normal(0.0f,1.0f,0.0f);
+	sink.vertex(min[0],max[1],min[2]);
+	sink.vertex(min[0],max[1],max[2]);
+	sink.vertex(max[0],max[1],max[2]);
+	sink.vertex(max[0],max[1],min[2]);
+	sink.normal(0.0f,0.0f,-1.0f);
+	sink.vertex(min[0],min[1],min[2]);
+	sink.vertex(min[0],max[1],min[2]);
+	sink.vertex(max[0],max[1],min[2]);
+	sink.vertex(max[0],min[1],min[2]);
+	sink.normal(0.0f,0.0f,1.0f);
+	sink.vertex(min[0],min[1],max[2]);
+	sink.vertex(max[0],min[1],max[2]);
+	sink.vertex(max[0],max[1],max[2]);
+	sink.vertex(min[0],max[1],max[2]);
+	sink.end();
+	}
+
+void glDrawSphereMercator(GLfloat radius,GLsizei numStrips,GLsizei numQuads,GLModelSink& sink)
 	{
 	const GLfloat pi=GLfloat(M_PI);
 	
-	GLfloat texY1=1.0f/GLfloat(numStrips);
 	GLfloat lat1=1.0f*pi/GLfloat(numStrips)-0.5f*pi;
 	GLfloat r1=cosf(lat1);
 	GLfloat z1=sinf(lat1);
 	
 	/* Draw "southern polar cap": */
-	glBegin(GL_TRIANGLE_FAN);
-	glNormal3f(0.0f,0.0f,-1.0f);
-	glTexCoord2f(0.5f,0.0f);
-	glVertex3f(0.0f,0.0f,-radius);
+	sink.begin(GL_TRIANGLE_FAN);
+	sink.normal(0.0f,0.0f,-1.0f);
+	sink.vertex(0.0f,0.0f,-radius);
 	for(int j=numQuads;j>=0;--j)
 		{
-		GLfloat texX=GLfloat(j)/GLfloat(numQuads);
 		GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numQuads);
 		GLfloat x1=cosf(lng)*r1;
 		GLfloat y1=sinf(lng)*r1;
-		glNormal3f(x1,y1,z1);
-		glTexCoord2f(texX,texY1);
-		glVertex3f(x1*radius,y1*radius,z1*radius);
+		sink.normal(x1,y1,z1);
+		sink.vertex(x1*radius,y1*radius,z1*radius);
 		}
-	glEnd();
+	sink.end();
 	
 	/* Draw quad strips: */
 	for(int i=2;i<numStrips;++i)
 		{
 		GLfloat r0=r1;
 		GLfloat z0=z1;
-		GLfloat texY0=texY1;
-		texY1=GLfloat(i)/GLfloat(numStrips);
 		lat1=GLfloat(i)*pi/GLfloat(numStrips)-0.5f*pi;
 		r1=cosf(lat1);
 		z1=sinf(lat1);
 		
-		glBegin(GL_QUAD_STRIP);
+		sink.begin(GL_QUAD_STRIP);
 		for(int j=0;j<=numQuads;++j)
 			{
-			GLfloat texX=GLfloat(j)/GLfloat(numQuads);
 			GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numQuads);
 			GLfloat x1=cosf(lng)*r1;
 			GLfloat y1=sinf(lng)*r1;
-			glNormal3f(x1,y1,z1);
-			glTexCoord2f(texX,texY1);
-			glVertex3f(x1*radius,y1*radius,z1*radius);
+			sink.normal(x1,y1,z1);
+			sink.vertex(x1*radius,y1*radius,z1*radius);
 			GLfloat x0=cosf(lng)*r0;
 			GLfloat y0=sinf(lng)*r0;
-			glNormal3f(x0,y0,z0);
-			glTexCoord2f(texX,texY0);
-			glVertex3f(x0*radius,y0*radius,z0*radius);
+			sink.normal(x0,y0,z0);
+			sink.vertex(x0*radius,y0*radius,z0*radius);
 			}
-		glEnd();
+		sink.end();
 		}
 	
 	/* Draw "northern polar cap": */
-	glBegin(GL_TRIANGLE_FAN);
-	glNormal3f(0.0f,0.0f,1.0f);
-	glTexCoord2f(0.5f,1.0f);
-	glVertex3f(0.0f,0.0f,radius);
+	sink.begin(GL_TRIANGLE_FAN);
+	sink.normal(0.0f,0.0f,1.0f);
+	sink.vertex(0.0f,0.0f,radius);
 	for(int j=0;j<=numQuads;++j)
 		{
-		GLfloat texX=GLfloat(j)/GLfloat(numQuads);
 		GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numQuads);
 		GLfloat x1=cosf(lng)*r1;
 		GLfloat y1=sinf(lng)*r1;
-		glNormal3f(x1,y1,z1);
-		glTexCoord2f(texX,texY1);
-		glVertex3f(x1*radius,y1*radius,z1*radius);
+		sink.normal(x1,y1,z1);
+		sink.vertex(x1*radius,y1*radius,z1*radius);
 		}
-	glEnd();
+	sink.end();
 	}
 
-inline void combine(const GLfloat p100[3],const GLfloat p010[3],const GLfloat p001[3],GLfloat w0,GLfloat w1,GLfloat radius)
+inline void combine(GLModelSink& sink,const GLfloat p100[3],const GLfloat p010[3],const GLfloat p001[3],GLfloat w0,GLfloat w1,GLfloat radius)
 	{
 	GLfloat w2=1.0f-w0-w1;
 	GLfloat result[3];
@@ -246,13 +214,13 @@ inline void combine(const GLfloat p100[3],const GLfloat p010[3],const GLfloat p0
 	resultLen=sqrtf(resultLen);
 	for(int i=0;i<3;++i)
 		result[i]/=resultLen;
-	glNormal3fv(result);
+	sink.normal(result);
 	for(int i=0;i<3;++i)
 		result[i]*=radius;
-	glVertex3fv(result);
+	sink.vertex(result);
 	}
 
-inline void combine(const GLfloat p00[3],const GLfloat p10[3],const GLfloat p01[3],const GLfloat p11[3],GLfloat wx,GLfloat wy,GLfloat radius)
+inline void combine(GLModelSink& sink,const GLfloat p00[3],const GLfloat p10[3],const GLfloat p01[3],const GLfloat p11[3],GLfloat wx,GLfloat wy,GLfloat radius)
 	{
 	GLfloat result[3];
 	GLfloat resultLen=0.0f;
@@ -275,13 +243,13 @@ inline void combine(const GLfloat p00[3],const GLfloat p10[3],const GLfloat p01[
 	resultLen=sqrtf(resultLen);
 	for(int i=0;i<3;++i)
 		result[i]/=resultLen;
-	glNormal3fv(result);
+	sink.normal(result);
 	for(int i=0;i<3;++i)
 		result[i]*=radius;
-	glVertex3fv(result);
+	sink.vertex(result);
 	}
 
-void glDrawSphereIcosahedron(GLfloat radius,GLsizei numStrips)
+void glDrawSphereIcosahedron(GLfloat radius,GLsizei numStrips,GLModelSink& sink)
 	{
 	/* Construct static icosahedron model: */
 	const GLfloat b0=0.525731112119133606f; // b0=sqrt((5.0-sqrt(5.0))/10);
@@ -297,7 +265,7 @@ void glDrawSphereIcosahedron(GLfloat radius,GLsizei numStrips)
 		{
 		GLfloat botW=GLfloat(strip)/GLfloat(numStrips);
 		GLfloat topW=GLfloat(strip+1)/GLfloat(numStrips);
-		glBegin(GL_TRIANGLE_STRIP);
+		sink.begin(GL_TRIANGLE_STRIP);
 		for(int i=0;i<10;i+=2)
 			{
 			const GLfloat* p00=vUnit[stripIndices[i+1]];
@@ -308,13 +276,13 @@ void glDrawSphereIcosahedron(GLfloat radius,GLsizei numStrips)
 				{
 				GLfloat leftW=GLfloat(j)/GLfloat(numStrips);
 				// GLfloat rightW=GLfloat(j+1)/GLfloat(numStrips);
-				combine(p00,p10,p01,p11,leftW,topW,radius);
-				combine(p00,p10,p01,p11,leftW,botW,radius);
+				combine(sink,p00,p10,p01,p11,leftW,topW,radius);
+				combine(sink,p00,p10,p01,p11,leftW,botW,radius);
 				}
-			combine(p00,p10,p01,p11,1.0f,topW,radius);
-			combine(p00,p10,p01,p11,1.0f,botW,radius);
+			combine(sink,p00,p10,p01,p11,1.0f,topW,radius);
+			combine(sink,p00,p10,p01,p11,1.0f,botW,radius);
 			}
-		glEnd();
+		sink.end();
 		}
 	
 	for(int cap=0;cap<2;++cap)
@@ -324,8 +292,8 @@ void glDrawSphereIcosahedron(GLfloat radius,GLsizei numStrips)
 			{
 			GLfloat botW=GLfloat(strip)/GLfloat(numStrips);
 			GLfloat topW=GLfloat(strip+1)/GLfloat(numStrips);
-			glBegin(GL_TRIANGLE_STRIP);
-			combine(vUnit[fanIndices[cap][0]],vUnit[fanIndices[cap][2]],vUnit[fanIndices[cap][1]],topW,0.0f,radius);
+			sink.begin(GL_TRIANGLE_STRIP);
+			combine(sink,vUnit[fanIndices[cap][0]],vUnit[fanIndices[cap][2]],vUnit[fanIndices[cap][1]],topW,0.0f,radius);
 			for(int i=1;i<6;++i)
 				{
 				const GLfloat* p100=vUnit[fanIndices[cap][0]];
@@ -334,72 +302,72 @@ void glDrawSphereIcosahedron(GLfloat radius,GLsizei numStrips)
 				for(int j=0;j<numStrips-strip;++j)
 					{
 					GLfloat leftW=GLfloat(j)/GLfloat(numStrips);
-					combine(p100,p001,p010,botW,leftW,radius);
-					combine(p100,p001,p010,topW,leftW,radius);
+					combine(sink,p100,p001,p010,botW,leftW,radius);
+					combine(sink,p100,p001,p010,topW,leftW,radius);
 					}
 				}
-			combine(vUnit[fanIndices[cap][0]],vUnit[fanIndices[cap][2]],vUnit[fanIndices[cap][1]],botW,0.0f,radius);
-			glEnd();
+			combine(sink,vUnit[fanIndices[cap][0]],vUnit[fanIndices[cap][2]],vUnit[fanIndices[cap][1]],botW,0.0f,radius);
+			sink.end();
 			}
 		
 		/* Render the cap triangle fan: */
-		glBegin(GL_TRIANGLE_FAN);
-		combine(vUnit[fanIndices[cap][0]],vUnit[fanIndices[cap][2]],vUnit[fanIndices[cap][1]],1.0f,0.0f,radius);
+		sink.begin(GL_TRIANGLE_FAN);
+		combine(sink,vUnit[fanIndices[cap][0]],vUnit[fanIndices[cap][2]],vUnit[fanIndices[cap][1]],1.0f,0.0f,radius);
 		GLfloat botW=GLfloat(numStrips-1)/GLfloat(numStrips);
 		for(int i=1;i<6;++i)
-			combine(vUnit[fanIndices[cap][0]],vUnit[fanIndices[cap][i+1]],vUnit[fanIndices[cap][i]],botW,0.0f,radius);
-		combine(vUnit[fanIndices[cap][0]],vUnit[fanIndices[cap][2]],vUnit[fanIndices[cap][1]],botW,0.0f,radius);
-		glEnd();
+			combine(sink,vUnit[fanIndices[cap][0]],vUnit[fanIndices[cap][i+1]],vUnit[fanIndices[cap][i]],botW,0.0f,radius);
+		combine(sink,vUnit[fanIndices[cap][0]],vUnit[fanIndices[cap][2]],vUnit[fanIndices[cap][1]],botW,0.0f,radius);
+		sink.end();
 		}
 	}
 
-void glDrawCylinder(GLfloat radius,GLfloat height,GLsizei numStrips)
+void glDrawCylinder(GLfloat radius,GLfloat height,GLsizei numStrips,GLModelSink& sink)
 	{
 	const GLfloat pi=GLfloat(M_PI);
 	
 	GLfloat h=0.5f*height;
 	
 	/* Draw bottom circle: */
-	glBegin(GL_TRIANGLE_FAN);
-	glNormal3f(0.0f,0.0f,-1.0f);
-	glVertex3f(0.0f,0.0f,-h);
+	sink.begin(GL_TRIANGLE_FAN);
+	sink.normal(0.0f,0.0f,-1.0f);
+	sink.vertex(0.0f,0.0f,-h);
 	for(int j=numStrips;j>=0;--j)
 		{
 		GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numStrips);
 		GLfloat x=cosf(lng);
 		GLfloat y=sinf(lng);
-		glVertex3f(x*radius,y*radius,-h);
+		sink.vertex(x*radius,y*radius,-h);
 		}
-	glEnd();
+	sink.end();
 	
 	/* Draw mantle: */
-	glBegin(GL_QUAD_STRIP);
+	sink.begin(GL_QUAD_STRIP);
 	for(int j=0;j<=numStrips;++j)
 		{
 		GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numStrips);
 		GLfloat x=cosf(lng);
 		GLfloat y=sinf(lng);
-		glNormal3f(x,y,0.0f);
-		glVertex3f(x*radius,y*radius,h);
-		glVertex3f(x*radius,y*radius,-h);
+		sink.normal(x,y,0.0f);
+		sink.vertex(x*radius,y*radius,h);
+		sink.vertex(x*radius,y*radius,-h);
 		}
-	glEnd();
+	sink.end();
 	
 	/* Draw top circle: */
-	glBegin(GL_TRIANGLE_FAN);
-	glNormal3f(0.0f,0.0f,1.0f);
-	glVertex3f(0.0f,0.0f,h);
+	sink.begin(GL_TRIANGLE_FAN);
+	sink.normal(0.0f,0.0f,1.0f);
+	sink.vertex(0.0f,0.0f,h);
 	for(int j=0;j<=numStrips;++j)
 		{
 		GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numStrips);
 		GLfloat x=cosf(lng);
 		GLfloat y=sinf(lng);
-		glVertex3f(x*radius,y*radius,h);
+		sink.vertex(x*radius,y*radius,h);
 		}
-	glEnd();
+	sink.end();
 	}
 
-void glDrawCone(GLfloat radius,GLfloat height,GLsizei numStrips)
+void glDrawCone(GLfloat radius,GLfloat height,GLsizei numStrips,GLModelSink& sink)
 	{
 	const GLfloat pi=GLfloat(M_PI);
 	
@@ -411,33 +379,33 @@ void glDrawCone(GLfloat radius,GLfloat height,GLsizei numStrips)
 	zn*=rn;
 	
 	/* Draw bottom circle: */
-	glBegin(GL_TRIANGLE_FAN);
-	glNormal3f(0.0f,0.0f,-1.0f);
-	glVertex3f(0.0f,0.0f,z0);
+	sink.begin(GL_TRIANGLE_FAN);
+	sink.normal(0.0f,0.0f,-1.0f);
+	sink.vertex(0.0f,0.0f,z0);
 	for(int j=numStrips;j>=0;--j)
 		{
 		GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numStrips);
 		GLfloat x=cosf(lng);
 		GLfloat y=sinf(lng);
-		glVertex3f(x*radius,y*radius,z0);
+		sink.vertex(x*radius,y*radius,z0);
 		}
-	glEnd();
+	sink.end();
 	
 	/* Draw mantle: */
-	glBegin(GL_QUAD_STRIP);
+	sink.begin(GL_QUAD_STRIP);
 	for(int j=0;j<=numStrips;++j)
 		{
 		GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numStrips);
 		GLfloat x=cosf(lng);
 		GLfloat y=sinf(lng);
-		glNormal3f(x*rn,y*rn,zn);
-		glVertex3f(0.0f,0.0f,z1);
-		glVertex3f(x*radius,y*radius,z0);
+		sink.normal(x*rn,y*rn,zn);
+		sink.vertex(0.0f,0.0f,z1);
+		sink.vertex(x*radius,y*radius,z0);
 		}
-	glEnd();
+	sink.end();
 	}
 
-static void glDrawBox(const GLfloat center[3],const GLfloat halfSize[3],int sideMask)
+static void drawBoxSides(const GLfloat center[3],const GLfloat halfSize[3],int sideMask,GLModelSink& sink)
 	{
 	static const GLfloat vertices[8][3]={{-1.0f,-1.0f,-1.0f},{ 1.0f,-1.0f,-1.0f},{-1.0f, 1.0f,-1.0f},{ 1.0f, 1.0f,-1.0f},
 	                                     {-1.0f,-1.0f, 1.0f},{ 1.0f,-1.0f, 1.0f},{-1.0f, 1.0f, 1.0f},{ 1.0f, 1.0f, 1.0f}};
@@ -448,16 +416,16 @@ static void glDrawBox(const GLfloat center[3],const GLfloat halfSize[3],int side
 	for(int side=0;side<6;++side)
 		if(sideMask&(1<<side))
 			{
-			glNormal3fv(normals[side]);
+			sink.normal(normals[side]);
 			for(int i=0;i<4;++i)
 				{
 				const GLfloat* v=vertices[sides[side][i]];
-				glVertex3f(center[0]+v[0]*halfSize[0],center[1]+v[1]*halfSize[1],center[2]+v[2]*halfSize[2]);
+				sink.vertex(center[0]+v[0]*halfSize[0],center[1]+v[1]*halfSize[1],center[2]+v[2]*halfSize[2]);
 				}
 			}
 	}
 
-void glDrawWireframeCube(GLfloat cubeSize,GLfloat edgeSize,GLfloat vertexSize)
+void glDrawWireframeCube(GLfloat cubeSize,GLfloat edgeSize,GLfloat vertexSize,GLModelSink& sink)
 	{
 	GLfloat cs=cubeSize*0.5f;
 	GLfloat es=edgeSize*0.5f;
@@ -465,7 +433,7 @@ void glDrawWireframeCube(GLfloat cubeSize,GLfloat edgeSize,GLfloat vertexSize)
 	GLfloat halfSize[3];
 	GLfloat center[3];
 	
-	glBegin(GL_QUADS);
+	sink.begin(GL_QUADS);
 	
 	/* Render box vertices: */
 	halfSize[0]=halfSize[1]=halfSize[2]=vs;
@@ -473,7 +441,7 @@ void glDrawWireframeCube(GLfloat cubeSize,GLfloat edgeSize,GLfloat vertexSize)
 		{
 		for(int i=0;i<3;++i)
 			center[i]=vertex&(1<<i)?cs:-cs;
-		glDrawBox(center,halfSize,0x3f);
+		drawBoxSides(center,halfSize,0x3f,sink);
 		}
 	
 	/* Render box edges: */
@@ -486,14 +454,14 @@ void glDrawWireframeCube(GLfloat cubeSize,GLfloat edgeSize,GLfloat vertexSize)
 			center[dim]=0.0f;
 			for(int i=0;i<2;++i)
 				center[(i+dim+1)%3]=edge&(1<<i)?cs:-cs;
-			glDrawBox(center,halfSize,0x3f&~(0x3<<(dim*2)));
+			drawBoxSides(center,halfSize,0x3f&~(0x3<<(dim*2)),sink);
 			}
 		}
 	
-	glEnd();
+	sink.end();
 	}
 
-void glDrawArrow(GLfloat shaftRadius,GLfloat tipRadius,GLfloat tipHeight,GLfloat totalHeight,GLsizei numStrips)
+void glDrawArrow(GLfloat shaftRadius,GLfloat tipRadius,GLfloat tipHeight,GLfloat totalHeight,GLsizei numStrips,GLModelSink& sink)
 	{
 	const GLfloat toRad=GLfloat(2.0*M_PI)/GLfloat(numStrips);
 	
@@ -502,58 +470,184 @@ void glDrawArrow(GLfloat shaftRadius,GLfloat tipRadius,GLfloat tipHeight,GLfloat
 	GLfloat z2=0.5f*totalHeight;
 	
 	/* Draw bottom circle: */
-	glBegin(GL_TRIANGLE_FAN);
-	glNormal3f(0.0f,0.0f,-1.0f);
-	glVertex3f(0.0f,0.0f,z0);
+	sink.begin(GL_TRIANGLE_FAN);
+	sink.normal(0.0f,0.0f,-1.0f);
+	sink.vertex(0.0f,0.0f,z0);
 	for(int j=numStrips;j>=0;--j)
 		{
 		GLfloat lng=GLfloat(j)*toRad;
 		GLfloat x=cosf(lng);
 		GLfloat y=sinf(lng);
-		glVertex3f(x*shaftRadius,y*shaftRadius,z0);
+		sink.vertex(x*shaftRadius,y*shaftRadius,z0);
 		}
-	glEnd();
+	sink.end();
 	
 	/* Draw shaft: */
-	glBegin(GL_QUAD_STRIP);
+	sink.begin(GL_QUAD_STRIP);
 	for(int j=0;j<=numStrips;++j)
 		{
 		GLfloat lng=GLfloat(j)*toRad;
 		GLfloat x=cosf(lng);
 		GLfloat y=sinf(lng);
-		glNormal3f(x,y,0.0f);
-		glVertex3f(x*shaftRadius,y*shaftRadius,z1);
-		glVertex3f(x*shaftRadius,y*shaftRadius,z0);
+		sink.normal(x,y,0.0f);
+		sink.vertex(x*shaftRadius,y*shaftRadius,z1);
+		sink.vertex(x*shaftRadius,y*shaftRadius,z0);
 		}
-	glEnd();
+	sink.end();
 	
 	/* Draw tip bottom: */
-	glBegin(GL_QUAD_STRIP);
-	glNormal3f(0.0f,0.0f,-1.0f);
+	sink.begin(GL_QUAD_STRIP);
+	sink.normal(0.0f,0.0f,-1.0f);
 	for(int j=0;j<=numStrips;++j)
 		{
 		GLfloat lng=GLfloat(j)*toRad;
 		GLfloat x=cosf(lng);
 		GLfloat y=sinf(lng);
-		glVertex3f(x*tipRadius,y*tipRadius,z1);
-		glVertex3f(x*shaftRadius,y*shaftRadius,z1);
+		sink.vertex(x*tipRadius,y*tipRadius,z1);
+		sink.vertex(x*shaftRadius,y*shaftRadius,z1);
 		}
-	glEnd();
+	sink.end();
 	
 	/* Draw tip: */
 	GLfloat zn=tipRadius/tipHeight;
 	GLfloat nl=sqrtf(1.0f+zn*zn);
 	GLfloat rn=1.0f/nl;
 	zn*=rn;
-	glBegin(GL_QUAD_STRIP);
+	sink.begin(GL_QUAD_STRIP);
 	for(int j=0;j<=numStrips;++j)
 		{
 		GLfloat lng=GLfloat(j)*toRad;
 		GLfloat x=cosf(lng);
 		GLfloat y=sinf(lng);
-		glNormal3f(x*rn,y*rn,zn);
-		glVertex3f(0.0f,0.0f,z2);
-		glVertex3f(x*tipRadius,y*tipRadius,z1);
+		sink.normal(x*rn,y*rn,zn);
+		sink.vertex(0.0f,0.0f,z2);
+		sink.vertex(x*tipRadius,y*tipRadius,z1);
+		}
+	sink.end();
+	}
+
+/******************************************************
+Functions to render models using OpenGL immediate mode:
+******************************************************/
+
+void glDrawCube(GLfloat size)
+	{
+	GLImmediateModelSink sink;
+	glDrawCube(size,sink);
+	}
+
+void glDrawBox(const GLfloat min[3],const GLfloat max[3])
+	{
+	GLImmediateModelSink sink;
+	glDrawBox(min,max,sink);
+	}
+
+void glDrawSphereMercator(GLfloat radius,GLsizei numStrips,GLsizei numQuads)
+	{
+	GLImmediateModelSink sink;
+	glDrawSphereMercator(radius,numStrips,numQuads,sink);
+	}
+
+void glDrawSphereMercatorWithTexture(GLfloat radius,GLsizei numStrips,GLsizei numQuads)
+	{
+	const GLfloat pi=GLfloat(M_PI);
+	
+	GLfloat texY1=1.0f/GLfloat(numStrips);
+	GLfloat lat1=1.0f*pi/GLfloat(numStrips)-0.5f*pi;
+	GLfloat r1=cosf(lat1);
+	GLfloat z1=sinf(lat1);
+	
+	/* Draw "southern polar cap": */
+	glBegin(GL_TRIANGLE_FAN);
+	glNormal3f(0.0f,0.0f,-1.0f);
+	glTexCoord2f(0.5f,0.0f);
+	glVertex3f(0.0f,0.0f,-radius);
+	for(int j=numQuads;j>=0;--j)
+		{
+		GLfloat texX=GLfloat(j)/GLfloat(numQuads);
+		GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numQuads);
+		GLfloat x1=cosf(lng)*r1;
+		GLfloat y1=sinf(lng)*r1;
+		glNormal3f(x1,y1,z1);
+		glTexCoord2f(texX,texY1);
+		glVertex3f(x1*radius,y1*radius,z1*radius);
+		}
+	glEnd();
+	
+	/* Draw quad strips: */
+	for(int i=2;i<numStrips;++i)
+		{
+		GLfloat r0=r1;
+		GLfloat z0=z1;
+		GLfloat texY0=texY1;
+		texY1=GLfloat(i)/GLfloat(numStrips);
+		lat1=GLfloat(i)*pi/GLfloat(numStrips)-0.5f*pi;
+		r1=cosf(lat1);
+		z1=sinf(lat1);
+		
+		glBegin(GL_QUAD_STRIP);
+		for(int j=0;j<=numQuads;++j)
+			{
+			GLfloat texX=GLfloat(j)/GLfloat(numQuads);
+			GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numQuads);
+			GLfloat x1=cosf(lng)*r1;
+			GLfloat y1=sinf(lng)*r1;
+			glNormal3f(x1,y1,z1);
+			glTexCoord2f(texX,texY1);
+			glVertex3f(x1*radius,y1*radius,z1*radius);
+			GLfloat x0=cosf(lng)*r0;
+			GLfloat y0=sinf(lng)*r0;
+			glNormal3f(x0,y0,z0);
+			glTexCoord2f(texX,texY0);
+			glVertex3f(x0*radius,y0*radius,z0*radius);
+			}
+		glEnd();
+		}
+	
+	/* Draw "northern polar cap": */
+	glBegin(GL_TRIANGLE_FAN);
+	glNormal3f(0.0f,0.0f,1.0f);
+	glTexCoord2f(0.5f,1.0f);
+	glVertex3f(0.0f,0.0f,radius);
+	for(int j=0;j<=numQuads;++j)
+		{
+		GLfloat texX=GLfloat(j)/GLfloat(numQuads);
+		GLfloat lng=GLfloat(j)*(2.0f*pi)/GLfloat(numQuads);
+		GLfloat x1=cosf(lng)*r1;
+		GLfloat y1=sinf(lng)*r1;
+		glNormal3f(x1,y1,z1);
+		glTexCoord2f(texX,texY1);
+		glVertex3f(x1*radius,y1*radius,z1*radius);
 		}
 	glEnd();
 	}
+
+void glDrawSphereIcosahedron(GLfloat radius,GLsizei numStrips)
+	{
+	GLImmediateModelSink sink;
+	glDrawSphereIcosahedron(radius,numStrips,sink);
+	}
+
+void glDrawCylinder(GLfloat radius,GLfloat height,GLsizei numStrips)
+	{
+	GLImmediateModelSink sink;
+	glDrawCylinder(radius,height,numStrips,sink);
+	}
+
+void glDrawCone(GLfloat radius,GLfloat height,GLsizei numStrips)
+	{
+	GLImmediateModelSink sink;
+	glDrawCone(radius,height,numStrips,sink);
+	}
+
+void glDrawWireframeCube(GLfloat cubeSize,GLfloat edgeSize,GLfloat vertexSize)
+	{
+	GLImmediateModelSink sink;
+	glDrawWireframeCube(cubeSize,edgeSize,vertexSize,sink);
+	}
+
+void glDrawArrow(GLfloat shaftRadius,GLfloat tipRadius,GLfloat tipHeight,GLfloat totalHeight,GLsizei numStrips)
+	{
+	GLImmediateModelSink sink;
+	glDrawArrow(shaftRadius,tipRadius,tipHeight,totalHeight,numStrips,sink);
+	}
@@ -1,6 +1,6 @@
 /***********************************************************************
 GLModels - Helper functions to render simple models using OpenGL.
-Copyright (c) 2004-2013 Oliver Kreylos
+Copyright (c) 2004-2021 Oliver Kreylos
 
 This file is part of the OpenGL Support Library (GLSupport).
 
@@ -24,6 +24,38 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <GL/gl.h>
 
+class GLModelSink // Abstract base class for receivers of model geometry generated by the functions below
+	{
+	/* Constructors and destructors: */
+	public:
+	virtual ~GLModelSink(void);
+	
+	/* Methods: */
+	virtual void begin(GLenum primitive) =0; // Starts a new primitive of type GL_TRIANGLE_STRIP, GL_TRIANGLE_FAN, GL_QUADS, or GL_QUAD_STRIP
+	virtual void normal(GLfloat x,GLfloat y,GLfloat z) =0; // Sets the normal vector for subsequent vertices
+	void normal(const GLfloat n[3]) // Ditto
+		{
+		normal(n[0],n[1],n[2]);
+		}
+	virtual void vertex(GLfloat x,GLfloat y,GLfloat z) =0; // Adds a vertex to the current primitive
+	void vertex(const GLfloat v[3]) // Ditto
+		{
+		vertex(v[0],v[1],v[2]);
+		}
+	virtual void end(void) =0; // Finishes the current primitive
+	};
+
+/* Functions to pass model geometry to a model sink: */
+void glDrawCube(GLfloat size,GLModelSink& sink);
+void glDrawBox(const GLfloat min[3],const GLfloat max[3],GLModelSink& sink);
+void glDrawSphereMercator(GLfloat radius,GLsizei numStrips,GLsizei numQuads,GLModelSink& sink);
+void glDrawSphereIcosahedron(GLfloat radius,GLsizei numStrips,GLModelSink& sink);
+void glDrawCylinder(GLfloat radius,GLfloat height,GLsizei numStrips,GLModelSink& sink);
+void glDrawCone(GLfloat radius,GLfloat height,GLsizei numStrips,GLModelSink& sink);
+void glDrawWireframeCube(GLfloat cubeSize,GLfloat edgeSize,GLfloat vertexSize,GLModelSink& sink);
+void glDrawArrow(GLfloat shaftRadius,GLfloat tipRadius,GLfloat tipHeight,GLfloat totalHeight,GLsizei numStrips,GLModelSink& sink);
+
+/* Functions to render models using OpenGL immediate mode: */
 void glDrawCube(GLfloat size);
 void glDrawBox(const GLfloat min[3],const GLfloat max[3]);
 void glDrawSphereMercator(GLfloat radius,GLsizei numStrips,GLsizei numQuads);
@@ -31,21 +31,51 @@ namespace GLMotif {
 Methods of class Event:
 **********************/
 
+void Event::convertToRoot(const Widget* widget) const
+	{
+	/* Check if the world location was already converted into the widget's root coordinate system: */
+	const Widget* root=widget->getRoot();
+	if(root!=cachedRoot)
+		{
+		/* Convert the world location to the root widget's coordinate system, which is shared by all its descendants: */
+		const WidgetManager* manager=root->getManager();
+		WidgetManager::Transformation t=manager->calcWidgetTransformation(root);
+		switch(worldLocationType)
+			{
+			case NONE:
+				break;
+			
+			case POINT:
+				cachedRootPoint=t.inverseTransform(worldLocationPoint);
+				break;
+			
+			case RAY:
+				cachedRootRay=worldLocationRay;
+				cachedRootRay.inverseTransform(t);
+				break;
+			}
+		cachedRoot=root;
+		}
+	}
+
 Event::Event(bool sButtonState)
 	:worldLocationType(NONE),
-	 buttonState(sButtonState),targetWidget(0)
+	 buttonState(sButtonState),targetWidget(0),
+	 cachedRoot(0)
 	{
 	}
 
 Event::Event(const Point& sWorldLocationPoint,bool sButtonState)
 	:worldLocationType(POINT),worldLocationPoint(sWorldLocationPoint),
-	 buttonState(sButtonState),targetWidget(0)
+	 buttonState(sButtonState),targetWidget(0),
+	 cachedRoot(0)
 	{
 	}
 
 Event::Event(const Ray& sWorldLocationRay,bool sButtonState)
 	:worldLocationType(RAY),worldLocationRay(sWorldLocationRay),
-	 buttonState(sButtonState),targetWidget(0)
+	 buttonState(sButtonState),targetWidget(0),
+	 cachedRoot(0)
 	{
 	}
 
@@ -75,8 +105,7 @@ Event::WidgetPoint Event::calcWidgetPoint(const Widget* widget) const
 	else
 		{
 		/* Convert the world location to the widget's coordinate system: */
-		const WidgetManager* manager=widget->getManager();
-		WidgetManager::Transformation t=manager->calcWidgetTransformation(widget);
+		convertToRoot(widget);
 		
 		WidgetPoint result;
 		switch(worldLocationType)
@@ -86,13 +115,11 @@ Event::WidgetPoint Event::calcWidgetPoint(const Widget* widget) const
 				break;
 			
 			case POINT:
-				result.point=t.inverseTransform(worldLocationPoint);
+				result.point=cachedRootPoint;
 				break;
 			
 			case RAY:
-				Ray ray=worldLocationRay;
-				ray.inverseTransform(t);
-				result.lambda=widget->intersectRay(ray,result.point);
+				result.lambda=widget->intersectRay(cachedRootRay,result.point);
 				break;
 			}
 		
@@ -100,4 +127,45 @@ Event::WidgetPoint Event::calcWidgetPoint(const Widget* widget) const
 		}
 	}
 
+bool Event::intersectsBox(const BoundingBox& box) const
+	{
+	switch(worldLocationType)
+		{
+		case POINT:
+			return box.contains(worldLocationPoint);
+		
+		case RAY:
+			{
+			/* Check if the ray enters the box in front of its origin and of the current target widget: */
+			std::pair<Scalar,Scalar> rp=box.getRayParameters(worldLocationRay);
+			return rp.first<=rp.second&&rp.second>=Scalar(0)&&rp.first<widgetPoint.lambda;
+			}
+		
+		default:
+			return true;
+		}
+	}
+
+bool Event::intersectsBox(const Widget* widget,const BoundingBox& box) const
+	{
+	/* Convert the world location to the widget's coordinate system: */
+	convertToRoot(widget);
+	
+	switch(worldLocationType)
+		{
+		case POINT:
+			return box.contains(cachedRootPoint);
+		
+		case RAY:
+			{
+			/* Check if the ray enters the box in front of its origin and of the current target widget: */
+			std::pair<Scalar,Scalar> rp=box.getRayParameters(cachedRootRay);
+			return rp.first<=rp.second&&rp.second>=Scalar(0)&&rp.first<widgetPoint.lambda;
+			}
+		
+		default:
+			return true;
+		}
+	}
+
 }
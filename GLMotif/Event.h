@@ -78,6 +78,12 @@ class Event
 	bool buttonState; // Pointer button state right before the event occured (true=pressed)
 	Widget* targetWidget; // Widget used to calculate widget location; intended recipient of event
 	WidgetPoint widgetPoint; // Widget location of this event
+	mutable const Widget* cachedRoot; // Root widget into whose coordinate system the world location was last converted
+	mutable Point cachedRootPoint; // World location point in the cached root widget's coordinate system
+	mutable Ray cachedRootRay; // World location ray in the cached root widget's coordinate system
+	
+	/* Private methods: */
+	void convertToRoot(const Widget* widget) const; // Converts the world location into the coordinate system of the given widget's root widget unless it is already cached
 	
 	/* Constructors and destructors: */
 	public:
@@ -90,11 +96,13 @@ class Event
 		{
 		worldLocationType=POINT;
 		worldLocationPoint=newWorldLocationPoint;
+		cachedRoot=0;
 		}
 	void setWorldLocation(const Ray& newWorldLocationRay) // Sets the world location to a ray
 		{
 		worldLocationType=RAY;
 		worldLocationRay=newWorldLocationRay;
+		cachedRoot=0;
 		}
 	bool isPressed(void) const // Returns true if the pointer button was pressed right before the event occurred
 		{
@@ -125,6 +133,8 @@ class Event
 		return result;
 		}
 	WidgetPoint calcWidgetPoint(const Widget* widget) const; // Returns event point in widget's coordinate system
+	bool intersectsBox(const BoundingBox& box) const; // Returns false if the event's world location can not hit anything inside the given world-space box, or only behind the current target widget
+	bool intersectsBox(const Widget* widget,const BoundingBox& box) const; // Returns false if the event's location can not hit anything inside the given box in the given widget's coordinate system, or only behind the current target widget
 	};
 
 }
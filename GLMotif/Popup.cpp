@@ -159,6 +159,10 @@ void Popup::resize(const Box& newExterior)
 	
 	/* Resize the parent class widget again to calculate the correct z range: */
 	Container::resize(newExterior);
+	
+	/* Invalidate the cached visual representation and bounding box of the re-laid out widget: */
+	if(manager!=0)
+		manager->updateTopLevelWidget(this);
 	}
 
 void Popup::draw(GLContextData& contextData) const
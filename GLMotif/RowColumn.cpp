@@ -119,13 +119,31 @@ Vector RowColumn::calcGrid(std::vector<GLfloat>& columnWidths,std::vector<GLfloa
 	return result;
 	}
 
+void RowColumn::updateChildBounds(void)
+	{
+	/* Calculate each child's bounding box from its exterior and the z range of its entire subtree: */
+	childBounds.clear();
+	childBounds.reserve(children.size());
+	for(WidgetList::const_iterator chIt=children.begin();chIt!=children.end();++chIt)
+		{
+		const Box& exterior=(*chIt)->getExterior();
+		ZRange zRange=(*chIt)->calcZRange();
+		BoundingBox::Point min(exterior.origin[0],exterior.origin[1],zRange.first);
+		BoundingBox::Point max(exterior.origin[0]+exterior.size[0],exterior.origin[1]+exterior.size[1],zRange.second);
+		childBounds.push_back(BoundingBox(min,max));
+		}
+	
+	childBoundsValid=true;
+	}
+
 RowColumn::RowColumn(const char* sName,Container* sParent,bool sManageChild)
 	:Container(sName,sParent,false),
 	 orientation(VERTICAL),
 	 packing(PACK_TIGHT),
 	 alignment(Alignment::HFILL,Alignment::VFILL),
 	 numMinorWidgets(1),
-	 nextChildIndex(0)
+	 nextChildIndex(0),
+	 childBoundsValid(false)
 	{
 	/* Check if the parent widget is also a RowColumn: */
 	RowColumn* parentRowColumn=dynamic_cast<RowColumn*>(getParent());
@@ -336,6 +354,9 @@ void RowColumn::resize(const Box& newExterior)
 				}
 			}
 		}
+	
+	/* Invalidate the child bounding boxes after moving the children: */
+	childBoundsValid=false;
 	}
 
 void RowColumn::updateVariables(void)
@@ -345,6 +366,15 @@ void RowColumn::updateVariables(void)
 		(*cIt)->updateVariables();
 	}
 
+void RowColumn::update(void)
+	{
+	/* Invalidate the child bounding boxes: */
+	childBoundsValid=false;
+	
+	/* Call the base class method: */
+	Container::update();
+	}
+
 void RowColumn::draw(GLContextData& contextData) const
 	{
 	/* Draw the parent class widget: */
@@ -485,10 +515,15 @@ void RowColumn::draw(GLContextData& contextData) const
 
 bool RowColumn::findRecipient(Event& event)
 	{
-	/* Distribute the question to the child widgets: */
+	/* Recalculate the child bounding boxes if they are outdated: */
+	if(!childBoundsValid)
+		updateChildBounds();
+	
+	/* Distribute the question to all child widgets whose bounding boxes can be hit by the event: */
 	bool childFound=false;
-	for(WidgetList::iterator chIt=children.begin();!childFound&&chIt!=children.end();++chIt)
-		childFound=(*chIt)->findRecipient(event);
+	for(WidgetList::size_type i=0;!childFound&&i<children.size();++i)
+		if(event.intersectsBox(children[i],childBounds[i]))
+			childFound=children[i]->findRecipient(event);
 	
 	/* If no child was found, return ourselves (and ignore any incoming events): */
 	if(childFound)
@@ -508,6 +543,7 @@ void RowColumn::addChild(Widget* newChild)
 	{
 	/* Add the child to the list: */
 	children.insert(children.begin()+nextChildIndex,newChild);
+	childBoundsValid=false;
 	nextChildIndex=GLint(children.size());
 	
 	/* Update the number of rows and columns: */
@@ -543,6 +579,7 @@ void RowColumn::removeChild(Widget* removeChild)
 		{
 		/* Remove the child from the list: */
 		children.erase(chIt);
+		childBoundsValid=false;
 		
 		/* Update the number of rows and columns: */
 		GLint majorPos=GLint(childIndex%numMinorWidgets);
@@ -913,6 +950,7 @@ void RowColumn::removeWidgets(GLint majorDirectionIndex)
 		deleteChild(children[i]);
 		}
 	children.erase(children.begin()+firstIndex,children.begin()+lastIndex);
+	childBoundsValid=false;
 	
 	/* Update the grid descriptor arrays: */
 	switch(orientation)
@@ -71,9 +71,12 @@ class RowColumn:public Container
 	std::vector<GridCell> rows,columns; // Grid cell descriptors
 	WidgetList children; // List of child widgets
 	GLint nextChildIndex; // Index at which to insert the next child into the list
+	std::vector<BoundingBox> childBounds; // Bounding boxes of all child widgets and their descendants, to skip children during event localization
+	bool childBoundsValid; // Flag whether the child bounding boxes are up-to-date
 	
 	/* Protected methods: */
 	Vector calcGrid(std::vector<GLfloat>& columnWidths,std::vector<GLfloat>& rowHeights) const;
+	void updateChildBounds(void); // Recalculates the bounding boxes of all child widgets
 	
 	/* Constructors and destructors: */
 	public:
@@ -85,6 +88,7 @@ class RowColumn:public Container
 	virtual ZRange calcZRange(void) const;
 	virtual void resize(const Box& newExterior);
 	virtual void updateVariables(void);
+	virtual void update(void);
 	virtual void draw(GLContextData& contextData) const;
 	virtual bool findRecipient(Event& event);
 	
@@ -267,6 +267,9 @@ void Texture::initContext(GLContextData& contextData) const
 void Texture::updateTexture(void)
 	{
 	++version;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Texture::setSize(const unsigned int newSize[2])
@@ -356,12 +359,16 @@ void Texture::setRegion(const GLfloat newRegion[4])
 	
 	/* Invalidate the cached region: */
 	++regionVersion;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Texture::setInterpolationMode(GLenum newInterpolationMode)
 	{
 	interpolationMode=newInterpolationMode;
 	++settingsVersion;
+	update();
 	}
 
 void Texture::setMipmapLevel(int newMipmapLevel)
@@ -371,11 +378,13 @@ void Texture::setMipmapLevel(int newMipmapLevel)
 	
 	/* Changing mipmap level also invalidates the texture image: */
 	++version;
+	update();
 	}
 
 void Texture::setIlluminated(bool newIlluminated)
 	{
 	illuminated=newIlluminated;
+	update();
 	}
 
 }
@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <utility>
 #include <Geometry/Point.h>
 #include <Geometry/Ray.h>
+#include <Geometry/Box.h>
 #include <GL/gl.h>
 #include <GL/GLColor.h>
 #include <GL/GLVector.h>
@@ -43,6 +44,7 @@ typedef GLColor<GLfloat,4> Color;
 typedef GLVector<GLfloat,3> Vector;
 typedef GLBox<GLfloat,3> Box;
 typedef std::pair<GLfloat,GLfloat> ZRange;
+typedef Geometry::Box<Scalar,3> BoundingBox; // Type for axis-aligned bounding boxes used to speed up event localization
 
 /****************
 Helper functions:
@@ -268,10 +268,18 @@ void Widget::updateVariables(void)
 
 void Widget::update(void)
 	{
-	if(parent!=0&&isManaged)
+	if(parent!=0)
 		{
 		/* Notify the parent widget of the update: */
-		parent->update();
+		if(isManaged)
+			parent->update();
+		}
+	else
+		{
+		/* Invalidate the cached visual representation and bounding box of this top level widget: */
+		WidgetManager* manager=getManager();
+		if(manager!=0)
+			manager->updateTopLevelWidget(this);
 		}
 	}
 
@@ -23,8 +23,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GLMotif/WidgetManager.h>
 
 #include <string.h>
+#include <utility>
+#include <algorithm>
 #include <Math/Constants.h>
 #include <GL/gl.h>
+#include <GL/GLContextData.h>
 #include <GL/GLLabel.h>
 #include <GL/GLTransformationWrappers.h>
 #include <GLMotif/WidgetArranger.h>
@@ -35,13 +38,29 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 namespace GLMotif {
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+template <class PopupBindingParam>
+inline bool stackingOrderLess(const PopupBindingParam* binding1,const PopupBindingParam* binding2) // Compares two primary bindings by their positions in the stacking order
+	{
+	return binding1->stackingIndex<binding2->stackingIndex;
+	}
+
+}
+
 /********************************************
 Methods of class WidgetManager::PopupBinding:
 ********************************************/
 
 WidgetManager::PopupBinding::PopupBinding(Widget* sTopLevelWidget,const WidgetManager::Transformation& sWidgetToWorld,WidgetManager::PopupBinding* sParent,WidgetManager::PopupBinding* sSucc)
 	:topLevelWidget(sTopLevelWidget),widgetToWorld(sWidgetToWorld),visible(true),
-	 parent(sParent),pred(0),succ(sSucc),firstSecondary(0)
+	 parent(sParent),pred(0),succ(sSucc),firstSecondary(0),
+	 version(1),
+	 bounds(BoundingBox::empty),boundsValid(false),stackingIndex(0)
 	{
 	}
 
@@ -141,7 +160,76 @@ WidgetManager::PopupBinding* WidgetManager::PopupBinding::findTopLevelWidget(con
 	return foundBinding;
 	}
 
-void WidgetManager::PopupBinding::draw(bool overlayWidgets,GLContextData& contextData) const
+void WidgetManager::PopupBinding::addBounds(const WidgetManager::Transformation& parentToWorld,BoundingBox& box) const
+	{
+	/* Calculate the transformation from the top level widget's coordinates to world coordinates: */
+	Transformation widgetTransform=parentToWorld;
+	widgetTransform*=widgetToWorld;
+	
+	/* Calculate the top level widget's bounding box from its exterior and the z range of its entire widget tree: */
+	const Box& exterior=topLevelWidget->getExterior();
+	ZRange zRange=topLevelWidget->calcZRange();
+	BoundingBox widgetBox(BoundingBox::Point(exterior.origin[0],exterior.origin[1],zRange.first),BoundingBox::Point(exterior.origin[0]+exterior.size[0],exterior.origin[1]+exterior.size[1],zRange.second));
+	
+	/* Add the transformed bounding box: */
+	widgetBox.transform(widgetTransform);
+	box.addBox(widgetBox);
+	
+	/* Add the bounding boxes of all secondary top level widgets: */
+	for(const PopupBinding* bPtr=firstSecondary;bPtr!=0;bPtr=bPtr->succ)
+		bPtr->addBounds(widgetTransform,box);
+	}
+
+void WidgetManager::PopupBinding::initContext(GLContextData& contextData) const
+	{
+	/* Create a data item and store it in the OpenGL context: */
+	DataItem* dataItem=new DataItem;
+	contextData.addDataItem(this,dataItem);
+	}
+
+void WidgetManager::PopupBinding::drawTopLevelWidget(bool renderCaching,GLContextData& contextData) const
+	{
+	/* Retrieve the data item if render caching is enabled: */
+	DataItem* dataItem=renderCaching?contextData.retrieveDataItem<DataItem>(this):0;
+	
+	/* Check if the display list's contents are current: */
+	if(dataItem!=0&&dataItem->listVersion==version)
+		{
+		/* Render the geometry stored in the display list: */
+		glCallList(dataItem->displayListId);
+		
+		return;
+		}
+	
+	/*********************************************************************
+	Only cache the visual representation once it was drawn directly
+	without changes, so that any texture uploads triggered by the update
+	are executed once instead of being recorded into the display list,
+	and widgets that change every frame are not re-compiled every frame.
+	*********************************************************************/
+	
+	bool cache=dataItem!=0&&dataItem->drawnVersion==version;
+	if(cache)
+		glNewList(dataItem->displayListId,GL_COMPILE_AND_EXECUTE);
+	
+	/* Draw the top level widget, including its deferred labels: */
+	{
+	GLLabel::DeferredRenderer dr(contextData);
+	topLevelWidget->draw(contextData);
+	dr.draw();
+	}
+	
+	if(cache)
+		{
+		/* Finish caching the visual representation and mark the display list as up-to-date: */
+		glEndList();
+		dataItem->listVersion=version;
+		}
+	else if(dataItem!=0)
+		dataItem->drawnVersion=version;
+	}
+
+void WidgetManager::PopupBinding::draw(bool overlayWidgets,bool renderCaching,GLContextData& contextData) const
 	{
 	if(visible)
 		{
@@ -152,14 +240,10 @@ void WidgetManager::PopupBinding::draw(bool overlayWidgets,GLContextData& contex
 		
 		/* Draw all its secondary top level widgets: */
 		for(PopupBinding* bPtr=firstSecondary;bPtr!=0;bPtr=bPtr->succ)
-			bPtr->draw(overlayWidgets,contextData);
+			bPtr->draw(overlayWidgets,renderCaching,contextData);
 		
 		/* Draw the top level widget: */
-		{
-		GLLabel::DeferredRenderer dr(contextData);
-		topLevelWidget->draw(contextData);
-		dr.draw();
-		}
+		drawTopLevelWidget(renderCaching,contextData);
 		
 		if(overlayWidgets)
 			{
@@ -170,11 +254,7 @@ void WidgetManager::PopupBinding::draw(bool overlayWidgets,GLContextData& contex
 			GLboolean colorMask[4];
 			glGetBooleanv(GL_COLOR_WRITEMASK,colorMask);
 			glColorMask(GL_FALSE,GL_FALSE,GL_FALSE,GL_FALSE);
-			{
-			GLLabel::DeferredRenderer dr(contextData);
-			topLevelWidget->draw(contextData);
-			dr.draw();
-			}
+			drawTopLevelWidget(renderCaching,contextData);
 			glColorMask(colorMask[0],colorMask[1],colorMask[2],colorMask[3]);
 			glDepthRange(depthRange[0],depthRange[1]);
 			}
@@ -210,6 +290,7 @@ void WidgetManager::popupPrimaryWidgetAt(Widget* topLevelWidget,const WidgetMana
 			firstBinding->pred=newBinding;
 		firstBinding=newBinding;
 		popupBindingMap.setEntry(PopupBindingMap::Entry(topLevelWidget,newBinding));
+		bvhValid=false;
 		
 		{
 		/* Call the pop-up callbacks: */
@@ -246,6 +327,166 @@ void WidgetManager::moveSecondaryWidgets(WidgetManager::PopupBinding* parent,con
 		}
 	}
 
+void WidgetManager::invalidateBounds(WidgetManager::PopupBinding* binding)
+	{
+	/* Find the primary binding: */
+	while(binding->parent!=0)
+		binding=binding->parent;
+	
+	/* Invalidate its bounding box: */
+	binding->boundsValid=false;
+	bvhBoundsValid=false;
+	}
+
+unsigned int WidgetManager::buildBVH(unsigned int first,unsigned int numBindings)
+	{
+	/* Create a new node: */
+	unsigned int nodeIndex=bvhNodes.size();
+	bvhNodes.push_back(BVHNode());
+	
+	/* Calculate the bounding boxes of the range's bindings and of their centers: */
+	BoundingBox bounds=BoundingBox::empty;
+	BoundingBox centerBounds=BoundingBox::empty;
+	for(unsigned int i=first;i<first+numBindings;++i)
+		{
+		bounds.addBox(bvhBindings[i]->bounds);
+		centerBounds.addPoint(Geometry::mid(bvhBindings[i]->bounds.min,bvhBindings[i]->bounds.max));
+		}
+	bvhNodes[nodeIndex].bounds=bounds;
+	
+	if(numBindings<=4)
+		{
+		/* Make a leaf node: */
+		bvhNodes[nodeIndex].first=first;
+		bvhNodes[nodeIndex].numBindings=numBindings;
+		}
+	else
+		{
+		/* Split the range at the median binding center along the widest axis of the center bounding box: */
+		int axis=0;
+		for(int i=1;i<3;++i)
+			if(centerBounds.getSize(axis)<centerBounds.getSize(i))
+				axis=i;
+		std::vector<std::pair<Scalar,PopupBinding*> > keys;
+		keys.reserve(numBindings);
+		for(unsigned int i=first;i<first+numBindings;++i)
+			keys.push_back(std::pair<Scalar,PopupBinding*>(bvhBindings[i]->bounds.min[axis]+bvhBindings[i]->bounds.max[axis],bvhBindings[i]));
+		unsigned int half=numBindings/2;
+		std::nth_element(keys.begin(),keys.begin()+half,keys.end());
+		for(unsigned int i=0;i<numBindings;++i)
+			bvhBindings[first+i]=keys[i].second;
+		
+		/* Make an interior node and create its children: */
+		bvhNodes[nodeIndex].numBindings=0;
+		buildBVH(first,half);
+		unsigned int secondChild=buildBVH(first+half,numBindings-half);
+		bvhNodes[nodeIndex].first=secondChild;
+		}
+	
+	return nodeIndex;
+	}
+
+void WidgetManager::validateBVH(void)
+	{
+	if(!bvhValid)
+		{
+		/* Collect all primary bindings in stacking order and calculate their bounding boxes: */
+		bvhBindings.clear();
+		unsigned int stackingIndex=0;
+		for(PopupBinding* bPtr=firstBinding;bPtr!=0;bPtr=bPtr->succ,++stackingIndex)
+			{
+			bPtr->stackingIndex=stackingIndex;
+			bPtr->bounds=BoundingBox::empty;
+			bPtr->addBounds(Transformation::identity,bPtr->bounds);
+			bPtr->boundsValid=true;
+			bvhBindings.push_back(bPtr);
+			}
+		
+		/* Build a new hierarchy: */
+		bvhNodes.clear();
+		if(!bvhBindings.empty())
+			buildBVH(0,bvhBindings.size());
+		
+		bvhValid=true;
+		bvhBoundsValid=true;
+		stackingOrderValid=true;
+		}
+	
+	if(!stackingOrderValid)
+		{
+		/* Re-number all primary bindings in stacking order: */
+		unsigned int stackingIndex=0;
+		for(PopupBinding* bPtr=firstBinding;bPtr!=0;bPtr=bPtr->succ,++stackingIndex)
+			bPtr->stackingIndex=stackingIndex;
+		
+		stackingOrderValid=true;
+		}
+	
+	if(!bvhBoundsValid)
+		{
+		/* Recalculate all outdated bounding boxes: */
+		for(std::vector<PopupBinding*>::iterator bIt=bvhBindings.begin();bIt!=bvhBindings.end();++bIt)
+			if(!(*bIt)->boundsValid)
+				{
+				(*bIt)->bounds=BoundingBox::empty;
+				(*bIt)->addBounds(Transformation::identity,(*bIt)->bounds);
+				(*bIt)->boundsValid=true;
+				}
+		
+		/* Refit the hierarchy from the leaves up, as children always follow their parents: */
+		for(unsigned int nodeIndex=bvhNodes.size();nodeIndex>0;--nodeIndex)
+			{
+			BVHNode& node=bvhNodes[nodeIndex-1];
+			if(node.numBindings!=0)
+				{
+				node.bounds=BoundingBox::empty;
+				for(unsigned int i=node.first;i<node.first+node.numBindings;++i)
+					node.bounds.addBox(bvhBindings[i]->bounds);
+				}
+			else
+				node.bounds=add(bvhNodes[nodeIndex].bounds,bvhNodes[node.first].bounds);
+			}
+		
+		bvhBoundsValid=true;
+		}
+	}
+
+void WidgetManager::findCandidates(const Event& event,std::vector<WidgetManager::PopupBinding*>& candidates)
+	{
+	/* Bring the hierarchy up-to-date: */
+	validateBVH();
+	
+	/* Traverse the hierarchy and collect the visible bindings of all leaf nodes that can be hit by the event: */
+	candidates.clear();
+	if(bvhNodes.empty())
+		return;
+	unsigned int nodeStack[64];
+	unsigned int stackSize=0;
+	nodeStack[stackSize++]=0;
+	while(stackSize>0)
+		{
+		unsigned int nodeIndex=nodeStack[--stackSize];
+		const BVHNode& node=bvhNodes[nodeIndex];
+		if(event.intersectsBox(node.bounds))
+			{
+			if(node.numBindings!=0)
+				{
+				for(unsigned int i=node.first;i<node.first+node.numBindings;++i)
+					if(bvhBindings[i]->visible)
+						candidates.push_back(bvhBindings[i]);
+				}
+			else
+				{
+				nodeStack[stackSize++]=node.first;
+				nodeStack[stackSize++]=nodeIndex+1;
+				}
+			}
+		}
+	
+	/* Sort the found bindings by stacking order: */
+	std::sort(candidates.begin(),candidates.end(),stackingOrderLess<PopupBinding>);
+	}
+
 void WidgetManager::removeFocusFromChild(Widget* widget)
 	{
 	/* Bail out if there is no text focus widget: */
@@ -301,9 +542,10 @@ void WidgetManager::deleteQueuedWidgets(void)
 
 WidgetManager::WidgetManager(void)
 	:styleSheet(0),arranger(0),textEntryMethod(0),
-	 timerEventScheduler(0),drawOverlayWidgets(false),
+	 timerEventScheduler(0),drawOverlayWidgets(false),renderCaching(false),
 	 widgetAttributeMap(101),
 	 firstBinding(0),popupBindingMap(31),
+	 bvhValid(false),bvhBoundsValid(false),stackingOrderValid(false),
 	 time(0.0),
 	 hardGrab(false),pointerGrabWidget(0),
 	 textFocusWidget(0),
@@ -364,6 +606,23 @@ void WidgetManager::setDrawOverlayWidgets(bool newDrawOverlayWidgets)
 	drawOverlayWidgets=newDrawOverlayWidgets;
 	}
 
+void WidgetManager::setRenderCaching(bool newRenderCaching)
+	{
+	renderCaching=newRenderCaching;
+	}
+
+void WidgetManager::updateTopLevelWidget(const Widget* topLevelWidget)
+	{
+	/* Find the top level widget's popup binding: */
+	PopupBindingMap::Iterator pbIt=popupBindingMap.findEntry(topLevelWidget);
+	if(!pbIt.isFinished())
+		{
+		/* Increment the binding's version number and invalidate its bounding box: */
+		++pbIt->getDest()->version;
+		invalidateBounds(pbIt->getDest());
+		}
+	}
+
 void WidgetManager::unmanageWidget(Widget* widget)
 	{
 	/* Check if the widget has an attribute: */
@@ -409,6 +668,7 @@ void WidgetManager::popupSecondaryWidget(const Widget* owner,Widget* topLevelWid
 				ownerBinding->firstSecondary->pred=newBinding;
 			ownerBinding->firstSecondary=newBinding;
 			popupBindingMap.setEntry(PopupBindingMap::Entry(topLevelWidget,newBinding));
+			bvhValid=false;
 			
 			{
 			/* Call the pop-up callbacks: */
@@ -459,6 +719,7 @@ void WidgetManager::popdownWidget(Widget* widget)
 			binding->succ->pred=binding->pred;
 		delete binding;
 		popupBindingMap.removeEntry(pbmIt);
+		bvhValid=false;
 		}
 	}
 
@@ -501,10 +762,14 @@ bool WidgetManager::isVisible(const Widget* widget) const
 
 Widget* WidgetManager::findPrimaryWidget(const Point& point)
 	{
-	/* Find a recipient for this event amongst all primary bindings: */
+	/* Find all primary bindings whose bounding boxes contain the point: */
+	std::vector<PopupBinding*> candidates;
+	findCandidates(Event(point,false),candidates);
+	
+	/* Find a recipient for this event amongst the found primary bindings: */
 	PopupBinding* foundBinding=0;
-	for(PopupBinding* bPtr=firstBinding;bPtr!=0&&foundBinding==0;bPtr=bPtr->succ)
-		foundBinding=bPtr->findTopLevelWidget(point);
+	for(std::vector<PopupBinding*>::iterator cIt=candidates.begin();cIt!=candidates.end()&&foundBinding==0;++cIt)
+		foundBinding=(*cIt)->findTopLevelWidget(point);
 	
 	/* Bail out if no widget was found: */
 	if(foundBinding==0)
@@ -523,11 +788,15 @@ Widget* WidgetManager::findPrimaryWidget(const Ray& ray,Scalar& lambda)
 	/* Initialize lambda to the invalid value: */
 	lambda=Math::Constants<Scalar>::max;
 	
-	/* Find a recipient for this event amongst all primary bindings: */
+	/* Find all primary bindings whose bounding boxes are intersected by the ray: */
+	std::vector<PopupBinding*> candidates;
+	findCandidates(Event(ray,false),candidates);
+	
+	/* Find a recipient for this event amongst the found primary bindings: */
 	PopupBinding* foundBinding=0;
-	for(PopupBinding* bPtr=firstBinding;bPtr!=0;bPtr=bPtr->succ)
+	for(std::vector<PopupBinding*>::iterator cIt=candidates.begin();cIt!=candidates.end();++cIt)
 		{
-		PopupBinding* fb=bPtr->findTopLevelWidget(ray,lambda);
+		PopupBinding* fb=(*cIt)->findTopLevelWidget(ray,lambda);
 		if(fb!=0)
 			foundBinding=fb;
 		}
@@ -571,6 +840,7 @@ void WidgetManager::setPrimaryWidgetTransformation(Widget* widget,const WidgetMa
 		{
 		/* Adjust and set the binding's widget transformation: */
 		bPtr->widgetToWorld=arranger->calcTopLevelTransform(bPtr->topLevelWidget,newWidgetToWorld);
+		invalidateBounds(bPtr);
 		
 		/* Call the widget move callbacks: */
 		WidgetMoveCallbackData cbData(this,newWidgetToWorld,bPtr->topLevelWidget,true);
@@ -605,7 +875,7 @@ void WidgetManager::draw(GLContextData& contextData) const
 	{
 	/* Traverse all primary top level widgets: */
 	for(const PopupBinding* bPtr=firstBinding;bPtr!=0;bPtr=bPtr->succ)
-		bPtr->draw(drawOverlayWidgets,contextData);
+		bPtr->draw(drawOverlayWidgets,renderCaching,contextData);
 	}
 
 bool WidgetManager::pointerButtonDown(Event& event)
@@ -623,13 +893,18 @@ bool WidgetManager::pointerButtonDown(Event& event)
 	
 	if(pointerGrabWidget==0)
 		{
-		/* Find a recipient for this event amongst the primary top-level windows: */
+		/* Find all visible primary top-level windows whose bounding boxes can be hit by the event: */
+		std::vector<PopupBinding*> candidates;
+		findCandidates(event,candidates);
+		
+		/* Find a recipient for this event amongst the found primary top-level windows: */
 		if(drawOverlayWidgets)
 			{
-			/* Find the first visible top-level widget in the stacking order that is hit by the event: */
-			PopupBinding* bPtr;
-			for(bPtr=firstBinding;bPtr!=0&&!(bPtr->visible&&bPtr->topLevelWidget->findRecipient(event));bPtr=bPtr->succ)
-				;
+			/* Find the first top-level widget in the stacking order that is hit by the event: */
+			PopupBinding* bPtr=0;
+			for(std::vector<PopupBinding*>::iterator cIt=candidates.begin();cIt!=candidates.end()&&bPtr==0;++cIt)
+				if((*cIt)->topLevelWidget->findRecipient(event))
+					bPtr=*cIt;
 			
 			if(bPtr!=0&&bPtr!=firstBinding)
 				{
@@ -641,14 +916,14 @@ bool WidgetManager::pointerButtonDown(Event& event)
 				bPtr->succ=firstBinding;
 				firstBinding->pred=bPtr;
 				firstBinding=bPtr;
+				stackingOrderValid=false;
 				}
 			}
 		else
 			{
-			/* Ask each visible top-level widget to inspect the event to find the closest hit: */
-			for(PopupBinding* bPtr=firstBinding;bPtr!=0;bPtr=bPtr->succ)
-				if(bPtr->visible)
-					bPtr->topLevelWidget->findRecipient(event);
+			/* Ask each found top-level widget to inspect the event to find the closest hit: */
+			for(std::vector<PopupBinding*>::iterator cIt=candidates.begin();cIt!=candidates.end();++cIt)
+				(*cIt)->topLevelWidget->findRecipient(event);
 			}
 		}
 	
@@ -706,20 +981,22 @@ bool WidgetManager::pointerMotion(Event& event)
 	
 	if(pointerGrabWidget==0)
 		{
-		/* Find a recipient for this event amongst the primary top-level windows: */
+		/* Find all visible primary top-level windows whose bounding boxes can be hit by the event: */
+		std::vector<PopupBinding*> candidates;
+		findCandidates(event,candidates);
+		
+		/* Find a recipient for this event amongst the found primary top-level windows: */
 		if(drawOverlayWidgets)
 			{
-			/* Find the first visible top-level widget in the stacking order that is hit by the event: */
-			PopupBinding* bPtr;
-			for(bPtr=firstBinding;bPtr!=0&&!(bPtr->visible&&bPtr->topLevelWidget->findRecipient(event));bPtr=bPtr->succ)
+			/* Find the first top-level widget in the stacking order that is hit by the event: */
+			for(std::vector<PopupBinding*>::iterator cIt=candidates.begin();cIt!=candidates.end()&&!(*cIt)->topLevelWidget->findRecipient(event);++cIt)
 				;
 			}
 		else
 			{
-			/* Ask each visible top-level widget to inspect the event to find the closest hit: */
-			for(PopupBinding* bPtr=firstBinding;bPtr!=0;bPtr=bPtr->succ)
-				if(bPtr->visible)
-					bPtr->topLevelWidget->findRecipient(event);
+			/* Ask each found top-level widget to inspect the event to find the closest hit: */
+			for(std::vector<PopupBinding*>::iterator cIt=candidates.begin();cIt!=candidates.end();++cIt)
+				(*cIt)->topLevelWidget->findRecipient(event);
 			}
 		}
 	
@@ -882,10 +1159,11 @@ bool WidgetManager::textControl(Event& event,const TextControlEvent& textControl
 		}
 	else
 		{
-		/* Find a recipient for this event amongst the primary top-level windows: */
-		for(PopupBinding* bPtr=firstBinding;bPtr!=0;bPtr=bPtr->succ)
-			if(bPtr->visible)
-				bPtr->topLevelWidget->findRecipient(event);
+		/* Find a recipient for this event amongst the visible primary top-level windows whose bounding boxes can be hit by the event: */
+		std::vector<PopupBinding*> candidates;
+		findCandidates(event,candidates);
+		for(std::vector<PopupBinding*>::iterator cIt=candidates.begin();cIt!=candidates.end();++cIt)
+			(*cIt)->topLevelWidget->findRecipient(event);
 		
 		if(event.getTargetWidget()!=0)
 			{
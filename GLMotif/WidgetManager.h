@@ -29,6 +29,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/HashTable.h>
 #include <Misc/ThrowStdErr.h>
 #include <Geometry/OrthogonalTransformation.h>
+#include <GL/gl.h>
+#include <GL/GLObject.h>
 #include <GLMotif/Types.h>
 #include <GLMotif/WidgetAttribute.h>
 
@@ -99,10 +101,30 @@ class WidgetManager
 		};
 	
 	private:
-	struct PopupBinding // Structure to bind top level widgets
+	struct PopupBinding:public GLObject // Structure to bind top level widgets
 		{
-		/* Elements: */
+		/* Embedded classes: */
 		public:
+		struct DataItem:public GLObject::DataItem
+			{
+			/* Elements: */
+			public:
+			GLuint displayListId; // ID of display list caching the rendering of the top level widget
+			unsigned int listVersion; // Version number of the top level widget's visual representation in the display list
+			unsigned int drawnVersion; // Version number of the top level widget's visual representation that was last drawn directly
+			
+			/* Constructors and destructors: */
+			DataItem(void)
+				:displayListId(glGenLists(1)),listVersion(0),drawnVersion(0)
+				{
+				}
+			virtual ~DataItem(void)
+				{
+				glDeleteLists(displayListId,1);
+				}
+			};
+		
+		/* Elements: */
 		Widget* topLevelWidget; // Pointer to top level widget
 		Transformation widgetToWorld; // Transformation from widget to world coordinates or owner widget's coordinates
 		bool visible; // Flag if top level widget should be drawn
@@ -110,21 +132,39 @@ class WidgetManager
 		PopupBinding* pred; // Pointer to previous binding in same hierarchy level
 		PopupBinding* succ; // Pointer to next binding in same hierarchy level
 		PopupBinding* firstSecondary; // Pointer to first secondary top level window
+		unsigned int version; // Version number of the top level widget's visual representation, incremented whenever any of its widgets are updated
+		BoundingBox bounds; // World-space bounding box of the top level widget and all its secondary top level widgets; only maintained for primary bindings
+		bool boundsValid; // Flag whether the bounding box is up-to-date
+		unsigned int stackingIndex; // Position of a primary binding in the stacking order
 		
 		/* Constructors and destructors: */
 		PopupBinding(Widget* sTopLevelWidget,const Transformation& sWidgetToWorld,PopupBinding* sParent,PopupBinding* sSucc);
-		~PopupBinding(void);
+		virtual ~PopupBinding(void);
+		
+		/* Methods from GLObject: */
+		virtual void initContext(GLContextData& contextData) const;
 		
 		/* Methods: */
 		const PopupBinding* getSucc(void) const; // Get the successor in a DFS-traversal of bindings
 		PopupBinding* getSucc(void); // Ditto
 		PopupBinding* findTopLevelWidget(const Point& point);
 		PopupBinding* findTopLevelWidget(const Ray& ray,Scalar& lambda);
-		void draw(bool overlayWidgets,GLContextData& contextData) const;
+		void addBounds(const Transformation& parentToWorld,BoundingBox& box) const; // Adds the world-space bounding boxes of the top level widget and all its secondary top level widgets to the given box
+		void drawTopLevelWidget(bool renderCaching,GLContextData& contextData) const; // Draws the top level widget, using or refreshing its cached visual representation if requested
+		void draw(bool overlayWidgets,bool renderCaching,GLContextData& contextData) const;
 		};
 	
 	typedef Misc::HashTable<const Widget*,PopupBinding*> PopupBindingMap; // Type to map top-level widgets to their popup bindings
 	
+	struct BVHNode // Structure for nodes of a bounding volume hierarchy over primary top level widgets
+		{
+		/* Elements: */
+		public:
+		BoundingBox bounds; // Bounding box of all primary bindings below this node
+		unsigned int first; // Index of the first primary binding of a leaf node, or index of the second child of an interior node
+		unsigned int numBindings; // Number of primary bindings in a leaf node, or zero for interior nodes, whose first child immediately follows them
+		};
+	
 	public:
 	class PoppedWidgetIterator // Class to iterate through popped-up widgets
 		{
@@ -132,17 +172,18 @@ class WidgetManager
 		
 		/* Elements: */
 		private:
+		WidgetManager* manager; // Pointer to the widget manager owning the popup binding
 		PopupBinding* bPtr; // Pointer to the widget's popup binding
 		
 		/* Constructors and destructors: */
 		public:
 		PoppedWidgetIterator(void) // Creates an invalid iterator
-			:bPtr(0)
+			:manager(0),bPtr(0)
 			{
 			}
 		private:
-		PoppedWidgetIterator(PopupBinding* sBPtr) // Creates an iterator from a popup binding
-			:bPtr(sBPtr)
+		PoppedWidgetIterator(WidgetManager* sManager,PopupBinding* sBPtr) // Creates an iterator from a popup binding
+			:manager(sManager),bPtr(sBPtr)
 			{
 			}
 		
@@ -175,14 +216,15 @@ class WidgetManager
 		void setWidgetToWorld(const Transformation& newWidgetToWorld) // Sets the top-level widget's transformation
 			{
 			bPtr->widgetToWorld=newWidgetToWorld;
+			manager->invalidateBounds(bPtr);
 			}
 		PoppedWidgetIterator beginSecondaryWidgets(void) const // Returns iterator to first secondary widget
 			{
-			return PoppedWidgetIterator(bPtr->firstSecondary);
+			return PoppedWidgetIterator(manager,bPtr->firstSecondary);
 			}
 		PoppedWidgetIterator endSecondaryWidgets(void) const // Returns iterator after last secondary widget
 			{
-			return PoppedWidgetIterator(0);
+			return PoppedWidgetIterator(manager,0);
 			}
 		PoppedWidgetIterator& operator--(void) // Decrements iterator
 			{
@@ -229,9 +271,15 @@ class WidgetManager
 	TextEntryMethod* textEntryMethod; // Helper object representing methods to generate text events or text control events
 	Misc::TimerEventScheduler* timerEventScheduler; // Pointer to a scheduler for timer events managed by the OS/window system binding layer
 	bool drawOverlayWidgets; // Flag whether widgets are drawn in an overlay layer on top of all other 3D imagery
+	bool renderCaching; // Flag whether the visual representations of top level widgets are cached in display lists between updates; disabled by default
 	WidgetAttributeMap widgetAttributeMap; // Map from widgets to widget attributes
 	PopupBinding* firstBinding; // Pointer to first bound top level widget
 	PopupBindingMap popupBindingMap; // Map from currently popped-up top-level widgets to their popup bindings
+	std::vector<PopupBinding*> bvhBindings; // Primary bindings in the order of the bounding volume hierarchy's leaf nodes
+	std::vector<BVHNode> bvhNodes; // Nodes of the bounding volume hierarchy over primary bindings, starting with the root
+	bool bvhValid; // Flag whether the hierarchy's structure matches the current set of primary bindings
+	bool bvhBoundsValid; // Flag whether the bounding boxes of all primary bindings and hierarchy nodes are up-to-date
+	bool stackingOrderValid; // Flag whether the stacking indices of all primary bindings are up-to-date
 	double time; // The time reported to widgets
 	bool hardGrab; // Flag if the current pointer grab is a hard one
 	Widget* pointerGrabWidget; // Pointer to the widget grabbing the input
@@ -249,6 +297,10 @@ class WidgetManager
 	PopupBinding* getRootBinding(const Widget* widget); // Ditto
 	void popupPrimaryWidgetAt(Widget* topLevelWidget,const Transformation& widgetToWorld); // Pops up a primary top level widget using the given widget transformation
 	void moveSecondaryWidgets(PopupBinding* parent,const Transformation& parentTransform); // Calls move callbacks for all secondary widgets belonging to the given parent
+	void invalidateBounds(PopupBinding* binding); // Invalidates the bounding box of the primary binding containing the given binding
+	unsigned int buildBVH(unsigned int first,unsigned int numBindings); // Recursively builds a bounding volume hierarchy over the given range of primary bindings; returns the index of the range's node
+	void validateBVH(void); // Brings the bounding volume hierarchy up-to-date with the current primary bindings
+	void findCandidates(const Event& event,std::vector<PopupBinding*>& candidates); // Returns all visible primary bindings whose bounding boxes can be hit by the given event, in stacking order
 	void removeFocusFromChild(Widget* widget); // Removes the text focus from the given widget or any of its children
 	void deleteWidgetImmediately(Widget* widget); // Immediately deletes the given widget and removes and locks or holds
 	void deleteQueuedWidgets(void); // Deletes all widgets in the deletion list
@@ -288,6 +340,12 @@ class WidgetManager
 		{
 		return drawOverlayWidgets;
 		}
+	void setRenderCaching(bool newRenderCaching); // Sets whether the visual representations of top level widgets are cached between updates
+	bool getRenderCaching(void) const // Returns the current setting of the render caching flag
+		{
+		return renderCaching;
+		}
+	void updateTopLevelWidget(const Widget* topLevelWidget); // Invalidates the cached visual representation and bounding box of the given top level widget; called from Widget::update and whenever a top level widget is re-laid out
 	void unmanageWidget(Widget* widget); // Tells the widget manager that the given widget is about to be destroyed; only called from Widget's destructor
 	template <class AttributeParam>
 	void setWidgetAttribute(const Widget* widget,const AttributeParam& attribute) // Associates an attribute of arbitrary type with a widget; deletes previous attribute
@@ -334,11 +392,11 @@ class WidgetManager
 	void popdownWidget(Widget* widget); // Pops down the top level widget containing the given widget
 	PoppedWidgetIterator beginPrimaryWidgets(void) // Returns iterator to first primary widget
 		{
-		return PoppedWidgetIterator(firstBinding);
+		return PoppedWidgetIterator(this,firstBinding);
 		}
 	PoppedWidgetIterator endPrimaryWidgets(void) // Returns iterator after last primary widget
 		{
-		return PoppedWidgetIterator(0);
+		return PoppedWidgetIterator(this,0);
 		}
 	void show(Widget* widget); // Shows the top level widget containing the given widget
 	void hide(Widget* widget); // Hides the top level widget containing the given widget
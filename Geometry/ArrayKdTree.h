@@ -25,6 +25,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef GEOMETRY_ARRAYKDTREE_INCLUDED
 #define GEOMETRY_ARRAYKDTREE_INCLUDED
 
+#include <Threads/Atomic.h>
 #include <Geometry/Point.h>
 #include <Geometry/Box.h>
 #include <Geometry/ClosePointSet.h>
@@ -61,6 +62,26 @@ class ArrayKdTree
 			}
 		};
 	
+	struct BatchQueryArgs // Structure to hold arguments for batch query threads
+		{
+		/* Elements: */
+		public:
+		const ArrayKdTree* tree; // The kd-tree to query
+		int numQueries; // Number of queries in the batch
+		const Point* queryPositions; // Array of query positions
+		const StoredPoint** closestPoints; // Array receiving the closest point for each query, or null
+		ClosePointSet* closestPointSets; // Array receiving the set of closest points for each query, or null
+		Threads::Atomic<int> nextQuery; // Index of the first query in the next unclaimed block of queries
+		
+		/* Constructors and destructors: */
+		BatchQueryArgs(const ArrayKdTree* sTree,int sNumQueries,const Point* sQueryPositions,const StoredPoint** sClosestPoints,ClosePointSet* sClosestPointSets)
+			:tree(sTree),numQueries(sNumQueries),queryPositions(sQueryPositions),
+			 closestPoints(sClosestPoints),closestPointSets(sClosestPointSets),
+			 nextQuery(0)
+			{
+			}
+		};
+	
 	/* Elements: */
 	private:
 	int numNodes; // Total number of nodes in kd-tree
@@ -70,6 +91,8 @@ class ArrayKdTree
 	void createTree(int left,int right,int splitDimension); // Creates sub-kd-tree
 	void* createTreeThreaded(const CreateSubTreeArgs* args); // Creates sub-kd-tree using multiple threads
 	void checkTree(int left,int right,int splitDimension,Scalar bbMin[],Scalar bbMax[]) const; // Checks if kd-tree has correct structure
+	static void* batchQueryThread(BatchQueryArgs* args); // Answers blocks of queries from a query batch until all queries are answered
+	void batchQuery(BatchQueryArgs& args,int numThreads) const; // Answers a batch of queries using multiple threads
 	template <class TraversalFunctionParam>
 	void traverseTree(int left,int right,TraversalFunctionParam& traversalFunction) const // Traverses sub-kd-tree in prefix order and calls traversal function for each node
 		{
@@ -174,6 +197,8 @@ class ArrayKdTree
 	const StoredPoint& findClosePoint(const Point& queryPosition) const; // Returns a stored point that is close to the query position
 	const StoredPoint& findClosestPoint(const Point& queryPosition) const; // Returns the stored point closest to the query position
 	ClosePointSet& findClosestPoints(const Point& queryPosition,ClosePointSet& closestPoints) const; // Returns a set of closest points
+	void findClosestPoint(int numQueries,const Point queryPositions[],const StoredPoint* closestPoints[],int numThreads) const; // Stores pointers to the stored points closest to each of the given query positions; most efficient if consecutive query positions are close to each other
+	void findClosestPoints(int numQueries,const Point queryPositions[],ClosePointSet closestPointSets[],int numThreads) const; // Fills in the given pre-initialized sets of closest points for each of the given query positions; ditto
 	};
 
 }
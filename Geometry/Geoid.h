@@ -25,6 +25,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef GEOMETRY_GEOID_INCLUDED
 #define GEOMETRY_GEOID_INCLUDED
 
+#include <stddef.h>
 #include <Math/Math.h>
 #include <Math/Constants.h>
 #include <Geometry/Point.h>
@@ -94,6 +95,7 @@ class Geoid
 		double chi=Math::sqrt(1.0-e2*sLat*sLat);
 		return Point(Scalar((radius/chi+elev)*cLat*cLon),Scalar((radius/chi+elev)*cLat*sLon),Scalar((radius*(1.0-e2)/chi+elev)*sLat));
 		}
+	void geodeticToCartesian(size_t numPoints,const Point geodetics[],Point cartesians[]) const; // Transforms an array of points; source and destination arrays may be the same
 	Derivative geodeticToCartesianDerivative(const Point& geodeticBase) const; // Returns the derivative of the point transformation at the given base point in geodetic coordinates
 	Orientation geodeticToCartesianOrientation(const Point& geodeticBase) const // Returns a geoid-tangential coordinate orientation at the given base point in geodetic coordinates
 		{
@@ -0,0 +1,235 @@
+/***********************************************************************
+PointHashGrid - Class to store a dynamic set of points with associated
+values in a sparse uniform grid of hashed cells, to efficiently find all
+points inside a query sphere while points are added and removed.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Templatized Geometry Library (TGL).
+
+The Templatized Geometry Library is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Templatized Geometry Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Templatized Geometry Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef GEOMETRY_POINTHASHGRID_INCLUDED
+#define GEOMETRY_POINTHASHGRID_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Misc/HashTable.h>
+#include <Math/Math.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+
+namespace Geometry {
+
+template <class ScalarParam,int dimensionParam,class ValueParam>
+class PointHashGrid
+	{
+	/* Embedded classes: */
+	public:
+	typedef ScalarParam Scalar; // The underlying scalar type
+	static const int dimension=dimensionParam; // The dimension of the grid's affine space
+	typedef Geometry::Point<ScalarParam,dimensionParam> Point; // The type for points
+	typedef ValueParam Value; // Type of values associated with points
+	
+	struct Entry // Structure for a point and its associated value
+		{
+		/* Elements: */
+		public:
+		Point point; // The point's position
+		Value value; // The associated value
+		
+		/* Constructors and destructors: */
+		Entry(const Point& sPoint,const Value& sValue)
+			:point(sPoint),value(sValue)
+			{
+			}
+		};
+	
+	private:
+	struct CellIndex // Structure to identify grid cells
+		{
+		/* Elements: */
+		public:
+		int index[dimensionParam]; // Integer cell coordinates
+		
+		/* Methods: */
+		friend bool operator==(const CellIndex& ci1,const CellIndex& ci2)
+			{
+			for(int i=0;i<dimensionParam;++i)
+				if(ci1.index[i]!=ci2.index[i])
+					return false;
+			return true;
+			}
+		friend bool operator!=(const CellIndex& ci1,const CellIndex& ci2)
+			{
+			for(int i=0;i<dimensionParam;++i)
+				if(ci1.index[i]!=ci2.index[i])
+					return true;
+			return false;
+			}
+		static size_t hash(const CellIndex& source,size_t tableSize)
+			{
+			size_t result=0;
+			for(int i=0;i<dimensionParam;++i)
+				result=result*size_t(2654435761U)+size_t((unsigned int)(source.index[i]));
+			return result%tableSize;
+			}
+		};
+	
+	typedef std::vector<Entry> Cell; // Type for lists of entries in a cell
+	typedef Misc::HashTable<CellIndex,Cell,CellIndex> CellMap; // Type for hash tables mapping cell indices to occupied cells
+	
+	/* Elements: */
+	Scalar cellSize; // Width of the grid's cubical cells
+	CellMap cells; // Map of occupied cells
+	size_t numEntries; // Total number of entries in the grid
+	
+	/* Private methods: */
+	CellIndex getCellIndex(const Point& p) const // Returns the index of the cell containing the given point
+		{
+		CellIndex result;
+		for(int i=0;i<dimensionParam;++i)
+			result.index[i]=int(Math::floor(p[i]/cellSize));
+		return result;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	PointHashGrid(Scalar sCellSize) // Creates an empty grid with the given cell size
+		:cellSize(sCellSize),cells(1021),numEntries(0)
+		{
+		}
+	
+	/* Methods: */
+	Scalar getCellSize(void) const // Returns the grid's cell size
+		{
+		return cellSize;
+		}
+	void setCellSize(Scalar newCellSize) // Sets a new cell size and re-distributes all entries
+		{
+		/* Collect all entries: */
+		std::vector<Entry> entries;
+		entries.reserve(numEntries);
+		for(typename CellMap::Iterator cIt=cells.begin();!cIt.isFinished();++cIt)
+			entries.insert(entries.end(),cIt->getDest().begin(),cIt->getDest().end());
+		
+		/* Re-insert all entries into an empty grid: */
+		cellSize=newCellSize;
+		clear();
+		for(typename std::vector<Entry>::iterator eIt=entries.begin();eIt!=entries.end();++eIt)
+			insert(eIt->point,eIt->value);
+		}
+	size_t getNumEntries(void) const // Returns the total number of entries in the grid
+		{
+		return numEntries;
+		}
+	size_t getNumCells(void) const // Returns the number of occupied grid cells
+		{
+		return cells.getNumEntries();
+		}
+	void clear(void) // Removes all entries from the grid
+		{
+		cells.clear();
+		numEntries=0;
+		}
+	void insert(const Point& point,const Value& value) // Inserts the given point with the given associated value
+		{
+		/* Find the point's cell or create a new cell: */
+		CellIndex ci=getCellIndex(point);
+		typename CellMap::Iterator cIt=cells.findEntry(ci);
+		if(cIt.isFinished())
+			{
+			cells.setEntry(typename CellMap::Entry(ci,Cell()));
+			cIt=cells.findEntry(ci);
+			}
+		
+		/* Append the entry to the cell: */
+		cIt->getDest().push_back(Entry(point,value));
+		++numEntries;
+		}
+	bool remove(const Point& point,const Value& value) // Removes one entry for the given point with the given associated value; returns false if no such entry exists
+		{
+		/* Find the point's cell: */
+		typename CellMap::Iterator cIt=cells.findEntry(getCellIndex(point));
+		if(cIt.isFinished())
+			return false;
+		
+		/* Find the entry in the cell: */
+		Cell& cell=cIt->getDest();
+		for(typename Cell::iterator eIt=cell.begin();eIt!=cell.end();++eIt)
+			if(eIt->value==value&&eIt->point==point)
+				{
+				/* Remove the entry by moving the cell's last entry into its place: */
+				*eIt=cell.back();
+				cell.pop_back();
+				--numEntries;
+				
+				/* Remove the cell if it became empty: */
+				if(cell.empty())
+					cells.removeEntry(cIt);
+				
+				return true;
+				}
+		
+		return false;
+		}
+	template <class FunctorParam>
+	void processPointsInSphere(const Point& center,Scalar radius,FunctorParam& functor) const // Calls functor(entry) for all entries whose points are inside the given sphere
+		{
+		Scalar radius2=Math::sqr(radius);
+		
+		/* Calculate the range of cells overlapped by the sphere's bounding box: */
+		CellIndex min=getCellIndex(center-Geometry::Vector<Scalar,dimensionParam>(radius));
+		CellIndex max=getCellIndex(center+Geometry::Vector<Scalar,dimensionParam>(radius));
+		double numQueryCells=1.0;
+		for(int i=0;i<dimensionParam;++i)
+			numQueryCells*=double(max.index[i]-min.index[i]+1);
+		
+		if(numQueryCells>double(cells.getNumEntries()))
+			{
+			/* Check all occupied cells: */
+			for(typename CellMap::ConstIterator cIt=cells.begin();!cIt.isFinished();++cIt)
+				for(typename Cell::const_iterator eIt=cIt->getDest().begin();eIt!=cIt->getDest().end();++eIt)
+					if(Geometry::sqrDist(eIt->point,center)<=radius2)
+						functor(*eIt);
+			}
+		else
+			{
+			/* Check all cells overlapped by the sphere's bounding box: */
+			CellIndex ci=min;
+			while(true)
+				{
+				typename CellMap::ConstIterator cIt=cells.findEntry(ci);
+				if(!cIt.isFinished())
+					for(typename Cell::const_iterator eIt=cIt->getDest().begin();eIt!=cIt->getDest().end();++eIt)
+						if(Geometry::sqrDist(eIt->point,center)<=radius2)
+							functor(*eIt);
+				
+				/* Go to the next cell: */
+				int i;
+				for(i=0;i<dimensionParam&&ci.index[i]==max.index[i];++i)
+					ci.index[i]=min.index[i];
+				if(i==dimensionParam)
+					break;
+				++ci.index[i];
+				}
+			}
+		}
+	};
+
+}
+
+#endif
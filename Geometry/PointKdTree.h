@@ -24,6 +24,8 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #define GEOMETRY_POINTKDTREE_INCLUDED
 
 #include <Misc/PoolAllocator.h>
+#include <Misc/PriorityHeap.h>
+#include <Threads/Atomic.h>
 #include <Geometry/Point.h>
 #include <Geometry/ClosePointSet.h>
 
@@ -146,9 +148,56 @@ class PointKdTree
 			}
 		};
 	
+	typedef Misc::PriorityHeap<QueueEntry> Queue; // Type for priority queues used by closest point queries
+	
+	struct CreateSubTreeArgs // Structure to hold arguments for subtree creation threads
+		{
+		/* Elements: */
+		public:
+		StoredPoint* points;
+		int left,right;
+		int splitDimension;
+		int numThreads;
+		
+		/* Constructors and destructors: */
+		CreateSubTreeArgs(StoredPoint* sPoints,int sLeft,int sRight,int sSplitDimension,int sNumThreads)
+			:points(sPoints),left(sLeft),right(sRight),splitDimension(sSplitDimension),numThreads(sNumThreads)
+			{
+			}
+		};
+	
+	struct BatchQueryArgs // Structure to hold arguments for batch query threads
+		{
+		/* Elements: */
+		public:
+		const PointKdTree* tree; // The kd-tree to query
+		int numQueries; // Number of queries in the batch
+		const Point* queryPositions; // Array of query positions
+		const StoredPoint** closestPoints; // Array receiving the closest point for each query, or null
+		ClosePointSet* closestPointSets; // Array receiving the set of closest points for each query, or null
+		Threads::Atomic<int> nextQuery; // Index of the first query in the next unclaimed block of queries
+		
+		/* Constructors and destructors: */
+		BatchQueryArgs(const PointKdTree* sTree,int sNumQueries,const Point* sQueryPositions,const StoredPoint** sClosestPoints,ClosePointSet* sClosestPointSets)
+			:tree(sTree),numQueries(sNumQueries),queryPositions(sQueryPositions),
+			 closestPoints(sClosestPoints),closestPointSets(sClosestPointSets),
+			 nextQuery(0)
+			{
+			}
+		};
+	
 	/* Elements: */
 	Node* root; // Pointer to root node
 	
+	/* Private methods: */
+	static void createTree(StoredPoint points[],int left,int right,int splitDimension); // Arranges a sub-array of points in implicit balanced kd-tree order
+	static void* createTreeThreaded(CreateSubTreeArgs* args); // Ditto, using multiple threads
+	static Node* linkTree(StoredPoint points[],int left,int right); // Creates sub-kd-tree nodes for a sub-array of points in implicit balanced kd-tree order
+	const StoredPoint* findClosestPoint(const Point& queryPosition,Queue& queue) const; // Returns the stored point closest to the query position using the given queue
+	ClosePointSet& findClosestPoints(const Point& queryPosition,ClosePointSet& closestPoints,Queue& queue) const; // Returns a set of closest points using the given queue
+	static void* batchQueryThread(BatchQueryArgs* args); // Answers blocks of queries from a query batch until all queries are answered
+	void batchQuery(BatchQueryArgs& args,int numThreads) const; // Answers a batch of queries using multiple threads
+	
 	/* Constructors and destructors: */
 	public:
 	PointKdTree(void) // Creates an empty kd-tree
@@ -162,6 +211,11 @@ class PointKdTree
 		root=new Node(numPoints,points,0,heap);
 		delete[] heap;
 		}
+	PointKdTree(int numPoints,StoredPoint points[],int numThreads) // Ditto, but uses multiple threads
+		:root(0)
+		{
+		setPoints(numPoints,points,numThreads);
+		}
 	~PointKdTree(void)
 		{
 		delete root;
@@ -175,6 +229,7 @@ class PointKdTree
 		root=new Node(numPoints,points,0,heap);
 		delete[] heap;
 		}
+	void setPoints(int numPoints,StoredPoint points[],int numThreads); // Ditto, but uses multiple threads; leaves point array in implicit kd-tree order
 	void insertPoint(const StoredPoint& newPoint) // Inserts a new point into the kd-tree
 		{
 		if(root!=0)
@@ -191,6 +246,16 @@ class PointKdTree
 	const StoredPoint& findClosePoint(const Point& queryPosition) const; // Returns a stored point that is close to the query position
 	const StoredPoint& findClosestPoint(const Point& queryPosition) const; // Returns the stored point closest to the query position
 	ClosePointSet& findClosestPoints(const Point& queryPosition,ClosePointSet& closestPoints) const; // Returns a set of closest points
+	
+	/*********************************************************************
+	Batch queries answer the queries in blocks of consecutive query
+	positions, and are therefore most efficient if consecutive query
+	positions are close to each other, such as the points of a point set
+	in the order left by the multi-threaded setPoints method.
+	*********************************************************************/
+	
+	void findClosestPoint(int numQueries,const Point queryPositions[],const StoredPoint* closestPoints[],int numThreads) const; // Stores pointers to the stored points closest to each of the given query positions
+	void findClosestPoints(int numQueries,const Point queryPositions[],ClosePointSet closestPointSets[],int numThreads) const; // Fills in the given pre-initialized sets of closest points for each of the given query positions
 	};
 
 }
@@ -23,6 +23,8 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef GEOMETRY_POINTOCTREE_INCLUDED
 #define GEOMETRY_POINTOCTREE_INCLUDED
 
+#include <Misc/PriorityHeap.h>
+#include <Threads/Atomic.h>
 #include <Geometry/Vector.h>
 #include <Geometry/Point.h>
 #include <Geometry/ValuedPoint.h>
@@ -76,6 +78,20 @@ class PointOctree
 	
 	struct Node
 		{
+		/* Embedded classes: */
+		private:
+		struct InitializeChildArgs // Structure to hold arguments for child initialization threads
+			{
+			/* Elements: */
+			public:
+			Node* child; // The child node to initialize
+			Traversal traversal; // The child's traversal structure
+			int numPoints; // Number of points in the child's subtree
+			StoredPoint* points; // Sub-array of points in the child's subtree
+			int maxNumPoints,maxDepth;
+			int numThreads; // Number of threads to use for the child's subtree
+			};
+		
 		/* Elements: */
 		public:
 		Node* children; // If node is not a leaf, pointer to array of eight child nodes; 0 otherwise
@@ -85,6 +101,7 @@ class PointOctree
 		/* Helper methods: */
 		private:
 		static int splitPoints(int direction,Scalar mid,int numPoints,StoredPoint* points); // Splits a point array
+		static void* initializeChildThread(InitializeChildArgs* args); // Initializes a child node in a separate thread
 		
 		/* Constructors and destructors: */
 		public:
@@ -98,7 +115,7 @@ class PointOctree
 			}
 		
 		/* Methods: */
-		void initialize(const Traversal& t,int sNumPoints,StoredPoint* sPoints,int maxNumPoints,int maxDepth); // Creates subtree storing the given subarray of points
+		void initialize(const Traversal& t,int sNumPoints,StoredPoint* sPoints,int maxNumPoints,int maxDepth,int numThreads); // Creates subtree storing the given subarray of points using the given number of threads
 		bool isLeaf(void) const // Checks whether a node is a leaf
 			{
 			return children==0;
@@ -132,12 +149,36 @@ class PointOctree
 			}
 		};
 	
+	typedef Misc::PriorityHeap<QueueEntry> Queue; // Type for priority queues used by closest point queries
+	
+	struct BatchQueryArgs // Structure to hold arguments for batch query threads
+		{
+		/* Elements: */
+		public:
+		const PointOctree* tree; // The octree to query
+		int numQueries; // Number of queries in the batch
+		const Point* queryPositions; // Array of query positions
+		const StoredPoint** closestPoints; // Array receiving the closest point for each query
+		Threads::Atomic<int> nextQuery; // Index of the first query in the next unclaimed block of queries
+		
+		/* Constructors and destructors: */
+		BatchQueryArgs(const PointOctree* sTree,int sNumQueries,const Point* sQueryPositions,const StoredPoint** sClosestPoints)
+			:tree(sTree),numQueries(sNumQueries),queryPositions(sQueryPositions),closestPoints(sClosestPoints),
+			 nextQuery(0)
+			{
+			}
+		};
+	
 	/* Elements: */
 	int numPoints; // The number of points in the tree
 	StoredPoint* points; // The array of points in the tree
 	Traversal rootTraversal; // Traversal structure describing the tree's root
 	Node* root; // The root node of the tree
 	
+	/* Private methods: */
+	const StoredPoint* findClosestPoint(const Point& p,Queue& queue) const; // Returns the closest point to the given point using the given queue
+	static void* batchQueryThread(BatchQueryArgs* args); // Answers blocks of queries from a query batch until all queries are answered
+	
 	/* Constructors and destructors: */
 	public:
 	PointOctree(void) // Dummy constructor
@@ -145,16 +186,19 @@ class PointOctree
 		{
 		}
 	PointOctree(const Point& min,const Point& max,int sNumPoints,StoredPoint* sPoints,int maxNumPoints,int maxDepth); // Creates an octree of the given size, containing the given points
+	PointOctree(const Point& min,const Point& max,int sNumPoints,StoredPoint* sPoints,int maxNumPoints,int maxDepth,int numThreads); // Ditto, but uses multiple threads
 	~PointOctree(void);
 	
 	/* Methods: */
 	void clear(void); // Clears the octree
 	void setPoints(const Point& min,const Point& max,int sNumPoints,StoredPoint* sPoints,int maxNumPoints,int maxDepth);
+	void setPoints(const Point& min,const Point& max,int sNumPoints,StoredPoint* sPoints,int maxNumPoints,int maxDepth,int numThreads); // Ditto, but uses multiple threads
 	const StoredPoint& findClosePoint(const Point& p) const // Returns a point "close" to the given point
 		{
 		return *root->findClosePoint(p,rootTraversal);
 		}
 	const StoredPoint& findClosestPoint(const Point& p) const; // Returns the closest point to the given point
+	void findClosestPoint(int numQueries,const Point queryPositions[],const StoredPoint* closestPoints[],int numThreads) const; // Stores pointers to the points closest to each of the given query positions; most efficient if consecutive query positions are close to each other
 	void gatherStatistics(int& numNodes,int& numLeaves,int& maxNumPoints,int& depth) const;
 	};
 
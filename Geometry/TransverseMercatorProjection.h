@@ -112,6 +112,7 @@ class TransverseMercatorProjection:public Geoid<ScalarParam>
 		              Scalar((M-M0+((1.0+((5.0-T+9.0*C+4.0*C*C)+(61.0-58.0*T+T*T+600.0*C-330.0*ep2)*A2/30.0)*A2/12.0)*A2/2.0)*N*sphi/cphi)*k0+offset[1]));
 		}
 	PBox geodeticToMap(const PBox& geodetic) const; // Conservatively converts a 2D bounding box in geodetic space to map space
+	void geodeticToMap(size_t numPoints,const PPoint geodetics[],PPoint maps[]) const; // Converts an array of 2D points in geodetic coordinates to map coordinates; source and destination arrays may be the same
 	PPoint mapToGeodetic(const PPoint& map) const // Converts a 2D point in map coordinates to geodetic (longitude, latitude) coordinates
 		{
 		/*******************************************************************
@@ -140,6 +141,7 @@ class TransverseMercatorProjection:public Geoid<ScalarParam>
 		              Scalar(phi-NbyR*sphi/cphi*(((61.0+(-3.0*C+298.0)*C+(45.0*T+90.0)*T-252.0*ep2)/720.0*D2-(5.0+(-4.0*C+10.0)*C+3.0*T-9.0*ep2)/24.0)*D2+1.0/2.0)*D2));
 		}
 	PBox mapToGeodetic(const PBox& map) const; // Conservatively converts a 2D bounding box in map space to geodetic space
+	void mapToGeodetic(size_t numPoints,const PPoint maps[],PPoint geodetics[]) const; // Converts an array of 2D points in map coordinates to geodetic coordinates; source and destination arrays may be the same
 	
 	/* Map coordinate versions of methods from Geoid: */
 	Point mapToCartesian(const Point& map) const // Converts a 3D point in map coordinates with geodetic vertical datum to geoid-centered geoid-fixed Cartesian coordinates
@@ -137,6 +137,7 @@ class UTMProjection:public Geoid<ScalarParam>
 		#endif
 		}
 	PBox geodeticToMap(const PBox& geodetic) const; // Conservatively converts a 2D bounding box in geodetic space to map space
+	void geodeticToMap(size_t numPoints,const PPoint geodetics[],PPoint maps[]) const; // Converts an array of 2D points in geodetic coordinates to map coordinates; source and destination arrays may be the same
 	PPoint mapToGeodetic(const PPoint& map) const // Converts a 2D point in map coordinates to geodetic (longitude, latitude) coordinates
 		{
 		#if GEOMETRY_UTMPROJECTION_NEWFORMULA
@@ -184,6 +185,7 @@ class UTMProjection:public Geoid<ScalarParam>
 		#endif
 		}
 	PBox mapToGeodetic(const PBox& map) const; // Conservatively converts a 2D bounding box in map space to geodetic space
+	void mapToGeodetic(size_t numPoints,const PPoint maps[],PPoint geodetics[]) const; // Converts an array of 2D points in map coordinates to geodetic coordinates; source and destination arrays may be the same
 	
 	/* Map coordinate versions of methods from Geoid: */
 	Point mapToCartesian(const Point& map) const // Converts a 3D point in map coordinates with geodetic vertical datum to geoid-centered geoid-fixed Cartesian coordinates
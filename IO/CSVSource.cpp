@@ -1,7 +1,7 @@
 /***********************************************************************
 CSVSource - Class to read tabular data from input streams in generalized
 comma-separated value (CSV) format.
-Copyright (c) 2010-2011 Oliver Kreylos
+Copyright (c) 2010-2021 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -24,8 +24,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <ctype.h>
 #include <math.h>
+#include <unistd.h>
 #include <string>
 #include <Misc/ThrowStdErr.h>
+#include <Threads/Thread.h>
 
 namespace IO {
 
@@ -101,34 +103,81 @@ class TypeName<std::string>
 		}
 	};
 
-}
+/**************************************************************
+Helper classes to read characters from files or memory blocks:
+**************************************************************/
 
-/***************************************
-Methods of class CSVSource::FormatError:
-***************************************/
+class FileCharSource // Class to read characters from a file
+	{
+	/* Elements: */
+	private:
+	File& file; // The file
+	
+	/* Constructors and destructors: */
+	public:
+	FileCharSource(File& sFile)
+		:file(sFile)
+		{
+		}
+	
+	/* Methods: */
+	int getChar(void) // Returns the next character, or -1 at end of file
+		{
+		return file.getChar();
+		}
+	};
 
-CSVSource::FormatError::FormatError(unsigned int fieldIndex,size_t recordIndex)
-	:std::runtime_error(Misc::printStdErrMsg("IO::CSVSource::read: Format error in field %u of record %u",fieldIndex,(unsigned int)recordIndex))
+class BufferCharSource // Class to read characters from a contiguous block of memory
 	{
-	}
+	/* Elements: */
+	private:
+	const unsigned char* bufferPtr; // Pointer to the next unread character
+	const unsigned char* bufferEnd; // Pointer to the end of the memory block
+	
+	/* Constructors and destructors: */
+	public:
+	BufferCharSource(const char* sBufferBegin,const char* sBufferEnd)
+		:bufferPtr(reinterpret_cast<const unsigned char*>(sBufferBegin)),
+		 bufferEnd(reinterpret_cast<const unsigned char*>(sBufferEnd))
+		{
+		}
+	
+	/* Methods: */
+	bool eof(void) const // Returns true if the entire memory block was read
+		{
+		return bufferPtr==bufferEnd;
+		}
+	int getChar(void) // Returns the next character, or -1 at the end of the memory block
+		{
+		return bufferPtr!=bufferEnd?int(*(bufferPtr++)):-1;
+		}
+	};
 
-/*******************************************
-Methods of class CSVSource::ConversionError:
-*******************************************/
+/*********************************************************************
+Helper functions to parse fields from files or memory blocks with the
+same semantics:
+*********************************************************************/
 
-CSVSource::ConversionError::ConversionError(unsigned int fieldIndex,size_t recordIndex,const char* dataTypeName)
-	:std::runtime_error(Misc::printStdErrMsg("IO::CSVSource::read: Could not convert field %u of record %u to type %s",fieldIndex,(unsigned int)recordIndex,dataTypeName))
+enum FieldEnd // Enumerated type for the ways in which a field can end
 	{
-	}
+	NextField,NextRecord,BadFieldEnd
+	};
 
-/**************************
-Methods of class CSVSource:
-**************************/
+inline FieldEnd classifyFieldEnd(int nextChar,int fieldSeparator,int recordSeparator)
+	{
+	if(nextChar==fieldSeparator)
+		return NextField;
+	else if(nextChar==recordSeparator||nextChar<0)
+		return NextRecord;
+	else
+		return BadFieldEnd;
+	}
 
-bool CSVSource::skipRestOfField(bool quoted,int nextChar)
+template <class CharSourceParam>
+inline FieldEnd scanRestOfField(CharSourceParam& source,int fieldSeparator,int recordSeparator,int quote,bool quoted,int nextChar,bool& skippedAny) // Skips the rest of a field starting with the given character
 	{
 	/* Keep track if any characters were actually skipped: */
-	bool skippedAny=false;
+	skippedAny=false;
 	
 	if(quoted)
 		{
@@ -143,19 +192,19 @@ bool CSVSource::skipRestOfField(bool quoted,int nextChar)
 			while(nextChar!=quote&&nextChar>=0)
 				{
 				skippedAny=true;
-				nextChar=source->getChar();
+				nextChar=source.getChar();
 				}
 			
 			/* Eof inside quote is a format error: */
 			if(nextChar<0)
-				throw FormatError(fieldIndex,recordIndex);
+				return BadFieldEnd;
 			
 			/* Check for quoted quotes: */
-			nextChar=source->getChar();
+			nextChar=source.getChar();
 			if(nextChar==quote)
 				{
 				skippedAny=true;
-				nextChar=source->getChar();
+				nextChar=source.getChar();
 				}
 			else
 				break;
@@ -171,33 +220,16 @@ bool CSVSource::skipRestOfField(bool quoted,int nextChar)
 		while(nextChar!=fieldSeparator&&nextChar!=recordSeparator&&nextChar>=0&&nextChar!=quote)
 			{
 			skippedAny=true;
-			nextChar=source->getChar();
+			nextChar=source.getChar();
 			}
 		}
 	
 	/* Check the next character: */
-	if(nextChar==fieldSeparator)
-		{
-		/* Start a new field: */
-		++fieldIndex;
-		}
-	else if(nextChar==recordSeparator||nextChar<0)
-		{
-		/* Record separator or eof start a new record: */
-		fieldIndex=0;
-		++recordIndex;
-		}
-	else
-		{
-		/* Signal a format error in the CSV source: */
-		throw FormatError(fieldIndex,recordIndex);
-		}
-	
-	return skippedAny;
+	return classifyFieldEnd(nextChar,fieldSeparator,recordSeparator);
 	}
 
-template <>
-bool CSVSource::convertNumber(int& nextChar,unsigned int& value)
+template <class CharSourceParam>
+inline bool convertNumber(CharSourceParam& source,int& nextChar,unsigned int& value)
 	{
 	/* Signal a conversion error if the next character is not a digit: */
 	if(nextChar<'0'||nextChar>'9')
@@ -205,30 +237,30 @@ bool CSVSource::convertNumber(int& nextChar,unsigned int& value)
 	
 	/* Read the first digit: */
 	value=(unsigned int)(nextChar-'0');
-	nextChar=source->getChar();
+	nextChar=source.getChar();
 	
 	/* Read all following digits: */
 	while(nextChar>='0'&&nextChar<='9')
 		{
 		value=value*10+(unsigned int)(nextChar-'0');
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 		}
 	
 	return true;
 	}
 
-template <>
-bool CSVSource::convertNumber(int& nextChar,int& value)
+template <class CharSourceParam>
+inline bool convertNumber(CharSourceParam& source,int& nextChar,int& value)
 	{
 	/* Check for optional sign: */
 	bool negated=false;
 	if(nextChar=='-')
 		{
 		negated=true;
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 		}
 	else if(nextChar=='+')
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 	
 	/* Signal a conversion error if the next character is not a digit: */
 	if(nextChar<'0'||nextChar>'9')
@@ -236,13 +268,13 @@ bool CSVSource::convertNumber(int& nextChar,int& value)
 	
 	/* Read the first digit: */
 	unsigned int tempValue=(unsigned int)(nextChar-'0');
-	nextChar=source->getChar();
+	nextChar=source.getChar();
 	
 	/* Read all following digits: */
 	while(nextChar>='0'&&nextChar<='9')
 		{
 		tempValue=tempValue*10+(unsigned int)(nextChar-'0');
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 		}
 	
 	/* Calculate the final value: */
@@ -254,18 +286,18 @@ bool CSVSource::convertNumber(int& nextChar,int& value)
 	return true;
 	}
 
-template <>
-bool CSVSource::convertNumber(int& nextChar,double& value)
+template <class CharSourceParam>
+inline bool convertNumber(CharSourceParam& source,int& nextChar,double& value)
 	{
 	/* Check for optional sign: */
 	bool negated=false;
 	if(nextChar=='-')
 		{
 		negated=true;
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 		}
 	else if(nextChar=='+')
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 	
 	/* Keep track if any digits have been read: */
 	bool haveDigit=false;
@@ -276,13 +308,13 @@ bool CSVSource::convertNumber(int& nextChar,double& value)
 		{
 		haveDigit=true;
 		value=value*10.0+double(nextChar-'0');
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 		}
 	
 	/* Check for a period: */
 	if(nextChar=='.')
 		{
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 		
 		/* Read a fractional number part: */
 		double fraction=0.0;
@@ -292,7 +324,7 @@ bool CSVSource::convertNumber(int& nextChar,double& value)
 			haveDigit=true;
 			fraction=fraction*10.0+double(nextChar-'0');
 			fractionBase*=10.0;
-			nextChar=source->getChar();
+			nextChar=source.getChar();
 			}
 		
 		value+=fraction/fractionBase;
@@ -309,17 +341,17 @@ bool CSVSource::convertNumber(int& nextChar,double& value)
 	/* Check for an exponent indicator: */
 	if(nextChar=='e'||nextChar=='E')
 		{
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 		
 		/* Read a plus or minus sign: */
 		bool exponentNegated=false;
 		if(nextChar=='-')
 			{
 			exponentNegated=true;
-			nextChar=source->getChar();
+			nextChar=source.getChar();
 			}
 		else if(nextChar=='+')
-			nextChar=source->getChar();
+			nextChar=source.getChar();
 		
 		/* Signal a conversion error if the next character is not a digit: */
 		if(nextChar<'0'||nextChar>'9')
@@ -327,13 +359,13 @@ bool CSVSource::convertNumber(int& nextChar,double& value)
 		
 		/* Read the first exponent digit: */
 		double exponent=double(nextChar-'0');
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 		
 		/* Read the rest of the exponent digits: */
 		while(nextChar>='0'&&nextChar<='9')
 			{
 			exponent=exponent*10.0+double(nextChar-'0');
-			nextChar=source->getChar();
+			nextChar=source.getChar();
 			}
 		
 		/* Multiply the mantissa with the exponent: */
@@ -345,92 +377,62 @@ bool CSVSource::convertNumber(int& nextChar,double& value)
 	return true;
 	}
 
-template <>
-bool CSVSource::convertNumber(int& nextChar,float& value)
+template <class CharSourceParam>
+inline bool convertNumber(CharSourceParam& source,int& nextChar,float& value)
 	{
 	/* Use the double conversion method internally: */
 	double tempValue;
-	if(!convertNumber<double>(nextChar,tempValue))
+	if(!convertNumber(source,nextChar,tempValue))
 		return false;
 	value=float(tempValue);
 	return true;
 	}
 
-CSVSource::CSVSource(FilePtr sSource)
-	:source(sSource),
-	 fieldSeparator(','),recordSeparator('\n'),quote('\"'),
-	 recordIndex(0),fieldIndex(0)
-	{
-	}
-
-CSVSource::~CSVSource(void)
-	{
-	}
-
-void CSVSource::setFieldSeparator(int newFieldSeparator)
-	{
-	fieldSeparator=newFieldSeparator;
-	}
-
-void CSVSource::setRecordSeparator(int newRecordSeparator)
-	{
-	recordSeparator=newRecordSeparator;
-	}
-
-void CSVSource::setQuote(int newQuote)
-	{
-	quote=newQuote;
-	}
-
-template <class ValueParam>
-ValueParam CSVSource::readField(void)
+template <class CharSourceParam,class ValueParam>
+inline FieldEnd scanNumericField(CharSourceParam& source,int fieldSeparator,int recordSeparator,int quote,ValueParam& value,bool& success) // Reads a numeric field; sets success flag to false if the field contents could not be fully converted
 	{
 	/* Read the field's first character: */
-	int nextChar=source->getChar();
+	int nextChar=source.getChar();
 	
 	/* Check for quote: */
 	bool quoted=false;
 	if(nextChar==quote)
 		{
 		quoted=true;
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 		}
 	
 	/* Skip whitespace: */
 	while(isspace(nextChar)&&nextChar!=fieldSeparator&&nextChar!=recordSeparator&&nextChar>=0)
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 	
 	/* Read the numeric value: */
-	ValueParam result(0);
-	bool success=convertNumber(nextChar,result);
+	value=ValueParam(0);
+	success=convertNumber(source,nextChar,value);
 	
 	/* Skip whitespace: */
 	while(isspace(nextChar)&&nextChar!=fieldSeparator&&nextChar!=recordSeparator&&nextChar>=0)
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 	
 	/* Read until the end of the field, and invalidate the result if any further characters are encountered: */
-	if(skipRestOfField(quoted,nextChar))
-			success=false;
-	
-	/* Check for conversion errors: */
-	if(!success)
-		throw ConversionError(fieldIndex,recordIndex,TypeName<ValueParam>::getName());
+	bool skippedAny;
+	FieldEnd result=scanRestOfField(source,fieldSeparator,recordSeparator,quote,quoted,nextChar,skippedAny);
+	if(skippedAny)
+		success=false;
 	
-	/* Return the result: */
 	return result;
 	}
 
-template <>
-std::string CSVSource::readField(void)
+template <class CharSourceParam>
+inline FieldEnd scanStringField(CharSourceParam& source,int fieldSeparator,int recordSeparator,int quote,std::string& value) // Appends the contents of a string field to the given string
 	{
 	/* Read the field's first character: */
-	int nextChar=source->getChar();
+	int nextChar=source.getChar();
 	
-	std::string result;
 	if(nextChar==quote)
 		{
 		/* Skip the opening quote: */
-		nextChar=source->getChar();
+		nextChar=source.getChar();
 		
 		/********************
 		Read a quoted string:
@@ -442,20 +444,20 @@ std::string CSVSource::readField(void)
 			/* Skip characters until the next quote character or eof: */
 			while(nextChar!=quote&&nextChar>=0)
 				{
-				result.push_back(nextChar);
-				nextChar=source->getChar();
+				value.push_back(nextChar);
+				nextChar=source.getChar();
 				}
 			
 			/* Eof inside quote is a format error: */
 			if(nextChar<0)
-				throw FormatError(fieldIndex,recordIndex);
+				return BadFieldEnd;
 			
 			/* Check for quoted quotes: */
-			nextChar=source->getChar();
+			nextChar=source.getChar();
 			if(nextChar==quote)
 				{
-				result.push_back(nextChar);
-				nextChar=source->getChar();
+				value.push_back(nextChar);
+				nextChar=source.getChar();
 				}
 			else
 				break;
@@ -470,18 +472,205 @@ std::string CSVSource::readField(void)
 		/* Skip characters until the next field separator, record separator, eof, or quote: */
 		while(nextChar!=fieldSeparator&&nextChar!=recordSeparator&&nextChar>=0&&nextChar!=quote)
 			{
-			result.push_back(nextChar);
-			nextChar=source->getChar();
+			value.push_back(nextChar);
+			nextChar=source.getChar();
 			}
 		}
 	
 	/* Check the next character: */
-	if(nextChar==fieldSeparator)
+	return classifyFieldEnd(nextChar,fieldSeparator,recordSeparator);
+	}
+
+template <class CharSourceParam>
+inline FieldEnd scanSkipField(CharSourceParam& source,int fieldSeparator,int recordSeparator,int quote) // Skips an entire field
+	{
+	/* Read the first character: */
+	int nextChar=source.getChar();
+	bool quoted=nextChar==quote;
+	if(quoted)
+		{
+		/* Skip the opening quote: */
+		nextChar=source.getChar();
+		}
+	
+	bool skippedAny;
+	return scanRestOfField(source,fieldSeparator,recordSeparator,quote,quoted,nextChar,skippedAny);
+	}
+
+template <class ValueParam>
+inline void appendValues(std::vector<ValueParam>& dest,std::vector<ValueParam>& source) // Moves the values from the source vector to the end of the destination vector
+	{
+	if(dest.empty())
+		dest.swap(source);
+	else
+		dest.insert(dest.end(),source.begin(),source.end());
+	std::vector<ValueParam>().swap(source);
+	}
+
+}
+
+/***************************************
+Methods of class CSVSource::FormatError:
+***************************************/
+
+CSVSource::FormatError::FormatError(unsigned int fieldIndex,size_t recordIndex)
+	:std::runtime_error(Misc::printStdErrMsg("IO::CSVSource::read: Format error in field %u of record %u",fieldIndex,(unsigned int)recordIndex))
+	{
+	}
+
+/*******************************************
+Methods of class CSVSource::ConversionError:
+*******************************************/
+
+CSVSource::ConversionError::ConversionError(unsigned int fieldIndex,size_t recordIndex,const char* dataTypeName)
+	:std::runtime_error(Misc::printStdErrMsg("IO::CSVSource::read: Could not convert field %u of record %u to type %s",fieldIndex,(unsigned int)recordIndex,dataTypeName))
+	{
+	}
+
+/********************************************
+Declaration of class CSVSource::ChunkParser:
+********************************************/
+
+class CSVSource::ChunkParser
+	{
+	/* Embedded classes: */
+	public:
+	enum ErrorType // Enumerated type for parsing errors
+		{
+		NoError,FormatErrorType,ConversionErrorType
+		};
+	
+	/* Elements: */
+	int fieldSeparator,recordSeparator,quote; // Special characters of the CSV source
+	const char* chunkBegin; // Pointer to the first character of the chunk
+	const char* chunkEnd; // Pointer to the end of the chunk
+	std::vector<Column> columns; // Chunk-local columns receiving the parsed values
+	size_t numRecords; // Number of records parsed from the chunk
+	ErrorType errorType; // Type of the first error encountered in the chunk
+	unsigned int errorFieldIndex; // Index of the field causing the error
+	size_t errorRecordIndex; // Chunk-local index of the record causing the error
+	const char* errorDataTypeName; // Name of the data type for conversion errors
+	
+	/* Methods: */
+	void* parse(void); // Parses all records in the chunk; stops at the first error
+	};
+
+/****************************************
+Methods of class CSVSource::ChunkParser:
+****************************************/
+
+void* CSVSource::ChunkParser::parse(void)
+	{
+	BufferCharSource source(chunkBegin,chunkEnd);
+	size_t numColumns=columns.size();
+	while(!source.eof())
+		{
+		/* Read the record's leading fields into the columns: */
+		FieldEnd fieldEnd=NextField;
+		unsigned int fieldIndex=0;
+		for(size_t columnIndex=0;columnIndex<numColumns;++columnIndex,++fieldIndex)
+			{
+			/* Check if the record ended early: */
+			if(fieldEnd!=NextField)
+				{
+				errorType=FormatErrorType;
+				errorFieldIndex=fieldIndex;
+				errorRecordIndex=numRecords;
+				return 0;
+				}
+			
+			/* Parse the field according to the column's type: */
+			Column& column=columns[columnIndex];
+			bool success=true;
+			switch(column.type)
+				{
+				case SkipColumn:
+					fieldEnd=scanSkipField(source,fieldSeparator,recordSeparator,quote);
+					break;
+				
+				case UnsignedIntColumn:
+					{
+					unsigned int value;
+					fieldEnd=scanNumericField(source,fieldSeparator,recordSeparator,quote,value,success);
+					column.unsignedInts.push_back(value);
+					errorDataTypeName=TypeName<unsigned int>::getName();
+					break;
+					}
+				
+				case IntColumn:
+					{
+					int value;
+					fieldEnd=scanNumericField(source,fieldSeparator,recordSeparator,quote,value,success);
+					column.ints.push_back(value);
+					errorDataTypeName=TypeName<int>::getName();
+					break;
+					}
+				
+				case FloatColumn:
+					{
+					float value;
+					fieldEnd=scanNumericField(source,fieldSeparator,recordSeparator,quote,value,success);
+					column.floats.push_back(value);
+					errorDataTypeName=TypeName<float>::getName();
+					break;
+					}
+				
+				case DoubleColumn:
+					{
+					double value;
+					fieldEnd=scanNumericField(source,fieldSeparator,recordSeparator,quote,value,success);
+					column.doubles.push_back(value);
+					errorDataTypeName=TypeName<double>::getName();
+					break;
+					}
+				
+				case StringColumn:
+					column.strings.push_back(std::string());
+					fieldEnd=scanStringField(source,fieldSeparator,recordSeparator,quote,column.strings.back());
+					break;
+				}
+			
+			/* Check for errors: */
+			if(fieldEnd==BadFieldEnd||!success)
+				{
+				errorType=fieldEnd==BadFieldEnd?FormatErrorType:ConversionErrorType;
+				errorFieldIndex=fieldIndex;
+				errorRecordIndex=numRecords;
+				return 0;
+				}
+			}
+		
+		/* Skip any further fields in the record: */
+		for(;fieldEnd==NextField;++fieldIndex)
+			{
+			fieldEnd=scanSkipField(source,fieldSeparator,recordSeparator,quote);
+			if(fieldEnd==BadFieldEnd)
+				{
+				errorType=FormatErrorType;
+				errorFieldIndex=fieldIndex;
+				errorRecordIndex=numRecords;
+				return 0;
+				}
+			}
+		
+		++numRecords;
+		}
+	
+	return 0;
+	}
+
+/**************************
+Methods of class CSVSource:
+**************************/
+
+void CSVSource::endField(int fieldEnd)
+	{
+	if(fieldEnd==NextField)
 		{
 		/* Start a new field: */
 		++fieldIndex;
 		}
-	else if(nextChar==recordSeparator||nextChar<0)
+	else if(fieldEnd==NextRecord)
 		{
 		/* Record separator or eof start a new record: */
 		fieldIndex=0;
@@ -492,10 +681,209 @@ std::string CSVSource::readField(void)
 		/* Signal a format error in the CSV source: */
 		throw FormatError(fieldIndex,recordIndex);
 		}
+	}
+
+bool CSVSource::skipRestOfField(bool quoted,int nextChar)
+	{
+	/* Skip the rest of the field and advance to the next field: */
+	FileCharSource fileSource(*source);
+	bool skippedAny;
+	endField(scanRestOfField(fileSource,fieldSeparator,recordSeparator,quote,quoted,nextChar,skippedAny));
+	
+	return skippedAny;
+	}
+
+CSVSource::CSVSource(FilePtr sSource)
+	:source(sSource),
+	 fieldSeparator(','),recordSeparator('\n'),quote('\"'),
+	 recordIndex(0),fieldIndex(0)
+	{
+	}
+
+CSVSource::~CSVSource(void)
+	{
+	}
+
+void CSVSource::setFieldSeparator(int newFieldSeparator)
+	{
+	fieldSeparator=newFieldSeparator;
+	}
+
+void CSVSource::setRecordSeparator(int newRecordSeparator)
+	{
+	recordSeparator=newRecordSeparator;
+	}
+
+void CSVSource::setQuote(int newQuote)
+	{
+	quote=newQuote;
+	}
+
+template <class ValueParam>
+ValueParam CSVSource::readField(void)
+	{
+	/* Read the numeric value and advance to the next field: */
+	FileCharSource fileSource(*source);
+	ValueParam result(0);
+	bool success;
+	endField(scanNumericField(fileSource,fieldSeparator,recordSeparator,quote,result,success));
+	
+	/* Check for conversion errors: */
+	if(!success)
+		throw ConversionError(fieldIndex,recordIndex,TypeName<ValueParam>::getName());
+	
+	/* Return the result: */
+	return result;
+	}
+
+template <>
+std::string CSVSource::readField(void)
+	{
+	/* Read the string and advance to the next field: */
+	FileCharSource fileSource(*source);
+	std::string result;
+	endField(scanStringField(fileSource,fieldSeparator,recordSeparator,quote,result));
 	
 	return result;
 	}
 
+size_t CSVSource::readColumns(std::vector<CSVSource::Column>& columns,unsigned int numThreads)
+	{
+	/* Check that the source is at the beginning of a record: */
+	if(fieldIndex!=0)
+		Misc::throwStdErr("IO::CSVSource::readColumns: Not at the beginning of a record");
+	
+	/* Read the rest of the source into memory: */
+	std::vector<char> data;
+	while(true)
+		{
+		void* buffer;
+		size_t readSize=source->readInBuffer(buffer);
+		if(readSize==0)
+			break;
+		const char* bufferBegin=static_cast<const char*>(buffer);
+		data.insert(data.end(),bufferBegin,bufferBegin+readSize);
+		}
+	if(data.empty())
+		return 0;
+	const char* dataBegin=&data[0];
+	const char* dataEnd=dataBegin+data.size();
+	
+	/* Determine the number of chunks to parse in parallel, without creating chunks that are too small to be worth a thread: */
+	if(numThreads==0)
+		{
+		long numCpus=sysconf(_SC_NPROCESSORS_ONLN);
+		numThreads=numCpus>0?(unsigned int)(numCpus):1U;
+		}
+	const size_t minChunkSize=256*1024;
+	if(size_t(numThreads)>data.size()/minChunkSize+1)
+		numThreads=(unsigned int)(data.size()/minChunkSize+1);
+	
+	/* Split the data into chunks at record separators that are not inside quoted fields: */
+	std::vector<const char*> chunkBegins;
+	chunkBegins.push_back(dataBegin);
+	bool inQuote=false;
+	const char* scanPtr=dataBegin;
+	for(unsigned int chunk=1;chunk<numThreads&&scanPtr!=dataEnd;++chunk)
+		{
+		/* Track the quote state up to the chunk's nominal start: */
+		const char* nominalBegin=dataBegin+(data.size()*chunk)/numThreads;
+		for(;scanPtr<nominalBegin;++scanPtr)
+			if(int((unsigned char)(*scanPtr))==quote)
+				inQuote=!inQuote;
+		
+		/* Find the next unquoted record separator: */
+		for(;scanPtr!=dataEnd&&(inQuote||int((unsigned char)(*scanPtr))!=recordSeparator);++scanPtr)
+			if(int((unsigned char)(*scanPtr))==quote)
+				inQuote=!inQuote;
+		
+		/* Start the next chunk after the record separator: */
+		if(scanPtr!=dataEnd&&++scanPtr!=dataEnd)
+			chunkBegins.push_back(scanPtr);
+		}
+	chunkBegins.push_back(dataEnd);
+	size_t numChunks=chunkBegins.size()-1;
+	
+	/* Create one parser per chunk: */
+	std::vector<ChunkParser> parsers(numChunks);
+	for(size_t chunk=0;chunk<numChunks;++chunk)
+		{
+		ChunkParser& parser=parsers[chunk];
+		parser.fieldSeparator=fieldSeparator;
+		parser.recordSeparator=recordSeparator;
+		parser.quote=quote;
+		parser.chunkBegin=chunkBegins[chunk];
+		parser.chunkEnd=chunkBegins[chunk+1];
+		for(std::vector<Column>::iterator cIt=columns.begin();cIt!=columns.end();++cIt)
+			parser.columns.push_back(Column(cIt->type));
+		parser.numRecords=0;
+		parser.errorType=ChunkParser::NoError;
+		parser.errorFieldIndex=0;
+		parser.errorRecordIndex=0;
+		parser.errorDataTypeName=0;
+		}
+	
+	/* Parse all chunks but the first in background threads, and the first chunk in this thread: */
+	Threads::Thread* threads=numChunks>1?new Threads::Thread[numChunks-1]:0;
+	for(size_t chunk=1;chunk<numChunks;++chunk)
+		threads[chunk-1].start(&parsers[chunk],&ChunkParser::parse);
+	parsers[0].parse();
+	for(size_t chunk=1;chunk<numChunks;++chunk)
+		threads[chunk-1].join();
+	delete[] threads;
+	
+	/* Check for errors in chunk order and count the parsed records: */
+	size_t numRecords=0;
+	for(std::vector<ChunkParser>::iterator pIt=parsers.begin();pIt!=parsers.end();++pIt)
+		{
+		if(pIt->errorType==ChunkParser::FormatErrorType)
+			throw FormatError(pIt->errorFieldIndex,recordIndex+numRecords+pIt->errorRecordIndex);
+		else if(pIt->errorType==ChunkParser::ConversionErrorType)
+			throw ConversionError(pIt->errorFieldIndex,recordIndex+numRecords+pIt->errorRecordIndex,pIt->errorDataTypeName);
+		numRecords+=pIt->numRecords;
+		}
+	
+	/* Append the chunks' column values to the result columns: */
+	for(size_t columnIndex=0;columnIndex<columns.size();++columnIndex)
+		{
+		Column& column=columns[columnIndex];
+		for(std::vector<ChunkParser>::iterator pIt=parsers.begin();pIt!=parsers.end();++pIt)
+			{
+			Column& chunkColumn=pIt->columns[columnIndex];
+			switch(column.type)
+				{
+				case SkipColumn:
+					break;
+				
+				case UnsignedIntColumn:
+					appendValues(column.unsignedInts,chunkColumn.unsignedInts);
+					break;
+				
+				case IntColumn:
+					appendValues(column.ints,chunkColumn.ints);
+					break;
+				
+				case FloatColumn:
+					appendValues(column.floats,chunkColumn.floats);
+					break;
+				
+				case DoubleColumn:
+					appendValues(column.doubles,chunkColumn.doubles);
+					break;
+				
+				case StringColumn:
+					appendValues(column.strings,chunkColumn.strings);
+					break;
+				}
+			}
+		}
+	
+	/* Advance the record index: */
+	recordIndex+=numRecords;
+	
+	return numRecords;
+	}
+
 /************************************************************************
 Force instantiation of standard versions of CSVSource::readField methods:
 ************************************************************************/
@@ -1,7 +1,7 @@
 /***********************************************************************
 CSVSource - Class to read tabular data from input streams in generalized
 comma-separated value (CSV) format.
-Copyright (c) 2010-2011 Oliver Kreylos
+Copyright (c) 2010-2021 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -23,6 +23,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef IO_CSVSOURCE_INCLUDED
 #define IO_CSVSOURCE_INCLUDED
 
+#include <stddef.h>
+#include <string>
+#include <vector>
 #include <stdexcept>
 #include <IO/File.h>
 
@@ -46,8 +49,62 @@ class CSVSource
 		ConversionError(unsigned int fieldIndex,size_t recordIndex,const char* dataTypeName);
 		};
 	
-	/* Elements: */
+	enum ColumnType // Enumerated type for data types of columns read in bulk
+		{
+		SkipColumn,UnsignedIntColumn,IntColumn,FloatColumn,DoubleColumn,StringColumn
+		};
+	
+	class Column // Class holding all values of one column read in bulk
+		{
+		friend class CSVSource;
+		
+		/* Elements: */
+		private:
+		ColumnType type; // Data type of the column
+		std::vector<unsigned int> unsignedInts; // Column values if the column type is unsigned int
+		std::vector<int> ints; // Column values if the column type is int
+		std::vector<float> floats; // Column values if the column type is float
+		std::vector<double> doubles; // Column values if the column type is double
+		std::vector<std::string> strings; // Column values if the column type is string
+		
+		/* Constructors and destructors: */
+		public:
+		Column(ColumnType sType) // Creates an empty column of the given type
+			:type(sType)
+			{
+			}
+		
+		/* Methods: */
+		ColumnType getType(void) const // Returns the column's data type
+			{
+			return type;
+			}
+		const std::vector<unsigned int>& getUnsignedInts(void) const // Returns the values of an unsigned int column
+			{
+			return unsignedInts;
+			}
+		const std::vector<int>& getInts(void) const // Returns the values of an int column
+			{
+			return ints;
+			}
+		const std::vector<float>& getFloats(void) const // Returns the values of a float column
+			{
+			return floats;
+			}
+		const std::vector<double>& getDoubles(void) const // Returns the values of a double column
+			{
+			return doubles;
+			}
+		const std::vector<std::string>& getStrings(void) const // Returns the values of a string column
+			{
+			return strings;
+			}
+		};
+	
 	private:
+	class ChunkParser; // Helper class to parse a chunk of records in bulk
+	
+	/* Elements: */
 	FilePtr source; // Data source for CSV source
 	int fieldSeparator; // Character used to separate fields in a record; comma by default
 	int recordSeparator; // Character used to separate records; newline by default
@@ -56,9 +113,8 @@ class CSVSource
 	unsigned int fieldIndex; // Zero-based index of the currently read field; increments before field read returns; resets to zero before field read on the last field in a record returns
 	
 	/* Private methods: */
+	void endField(int fieldEnd); // Advances the field and record indices after a field ended in the given way; throws format error if the end of the field could not be determined reliably
 	bool skipRestOfField(bool quoted,int nextChar); // Skips the rest of the current field starting with the given character; returns true if any characters were skipped; throws format error if the end of the field cannot be determined reliably
-	template <class ValueParam>
-	bool convertNumber(int& nextChar,ValueParam& value); // Converts characters in a field into a numeric value of the given type; returns false on conversion error
 	
 	/* Constructors and destructors: */
 	public:
@@ -129,6 +185,9 @@ class CSVSource
 		}
 	template <class ValueParam>
 	ValueParam readField(void); // Reads the next field as the given data type; throws exception if the field contents cannot be fully converted, or the end of the field cannot be determined reliably
+	
+	/* Bulk reading methods: */
+	size_t readColumns(std::vector<Column>& columns,unsigned int numThreads =0); // Reads all remaining records and appends their leading fields to the given columns, skipping any further fields; parses chunks of records in parallel using the given number of threads, or one per CPU if zero; must be called at the beginning of a record; returns the number of records read; throws exception on the first malformed field
 	};
 
 /**********************************************
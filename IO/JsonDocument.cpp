@@ -0,0 +1,276 @@
+/***********************************************************************
+JsonDocument - Class for read-only JSON entity trees whose values,
+strings, and arrays are all allocated from a single memory arena, to
+parse large JSON files without creating a heap object per entity.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <IO/JsonDocument.h>
+
+#include <string.h>
+#include <string>
+#include <algorithm>
+#include <Misc/ThrowStdErr.h>
+#include <IO/JsonSource.h>
+
+namespace IO {
+
+/******************************************
+Declaration of class JsonDocument::Builder:
+******************************************/
+
+class JsonDocument::Builder:public JsonSource::Handler
+	{
+	/* Elements: */
+	private:
+	JsonDocument& document; // The document being built
+	std::vector<Value> values; // Stack of finished values that have not yet been moved into their parent arrays or objects; object members are stored as pairs of name and value
+	
+	/* Private methods: */
+	void pushValue(ValueType type) // Pushes a new value of the given type onto the stack
+		{
+		Value newValue;
+		newValue.type=type;
+		newValue.size=0;
+		values.push_back(newValue);
+		}
+	void pushString(const std::string& string) // Pushes a new string value with a copy of the given string in the document's arena
+		{
+		char* s=static_cast<char*>(document.allocate(string.size()+1));
+		memcpy(s,string.c_str(),string.size()+1);
+		pushValue(STRING);
+		values.back().size=string.size();
+		values.back().data.string=s;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	Builder(JsonDocument& sDocument)
+		:document(sDocument)
+		{
+		}
+	
+	/* Methods from class JsonSource::Handler: */
+	virtual void null(void)
+		{
+		pushValue(NULLVALUE);
+		}
+	virtual void boolean(bool value)
+		{
+		pushValue(BOOLEAN);
+		values.back().data.boolean=value;
+		}
+	virtual void number(double value)
+		{
+		pushValue(NUMBER);
+		values.back().data.number=value;
+		}
+	virtual void string(const std::string& value)
+		{
+		pushString(value);
+		}
+	virtual void endArray(size_t numItems)
+		{
+		/* Move the array's items from the stack into the arena: */
+		Value* items=static_cast<Value*>(document.allocate(numItems*sizeof(Value)));
+		std::vector<Value>::iterator firstIt=values.end()-numItems;
+		std::copy(firstIt,values.end(),items);
+		values.erase(firstIt,values.end());
+		
+		/* Push the array value: */
+		pushValue(ARRAY);
+		values.back().size=numItems;
+		values.back().data.items=items;
+		}
+	virtual void name(const std::string& name)
+		{
+		pushString(name);
+		}
+	virtual void endObject(size_t numMembers)
+		{
+		/* Move the object's (name, value) pairs from the stack into the arena: */
+		Member* members=static_cast<Member*>(document.allocate(numMembers*sizeof(Member)));
+		std::vector<Value>::iterator firstIt=values.end()-numMembers*2;
+		for(size_t i=0;i<numMembers;++i)
+			{
+			members[i].name=firstIt[i*2];
+			members[i].value=firstIt[i*2+1];
+			}
+		values.erase(firstIt,values.end());
+		
+		/* Push the object value: */
+		pushValue(OBJECT);
+		values.back().size=numMembers;
+		values.back().data.members=members;
+		}
+	
+	/* New methods: */
+	const Value& getRoot(void) const // Returns the root value after a complete entity has been parsed
+		{
+		return values.back();
+		}
+	};
+
+/************************************
+Methods of class JsonDocument::Value:
+************************************/
+
+void JsonDocument::Value::checkType(JsonDocument::ValueType requiredType,const char* methodName) const
+	{
+	if(type!=requiredType)
+		{
+		static const char* typeNames[]={"null","boolean","number","string","array","object"};
+		Misc::throwStdErr("IO::JsonDocument::Value::%s: JSON value is %s, not %s",methodName,typeNames[type],typeNames[requiredType]);
+		}
+	}
+
+bool JsonDocument::Value::getBoolean(void) const
+	{
+	checkType(BOOLEAN,"getBoolean");
+	return data.boolean;
+	}
+
+double JsonDocument::Value::getNumber(void) const
+	{
+	checkType(NUMBER,"getNumber");
+	return data.number;
+	}
+
+const char* JsonDocument::Value::getString(void) const
+	{
+	checkType(STRING,"getString");
+	return data.string;
+	}
+
+size_t JsonDocument::Value::getStringLength(void) const
+	{
+	checkType(STRING,"getStringLength");
+	return size;
+	}
+
+size_t JsonDocument::Value::getNumItems(void) const
+	{
+	checkType(ARRAY,"getNumItems");
+	return size;
+	}
+
+const JsonDocument::Value& JsonDocument::Value::getItem(size_t index) const
+	{
+	checkType(ARRAY,"getItem");
+	return data.items[index];
+	}
+
+size_t JsonDocument::Value::getNumMembers(void) const
+	{
+	checkType(OBJECT,"getNumMembers");
+	return size;
+	}
+
+const JsonDocument::Member& JsonDocument::Value::getMember(size_t index) const
+	{
+	checkType(OBJECT,"getMember");
+	return data.members[index];
+	}
+
+const JsonDocument::Value* JsonDocument::Value::findMember(const char* name) const
+	{
+	checkType(OBJECT,"findMember");
+	
+	/* Compare the given name against all member names in file order: */
+	size_t nameLength=strlen(name);
+	for(size_t i=0;i<size;++i)
+		{
+		const Value& memberName=data.members[i].name;
+		if(memberName.size==nameLength&&memcmp(memberName.data.string,name,nameLength)==0)
+			return &data.members[i].value;
+		}
+	
+	return 0;
+	}
+
+const JsonDocument::Value& JsonDocument::Value::getMember(const char* name) const
+	{
+	const Value* result=findMember(name);
+	if(result==0)
+		Misc::throwStdErr("IO::JsonDocument::Value::getMember: JSON object has no member %s",name);
+	
+	return *result;
+	}
+
+/*****************************
+Methods of class JsonDocument:
+*****************************/
+
+void* JsonDocument::allocate(size_t size)
+	{
+	/* Round the size up to keep all chunks aligned for doubles and pointers: */
+	size=(size+sizeof(double)-1)&~(sizeof(double)-1);
+	
+	/* Give large chunks their own memory blocks to not waste the rest of the current block: */
+	if(size>blockSize/4)
+		{
+		char* block=new char[size];
+		blocks.push_back(block);
+		arenaSize+=size;
+		return block;
+		}
+	
+	/* Start a new memory block if the current one is full: */
+	if(size>blockFree)
+		{
+		blockPtr=new char[blockSize];
+		blocks.push_back(blockPtr);
+		blockFree=blockSize;
+		arenaSize+=blockSize;
+		}
+	
+	/* Carve the chunk from the current memory block: */
+	void* result=blockPtr;
+	blockPtr+=size;
+	blockFree-=size;
+	return result;
+	}
+
+JsonDocument::JsonDocument(JsonSource& source)
+	:blockPtr(0),blockFree(0),arenaSize(0)
+	{
+	try
+		{
+		/* Parse the next entity from the JSON source: */
+		Builder builder(*this);
+		source.parseEntity(builder);
+		root=builder.getRoot();
+		}
+	catch(...)
+		{
+		/* Release the partially built arena and re-throw the exception: */
+		for(std::vector<char*>::iterator bIt=blocks.begin();bIt!=blocks.end();++bIt)
+			delete[] *bIt;
+		throw;
+		}
+	}
+
+JsonDocument::~JsonDocument(void)
+	{
+	/* Release all arena memory blocks: */
+	for(std::vector<char*>::iterator bIt=blocks.begin();bIt!=blocks.end();++bIt)
+		delete[] *bIt;
+	}
+
+}
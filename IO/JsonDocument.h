@@ -0,0 +1,135 @@
+/***********************************************************************
+JsonDocument - Class for read-only JSON entity trees whose values,
+strings, and arrays are all allocated from a single memory arena, to
+parse large JSON files without creating a heap object per entity.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IO_JSONDOCUMENT_INCLUDED
+#define IO_JSONDOCUMENT_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+
+/* Forward declarations: */
+namespace IO {
+class JsonSource;
+}
+
+namespace IO {
+
+class JsonDocument
+	{
+	/* Embedded classes: */
+	private:
+	class Builder; // Class to build a document from parsing events
+	
+	public:
+	enum ValueType // Enumerated type for JSON value types
+		{
+		NULLVALUE,BOOLEAN,NUMBER,STRING,ARRAY,OBJECT
+		};
+	
+	struct Member;
+	
+	class Value // Class for JSON values; values are owned by their document and must not outlive it
+		{
+		friend class JsonDocument::Builder;
+		
+		/* Elements: */
+		private:
+		ValueType type; // The value's type
+		size_t size; // Length of a string value, or number of items or members of an array or object value
+		union
+			{
+			bool boolean;
+			double number;
+			const char* string; // NUL-terminated string in the document's arena
+			const Value* items; // Array of array items in the document's arena
+			const Member* members; // Array of object members in the document's arena
+			} data;
+		
+		/* Private methods: */
+		void checkType(ValueType requiredType,const char* methodName) const; // Throws an exception if the value is not of the required type
+		
+		/* Methods: */
+		public:
+		ValueType getType(void) const // Returns the value's type
+			{
+			return type;
+			}
+		bool isNull(void) const // Returns true if the value is null
+			{
+			return type==NULLVALUE;
+			}
+		bool getBoolean(void) const; // Returns a boolean value; throws exception if value is not a boolean
+		double getNumber(void) const; // Returns a numerical value; throws exception if value is not a number
+		const char* getString(void) const; // Returns a string value as a NUL-terminated string; throws exception if value is not a string
+		size_t getStringLength(void) const; // Returns the length of a string value; throws exception if value is not a string
+		size_t getNumItems(void) const; // Returns the number of items in an array value; throws exception if value is not an array
+		const Value& getItem(size_t index) const; // Returns the array item of the given index; throws exception if value is not an array
+		size_t getNumMembers(void) const; // Returns the number of members of an object value; throws exception if value is not an object
+		const Member& getMember(size_t index) const; // Returns the object member of the given index in file order; throws exception if value is not an object
+		const Value* findMember(const char* name) const; // Returns the value of the first object member of the given name, or null if there is no such member; throws exception if value is not an object
+		const Value& getMember(const char* name) const; // Returns the value of the first object member of the given name; throws exception if value is not an object or there is no such member
+		};
+	
+	struct Member // Structure for (name, value) pairs of object members
+		{
+		/* Elements: */
+		public:
+		Value name; // The member's name as a string value
+		Value value; // The member's value
+		};
+	
+	/* Elements: */
+	private:
+	static const size_t blockSize=65536; // Size of regular arena memory blocks
+	std::vector<char*> blocks; // List of allocated arena memory blocks
+	char* blockPtr; // Pointer to the first unused byte in the current arena memory block
+	size_t blockFree; // Number of unused bytes in the current arena memory block
+	size_t arenaSize; // Total size of all allocated arena memory blocks
+	Value root; // The document's root value
+	
+	/* Private methods: */
+	void* allocate(size_t size); // Allocates a memory chunk of the given size with double alignment from the arena
+	
+	/* Constructors and destructors: */
+	public:
+	JsonDocument(JsonSource& source); // Parses the next entity from the given JSON source into a new document; throws exception at end of file or on syntax error
+	private:
+	JsonDocument(const JsonDocument& source); // Prohibit copy constructor
+	JsonDocument& operator=(const JsonDocument& source); // Prohibit assignment operator
+	public:
+	~JsonDocument(void); // Releases all arena memory
+	
+	/* Methods: */
+	const Value& getRoot(void) const // Returns the document's root value
+		{
+		return root;
+		}
+	size_t getArenaSize(void) const // Returns the total amount of memory allocated for the document's arena
+		{
+		return arenaSize;
+		}
+	};
+
+}
+
+#endif
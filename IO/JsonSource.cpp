@@ -1,6 +1,7 @@
 /***********************************************************************
-JsonSource - Class to retrieve JSON entities from JSON files.
-Copyright (c) 2018-2019 Oliver Kreylos
+JsonSource - Class to retrieve JSON entities from JSON files, either as
+trees of JSON entities or as streams of parsing events.
+Copyright (c) 2018-2021 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -21,11 +22,151 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <IO/JsonSource.h>
 
+#include <string.h>
+#include <vector>
+#include <stdexcept>
 #include <IO/OpenFile.h>
 #include <IO/JsonEntityTypes.h>
 
 namespace IO {
 
+namespace {
+
+/****************************************************************
+Helper class to build trees of JSON entities from parsing events:
+****************************************************************/
+
+class EntityBuilder:public JsonSource::Handler
+	{
+	/* Embedded classes: */
+	private:
+	struct Container // Structure representing an array or object that is currently being parsed
+		{
+		/* Elements: */
+		public:
+		JsonArray* array; // Pointer to the array, or null if the container is an object
+		JsonObject* object; // Pointer to the object, or null if the container is an array
+		};
+	
+	/* Elements: */
+	JsonPointer root; // The root entity of the parsed tree
+	std::vector<Container> containers; // Stack of arrays and objects that are currently being parsed
+	std::vector<std::string> names; // Stack of names of object members whose values are currently being parsed
+	
+	/* Private methods: */
+	void addEntity(JsonEntity* entity) // Adds the given entity to the currently parsed container, or sets it as the root entity
+		{
+		if(containers.empty())
+			root=entity;
+		else if(containers.back().array!=0)
+			containers.back().array->getArray().push_back(entity);
+		else
+			{
+			containers.back().object->getMap()[names.back()]=entity;
+			names.pop_back();
+			}
+		}
+	
+	/* Methods from class JsonSource::Handler: */
+	public:
+	virtual void null(void)
+		{
+		addEntity(0);
+		}
+	virtual void boolean(bool value)
+		{
+		addEntity(new JsonBoolean(value));
+		}
+	virtual void number(double value)
+		{
+		addEntity(new JsonNumber(value));
+		}
+	virtual void string(const std::string& value)
+		{
+		addEntity(new JsonString(value));
+		}
+	virtual void beginArray(void)
+		{
+		Container c;
+		c.array=new JsonArray;
+		c.object=0;
+		addEntity(c.array);
+		containers.push_back(c);
+		}
+	virtual void endArray(size_t numItems)
+		{
+		containers.pop_back();
+		}
+	virtual void beginObject(void)
+		{
+		Container c;
+		c.array=0;
+		c.object=new JsonObject;
+		addEntity(c.object);
+		containers.push_back(c);
+		}
+	virtual void name(const std::string& name)
+		{
+		names.push_back(name);
+		}
+	virtual void endObject(size_t numMembers)
+		{
+		containers.pop_back();
+		}
+	
+	/* New methods: */
+	JsonPointer getRoot(void) const // Returns the root entity of the parsed tree
+		{
+		return root;
+		}
+	};
+
+}
+
+/************************************
+Methods of class JsonSource::Handler:
+************************************/
+
+JsonSource::Handler::~Handler(void)
+	{
+	}
+
+void JsonSource::Handler::null(void)
+	{
+	}
+
+void JsonSource::Handler::boolean(bool value)
+	{
+	}
+
+void JsonSource::Handler::number(double value)
+	{
+	}
+
+void JsonSource::Handler::string(const std::string& value)
+	{
+	}
+
+void JsonSource::Handler::beginArray(void)
+	{
+	}
+
+void JsonSource::Handler::endArray(size_t numItems)
+	{
+	}
+
+void JsonSource::Handler::beginObject(void)
+	{
+	}
+
+void JsonSource::Handler::name(const std::string& name)
+	{
+	}
+
+void JsonSource::Handler::endObject(size_t numMembers)
+	{
+	}
+
 /***************************
 Methods of class JsonSource:
 ***************************/
@@ -58,7 +199,7 @@ JsonSource::JsonSource(FilePtr sFile)
 	file.skipWs();
 	}
 
-JsonPointer JsonSource::parseEntity(void)
+void JsonSource::parseEntity(JsonSource::Handler& handler)
 	{
 	/* Determine the type of the next entity: */
 	switch(file.peekc())
@@ -66,86 +207,101 @@ JsonPointer JsonSource::parseEntity(void)
 		case '"': // String
 			{
 			/* Parse a string: */
-			return new JsonString(file.readString());
+			handler.string(file.readString());
+			break;
 			}
 		
 		case '[': // Array
 			{
 			/* Skip the opening bracket: */
 			file.skipString();
+			handler.beginArray();
 			
-			/* Create a new array entity: */
-			JsonArray* array=new JsonArray;
-			
-			/* Parse array items until the closing bracket: */
-			while(true)
+			size_t numItems=0;
+			if(file.peekc()==']')
 				{
-				/* Parse the next array item: */
-				JsonPointer item=parseEntity();
-				array->getArray().push_back(item);
-				
-				/* Check for comma or closing bracket: */
-				if(file.peekc()==',')
-					{
-					/* Skip the comma: */
-					file.skipString();
-					}
-				else if(file.peekc()==']')
+				/* Skip the closing bracket of an empty array: */
+				file.skipString();
+				}
+			else
+				{
+				/* Parse array items until the closing bracket: */
+				while(true)
 					{
-					/* Skip the closing bracket and end the array: */
-					file.skipString();
-					break;
+					/* Parse the next array item: */
+					parseEntity(handler);
+					++numItems;
+					
+					/* Check for comma or closing bracket: */
+					if(file.peekc()==',')
+						{
+						/* Skip the comma: */
+						file.skipString();
+						}
+					else if(file.peekc()==']')
+						{
+						/* Skip the closing bracket and end the array: */
+						file.skipString();
+						break;
+						}
+					else
+						throw std::runtime_error("JsonSource::parseEntity: Illegal token in array");
 					}
-				else
-					throw std::runtime_error("JsonSource::parseEntity: Illegal token in array");
 				}
 			
-			return array;
+			handler.endArray(numItems);
+			break;
 			}
 		
 		case '{': // Object
 			{
 			/* Skip the opening brace: */
 			file.skipString();
+			handler.beginObject();
 			
-			/* Create a new object entity: */
-			JsonObject* object=new JsonObject;
-			
-			/* Parse (name, value) pairs until the closing brace: */
-			while(true)
+			size_t numMembers=0;
+			if(file.peekc()=='}')
 				{
-				/* Parse the next entity name: */
-				if(file.peekc()!='"')
-					throw std::runtime_error("JsonSource::parseEntity: No name in object item");
-				std::string name=file.readString();
-				
-				/* Check for the colon: */
-				if(!file.isLiteral(':'))
-					throw std::runtime_error("JsonSource::parseEntity: Missing colon in object item");
+				/* Skip the closing brace of an empty object: */
+				file.skipString();
+				}
+			else
+				{
+				/* Parse (name, value) pairs until the closing brace: */
+				while(true)
+					{
+					/* Parse the next entity name: */
+					if(file.peekc()!='"')
+						throw std::runtime_error("JsonSource::parseEntity: No name in object item");
+					handler.name(file.readString());
 				
-				/* Parse the next entity: */
-				JsonPointer entity=parseEntity();
+					/* Check for the colon: */
+					if(!file.isLiteral(':'))
+						throw std::runtime_error("JsonSource::parseEntity: Missing colon in object item");
 				
-				/* Store the association: */
-				object->getMap()[name]=entity;
+					/* Parse the next entity: */
+					parseEntity(handler);
+					++numMembers;
 				
-				/* Check for comma or closing brace: */
-				if(file.peekc()==',')
-					{
-					/* Skip the comma: */
-					file.skipString();
-					}
-				else if(file.peekc()=='}')
-					{
-					/* Skip the closing brace and end the object: */
-					file.skipString();
-					break;
+					/* Check for comma or closing brace: */
+					if(file.peekc()==',')
+						{
+						/* Skip the comma: */
+						file.skipString();
+						}
+					else if(file.peekc()=='}')
+						{
+						/* Skip the closing brace and end the object: */
+						file.skipString();
+						break;
+						}
+					else
+						throw std::runtime_error("JsonSource::parseEntity: Illegal token in object");
 					}
-				else
-					throw std::runtime_error("JsonSource::parseEntity: Illegal token in object");
 				}
 			
-			return object;
+			handler.endObject(numMembers);
+			break;
 			}
 		
 		case 'F': // Boolean literal
@@ -155,11 +311,12 @@ JsonPointer JsonSource::parseEntity(void)
 			{
 			std::string value=file.readString();
 			if(strcasecmp(value.c_str(),"true")==0)
-				return new JsonBoolean(true);
+				handler.boolean(true);
 			else if(strcasecmp(value.c_str(),"false")==0)
-				return new JsonBoolean(false);
+				handler.boolean(false);
 			else
 				throw std::runtime_error("JsonSource::parseEntity: Illegal boolean literal");
+			break;
 			}
 		
 		case 'n': // NULL value
@@ -167,9 +324,10 @@ JsonPointer JsonSource::parseEntity(void)
 			{
 			std::string null=file.readString();
 			if(strcasecmp(null.c_str(),"null")==0)
-				return 0;
+				handler.null();
 			else
 				throw std::runtime_error("JsonSource::parseEntity: Illegal null value");
+			break;
 			}
 		
 		case '+': // Number
@@ -187,8 +345,8 @@ JsonPointer JsonSource::parseEntity(void)
 		case '9':
 			{
 			/* Parse a number: */
-			double number=file.readNumber();
-			return new JsonNumber(number);
+			handler.number(file.readNumber());
+			break;
 			}
 		
 		default:
@@ -196,4 +354,12 @@ JsonPointer JsonSource::parseEntity(void)
 		}
 	}
 
+JsonPointer JsonSource::parseEntity(void)
+	{
+	/* Build a tree of JSON entities from the next entity's parsing events: */
+	EntityBuilder builder;
+	parseEntity(builder);
+	return builder.getRoot();
+	}
+
 }
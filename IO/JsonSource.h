@@ -1,6 +1,7 @@
 /***********************************************************************
-JsonSource - Class to retrieve JSON entities from JSON files.
-Copyright (c) 2018-2019 Oliver Kreylos
+JsonSource - Class to retrieve JSON entities from JSON files, either as
+trees of JSON entities or as streams of parsing events.
+Copyright (c) 2018-2021 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -22,6 +23,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef IO_JSONSOURCE_INCLUDED
 #define IO_JSONSOURCE_INCLUDED
 
+#include <stddef.h>
+#include <string>
 #include <IO/File.h>
 #include <IO/ValueSource.h>
 #include <IO/JsonEntity.h>
@@ -30,6 +33,26 @@ namespace IO {
 
 class JsonSource
 	{
+	/* Embedded classes: */
+	public:
+	class Handler // Base class for receivers of parsing events; default implementations ignore all events
+		{
+		/* Constructors and destructors: */
+		public:
+		virtual ~Handler(void);
+		
+		/* Methods: */
+		virtual void null(void); // Called for a null value
+		virtual void boolean(bool value); // Called for a boolean value
+		virtual void number(double value); // Called for a numerical value
+		virtual void string(const std::string& value); // Called for a string value; string is only valid during the call
+		virtual void beginArray(void); // Called at the beginning of an array; followed by one event sequence for each array item
+		virtual void endArray(size_t numItems); // Called at the end of an array containing the given number of items
+		virtual void beginObject(void); // Called at the beginning of an object; followed by a name event and a value event sequence for each object member
+		virtual void name(const std::string& name); // Called for the name of the following object member; name is only valid during the call
+		virtual void endObject(size_t numMembers); // Called at the end of an object containing the given number of members
+		};
+	
 	/* Elements: */
 	private:
 	IO::ValueSource file; // The underlying JSON file
@@ -44,7 +67,8 @@ class JsonSource
 		{
 		return file.eof();
 		}
-	JsonPointer parseEntity(void); // Parses the next entity from the JSON file; throws exception at end of file or on syntax error
+	void parseEntity(Handler& handler); // Parses the next entity from the JSON file and sends the resulting events to the given handler; throws exception at end of file or on syntax error
+	JsonPointer parseEntity(void); // Parses the next entity from the JSON file into a tree of JSON entities; throws exception at end of file or on syntax error
 	};
 
 }
@@ -25,10 +25,19 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <stddef.h>
 #include <string.h>
+#include <unistd.h>
+#include <vector>
+#include <limits>
 #include <stdexcept>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include <Misc/SizedTypes.h>
+#include <Threads/Atomic.h>
+#include <Threads/Thread.h>
 #include <IO/File.h>
 #include <Math/Math.h>
+#include <Math/Constants.h>
 #include <GL/Extensions/GLEXTFramebufferObject.h>
 
 namespace Images {
@@ -76,384 +85,907 @@ BaseImage::ImageRepresentation::~ImageRepresentation(void)
 
 namespace {
 
+/****************
+Helper constants:
+****************/
+
+const size_t parallelPixelThreshold=262144; // Minimum number of pixels processed by an image operation to split it across threads
+const unsigned int rowBlockSize=8; // Number of consecutive destination rows claimed by a thread at a time
+Threads::Atomic<unsigned int> maxNumThreads(1); // Maximum number of threads used to process large images, shared by all concurrent image operations; 0 uses one thread per CPU
+Threads::Atomic<unsigned int> numHelperThreads(0); // Number of helper threads currently running on behalf of all concurrent image operations
+
 /*******************************************************
-Helper classes and functions for basic image operations:
+Helper classes and functions for row-parallel processing:
 *******************************************************/
 
-template <class ScalarParam>
+struct ResampleWeights // Structure holding filter weights for one dimension of a resampling operation
+	{
+	/* Elements: */
+	public:
+	unsigned int maxNumTaps; // Maximum number of source samples contributing to a destination sample
+	std::vector<unsigned int> firstTaps; // Index of the first source sample contributing to each destination sample
+	std::vector<unsigned int> numTaps; // Number of source samples contributing to each destination sample
+	std::vector<float> weights; // Normalized weights of the contributing source samples, maxNumTaps per destination sample
+	
+	/* Constructors and destructors: */
+	ResampleWeights(unsigned int sourceSize,unsigned int destSize,BaseImage::ResampleFilter filter);
+	};
+
+double evalResampleFilter(BaseImage::ResampleFilter filter,double x) // Evaluates a resampling filter at the given distance from its center
+	{
+	x=Math::abs(x);
+	switch(filter)
+		{
+		case BaseImage::BoxFilter:
+			return x<0.5?1.0:0.0;
+		
+		case BaseImage::BilinearFilter:
+			return x<1.0?1.0-x:0.0;
+		
+		case BaseImage::LanczosFilter:
+			if(x<1.0e-8)
+				return 1.0;
+			else if(x<3.0)
+				{
+				double px=Math::Constants<double>::pi*x;
+				return 3.0*Math::sin(px)*Math::sin(px/3.0)/(px*px);
+				}
+			else
+				return 0.0;
+		
+		default:
+			return 0.0;
+		}
+	}
+
+ResampleWeights::ResampleWeights(unsigned int sourceSize,unsigned int destSize,BaseImage::ResampleFilter filter)
+	{
+	/* Determine the filter's support in source samples, widening the filter when downsampling to avoid aliasing: */
+	double radius=filter==BaseImage::BoxFilter?0.5:filter==BaseImage::BilinearFilter?1.0:3.0;
+	double scale=double(sourceSize)/double(destSize);
+	double filterScale=scale>1.0?scale:1.0;
+	double support=radius*filterScale;
+	maxNumTaps=(unsigned int)(Math::ceil(support*2.0))+1;
+	firstTaps.resize(destSize);
+	numTaps.resize(destSize);
+	weights.resize(size_t(destSize)*size_t(maxNumTaps),0.0f);
+	
+	for(unsigned int i=0;i<destSize;++i)
+		{
+		/* Find the range of source samples covered by the filter centered on the destination sample: */
+		double center=(double(i)+0.5)*scale;
+		int first=int(Math::ceil(center-support-0.5));
+		if(first<0)
+			first=0;
+		int last=int(Math::floor(center+support-0.5));
+		if(last>int(sourceSize)-1)
+			last=int(sourceSize)-1;
+		if(last-first+1>int(maxNumTaps))
+			last=first+int(maxNumTaps)-1;
+		
+		/* Calculate the weights of all covered samples: */
+		float* w=&weights[size_t(i)*size_t(maxNumTaps)];
+		double weightSum=0.0;
+		for(int j=first;j<=last;++j)
+			{
+			double weight=evalResampleFilter(filter,(double(j)+0.5-center)/filterScale);
+			w[j-first]=float(weight);
+			weightSum+=weight;
+			}
+		
+		if(last>=first&&weightSum!=0.0)
+			{
+			/* Normalize the weights: */
+			for(int j=first;j<=last;++j)
+				w[j-first]=float(double(w[j-first])/weightSum);
+			firstTaps[i]=(unsigned int)(first);
+			numTaps[i]=(unsigned int)(last-first+1);
+			}
+		else
+			{
+			/* Fall back to the nearest source sample: */
+			int nearest=int(Math::floor(center));
+			if(nearest>int(sourceSize)-1)
+				nearest=int(sourceSize)-1;
+			firstTaps[i]=(unsigned int)(nearest);
+			numTaps[i]=1;
+			w[0]=1.0f;
+			}
+		}
+	}
+
+struct RowJob // Structure describing an image processing operation on independent rows of a destination image
+	{
+	/* Embedded classes: */
+	public:
+	typedef void (*Kernel)(const RowJob& job,unsigned int rowBegin,unsigned int rowEnd); // Type for functions processing a range of destination rows
+	
+	/* Elements: */
+	Kernel kernel; // Function processing destination rows
+	const void* sourcePixels; // Source pixel array
+	unsigned int sourceSize[2]; // Width and height of the source image
+	unsigned int numChannels; // Number of channels of the source image
+	void* destPixels; // Destination pixel array
+	unsigned int destSize[2]; // Width and height of the destination image
+	double parameter; // Operation-specific scalar parameter
+	const ResampleWeights* weights; // Filter weights for resampling operations
+	Threads::Atomic<unsigned int> nextRow; // Index of the next unclaimed destination row
+	
+	/* Constructors and destructors: */
+	RowJob(Kernel sKernel,const void* sSourcePixels,unsigned int sourceWidth,unsigned int sourceHeight,unsigned int sNumChannels,void* sDestPixels,unsigned int destWidth,unsigned int destHeight)
+		:kernel(sKernel),
+		 sourcePixels(sSourcePixels),numChannels(sNumChannels),
+		 destPixels(sDestPixels),
+		 parameter(0.0),weights(0),
+		 nextRow(0)
+		{
+		sourceSize[0]=sourceWidth;
+		sourceSize[1]=sourceHeight;
+		destSize[0]=destWidth;
+		destSize[1]=destHeight;
+		}
+	RowJob(Kernel sKernel,const BaseImage& source,BaseImage& dest) // Creates a job reading from the given source image and writing all pixels of the given destination image
+		:kernel(sKernel),
+		 sourcePixels(source.getPixels()),numChannels(source.getNumChannels()),
+		 destPixels(dest.replacePixels()),
+		 parameter(0.0),weights(0),
+		 nextRow(0)
+		{
+		for(int i=0;i<2;++i)
+			{
+			sourceSize[i]=source.getSize(i);
+			destSize[i]=dest.getSize(i);
+			}
+		}
+	};
+
+void* rowJobThread(RowJob* job) // Thread function processing blocks of destination rows until all are taken
+	{
+	while(true)
+		{
+		unsigned int rowBegin=job->nextRow.preAdd(rowBlockSize)-rowBlockSize;
+		if(rowBegin>=job->destSize[1])
+			break;
+		unsigned int rowEnd=rowBegin+rowBlockSize;
+		if(rowEnd>job->destSize[1])
+			rowEnd=job->destSize[1];
+		job->kernel(*job,rowBegin,rowEnd);
+		}
+	
+	return 0;
+	}
+
+unsigned int claimHelperThreads(unsigned int numWanted) // Claims up to the given number of helper threads from the process-wide budget; returns the number of claimed threads
+	{
+	/* Determine the process-wide helper thread budget: */
+	unsigned int maxNumHelpers=maxNumThreads.get();
+	if(maxNumHelpers==0)
+		{
+		long numCpus=sysconf(_SC_NPROCESSORS_ONLN);
+		maxNumHelpers=numCpus>0?(unsigned int)(numCpus):1U;
+		}
+	--maxNumHelpers;
+	
+	/* Claim as many helpers as are still available, so that concurrent operations never run more than the budget in total: */
+	while(true)
+		{
+		unsigned int numRunning=numHelperThreads.get();
+		unsigned int numClaimed=maxNumHelpers>numRunning?maxNumHelpers-numRunning:0U;
+		if(numClaimed>numWanted)
+			numClaimed=numWanted;
+		if(numClaimed==0||numHelperThreads.ifCompareAndSwap(numRunning,numRunning+numClaimed))
+			return numClaimed;
+		}
+	}
+
+void runRowJob(RowJob& job) // Runs the given job, splitting it across helper threads if it is large enough and the helper thread budget allows
+	{
+	/* Determine the number of helper threads: */
+	unsigned int numHelpers=0;
+	size_t numPixels=size_t(job.sourceSize[0])*size_t(job.sourceSize[1]);
+	size_t numDestPixels=size_t(job.destSize[0])*size_t(job.destSize[1]);
+	if(numPixels<numDestPixels)
+		numPixels=numDestPixels;
+	unsigned int numBlocks=(job.destSize[1]+rowBlockSize-1)/rowBlockSize;
+	if(numPixels>=parallelPixelThreshold&&numBlocks>1)
+		numHelpers=claimHelperThreads(numBlocks-1);
+	
+	if(numHelpers==0)
+		{
+		/* Process all rows in the calling thread: */
+		job.kernel(job,0,job.destSize[1]);
+		return;
+		}
+	
+	/* Start helper threads and process rows in the calling thread as well: */
+	Threads::Thread* threads=new Threads::Thread[numHelpers];
+	for(unsigned int i=0;i<numHelpers;++i)
+		threads[i].start(rowJobThread,&job);
+	rowJobThread(&job);
+	
+	/* Wait for all helper threads to finish and return them to the budget: */
+	for(unsigned int i=0;i<numHelpers;++i)
+		threads[i].join();
+	delete[] threads;
+	numHelperThreads.preSub(numHelpers);
+	}
+
+/**********************************************************************
+Helper functions for basic image operations; kernels are specialized on
+their channel counts to let the compiler vectorize their inner loops:
+**********************************************************************/
+
+template <class ScalarParam,int sourceChannelsParam>
 inline
 void
-dropAlphaTyped(
-	const BaseImage& source,
-	BaseImage& dest)
+dropAlphaRows(
+	const RowJob& job,
+	unsigned int rowBegin,
+	unsigned int rowEnd)
 	{
-	/* Drop the alpha value of all pixels: */
-	unsigned int numChannels=dest.getNumChannels();
-	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i)
+	/* Drop the alpha value of all pixels in the row range: */
+	size_t pixelBegin=size_t(rowBegin)*size_t(job.destSize[0]);
+	size_t pixelEnd=size_t(rowEnd)*size_t(job.destSize[0]);
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(job.sourcePixels)+pixelBegin*sourceChannelsParam;
+	ScalarParam* dPtr=static_cast<ScalarParam*>(job.destPixels)+pixelBegin*(sourceChannelsParam-1);
+	for(size_t i=pixelBegin;i<pixelEnd;++i,sPtr+=sourceChannelsParam,dPtr+=sourceChannelsParam-1)
 		{
 		/* Copy the non-alpha channels: */
-		for(size_t j=0;j<numChannels;++j)
-			*(dPtr++)=*(sPtr++);
-		
-		/* Skip the source's alpha channel: */
-		++sPtr;
+		for(int j=0;j<sourceChannelsParam-1;++j)
+			dPtr[j]=sPtr[j];
 		}
 	}
 
+template <class ScalarParam>
+inline
+RowJob::Kernel
+dropAlphaKernel(
+	unsigned int numChannels)
+	{
+	return numChannels==2?&dropAlphaRows<ScalarParam,2>:&dropAlphaRows<ScalarParam,4>;
+	}
+
 void dropAlphaImpl(const BaseImage& source,BaseImage& dest)
 	{
-	/* Delegate to a typed version of this function: */
+	/* Select a typed version of this function: */
+	RowJob::Kernel kernel;
 	switch(source.getScalarType())
 		{
 		case GL_BYTE:
-			dropAlphaTyped<signed char>(source,dest);
+			kernel=dropAlphaKernel<signed char>(source.getNumChannels());
 			break;
 		
 		case GL_UNSIGNED_BYTE:
-			dropAlphaTyped<unsigned char>(source,dest);
+			kernel=dropAlphaKernel<unsigned char>(source.getNumChannels());
 			break;
 		
 		case GL_SHORT:
-			dropAlphaTyped<signed short>(source,dest);
+			kernel=dropAlphaKernel<signed short>(source.getNumChannels());
 			break;
 		
 		case GL_UNSIGNED_SHORT:
-			dropAlphaTyped<unsigned short>(source,dest);
+			kernel=dropAlphaKernel<unsigned short>(source.getNumChannels());
 			break;
 		
 		case GL_INT:
-			dropAlphaTyped<signed int>(source,dest);
+			kernel=dropAlphaKernel<signed int>(source.getNumChannels());
 			break;
 		
 		case GL_UNSIGNED_INT:
-			dropAlphaTyped<unsigned int>(source,dest);
+			kernel=dropAlphaKernel<unsigned int>(source.getNumChannels());
 			break;
 		
 		case GL_FLOAT:
-			dropAlphaTyped<float>(source,dest);
+			kernel=dropAlphaKernel<float>(source.getNumChannels());
 			break;
 		
 		case GL_DOUBLE:
-			dropAlphaTyped<double>(source,dest);
+			kernel=dropAlphaKernel<double>(source.getNumChannels());
 			break;
 		
 		default:
 			throw std::runtime_error("Images::BaseImage::dropAlpha: Image has unsupported pixel format");
 		}
+	
+	/* Process the image: */
+	RowJob job(kernel,source,dest);
+	runRowJob(job);
 	}
 
-template <class ScalarParam>
+template <class ScalarParam,int sourceChannelsParam>
 inline
 void
-addAlphaTyped(
-	const BaseImage& source,
-	BaseImage& dest,
-	ScalarParam alpha)
+addAlphaRows(
+	const RowJob& job,
+	unsigned int rowBegin,
+	unsigned int rowEnd)
 	{
-	/* Add the constant alpha value to all pixels: */
-	unsigned int numChannels=source.getNumChannels();
-	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i)
+	/* Add the constant alpha value to all pixels in the row range: */
+	ScalarParam alpha=ScalarParam(job.parameter);
+	size_t pixelBegin=size_t(rowBegin)*size_t(job.destSize[0]);
+	size_t pixelEnd=size_t(rowEnd)*size_t(job.destSize[0]);
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(job.sourcePixels)+pixelBegin*sourceChannelsParam;
+	ScalarParam* dPtr=static_cast<ScalarParam*>(job.destPixels)+pixelBegin*(sourceChannelsParam+1);
+	for(size_t i=pixelBegin;i<pixelEnd;++i,sPtr+=sourceChannelsParam,dPtr+=sourceChannelsParam+1)
 		{
 		/* Copy the non-alpha channels: */
-		for(size_t j=0;j<numChannels;++j)
-			*(dPtr++)=*(sPtr++);
+		for(int j=0;j<sourceChannelsParam;++j)
+			dPtr[j]=sPtr[j];
 		
 		/* Add an alpha value to the destination: */
-		*(dPtr++)=alpha;
+		dPtr[sourceChannelsParam]=alpha;
 		}
 	}
 
+template <class ScalarParam>
+inline
+RowJob::Kernel
+addAlphaKernel(
+	unsigned int numChannels)
+	{
+	return numChannels==1?&addAlphaRows<ScalarParam,1>:&addAlphaRows<ScalarParam,3>;
+	}
+
 void addAlphaImpl(const BaseImage& source,BaseImage& dest,double alpha)
 	{
-	/* Delegate to a typed version of this function: */
+	/* Select a typed version of this function and convert the alpha value to the image's scalar type: */
+	RowJob::Kernel kernel;
+	double typedAlpha;
 	switch(source.getScalarType())
 		{
 		case GL_BYTE:
-			addAlphaTyped<signed char>(source,dest,(signed char)(Math::clamp(Math::floor(alpha*128.0),0.0,127.0)));
+			kernel=addAlphaKernel<signed char>(source.getNumChannels());
+			typedAlpha=Math::clamp(Math::floor(alpha*128.0),0.0,127.0);
 			break;
 		
 		case GL_UNSIGNED_BYTE:
-			addAlphaTyped<unsigned char>(source,dest,(unsigned char)(Math::clamp(Math::floor(alpha*256.0),0.0,255.0)));
+			kernel=addAlphaKernel<unsigned char>(source.getNumChannels());
+			typedAlpha=Math::clamp(Math::floor(alpha*256.0),0.0,255.0);
 			break;
 		
 		case GL_SHORT:
-			addAlphaTyped<signed short>(source,dest,(signed short)(Math::clamp(Math::floor(alpha*32768.0),0.0,32767.0)));
+			kernel=addAlphaKernel<signed short>(source.getNumChannels());
+			typedAlpha=Math::clamp(Math::floor(alpha*32768.0),0.0,32767.0);
 			break;
 		
 		case GL_UNSIGNED_SHORT:
-			addAlphaTyped<unsigned short>(source,dest,(unsigned short)(Math::clamp(Math::floor(alpha*65536.0),0.0,65535.0)));
+			kernel=addAlphaKernel<unsigned short>(source.getNumChannels());
+			typedAlpha=Math::clamp(Math::floor(alpha*65536.0),0.0,65535.0);
 			break;
 		
 		case GL_INT:
-			addAlphaTyped<signed int>(source,dest,(signed int)(Math::clamp(Math::floor(alpha*2147483648.0),0.0,2147483647.0)));
+			kernel=addAlphaKernel<signed int>(source.getNumChannels());
+			typedAlpha=Math::clamp(Math::floor(alpha*2147483648.0),0.0,2147483647.0);
 			break;
 		
 		case GL_UNSIGNED_INT:
-			addAlphaTyped<unsigned int>(source,dest,(unsigned int)(Math::clamp(Math::floor(alpha*4294967296.0),0.0,4294967295.0)));
+			kernel=addAlphaKernel<unsigned int>(source.getNumChannels());
+			typedAlpha=Math::clamp(Math::floor(alpha*4294967296.0),0.0,4294967295.0);
 			break;
 		
 		case GL_FLOAT:
-			addAlphaTyped<float>(source,dest,float(alpha));
+			kernel=addAlphaKernel<float>(source.getNumChannels());
+			typedAlpha=double(float(alpha));
 			break;
 		
 		case GL_DOUBLE:
-			addAlphaTyped<double>(source,dest,alpha);
+			kernel=addAlphaKernel<double>(source.getNumChannels());
+			typedAlpha=alpha;
 			break;
 		
 		default:
 			throw std::runtime_error("Images::BaseImage::addAlpha: Image has unsupported pixel format");
 		}
+	
+	/* Process the image: */
+	RowJob job(kernel,source,dest);
+	job.parameter=typedAlpha;
+	runRowJob(job);
 	}
 
-template <class ScalarParam,class WeightParam>
+template <class ScalarParam,class WeightParam,int sourceChannelsParam>
 inline
 void
-toGreyTypedInt(
-	const BaseImage& source,
-	BaseImage& dest)
+toGreyIntRows(
+	const RowJob& job,
+	unsigned int rowBegin,
+	unsigned int rowEnd)
 	{
-	/* Convert all pixels to luminance and retain an existing alpha channel: */
-	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	if(source.getNumChannels()==4)
-		{
-		/* Convert RGBA to LUMINANCE_ALPHA: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=4)
-			{
-			/* Calculate pixel luminance: */
-			*(dPtr++)=ScalarParam((WeightParam(sPtr[0])*WeightParam(77)+WeightParam(sPtr[1])*WeightParam(150)+WeightParam(sPtr[2])*WeightParam(29))>>WeightParam(8));
-			
-			/* Copy alpha channel: */
-			*(dPtr++)=sPtr[3];
-			}
-		}
-	else
+	/* Convert all pixels in the row range to luminance and retain an existing alpha channel: */
+	size_t pixelBegin=size_t(rowBegin)*size_t(job.destSize[0]);
+	size_t pixelEnd=size_t(rowEnd)*size_t(job.destSize[0]);
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(job.sourcePixels)+pixelBegin*sourceChannelsParam;
+	ScalarParam* dPtr=static_cast<ScalarParam*>(job.destPixels)+pixelBegin*(sourceChannelsParam-2);
+	for(size_t i=pixelBegin;i<pixelEnd;++i,sPtr+=sourceChannelsParam,dPtr+=sourceChannelsParam-2)
 		{
-		/* Convert RGB to LUMINANCE: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=3)
-			{
-			/* Calculate pixel luminance: */
-			*(dPtr++)=ScalarParam((WeightParam(sPtr[0])*WeightParam(77)+WeightParam(sPtr[1])*WeightParam(150)+WeightParam(sPtr[2])*WeightParam(29))>>WeightParam(8));
-			}
+		/* Calculate pixel luminance: */
+		dPtr[0]=ScalarParam((WeightParam(sPtr[0])*WeightParam(77)+WeightParam(sPtr[1])*WeightParam(150)+WeightParam(sPtr[2])*WeightParam(29))>>WeightParam(8));
+		
+		/* Copy alpha channel: */
+		if(sourceChannelsParam==4)
+			dPtr[1]=sPtr[3];
 		}
 	}
 
-template <class ScalarParam>
+template <class ScalarParam,int sourceChannelsParam>
 inline
 void
-toGreyTypedFloat(
-	const BaseImage& source,
-	BaseImage& dest)
+toGreyFloatRows(
+	const RowJob& job,
+	unsigned int rowBegin,
+	unsigned int rowEnd)
 	{
-	/* Convert all pixels to luminance and retain an existing alpha channel: */
-	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	if(source.getNumChannels()==4)
-		{
-		/* Convert RGBA to LUMINANCE_ALPHA: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=4)
-			{
-			/* Calculate pixel luminance: */
-			*(dPtr++)=sPtr[0]*ScalarParam(0.299)+sPtr[1]*ScalarParam(0.587)+sPtr[2]*ScalarParam(0.114);
-			
-			/* Copy alpha channel: */
-			*(dPtr++)=sPtr[3];
-			}
-		}
-	else
+	/* Convert all pixels in the row range to luminance and retain an existing alpha channel: */
+	size_t pixelBegin=size_t(rowBegin)*size_t(job.destSize[0]);
+	size_t pixelEnd=size_t(rowEnd)*size_t(job.destSize[0]);
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(job.sourcePixels)+pixelBegin*sourceChannelsParam;
+	ScalarParam* dPtr=static_cast<ScalarParam*>(job.destPixels)+pixelBegin*(sourceChannelsParam-2);
+	for(size_t i=pixelBegin;i<pixelEnd;++i,sPtr+=sourceChannelsParam,dPtr+=sourceChannelsParam-2)
 		{
-		/* Convert RGB to LUMINANCE: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=3)
-			{
-			/* Calculate pixel luminance: */
-			*(dPtr++)=sPtr[0]*ScalarParam(0.299)+sPtr[1]*ScalarParam(0.587)+sPtr[2]*ScalarParam(0.114);
-			}
+		/* Calculate pixel luminance: */
+		dPtr[0]=sPtr[0]*ScalarParam(0.299)+sPtr[1]*ScalarParam(0.587)+sPtr[2]*ScalarParam(0.114);
+		
+		/* Copy alpha channel: */
+		if(sourceChannelsParam==4)
+			dPtr[1]=sPtr[3];
 		}
 	}
 
+template <class ScalarParam,class WeightParam>
+inline
+RowJob::Kernel
+toGreyIntKernel(
+	unsigned int numChannels)
+	{
+	return numChannels==4?&toGreyIntRows<ScalarParam,WeightParam,4>:&toGreyIntRows<ScalarParam,WeightParam,3>;
+	}
+
+template <class ScalarParam>
+inline
+RowJob::Kernel
+toGreyFloatKernel(
+	unsigned int numChannels)
+	{
+	return numChannels==4?&toGreyFloatRows<ScalarParam,4>:&toGreyFloatRows<ScalarParam,3>;
+	}
+
 void toGreyImpl(const BaseImage& source,BaseImage& dest)
 	{
-	/* Delegate to a typed version of this function: */
+	/* Select a typed version of this function: */
+	RowJob::Kernel kernel;
 	switch(source.getScalarType())
 		{
 		case GL_BYTE:
-			toGreyTypedInt<signed char,signed short>(source,dest);
+			kernel=toGreyIntKernel<signed char,signed short>(source.getNumChannels());
 			break;
 		
 		case GL_UNSIGNED_BYTE:
-			toGreyTypedInt<unsigned char,unsigned short>(source,dest);
+			kernel=toGreyIntKernel<unsigned char,unsigned short>(source.getNumChannels());
 			break;
 		
 		case GL_SHORT:
-			toGreyTypedInt<signed short,signed int>(source,dest);
+			kernel=toGreyIntKernel<signed short,signed int>(source.getNumChannels());
 			break;
 		
 		case GL_UNSIGNED_SHORT:
-			toGreyTypedInt<unsigned short,unsigned int>(source,dest);
+			kernel=toGreyIntKernel<unsigned short,unsigned int>(source.getNumChannels());
 			break;
 		
 		case GL_INT:
-			toGreyTypedInt<signed int,signed long>(source,dest);
+			kernel=toGreyIntKernel<signed int,signed long>(source.getNumChannels());
 			break;
 		
 		case GL_UNSIGNED_INT:
-			toGreyTypedInt<unsigned int,unsigned long>(source,dest);
+			kernel=toGreyIntKernel<unsigned int,unsigned long>(source.getNumChannels());
 			break;
 		
 		case GL_FLOAT:
-			toGreyTypedFloat<float>(source,dest);
+			kernel=toGreyFloatKernel<float>(source.getNumChannels());
 			break;
 		
 		case GL_DOUBLE:
-			toGreyTypedFloat<double>(source,dest);
+			kernel=toGreyFloatKernel<double>(source.getNumChannels());
 			break;
 		
 		default:
 			throw std::runtime_error("Images::BaseImage::toGrey: Image has unsupported pixel format");
 		}
+	
+	/* Process the image: */
+	RowJob job(kernel,source,dest);
+	runRowJob(job);
 	}
 
-template <class ScalarParam>
+template <class ScalarParam,int sourceChannelsParam>
 inline
 void
-toRgbTyped(
-	const BaseImage& source,
-	BaseImage& dest)
+toRgbRows(
+	const RowJob& job,
+	unsigned int rowBegin,
+	unsigned int rowEnd)
 	{
-	/* Convert all pixels to RGB and retain an existing alpha channel: */
-	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	if(source.getNumChannels()==2)
+	/* Convert all pixels in the row range to RGB and retain an existing alpha channel: */
+	size_t pixelBegin=size_t(rowBegin)*size_t(job.destSize[0]);
+	size_t pixelEnd=size_t(rowEnd)*size_t(job.destSize[0]);
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(job.sourcePixels)+pixelBegin*sourceChannelsParam;
+	ScalarParam* dPtr=static_cast<ScalarParam*>(job.destPixels)+pixelBegin*(sourceChannelsParam+2);
+	for(size_t i=pixelBegin;i<pixelEnd;++i,sPtr+=sourceChannelsParam,dPtr+=sourceChannelsParam+2)
 		{
-		/* Convert LUMINANCE_ALPHA to RGBA: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,sPtr+=2)
-			{
-			/* Copy pixel luminance: */
-			*(dPtr++)=sPtr[0];
-			*(dPtr++)=sPtr[0];
-			*(dPtr++)=sPtr[0];
-			
-			/* Copy alpha channel: */
-			*(dPtr++)=sPtr[1];
-			}
-		}
-	else
-		{
-		/* Convert LUMINANCE to RGB: */
-		for(size_t i=size_t(source.getSize(0))*size_t(source.getSize(1));i>0;--i,++sPtr)
-			{
-			/* Copy pixel luminance: */
-			*(dPtr++)=sPtr[0];
-			*(dPtr++)=sPtr[0];
-			*(dPtr++)=sPtr[0];
-			}
+		/* Copy pixel luminance: */
+		dPtr[0]=sPtr[0];
+		dPtr[1]=sPtr[0];
+		dPtr[2]=sPtr[0];
+		
+		/* Copy alpha channel: */
+		if(sourceChannelsParam==2)
+			dPtr[3]=sPtr[1];
 		}
 	}
 
+template <class ScalarParam>
+inline
+RowJob::Kernel
+toRgbKernel(
+	unsigned int numChannels)
+	{
+	return numChannels==2?&toRgbRows<ScalarParam,2>:&toRgbRows<ScalarParam,1>;
+	}
+
 void toRgbImpl(const BaseImage& source,BaseImage& dest)
 	{
-	/* Delegate to a typed version of this function: */
+	/* Select a typed version of this function: */
+	RowJob::Kernel kernel;
 	switch(source.getScalarType())
 		{
 		case GL_BYTE:
-			toRgbTyped<signed char>(source,dest);
+			kernel=toRgbKernel<signed char>(source.getNumChannels());
 			break;
 		
 		case GL_UNSIGNED_BYTE:
-			toRgbTyped<unsigned char>(source,dest);
+			kernel=toRgbKernel<unsigned char>(source.getNumChannels());
 			break;
 		
 		case GL_SHORT:
-			toRgbTyped<signed short>(source,dest);
+			kernel=toRgbKernel<signed short>(source.getNumChannels());
 			break;
 		
 		case GL_UNSIGNED_SHORT:
-			toRgbTyped<unsigned short>(source,dest);
+			kernel=toRgbKernel<unsigned short>(source.getNumChannels());
 			break;
 		
 		case GL_INT:
-			toRgbTyped<signed int>(source,dest);
+			kernel=toRgbKernel<signed int>(source.getNumChannels());
 			break;
 		
 		case GL_UNSIGNED_INT:
-			toRgbTyped<unsigned int>(source,dest);
+			kernel=toRgbKernel<unsigned int>(source.getNumChannels());
 			break;
 		
 		case GL_FLOAT:
-			toRgbTyped<float>(source,dest);
+			kernel=toRgbKernel<float>(source.getNumChannels());
 			break;
 		
 		case GL_DOUBLE:
-			toRgbTyped<double>(source,dest);
+			kernel=toRgbKernel<double>(source.getNumChannels());
 			break;
 		
 		default:
 			throw std::runtime_error("Images::BaseImage::toRgb: Image has unsupported pixel format");
 		}
+	
+	/* Process the image: */
+	RowJob job(kernel,source,dest);
+	runRowJob(job);
 	}
 
-template <class ScalarParam,class AccumParam>
+template <class ScalarParam,class AccumParam,int numChannelsParam>
 inline
 void
-shrinkTypedInt(
-	const BaseImage& source,
-	BaseImage& dest)
+shrinkIntRows(
+	const RowJob& job,
+	unsigned int rowBegin,
+	unsigned int rowEnd)
 	{
-	/* Average all blocks of 2x2 pixels in the source image: */
-	unsigned int nc=source.getNumChannels();
-	const ScalarParam* sRow0Ptr=static_cast<const ScalarParam*>(source.getPixels());
-	const ptrdiff_t sStride=source.getSize(0)*nc;
-	const ScalarParam* sRow1Ptr=sRow0Ptr+sStride;
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	for(unsigned int y=0;y<source.getSize(1);y+=2,sRow0Ptr+=sStride*2,sRow1Ptr+=sStride*2)
+	/* Average all blocks of 2x2 pixels in the source image that map to the row range; a zero channel count template parameter uses the job's channel count: */
+	const unsigned int nc=numChannelsParam!=0?numChannelsParam:job.numChannels;
+	const ptrdiff_t sStride=ptrdiff_t(job.sourceSize[0])*nc;
+	const ptrdiff_t dStride=ptrdiff_t(job.destSize[0])*nc;
+	for(unsigned int y=rowBegin;y<rowEnd;++y)
 		{
-		const ScalarParam* s0Ptr=sRow0Ptr;
-		const ScalarParam* s1Ptr=sRow1Ptr;
-		for(unsigned int x=0;x<source.getSize(0);x+=2,s0Ptr+=nc,s1Ptr+=nc)
-			{
-			for(unsigned int i=0;i<source.getNumChannels();++i,++s0Ptr,++s1Ptr,++dPtr)
+		const ScalarParam* s0Ptr=static_cast<const ScalarParam*>(job.sourcePixels)+ptrdiff_t(y)*2*sStride;
+		const ScalarParam* s1Ptr=s0Ptr+sStride;
+		ScalarParam* dPtr=static_cast<ScalarParam*>(job.destPixels)+ptrdiff_t(y)*dStride;
+		for(unsigned int x=0;x<job.destSize[0];++x,s0Ptr+=nc*2,s1Ptr+=nc*2,dPtr+=nc)
+			for(unsigned int i=0;i<nc;++i)
 				{
 				/* Average the current 2x2 pixel block: */
-				AccumParam sum0=AccumParam(s0Ptr[0])+AccumParam(s0Ptr[nc]);
-				AccumParam sum1=AccumParam(s1Ptr[0])+AccumParam(s1Ptr[nc]);
-				*dPtr=ScalarParam((sum0+sum1+2)>>2);
+				AccumParam sum0=AccumParam(s0Ptr[i])+AccumParam(s0Ptr[nc+i]);
+				AccumParam sum1=AccumParam(s1Ptr[i])+AccumParam(s1Ptr[nc+i]);
+				dPtr[i]=ScalarParam((sum0+sum1+2)>>2);
 				}
-			}
 		}
 	}
 
-template <class ScalarParam>
+template <class ScalarParam,int numChannelsParam>
 inline
 void
-shrinkTypedFloat(
-	const BaseImage& source,
-	BaseImage& dest)
+shrinkFloatRows(
+	const RowJob& job,
+	unsigned int rowBegin,
+	unsigned int rowEnd)
 	{
-	/* Average all blocks of 2x2 pixels in the source image: */
-	unsigned int nc=source.getNumChannels();
-	const ScalarParam* sRow0Ptr=static_cast<const ScalarParam*>(source.getPixels());
-	const ptrdiff_t sStride=source.getSize(0)*nc;
-	const ScalarParam* sRow1Ptr=sRow0Ptr+sStride;
-	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.modifyPixels());
-	for(unsigned int y=0;y<source.getSize(1);y+=2,sRow0Ptr+=sStride*2,sRow1Ptr+=sStride*2)
+	/* Average all blocks of 2x2 pixels in the source image that map to the row range; a zero channel count template parameter uses the job's channel count: */
+	const unsigned int nc=numChannelsParam!=0?numChannelsParam:job.numChannels;
+	const ptrdiff_t sStride=ptrdiff_t(job.sourceSize[0])*nc;
+	const ptrdiff_t dStride=ptrdiff_t(job.destSize[0])*nc;
+	for(unsigned int y=rowBegin;y<rowEnd;++y)
 		{
-		const ScalarParam* s0Ptr=sRow0Ptr;
-		const ScalarParam* s1Ptr=sRow1Ptr;
-		for(unsigned int x=0;x<source.getSize(0);x+=2,s0Ptr+=nc,s1Ptr+=nc)
-			{
-			for(unsigned int i=0;i<source.getNumChannels();++i,++s0Ptr,++s1Ptr,++dPtr)
+		const ScalarParam* s0Ptr=static_cast<const ScalarParam*>(job.sourcePixels)+ptrdiff_t(y)*2*sStride;
+		const ScalarParam* s1Ptr=s0Ptr+sStride;
+		ScalarParam* dPtr=static_cast<ScalarParam*>(job.destPixels)+ptrdiff_t(y)*dStride;
+		for(unsigned int x=0;x<job.destSize[0];++x,s0Ptr+=nc*2,s1Ptr+=nc*2,dPtr+=nc)
+			for(unsigned int i=0;i<nc;++i)
 				{
 				/* Average the current 2x2 pixel block: */
-				*dPtr=(s0Ptr[0]+s0Ptr[nc]+s1Ptr[0]+s1Ptr[nc])*ScalarParam(0.25);
+				dPtr[i]=(s0Ptr[i]+s0Ptr[nc+i]+s1Ptr[i]+s1Ptr[nc+i])*ScalarParam(0.25);
 				}
+		}
+	}
+
+#ifdef __SSE2__
+
+void shrinkUByteLuminanceRows(const RowJob& job,unsigned int rowBegin,unsigned int rowEnd) // Shrinks single-channel 8-bit images using SSE2 instructions
+	{
+	const ptrdiff_t sStride=ptrdiff_t(job.sourceSize[0]);
+	const ptrdiff_t dStride=ptrdiff_t(job.destSize[0]);
+	const __m128i lowMask=_mm_set1_epi16(0x00ff);
+	const __m128i two=_mm_set1_epi16(2);
+	for(unsigned int y=rowBegin;y<rowEnd;++y)
+		{
+		const GLubyte* s0Ptr=static_cast<const GLubyte*>(job.sourcePixels)+ptrdiff_t(y)*2*sStride;
+		const GLubyte* s1Ptr=s0Ptr+sStride;
+		GLubyte* dPtr=static_cast<GLubyte*>(job.destPixels)+ptrdiff_t(y)*dStride;
+		
+		/* Process blocks of 16 destination pixels: */
+		unsigned int x=0;
+		for(;x+16<=job.destSize[0];x+=16,s0Ptr+=32,s1Ptr+=32,dPtr+=16)
+			{
+			__m128i r0a=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s0Ptr));
+			__m128i r0b=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s0Ptr+16));
+			__m128i r1a=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s1Ptr));
+			__m128i r1b=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s1Ptr+16));
+			
+			/* Add horizontally and vertically adjacent pixels at 16-bit precision: */
+			__m128i sa=_mm_add_epi16(_mm_add_epi16(_mm_and_si128(r0a,lowMask),_mm_srli_epi16(r0a,8)),_mm_add_epi16(_mm_and_si128(r1a,lowMask),_mm_srli_epi16(r1a,8)));
+			__m128i sb=_mm_add_epi16(_mm_add_epi16(_mm_and_si128(r0b,lowMask),_mm_srli_epi16(r0b,8)),_mm_add_epi16(_mm_and_si128(r1b,lowMask),_mm_srli_epi16(r1b,8)));
+			
+			/* Round, divide by four, and store the results: */
+			sa=_mm_srli_epi16(_mm_add_epi16(sa,two),2);
+			sb=_mm_srli_epi16(_mm_add_epi16(sb,two),2);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dPtr),_mm_packus_epi16(sa,sb));
+			}
+		
+		/* Process the remaining pixels: */
+		for(;x<job.destSize[0];++x,s0Ptr+=2,s1Ptr+=2,++dPtr)
+			*dPtr=GLubyte(((unsigned int)(s0Ptr[0])+(unsigned int)(s0Ptr[1])+(unsigned int)(s1Ptr[0])+(unsigned int)(s1Ptr[1])+2U)>>2);
+		}
+	}
+
+void shrinkUByteRGBARows(const RowJob& job,unsigned int rowBegin,unsigned int rowEnd) // Shrinks four-channel 8-bit images using SSE2 instructions
+	{
+	const ptrdiff_t sStride=ptrdiff_t(job.sourceSize[0])*4;
+	const ptrdiff_t dStride=ptrdiff_t(job.destSize[0])*4;
+	const __m128i zero=_mm_setzero_si128();
+	const __m128i two=_mm_set1_epi16(2);
+	for(unsigned int y=rowBegin;y<rowEnd;++y)
+		{
+		const GLubyte* s0Ptr=static_cast<const GLubyte*>(job.sourcePixels)+ptrdiff_t(y)*2*sStride;
+		const GLubyte* s1Ptr=s0Ptr+sStride;
+		GLubyte* dPtr=static_cast<GLubyte*>(job.destPixels)+ptrdiff_t(y)*dStride;
+		
+		/* Process blocks of four destination pixels: */
+		unsigned int x=0;
+		for(;x+4<=job.destSize[0];x+=4,s0Ptr+=32,s1Ptr+=32,dPtr+=16)
+			{
+			__m128i r0a=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s0Ptr));
+			__m128i r0b=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s0Ptr+16));
+			__m128i r1a=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s1Ptr));
+			__m128i r1b=_mm_loadu_si128(reinterpret_cast<const __m128i*>(s1Ptr+16));
+			
+			/* Add vertically adjacent pixels at 16-bit precision, two pixels per register: */
+			__m128i v0=_mm_add_epi16(_mm_unpacklo_epi8(r0a,zero),_mm_unpacklo_epi8(r1a,zero));
+			__m128i v1=_mm_add_epi16(_mm_unpackhi_epi8(r0a,zero),_mm_unpackhi_epi8(r1a,zero));
+			__m128i v2=_mm_add_epi16(_mm_unpacklo_epi8(r0b,zero),_mm_unpacklo_epi8(r1b,zero));
+			__m128i v3=_mm_add_epi16(_mm_unpackhi_epi8(r0b,zero),_mm_unpackhi_epi8(r1b,zero));
+			
+			/* Add horizontally adjacent pixels: */
+			__m128i h0=_mm_add_epi16(_mm_unpacklo_epi64(v0,v1),_mm_unpackhi_epi64(v0,v1));
+			__m128i h1=_mm_add_epi16(_mm_unpacklo_epi64(v2,v3),_mm_unpackhi_epi64(v2,v3));
+			
+			/* Round, divide by four, and store the results: */
+			h0=_mm_srli_epi16(_mm_add_epi16(h0,two),2);
+			h1=_mm_srli_epi16(_mm_add_epi16(h1,two),2);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dPtr),_mm_packus_epi16(h0,h1));
 			}
+		
+		/* Process the remaining pixels: */
+		for(;x<job.destSize[0];++x,s0Ptr+=8,s1Ptr+=8,dPtr+=4)
+			for(int i=0;i<4;++i)
+				dPtr[i]=GLubyte(((unsigned int)(s0Ptr[i])+(unsigned int)(s0Ptr[4+i])+(unsigned int)(s1Ptr[i])+(unsigned int)(s1Ptr[4+i])+2U)>>2);
+		}
+	}
+
+#endif
+
+template <class ScalarParam,class AccumParam>
+inline
+RowJob::Kernel
+shrinkIntKernel(
+	unsigned int numChannels)
+	{
+	switch(numChannels)
+		{
+		case 1:
+			return &shrinkIntRows<ScalarParam,AccumParam,1>;
+		
+		case 2:
+			return &shrinkIntRows<ScalarParam,AccumParam,2>;
+		
+		case 3:
+			return &shrinkIntRows<ScalarParam,AccumParam,3>;
+		
+		case 4:
+			return &shrinkIntRows<ScalarParam,AccumParam,4>;
+		
+		default:
+			return &shrinkIntRows<ScalarParam,AccumParam,0>;
+		}
+	}
+
+template <class ScalarParam>
+inline
+RowJob::Kernel
+shrinkFloatKernel(
+	unsigned int numChannels)
+	{
+	switch(numChannels)
+		{
+		case 1:
+			return &shrinkFloatRows<ScalarParam,1>;
+		
+		case 2:
+			return &shrinkFloatRows<ScalarParam,2>;
+		
+		case 3:
+			return &shrinkFloatRows<ScalarParam,3>;
+		
+		case 4:
+			return &shrinkFloatRows<ScalarParam,4>;
+		
+		default:
+			return &shrinkFloatRows<ScalarParam,0>;
 		}
 	}
 
+template <class ScalarParam,class AccumParam>
+inline
+ScalarParam
+convertAccum(
+	AccumParam value) // Rounds and clamps an accumulated value to the range of an integer scalar type
+	{
+	if(value<=AccumParam(std::numeric_limits<ScalarParam>::min()))
+		return std::numeric_limits<ScalarParam>::min();
+	else if(value>=AccumParam(std::numeric_limits<ScalarParam>::max()))
+		return std::numeric_limits<ScalarParam>::max();
+	else
+		return ScalarParam(Math::floor(value+AccumParam(0.5)));
+	}
+
+template <>
+inline
+float
+convertAccum<float,float>(
+	float value)
+	{
+	return value;
+	}
+
+template <>
+inline
+double
+convertAccum<double,double>(
+	double value)
+	{
+	return value;
+	}
+
+template <class ScalarParam,class AccumParam>
+inline
+void
+resampleHorizontalRows(
+	const RowJob& job,
+	unsigned int rowBegin,
+	unsigned int rowEnd)
+	{
+	/* Resample the source rows in the row range into the intermediate image: */
+	const unsigned int nc=job.numChannels;
+	const ResampleWeights& rw=*job.weights;
+	for(unsigned int y=rowBegin;y<rowEnd;++y)
+		{
+		const ScalarParam* sRowPtr=static_cast<const ScalarParam*>(job.sourcePixels)+size_t(y)*size_t(job.sourceSize[0])*nc;
+		AccumParam* dPtr=static_cast<AccumParam*>(job.destPixels)+size_t(y)*size_t(job.destSize[0])*nc;
+		for(unsigned int x=0;x<job.destSize[0];++x,dPtr+=nc)
+			{
+			const float* weights=&rw.weights[size_t(x)*size_t(rw.maxNumTaps)];
+			const ScalarParam* sPtr=sRowPtr+size_t(rw.firstTaps[x])*nc;
+			for(unsigned int i=0;i<nc;++i)
+				dPtr[i]=AccumParam(0);
+			for(unsigned int tap=0;tap<rw.numTaps[x];++tap,sPtr+=nc)
+				for(unsigned int i=0;i<nc;++i)
+					dPtr[i]+=AccumParam(sPtr[i])*AccumParam(weights[tap]);
+			}
+		}
+	}
+
+template <class ScalarParam,class AccumParam>
+inline
+void
+resampleVerticalRows(
+	const RowJob& job,
+	unsigned int rowBegin,
+	unsigned int rowEnd)
+	{
+	/* Resample the intermediate image's columns into the destination rows in the row range: */
+	const ResampleWeights& rw=*job.weights;
+	size_t rowSize=size_t(job.destSize[0])*job.numChannels;
+	std::vector<AccumParam> rowSums(rowSize);
+	for(unsigned int y=rowBegin;y<rowEnd;++y)
+		{
+		/* Accumulate the weighted intermediate rows: */
+		const float* weights=&rw.weights[size_t(y)*size_t(rw.maxNumTaps)];
+		const AccumParam* sRowPtr=static_cast<const AccumParam*>(job.sourcePixels)+size_t(rw.firstTaps[y])*rowSize;
+		for(size_t i=0;i<rowSize;++i)
+			rowSums[i]=sRowPtr[i]*AccumParam(weights[0]);
+		for(unsigned int tap=1;tap<rw.numTaps[y];++tap)
+			{
+			sRowPtr+=rowSize;
+			AccumParam weight(weights[tap]);
+			for(size_t i=0;i<rowSize;++i)
+				rowSums[i]+=sRowPtr[i]*weight;
+			}
+		
+		/* Convert the accumulated row to the destination's scalar type: */
+		ScalarParam* dPtr=static_cast<ScalarParam*>(job.destPixels)+size_t(y)*rowSize;
+		for(size_t i=0;i<rowSize;++i)
+			dPtr[i]=convertAccum<ScalarParam,AccumParam>(rowSums[i]);
+		}
+	}
+
+template <class ScalarParam,class AccumParam>
+inline
+void
+resampleTyped(
+	const BaseImage& source,
+	BaseImage& dest,
+	BaseImage::ResampleFilter filter)
+	{
+	/* Calculate the filter weights for both directions: */
+	ResampleWeights horizontalWeights(source.getSize(0),dest.getSize(0),filter);
+	ResampleWeights verticalWeights(source.getSize(1),dest.getSize(1),filter);
+	
+	/* Resample the source image horizontally into an intermediate image: */
+	unsigned int nc=source.getNumChannels();
+	std::vector<AccumParam> intermediate(size_t(dest.getSize(0))*size_t(source.getSize(1))*nc);
+	RowJob horizontalJob(&resampleHorizontalRows<ScalarParam,AccumParam>,source.getPixels(),source.getSize(0),source.getSize(1),nc,&intermediate[0],dest.getSize(0),source.getSize(1));
+	horizontalJob.weights=&horizontalWeights;
+	runRowJob(horizontalJob);
+	
+	/* Resample the intermediate image vertically into the destination image: */
+	RowJob verticalJob(&resampleVerticalRows<ScalarParam,AccumParam>,&intermediate[0],dest.getSize(0),source.getSize(1),nc,dest.replacePixels(),dest.getSize(0),dest.getSize(1));
+	verticalJob.weights=&verticalWeights;
+	runRowJob(verticalJob);
+	}
+
 /***************************************************************************
 Generic function to convert color components between supported scalar types:
 ***************************************************************************/
@@ -948,48 +1480,121 @@ BaseImage BaseImage::shrink(void) const
 	/* Create a reduced-sized image with the same pixel format: */
 	BaseImage result(rep->size[0]/2,rep->size[1]/2,rep->numChannels,rep->channelSize,rep->format,rep->scalarType);
 	
-	/* Delegate to a typed version of this function: */
+	/* Select a typed version of this function: */
+	RowJob::Kernel kernel;
 	switch(rep->scalarType)
 		{
 		case GL_BYTE:
-			shrinkTypedInt<signed char,signed short>(*this,result);
+			kernel=shrinkIntKernel<signed char,signed short>(rep->numChannels);
 			break;
 		
 		case GL_UNSIGNED_BYTE:
-			shrinkTypedInt<unsigned char,unsigned short>(*this,result);
+			kernel=shrinkIntKernel<unsigned char,unsigned short>(rep->numChannels);
+			#ifdef __SSE2__
+			if(rep->numChannels==1)
+				kernel=shrinkUByteLuminanceRows;
+			else if(rep->numChannels==4)
+				kernel=shrinkUByteRGBARows;
+			#endif
 			break;
 		
 		case GL_SHORT:
-			shrinkTypedInt<signed short,signed int>(*this,result);
+			kernel=shrinkIntKernel<signed short,signed int>(rep->numChannels);
 			break;
 		
 		case GL_UNSIGNED_SHORT:
-			shrinkTypedInt<unsigned short,unsigned int>(*this,result);
+			kernel=shrinkIntKernel<unsigned short,unsigned int>(rep->numChannels);
 			break;
 		
 		case GL_INT:
-			shrinkTypedInt<signed int,signed long>(*this,result);
+			kernel=shrinkIntKernel<signed int,signed long>(rep->numChannels);
 			break;
 		
 		case GL_UNSIGNED_INT:
-			shrinkTypedInt<unsigned int,unsigned long>(*this,result);
+			kernel=shrinkIntKernel<unsigned int,unsigned long>(rep->numChannels);
 			break;
 		
 		case GL_FLOAT:
-			shrinkTypedFloat<float>(*this,result);
+			kernel=shrinkFloatKernel<float>(rep->numChannels);
 			break;
 		
 		case GL_DOUBLE:
-			shrinkTypedFloat<double>(*this,result);
+			kernel=shrinkFloatKernel<double>(rep->numChannels);
 			break;
 		
 		default:
 			throw std::runtime_error("Images::BaseImage::shrink: Image has unsupported pixel format");
 		}
 	
+	/* Process the image: */
+	RowJob job(kernel,*this,result);
+	runRowJob(job);
+	
 	return result;
 	}
 
+BaseImage BaseImage::resample(unsigned int newWidth,unsigned int newHeight,BaseImage::ResampleFilter filter) const
+	{
+	/* Check the new image size: */
+	if(newWidth==0||newHeight==0)
+		throw std::runtime_error("Images::BaseImage::resample: Invalid image size");
+	
+	/* Create a resampled image with the same pixel format: */
+	BaseImage result(newWidth,newHeight,rep->numChannels,rep->channelSize,rep->format,rep->scalarType);
+	
+	/* Delegate to a typed version of this function: */
+	switch(rep->scalarType)
+		{
+		case GL_BYTE:
+			resampleTyped<signed char,float>(*this,result,filter);
+			break;
+		
+		case GL_UNSIGNED_BYTE:
+			resampleTyped<unsigned char,float>(*this,result,filter);
+			break;
+		
+		case GL_SHORT:
+			resampleTyped<signed short,float>(*this,result,filter);
+			break;
+		
+		case GL_UNSIGNED_SHORT:
+			resampleTyped<unsigned short,float>(*this,result,filter);
+			break;
+		
+		case GL_INT:
+			resampleTyped<signed int,double>(*this,result,filter);
+			break;
+		
+		case GL_UNSIGNED_INT:
+			resampleTyped<unsigned int,double>(*this,result,filter);
+			break;
+		
+		case GL_FLOAT:
+			resampleTyped<float,float>(*this,result,filter);
+			break;
+		
+		case GL_DOUBLE:
+			resampleTyped<double,double>(*this,result,filter);
+			break;
+		
+		default:
+			throw std::runtime_error("Images::BaseImage::resample: Image has unsupported pixel format");
+		}
+	
+	return result;
+	}
+
+void BaseImage::setNumThreads(unsigned int newNumThreads)
+	{
+	/* Atomically exchange the thread budget; operations that already claimed helper threads finish with them: */
+	unsigned int oldNumThreads;
+	do
+		{
+		oldNumThreads=maxNumThreads.get();
+		}
+	while(!maxNumThreads.ifCompareAndSwap(oldNumThreads,newNumThreads));
+	}
+
 GLenum BaseImage::getInternalFormat(void) const
 	{
 	/* Guess an appropriate internal image format: */
@@ -37,6 +37,12 @@ namespace Images {
 
 class BaseImage
 	{
+	public:
+	enum ResampleFilter // Enumerated type for filters used when resampling images
+		{
+		BoxFilter,BilinearFilter,LanczosFilter
+		};
+	
 	private:
 	struct ImageRepresentation // Structure to represent an image to allow non-copy sharing and passing of images
 		{
@@ -199,6 +205,8 @@ class BaseImage
 	BaseImage toGrey(void) const; // Returns a new image representing this image's luminance; returns itself if the image is already greyscale; retains existing alpha channel
 	BaseImage toRgb(void) const; // Returns a new image representing this greyscale image in RGB color space; returns itself if the image is already RGB; retains existing alpha channel
 	BaseImage shrink(void) const; // Returns a version of this image downsampled by a factor of two (for mipmap generation); assumes size of image is even in both directions
+	BaseImage resample(unsigned int newWidth,unsigned int newHeight,ResampleFilter filter =LanczosFilter) const; // Returns a version of this image resampled to the given size using the given filter
+	static void setNumThreads(unsigned int newNumThreads); // Sets the maximum total number of threads used by all concurrent operations on large images; 1 (default) processes images in the calling thread, 0 uses one thread per CPU; can be called at any time
 	
 	/* OpenGL interface methods: */
 	GLenum getInternalFormat(void) const; // Returns an internal OpenGL texture format compatible with this image
@@ -0,0 +1,497 @@
+/***********************************************************************
+ImagePyramid - Class to represent huge images as out-of-core pyramids
+of fixed-size tiles at successively halved resolutions, stored in a
+cache file that is built once from a source image file.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Images/ImagePyramid.h>
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <string>
+#include <stdexcept>
+#include <Misc/SizedTypes.h>
+#include <Misc/SelfDestructPointer.h>
+#include <Misc/ThrowStdErr.h>
+#include <Threads/Atomic.h>
+#include <Threads/Thread.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Images/Config.h>
+#include <Images/ImageFileFormats.h>
+#include <Images/ReadImageFile.h>
+#if IMAGES_CONFIG_HAVE_TIFF
+#include <Images/TIFFReader.h>
+#endif
+
+namespace Images {
+
+namespace {
+
+/****************
+Helper constants:
+****************/
+
+const char pyramidFileMagic[16]={'V','r','u','i',' ','I','m','a','g','e','P','y','r',' ','1','\0'}; // Identifier at the beginning of pyramid files
+const IO::SeekableFile::Offset tileDataAlignment=4096; // Alignment of the first tile in a pyramid file
+
+/****************
+Helper functions:
+****************/
+
+void initLevels(unsigned int width,unsigned int height,unsigned int tileSize,size_t tileDataSize,std::vector<ImagePyramid::Level>& levels) // Calculates the layout of a pyramid's resolution levels
+	{
+	levels.clear();
+	IO::SeekableFile::Offset offset=tileDataAlignment;
+	unsigned int size[2]={width,height};
+	while(true)
+		{
+		/* Add the current level: */
+		ImagePyramid::Level level;
+		for(int i=0;i<2;++i)
+			{
+			level.size[i]=size[i];
+			level.numTiles[i]=(size[i]+tileSize-1)/tileSize;
+			}
+		level.offset=offset;
+		offset+=IO::SeekableFile::Offset(level.numTiles[1])*IO::SeekableFile::Offset(level.numTiles[0])*IO::SeekableFile::Offset(tileDataSize);
+		levels.push_back(level);
+		
+		/* Stop once the level fits into a single tile: */
+		if(level.numTiles[0]==1&&level.numTiles[1]==1)
+			break;
+		
+		/* Halve the level size, rounding up: */
+		for(int i=0;i<2;++i)
+			size[i]=(size[i]+1)/2;
+		}
+	}
+
+IO::SeekableFile::Offset getTileOffset(const ImagePyramid::Level& level,unsigned int tileX,unsigned int tileY,size_t tileDataSize) // Returns the file offset of a tile
+	{
+	return level.offset+(IO::SeekableFile::Offset(tileY)*IO::SeekableFile::Offset(level.numTiles[0])+IO::SeekableFile::Offset(tileX))*IO::SeekableFile::Offset(tileDataSize);
+	}
+
+/**************
+Helper classes:
+**************/
+
+class PyramidBuilder // Class holding the state of a pyramid file under construction
+	{
+	/* Embedded classes: */
+	public:
+	struct ShrinkArgs // Structure passing arguments to level downsampling threads
+		{
+		/* Elements: */
+		public:
+		PyramidBuilder* builder; // The pyramid builder
+		unsigned int level; // Index of the level being calculated from the next-finer level
+		Threads::Atomic<size_t> nextTile; // Index of the next unclaimed tile in the level
+		Threads::Mutex errorMutex; // Mutex protecting the error message
+		std::string error; // Message of the first exception thrown by any thread
+		
+		/* Constructors and destructors: */
+		ShrinkArgs(PyramidBuilder* sBuilder,unsigned int sLevel)
+			:builder(sBuilder),level(sLevel),nextTile(0)
+			{
+			}
+		};
+	
+	/* Elements: */
+	std::string pyramidFileName; // Name of the pyramid file
+	IO::SeekableFilePtr file; // Pyramid file opened for writing
+	Threads::Mutex fileMutex; // Mutex serializing writes to the pyramid file
+	unsigned int size[2]; // Size of the full-resolution image
+	unsigned int tileSize; // Width and height of all tiles
+	unsigned int numChannels,channelSize; // Pixel layout of the image
+	GLenum format,scalarType; // OpenGL pixel format and scalar type of the image
+	size_t pixelSize; // Size of a pixel in bytes
+	size_t tileDataSize; // Size of a tile in bytes
+	std::vector<ImagePyramid::Level> levels; // Layout of the pyramid's resolution levels
+	unsigned char* tileBuffer; // Buffer to assemble full-resolution tiles
+	
+	/* Constructors and destructors: */
+	PyramidBuilder(const char* sPyramidFileName,unsigned int sWidth,unsigned int sHeight,unsigned int sTileSize,unsigned int sNumChannels,unsigned int sChannelSize,GLenum sFormat,GLenum sScalarType)
+		:pyramidFileName(sPyramidFileName),
+		 file(IO::openSeekableFile(sPyramidFileName,IO::File::WriteOnly)),
+		 tileSize(sTileSize),numChannels(sNumChannels),channelSize(sChannelSize),
+		 format(sFormat),scalarType(sScalarType),
+		 pixelSize(size_t(numChannels)*size_t(channelSize)),
+		 tileDataSize(size_t(tileSize)*size_t(tileSize)*pixelSize),
+		 tileBuffer(new unsigned char[tileDataSize])
+		{
+		size[0]=sWidth;
+		size[1]=sHeight;
+		initLevels(size[0],size[1],tileSize,tileDataSize,levels);
+		}
+	~PyramidBuilder(void)
+		{
+		delete[] tileBuffer;
+		}
+	
+	/* Methods: */
+	void writeTile(unsigned int level,unsigned int tileX,unsigned int tileY,const void* tileData) // Writes a tile to the pyramid file; can be called from multiple threads
+		{
+		Threads::Mutex::Lock fileLock(fileMutex);
+		file->setWritePosAbs(getTileOffset(levels[level],tileX,tileY,tileDataSize));
+		file->writeRaw(tileData,tileDataSize);
+		}
+	void writeBaseTile(unsigned int tileX,unsigned int tileY,const unsigned char* firstRow,ptrdiff_t rowStride) // Writes a full-resolution tile from image rows starting at the tile's lower-left corner, replicating edge pixels beyond the image's size
+		{
+		/* Determine the tile's valid region: */
+		unsigned int validWidth=size[0]-tileX*tileSize;
+		if(validWidth>tileSize)
+			validWidth=tileSize;
+		unsigned int validHeight=size[1]-tileY*tileSize;
+		if(validHeight>tileSize)
+			validHeight=tileSize;
+		
+		/* Assemble the tile: */
+		size_t validRowSize=size_t(validWidth)*pixelSize;
+		size_t tileRowSize=size_t(tileSize)*pixelSize;
+		unsigned char* tPtr=tileBuffer;
+		for(unsigned int y=0;y<tileSize;++y,tPtr+=tileRowSize)
+			{
+			if(y<validHeight)
+				{
+				/* Copy the row's valid pixels and replicate its last pixel: */
+				memcpy(tPtr,firstRow+ptrdiff_t(y)*rowStride,validRowSize);
+				for(unsigned char* pPtr=tPtr+validRowSize;pPtr!=tPtr+tileRowSize;pPtr+=pixelSize)
+					memcpy(pPtr,pPtr-pixelSize,pixelSize);
+				}
+			else
+				{
+				/* Replicate the last valid row: */
+				memcpy(tPtr,tPtr-tileRowSize,tileRowSize);
+				}
+			}
+		
+		writeTile(0,tileX,tileY,tileBuffer);
+		}
+	void writeBaseImage(const BaseImage& image) // Writes all full-resolution tiles from an in-memory image
+		{
+		const unsigned char* pixels=static_cast<const unsigned char*>(image.getPixels());
+		ptrdiff_t rowStride=image.getRowStride();
+		for(unsigned int tileY=0;tileY<levels[0].numTiles[1];++tileY)
+			for(unsigned int tileX=0;tileX<levels[0].numTiles[0];++tileX)
+				writeBaseTile(tileX,tileY,pixels+ptrdiff_t(tileY)*ptrdiff_t(tileSize)*rowStride+ptrdiff_t(tileX)*ptrdiff_t(tileSize)*ptrdiff_t(pixelSize),rowStride);
+		}
+	void shrinkTile(IO::SeekableFile& reader,unsigned int level,unsigned int tileX,unsigned int tileY) // Calculates a tile by downsampling up to four tiles of the next-finer level
+		{
+		const ImagePyramid::Level& child=levels[level-1];
+		
+		/* Assemble the child tiles into an image of twice the tile size: */
+		BaseImage block(tileSize*2,tileSize*2,numChannels,channelSize,format,scalarType);
+		unsigned char* blockPixels=static_cast<unsigned char*>(block.replacePixels());
+		ptrdiff_t blockRowStride=block.getRowStride();
+		size_t tileRowSize=size_t(tileSize)*pixelSize;
+		unsigned int numChildren[2];
+		for(int i=0;i<2;++i)
+			numChildren[i]=child.numTiles[i]>(i==0?tileX:tileY)*2+1?2:1;
+		for(unsigned int cy=0;cy<numChildren[1];++cy)
+			for(unsigned int cx=0;cx<numChildren[0];++cx)
+				{
+				/* Read the child tile's rows directly into the block: */
+				reader.setReadPosAbs(getTileOffset(child,tileX*2+cx,tileY*2+cy,tileDataSize));
+				unsigned char* bPtr=blockPixels+ptrdiff_t(cy*tileSize)*blockRowStride+ptrdiff_t(cx)*ptrdiff_t(tileRowSize);
+				for(unsigned int y=0;y<tileSize;++y,bPtr+=blockRowStride)
+					reader.readRaw(bPtr,tileRowSize);
+				}
+		
+		/* Replicate the edges of missing child tiles beyond the next-finer level's edges: */
+		if(numChildren[0]<2)
+			{
+			unsigned char* rowPtr=blockPixels;
+			for(unsigned int y=0;y<tileSize*numChildren[1];++y,rowPtr+=blockRowStride)
+				for(unsigned char* pPtr=rowPtr+tileRowSize;pPtr!=rowPtr+blockRowStride;pPtr+=pixelSize)
+					memcpy(pPtr,pPtr-pixelSize,pixelSize);
+			}
+		if(numChildren[1]<2)
+			{
+			unsigned char* rowPtr=blockPixels+ptrdiff_t(tileSize)*blockRowStride;
+			for(unsigned int y=tileSize;y<tileSize*2;++y,rowPtr+=blockRowStride)
+				memcpy(rowPtr,rowPtr-blockRowStride,blockRowStride);
+			}
+		
+		/* Downsample the block and write the result: */
+		BaseImage tile=block.shrink();
+		writeTile(level,tileX,tileY,tile.getPixels());
+		}
+	static void* shrinkThread(ShrinkArgs* args) // Thread function calculating tiles of a level until all are taken
+		{
+		PyramidBuilder* builder=args->builder;
+		const ImagePyramid::Level& level=builder->levels[args->level];
+		size_t numTiles=size_t(level.numTiles[1])*size_t(level.numTiles[0]);
+		try
+			{
+			/* Open a private reader for the pyramid file: */
+			IO::SeekableFilePtr reader=IO::openSeekableFile(builder->pyramidFileName.c_str());
+			
+			/* Claim and calculate tiles until all are taken: */
+			while(true)
+				{
+				size_t tileIndex=args->nextTile.preAdd(1)-1;
+				if(tileIndex>=numTiles)
+					break;
+				builder->shrinkTile(*reader,args->level,(unsigned int)(tileIndex%level.numTiles[0]),(unsigned int)(tileIndex/level.numTiles[0]));
+				}
+			}
+		catch(const std::runtime_error& err)
+			{
+			/* Remember the error and stop all threads: */
+			Threads::Mutex::Lock errorLock(args->errorMutex);
+			if(args->error.empty())
+				args->error=err.what();
+			args->nextTile.preAdd(numTiles);
+			}
+		
+		return 0;
+		}
+	void shrinkLevels(unsigned int numThreads) // Calculates all levels beyond the full-resolution level
+		{
+		for(unsigned int level=1;level<levels.size();++level)
+			{
+			/* Make the next-finer level visible to the readers: */
+			file->flush();
+			
+			/* Calculate all tiles of the level in parallel: */
+			ShrinkArgs args(this,level);
+			unsigned int levelThreads=numThreads;
+			size_t numTiles=size_t(levels[level].numTiles[1])*size_t(levels[level].numTiles[0]);
+			if(levelThreads>numTiles)
+				levelThreads=(unsigned int)(numTiles);
+			Threads::Thread* threads=new Threads::Thread[levelThreads-1];
+			for(unsigned int i=0;i<levelThreads-1;++i)
+				threads[i].start(&PyramidBuilder::shrinkThread,&args);
+			shrinkThread(&args);
+			for(unsigned int i=0;i<levelThreads-1;++i)
+				threads[i].join();
+			delete[] threads;
+			
+			if(!args.error.empty())
+				Misc::throwStdErr("Images::ImagePyramid::build: Unable to calculate level %u due to exception %s",level,args.error.c_str());
+			}
+		}
+	void finish(void) // Writes the pyramid file header after all tiles have been written
+		{
+		file->setWritePosAbs(0);
+		file->writeRaw(pyramidFileMagic,sizeof(pyramidFileMagic));
+		file->write<Misc::UInt32>(size[0]);
+		file->write<Misc::UInt32>(size[1]);
+		file->write<Misc::UInt32>(tileSize);
+		file->write<Misc::UInt32>(numChannels);
+		file->write<Misc::UInt32>(channelSize);
+		file->write<Misc::UInt32>(format);
+		file->write<Misc::UInt32>(scalarType);
+		file->flush();
+		}
+	};
+
+#if IMAGES_CONFIG_HAVE_TIFF
+
+class TIFFStreamer // Class to collect streamed TIFF image rows into bands of full-resolution tiles
+	{
+	/* Elements: */
+	private:
+	PyramidBuilder& builder; // The pyramid builder receiving tiles
+	size_t rowSize; // Size of an image row in bytes
+	std::vector<unsigned char*> bands; // Buffers for partially received bands of tile rows
+	std::vector<size_t> numReceived; // Number of pixels received for each band
+	
+	/* Constructors and destructors: */
+	public:
+	TIFFStreamer(PyramidBuilder& sBuilder)
+		:builder(sBuilder),
+		 rowSize(size_t(builder.size[0])*builder.pixelSize),
+		 bands(builder.levels[0].numTiles[1],0),
+		 numReceived(builder.levels[0].numTiles[1],0)
+		{
+		}
+	~TIFFStreamer(void)
+		{
+		for(std::vector<unsigned char*>::iterator bIt=bands.begin();bIt!=bands.end();++bIt)
+			delete[] *bIt;
+		}
+	
+	/* Methods: */
+	static void pixelCallback(uint32 x,uint32 y,uint32 width,uint16 channel,const uint8* pixels,void* userData) // Receives a row of interleaved pixels from the TIFF reader
+		{
+		TIFFStreamer* thisPtr=static_cast<TIFFStreamer*>(userData);
+		PyramidBuilder& builder=thisPtr->builder;
+		unsigned int tileSize=builder.tileSize;
+		
+		/* Copy the pixels into their band, creating it on first use: */
+		unsigned int bandIndex=y/tileSize;
+		unsigned char*& band=thisPtr->bands[bandIndex];
+		if(band==0)
+			band=new unsigned char[thisPtr->rowSize*tileSize];
+		memcpy(band+size_t(y-bandIndex*tileSize)*thisPtr->rowSize+size_t(x)*builder.pixelSize,pixels,size_t(width)*builder.pixelSize);
+		
+		/* Write the band's tiles once it is complete: */
+		unsigned int bandHeight=builder.size[1]-bandIndex*tileSize;
+		if(bandHeight>tileSize)
+			bandHeight=tileSize;
+		thisPtr->numReceived[bandIndex]+=width;
+		if(thisPtr->numReceived[bandIndex]==size_t(bandHeight)*size_t(builder.size[0]))
+			{
+			for(unsigned int tileX=0;tileX<builder.levels[0].numTiles[0];++tileX)
+				builder.writeBaseTile(tileX,bandIndex,band+size_t(tileX)*size_t(tileSize)*builder.pixelSize,ptrdiff_t(thisPtr->rowSize));
+			delete[] band;
+			band=0;
+			}
+		}
+	};
+
+#endif
+
+}
+
+/*****************************
+Methods of class ImagePyramid:
+*****************************/
+
+ImagePyramid::ImagePyramid(const char* pyramidFileName)
+	:file(IO::openSeekableFile(pyramidFileName))
+	{
+	/* Read and check the file header: */
+	char magic[sizeof(pyramidFileMagic)];
+	file->readRaw(magic,sizeof(magic));
+	if(memcmp(magic,pyramidFileMagic,sizeof(magic))!=0)
+		Misc::throwStdErr("Images::ImagePyramid: File %s is not an image pyramid file",pyramidFileName);
+	for(int i=0;i<2;++i)
+		size[i]=file->read<Misc::UInt32>();
+	tileSize=file->read<Misc::UInt32>();
+	numChannels=file->read<Misc::UInt32>();
+	channelSize=file->read<Misc::UInt32>();
+	format=GLenum(file->read<Misc::UInt32>());
+	scalarType=GLenum(file->read<Misc::UInt32>());
+	if(size[0]==0||size[1]==0||tileSize==0||numChannels==0||channelSize==0)
+		Misc::throwStdErr("Images::ImagePyramid: Invalid image layout in pyramid file %s",pyramidFileName);
+	
+	/* Calculate the layout of the resolution levels: */
+	tileDataSize=size_t(tileSize)*size_t(tileSize)*size_t(numChannels)*size_t(channelSize);
+	initLevels(size[0],size[1],tileSize,tileDataSize,levels);
+	
+	/* Check that the file contains all tiles: */
+	const Level& top=levels.back();
+	if(file->getSize()<top.offset+IO::SeekableFile::Offset(tileDataSize))
+		Misc::throwStdErr("Images::ImagePyramid: Pyramid file %s is truncated",pyramidFileName);
+	}
+
+bool ImagePyramid::isCurrent(const char* pyramidFileName,const char* imageFileName)
+	{
+	/* Check that the pyramid file exists and is newer than the image file: */
+	struct stat pyramidStat,imageStat;
+	if(stat(pyramidFileName,&pyramidStat)!=0||stat(imageFileName,&imageStat)!=0)
+		return false;
+	if(pyramidStat.st_mtime<imageStat.st_mtime)
+		return false;
+	
+	/* Check that the pyramid file is complete: */
+	try
+		{
+		ImagePyramid pyramid(pyramidFileName);
+		return true;
+		}
+	catch(const std::runtime_error&)
+		{
+		return false;
+		}
+	}
+
+void ImagePyramid::build(const char* imageFileName,const char* pyramidFileName,unsigned int tileSize,unsigned int numThreads)
+	{
+	if(tileSize==0)
+		throw std::runtime_error("Images::ImagePyramid::build: Invalid tile size");
+	if(numThreads==0)
+		{
+		/* Use one thread per CPU: */
+		long numCpus=sysconf(_SC_NPROCESSORS_ONLN);
+		numThreads=numCpus>0?(unsigned int)(numCpus):1U;
+		}
+	
+	Misc::SelfDestructPointer<PyramidBuilder> builder;
+	
+	#if IMAGES_CONFIG_HAVE_TIFF
+	if(getImageFileFormat(imageFileName)==IFF_TIFF)
+		{
+		/* Check if the TIFF image can be streamed: */
+		IO::FilePtr imageFile=IO::openFile(imageFileName);
+		TIFFReader reader(*imageFile);
+		if(!reader.isPlanar()&&!reader.isIndexed()&&reader.getNumBits()%8==0&&reader.getNumSamples()>=1&&reader.getNumSamples()<=4)
+			{
+			/* Determine the image's pixel format: */
+			static const GLenum formats[4]={GL_LUMINANCE,GL_LUMINANCE_ALPHA,GL_RGB,GL_RGBA};
+			GLenum scalarType=GL_NONE;
+			switch(reader.getNumBits())
+				{
+				case 8:
+					scalarType=reader.hasSignedIntSamples()?GL_BYTE:GL_UNSIGNED_BYTE;
+					break;
+				
+				case 16:
+					scalarType=reader.hasSignedIntSamples()?GL_SHORT:GL_UNSIGNED_SHORT;
+					break;
+				
+				case 32:
+					scalarType=reader.hasFloatSamples()?GL_FLOAT:(reader.hasSignedIntSamples()?GL_INT:GL_UNSIGNED_INT);
+					break;
+				}
+			
+			if(scalarType!=GL_NONE)
+				{
+				/* Stream the image into full-resolution tiles band by band: */
+				builder.setTarget(new PyramidBuilder(pyramidFileName,reader.getWidth(),reader.getHeight(),tileSize,reader.getNumSamples(),reader.getNumBits()/8,formats[reader.getNumSamples()-1],scalarType));
+				TIFFStreamer streamer(*builder);
+				reader.streamImage(&TIFFStreamer::pixelCallback,&streamer);
+				}
+			}
+		}
+	#endif
+	
+	if(!builder.isValid())
+		{
+		/* Read the entire image and split it into full-resolution tiles: */
+		BaseImage image=readGenericImageFile(imageFileName);
+		builder.setTarget(new PyramidBuilder(pyramidFileName,image.getWidth(),image.getHeight(),tileSize,image.getNumChannels(),image.getChannelSize(),image.getFormat(),image.getScalarType()));
+		builder->writeBaseImage(image);
+		}
+	
+	/* Calculate the lower-resolution levels and finish the pyramid file: */
+	builder->shrinkLevels(numThreads);
+	builder->finish();
+	}
+
+BaseImage ImagePyramid::readTile(unsigned int level,unsigned int tileX,unsigned int tileY) const
+	{
+	/* Read the tile's pixels: */
+	BaseImage result(tileSize,tileSize,numChannels,channelSize,format,scalarType);
+	{
+	Threads::Mutex::Lock fileLock(fileMutex);
+	file->setReadPosAbs(getTileOffset(levels[level],tileX,tileY,tileDataSize));
+	file->readRaw(result.replacePixels(),tileDataSize);
+	}
+	
+	return result;
+	}
+
+}
@@ -0,0 +1,114 @@
+/***********************************************************************
+ImagePyramid - Class to represent huge images as out-of-core pyramids
+of fixed-size tiles at successively halved resolutions, stored in a
+cache file that is built once from a source image file.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IMAGES_IMAGEPYRAMID_INCLUDED
+#define IMAGES_IMAGEPYRAMID_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Threads/Mutex.h>
+#include <IO/SeekableFile.h>
+#include <GL/gl.h>
+#include <Images/BaseImage.h>
+
+namespace Images {
+
+class ImagePyramid
+	{
+	/* Embedded classes: */
+	public:
+	struct Level // Structure describing one resolution level of the pyramid
+		{
+		/* Elements: */
+		public:
+		unsigned int size[2]; // Width and height of the level in pixels
+		unsigned int numTiles[2]; // Number of tiles covering the level in x and y
+		IO::SeekableFile::Offset offset; // Offset of the level's first tile in the pyramid file
+		};
+	
+	/* Elements: */
+	private:
+	mutable Threads::Mutex fileMutex; // Mutex serializing access to the pyramid file
+	IO::SeekableFilePtr file; // The pyramid file
+	unsigned int size[2]; // Width and height of the full-resolution image in pixels
+	unsigned int tileSize; // Width and height of all tiles in pixels
+	unsigned int numChannels; // Number of interleaved channels per pixel
+	unsigned int channelSize; // Storage size of one pixel component in bytes
+	GLenum format; // OpenGL pixel format of the image
+	GLenum scalarType; // OpenGL scalar type of the image
+	size_t tileDataSize; // Size of a tile's pixel data in bytes
+	std::vector<Level> levels; // Resolution levels, from full resolution (level 0) to a single tile
+	
+	/* Constructors and destructors: */
+	public:
+	ImagePyramid(const char* pyramidFileName); // Opens the pyramid cache file of the given name
+	private:
+	ImagePyramid(const ImagePyramid& source); // Prohibit copy constructor
+	ImagePyramid& operator=(const ImagePyramid& source); // Prohibit assignment operator
+	
+	/* Methods: */
+	public:
+	static bool isCurrent(const char* pyramidFileName,const char* imageFileName); // Returns true if the given pyramid cache file exists and is newer than the given source image file
+	static void build(const char* imageFileName,const char* pyramidFileName,unsigned int tileSize =256,unsigned int numThreads =0); // Builds a pyramid cache file from the given source image file using the given number of threads (0: one per CPU); streams TIFF images instead of loading them completely
+	const unsigned int* getSize(void) const // Returns the size of the full-resolution image
+		{
+		return size;
+		}
+	unsigned int getSize(int dimension) const // Returns one dimension of the full-resolution image's size
+		{
+		return size[dimension];
+		}
+	unsigned int getTileSize(void) const // Returns the width and height of all tiles
+		{
+		return tileSize;
+		}
+	unsigned int getNumChannels(void) const // Returns the number of pixel channels
+		{
+		return numChannels;
+		}
+	unsigned int getChannelSize(void) const // Returns the storage size of one pixel component in bytes
+		{
+		return channelSize;
+		}
+	GLenum getFormat(void) const // Returns the OpenGL pixel format of the image
+		{
+		return format;
+		}
+	GLenum getScalarType(void) const // Returns the OpenGL scalar type of the image
+		{
+		return scalarType;
+		}
+	unsigned int getNumLevels(void) const // Returns the number of resolution levels
+		{
+		return levels.size();
+		}
+	const Level& getLevel(unsigned int level) const // Returns the resolution level of the given index
+		{
+		return levels[level];
+		}
+	BaseImage readTile(unsigned int level,unsigned int tileX,unsigned int tileY) const; // Reads the tile of the given index from the given level; tiles at the right and top edges are padded by replicating edge pixels; can be called from multiple threads
+	};
+
+}
+
+#endif
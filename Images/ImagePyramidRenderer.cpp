@@ -0,0 +1,479 @@
+/***********************************************************************
+ImagePyramidRenderer - Class to render out-of-core image pyramids by
+selecting visible tiles at view-dependent resolutions, streaming them
+from the pyramid file on background threads into a memory-bounded tile
+cache, and uploading them into per-context texture caches.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Images/ImagePyramidRenderer.h>
+
+#include <vector>
+#include <stdexcept>
+#include <Misc/MessageLogger.h>
+#include <GL/GLContextData.h>
+#include <Images/ImagePyramid.h>
+
+namespace Images {
+
+/***********************************************
+Methods of class ImagePyramidRenderer::DataItem:
+***********************************************/
+
+ImagePyramidRenderer::DataItem::DataItem(void)
+	:textures(1031),
+	 frameIndex(~0U),numUploads(0),uploadsDeferred(false)
+	{
+	}
+
+ImagePyramidRenderer::DataItem::~DataItem(void)
+	{
+	/* Delete all texture objects: */
+	for(TextureCache::Iterator tIt=textures.begin();!tIt.isFinished();++tIt)
+		glDeleteTextures(1,&tIt->getDest().textureObjectId);
+	}
+
+/*************************************
+Methods of class ImagePyramidRenderer:
+*************************************/
+
+void* ImagePyramidRenderer::loaderThreadMethod(void)
+	{
+	while(true)
+		{
+		/* Pick the next tile to load: */
+		TileKey key;
+		{
+		Threads::Mutex::Lock cacheLock(cacheMutex);
+		bool haveKey=false;
+		while(!shutdown&&!haveKey)
+			{
+			/* Wait for tile requests: */
+			while(!shutdown&&requests.getNumEntries()==0)
+				requestCond.wait(cacheMutex);
+			if(shutdown)
+				break;
+			
+			/* Find the most recently requested tile, preferring coarser tiles, and drop requests that were not renewed during the previous frame: */
+			unsigned int currentFrame=frameIndex;
+			unsigned int bestFrame=0;
+			std::vector<TileKey> staleKeys;
+			for(RequestMap::Iterator rIt=requests.begin();!rIt.isFinished();++rIt)
+				{
+				if(currentFrame-rIt->getDest()>1U)
+					staleKeys.push_back(rIt->getSource());
+				else if(!haveKey||bestFrame<rIt->getDest()||(bestFrame==rIt->getDest()&&key.level<rIt->getSource().level))
+					{
+					key=rIt->getSource();
+					bestFrame=rIt->getDest();
+					haveKey=true;
+					}
+				}
+			for(std::vector<TileKey>::iterator skIt=staleKeys.begin();skIt!=staleKeys.end();++skIt)
+				requests.removeEntry(*skIt);
+			}
+		if(shutdown)
+			break;
+		
+		/* Move the tile from the request map to the loading set: */
+		requests.removeEntry(key);
+		loadingTiles.setEntry(TileSet::Entry(key));
+		}
+		
+		/* Load the tile: */
+		BaseImage tile;
+		try
+			{
+			tile=pyramid.readTile(key.level,key.tileX,key.tileY);
+			}
+		catch(const std::exception& err)
+			{
+			Misc::formattedConsoleError("Images::ImagePyramidRenderer: Unable to load tile %u/%u/%u due to exception %s",key.level,key.tileX,key.tileY,err.what());
+			}
+		catch(...)
+			{
+			Misc::formattedConsoleError("Images::ImagePyramidRenderer: Unable to load tile %u/%u/%u due to spurious exception",key.level,key.tileX,key.tileY);
+			}
+		
+		{
+		Threads::Mutex::Lock cacheLock(cacheMutex);
+		loadingTiles.removeEntry(key);
+		if(!tile.isValid())
+			{
+			/* Remember the failed tile so that it is not requested again: */
+			failedTiles.setEntry(TileSet::Entry(key));
+			continue;
+			}
+		
+		/* Add the tile to the tile cache: */
+		CachedTile cachedTile;
+		cachedTile.image=tile;
+		cachedTile.lastUsed=frameIndex;
+		tileCache.setEntry(TileCache::Entry(key,cachedTile));
+		
+		/* Evict least-recently used tiles that were not used during the current frame until the cache fits into its budget: */
+		while(tileCache.getNumEntries()>maxNumCachedTiles)
+			{
+			TileCache::Iterator lruIt;
+			for(TileCache::Iterator tcIt=tileCache.begin();!tcIt.isFinished();++tcIt)
+				if(tcIt->getDest().lastUsed!=frameIndex&&(lruIt.isFinished()||lruIt->getDest().lastUsed>tcIt->getDest().lastUsed))
+					lruIt=tcIt;
+			if(lruIt.isFinished())
+				break;
+			tileCache.removeEntry(lruIt);
+			}
+		}
+		
+		/* Notify the application: */
+		if(tileLoadedCallback!=0)
+			(*tileLoadedCallback)(this);
+		}
+	
+	return 0;
+	}
+
+BaseImage ImagePyramidRenderer::getCachedTile(const ImagePyramidRenderer::TileKey& key) const
+	{
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	
+	/* Return the tile if it is cached: */
+	TileCache::Iterator tcIt=tileCache.findEntry(key);
+	if(!tcIt.isFinished())
+		{
+		tcIt->getDest().lastUsed=frameIndex;
+		return tcIt->getDest().image;
+		}
+	
+	/* Request the tile unless it is already being loaded or previously failed to load: */
+	if(!loadingTiles.isEntry(key)&&!failedTiles.isEntry(key))
+		{
+		requests[key].getDest()=frameIndex;
+		requestCond.signal();
+		}
+	
+	return BaseImage();
+	}
+
+bool ImagePyramidRenderer::requestTile(const ImagePyramidRenderer::TileKey& key) const
+	{
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	
+	/* Check if the tile is cached: */
+	TileCache::Iterator tcIt=tileCache.findEntry(key);
+	if(!tcIt.isFinished())
+		{
+		tcIt->getDest().lastUsed=frameIndex;
+		return true;
+		}
+	
+	/* Request the tile unless it is already being loaded or previously failed to load: */
+	if(!loadingTiles.isEntry(key)&&!failedTiles.isEntry(key))
+		{
+		requests[key].getDest()=frameIndex;
+		requestCond.signal();
+		}
+	
+	return false;
+	}
+
+GLuint ImagePyramidRenderer::getTexture(ImagePyramidRenderer::DataItem* dataItem,const ImagePyramidRenderer::TileKey& key) const
+	{
+	/* Return the tile's texture object if the tile is resident: */
+	DataItem::TextureCache::Iterator tIt=dataItem->textures.findEntry(key);
+	if(!tIt.isFinished())
+		{
+		tIt->getDest().lastUsed=frameIndex;
+		return tIt->getDest().textureObjectId;
+		}
+	
+	/* Only request the tile if the upload limit for the current frame has been reached: */
+	if(dataItem->numUploads>=maxNumUploads)
+		{
+		if(requestTile(key))
+			dataItem->uploadsDeferred=true;
+		return 0;
+		}
+	
+	/* Retrieve the tile from the tile cache: */
+	BaseImage tile=getCachedTile(key);
+	if(!tile.isValid())
+		return 0;
+	
+	/* Create a new texture object or recycle the least-recently used one that was not used during the current frame: */
+	GLuint textureObjectId=0;
+	if(dataItem->textures.getNumEntries()<maxNumTextures)
+		glGenTextures(1,&textureObjectId);
+	else
+		{
+		DataItem::TextureCache::Iterator lruIt;
+		for(DataItem::TextureCache::Iterator tcIt=dataItem->textures.begin();!tcIt.isFinished();++tcIt)
+			if(tcIt->getDest().lastUsed!=frameIndex&&(lruIt.isFinished()||lruIt->getDest().lastUsed>tcIt->getDest().lastUsed))
+				lruIt=tcIt;
+		if(lruIt.isFinished())
+			return 0;
+		textureObjectId=lruIt->getDest().textureObjectId;
+		dataItem->textures.removeEntry(lruIt);
+		}
+	
+	/* Upload the tile: */
+	glBindTexture(GL_TEXTURE_2D,textureObjectId);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_BASE_LEVEL,0);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAX_LEVEL,0);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+	tile.glTexImage2D(GL_TEXTURE_2D,0);
+	++dataItem->numUploads;
+	
+	/* Add the texture object to the texture cache: */
+	DataItem::Texture texture;
+	texture.textureObjectId=textureObjectId;
+	texture.lastUsed=frameIndex;
+	dataItem->textures.setEntry(DataItem::TextureCache::Entry(key,texture));
+	
+	return textureObjectId;
+	}
+
+void ImagePyramidRenderer::renderTile(ImagePyramidRenderer::DataItem* dataItem,const double pmv[16],const double viewportSize[2],const ImagePyramidRenderer::TileKey& key,const ImagePyramidRenderer::TileKey& fallbackKey,GLuint fallbackTextureObjectId) const
+	{
+	/* Calculate the tile's extent in full-resolution image coordinates, clipped to the image: */
+	double tileSize(pyramid.getTileSize());
+	double levelScale(1U<<key.level);
+	double min[2],max[2];
+	min[0]=double(key.tileX)*tileSize*levelScale;
+	min[1]=double(key.tileY)*tileSize*levelScale;
+	for(int i=0;i<2;++i)
+		{
+		max[i]=min[i]+tileSize*levelScale;
+		if(max[i]>double(pyramid.getSize(i)))
+			max[i]=double(pyramid.getSize(i));
+		}
+	
+	/* Transform the tile's corners to clip space: */
+	double clip[4][4];
+	for(int corner=0;corner<4;++corner)
+		{
+		double x=(corner&0x1)!=0?max[0]:min[0];
+		double y=(corner&0x2)!=0?max[1]:min[1];
+		for(int i=0;i<4;++i)
+			clip[corner][i]=pmv[i]*x+pmv[4+i]*y+pmv[12+i];
+		}
+	
+	/* Cull the tile if all its corners are outside the same view frustum plane: */
+	for(int i=0;i<3;++i)
+		{
+		int numAbove=0;
+		int numBelow=0;
+		for(int corner=0;corner<4;++corner)
+			{
+			if(clip[corner][i]>clip[corner][3])
+				++numAbove;
+			if(clip[corner][i]<-clip[corner][3])
+				++numBelow;
+			}
+		if(numAbove==4||numBelow==4)
+			return;
+		}
+	
+	/* Refine the tile if it crosses the eye plane or any of its edges is projected larger than the tile size: */
+	bool refine=false;
+	if(key.level>0)
+		{
+		double screen[4][2];
+		for(int corner=0;corner<4&&!refine;++corner)
+			{
+			if(clip[corner][3]>0.0)
+				{
+				for(int i=0;i<2;++i)
+					screen[corner][i]=clip[corner][i]/clip[corner][3]*viewportSize[i]*0.5;
+				}
+			else
+				refine=true;
+			}
+		if(!refine)
+			{
+			static const int edges[4][2]={{0,1},{2,3},{0,2},{1,3}};
+			double maxEdgeLength=tileSize*lodBias;
+			for(int edge=0;edge<4&&!refine;++edge)
+				{
+				const double* p0=screen[edges[edge][0]];
+				const double* p1=screen[edges[edge][1]];
+				refine=(p1[0]-p0[0])*(p1[0]-p0[0])+(p1[1]-p0[1])*(p1[1]-p0[1])>maxEdgeLength*maxEdgeLength;
+				}
+			}
+		}
+	
+	/* Use the tile itself as fallback for its children if it is resident; request it otherwise: */
+	TileKey childFallbackKey=fallbackKey;
+	GLuint childFallbackTextureObjectId=fallbackTextureObjectId;
+	GLuint textureObjectId=getTexture(dataItem,key);
+	if(textureObjectId!=0)
+		{
+		childFallbackKey=key;
+		childFallbackTextureObjectId=textureObjectId;
+		}
+	
+	if(refine)
+		{
+		/* Render the tile's children: */
+		const ImagePyramid::Level& childLevel=pyramid.getLevel(key.level-1);
+		for(unsigned int cy=0;cy<2;++cy)
+			for(unsigned int cx=0;cx<2;++cx)
+				{
+				TileKey childKey(key.level-1,key.tileX*2+cx,key.tileY*2+cy);
+				if(childKey.tileX<childLevel.numTiles[0]&&childKey.tileY<childLevel.numTiles[1])
+					renderTile(dataItem,pmv,viewportSize,childKey,childFallbackKey,childFallbackTextureObjectId);
+				}
+		}
+	else if(childFallbackTextureObjectId!=0)
+		{
+		/* Render the tile's extent using the tile's texture or the nearest resident ancestor's texture: */
+		glBindTexture(GL_TEXTURE_2D,childFallbackTextureObjectId);
+		double texScale=1.0/(tileSize*double(1U<<childFallbackKey.level));
+		double texMin[2],texMax[2];
+		texMin[0]=min[0]*texScale-double(childFallbackKey.tileX);
+		texMin[1]=min[1]*texScale-double(childFallbackKey.tileY);
+		texMax[0]=max[0]*texScale-double(childFallbackKey.tileX);
+		texMax[1]=max[1]*texScale-double(childFallbackKey.tileY);
+		glBegin(GL_QUADS);
+		glTexCoord2d(texMin[0],texMin[1]);
+		glVertex2d(min[0],min[1]);
+		glTexCoord2d(texMax[0],texMin[1]);
+		glVertex2d(max[0],min[1]);
+		glTexCoord2d(texMax[0],texMax[1]);
+		glVertex2d(max[0],max[1]);
+		glTexCoord2d(texMin[0],texMax[1]);
+		glVertex2d(min[0],max[1]);
+		glEnd();
+		}
+	}
+
+ImagePyramidRenderer::ImagePyramidRenderer(const ImagePyramid& sPyramid,size_t memoryBudget,size_t textureBudget,unsigned int sNumLoaderThreads)
+	:pyramid(sPyramid),
+	 tileDataSize(size_t(pyramid.getTileSize())*size_t(pyramid.getTileSize())*size_t(pyramid.getNumChannels())*size_t(pyramid.getChannelSize())),
+	 maxNumCachedTiles(memoryBudget/tileDataSize),
+	 maxNumTextures((unsigned int)(textureBudget/tileDataSize)),
+	 maxNumUploads(8),lodBias(1.0),
+	 frameIndex(0),
+	 tileCache(1031),requests(101),loadingTiles(17),failedTiles(17),
+	 shutdown(false),
+	 numLoaderThreads(sNumLoaderThreads>0?sNumLoaderThreads:1),loaderThreads(0),
+	 tileLoadedCallback(0)
+	{
+	/* Keep at least enough tiles to cover the coarsest levels: */
+	if(maxNumCachedTiles<16)
+		maxNumCachedTiles=16;
+	if(maxNumTextures<16)
+		maxNumTextures=16;
+	
+	/* Start the background threads: */
+	loaderThreads=new Threads::Thread[numLoaderThreads];
+	for(unsigned int i=0;i<numLoaderThreads;++i)
+		loaderThreads[i].start(this,&ImagePyramidRenderer::loaderThreadMethod);
+	}
+
+ImagePyramidRenderer::~ImagePyramidRenderer(void)
+	{
+	/* Shut down the background threads: */
+	{
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	shutdown=true;
+	requestCond.broadcast();
+	}
+	for(unsigned int i=0;i<numLoaderThreads;++i)
+		loaderThreads[i].join();
+	delete[] loaderThreads;
+	
+	delete tileLoadedCallback;
+	}
+
+void ImagePyramidRenderer::initContext(GLContextData& contextData) const
+	{
+	/* Create a context data item and store it in the context: */
+	DataItem* dataItem=new DataItem;
+	contextData.addDataItem(this,dataItem);
+	}
+
+void ImagePyramidRenderer::setTileLoadedCallback(ImagePyramidRenderer::TileLoadedCallback* newTileLoadedCallback)
+	{
+	delete tileLoadedCallback;
+	tileLoadedCallback=newTileLoadedCallback;
+	}
+
+void ImagePyramidRenderer::setMaxNumUploads(unsigned int newMaxNumUploads)
+	{
+	maxNumUploads=newMaxNumUploads;
+	}
+
+void ImagePyramidRenderer::setLodBias(double newLodBias)
+	{
+	lodBias=newLodBias;
+	}
+
+void ImagePyramidRenderer::startFrame(void)
+	{
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	++frameIndex;
+	}
+
+void ImagePyramidRenderer::glRenderAction(GLContextData& contextData) const
+	{
+	/* Get the context data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	
+	/* Reset the upload limit at the beginning of a new frame: */
+	if(dataItem->frameIndex!=frameIndex)
+		{
+		dataItem->frameIndex=frameIndex;
+		dataItem->numUploads=0;
+		}
+	dataItem->uploadsDeferred=false;
+	
+	/* Calculate the combined projection and modelview matrix: */
+	double proj[16],mv[16];
+	glGetDoublev(GL_PROJECTION_MATRIX,proj);
+	glGetDoublev(GL_MODELVIEW_MATRIX,mv);
+	double pmv[16];
+	for(int j=0;j<4;++j)
+		for(int i=0;i<4;++i)
+			{
+			pmv[j*4+i]=0.0;
+			for(int k=0;k<4;++k)
+				pmv[j*4+i]+=proj[k*4+i]*mv[j*4+k];
+			}
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT,viewport);
+	double viewportSize[2];
+	for(int i=0;i<2;++i)
+		viewportSize[i]=double(viewport[2+i]);
+	
+	/* Render the pyramid starting from its single top-level tile: */
+	glPushAttrib(GL_TEXTURE_BIT);
+	TileKey topKey(pyramid.getNumLevels()-1,0,0);
+	renderTile(dataItem,pmv,viewportSize,topKey,topKey,0);
+	glBindTexture(GL_TEXTURE_2D,0);
+	glPopAttrib();
+	
+	/* Ask for another frame if cached tiles are waiting to be uploaded: */
+	if(dataItem->uploadsDeferred&&tileLoadedCallback!=0)
+		(*tileLoadedCallback)(this);
+	}
+
+}
@@ -0,0 +1,164 @@
+/***********************************************************************
+ImagePyramidRenderer - Class to render out-of-core image pyramids by
+selecting visible tiles at view-dependent resolutions, streaming them
+from the pyramid file on background threads into a memory-bounded tile
+cache, and uploading them into per-context texture caches.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IMAGES_IMAGEPYRAMIDRENDERER_INCLUDED
+#define IMAGES_IMAGEPYRAMIDRENDERER_INCLUDED
+
+#include <stddef.h>
+#include <Misc/HashTable.h>
+#include <Misc/FunctionCalls.h>
+#include <Threads/Mutex.h>
+#include <Threads/Cond.h>
+#include <Threads/Thread.h>
+#include <GL/gl.h>
+#include <GL/GLObject.h>
+#include <Images/BaseImage.h>
+
+/* Forward declarations: */
+namespace Images {
+class ImagePyramid;
+}
+
+namespace Images {
+
+class ImagePyramidRenderer:public GLObject
+	{
+	/* Embedded classes: */
+	public:
+	typedef Misc::FunctionCall<const ImagePyramidRenderer*> TileLoadedCallback; // Type for callbacks called, possibly from a background thread, when loaded tiles are waiting to be displayed
+	
+	private:
+	struct TileKey // Structure identifying a tile in the pyramid
+		{
+		/* Elements: */
+		public:
+		unsigned int level; // Resolution level of the tile
+		unsigned int tileX,tileY; // Index of the tile inside its level
+		
+		/* Constructors and destructors: */
+		TileKey(void)
+			{
+			}
+		TileKey(unsigned int sLevel,unsigned int sTileX,unsigned int sTileY)
+			:level(sLevel),tileX(sTileX),tileY(sTileY)
+			{
+			}
+		
+		/* Methods: */
+		friend bool operator==(const TileKey& k1,const TileKey& k2)
+			{
+			return k1.level==k2.level&&k1.tileX==k2.tileX&&k1.tileY==k2.tileY;
+			}
+		friend bool operator!=(const TileKey& k1,const TileKey& k2)
+			{
+			return k1.level!=k2.level||k1.tileX!=k2.tileX||k1.tileY!=k2.tileY;
+			}
+		static size_t hash(const TileKey& source,size_t tableSize)
+			{
+			return ((size_t(source.level)*1000003U+size_t(source.tileY))*1000003U+size_t(source.tileX))%tableSize;
+			}
+		};
+	
+	struct CachedTile // Structure for a tile in the in-memory tile cache
+		{
+		/* Elements: */
+		public:
+		BaseImage image; // The tile's pixels
+		unsigned int lastUsed; // Index of the frame in which the tile was last used
+		};
+	
+	typedef Misc::HashTable<TileKey,CachedTile,TileKey> TileCache; // Type for hash tables mapping tile keys to cached tiles
+	typedef Misc::HashTable<TileKey,unsigned int,TileKey> RequestMap; // Type for hash tables mapping tile keys to the index of the frame in which they were last requested
+	typedef Misc::HashTable<TileKey,void,TileKey> TileSet; // Type for hash sets of tile keys
+	
+	struct DataItem:public GLObject::DataItem
+		{
+		/* Embedded classes: */
+		public:
+		struct Texture // Structure for a texture object holding a tile
+			{
+			/* Elements: */
+			public:
+			GLuint textureObjectId; // ID of the texture object
+			unsigned int lastUsed; // Index of the frame in which the texture was last used
+			};
+		
+		typedef Misc::HashTable<TileKey,Texture,TileKey> TextureCache; // Type for hash tables mapping tile keys to texture objects
+		
+		/* Elements: */
+		TextureCache textures; // Texture objects of currently resident tiles
+		unsigned int frameIndex; // Index of the frame in which the texture cache was last used
+		unsigned int numUploads; // Number of tiles uploaded during the current frame
+		bool uploadsDeferred; // Flag whether cached tiles could not be uploaded during the current frame due to the upload limit
+		
+		/* Constructors and destructors: */
+		DataItem(void);
+		virtual ~DataItem(void);
+		};
+	
+	/* Elements: */
+	const ImagePyramid& pyramid; // The rendered image pyramid
+	size_t tileDataSize; // Size of a tile's pixels in bytes
+	size_t maxNumCachedTiles; // Maximum number of tiles in the in-memory tile cache
+	unsigned int maxNumTextures; // Maximum number of texture objects per OpenGL context
+	unsigned int maxNumUploads; // Maximum number of tiles uploaded per frame and OpenGL context
+	double lodBias; // Factor for the projected size of a tile in pixels, relative to the tile size, beyond which the tile is refined
+	volatile unsigned int frameIndex; // Index of the current frame
+	mutable Threads::Mutex cacheMutex; // Mutex protecting the tile cache and the request map
+	mutable Threads::Cond requestCond; // Condition variable signalling new tile requests or shutdown
+	mutable TileCache tileCache; // In-memory cache of loaded tiles
+	mutable RequestMap requests; // Map of requested tiles that are neither cached nor being loaded
+	mutable TileSet loadingTiles; // Set of tiles currently being loaded by background threads
+	TileSet failedTiles; // Set of tiles that could not be loaded and are not requested again
+	bool shutdown; // Flag to shut down the background threads
+	unsigned int numLoaderThreads; // Number of background threads loading tiles
+	Threads::Thread* loaderThreads; // Array of background threads loading tiles
+	TileLoadedCallback* tileLoadedCallback; // Callback called when loaded tiles are waiting to be displayed
+	
+	/* Private methods: */
+	void* loaderThreadMethod(void); // Method running the background threads
+	BaseImage getCachedTile(const TileKey& key) const; // Returns the tile of the given key from the tile cache and requests it if it is not cached; returns invalid image if tile is not cached
+	bool requestTile(const TileKey& key) const; // Requests the tile of the given key if it is neither cached nor being loaded; returns true if the tile is cached
+	GLuint getTexture(DataItem* dataItem,const TileKey& key) const; // Returns a texture object holding the tile of the given key, or 0 if the tile is not resident yet
+	void renderTile(DataItem* dataItem,const double pmv[16],const double viewportSize[2],const TileKey& key,const TileKey& fallbackKey,GLuint fallbackTextureObjectId) const; // Renders the given tile or its children, or the given fallback tile if the tile is not resident yet
+	
+	/* Constructors and destructors: */
+	public:
+	ImagePyramidRenderer(const ImagePyramid& sPyramid,size_t memoryBudget,size_t textureBudget,unsigned int sNumLoaderThreads =2); // Creates a renderer for the given pyramid with the given tile cache and per-context texture memory budgets in bytes
+	virtual ~ImagePyramidRenderer(void);
+	
+	/* Methods from GLObject: */
+	virtual void initContext(GLContextData& contextData) const;
+	
+	/* New methods: */
+	void setTileLoadedCallback(TileLoadedCallback* newTileLoadedCallback); // Sets the callback called when loaded tiles are waiting to be displayed; adopts callback object
+	void setMaxNumUploads(unsigned int newMaxNumUploads); // Sets the maximum number of tiles uploaded per frame and OpenGL context
+	void setLodBias(double newLodBias); // Sets the refinement threshold for tiles relative to their size in pixels
+	void startFrame(void); // Starts a new frame; must be called once per frame before rendering
+	void glRenderAction(GLContextData& contextData) const; // Renders the visible parts of the image into the z=0 plane, one unit per full-resolution pixel, using the current OpenGL transformations; caller must enable 2D texture mapping
+	};
+
+}
+
+#endif
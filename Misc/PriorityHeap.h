@@ -199,6 +199,12 @@ class PriorityHeap
 		
 		return *this;
 		}
+	void clear(void) // Removes all elements from the heap without releasing its memory
+		{
+		for(size_t i=0;i<numElements;++i)
+			heap[i].~Content();
+		numElements=0;
+		}
 	bool isEmpty(void) const
 		{
 		return numElements==0;
@@ -204,6 +204,7 @@ class FactoryManager
 		{
 		return dsoLocator;
 		}
+	std::string locateDso(const char* className); // Returns the full path of the DSO containing the object class of the given name; throws exception if the DSO does not exist
 	ManagedFactory* loadClass(const char* className); // Loads an object class at runtime and returns class object pointer
 	void addClass(ManagedFactory* newFactory,DestroyFactoryFunction newDestroyFactoryFunction =0); // Adds an existing factory to the manager
 	void releaseClass(ManagedFactory* factory); // Destroys an object class at runtime; throws exception if class cannot be removed due to dependencies
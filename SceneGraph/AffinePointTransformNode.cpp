@@ -82,6 +82,13 @@ unsigned int AffinePointTransformNode::update(void)
 	return NoCascade;
 	}
 
+void AffinePointTransformNode::transformPointBlock(size_t numPoints,const Point points[],PointTransformNode::TPoint transformedPoints[]) const
+	{
+	/* Transform all points without going through the virtual per-point method: */
+	for(size_t i=0;i<numPoints;++i)
+		transformedPoints[i]=transform.transform(TPoint(points[i]));
+	}
+
 PointTransformNode::TPoint AffinePointTransformNode::transformPoint(const PointTransformNode::TPoint& point) const
 	{
 	return transform.transform(point);
@@ -94,13 +101,8 @@ PointTransformNode::TPoint AffinePointTransformNode::inverseTransformPoint(const
 
 PointTransformNode::TBox AffinePointTransformNode::calcBoundingBox(const std::vector<Point>& points) const
 	{
-	TBox result=Box::empty;
-	
-	/* Transform all points individually: */
-	for(std::vector<Point>::const_iterator pIt=points.begin();pIt!=points.end();++pIt)
-		result.addPoint(transform.transform(TPoint(*pIt)));
-	
-	return result;
+	/* Transform all points in batches: */
+	return calcBatchBoundingBox(points);
 	}
 
 PointTransformNode::TBox AffinePointTransformNode::calcBoundingBox(const std::vector<Point>& points,const std::vector<int>& pointIndices) const
@@ -197,6 +197,19 @@ unsigned int GeodeticToCartesianPointTransformNode::update(void)
 	return NoCascade;
 	}
 
+void GeodeticToCartesianPointTransformNode::transformPointBlock(size_t numPoints,const Point points[],PointTransformNode::TPoint transformedPoints[]) const
+	{
+	/* Convert the geodetic points to longitude and latitude in radians and elevation in meters: */
+	for(size_t i=0;i<numPoints;++i)
+		for(int j=0;j<3;++j)
+			transformedPoints[i][j]=TScalar(points[i][componentIndices[j]])*componentScales[j]+componentOffsets[j];
+	
+	/* Transform the geodetic points to Cartesian coordinates in place: */
+	re->geodeticToCartesian(numPoints,transformedPoints,transformedPoints);
+	for(size_t i=0;i<numPoints;++i)
+		transformedPoints[i]+=offset;
+	}
+
 PointTransformNode::TPoint GeodeticToCartesianPointTransformNode::transformPoint(const PointTransformNode::TPoint& point) const
 	{
 	/* Convert the geodetic point to longitude and latitude in radians and elevation in meters: */
@@ -222,13 +235,8 @@ PointTransformNode::TPoint GeodeticToCartesianPointTransformNode::inverseTransfo
 
 PointTransformNode::TBox GeodeticToCartesianPointTransformNode::calcBoundingBox(const std::vector<Point>& points) const
 	{
-	TBox result=TBox::empty;
-	
-	/* Transform each point individually: */
-	for(std::vector<Point>::const_iterator pIt=points.begin();pIt!=points.end();++pIt)
-		result.addPoint(transformPoint(TPoint(*pIt)));
-	
-	return result;
+	/* Transform all points in batches: */
+	return calcBatchBoundingBox(points);
 	}
 
 PointTransformNode::TBox GeodeticToCartesianPointTransformNode::calcBoundingBox(const std::vector<Point>& points,const std::vector<int>& pointIndices) const
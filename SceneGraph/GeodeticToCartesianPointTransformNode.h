@@ -69,6 +69,9 @@ class GeodeticToCartesianPointTransformNode:public PointTransformNode
 	virtual unsigned int update(void);
 	
 	/* Methods from class PointTransformNode: */
+	protected:
+	virtual void transformPointBlock(size_t numPoints,const Point points[],TPoint transformedPoints[]) const;
+	public:
 	virtual TPoint transformPoint(const TPoint& point) const;
 	virtual TPoint inverseTransformPoint(const TPoint& point) const;
 	virtual TBox calcBoundingBox(const std::vector<Point>& points) const;
@@ -39,13 +39,68 @@ const char* GroupNode::className="Group";
 Methods of class GroupNode:
 **************************/
 
+void GroupNode::countPassMask(GraphNode::PassMask childPassMask,int increment)
+	{
+	/* Adjust the counters of all passes in which the child participates: */
+	for(int bit=0;childPassMask!=0x0U;++bit,childPassMask>>=1)
+		if(childPassMask&0x1U)
+			passCounts[bit]+=increment;
+	}
+
+GraphNode::PassMask GroupNode::calcCountedPassMask(void) const
+	{
+	/* The group participates in all passes in which at least one child participates: */
+	PassMask result=0x0U;
+	for(int bit=0;bit<numPassBits;++bit)
+		if(passCounts[bit]!=0)
+			result|=PassMask(0x1U)<<bit;
+	return result;
+	}
+
+void GroupNode::countChild(GraphNode* child,size_t index)
+	{
+	ChildStateMap::Iterator csIt=childStates.findEntry(child);
+	if(csIt.isFinished())
+		{
+		/* Add a new state for the child and count its pass mask: */
+		ChildState newState;
+		newState.numInstances=1;
+		newState.index=index;
+		newState.passMask=child->getPassMask();
+		childStates.setEntry(ChildStateMap::Entry(child,newState));
+		countPassMask(newState.passMask,1);
+		}
+	else
+		{
+		/* Count another instance of the child; distinct children only contribute once to the pass counters: */
+		++csIt->getDest().numInstances;
+		}
+	}
+
+void GroupNode::recountChildren(void)
+	{
+	/* Reset the bookkeeping state: */
+	childStates.clear();
+	for(int bit=0;bit<numPassBits;++bit)
+		passCounts[bit]=0;
+	
+	/* Count all current children: */
+	ChildList& c=children.getValues();
+	for(size_t i=0;i<c.size();++i)
+		countChild(c[i].getPointer(),i);
+	childrenChanged=false;
+	}
+
 GroupNode::GroupNode(void)
 	:bboxCenter(Point::origin),
 	 bboxSize(Size(-1,-1,-1)),
-	 explicitBoundingBox(0)
+	 explicitBoundingBox(0),
+	 childStates(17),childrenChanged(false),haveChildrenEventIn(false)
 	{
 	/* An empty group node does not participate in any processing: */
 	passMask=0x0U;
+	for(int bit=0;bit<numPassBits;++bit)
+		passCounts[bit]=0;
 	}
 
 GroupNode::~GroupNode(void)
@@ -73,7 +128,11 @@ EventIn* GroupNode::getEventIn(const char* fieldName)
 	else if(strcmp(fieldName,"removeChildren")==0)
 		return makeEventIn(this,removeChildren);
 	else if(strcmp(fieldName,"children")==0)
+		{
+		/* Events can replace the children field, which has to be recounted on every update from now on: */
+		haveChildrenEventIn=true;
 		return makeEventIn(this,children);
+		}
 	else
 		return GraphNode::getEventIn(fieldName);
 	}
@@ -85,9 +144,8 @@ void GroupNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 		vrmlFile.parseMFNode(children);
 		
 		/* Initialize the pass mask based on the new contents of the children field: */
-		passMask=0x0U;
-		for(ChildList::iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-			passMask|=(*chIt)->getPassMask();
+		recountChildren();
+		passMask=calcCountedPassMask();
 		}
 	else if(strcmp(fieldName,"bboxCenter")==0)
 		{
@@ -103,28 +161,24 @@ void GroupNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 unsigned int GroupNode::update(void)
 	{
+	/* Rebuild the child bookkeeping if the children field was changed directly, or might have been changed by an event: */
+	if(childrenChanged||haveChildrenEventIn)
+		recountChildren();
+	
 	/* Process the lists of children to add and children to remove: */
 	MFGraphNode::ValueList& c=children.getValues();
 	
-	/* Keep track of the pass mask: */
-	PassMask newPassMask=passMask;
-	
 	MFGraphNode::ValueList& ac=addChildren.getValues();
 	if(!ac.empty())
 		{
 		for(MFGraphNode::ValueList::iterator acIt=ac.begin();acIt!=ac.end();++acIt)
 			{
 			/* Check if the child is already in the list: */
-			MFGraphNode::ValueList::iterator cIt;
-			for(cIt=c.begin();cIt!=c.end()&&*cIt!=*acIt;++cIt)
-				;
-			if(cIt==c.end())
+			if(!childStates.isEntry(acIt->getPointer()))
 				{
-				/* Add the child to the list: */
+				/* Add the child to the list and count its pass mask: */
+				countChild(acIt->getPointer(),c.size());
 				c.push_back(*acIt);
-				
-				/* Update the pass mask: */
-				newPassMask|=(*acIt)->getPassMask();
 				}
 			}
 		ac.clear();
@@ -136,28 +190,36 @@ unsigned int GroupNode::update(void)
 		bool removedAChild=false;
 		for(MFGraphNode::ValueList::iterator rcIt=rc.begin();rcIt!=rc.end();++rcIt)
 			{
-			/* Remove all instances of the child from the list: */
-			for(MFGraphNode::ValueList::iterator cIt=c.begin();cIt!=c.end();)
+			/* Forget all instances of the child: */
+			ChildStateMap::Iterator csIt=childStates.findEntry(rcIt->getPointer());
+			if(!csIt.isFinished())
 				{
-				if(*cIt==*rcIt)
-					{
-					/* Remove the child: */
-					c.erase(cIt);
-					removedAChild=true;
-					}
-				else
-					++cIt;
+				countPassMask(csIt->getDest().passMask,-1);
+				childStates.removeEntry(csIt);
+				removedAChild=true;
 				}
 			}
-		rc.clear();
 		
 		if(removedAChild)
 			{
-			/* Need to recalculate the pass mask by querying all remaining children: */
-			newPassMask=0x0U;
-			for(ChildList::iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-				newPassMask|=(*chIt)->getPassMask();
+			/* Compact the children list in a single pass, retaining only children that are still counted, and record their new positions: */
+			size_t destIndex=0;
+			for(size_t i=0;i<c.size();++i)
+				{
+				ChildStateMap::Iterator csIt=childStates.findEntry(c[i].getPointer());
+				if(!csIt.isFinished())
+					{
+					csIt->getDest().index=destIndex;
+					if(destIndex!=i)
+						c[destIndex]=c[i];
+					++destIndex;
+					}
+				}
+			c.erase(c.begin()+destIndex,c.end());
 			}
+		
+		/* Release the removed children only after the children list has been compacted: */
+		rc.clear();
 		}
 	
 	/* Calculate the explicit bounding box, if one is given: */
@@ -184,8 +246,8 @@ unsigned int GroupNode::update(void)
 		explicitBoundingBox=0;
 		}
 	
-	/* Set the new pass mask: */
-	return setPassMask(newPassMask);
+	/* Set the new pass mask from the pass counters: */
+	return setPassMask(calcCountedPassMask());
 	}
 
 unsigned int GroupNode::cascadingUpdate(Node& child,unsigned int childUpdateResult)
@@ -193,23 +255,26 @@ unsigned int GroupNode::cascadingUpdate(Node& child,unsigned int childUpdateResu
 	unsigned int result=NoCascade;
 	
 	/* Act depending on the node's update result: */
-	if(childUpdateResult==CascadePassAdded)
+	if(childUpdateResult==CascadePassAdded||childUpdateResult==CascadePassRemoved||childUpdateResult==CascadePassMaskChanged)
 		{
-		/* Check if the node's new pass mask changes this node's pass mask: */
-		PassMask newPassMask=passMask|static_cast<GraphNode*>(&child)->getPassMask();
-		if(passMask!=newPassMask)
+		GraphNode* graphChild=static_cast<GraphNode*>(&child);
+		ChildStateMap::Iterator csIt=childStates.findEntry(graphChild);
+		if(!csIt.isFinished())
 			{
-			passMask=newPassMask;
-			result=CascadePassAdded;
+			/* Replace the child's old pass mask with its new one in the pass counters: */
+			ChildState& cs=csIt->getDest();
+			countPassMask(cs.passMask,-1);
+			cs.passMask=graphChild->getPassMask();
+			countPassMask(cs.passMask,1);
 			}
-		}
-	else if(childUpdateResult==CascadePassRemoved||childUpdateResult==CascadePassMaskChanged)
-		{
-		/* Recalculate the pass mask from scratch as the union of all children's pass masks: */
-		PassMask newPassMask=0x0U;
-		for(ChildList::iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-			newPassMask|=(*chIt)->getPassMask();
-		result=setPassMask(newPassMask);
+		else
+			{
+			/* The child is not known; recount all children from scratch: */
+			recountChildren();
+			}
+		
+		/* Calculate the new pass mask from the pass counters: */
+		result=setPassMask(calcCountedPassMask());
 		}
 	
 	return result;
@@ -232,16 +297,13 @@ Box GroupNode::calcBoundingBox(void) const
 
 unsigned int GroupNode::updatePassMask(void)
 	{
-	/* Recalculate the pass mask from scratch by telling all children to update theirs, and then calculate the union of the results: */
-	PassMask newPassMask=0x0U;
+	/* Recalculate the pass mask from scratch by telling all children to update theirs, and then counting the results: */
 	for(ChildList::iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-		{
 		(*chIt)->updatePassMask();
-		newPassMask|=(*chIt)->getPassMask();
-		}
+	recountChildren();
 	
 	/* Set the new pass mask: */
-	return setPassMask(newPassMask);
+	return setPassMask(calcCountedPassMask());
 	}
 
 void GroupNode::testCollision(SphereCollisionQuery& collisionQuery) const
@@ -273,43 +335,78 @@ void GroupNode::alRenderAction(ALRenderState& renderState) const
 
 unsigned int GroupNode::addChild(GraphNode& child)
 	{
-	/* Add the child to the children field: */
+	/* Rebuild the child bookkeeping if the children field was changed directly: */
+	if(childrenChanged)
+		recountChildren();
+	
+	/* Count the child at the end of the children field and add it: */
+	countChild(&child,children.getValues().size());
 	children.appendValue(&child);
 	
 	/* Update the processing pass mask: */
-	PassMask newPassMask=passMask|child.getPassMask();
-	if(passMask!=newPassMask)
-		{
-		passMask=newPassMask;
-		return CascadePassAdded;
-		}
-	else
-		return NoCascade;
+	return setPassMask(calcCountedPassMask());
 	}
 
 unsigned int GroupNode::removeChild(GraphNode& child)
 	{
-	/* Remove the first instance of the child from the children field: */
-	children.removeFirstValue(&child);
+	/* Rebuild the child bookkeeping if the children field was changed directly: */
+	if(childrenChanged)
+		recountChildren();
 	
-	/* Need to recalculate the pass mask by querying all remaining children: */
-	PassMask newPassMask=0x0U;
-	for(ChildList::iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-		newPassMask|=(*chIt)->getPassMask();
+	/* Bail out if the child is not in the group: */
+	ChildStateMap::Iterator csIt=childStates.findEntry(&child);
+	if(csIt.isFinished())
+		return NoCascade;
 	
-	if(passMask!=newPassMask)
+	/* Find the child's first instance in the children list: */
+	ChildList& c=children.getValues();
+	ChildState& cs=csIt->getDest();
+	size_t index;
+	if(cs.numInstances==1)
 		{
-		passMask=newPassMask;
-		return CascadePassRemoved;
+		/* Children only move towards the front when earlier children are removed, so search backwards from the recorded position: */
+		index=cs.index<c.size()?cs.index:c.size()-1;
+		while(c[index]!=&child)
+			--index;
 		}
 	else
-		return NoCascade;
+		{
+		/* Later instances might have moved in front of the recorded position; search from the front: */
+		index=0;
+		while(c[index]!=&child)
+			++index;
+		}
+	
+	/* Keep the child alive until the children field has been updated: */
+	GraphNodePointer removedChild=c[index];
+	
+	/* Remove the first instance while retaining the order of the remaining children: */
+	c.erase(c.begin()+index);
+	
+	/* Uncount the removed instance: */
+	if(--cs.numInstances==0)
+		{
+		/* Remove the child's contribution to the pass counters and forget it: */
+		countPassMask(cs.passMask,-1);
+		childStates.removeEntry(csIt);
+		}
+	else
+		{
+		/* Record the position of the child's new first instance, which follows the removed one: */
+		while(c[index]!=&child)
+			++index;
+		cs.index=index;
+		}
+	
+	/* Update the processing pass mask: */
+	return setPassMask(calcCountedPassMask());
 	}
 
 unsigned int GroupNode::removeAllChildren(void)
 	{
-	/* Clear the children field: */
+	/* Clear the children field and the child bookkeeping: */
 	children.clearValues();
+	recountChildren();
 	
 	/* Reset the processing pass mask: */
 	if(passMask!=0x0U)
@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <vector>
 #include <Misc/Autopointer.h>
+#include <Misc/HashTable.h>
 #include <Geometry/ComponentArray.h>
 #include <Geometry/Point.h>
 #include <SceneGraph/FieldTypes.h>
@@ -38,6 +39,21 @@ class GroupNode:public GraphNode
 	typedef MF<GraphNodePointer> MFGraphNode;
 	typedef MFGraphNode::ValueList ChildList;
 	
+	private:
+	struct ChildState // Structure to keep track of a child's contribution to the group's pass mask
+		{
+		/* Elements: */
+		public:
+		unsigned int numInstances; // Number of times the child appears in the children list
+		size_t index; // Index of the child's first instance in the children list when it was last recorded; removing earlier children can only move it towards the front
+		PassMask passMask; // Child's pass mask as last counted into the pass counters
+		};
+	
+	typedef Misc::HashTable<GraphNode*,ChildState> ChildStateMap; // Hash table mapping children to their states
+	
+	static const int numPassBits=32; // Number of bits in a pass mask
+	
+	public:
 	/* Elements: */
 	static const char* className; // The class's name
 	
@@ -47,7 +63,11 @@ class GroupNode:public GraphNode
 	To add or remove children from a group, append pointers to the
 	children to the addChildren or removeChildren fields, respectively,
 	and then call the update() method. Or call the addChild / removeChild
-	methods, respectively, which will update more efficiently.
+	methods, respectively, which will update more efficiently. The group
+	keeps per-pass counts of its children's pass masks and the position of
+	each child in the children list, so adding or removing a child does not
+	need to query all other children. Derived classes that change the
+	children field directly must call invalidateChildren() afterwards.
 	*********************************************************************/
 	
 	MFGraphNode addChildren; // List of children to add on the next update
@@ -61,6 +81,24 @@ class GroupNode:public GraphNode
 	/* Derived state: */
 	protected:
 	Box* explicitBoundingBox; // Pointer to the explicit bounding box; null if there is no explicit bounding box
+	private:
+	ChildStateMap childStates; // Map from children to their contributions to the group's pass mask and their positions in the children list
+	bool childrenChanged; // Flag whether the children field was changed directly since the child state map was last rebuilt
+	bool haveChildrenEventIn; // Flag whether an event sink for the children field was created, which can change the field at any time; makes update() rebuild the child state map
+	unsigned int passCounts[numPassBits]; // Number of distinct children participating in each processing pass
+	
+	/* Private methods: */
+	void countPassMask(PassMask childPassMask,int increment); // Adds the given child pass mask to or subtracts it from the pass counters
+	PassMask calcCountedPassMask(void) const; // Returns the union of all children's pass masks from the pass counters
+	void countChild(GraphNode* child,size_t index); // Records an added instance of the given child at the given index in the children list
+	void recountChildren(void); // Rebuilds the child state map and pass counters from the current children list
+	
+	/* Protected methods: */
+	protected:
+	void invalidateChildren(void) // Notifies the group that the children field was changed directly
+		{
+		childrenChanged=true;
+		}
 	
 	/* Constructors and destructors: */
 	public:
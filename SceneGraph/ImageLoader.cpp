@@ -0,0 +1,186 @@
+/***********************************************************************
+ImageLoader - Class to read and process texture images on a pool of
+background threads, and to throttle the upload of finished images into
+OpenGL contexts.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/ImageLoader.h>
+
+#include <unistd.h>
+#include <stdexcept>
+#include <GL/GLContextData.h>
+#include <SceneGraph/TextureCache.h>
+
+namespace SceneGraph {
+
+/*********************************
+Methods of class ImageLoader::Job:
+*********************************/
+
+ImageLoader::Job::Job(void)
+	:finished(false),failed(false)
+	{
+	}
+
+ImageLoader::Job::~Job(void)
+	{
+	}
+
+bool ImageLoader::Job::isFinished(void) const
+	{
+	Threads::MutexCond::Lock statusLock(statusCond);
+	return finished;
+	}
+
+void ImageLoader::Job::waitUntilFinished(void) const
+	{
+	Threads::MutexCond::Lock statusLock(statusCond);
+	while(!finished)
+		statusCond.wait(statusLock);
+	}
+
+/****************************
+Methods of class ImageLoader:
+****************************/
+
+void* ImageLoader::workerThreadMethod(void)
+	{
+	while(true)
+		{
+		/* Grab the next job from the queue; a null job is the signal to shut down: */
+		JobPtr job=jobQueue.pop();
+		if(job==0)
+			break;
+		
+		/* Execute the job: */
+		bool failed=false;
+		std::string errorMessage;
+		try
+			{
+			job->process();
+			}
+		catch(const std::exception& err)
+			{
+			failed=true;
+			errorMessage=err.what();
+			}
+		catch(...)
+			{
+			failed=true;
+			errorMessage="spurious exception";
+			}
+		
+		/* Mark the job as finished and wake up anybody waiting on it: */
+		{
+		Threads::MutexCond::Lock statusLock(job->statusCond);
+		job->failed=failed;
+		job->errorMessage=errorMessage;
+		job->finished=true;
+		job->statusCond.broadcast();
+		}
+		}
+	
+	return 0;
+	}
+
+ImageLoader::ImageLoader(int sNumWorkerThreads)
+	:numWorkerThreads(sNumWorkerThreads),workerThreads(0),
+	 uploadTimeBudget(0.002),budgetPeriod(1.0/90.0)
+	{
+	/* Determine the number of worker threads: */
+	if(numWorkerThreads<=0)
+		{
+		numWorkerThreads=int(sysconf(_SC_NPROCESSORS_ONLN))-1;
+		if(numWorkerThreads<1)
+			numWorkerThreads=1;
+		}
+	
+	/* Start the worker threads: */
+	workerThreads=new Threads::Thread[numWorkerThreads];
+	for(int i=0;i<numWorkerThreads;++i)
+		workerThreads[i].start(this,&ImageLoader::workerThreadMethod);
+	}
+
+ImageLoader::~ImageLoader(void)
+	{
+	/* Send a shutdown signal to each worker thread after all pending jobs: */
+	for(int i=0;i<numWorkerThreads;++i)
+		jobQueue.push(JobPtr());
+	
+	/* Wait for all worker threads to terminate: */
+	for(int i=0;i<numWorkerThreads;++i)
+		workerThreads[i].join();
+	delete[] workerThreads;
+	}
+
+void ImageLoader::initContext(GLContextData& contextData) const
+	{
+	/* Start a fresh upload budget for the new context: */
+	DataItem* dataItem=new DataItem;
+	contextData.addDataItem(this,dataItem);
+	}
+
+ImageLoader& ImageLoader::getLoader(void)
+	{
+	/* The shared image loader lives and dies with the shared texture cache, which must outlive all jobs reporting back to it: */
+	return TextureCache::getCache().getLoader();
+	}
+
+void ImageLoader::submit(ImageLoader::JobPtr job)
+	{
+	jobQueue.push(job);
+	}
+
+void ImageLoader::setUploadBudget(double newUploadTimeBudget,double newBudgetPeriod)
+	{
+	Threads::Mutex::Lock uploadBudgetLock(uploadBudgetMutex);
+	uploadTimeBudget=newUploadTimeBudget;
+	budgetPeriod=newBudgetPeriod;
+	}
+
+bool ImageLoader::canUpload(GLContextData& contextData)
+	{
+	/* Allow uploads into contexts that have not yet been initialized for the image loader: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	if(dataItem==0)
+		return true;
+	
+	Threads::Mutex::Lock uploadBudgetLock(uploadBudgetMutex);
+	
+	/* Start a new budget period if the current one has expired: */
+	double now=clock.peekTime();
+	if(now-dataItem->periodStart>=budgetPeriod)
+		{
+		dataItem->periodStart=now;
+		dataItem->usedTime=0.0;
+		}
+	
+	return dataItem->usedTime<uploadTimeBudget;
+	}
+
+void ImageLoader::chargeUpload(GLContextData& contextData,double uploadTime)
+	{
+	/* Charge the context's current budget period: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	if(dataItem!=0)
+		dataItem->usedTime+=uploadTime;
+	}
+
+}
@@ -0,0 +1,134 @@
+/***********************************************************************
+ImageLoader - Class to read and process texture images on a pool of
+background threads, and to throttle the upload of finished images into
+OpenGL contexts.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_IMAGELOADER_INCLUDED
+#define SCENEGRAPH_IMAGELOADER_INCLUDED
+
+#include <string>
+#include <Misc/Autopointer.h>
+#include <Misc/Timer.h>
+#include <Threads/Mutex.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+#include <Threads/Queue.h>
+#include <Threads/RefCounted.h>
+#include <GL/GLObject.h>
+
+/* Forward declarations: */
+class GLContextData;
+
+namespace SceneGraph {
+
+class ImageLoader:public GLObject
+	{
+	/* Embedded classes: */
+	public:
+	class Job:public Threads::RefCounted // Base class for units of work executed by the image loader's worker threads
+		{
+		friend class ImageLoader;
+		
+		/* Elements: */
+		private:
+		mutable Threads::MutexCond statusCond; // Condition variable signaling completion of the job
+		bool finished; // Flag whether the job has been executed
+		bool failed; // Flag whether the job's process method threw an exception
+		std::string errorMessage; // Message of the exception thrown by the job's process method
+		
+		/* Protected methods: */
+		protected:
+		virtual void process(void) =0; // Executes the job in a worker thread; can throw exceptions
+		
+		/* Constructors and destructors: */
+		public:
+		Job(void);
+		virtual ~Job(void);
+		
+		/* Methods: */
+		bool isFinished(void) const; // Returns true if the job has been executed
+		void waitUntilFinished(void) const; // Blocks the calling thread until the job has been executed
+		bool hasFailed(void) const // Returns true if the job threw an exception; only valid after the job has finished
+			{
+			return failed;
+			}
+		const std::string& getErrorMessage(void) const // Returns the message of the exception thrown by the job; only valid after the job has finished
+			{
+			return errorMessage;
+			}
+		};
+	
+	typedef Misc::Autopointer<Job> JobPtr; // Type for pointers to jobs
+	
+	private:
+	struct DataItem:public GLObject::DataItem // Structure tracking texture upload time in an OpenGL context during the current budget period; destroyed with its context
+		{
+		/* Elements: */
+		public:
+		double periodStart; // Time at which the current budget period started
+		double usedTime; // Upload time used during the current budget period
+		
+		/* Constructors and destructors: */
+		DataItem(void)
+			:periodStart(0.0),usedTime(0.0)
+			{
+			}
+		};
+	
+	/* Elements: */
+	int numWorkerThreads; // Number of worker threads
+	Threads::Thread* workerThreads; // Array of worker threads
+	Threads::Queue<JobPtr> jobQueue; // Queue of jobs waiting to be executed, in order of submission
+	Misc::Timer clock; // Free-running timer to measure budget periods
+	double uploadTimeBudget; // Maximum amount of time to spend on texture uploads per budget period in seconds
+	double budgetPeriod; // Length of a budget period in seconds, typically one frame
+	Threads::Mutex uploadBudgetMutex; // Mutex protecting the upload budget settings
+	
+	/* Private methods: */
+	void* workerThreadMethod(void); // Method executing jobs from the job queue
+	
+	/* Constructors and destructors: */
+	public:
+	ImageLoader(int sNumWorkerThreads); // Creates an image loader with the given number of worker threads; uses number of CPUs minus one if <=0
+	private:
+	ImageLoader(const ImageLoader& source); // Prohibit copy constructor
+	ImageLoader& operator=(const ImageLoader& source); // Prohibit assignment operator
+	public:
+	virtual ~ImageLoader(void); // Executes all pending jobs and shuts down the worker threads
+	
+	/* Methods from class GLObject: */
+	virtual void initContext(GLContextData& contextData) const;
+	
+	/* New methods: */
+	static ImageLoader& getLoader(void); // Returns the image loader shared by all scene graph nodes, which is owned by the shared texture cache; creates both on the first call
+	int getNumWorkerThreads(void) const // Returns the number of worker threads
+		{
+		return numWorkerThreads;
+		}
+	void submit(JobPtr job); // Queues the given job for execution; jobs are started in order of submission
+	void setUploadBudget(double newUploadTimeBudget,double newBudgetPeriod); // Sets the maximum amount of upload time per budget period
+	bool canUpload(GLContextData& contextData); // Returns true if a texture may be uploaded into the given OpenGL context during the current budget period
+	void chargeUpload(GLContextData& contextData,double uploadTime); // Charges the given amount of upload time against the given OpenGL context's current budget
+	};
+
+}
+
+#endif
@@ -23,31 +23,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <string.h>
 #include <GL/gl.h>
-#include <GL/GLContextData.h>
-#include <GL/Extensions/GLEXTFramebufferObject.h>
-#include <Images/BaseImage.h>
-#include <Images/ReadImageFile.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
 
 namespace SceneGraph {
 
-/*******************************************
-Methods of class ImageTextureNode::DataItem:
-*******************************************/
-
-ImageTextureNode::DataItem::DataItem(void)
-	:textureObjectId(0),
-	 version(0)
-	{
-	glGenTextures(1,&textureObjectId);
-	}
-
-ImageTextureNode::DataItem::~DataItem(void)
-	{
-	glDeleteTextures(1,&textureObjectId);
-	}
-
 /*****************************************
 Static elements of class ImageTextureNode:
 *****************************************/
@@ -58,10 +38,37 @@ const char* ImageTextureNode::className="ImageTexture";
 Methods of class ImageTextureNode:
 *********************************/
 
+void ImageTextureNode::acquireTexture(void)
+	{
+	/* Acquire the texture cache entry for the current texture image and parameters: */
+	TextureCache::Entry* newTextureEntry=0;
+	if(url.getNumValues()>0&&baseDirectory!=0)
+		{
+		TextureCache::TextureParameters parameters;
+		parameters.repeatS=repeatS.getValue();
+		parameters.repeatT=repeatT.getValue();
+		parameters.filter=filter.getValue();
+		parameters.mipmapLevel=mipmapLevel.getValue();
+		newTextureEntry=TextureCache::getCache().acquire(*baseDirectory,url.getValue(0),parameters);
+		}
+	
+	/* Release the previous entry after acquiring the new one, in case they are the same: */
+	if(textureEntry!=0)
+		TextureCache::getCache().release(textureEntry);
+	textureEntry=newTextureEntry;
+	}
+
 ImageTextureNode::ImageTextureNode(void)
 	:repeatS(true),repeatT(true),filter(true),mipmapLevel(0),
-	 version(0)
+	 textureEntry(0)
+	{
+	}
+
+ImageTextureNode::~ImageTextureNode(void)
 	{
+	/* Release the texture cache entry: */
+	if(textureEntry!=0)
+		TextureCache::getCache().release(textureEntry);
 	}
 
 const char* ImageTextureNode::getClassName(void) const
@@ -104,54 +111,24 @@ unsigned int ImageTextureNode::update(void)
 	if(mipmapLevel.getValue()<0)
 		mipmapLevel.setValue(0);
 	
-	/* Bump up the texture's version number: */
-	++version;
+	/* Acquire the shared texture for the current image and parameters: */
+	acquireTexture();
 	
 	return NoCascade;
 	}
 
 void ImageTextureNode::setGLState(GLRenderState& renderState) const
 	{
-	if(url.getNumValues()>0)
+	if(textureEntry!=0)
 		{
 		/* Enable 2D textures: */
 		renderState.enableTexture2D();
 		
-		/* Get the data item: */
-		DataItem* dataItem=renderState.contextData.retrieveDataItem<DataItem>(this);
-		
-		/* Bind the texture object: */
-		renderState.bindTexture2D(dataItem->textureObjectId);
+		/* Bind the shared texture object: */
+		renderState.bindTexture2D(textureEntry->getTextureObjectId(renderState.contextData));
 		
-		/* Check if the texture object needs to be updated: */
-		if(dataItem->version!=version)
-			{
-			/* Load the texture image: */
-			Images::BaseImage texture=Images::readGenericImageFile(*baseDirectory,url.getValue(0).c_str());
-			
-			/* Upload the texture image: */
-			int mml=mipmapLevel.getValue();
-			texture.glTexImage2D(GL_TEXTURE_2D,0,false);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_BASE_LEVEL,0);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAX_LEVEL,mml);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,filter.getValue()?(mml>0?GL_LINEAR_MIPMAP_LINEAR:GL_LINEAR):GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,filter.getValue()?GL_LINEAR:GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,repeatS.getValue()?GL_REPEAT:GL_CLAMP);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,repeatT.getValue()?GL_REPEAT:GL_CLAMP);
-			
-			/* Check if mipmapping was requested and mipmap generation is supported: */
-			if(mml>0&&GLEXTFramebufferObject::isSupported())
-				{
-				/* Initialize the framebuffer extension: */
-				GLEXTFramebufferObject::initExtension();
-				
-				/* Auto-generate all requested mipmap levels: */
-				glGenerateMipmapEXT(GL_TEXTURE_2D);
-				}
-			
-			/* Mark the texture object as up-to-date: */
-			dataItem->version=version;
-			}
+		/* Upload the texture image if it is ready, or a placeholder until it is: */
+		textureEntry->updateTexture(renderState.contextData);
 		
 		#if 0
 		
@@ -180,21 +157,11 @@ void ImageTextureNode::resetGLState(GLRenderState& renderState) const
 	/* Don't do anything; next guy cleans up */
 	}
 
-void ImageTextureNode::initContext(GLContextData& contextData) const
-	{
-	/* Create a data item and store it in the GL context: */
-	DataItem* dataItem=new DataItem;
-	contextData.addDataItem(this,dataItem);
-	}
-
 void ImageTextureNode::setUrl(const std::string& newUrl,IO::Directory& newBaseDirectory)
 	{
 	/* Store the URL and its base directory: */
 	url.setValue(newUrl);
 	baseDirectory=&newBaseDirectory;
-	
-	/* Bump up the texture's version number: */
-	++version;
 	}
 
 void ImageTextureNode::setUrl(const std::string& newUrl)
@@ -202,9 +169,6 @@ void ImageTextureNode::setUrl(const std::string& newUrl)
 	/* Store the URL and the current directory: */
 	url.setValue(newUrl);
 	baseDirectory=IO::Directory::getCurrent();
-	
-	/* Bump up the texture's version number: */
-	++version;
 	}
 
 }
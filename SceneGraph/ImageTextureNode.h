@@ -24,28 +24,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <Misc/Autopointer.h>
 #include <IO/Directory.h>
-#include <GL/gl.h>
-#include <GL/GLObject.h>
 #include <SceneGraph/FieldTypes.h>
 #include <SceneGraph/TextureNode.h>
+#include <SceneGraph/TextureCache.h>
 
 namespace SceneGraph {
 
-class ImageTextureNode:public TextureNode,public GLObject
+class ImageTextureNode:public TextureNode
 	{
-	/* Embedded classes: */
-	protected:
-	struct DataItem:public GLObject::DataItem
-		{
-		/* Elements: */
-		GLuint textureObjectId; // ID of texture object
-		unsigned int version; // Version of texture in texture object
-		
-		/* Constructors and destructors: */
-		DataItem(void);
-		virtual ~DataItem(void);
-		};
-	
 	/* Elements: */
 	public:
 	static const char* className; // The class's name
@@ -60,11 +46,15 @@ class ImageTextureNode:public TextureNode,public GLObject
 	/* Derived state: */
 	protected:
 	IO::DirectoryPtr baseDirectory; // Base directory for image URLs
-	unsigned int version; // Version number of texture
+	TextureCache::Entry* textureEntry; // Shared texture cache entry for the current texture image and parameters, or null if there is no texture image
+	
+	/* Protected methods: */
+	void acquireTexture(void); // Acquires the texture cache entry for the current texture image and parameters, and releases the previous entry
 	
 	/* Constructors and destructors: */
 	public:
 	ImageTextureNode(void); // Creates a default image texture node with no texture image
+	virtual ~ImageTextureNode(void);
 	
 	/* Methods from class Node: */
 	virtual const char* getClassName(void) const;
@@ -75,11 +65,8 @@ class ImageTextureNode:public TextureNode,public GLObject
 	virtual void setGLState(GLRenderState& renderState) const;
 	virtual void resetGLState(GLRenderState& renderState) const;
 	
-	/* Methods from class GLObject: */
-	virtual void initContext(GLContextData& contextData) const;
-	
 	/* New methods: */
-	void setUrl(const std::string& newUrl,IO::Directory& newBaseDirectory); // Sets an image URL and its base directory
+	void setUrl(const std::string& newUrl,IO::Directory& newBaseDirectory); // Sets an image URL and its base directory; texture image is read on the next call to update()
 	void setUrl(const std::string& newUrl); // Ditto, with URL relative to the current directory
 	};
 
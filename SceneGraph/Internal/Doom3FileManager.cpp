@@ -301,8 +301,9 @@ IO::FilePtr Doom3FileManager::getFile(const char* fileName)
 	/* Get the file's pak file handle: */
 	const PakFileHandle& pfh=pakFileTree.getLeafValue(leafId);
 	
-	/* Read and return the file: */
-	return pfh.pakFile->openFile(pfh.fileID);
+	/* Read the entire file while holding the lock, as streaming readers would share the pak archive's read position with other threads: */
+	Threads::Mutex::Lock pakFileLock(pakFileMutex);
+	return pfh.pakFile->openSeekableFile(pfh.fileID);
 	}
 
 IO::SeekableFilePtr Doom3FileManager::getSeekableFile(const char* fileName)
@@ -316,6 +317,7 @@ IO::SeekableFilePtr Doom3FileManager::getSeekableFile(const char* fileName)
 	const PakFileHandle& pfh=pakFileTree.getLeafValue(leafId);
 	
 	/* Read and return the file: */
+	Threads::Mutex::Lock pakFileLock(pakFileMutex);
 	return pfh.pakFile->openSeekableFile(pfh.fileID);
 	}
 
@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <vector>
 #include <stdexcept>
 #include <Misc/ThrowStdErr.h>
+#include <Threads/Mutex.h>
 #include <IO/File.h>
 #include <IO/SeekableFile.h>
 #include <IO/Directory.h>
@@ -157,6 +158,7 @@ class Doom3FileManager
 	private:
 	std::vector<PakFile*> pakFiles; // The list of pk3/pk4 files
 	PakFileTree pakFileTree; // The tree containing the pak archive's files
+	Threads::Mutex pakFileMutex; // Mutex serializing access to the pak archives, which are shared between the main thread and background image loaders
 	
 	/* Constructors and destructors: */
 	public:
@@ -187,7 +189,7 @@ class Doom3FileManager
 		DirectorySearcher<ClientFunctorParam,NameFilterParam> ds(cf,nf);
 		pakFileTree.traverseTree(ds);
 		}
-	IO::FilePtr getFile(const char* fileName); // Returns a file as a streaming reader; throws ReadError if file not found
+	IO::FilePtr getFile(const char* fileName); // Returns a file as a reader, fully read into memory so it can be used from any thread; throws ReadError if file not found
 	IO::SeekableFilePtr getSeekableFile(const char* fileName); // Returns a file as a seekable reader; throws ReadError if file not found
 	IO::DirectoryPtr getDirectory(const char* directoryName); // Returns a directory object to traverse the file manager's directory tree
 	};
@@ -24,6 +24,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <Misc/StringPrintf.h>
 #include <Misc/ThrowStdErr.h>
+#include <Misc/Timer.h>
+#include <Misc/MessageLogger.h>
 #include <IO/File.h>
 #include <Math/Math.h>
 #include <Geometry/Vector.h>
@@ -58,18 +60,252 @@ inline Images::RGBAImage::Color encodeNormal(const Geometry::Vector<float,3>& no
 	return result;
 	}
 
+void computeHeightmapImage(const Images::RGBAImage& sourceImage,float bumpiness,Images::RGBAImage& resultImage)
+	{
+	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
+	for(unsigned int y=0;y<resultImage.getHeight();++y)
+		{
+		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
+		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
+		for(unsigned int x=0;x<resultImage.getWidth();++x)
+			{
+			Geometry::Vector<float,3> g;
+			if(x==0)
+				g[0]=float(sourceRow[x][0])-float(sourceRow[x+1][0]);
+			else if(x==resultImage.getWidth()-1)
+				g[0]=float(sourceRow[x-1][0])-float(sourceRow[x][0]);
+			else
+				g[0]=(float(sourceRow[x-1][0])-float(sourceRow[x+1][0]))*0.5f;
+			if(y==0)
+				g[1]=float(sourceRow[x][0])-float((sourceRow+resultImage.getWidth())[x][0]);
+			else if(y==resultImage.getHeight()-1)
+				g[1]=float((sourceRow-resultImage.getWidth())[x][0])-float(sourceRow[x][0]);
+			else
+				g[1]=(float((sourceRow-resultImage.getWidth())[x][0])-float((sourceRow+resultImage.getWidth())[x][0]))*0.5f;
+			g[2]=128.0f/bumpiness;
+			destRow[x]=encodeNormal(g);
+			}
+		}
+	}
+
+void computeAddNormalsImage(const Images::RGBAImage& source1Image,const Images::RGBAImage& source2Image,Images::RGBAImage& resultImage)
+	{
+	resultImage=Images::RGBAImage(source1Image.getWidth(),source1Image.getHeight());
+	for(unsigned int y=0;y<resultImage.getHeight();++y)
+		{
+		const Images::RGBAImage::Color* source1Row=source1Image.getPixelRow(y);
+		const Images::RGBAImage::Color* source2Row=source2Image.getPixelRow(y);
+		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
+		for(unsigned int x=0;x<resultImage.getWidth();++x)
+			{
+			Geometry::Vector<float,3> g;
+			for(int i=0;i<3;++i)
+				g[i]=float(source1Row[x][i])+float(source2Row[x][i])-256.0f;
+			destRow[x]=encodeNormal(g);
+			}
+		}
+	}
+
+void computeSmoothNormalsImage(const Images::RGBAImage& sourceImage,Images::RGBAImage& resultImage)
+	{
+	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
+	for(unsigned int y=0;y<resultImage.getHeight();++y)
+		{
+		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
+		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
+		for(unsigned int x=0;x<resultImage.getWidth();++x)
+			{
+			destRow[x]=sourceRow[x];
+			}
+		}
+	}
+
+void computeAddImage(const Images::RGBAImage& source1Image,const Images::RGBAImage& source2Image,Images::RGBAImage& resultImage)
+	{
+	resultImage=Images::RGBAImage(source1Image.getWidth(),source1Image.getHeight());
+	for(unsigned int y=0;y<resultImage.getHeight();++y)
+		{
+		const Images::RGBAImage::Color* source1Row=source1Image.getPixelRow(y);
+		const Images::RGBAImage::Color* source2Row=source2Image.getPixelRow(y);
+		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
+		for(unsigned int x=0;x<resultImage.getWidth();++x)
+			{
+			for(int i=0;i<3;++i)
+				{
+				unsigned int sum=(unsigned int)(source1Row[x][i])+(unsigned int)(source2Row[x][i]);
+				if(sum>=255)
+					destRow[x][i]=GLubyte(255);
+				else
+					destRow[x][i]=GLubyte(sum);
+				}
+			}
+		}
+	}
+
+void computeScaleImage(const Images::RGBAImage& sourceImage,const float factors[4],Images::RGBAImage& resultImage)
+	{
+	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
+	for(unsigned int y=0;y<resultImage.getHeight();++y)
+		{
+		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
+		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
+		for(unsigned int x=0;x<resultImage.getWidth();++x)
+			{
+			for(int i=0;i<4;++i)
+				{
+				float val=float(sourceRow[x][i])*factors[i];
+				if(val<0.5f)
+					destRow[x][i]=GLubyte(0);
+				else if(val>=254.5f)
+					destRow[x][i]=GLubyte(255);
+				else
+					destRow[x][i]=GLubyte(Math::floor(val+0.5f));
+				}
+			}
+		}
+	}
+
+void computeInvertAlphaImage(const Images::RGBAImage& sourceImage,Images::RGBAImage& resultImage)
+	{
+	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
+	for(unsigned int y=0;y<resultImage.getHeight();++y)
+		{
+		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
+		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
+		for(unsigned int x=0;x<resultImage.getWidth();++x)
+			{
+			for(int i=0;i<3;++i)
+				destRow[x][i]=sourceRow[x][i];
+			destRow[x][3]=GLubyte(255)-destRow[x][3];
+			}
+		}
+	}
+
+void computeInvertColorImage(const Images::RGBAImage& sourceImage,Images::RGBAImage& resultImage)
+	{
+	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
+	for(unsigned int y=0;y<resultImage.getHeight();++y)
+		{
+		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
+		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
+		for(unsigned int x=0;x<resultImage.getWidth();++x)
+			{
+			for(int i=0;i<3;++i)
+				destRow[x][i]=GLubyte(255)-sourceRow[x][i];
+			destRow[x][3]=destRow[x][3];
+			}
+		}
+	}
+
+void computeMakeIntensityImage(const Images::RGBAImage& sourceImage,Images::RGBAImage& resultImage)
+	{
+	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
+	for(unsigned int y=0;y<resultImage.getHeight();++y)
+		{
+		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
+		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
+		for(unsigned int x=0;x<resultImage.getWidth();++x)
+			{
+			for(int i=0;i<4;++i)
+				destRow[x][i]=sourceRow[x][0];
+			}
+		}
+	}
+
+void computeMakeAlphaImage(const Images::RGBAImage& sourceImage,Images::RGBAImage& resultImage)
+	{
+	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
+	for(unsigned int y=0;y<resultImage.getHeight();++y)
+		{
+		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
+		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
+		for(unsigned int x=0;x<resultImage.getWidth();++x)
+			{
+			unsigned int sum=0U;
+			for(int i=0;i<3;++i)
+				{
+				sum+=sourceRow[x][i];
+				destRow[x][i]=GLubyte(255);
+				}
+			destRow[x][3]=GLubyte((sum+2U)/3U);
+			}
+		}
+	}
+
 }
 
+/*************************************************
+Declaration of class Doom3TextureManager::LoadJob:
+*************************************************/
+
+class Doom3TextureManager::LoadJob:public ImageLoader::Job
+	{
+	/* Elements: */
+	private:
+	Doom3FileManager& fileManager; // File manager from which to read the texture image
+	std::string textureName; // Name of the texture image file
+	Image& image; // Image structure receiving the texture image
+	
+	/* Protected methods from ImageLoader::Job: */
+	protected:
+	virtual void process(void);
+	
+	/* Constructors and destructors: */
+	public:
+	LoadJob(Doom3FileManager& sFileManager,const char* sTextureName,Image& sImage)
+		:fileManager(sFileManager),textureName(sTextureName),image(sImage)
+		{
+		}
+	};
+
+/****************************************************
+Declaration of class Doom3TextureManager::ComputeJob:
+****************************************************/
+
+class Doom3TextureManager::ComputeJob:public ImageLoader::Job
+	{
+	/* Embedded classes: */
+	public:
+	enum Operation // Enumerated type for image compute operations
+		{
+		Heightmap,AddNormals,SmoothNormals,Add,Scale,InvertAlpha,InvertColor,MakeIntensity,MakeAlpha
+		};
+	
+	/* Elements: */
+	private:
+	Operation operation; // The compute operation
+	const Image& source1; // The first source image
+	const Image* source2; // The second source image for binary operations
+	float parameters[4]; // Additional parameters for the compute operation
+	Image& result; // Image structure receiving the result image
+	
+	/* Protected methods from ImageLoader::Job: */
+	protected:
+	virtual void process(void);
+	
+	/* Constructors and destructors: */
+	public:
+	ComputeJob(Operation sOperation,const Image& sSource1,const Image* sSource2,const float sParameters[4],Image& sResult)
+		:operation(sOperation),source1(sSource1),source2(sSource2),result(sResult)
+		{
+		for(int i=0;i<4;++i)
+			parameters[i]=sParameters!=0?sParameters[i]:0.0f;
+		}
+	};
+
 /**********************************************
 Methods of class Doom3TextureManager::DataItem:
 **********************************************/
 
 Doom3TextureManager::DataItem::DataItem(int sNumTextures)
 	:numTextures(sNumTextures),
-	 textureObjectIds(new GLuint[numTextures])
+	 textureObjectIds(new GLuint[numTextures]),
+	 uploaded(new bool[numTextures])
 	{
 	/* Allocate the texture objects: */
 	glGenTextures(numTextures,textureObjectIds);
+	for(int i=0;i<numTextures;++i)
+		uploaded[i]=false;
 	}
 
 Doom3TextureManager::DataItem::~DataItem(void)
@@ -77,6 +313,7 @@ Doom3TextureManager::DataItem::~DataItem(void)
 	/* Destroy the texture objects: */
 	glDeleteTextures(numTextures,textureObjectIds);
 	delete[] textureObjectIds;
+	delete[] uploaded;
 	}
 
 /*****************************************************
@@ -88,18 +325,141 @@ void Doom3TextureManager::TextureUploader::operator()(std::string name,const Doo
 	/* Bind the texture object: */
 	glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectIds[image.textureIndex]);
 	
-	/* Upload the texture image: */
-	image.image.glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8);
+	/* Upload a small placeholder image; the final image will be uploaded once it is ready: */
+	Images::RGBAImage placeholder(2,2);
+	placeholder.clear(image.placeholderColor);
+	placeholder.glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8);
 	
-	/* Keep track of the number of textures and pixels: */
+	/* Keep track of the number of textures: */
 	++numTextures;
-	totalTextureSize+=size_t(image.image.getWidth())*size_t(image.image.getHeight())*sizeof(Images::RGBAImage::Color);
+	}
+
+/*********************************************
+Methods of class Doom3TextureManager::LoadJob:
+*********************************************/
+
+void Doom3TextureManager::LoadJob::process(void)
+	{
+	try
+		{
+		/* Read the texture image file: */
+		IO::FilePtr imageFile=fileManager.getFile(textureName.c_str());
+		Images::TargaImageFileReader<IO::File> targaReader(*imageFile);
+		
+		/* Initialize the texture image: */
+		image.image=targaReader.readImage<Images::RGBAImage>();
+		}
+	catch(const Doom3FileManager::ReadError& err)
+		{
+		/* Initialize the texture image: */
+		image.image=Images::RGBAImage(2,2);
+		image.image.clear(Images::RGBAImage::Color(255,0,255,255));
+		}
+	}
+
+/************************************************
+Methods of class Doom3TextureManager::ComputeJob:
+************************************************/
+
+void Doom3TextureManager::ComputeJob::process(void)
+	{
+	/* Wait until the source images are ready; they were submitted before this job, so this cannot deadlock: */
+	if(source1.job!=0)
+		source1.job->waitUntilFinished();
+	if(source2!=0&&source2->job!=0)
+		source2->job->waitUntilFinished();
+	
+	/* Create an invalid texture placeholder if any source image could not be created: */
+	if(source1.hasFailed()||(source2!=0&&source2->hasFailed()))
+		{
+		result.image=Images::RGBAImage(2,2);
+		result.image.clear(Images::RGBAImage::Color(255,0,255,255));
+		return;
+		}
+	
+	/* Resample the second image to match the first image's size for binary operations: */
+	Images::RGBAImage source2Image;
+	if(source2!=0)
+		{
+		source2Image=source2->image;
+		if(source1.image.getWidth()!=source2Image.getWidth()||source1.image.getHeight()!=source2Image.getHeight())
+			source2Image.resize(source1.image.getWidth(),source1.image.getHeight());
+		}
+	
+	/* Compute the result image's pixels: */
+	switch(operation)
+		{
+		case Heightmap:
+			computeHeightmapImage(source1.image,parameters[0],result.image);
+			break;
+		
+		case AddNormals:
+			computeAddNormalsImage(source1.image,source2Image,result.image);
+			break;
+		
+		case SmoothNormals:
+			computeSmoothNormalsImage(source1.image,result.image);
+			break;
+		
+		case Add:
+			computeAddImage(source1.image,source2Image,result.image);
+			break;
+		
+		case Scale:
+			computeScaleImage(source1.image,parameters,result.image);
+			break;
+		
+		case InvertAlpha:
+			computeInvertAlphaImage(source1.image,result.image);
+			break;
+		
+		case InvertColor:
+			computeInvertColorImage(source1.image,result.image);
+			break;
+		
+		case MakeIntensity:
+			computeMakeIntensityImage(source1.image,result.image);
+			break;
+		
+		case MakeAlpha:
+			computeMakeAlphaImage(source1.image,result.image);
+			break;
+		}
 	}
 
 /************************************
 Methods of class Doom3TextureManager:
 ************************************/
 
+Doom3TextureManager::Image& Doom3TextureManager::createComputedImage(Doom3TextureManager::ImageID& resultId)
+	{
+	/* Store a new image structure in the image tree: */
+	resultId=imageTree.insertLeaf(Misc::stringPrintf("/_computedTextures/tex%06d",numTextures).c_str(),Image());
+	Image& result=imageTree.getLeafValue(resultId);
+	result.textureIndex=numTextures;
+	result.placeholderColor=Images::RGBAImage::Color(128,128,128,255);
+	++numTextures;
+	
+	return result;
+	}
+
+void Doom3TextureManager::uploadImage(const Doom3TextureManager::Image& image) const
+	{
+	if(!image.hasFailed())
+		{
+		/* Upload the texture image: */
+		image.image.glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8);
+		}
+	else
+		{
+		/* Upload an invalid texture placeholder: */
+		Misc::formattedUserError("SceneGraph::Doom3TextureManager: Unable to create texture image due to exception %s",image.job->getErrorMessage().c_str());
+		Images::RGBAImage placeholder(2,2);
+		placeholder.clear(Images::RGBAImage::Color(255,0,255,255));
+		placeholder.glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8);
+		}
+	}
+
 Doom3TextureManager::Doom3TextureManager(Doom3FileManager& sFileManager)
 	:fileManager(sFileManager),
 	 numTextures(0)
@@ -108,7 +468,9 @@ Doom3TextureManager::Doom3TextureManager(Doom3FileManager& sFileManager)
 
 Doom3TextureManager::~Doom3TextureManager(void)
 	{
-	/* Nothing to do, since RGBAImages take care of themselves... */
+	/* Wait for all background jobs still referencing the image tree: */
+	JobWaiter jw;
+	imageTree.forEachLeaf(jw);
 	}
 
 void Doom3TextureManager::initContext(GLContextData& contextData) const
@@ -117,7 +479,7 @@ void Doom3TextureManager::initContext(GLContextData& contextData) const
 	DataItem* dataItem=new DataItem(numTextures);
 	contextData.addDataItem(this,dataItem);
 	
-	/* Upload all textures: */
+	/* Upload placeholders for all textures: */
 	TextureUploader tu(*this,dataItem);
 	imageTree.forEachLeaf(tu);
 	
@@ -150,6 +512,7 @@ Doom3TextureManager::ImageID Doom3TextureManager::loadTexture(const char* textur
 	/* Create a texture image: */
 	Image& image=imageTree.getLeafValue(imageID);
 	image.textureIndex=numTextures;
+	image.placeholderColor=Images::RGBAImage::Color(128,128,128,255);
 	++numTextures;
 	
 	/* Check for built-in texture names: */
@@ -169,24 +532,13 @@ Doom3TextureManager::ImageID Doom3TextureManager::loadTexture(const char* textur
 		/* Initialize the texture image: */
 		image.image=Images::RGBAImage(2,2);
 		image.image.clear(imageColor);
+		image.placeholderColor=imageColor;
 		}
 	else
 		{
-		try
-			{
-			/* Read the texture image file: */
-			IO::FilePtr imageFile=fileManager.getFile(textureName);
-			Images::TargaImageFileReader<IO::File> targaReader(*imageFile);
-			
-			/* Initialize the texture image: */
-			image.image=targaReader.readImage<Images::RGBAImage>();
-			}
-		catch(const Doom3FileManager::ReadError& err)
-			{
-			/* Initialize the texture image: */
-			image.image=Images::RGBAImage(2,2);
-			image.image.clear(Images::RGBAImage::Color(255,0,255,255));
-			}
+		/* Read the texture image file in the background: */
+		image.job=new LoadJob(fileManager,textureName,image);
+		ImageLoader::getLoader().submit(image.job);
 		}
 	
 	/* Return the image ID: */
@@ -195,41 +547,13 @@ Doom3TextureManager::ImageID Doom3TextureManager::loadTexture(const char* textur
 
 Doom3TextureManager::ImageID Doom3TextureManager::computeHeightmap(const Doom3TextureManager::ImageID& source,float bumpiness)
 	{
-	/* Get a reference to the source image: */
-	const Images::RGBAImage& sourceImage=imageTree.getLeafValue(source).image;
-	
-	/* Store a new image structure in the image tree: */
-	ImageID resultId=imageTree.insertLeaf(Misc::stringPrintf("/_computedTextures/tex%06d",numTextures).c_str(),Image());
-	Image& result=imageTree.getLeafValue(resultId);
-	Images::RGBAImage& resultImage=result.image;
-	result.textureIndex=numTextures;
-	++numTextures;
-	
-	/* Compute the result image's pixels: */
-	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
-	for(unsigned int y=0;y<resultImage.getHeight();++y)
-		{
-		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
-		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
-		for(unsigned int x=0;x<resultImage.getWidth();++x)
-			{
-			Geometry::Vector<float,3> g;
-			if(x==0)
-				g[0]=float(sourceRow[x][0])-float(sourceRow[x+1][0]);
-			else if(x==resultImage.getWidth()-1)
-				g[0]=float(sourceRow[x-1][0])-float(sourceRow[x][0]);
-			else
-				g[0]=(float(sourceRow[x-1][0])-float(sourceRow[x+1][0]))*0.5f;
-			if(y==0)
-				g[1]=float(sourceRow[x][0])-float((sourceRow+resultImage.getWidth())[x][0]);
-			else if(y==resultImage.getHeight()-1)
-				g[1]=float((sourceRow-resultImage.getWidth())[x][0])-float(sourceRow[x][0]);
-			else
-				g[1]=(float((sourceRow-resultImage.getWidth())[x][0])-float((sourceRow+resultImage.getWidth())[x][0]))*0.5f;
-			g[2]=128.0f/bumpiness;
-			destRow[x]=encodeNormal(g);
-			}
-		}
+	/* Create the result image and compute it in the background: */
+	ImageID resultId;
+	Image& result=createComputedImage(resultId);
+	result.placeholderColor=Images::RGBAImage::Color(128,128,255,255);
+	float parameters[4]={bumpiness,0.0f,0.0f,0.0f};
+	result.job=new ComputeJob(ComputeJob::Heightmap,imageTree.getLeafValue(source),0,parameters,result);
+	ImageLoader::getLoader().submit(result.job);
 	
 	/* Return the result image ID: */
 	return resultId;
@@ -237,37 +561,12 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeHeightmap(const Doom3Te
 
 Doom3TextureManager::ImageID Doom3TextureManager::computeAddNormals(const Doom3TextureManager::ImageID& source1,const Doom3TextureManager::ImageID& source2)
 	{
-	/* Get a reference to the source images: */
-	const Images::RGBAImage& source1Image=imageTree.getLeafValue(source1).image;
-	Images::RGBAImage source2Image=imageTree.getLeafValue(source2).image;
-	if(source1Image.getWidth()!=source2Image.getWidth()||source1Image.getHeight()!=source2Image.getHeight())
-		{
-		/* Resample the second image to match the first image's size: */
-		source2Image.resize(source1Image.getWidth(),source1Image.getHeight());
-		}
-	
-	/* Store a new image structure in the image tree: */
-	ImageID resultId=imageTree.insertLeaf(Misc::stringPrintf("/_computedTextures/tex%06d",numTextures).c_str(),Image());
-	Image& result=imageTree.getLeafValue(resultId);
-	Images::RGBAImage& resultImage=result.image;
-	result.textureIndex=numTextures;
-	++numTextures;
-	
-	/* Compute the result image's pixels: */
-	resultImage=Images::RGBAImage(source1Image.getWidth(),source1Image.getHeight());
-	for(unsigned int y=0;y<resultImage.getHeight();++y)
-		{
-		const Images::RGBAImage::Color* source1Row=source1Image.getPixelRow(y);
-		const Images::RGBAImage::Color* source2Row=source2Image.getPixelRow(y);
-		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
-		for(unsigned int x=0;x<resultImage.getWidth();++x)
-			{
-			Geometry::Vector<float,3> g;
-			for(int i=0;i<3;++i)
-				g[i]=float(source1Row[x][i])+float(source2Row[x][i])-256.0f;
-			destRow[x]=encodeNormal(g);
-			}
-		}
+	/* Create the result image and compute it in the background: */
+	ImageID resultId;
+	Image& result=createComputedImage(resultId);
+	result.placeholderColor=Images::RGBAImage::Color(128,128,255,255);
+	result.job=new ComputeJob(ComputeJob::AddNormals,imageTree.getLeafValue(source1),&imageTree.getLeafValue(source2),0,result);
+	ImageLoader::getLoader().submit(result.job);
 	
 	/* Return the result image ID: */
 	return resultId;
@@ -275,27 +574,12 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeAddNormals(const Doom3T
 
 Doom3TextureManager::ImageID Doom3TextureManager::computeSmoothNormals(const Doom3TextureManager::ImageID& source)
 	{
-	/* Get a reference to the source image: */
-	const Images::RGBAImage& sourceImage=imageTree.getLeafValue(source).image;
-	
-	/* Store a new image structure in the image tree: */
-	ImageID resultId=imageTree.insertLeaf(Misc::stringPrintf("/_computedTextures/tex%06d",numTextures).c_str(),Image());
-	Image& result=imageTree.getLeafValue(resultId);
-	Images::RGBAImage& resultImage=result.image;
-	result.textureIndex=numTextures;
-	++numTextures;
-	
-	/* Compute the result image's pixels: */
-	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
-	for(unsigned int y=0;y<resultImage.getHeight();++y)
-		{
-		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
-		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
-		for(unsigned int x=0;x<resultImage.getWidth();++x)
-			{
-			destRow[x]=sourceRow[x];
-			}
-		}
+	/* Create the result image and compute it in the background: */
+	ImageID resultId;
+	Image& result=createComputedImage(resultId);
+	result.placeholderColor=Images::RGBAImage::Color(128,128,255,255);
+	result.job=new ComputeJob(ComputeJob::SmoothNormals,imageTree.getLeafValue(source),0,0,result);
+	ImageLoader::getLoader().submit(result.job);
 	
 	/* Return the result image ID: */
 	return resultId;
@@ -303,41 +587,11 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeSmoothNormals(const Doo
 
 Doom3TextureManager::ImageID Doom3TextureManager::computeAdd(const Doom3TextureManager::ImageID& source1,const Doom3TextureManager::ImageID& source2)
 	{
-	/* Get a reference to the source images: */
-	const Images::RGBAImage& source1Image=imageTree.getLeafValue(source1).image;
-	Images::RGBAImage source2Image=imageTree.getLeafValue(source2).image;
-	if(source1Image.getWidth()!=source2Image.getWidth()||source1Image.getHeight()!=source2Image.getHeight())
-		{
-		/* Resample the second image to match the first image's size: */
-		source2Image.resize(source1Image.getWidth(),source1Image.getHeight());
-		}
-	
-	/* Store a new image structure in the image tree: */
-	ImageID resultId=imageTree.insertLeaf(Misc::stringPrintf("/_computedTextures/tex%06d",numTextures).c_str(),Image());
-	Image& result=imageTree.getLeafValue(resultId);
-	Images::RGBAImage& resultImage=result.image;
-	result.textureIndex=numTextures;
-	++numTextures;
-	
-	/* Compute the result image's pixels: */
-	resultImage=Images::RGBAImage(source1Image.getWidth(),source1Image.getHeight());
-	for(unsigned int y=0;y<resultImage.getHeight();++y)
-		{
-		const Images::RGBAImage::Color* source1Row=source1Image.getPixelRow(y);
-		const Images::RGBAImage::Color* source2Row=source2Image.getPixelRow(y);
-		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
-		for(unsigned int x=0;x<resultImage.getWidth();++x)
-			{
-			for(int i=0;i<3;++i)
-				{
-				unsigned int sum=(unsigned int)(source1Row[x][i])+(unsigned int)(source2Row[x][i]);
-				if(sum>=255)
-					destRow[x][i]=GLubyte(255);
-				else
-					destRow[x][i]=GLubyte(sum);
-				}
-			}
-		}
+	/* Create the result image and compute it in the background: */
+	ImageID resultId;
+	Image& result=createComputedImage(resultId);
+	result.job=new ComputeJob(ComputeJob::Add,imageTree.getLeafValue(source1),&imageTree.getLeafValue(source2),0,result);
+	ImageLoader::getLoader().submit(result.job);
 	
 	/* Return the result image ID: */
 	return resultId;
@@ -345,36 +599,11 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeAdd(const Doom3TextureM
 
 Doom3TextureManager::ImageID Doom3TextureManager::computeScale(const Doom3TextureManager::ImageID& source,const float factors[4])
 	{
-	/* Get a reference to the source image: */
-	const Images::RGBAImage& sourceImage=imageTree.getLeafValue(source).image;
-	
-	/* Store a new image structure in the image tree: */
-	ImageID resultId=imageTree.insertLeaf(Misc::stringPrintf("/_computedTextures/tex%06d",numTextures).c_str(),Image());
-	Image& result=imageTree.getLeafValue(resultId);
-	Images::RGBAImage& resultImage=result.image;
-	result.textureIndex=numTextures;
-	++numTextures;
-	
-	/* Compute the result image's pixels: */
-	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
-	for(unsigned int y=0;y<resultImage.getHeight();++y)
-		{
-		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
-		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
-		for(unsigned int x=0;x<resultImage.getWidth();++x)
-			{
-			for(int i=0;i<4;++i)
-				{
-				float val=float(sourceRow[x][i])*factors[i];
-				if(val<0.5f)
-					destRow[x][i]=GLubyte(0);
-				else if(val>=254.5f)
-					destRow[x][i]=GLubyte(255);
-				else
-					destRow[x][i]=GLubyte(Math::floor(val+0.5f));
-				}
-			}
-		}
+	/* Create the result image and compute it in the background: */
+	ImageID resultId;
+	Image& result=createComputedImage(resultId);
+	result.job=new ComputeJob(ComputeJob::Scale,imageTree.getLeafValue(source),0,factors,result);
+	ImageLoader::getLoader().submit(result.job);
 	
 	/* Return the result image ID: */
 	return resultId;
@@ -382,29 +611,11 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeScale(const Doom3Textur
 
 Doom3TextureManager::ImageID Doom3TextureManager::computeInvertAlpha(const Doom3TextureManager::ImageID& source)
 	{
-	/* Get a reference to the source image: */
-	const Images::RGBAImage& sourceImage=imageTree.getLeafValue(source).image;
-	
-	/* Store a new image structure in the image tree: */
-	ImageID resultId=imageTree.insertLeaf(Misc::stringPrintf("/_computedTextures/tex%06d",numTextures).c_str(),Image());
-	Image& result=imageTree.getLeafValue(resultId);
-	Images::RGBAImage& resultImage=result.image;
-	result.textureIndex=numTextures;
-	++numTextures;
-	
-	/* Compute the result image's pixels: */
-	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
-	for(unsigned int y=0;y<resultImage.getHeight();++y)
-		{
-		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
-		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
-		for(unsigned int x=0;x<resultImage.getWidth();++x)
-			{
-			for(int i=0;i<3;++i)
-				destRow[x][i]=sourceRow[x][i];
-			destRow[x][3]=GLubyte(255)-destRow[x][3];
-			}
-		}
+	/* Create the result image and compute it in the background: */
+	ImageID resultId;
+	Image& result=createComputedImage(resultId);
+	result.job=new ComputeJob(ComputeJob::InvertAlpha,imageTree.getLeafValue(source),0,0,result);
+	ImageLoader::getLoader().submit(result.job);
 	
 	/* Return the result image ID: */
 	return resultId;
@@ -412,29 +623,11 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeInvertAlpha(const Doom3
 
 Doom3TextureManager::ImageID Doom3TextureManager::computeInvertColor(const Doom3TextureManager::ImageID& source)
 	{
-	/* Get a reference to the source image: */
-	const Images::RGBAImage& sourceImage=imageTree.getLeafValue(source).image;
-	
-	/* Store a new image structure in the image tree: */
-	ImageID resultId=imageTree.insertLeaf(Misc::stringPrintf("/_computedTextures/tex%06d",numTextures).c_str(),Image());
-	Image& result=imageTree.getLeafValue(resultId);
-	Images::RGBAImage& resultImage=result.image;
-	result.textureIndex=numTextures;
-	++numTextures;
-	
-	/* Compute the result image's pixels: */
-	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
-	for(unsigned int y=0;y<resultImage.getHeight();++y)
-		{
-		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
-		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
-		for(unsigned int x=0;x<resultImage.getWidth();++x)
-			{
-			for(int i=0;i<3;++i)
-				destRow[x][i]=GLubyte(255)-sourceRow[x][i];
-			destRow[x][3]=destRow[x][3];
-			}
-		}
+	/* Create the result image and compute it in the background: */
+	ImageID resultId;
+	Image& result=createComputedImage(resultId);
+	result.job=new ComputeJob(ComputeJob::InvertColor,imageTree.getLeafValue(source),0,0,result);
+	ImageLoader::getLoader().submit(result.job);
 	
 	/* Return the result image ID: */
 	return resultId;
@@ -442,28 +635,11 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeInvertColor(const Doom3
 
 Doom3TextureManager::ImageID Doom3TextureManager::computeMakeIntensity(const Doom3TextureManager::ImageID& source)
 	{
-	/* Get a reference to the source image: */
-	const Images::RGBAImage& sourceImage=imageTree.getLeafValue(source).image;
-	
-	/* Store a new image structure in the image tree: */
-	ImageID resultId=imageTree.insertLeaf(Misc::stringPrintf("/_computedTextures/tex%06d",numTextures).c_str(),Image());
-	Image& result=imageTree.getLeafValue(resultId);
-	Images::RGBAImage& resultImage=result.image;
-	result.textureIndex=numTextures;
-	++numTextures;
-	
-	/* Compute the result image's pixels: */
-	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
-	for(unsigned int y=0;y<resultImage.getHeight();++y)
-		{
-		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
-		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
-		for(unsigned int x=0;x<resultImage.getWidth();++x)
-			{
-			for(int i=0;i<4;++i)
-				destRow[x][i]=sourceRow[x][0];
-			}
-		}
+	/* Create the result image and compute it in the background: */
+	ImageID resultId;
+	Image& result=createComputedImage(resultId);
+	result.job=new ComputeJob(ComputeJob::MakeIntensity,imageTree.getLeafValue(source),0,0,result);
+	ImageLoader::getLoader().submit(result.job);
 	
 	/* Return the result image ID: */
 	return resultId;
@@ -471,33 +647,11 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeMakeIntensity(const Doo
 
 Doom3TextureManager::ImageID Doom3TextureManager::computeMakeAlpha(const Doom3TextureManager::ImageID& source)
 	{
-	/* Get a reference to the source image: */
-	const Images::RGBAImage& sourceImage=imageTree.getLeafValue(source).image;
-	
-	/* Store a new image structure in the image tree: */
-	ImageID resultId=imageTree.insertLeaf(Misc::stringPrintf("/_computedTextures/tex%06d",numTextures).c_str(),Image());
-	Image& result=imageTree.getLeafValue(resultId);
-	Images::RGBAImage& resultImage=result.image;
-	result.textureIndex=numTextures;
-	++numTextures;
-	
-	/* Compute the result image's pixels: */
-	resultImage=Images::RGBAImage(sourceImage.getWidth(),sourceImage.getHeight());
-	for(unsigned int y=0;y<resultImage.getHeight();++y)
-		{
-		const Images::RGBAImage::Color* sourceRow=sourceImage.getPixelRow(y);
-		Images::RGBAImage::Color* destRow=resultImage.modifyPixelRow(y);
-		for(unsigned int x=0;x<resultImage.getWidth();++x)
-			{
-			unsigned int sum=0U;
-			for(int i=0;i<3;++i)
-				{
-				sum+=sourceRow[x][i];
-				destRow[x][i]=GLubyte(255);
-				}
-			destRow[x][3]=GLubyte((sum+2U)/3U);
-			}
-		}
+	/* Create the result image and compute it in the background: */
+	ImageID resultId;
+	Image& result=createComputedImage(resultId);
+	result.job=new ComputeJob(ComputeJob::MakeAlpha,imageTree.getLeafValue(source),0,0,result);
+	ImageLoader::getLoader().submit(result.job);
 	
 	/* Return the result image ID: */
 	return resultId;
@@ -506,14 +660,30 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeMakeAlpha(const Doom3Te
 Doom3TextureManager::RenderContext Doom3TextureManager::start(GLContextData& contextData) const
 	{
 	/* Create a render context: */
-	RenderContext result(contextData.retrieveDataItem<DataItem>(this));
+	RenderContext result(contextData,contextData.retrieveDataItem<DataItem>(this));
 	
 	return result;
 	}
 
 void Doom3TextureManager::bindTexture(Doom3TextureManager::RenderContext& renderContext,const Doom3TextureManager::ImageID& image) const
 	{
-	glBindTexture(GL_TEXTURE_2D,renderContext.dataItem->textureObjectIds[imageTree.getLeafValue(image).textureIndex]);
+	const Image& img=imageTree.getLeafValue(image);
+	glBindTexture(GL_TEXTURE_2D,renderContext.dataItem->textureObjectIds[img.textureIndex]);
+	
+	/* Check if the final texture image still needs to be uploaded: */
+	if(!renderContext.dataItem->uploaded[img.textureIndex]&&img.isReady())
+		{
+		/* Upload the texture image if this frame's upload budget has not been exhausted yet: */
+		ImageLoader& loader=ImageLoader::getLoader();
+		if(loader.canUpload(renderContext.contextData))
+			{
+			Misc::Timer uploadTimer;
+			uploadImage(img);
+			uploadTimer.elapse();
+			loader.chargeUpload(renderContext.contextData,uploadTimer.getTime());
+			renderContext.dataItem->uploaded[img.textureIndex]=true;
+			}
+		}
 	}
 
 void Doom3TextureManager::finish(Doom3TextureManager::RenderContext& renderContext) const
@@ -26,9 +26,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/gl.h>
 #include <GL/GLObject.h>
 #include <Images/RGBAImage.h>
+#include <SceneGraph/ImageLoader.h>
 #include <SceneGraph/Internal/Doom3NameTree.h>
 
 /* Forward declarations: */
+class GLContextData;
 namespace SceneGraph {
 class Doom3FileManager;
 }
@@ -43,10 +45,25 @@ class Doom3TextureManager:public GLObject
 		{
 		/* Elements: */
 		public:
-		Images::RGBAImage image; // The texture image
+		Images::RGBAImage image; // The texture image; only valid once the image's job has finished
 		int textureIndex; // Index of this texture in the texture object ID array
+		Images::RGBAImage::Color placeholderColor; // Color of the placeholder texture shown while the image is not ready
+		ImageLoader::JobPtr job; // Background job creating the texture image, or null if the image was created immediately
+		
+		/* Methods: */
+		bool isReady(void) const // Returns true if the texture image can be uploaded
+			{
+			return job==0||job->isFinished();
+			}
+		bool hasFailed(void) const // Returns true if the image's job failed to create the texture image; only valid once the image is ready
+			{
+			return job!=0&&job->hasFailed();
+			}
 		};
 	
+	class LoadJob; // Background job to read a texture image from a file
+	class ComputeJob; // Background job to compute a texture image from one or two source images
+	
 	typedef Doom3NameTree<Image> ImageTree; // Structure to store all requested texture images
 	
 	struct DataItem:public GLObject::DataItem
@@ -55,6 +72,7 @@ class Doom3TextureManager:public GLObject
 		public:
 		int numTextures; // Number of requested textures
 		GLuint* textureObjectIds; // Array of texture object IDs
+		bool* uploaded; // Array of flags whether the final texture image has been uploaded into each texture object
 		
 		/* Constructors and destructors: */
 		DataItem(int sNumTextures);
@@ -67,13 +85,12 @@ class Doom3TextureManager:public GLObject
 		public:
 		const Doom3TextureManager& textureManager;
 		DataItem* dataItem;
-		unsigned int numTextures; // Number of uploaded textures
-		size_t totalTextureSize; // Total number of pixels in all uploaded textures
+		unsigned int numTextures; // Number of uploaded placeholder textures
 		
 		/* Constructors and destructors: */
 		TextureUploader(const Doom3TextureManager& sTextureManager,DataItem* sDataItem)
 			:textureManager(sTextureManager),dataItem(sDataItem),
-			 numTextures(0),totalTextureSize(0)
+			 numTextures(0)
 			{
 			};
 		
@@ -81,6 +98,17 @@ class Doom3TextureManager:public GLObject
 		void operator()(std::string name,const Image& image);
 		};
 	
+	struct JobWaiter // Helper class to wait for all pending background jobs
+		{
+		/* Methods: */
+		public:
+		void operator()(std::string name,const Image& image)
+			{
+			if(image.job!=0)
+				image.job->waitUntilFinished();
+			}
+		};
+	
 	public:
 	typedef ImageTree::LeafID ImageID; // Handle to allow clients to reference texture images
 	
@@ -90,12 +118,13 @@ class Doom3TextureManager:public GLObject
 		
 		/* Elements: */
 		private:
+		GLContextData& contextData; // The OpenGL context's data
 		DataItem* dataItem; // Pointer to the texture manager's data item
 		
 		/* Constructors and destructors: */
 		private:
-		RenderContext(DataItem* sDataItem)
-			:dataItem(sDataItem)
+		RenderContext(GLContextData& sContextData,DataItem* sDataItem)
+			:contextData(sContextData),dataItem(sDataItem)
 			{
 			}
 		};
@@ -106,16 +135,20 @@ class Doom3TextureManager:public GLObject
 	int numTextures; // Number of textures currently in the image tree
 	ImageTree imageTree; // The tree containing requested texture images
 	
+	/* Private methods: */
+	Image& createComputedImage(ImageID& resultId); // Creates a new image structure for the result of a compute operation
+	void uploadImage(const Image& image) const; // Uploads the given finished texture image into the currently bound texture object
+	
 	/* Constructors and destructors: */
 	public:
 	Doom3TextureManager(Doom3FileManager& sFileManager); // Creates an empty texture manager loading from the given file manager
-	virtual ~Doom3TextureManager(void);
+	virtual ~Doom3TextureManager(void); // Waits for all pending background jobs and destroys the texture manager
 	
 	/* Methods from GLObject: */
 	virtual void initContext(GLContextData& contextData) const; // Uploads all requested textures into texture objects
 	
 	/* New methods: */
-	ImageID loadTexture(const char* textureName); // Loads a texture image and returns its handle
+	ImageID loadTexture(const char* textureName); // Starts loading a texture image in the background and returns its handle
 	ImageID computeHeightmap(const ImageID& source,float bumpiness); // Converts a height map into a normalized normal map
 	ImageID computeAddNormals(const ImageID& source1,const ImageID& source2); // Adds and renormalizes two normal maps
 	ImageID computeSmoothNormals(const ImageID& source); // Smoothes and renormalizes a normal map
@@ -126,7 +159,7 @@ class Doom3TextureManager:public GLObject
 	ImageID computeMakeIntensity(const ImageID& source); // Copies the red channel to the G, B, and A channels
 	ImageID computeMakeAlpha(const ImageID& source); // Sets the alpha channel to the average of the RGB channels and the RGB channels to white
 	RenderContext start(GLContextData& contextData) const; // Prepares the OpenGL context for texture binding; returns a state variable to be handed back in subsequent calls
-	void bindTexture(RenderContext& renderContext,const ImageID& image) const; // Binds the given texture image into the OpenGL context
+	void bindTexture(RenderContext& renderContext,const ImageID& image) const; // Binds the given texture image into the OpenGL context; binds a placeholder if the image is not yet ready
 	void finish(RenderContext& renderContext) const; // Finishes texture binding into the current OpenGL context
 	};
 
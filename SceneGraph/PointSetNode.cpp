@@ -38,6 +38,71 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 namespace SceneGraph {
 
+namespace {
+
+/****************
+Helper constants:
+****************/
+
+const size_t transformBatchSize=262144; // Number of points transformed at a time when uploading transformed points
+
+/**************
+Helper classes:
+**************/
+
+template <class VertexParam>
+class PositionWriter:public PointTransformNode::BatchConsumer // Class to write batches of transformed points into the positions of a vertex array
+	{
+	/* Elements: */
+	private:
+	VertexParam* vertices; // The vertex array
+	
+	/* Constructors and destructors: */
+	public:
+	PositionWriter(VertexParam* sVertices)
+		:vertices(sVertices)
+		{
+		}
+	
+	/* Methods from class PointTransformNode::BatchConsumer: */
+	virtual void consumeBatch(size_t first,size_t numPoints,const PointTransformNode::TPoint transformedPoints[])
+		{
+		VertexParam* vPtr=vertices+first;
+		for(size_t i=0;i<numPoints;++i,++vPtr)
+			vPtr->position=transformedPoints[i];
+		}
+	};
+
+template <class VertexParam>
+class ColorPositionWriter:public PointTransformNode::BatchConsumer // Class to write batches of transformed points and their colors into a vertex array
+	{
+	/* Elements: */
+	private:
+	VertexParam* vertices; // The vertex array
+	const Color* colors; // The points' colors
+	
+	/* Constructors and destructors: */
+	public:
+	ColorPositionWriter(VertexParam* sVertices,const Color* sColors)
+		:vertices(sVertices),colors(sColors)
+		{
+		}
+	
+	/* Methods from class PointTransformNode::BatchConsumer: */
+	virtual void consumeBatch(size_t first,size_t numPoints,const PointTransformNode::TPoint transformedPoints[])
+		{
+		VertexParam* vPtr=vertices+first;
+		const Color* cPtr=colors+first;
+		for(size_t i=0;i<numPoints;++i,++vPtr,++cPtr)
+			{
+			vPtr->color=*cPtr;
+			vPtr->position=transformedPoints[i];
+			}
+		}
+	};
+
+}
+
 /***************************************
 Methods of class PointSetNode::DataItem:
 ***************************************/
@@ -226,11 +291,10 @@ void PointSetNode::glRenderAction(GLRenderState& renderState) const
 					ColorVertex* vPtr=static_cast<ColorVertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
 					if(pointTransform.getValue()!=0)
 						{
-						for(size_t i=0;i<numPoints;++i,++vPtr)
-							{
-							vPtr->color=colors[i];
-							vPtr->position=pointTransform.getValue()->transformPoint(points[i]);
-							}
+						/* Transform the points in batches: */
+						ColorPositionWriter<ColorVertex> writer(vPtr,numPoints>0?&colors[0]:0);
+						if(numPoints>0)
+							pointTransform.getValue()->transformPointBatches(numPoints,&points[0],transformBatchSize,writer);
 						}
 					else
 						{
@@ -246,8 +310,10 @@ void PointSetNode::glRenderAction(GLRenderState& renderState) const
 					Vertex* vPtr=static_cast<Vertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
 					if(pointTransform.getValue()!=0)
 						{
-						for(size_t i=0;i<numPoints;++i,++vPtr)
-							vPtr->position=pointTransform.getValue()->transformPoint(points[i]);
+						/* Transform the points in batches: */
+						PositionWriter<Vertex> writer(vPtr);
+						if(numPoints>0)
+							pointTransform.getValue()->transformPointBatches(numPoints,&points[0],transformBatchSize,writer);
 						}
 					else
 						{
@@ -0,0 +1,220 @@
+/***********************************************************************
+PointTransformNode - Base class for nodes that define non-linear
+transformations that can be applied to the point coordinates and normal
+vectors of Geometry nodes.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/PointTransformNode.h>
+
+#include <unistd.h>
+#include <Threads/Mutex.h>
+#include <Threads/Thread.h>
+#include <Geometry/Box.h>
+
+namespace SceneGraph {
+
+namespace {
+
+/****************
+Helper constants:
+****************/
+
+const size_t transformBlockSize=4096; // Number of consecutive points claimed by a batch transformation thread at a time
+const size_t minPointsPerThread=65536; // Minimum number of points per thread to amortize the cost of starting threads
+const size_t boundingBoxChunkSize=262144; // Number of points transformed at a time when calculating bounding boxes
+
+/**************
+Helper classes:
+**************/
+
+class BoundingBoxConsumer:public PointTransformNode::BatchConsumer // Class to accumulate the bounding box of batches of transformed points
+	{
+	/* Elements: */
+	private:
+	Threads::Mutex boxMutex; // Mutex serializing access to the bounding box
+	PointTransformNode::TBox box; // The accumulated bounding box
+	
+	/* Constructors and destructors: */
+	public:
+	BoundingBoxConsumer(void)
+		:box(PointTransformNode::TBox::empty)
+		{
+		}
+	
+	/* Methods from class PointTransformNode::BatchConsumer: */
+	virtual void consumeBatch(size_t first,size_t numPoints,const PointTransformNode::TPoint transformedPoints[])
+		{
+		/* Calculate the batch's bounding box outside the lock: */
+		PointTransformNode::TBox batchBox=PointTransformNode::TBox::empty;
+		for(size_t i=0;i<numPoints;++i)
+			batchBox.addPoint(transformedPoints[i]);
+		
+		/* Merge the batch's bounding box into the accumulated bounding box: */
+		Threads::Mutex::Lock boxLock(boxMutex);
+		box.addBox(batchBox);
+		}
+	
+	/* New methods: */
+	const PointTransformNode::TBox& getBox(void) const // Returns the accumulated bounding box
+		{
+		return box;
+		}
+	};
+
+}
+
+/***********************************
+Methods of class PointTransformNode:
+***********************************/
+
+int PointTransformNode::calcNumThreads(size_t numPoints,int numThreads)
+	{
+	if(numThreads<=0)
+		{
+		/* Use one thread per CPU, but only if each thread gets enough work: */
+		numThreads=int(sysconf(_SC_NPROCESSORS_ONLN));
+		if(size_t(numThreads)>numPoints/minPointsPerThread)
+			numThreads=int(numPoints/minPointsPerThread);
+		}
+	
+	return numThreads;
+	}
+
+void* PointTransformNode::transformPointsThread(PointTransformNode::TransformPointsArgs* args)
+	{
+	/* Claim and transform blocks of consecutive points until all are taken: */
+	while(true)
+		{
+		size_t first=args->nextPoint.preAdd(transformBlockSize)-transformBlockSize;
+		if(first>=args->numPoints)
+			break;
+		size_t numPoints=args->numPoints-first;
+		if(numPoints>transformBlockSize)
+			numPoints=transformBlockSize;
+		
+		args->node->transformPointBlock(numPoints,args->points+first,args->transformedPoints+first);
+		}
+	
+	return 0;
+	}
+
+void* PointTransformNode::transformBatchesThread(PointTransformNode::TransformBatchesArgs* args)
+	{
+	/* Transform the thread's batches into a private buffer and hand them to the consumer: */
+	std::vector<TPoint> transformedPoints(args->batchSize);
+	for(size_t batch=args->firstBatch;batch<args->lastBatch;++batch)
+		{
+		size_t first=batch*args->batchSize;
+		size_t numPoints=args->numPoints-first;
+		if(numPoints>args->batchSize)
+			numPoints=args->batchSize;
+		
+		args->node->transformPointBlock(numPoints,args->points+first,&transformedPoints[0]);
+		args->consumer->consumeBatch(first,numPoints,&transformedPoints[0]);
+		}
+	
+	return 0;
+	}
+
+void PointTransformNode::transformPointBlock(size_t numPoints,const Point points[],PointTransformNode::TPoint transformedPoints[]) const
+	{
+	/* Transform all points individually: */
+	for(size_t i=0;i<numPoints;++i)
+		transformedPoints[i]=transformPoint(TPoint(points[i]));
+	}
+
+PointTransformNode::TBox PointTransformNode::calcBatchBoundingBox(const std::vector<Point>& points) const
+	{
+	/* Transform the points in chunks to limit the size of the temporary point arrays: */
+	BoundingBoxConsumer consumer;
+	if(!points.empty())
+		transformPointBatches(points.size(),&points[0],boundingBoxChunkSize,consumer);
+	
+	return consumer.getBox();
+	}
+
+void PointTransformNode::transformPoints(size_t numPoints,const Point points[],PointTransformNode::TPoint transformedPoints[],int numThreads) const
+	{
+	numThreads=calcNumThreads(numPoints,numThreads);
+	if(numThreads<=1)
+		{
+		/* Transform all points in the calling thread: */
+		transformPointBlock(numPoints,points,transformedPoints);
+		return;
+		}
+	
+	/* Start helper threads: */
+	TransformPointsArgs args(this,numPoints,points,transformedPoints);
+	Threads::Thread* threads=new Threads::Thread[numThreads-1];
+	for(int i=0;i<numThreads-1;++i)
+		threads[i].start(&PointTransformNode::transformPointsThread,&args);
+	
+	/* Transform points in the calling thread as well: */
+	transformPointsThread(&args);
+	
+	/* Wait for all helper threads to finish: */
+	for(int i=0;i<numThreads-1;++i)
+		threads[i].join();
+	delete[] threads;
+	}
+
+void PointTransformNode::transformPointBatches(size_t numPoints,const Point points[],size_t batchSize,PointTransformNode::BatchConsumer& consumer,int numThreads) const
+	{
+	if(numPoints==0)
+		return;
+	if(batchSize<1)
+		batchSize=1;
+	
+	/* Don't start more threads than there are batches: */
+	size_t numBatches=(numPoints+batchSize-1)/batchSize;
+	numThreads=calcNumThreads(numPoints,numThreads);
+	if(numThreads<1)
+		numThreads=1;
+	if(size_t(numThreads)>numBatches)
+		numThreads=int(numBatches);
+	
+	/* Assign each thread a contiguous range of batches: */
+	std::vector<TransformBatchesArgs> args(numThreads);
+	for(int i=0;i<numThreads;++i)
+		{
+		args[i].node=this;
+		args[i].numPoints=numPoints;
+		args[i].points=points;
+		args[i].batchSize=batchSize;
+		args[i].consumer=&consumer;
+		args[i].firstBatch=(numBatches*size_t(i))/size_t(numThreads);
+		args[i].lastBatch=(numBatches*size_t(i+1))/size_t(numThreads);
+		}
+	
+	/* Start helper threads for all but the first range of batches: */
+	Threads::Thread* threads=numThreads>1?new Threads::Thread[numThreads-1]:0;
+	for(int i=1;i<numThreads;++i)
+		threads[i-1].start(&PointTransformNode::transformBatchesThread,&args[i]);
+	
+	/* Transform the first range of batches in the calling thread: */
+	transformBatchesThread(&args[0]);
+	
+	/* Wait for all helper threads to finish: */
+	for(int i=1;i<numThreads;++i)
+		threads[i-1].join();
+	delete[] threads;
+	}
+
+}
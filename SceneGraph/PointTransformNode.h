@@ -24,8 +24,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_POINTTRANSFORMNODE_INCLUDED
 #define SCENEGRAPH_POINTTRANSFORMNODE_INCLUDED
 
+#include <stddef.h>
 #include <vector>
 #include <Misc/Autopointer.h>
+#include <Threads/Atomic.h>
 #include <SceneGraph/Geometry.h>
 #include <SceneGraph/FieldTypes.h>
 #include <SceneGraph/Node.h>
@@ -45,8 +47,63 @@ class PointTransformNode:public Node
 	typedef SF<TPoint> SFTPoint; // Type for single-value fields of double-precision points
 	typedef MF<TPoint> MFTPoint; // Type for multi-value fields of double-precision points
 	
+	class BatchConsumer // Abstract base class for objects receiving batches of transformed points
+		{
+		/* Constructors and destructors: */
+		public:
+		virtual ~BatchConsumer(void)
+			{
+			}
+		
+		/* Methods: */
+		virtual void consumeBatch(size_t first,size_t numPoints,const TPoint transformedPoints[]) =0; // Receives the transformed points of the batch of source points starting at the given index; called from multiple threads concurrently for disjoint batches
+		};
+	
+	private:
+	struct TransformPointsArgs // Structure to hold arguments for batch point transformation threads
+		{
+		/* Elements: */
+		public:
+		const PointTransformNode* node; // The point transformation node
+		size_t numPoints; // Number of points in the batch
+		const Point* points; // Array of source points
+		TPoint* transformedPoints; // Array receiving transformed points
+		Threads::Atomic<size_t> nextPoint; // Index of the first point in the next unclaimed block of points
+		
+		/* Constructors and destructors: */
+		TransformPointsArgs(const PointTransformNode* sNode,size_t sNumPoints,const Point* sPoints,TPoint* sTransformedPoints)
+			:node(sNode),numPoints(sNumPoints),points(sPoints),transformedPoints(sTransformedPoints),
+			 nextPoint(0)
+			{
+			}
+		};
+	
+	struct TransformBatchesArgs // Structure to hold arguments for a thread transforming a range of point batches
+		{
+		/* Elements: */
+		public:
+		const PointTransformNode* node; // The point transformation node
+		size_t numPoints; // Total number of points
+		const Point* points; // Array of source points
+		size_t batchSize; // Number of points per batch
+		BatchConsumer* consumer; // Object receiving the transformed batches
+		size_t firstBatch,lastBatch; // Range of batches transformed by the thread
+		};
+	
+	/* Private methods: */
+	static int calcNumThreads(size_t numPoints,int numThreads); // Returns the number of threads to transform the given number of points, based on available CPUs if the given number of threads is zero
+	static void* transformPointsThread(TransformPointsArgs* args); // Transforms blocks of points from a batch until all points are transformed
+	static void* transformBatchesThread(TransformBatchesArgs* args); // Transforms a range of point batches and hands them to the consumer
+	
+	/* Protected methods: */
+	protected:
+	virtual void transformPointBlock(size_t numPoints,const Point points[],TPoint transformedPoints[]) const; // Transforms a block of single-precision points; can be called from multiple threads concurrently; default implementation transforms each point individually
+	TBox calcBatchBoundingBox(const std::vector<Point>& points) const; // Calculates transformed bounding box of a single-precision point array using batch transformation
+	
 	/* New methods: */
 	public:
+	void transformPoints(size_t numPoints,const Point points[],TPoint transformedPoints[],int numThreads=0) const; // Transforms an array of single-precision points using the given number of threads, or a number of threads based on batch size and available CPUs if zero
+	void transformPointBatches(size_t numPoints,const Point points[],size_t batchSize,BatchConsumer& consumer,int numThreads=0) const; // Transforms an array of single-precision points in batches of the given size that are handed to the given consumer, starting the given number of threads, or a number of threads based on array size and available CPUs if zero, once for all batches
 	virtual TPoint transformPoint(const TPoint& point) const =0; // Transforms a point
 	virtual TPoint inverseTransformPoint(const TPoint& point) const =0; // Transforms a point with the inverse transformation
 	virtual TBox calcBoundingBox(const std::vector<Point>& points) const =0; // Calculates transformed bounding box of a single-precision point list
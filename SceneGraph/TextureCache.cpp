@@ -0,0 +1,463 @@
+/***********************************************************************
+TextureCache - Class to share texture images and their OpenGL texture
+objects between all scene graph nodes referencing the same image file,
+with least-recently-used eviction of unused textures under CPU and GPU
+memory budgets.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/TextureCache.h>
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdexcept>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Misc/MessageLogger.h>
+#include <IO/StandardDirectory.h>
+#include <GL/GLContextData.h>
+#include <GL/Extensions/GLEXTFramebufferObject.h>
+#include <Images/BaseImage.h>
+#include <Images/ReadImageFile.h>
+
+namespace SceneGraph {
+
+/******************************************
+Declaration of class TextureCache::LoadJob:
+******************************************/
+
+class TextureCache::LoadJob:public ImageLoader::Job
+	{
+	/* Elements: */
+	private:
+	Entry& entry; // The cache entry whose texture image is read
+	IO::DirectoryPtr baseDirectory; // Base directory for the image URL; released once the image has been read
+	Images::BaseImage image; // The texture image; only valid after the job has finished successfully
+	
+	/* Protected methods from ImageLoader::Job: */
+	protected:
+	virtual void process(void)
+		{
+		/* Release the base directory when done, even if reading the image fails: */
+		IO::DirectoryPtr directory=baseDirectory;
+		baseDirectory=0;
+		
+		/* Load the texture image: */
+		image=Images::readGenericImageFile(*directory,entry.url.c_str());
+		
+		/* Calculate the image's memory size and the estimated size of its texture object: */
+		size_t imageSize=size_t(image.getRowStride())*size_t(image.getHeight());
+		size_t textureSize=size_t(image.getWidth())*size_t(image.getHeight())*size_t(image.getNumChannels())*size_t(image.getChannelSize());
+		if(entry.parameters.mipmapLevel>0)
+			textureSize=(textureSize*4)/3;
+		
+		/* Notify the cache: */
+		entry.cache.imageLoaded(&entry,imageSize,textureSize);
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	LoadJob(Entry& sEntry,IO::Directory& sBaseDirectory)
+		:entry(sEntry),baseDirectory(&sBaseDirectory)
+		{
+		}
+	
+	/* Methods: */
+	const Images::BaseImage& getImage(void) const // Returns the texture image
+		{
+		return image;
+		}
+	};
+
+/**********************************************
+Methods of class TextureCache::Entry::DataItem:
+**********************************************/
+
+TextureCache::Entry::DataItem::DataItem(TextureCache& sCache,TextureCache::Entry::GpuUsage* sGpuUsage)
+	:cache(sCache),gpuUsage(sGpuUsage),
+	 textureObjectId(0),textureSize(0),
+	 uploaded(false),havePlaceholder(false)
+	{
+	glGenTextures(1,&textureObjectId);
+	}
+
+TextureCache::Entry::DataItem::~DataItem(void)
+	{
+	glDeleteTextures(1,&textureObjectId);
+	
+	/* Remove the texture object's memory from the cache's statistics: */
+	if(textureSize!=0)
+		cache.textureReleased(gpuUsage.getPointer(),textureSize);
+	}
+
+/************************************
+Methods of class TextureCache::Entry:
+************************************/
+
+TextureCache::Entry::Entry(TextureCache& sCache,const std::string& sKey,IO::Directory& baseDirectory,const std::string& sUrl,const TextureCache::TextureParameters& sParameters)
+	:cache(sCache),key(sKey),url(sUrl),parameters(sParameters),
+	 imageSize(0),textureSize(0),gpuUsage(new GpuUsage),cached(true),
+	 numUsers(0),lruPred(0),lruSucc(0)
+	{
+	/* Read the texture image in the background: */
+	loadJob=new LoadJob(*this,baseDirectory);
+	cache.loader->submit(loadJob);
+	}
+
+TextureCache::Entry::~Entry(void)
+	{
+	}
+
+void TextureCache::Entry::initContext(GLContextData& contextData) const
+	{
+	/* Create a data item and store it in the GL context: */
+	DataItem* dataItem=new DataItem(cache,gpuUsage.getPointer());
+	contextData.addDataItem(this,dataItem);
+	}
+
+GLuint TextureCache::Entry::getTextureObjectId(GLContextData& contextData) const
+	{
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	return dataItem->textureObjectId;
+	}
+
+void TextureCache::Entry::updateTexture(GLContextData& contextData) const
+	{
+	/* Bail out if the texture object is already up to date: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	if(dataItem->uploaded)
+		return;
+	
+	/* Check if the texture image is ready and can be uploaded during this frame: */
+	const LoadJob* job=static_cast<const LoadJob*>(loadJob.getPointer());
+	if(job->isFinished()&&cache.loader->canUpload(contextData))
+		{
+		Misc::Timer uploadTimer;
+		int mml=parameters.mipmapLevel;
+		if(!job->hasFailed())
+			{
+			/* Upload the texture image: */
+			job->getImage().glTexImage2D(GL_TEXTURE_2D,0,false);
+			}
+		else
+			{
+			/* Keep showing a placeholder: */
+			Misc::formattedUserError("SceneGraph::TextureCache: Unable to load image %s due to exception %s",url.c_str(),job->getErrorMessage().c_str());
+			GLubyte placeholder[4]={255U,255U,255U,255U};
+			glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8,1,1,0,GL_RGBA,GL_UNSIGNED_BYTE,placeholder);
+			mml=0;
+			}
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_BASE_LEVEL,0);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAX_LEVEL,mml);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,parameters.filter?(mml>0?GL_LINEAR_MIPMAP_LINEAR:GL_LINEAR):GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,parameters.filter?GL_LINEAR:GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,parameters.repeatS?GL_REPEAT:GL_CLAMP);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,parameters.repeatT?GL_REPEAT:GL_CLAMP);
+		
+		/* Check if mipmapping was requested and mipmap generation is supported: */
+		if(mml>0&&GLEXTFramebufferObject::isSupported())
+			{
+			/* Initialize the framebuffer extension: */
+			GLEXTFramebufferObject::initExtension();
+			
+			/* Auto-generate all requested mipmap levels: */
+			glGenerateMipmapEXT(GL_TEXTURE_2D);
+			}
+		
+		/* Charge the upload against this frame's upload budget: */
+		uploadTimer.elapse();
+		cache.loader->chargeUpload(contextData,uploadTimer.getTime());
+		
+		/* Mark the texture object as up-to-date: */
+		dataItem->uploaded=true;
+		if(!job->hasFailed())
+			{
+			/* Account for the new texture object's memory: */
+			dataItem->textureSize=textureSize;
+			cache.textureUploaded(gpuUsage.getPointer(),textureSize);
+			}
+		}
+	else if(!dataItem->havePlaceholder)
+		{
+		/* Upload a white placeholder until the texture image is ready: */
+		GLubyte placeholder[4]={255U,255U,255U,255U};
+		glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8,1,1,0,GL_RGBA,GL_UNSIGNED_BYTE,placeholder);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_BASE_LEVEL,0);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAX_LEVEL,0);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
+		dataItem->havePlaceholder=true;
+		}
+	}
+
+/*************************************
+Static elements of class TextureCache:
+*************************************/
+
+Threads::Mutex TextureCache::theCacheMutex;
+Misc::SelfDestructPointer<TextureCache> TextureCache::theCache;
+
+/*****************************
+Methods of class TextureCache:
+*****************************/
+
+void TextureCache::unlinkUnused(TextureCache::Entry* entry)
+	{
+	if(entry->lruPred!=0)
+		entry->lruPred->lruSucc=entry->lruSucc;
+	else
+		lruHead=entry->lruSucc;
+	if(entry->lruSucc!=0)
+		entry->lruSucc->lruPred=entry->lruPred;
+	else
+		lruTail=entry->lruPred;
+	entry->lruPred=0;
+	entry->lruSucc=0;
+	--statistics.numUnusedEntries;
+	}
+
+void TextureCache::destroyEntry(TextureCache::Entry* entry)
+	{
+	/* Remove the entry's memory from the statistics; texture objects that outlive the entry in their OpenGL contexts no longer count: */
+	statistics.cpuMemory-=entry->imageSize;
+	statistics.gpuMemory-=entry->gpuUsage->numBytes;
+	entry->gpuUsage->evicted=true;
+	
+	/* Destroy the entry, which also schedules its texture objects for destruction: */
+	delete entry;
+	}
+
+void TextureCache::evictUnused(void)
+	{
+	/* Evict unused entries in least-recently used order until the cache fits into its budgets: */
+	Entry* ePtr=lruHead;
+	while(ePtr!=0&&(statistics.cpuMemory>cpuMemoryBudget||statistics.gpuMemory>gpuMemoryBudget))
+		{
+		Entry* succ=ePtr->lruSucc;
+		
+		/* Skip entries whose texture images are still being read: */
+		if(ePtr->loadJob->isFinished())
+			{
+			/* Remove the entry from the cache and destroy it: */
+			unlinkUnused(ePtr);
+			entries.removeEntry(ePtr->key);
+			destroyEntry(ePtr);
+			++statistics.numEvictions;
+			}
+		
+		ePtr=succ;
+		}
+	}
+
+void TextureCache::imageLoaded(TextureCache::Entry* entry,size_t imageSize,size_t textureSize)
+	{
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	
+	/* Account for the texture image's memory; eviction is left to the main thread: */
+	entry->imageSize=imageSize;
+	entry->textureSize=textureSize;
+	statistics.cpuMemory+=imageSize;
+	}
+
+void TextureCache::textureUploaded(TextureCache::Entry::GpuUsage* gpuUsage,size_t textureSize)
+	{
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	
+	/* Account for the new texture object's memory; eviction is left to the main thread: */
+	gpuUsage->numBytes+=textureSize;
+	if(!gpuUsage->evicted)
+		statistics.gpuMemory+=textureSize;
+	}
+
+void TextureCache::textureReleased(TextureCache::Entry::GpuUsage* gpuUsage,size_t textureSize)
+	{
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	
+	/* Remove the texture object's memory unless its entry was already removed from the cache: */
+	gpuUsage->numBytes-=textureSize;
+	if(!gpuUsage->evicted)
+		statistics.gpuMemory-=textureSize;
+	}
+
+TextureCache::TextureCache(size_t sCpuMemoryBudget,size_t sGpuMemoryBudget)
+	:loader(new ImageLoader(0)),
+	 entries(101),
+	 lruHead(0),lruTail(0),
+	 cpuMemoryBudget(sCpuMemoryBudget),gpuMemoryBudget(sGpuMemoryBudget)
+	{
+	/* Initialize the usage statistics: */
+	statistics.numHits=0;
+	statistics.numMisses=0;
+	statistics.numEvictions=0;
+	statistics.numEntries=0;
+	statistics.numUnusedEntries=0;
+	statistics.cpuMemory=0;
+	statistics.gpuMemory=0;
+	}
+
+TextureCache::~TextureCache(void)
+	{
+	/* Wait for all pending background jobs, which report back to the cache: */
+	std::vector<ImageLoader::JobPtr> jobs;
+	{
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	for(EntryMap::Iterator eIt=entries.begin();!eIt.isFinished();++eIt)
+		jobs.push_back(eIt->getDest()->loadJob);
+	}
+	for(std::vector<ImageLoader::JobPtr>::iterator jIt=jobs.begin();jIt!=jobs.end();++jIt)
+		(*jIt)->waitUntilFinished();
+	
+	/* Destroy all remaining entries: */
+	for(EntryMap::Iterator eIt=entries.begin();!eIt.isFinished();++eIt)
+		delete eIt->getDest();
+	
+	/* Shut down the image loader after all entries that submitted jobs to it are gone: */
+	delete loader;
+	}
+
+TextureCache& TextureCache::getCache(void)
+	{
+	Threads::Mutex::Lock theCacheLock(theCacheMutex);
+	
+	/* Create the shared texture cache if it does not exist yet: */
+	if(!theCache.isValid())
+		theCache.setTarget(new TextureCache(size_t(256)*1024*1024,size_t(512)*1024*1024));
+	
+	return *theCache;
+	}
+
+bool TextureCache::haveCache(void)
+	{
+	Threads::Mutex::Lock theCacheLock(theCacheMutex);
+	return theCache.isValid();
+	}
+
+void TextureCache::setMemoryBudgets(size_t newCpuMemoryBudget,size_t newGpuMemoryBudget)
+	{
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	cpuMemoryBudget=newCpuMemoryBudget;
+	gpuMemoryBudget=newGpuMemoryBudget;
+	
+	/* Evict unused entries to fit into the new budgets: */
+	evictUnused();
+	}
+
+TextureCache::Entry* TextureCache::acquire(IO::Directory& baseDirectory,const std::string& url,const TextureCache::TextureParameters& parameters)
+	{
+	/* Create the entry's key from the resolved image URL and the texture parameters: */
+	std::string key;
+	try
+		{
+		key=baseDirectory.getPath(url.c_str());
+		}
+	catch(const std::runtime_error&)
+		{
+		/* Use the unresolved URL; reading the image will report the error: */
+		key=baseDirectory.getPath();
+		key.push_back('/');
+		key.append(url);
+		}
+	
+	/* Add the image file's modification time to the key so that changed files are read again: */
+	long modTime=0;
+	if(dynamic_cast<IO::StandardDirectory*>(&baseDirectory)!=0)
+		{
+		struct stat fileStats;
+		if(stat(key.c_str(),&fileStats)==0)
+			modTime=long(fileStats.st_mtime);
+		}
+	
+	char parameterTag[64];
+	snprintf(parameterTag,sizeof(parameterTag),"|%ld|%d%d%d%d",modTime,parameters.repeatS?1:0,parameters.repeatT?1:0,parameters.filter?1:0,parameters.mipmapLevel);
+	key.append(parameterTag);
+	
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	
+	/* Check if the texture is already in the cache: */
+	EntryMap::Iterator eIt=entries.findEntry(key);
+	if(!eIt.isFinished()&&eIt->getDest()->loadJob->isFinished()&&eIt->getDest()->loadJob->hasFailed())
+		{
+		/* Remove the failed entry from the cache so that its texture image is read again: */
+		Entry* failed=eIt->getDest();
+		entries.removeEntry(eIt);
+		failed->cached=false;
+		if(failed->numUsers==0)
+			{
+			unlinkUnused(failed);
+			destroyEntry(failed);
+			}
+		eIt=entries.findEntry(key);
+		}
+	Entry* result;
+	if(!eIt.isFinished())
+		{
+		/* Share the existing entry and take it off the list of unused entries: */
+		result=eIt->getDest();
+		if(result->numUsers==0)
+			unlinkUnused(result);
+		++statistics.numHits;
+		}
+	else
+		{
+		/* Create a new entry, which starts reading the texture image: */
+		result=new Entry(*this,key,baseDirectory,url,parameters);
+		entries.setEntry(EntryMap::Entry(key,result));
+		++statistics.numMisses;
+		}
+	++result->numUsers;
+	
+	return result;
+	}
+
+void TextureCache::release(TextureCache::Entry* entry)
+	{
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	
+	if(--entry->numUsers==0&&!entry->cached)
+		{
+		/* Destroy the entry, which was removed from the cache after failing to read its texture image: */
+		destroyEntry(entry);
+		}
+	else if(entry->numUsers==0)
+		{
+		/* Put the entry at the most-recently used end of the list of unused entries: */
+		entry->lruPred=lruTail;
+		entry->lruSucc=0;
+		if(lruTail!=0)
+			lruTail->lruSucc=entry;
+		else
+			lruHead=entry;
+		lruTail=entry;
+		++statistics.numUnusedEntries;
+		
+		/* Evict unused entries if the cache is over budget: */
+		evictUnused();
+		}
+	}
+
+TextureCache::Statistics TextureCache::getStatistics(void) const
+	{
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	Statistics result=statistics;
+	result.numEntries=entries.getNumEntries();
+	return result;
+	}
+
+}
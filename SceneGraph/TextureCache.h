@@ -0,0 +1,193 @@
+/***********************************************************************
+TextureCache - Class to share texture images and their OpenGL texture
+objects between all scene graph nodes referencing the same image file,
+with least-recently-used eviction of unused textures under CPU and GPU
+memory budgets.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_TEXTURECACHE_INCLUDED
+#define SCENEGRAPH_TEXTURECACHE_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <Misc/SelfDestructPointer.h>
+#include <Misc/Autopointer.h>
+#include <Misc/StringHashFunctions.h>
+#include <Misc/HashTable.h>
+#include <Threads/Mutex.h>
+#include <Threads/RefCounted.h>
+#include <IO/Directory.h>
+#include <GL/gl.h>
+#include <GL/GLObject.h>
+#include <SceneGraph/ImageLoader.h>
+
+/* Forward declarations: */
+class GLContextData;
+
+namespace SceneGraph {
+
+class TextureCache
+	{
+	/* Embedded classes: */
+	private:
+	class LoadJob; // Background job to read a texture image
+	
+	public:
+	struct TextureParameters // Structure describing how a texture image is turned into a texture object
+		{
+		/* Elements: */
+		public:
+		bool repeatS,repeatT; // Flags whether the texture repeats or is clamped in s and t
+		bool filter; // Flag whether the texture is filtered bilinearly (or trilinearly if mipmapLevel>0)
+		int mipmapLevel; // Maximum generated mipmap level; 0 disables mipmapping
+		};
+	
+	struct Statistics // Structure to report cache usage
+		{
+		/* Elements: */
+		public:
+		size_t numHits; // Number of texture requests that found an existing entry
+		size_t numMisses; // Number of texture requests that created a new entry
+		size_t numEvictions; // Number of unused entries that were evicted to stay within the memory budgets
+		size_t numEntries; // Current number of entries
+		size_t numUnusedEntries; // Current number of entries that are not referenced by any scene graph node
+		size_t cpuMemory; // Current amount of memory held by decoded texture images in bytes
+		size_t gpuMemory; // Current estimated amount of texture memory held by texture objects in all OpenGL contexts in bytes
+		};
+	
+	class Entry:public GLObject // Class for a shared texture image and its per-context texture objects
+		{
+		friend class TextureCache;
+		friend class LoadJob;
+		
+		/* Embedded classes: */
+		private:
+		struct GpuUsage:public Threads::RefCounted // Structure tracking the texture memory held by an entry's texture objects; outlives the entry until all its texture objects are destroyed
+			{
+			/* Elements: */
+			public:
+			size_t numBytes; // Estimated memory held by the entry's texture objects in all OpenGL contexts
+			bool evicted; // Flag whether the entry has been removed from the cache and no longer counts towards its memory use
+			
+			/* Constructors and destructors: */
+			GpuUsage(void)
+				:numBytes(0),evicted(false)
+				{
+				}
+			};
+		
+		typedef Misc::Autopointer<GpuUsage> GpuUsagePtr; // Type for pointers to texture memory trackers
+		
+		struct DataItem:public GLObject::DataItem
+			{
+			/* Elements: */
+			public:
+			TextureCache& cache; // The cache owning the entry
+			GpuUsagePtr gpuUsage; // Texture memory tracker of the entry
+			GLuint textureObjectId; // ID of texture object
+			size_t textureSize; // Estimated memory held by the texture object once the texture image has been uploaded
+			bool uploaded; // Flag whether the texture object contains the final texture image, or a placeholder if the image could not be read
+			bool havePlaceholder; // Flag whether the texture object contains a placeholder while the texture image is being read
+			
+			/* Constructors and destructors: */
+			DataItem(TextureCache& sCache,GpuUsage* sGpuUsage);
+			virtual ~DataItem(void); // Destroys the texture object and removes its memory from the cache's statistics
+			};
+		
+		/* Elements: */
+		TextureCache& cache; // The cache owning this entry
+		std::string key; // The entry's key in the cache
+		std::string url; // URL of the texture image
+		TextureParameters parameters; // Parameters to create texture objects
+		ImageLoader::JobPtr loadJob; // Background job reading the texture image
+		size_t imageSize; // Memory held by the decoded texture image
+		size_t textureSize; // Estimated memory held by the texture object in a single OpenGL context
+		GpuUsagePtr gpuUsage; // Texture memory tracker shared with the entry's per-context data items
+		bool cached; // Flag whether the entry can still be found in the cache; failed entries are removed and destroyed when their last user lets go
+		unsigned int numUsers; // Number of scene graph nodes referencing this entry
+		Entry* lruPred; // Pointer to the previous entry in the list of unused entries
+		Entry* lruSucc; // Pointer to the next entry in the list of unused entries
+		
+		/* Constructors and destructors: */
+		Entry(TextureCache& sCache,const std::string& sKey,IO::Directory& baseDirectory,const std::string& sUrl,const TextureParameters& sParameters);
+		virtual ~Entry(void);
+		
+		/* Methods from class GLObject: */
+		public:
+		virtual void initContext(GLContextData& contextData) const;
+		
+		/* New methods: */
+		const std::string& getUrl(void) const // Returns the URL of the entry's texture image
+			{
+			return url;
+			}
+		GLuint getTextureObjectId(GLContextData& contextData) const; // Returns the ID of the entry's texture object in the given OpenGL context
+		void updateTexture(GLContextData& contextData) const; // Uploads the texture image or a placeholder into the entry's texture object, which must be bound to GL_TEXTURE_2D, if it is not up to date
+		};
+	
+	/* Elements: */
+	private:
+	static Threads::Mutex theCacheMutex; // Mutex protecting creation of the shared texture cache
+	static Misc::SelfDestructPointer<TextureCache> theCache; // The shared texture cache
+	
+	typedef Misc::HashTable<std::string,Entry*> EntryMap; // Hash table mapping keys to cache entries
+	
+	ImageLoader* loader; // Image loader reading texture images for this cache; owned by the cache so that it outlives all entries
+	mutable Threads::Mutex cacheMutex; // Mutex serializing access to the cache's state
+	EntryMap entries; // Map of all cache entries
+	Entry* lruHead; // Pointer to the least recently used unused entry
+	Entry* lruTail; // Pointer to the most recently used unused entry
+	size_t cpuMemoryBudget; // Maximum amount of memory held by decoded texture images before unused entries are evicted
+	size_t gpuMemoryBudget; // Maximum estimated amount of texture memory before unused entries are evicted
+	Statistics statistics; // Cache usage statistics
+	
+	/* Private methods: */
+	void unlinkUnused(Entry* entry); // Removes the given entry from the list of unused entries
+	void destroyEntry(Entry* entry); // Removes the given entry's memory from the statistics and destroys it; must be called from the main thread with the cache mutex locked
+	void evictUnused(void); // Evicts least-recently used unused entries until the cache fits into its memory budgets; must be called from the main thread with the cache mutex locked
+	void imageLoaded(Entry* entry,size_t imageSize,size_t textureSize); // Called from a background job when the given entry's texture image has been read
+	void textureUploaded(Entry::GpuUsage* gpuUsage,size_t textureSize); // Called when a texture image of the given size has been uploaded into an OpenGL context
+	void textureReleased(Entry::GpuUsage* gpuUsage,size_t textureSize); // Called when a texture object holding a texture image of the given size has been destroyed
+	
+	/* Constructors and destructors: */
+	public:
+	TextureCache(size_t sCpuMemoryBudget,size_t sGpuMemoryBudget); // Creates an empty texture cache with its own image loader and the given memory budgets in bytes
+	private:
+	TextureCache(const TextureCache& source); // Prohibit copy constructor
+	TextureCache& operator=(const TextureCache& source); // Prohibit assignment operator
+	public:
+	~TextureCache(void); // Waits for all pending background jobs, destroys all entries, and shuts down the image loader
+	
+	/* Methods: */
+	static TextureCache& getCache(void); // Returns the texture cache shared by all scene graph nodes; creates it on the first call
+	static bool haveCache(void); // Returns true if the shared texture cache has been created
+	ImageLoader& getLoader(void) // Returns the cache's image loader
+		{
+		return *loader;
+		}
+	void setMemoryBudgets(size_t newCpuMemoryBudget,size_t newGpuMemoryBudget); // Sets the memory budgets in bytes and evicts unused entries if necessary
+	Entry* acquire(IO::Directory& baseDirectory,const std::string& url,const TextureParameters& parameters); // Returns an entry for the given image URL, the image file's modification time, and texture parameters, and starts reading the image in the background if the entry is new or previously failed to read its image
+	void release(Entry* entry); // Releases an entry that was returned by acquire
+	Statistics getStatistics(void) const; // Returns the current usage statistics
+	};
+
+}
+
+#endif
@@ -103,6 +103,31 @@ unsigned int UTMPointTransformNode::update(void)
 	return NoCascade;
 	}
 
+void UTMPointTransformNode::transformPointBlock(size_t numPoints,const Point points[],PointTransformNode::TPoint transformedPoints[]) const
+	{
+	typedef Geometry::UTMProjection<double>::PPoint PPoint;
+	
+	/* Conversion factor from radians to the requested angle unit: */
+	TScalar angleScale=degrees.getValue()?TScalar(180)/Math::Constants<TScalar>::pi:TScalar(1);
+	
+	/* Unproject the points in sub-blocks that fit into a local buffer: */
+	const size_t subBlockSize=256;
+	PPoint geodetics[subBlockSize];
+	for(size_t first=0;first<numPoints;first+=subBlockSize)
+		{
+		size_t numSubPoints=numPoints-first;
+		if(numSubPoints>subBlockSize)
+			numSubPoints=subBlockSize;
+		const Point* sps=points+first;
+		for(size_t i=0;i<numSubPoints;++i)
+			geodetics[i]=PPoint(TScalar(sps[i][0]),TScalar(sps[i][1]));
+		projection.mapToGeodetic(numSubPoints,geodetics,geodetics);
+		TPoint* tps=transformedPoints+first;
+		for(size_t i=0;i<numSubPoints;++i)
+			tps[i]=TPoint(geodetics[i][0]*angleScale,geodetics[i][1]*angleScale,TScalar(sps[i][2]));
+		}
+	}
+
 PointTransformNode::TPoint UTMPointTransformNode::transformPoint(const PointTransformNode::TPoint& point) const
 	{
 	/* Transform the point using the UTM projection object: */
@@ -132,22 +157,8 @@ PointTransformNode::TPoint UTMPointTransformNode::inverseTransformPoint(const Po
 
 PointTransformNode::TBox UTMPointTransformNode::calcBoundingBox(const std::vector<Point>& points) const
 	{
-	TBox result=TBox::empty;
-	
-	/* Transform each point individually: */
-	for(std::vector<Point>::const_iterator pIt=points.begin();pIt!=points.end();++pIt)
-		{
-		Geometry::UTMProjection<double>::PPoint geodetic=projection.mapToGeodetic(Geometry::UTMProjection<double>::PPoint(TScalar((*pIt)[0]),TScalar((*pIt)[1])));
-		if(degrees.getValue())
-			{
-			/* Convert geodetic coordinates from radians to degrees: */
-			geodetic[0]*=TScalar(180)/Math::Constants<TScalar>::pi;
-			geodetic[1]*=TScalar(180)/Math::Constants<TScalar>::pi;
-			}
-		result.addPoint(TPoint(geodetic[0],geodetic[1],TScalar((*pIt)[2])));
-		}
-	
-	return result;
+	/* Transform all points in batches: */
+	return calcBatchBoundingBox(points);
 	}
 
 PointTransformNode::TBox UTMPointTransformNode::calcBoundingBox(const std::vector<Point>& points,const std::vector<int>& pointIndices) const
@@ -0,0 +1,120 @@
+/***********************************************************************
+EventCount - Class to let threads block until a condition checked
+outside of any mutex becomes true, for lock-free data structures that
+only need to block when they are empty or full. Uses futexes on Linux
+and a mutex and condition variable elsewhere.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_EVENTCOUNT_INCLUDED
+#define THREADS_EVENTCOUNT_INCLUDED
+
+#ifdef __linux__
+#include <unistd.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#else
+#include <Threads/Mutex.h>
+#include <Threads/Cond.h>
+#endif
+
+namespace Threads {
+
+class EventCount
+	{
+	/* Elements: */
+	private:
+	volatile int epoch; // Counter incremented on every notification that found waiting threads
+	volatile int numWaiters; // Number of threads that are preparing to wait or waiting
+	#ifndef __linux__
+	Mutex waitMutex; // Mutex protecting the condition variable
+	Cond waitCond; // Condition variable to block waiting threads
+	#endif
+	
+	/* Private methods: */
+	void wake(bool all) // Advances the epoch and wakes up one or all waiting threads
+		{
+		#ifdef __linux__
+		__sync_add_and_fetch(&epoch,1);
+		syscall(SYS_futex,&epoch,FUTEX_WAKE_PRIVATE,all?INT_MAX:1,0,0,0);
+		#else
+		Mutex::Lock waitLock(waitMutex);
+		__sync_add_and_fetch(&epoch,1);
+		if(all)
+			waitCond.broadcast();
+		else
+			waitCond.signal();
+		#endif
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	EventCount(void)
+		:epoch(0),numWaiters(0)
+		{
+		}
+	private:
+	EventCount(const EventCount& source); // Prohibit copy constructor
+	EventCount& operator=(const EventCount& source); // Prohibit assignment operator
+	
+	/* Methods: */
+	public:
+	int prepareWait(void) // Announces that the calling thread is about to wait; caller must re-check its condition afterwards and then call cancelWait or commitWait with the returned key
+		{
+		__sync_add_and_fetch(&numWaiters,1);
+		return epoch;
+		}
+	void cancelWait(void) // Cancels waiting after the re-checked condition became true
+		{
+		__sync_sub_and_fetch(&numWaiters,1);
+		}
+	void commitWait(int key) // Blocks the calling thread until a notification after the corresponding call to prepareWait
+		{
+		#ifdef __linux__
+		while(epoch==key)
+			syscall(SYS_futex,&epoch,FUTEX_WAIT_PRIVATE,key,0,0,0);
+		#else
+		{
+		Mutex::Lock waitLock(waitMutex);
+		while(epoch==key)
+			waitCond.wait(waitMutex);
+		}
+		#endif
+		__sync_sub_and_fetch(&numWaiters,1);
+		}
+	void notifyOne(void) // Wakes up one waiting thread after the caller changed the condition; cheap if no threads are waiting
+		{
+		/* Order the caller's preceding condition change before checking for waiters: */
+		__sync_synchronize();
+		if(numWaiters!=0)
+			wake(false);
+		}
+	void notifyAll(void) // Wakes up all waiting threads after the caller changed the condition; cheap if no threads are waiting
+		{
+		/* Order the caller's preceding condition change before checking for waiters: */
+		__sync_synchronize();
+		if(numWaiters!=0)
+			wake(true);
+		}
+	};
+
+}
+
+#endif
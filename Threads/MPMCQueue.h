@@ -0,0 +1,209 @@
+/***********************************************************************
+MPMCQueue - Lock-free bounded queue to pass values between any number of
+producer and consumer threads, blocking only when the queue is empty or
+full. Drop-in replacement for LimitedQueue.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_MPMCQUEUE_INCLUDED
+#define THREADS_MPMCQUEUE_INCLUDED
+
+#include <stddef.h>
+#include <Threads/EventCount.h>
+
+namespace Threads {
+
+template <class ValueParam>
+class MPMCQueue
+	{
+	/* Embedded classes: */
+	public:
+	typedef ValueParam Value; // Type of communicated data
+	
+	private:
+	struct Slot // Structure for a queue slot
+		{
+		/* Elements: */
+		public:
+		volatile size_t sequence; // Position for which the slot is ready to be written (sequence==position) or read (sequence==position+1)
+		Value value; // The value stored in the slot
+		};
+	
+	/* Elements: */
+	size_t capacity; // Number of slots in the queue, a power of two
+	size_t mask; // Bit mask to map positions to slots
+	Slot* slots; // Array of queue slots
+	char padding0[64]; // Padding to separate the enqueue position from the shared constants
+	volatile size_t enqueuePos; // Position at which the next value will be pushed
+	char padding1[64]; // Padding to separate the dequeue position from the enqueue position
+	volatile size_t dequeuePos; // Position from which the next value will be popped
+	char padding2[64]; // Padding to separate the dequeue position from the event counts
+	EventCount notEmpty; // Event count on which consumers block while the queue is empty
+	EventCount notFull; // Event count on which producers block while the queue is full
+	
+	/* Private methods: */
+	bool tryPushNoNotify(const Value& value) // Pushes the given value into the queue without waking up consumers; returns false if the queue is full
+		{
+		/* Claim a slot by advancing the enqueue position: */
+		size_t pos=enqueuePos;
+		Slot* slot;
+		while(true)
+			{
+			slot=&slots[pos&mask];
+			ptrdiff_t diff=ptrdiff_t(slot->sequence)-ptrdiff_t(pos);
+			if(diff==0)
+				{
+				/* The slot is free; try claiming it: */
+				size_t oldPos=__sync_val_compare_and_swap(&enqueuePos,pos,pos+1);
+				if(oldPos==pos)
+					break;
+				pos=oldPos;
+				}
+			else if(diff<0)
+				{
+				/* The slot still holds a value from the previous round; the queue is full: */
+				return false;
+				}
+			else
+				{
+				/* Another producer claimed the slot; try again: */
+				pos=enqueuePos;
+				}
+			}
+		
+		/* Write the value and publish it to consumers: */
+		slot->value=value;
+		__sync_synchronize();
+		slot->sequence=pos+1;
+		return true;
+		}
+	bool tryPopNoNotify(Value& value) // Removes the first value from the queue without waking up producers; returns false if the queue is empty
+		{
+		/* Claim a slot by advancing the dequeue position: */
+		size_t pos=dequeuePos;
+		Slot* slot;
+		while(true)
+			{
+			slot=&slots[pos&mask];
+			ptrdiff_t diff=ptrdiff_t(slot->sequence)-ptrdiff_t(pos+1);
+			if(diff==0)
+				{
+				/* The slot holds a value; try claiming it: */
+				size_t oldPos=__sync_val_compare_and_swap(&dequeuePos,pos,pos+1);
+				if(oldPos==pos)
+					break;
+				pos=oldPos;
+				}
+			else if(diff<0)
+				{
+				/* The slot has not been written yet; the queue is empty: */
+				return false;
+				}
+			else
+				{
+				/* Another consumer claimed the slot; try again: */
+				pos=dequeuePos;
+				}
+			}
+		
+		/* Read the value and release the slot for the next round: */
+		value=slot->value;
+		__sync_synchronize();
+		slot->sequence=pos+capacity;
+		return true;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	MPMCQueue(size_t maxQueueLength) // Creates a queue that can hold at least the given number of elements
+		:capacity(2),enqueuePos(0),dequeuePos(0)
+		{
+		/* Round the capacity up to the next power of two: */
+		while(capacity<maxQueueLength)
+			capacity<<=1;
+		mask=capacity-1;
+		slots=new Slot[capacity];
+		for(size_t i=0;i<capacity;++i)
+			slots[i].sequence=i;
+		}
+	private:
+	MPMCQueue(const MPMCQueue& source); // Prohibit copy constructor
+	MPMCQueue& operator=(const MPMCQueue& source); // Prohibit assignment operator
+	public:
+	~MPMCQueue(void) // Destroys the queue and its contents
+		{
+		delete[] slots;
+		}
+	
+	/* Methods: */
+	size_t getCapacity(void) const // Returns the maximum number of values the queue can hold
+		{
+		return capacity;
+		}
+	bool tryPush(const Value& value) // Pushes the given value into the queue; returns false without blocking if the queue is full
+		{
+		if(!tryPushNoNotify(value))
+			return false;
+		notEmpty.notifyOne();
+		return true;
+		}
+	void push(const Value& value) // Pushes the given value into the queue; blocks if queue is full
+		{
+		while(!tryPushNoNotify(value))
+			{
+			/* Block until a consumer frees a slot: */
+			int key=notFull.prepareWait();
+			if(tryPushNoNotify(value))
+				{
+				notFull.cancelWait();
+				break;
+				}
+			notFull.commitWait(key);
+			}
+		notEmpty.notifyOne();
+		}
+	bool tryPop(Value& value) // Removes the first value from the queue into the given variable; returns false without blocking if the queue is empty
+		{
+		if(!tryPopNoNotify(value))
+			return false;
+		notFull.notifyOne();
+		return true;
+		}
+	Value pop(void) // Returns and removes the first value from the queue; blocks if queue is empty
+		{
+		Value result;
+		while(!tryPopNoNotify(result))
+			{
+			/* Block until a producer pushes a value: */
+			int key=notEmpty.prepareWait();
+			if(tryPopNoNotify(result))
+				{
+				notEmpty.cancelWait();
+				break;
+				}
+			notEmpty.commitWait(key);
+			}
+		notFull.notifyOne();
+		return result;
+		}
+	};
+
+}
+
+#endif
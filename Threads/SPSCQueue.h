@@ -0,0 +1,227 @@
+/***********************************************************************
+SPSCQueue - Lock-free bounded queue to pass values from exactly one
+producer thread to exactly one consumer thread, blocking only when the
+queue is empty or full. Drop-in replacement for LimitedQueue and for
+the value-copying methods of RingBuffer under that restriction.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_SPSCQUEUE_INCLUDED
+#define THREADS_SPSCQUEUE_INCLUDED
+
+#include <stddef.h>
+#include <Threads/EventCount.h>
+
+namespace Threads {
+
+template <class ValueParam>
+class SPSCQueue
+	{
+	/* Embedded classes: */
+	public:
+	typedef ValueParam Value; // Type of communicated data
+	
+	/* Elements: */
+	private:
+	size_t capacity; // Number of slots in the queue, a power of two
+	size_t mask; // Bit mask to map positions to slots
+	Value* slots; // Array of queue slots
+	char padding0[64]; // Padding to separate the consumer's state from the shared constants
+	volatile size_t head; // Position of the first value in the queue; only written by the consumer
+	size_t cachedTail; // Consumer's last observed tail position
+	char padding1[64]; // Padding to separate the producer's state from the consumer's state
+	volatile size_t tail; // Position after the last value in the queue; only written by the producer
+	size_t cachedHead; // Producer's last observed head position
+	char padding2[64]; // Padding to separate the producer's state from the event counts
+	EventCount notEmpty; // Event count on which the consumer blocks while the queue is empty
+	EventCount notFull; // Event count on which the producer blocks while the queue is full
+	
+	/* Private methods: */
+	size_t getWritable(void) // Returns the number of slots the producer can write without blocking
+		{
+		size_t result=capacity-(tail-cachedHead);
+		if(result==0)
+			{
+			/* Re-read the consumer's position: */
+			cachedHead=head;
+			__sync_synchronize();
+			result=capacity-(tail-cachedHead);
+			}
+		return result;
+		}
+	size_t getReadable(void) // Returns the number of values the consumer can read without blocking
+		{
+		size_t result=cachedTail-head;
+		if(result==0)
+			{
+			/* Re-read the producer's position: */
+			cachedTail=tail;
+			__sync_synchronize();
+			result=cachedTail-head;
+			}
+		return result;
+		}
+	void commitWrite(size_t numValues) // Publishes the given number of written values to the consumer
+		{
+		__sync_synchronize();
+		tail=tail+numValues;
+		notEmpty.notifyOne();
+		}
+	void commitRead(size_t numValues) // Releases the given number of read slots to the producer
+		{
+		__sync_synchronize();
+		head=head+numValues;
+		notFull.notifyOne();
+		}
+	size_t waitWritable(void) // Blocks until the producer can write at least one value; returns number of writable slots
+		{
+		size_t result;
+		while((result=getWritable())==0)
+			{
+			int key=notFull.prepareWait();
+			if((result=getWritable())!=0)
+				{
+				notFull.cancelWait();
+				break;
+				}
+			notFull.commitWait(key);
+			}
+		return result;
+		}
+	size_t waitReadable(void) // Blocks until the consumer can read at least one value; returns number of readable values
+		{
+		size_t result;
+		while((result=getReadable())==0)
+			{
+			int key=notEmpty.prepareWait();
+			if((result=getReadable())!=0)
+				{
+				notEmpty.cancelWait();
+				break;
+				}
+			notEmpty.commitWait(key);
+			}
+		return result;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	SPSCQueue(size_t maxQueueLength) // Creates a queue that can hold at least the given number of elements
+		:capacity(1),head(0),cachedTail(0),tail(0),cachedHead(0)
+		{
+		/* Round the capacity up to the next power of two: */
+		while(capacity<maxQueueLength)
+			capacity<<=1;
+		mask=capacity-1;
+		slots=new Value[capacity];
+		}
+	private:
+	SPSCQueue(const SPSCQueue& source); // Prohibit copy constructor
+	SPSCQueue& operator=(const SPSCQueue& source); // Prohibit assignment operator
+	public:
+	~SPSCQueue(void) // Destroys the queue and its contents
+		{
+		delete[] slots;
+		}
+	
+	/* Methods: */
+	size_t getCapacity(void) const // Returns the maximum number of values the queue can hold
+		{
+		return capacity;
+		}
+	bool empty(void) const // Returns true if the queue is empty; only reliable when called by the consumer
+		{
+		return tail==head;
+		}
+	bool full(void) const // Returns true if the queue is full; only reliable when called by the producer
+		{
+		return tail-head==capacity;
+		}
+	
+	/* Producer methods: */
+	bool tryPush(const Value& value) // Pushes the given value into the queue; returns false without blocking if the queue is full
+		{
+		if(getWritable()==0)
+			return false;
+		slots[tail&mask]=value;
+		commitWrite(1);
+		return true;
+		}
+	void push(const Value& value) // Pushes the given value into the queue; blocks if queue is full
+		{
+		waitWritable();
+		slots[tail&mask]=value;
+		commitWrite(1);
+		}
+	void blockingWrite(const Value* values,size_t numValues) // Writes the given array into the queue; blocks until everything is written
+		{
+		while(numValues>0)
+			{
+			/* Write as many values as currently fit: */
+			size_t chunkSize=waitWritable();
+			if(chunkSize>numValues)
+				chunkSize=numValues;
+			for(size_t i=0;i<chunkSize;++i)
+				slots[(tail+i)&mask]=values[i];
+			commitWrite(chunkSize);
+			values+=chunkSize;
+			numValues-=chunkSize;
+			}
+		}
+	
+	/* Consumer methods: */
+	bool tryPop(Value& value) // Removes the first value from the queue into the given variable; returns false without blocking if the queue is empty
+		{
+		if(getReadable()==0)
+			return false;
+		value=slots[head&mask];
+		commitRead(1);
+		return true;
+		}
+	Value pop(void) // Returns and removes the first value from the queue; blocks if queue is empty
+		{
+		waitReadable();
+		Value result=slots[head&mask];
+		commitRead(1);
+		return result;
+		}
+	size_t read(Value* values,size_t numValues) // Reads between one and numValues from the queue; returns number read; blocks if no data is available
+		{
+		size_t chunkSize=waitReadable();
+		if(chunkSize>numValues)
+			chunkSize=numValues;
+		for(size_t i=0;i<chunkSize;++i)
+			values[i]=slots[(head+i)&mask];
+		commitRead(chunkSize);
+		return chunkSize;
+		}
+	void blockingRead(Value* values,size_t numValues) // Reads the given array from the queue; blocks until everything is read
+		{
+		while(numValues>0)
+			{
+			size_t chunkSize=read(values,numValues);
+			values+=chunkSize;
+			numValues-=chunkSize;
+			}
+		}
+	};
+
+}
+
+#endif
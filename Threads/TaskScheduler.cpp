@@ -0,0 +1,281 @@
+/***********************************************************************
+TaskScheduler - Class to execute short-lived tasks on a fixed pool of
+worker threads, using per-thread task deques and work stealing, with
+helpers for parallel loops, parallel reductions, and futures.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Threads/TaskScheduler.h>
+
+#include <unistd.h>
+#include <pthread.h>
+#include <Threads/Config.h>
+#include <Threads/Thread.h>
+
+namespace Threads {
+
+namespace {
+
+/****************************************************************
+Helper functions to identify the scheduler and deque of a thread:
+****************************************************************/
+
+struct WorkerIdentity // Structure identifying the scheduler and deque index of a worker thread
+	{
+	/* Elements: */
+	public:
+	const TaskScheduler* scheduler; // Scheduler owning the worker thread
+	unsigned int queueIndex; // Index of the worker thread's deque
+	};
+
+#if THREADS_CONFIG_HAVE_BUILTIN_TLS
+
+__thread WorkerIdentity workerIdentity={0,0};
+
+inline const WorkerIdentity* getWorkerIdentity(void)
+	{
+	return &workerIdentity;
+	}
+
+inline void setWorkerIdentity(const WorkerIdentity& newWorkerIdentity)
+	{
+	workerIdentity=newWorkerIdentity;
+	}
+
+#else
+
+pthread_once_t workerIdentityKeyOnce=PTHREAD_ONCE_INIT;
+pthread_key_t workerIdentityKey;
+
+void createWorkerIdentityKey(void)
+	{
+	pthread_key_create(&workerIdentityKey,0);
+	}
+
+inline const WorkerIdentity* getWorkerIdentity(void)
+	{
+	pthread_once(&workerIdentityKeyOnce,createWorkerIdentityKey);
+	static const WorkerIdentity noWorker={0,0};
+	const WorkerIdentity* result=static_cast<const WorkerIdentity*>(pthread_getspecific(workerIdentityKey));
+	return result!=0?result:&noWorker;
+	}
+
+inline void setWorkerIdentity(const WorkerIdentity& newWorkerIdentity)
+	{
+	pthread_once(&workerIdentityKeyOnce,createWorkerIdentityKey);
+	pthread_setspecific(workerIdentityKey,new WorkerIdentity(newWorkerIdentity));
+	}
+
+#endif
+
+}
+
+/******************************
+Methods of class TaskScheduler:
+******************************/
+
+void* TaskScheduler::workerThreadMethod(unsigned int workerIndex)
+	{
+	/* Associate this thread with its deque: */
+	WorkerIdentity wi;
+	wi.scheduler=this;
+	wi.queueIndex=workerIndex;
+	setWorkerIdentity(wi);
+	
+	while(true)
+		{
+		/* Execute tasks from this thread's deque or steal from other deques: */
+		Task* task=findTask(workerIndex);
+		if(task!=0)
+			{
+			runTask(task);
+			continue;
+			}
+		
+		/* Block until new tasks are submitted or the scheduler shuts down: */
+		Mutex::Lock sleepLock(sleepMutex);
+		numSleepers.preAdd(1);
+		while(!shutdown&&numQueuedTasks.get()==0)
+			wakeCond.wait(sleepMutex);
+		numSleepers.preSub(1);
+		
+		/* Bail out if the scheduler is shutting down and all tasks have been executed: */
+		if(shutdown&&numQueuedTasks.get()==0)
+			break;
+		}
+	
+	return 0;
+	}
+
+unsigned int TaskScheduler::getQueueIndex(void) const
+	{
+	/* Return the calling worker thread's deque, or the shared deque for external threads: */
+	const WorkerIdentity* wi=getWorkerIdentity();
+	return wi->scheduler==this?wi->queueIndex:numWorkers;
+	}
+
+TaskScheduler::Task* TaskScheduler::findTask(unsigned int queueIndex)
+	{
+	Task* result=0;
+	
+	/* Bail out early if there are no queued tasks at all: */
+	if(numQueuedTasks.get()==0)
+		return result;
+	
+	/* Pop the most recently pushed task from the given deque: */
+	{
+	TaskQueue& q=queues[queueIndex];
+	Spinlock::Lock queueLock(q.lock);
+	if(!q.tasks.empty())
+		{
+		result=q.tasks.back();
+		q.tasks.pop_back();
+		}
+	}
+	
+	/* Steal the least recently pushed task from the other deques, starting with the next one: */
+	for(unsigned int i=1;result==0&&i<=numWorkers;++i)
+		{
+		unsigned int victimIndex=queueIndex+i;
+		if(victimIndex>numWorkers)
+			victimIndex-=numWorkers+1;
+		TaskQueue& q=queues[victimIndex];
+		Spinlock::Lock queueLock(q.lock);
+		if(!q.tasks.empty())
+			{
+			result=q.tasks.front();
+			q.tasks.pop_front();
+			}
+		}
+	
+	if(result!=0)
+		numQueuedTasks.preSub(1);
+	
+	return result;
+	}
+
+void TaskScheduler::runTask(TaskScheduler::Task* task)
+	{
+	/* Execute the task: */
+	task->execute(*this);
+	
+	/* Signal completion of the task's group: */
+	if(task->counter!=0&&task->counter->numPending.preSub(1)==0&&numSleepers.get()>0)
+		{
+		/* Wake up all threads waiting on task groups: */
+		Mutex::Lock sleepLock(sleepMutex);
+		wakeCond.broadcast();
+		}
+	
+	/* Release the scheduler's reference to the task: */
+	task->unref();
+	}
+
+TaskScheduler::TaskScheduler(unsigned int sNumWorkers)
+	:numWorkers(sNumWorkers),
+	 queues(0),
+	 numQueuedTasks(0),numSleepers(0),
+	 shutdown(false),
+	 workers(0)
+	{
+	if(numWorkers==0)
+		{
+		/* Create one less worker than CPUs, as waiting threads execute tasks as well: */
+		long numCpus=sysconf(_SC_NPROCESSORS_ONLN);
+		numWorkers=numCpus>1?(unsigned int)(numCpus-1):1U;
+		}
+	
+	/* Create the task deques, including the deque shared by external threads: */
+	queues=new TaskQueue[numWorkers+1];
+	
+	/* Start the worker threads: */
+	workers=new Thread[numWorkers];
+	for(unsigned int i=0;i<numWorkers;++i)
+		workers[i].start(this,&TaskScheduler::workerThreadMethod,i);
+	}
+
+TaskScheduler::~TaskScheduler(void)
+	{
+	/* Signal the worker threads to shut down once all tasks have been executed: */
+	{
+	Mutex::Lock sleepLock(sleepMutex);
+	shutdown=true;
+	wakeCond.broadcast();
+	}
+	
+	/* Wait for all worker threads to terminate: */
+	for(unsigned int i=0;i<numWorkers;++i)
+		workers[i].join();
+	delete[] workers;
+	delete[] queues;
+	}
+
+TaskScheduler& TaskScheduler::getDefaultScheduler(void)
+	{
+	static TaskScheduler defaultScheduler;
+	return defaultScheduler;
+	}
+
+void TaskScheduler::submit(TaskScheduler::Task* task,TaskScheduler::TaskCounter* counter)
+	{
+	/* Reference the task until it is executed and count it in its group: */
+	task->ref();
+	task->counter=counter;
+	if(counter!=0)
+		counter->numPending.preAdd(1);
+	
+	/* Push the task onto the calling thread's deque: */
+	{
+	TaskQueue& q=queues[getQueueIndex()];
+	Spinlock::Lock queueLock(q.lock);
+	q.tasks.push_back(task);
+	}
+	numQueuedTasks.preAdd(1);
+	
+	/* Wake up a blocked thread to execute or steal the task: */
+	if(numSleepers.get()>0)
+		{
+		Mutex::Lock sleepLock(sleepMutex);
+		wakeCond.signal();
+		}
+	}
+
+void TaskScheduler::wait(TaskScheduler::TaskCounter& counter)
+	{
+	unsigned int queueIndex=getQueueIndex();
+	while(!counter.isDone())
+		{
+		/* Help executing tasks while the group has not finished: */
+		Task* task=findTask(queueIndex);
+		if(task!=0)
+			{
+			runTask(task);
+			continue;
+			}
+		
+		/* Block until new tasks are submitted or a task group finishes: */
+		Mutex::Lock sleepLock(sleepMutex);
+		numSleepers.preAdd(1);
+		while(!counter.isDone()&&numQueuedTasks.get()==0)
+			wakeCond.wait(sleepMutex);
+		numSleepers.preSub(1);
+		}
+	}
+
+}
@@ -0,0 +1,401 @@
+/***********************************************************************
+TaskScheduler - Class to execute short-lived tasks on a fixed pool of
+worker threads, using per-thread task deques and work stealing, with
+helpers for parallel loops, parallel reductions, and futures.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_TASKSCHEDULER_INCLUDED
+#define THREADS_TASKSCHEDULER_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <deque>
+#include <vector>
+#include <stdexcept>
+#include <Misc/Autopointer.h>
+#include <Threads/Atomic.h>
+#include <Threads/Spinlock.h>
+#include <Threads/Mutex.h>
+#include <Threads/Cond.h>
+#include <Threads/RefCounted.h>
+
+/* Forward declarations: */
+namespace Threads {
+class Thread;
+}
+
+namespace Threads {
+
+class TaskScheduler
+	{
+	/* Embedded classes: */
+	public:
+	class TaskCounter // Class to count the pending tasks of a group of tasks, to wait for their completion
+		{
+		friend class TaskScheduler;
+		
+		/* Elements: */
+		private:
+		Atomic<unsigned int> numPending; // Number of submitted tasks that have not finished yet
+		
+		/* Constructors and destructors: */
+		public:
+		TaskCounter(void)
+			:numPending(0)
+			{
+			}
+		private:
+		TaskCounter(const TaskCounter& source); // Prohibit copy constructor
+		TaskCounter& operator=(const TaskCounter& source); // Prohibit assignment operator
+		
+		/* Methods: */
+		public:
+		bool isDone(void) const // Returns true if all tasks counted by this counter have finished
+			{
+			return numPending.get()==0;
+			}
+		};
+	
+	class Task:public RefCounted // Base class for tasks; submitted tasks are deleted after they are executed unless referenced elsewhere
+		{
+		friend class TaskScheduler;
+		
+		/* Elements: */
+		private:
+		TaskCounter* counter; // Counter to decrement when the task finishes, or null
+		
+		/* Constructors and destructors: */
+		public:
+		Task(void)
+			:counter(0)
+			{
+			}
+		
+		/* Methods: */
+		protected:
+		TaskCounter* getCounter(void) const // Returns the counter with which the task was submitted, for spawning child tasks into the same group
+			{
+			return counter;
+			}
+		public:
+		virtual void execute(TaskScheduler& scheduler) =0; // Executes the task; can submit further tasks to the given scheduler; must not throw exceptions
+		};
+	
+	template <class ResultParam>
+	class FutureTask:public Task // Base class for tasks computing a result that is retrieved through a future
+		{
+		friend class TaskScheduler;
+		
+		/* Elements: */
+		private:
+		TaskCounter counter; // Counter to wait for completion of the task
+		ResultParam result; // The task's result
+		bool failed; // Flag if the task's computation threw an exception
+		std::string errorMessage; // The message of the exception thrown by the task's computation
+		
+		/* Protected methods: */
+		protected:
+		virtual ResultParam compute(void) =0; // Computes the task's result; can throw exceptions
+		
+		/* Constructors and destructors: */
+		public:
+		FutureTask(void)
+			:result(),failed(false)
+			{
+			}
+		
+		/* Methods from Task: */
+		virtual void execute(TaskScheduler& scheduler)
+			{
+			try
+				{
+				result=compute();
+				}
+			catch(const std::exception& err)
+				{
+				/* Remember the error to re-throw it from the future: */
+				failed=true;
+				errorMessage=err.what();
+				}
+			catch(...)
+				{
+				/* Remember that the computation failed to re-throw an error from the future: */
+				failed=true;
+				errorMessage="Threads::TaskScheduler::FutureTask: Computation threw spurious exception";
+				}
+			}
+		
+		/* New methods: */
+		bool isFinished(void) const // Returns true if the task has finished
+			{
+			return counter.isDone();
+			}
+		const ResultParam& getResult(TaskScheduler& scheduler) // Waits for the task to finish and returns its result; executes other tasks while waiting; re-throws any exception from the computation as std::runtime_error
+			{
+			scheduler.wait(counter);
+			if(failed)
+				throw std::runtime_error(errorMessage);
+			return result;
+			}
+		};
+	
+	template <class ResultParam>
+	class Future // Class to retrieve the result of an asynchronously executed computation
+		{
+		/* Elements: */
+		private:
+		TaskScheduler* scheduler; // The scheduler executing the computation
+		Misc::Autopointer<FutureTask<ResultParam> > task; // The task computing the result
+		
+		/* Constructors and destructors: */
+		public:
+		Future(void) // Creates an invalid future
+			:scheduler(0)
+			{
+			}
+		Future(TaskScheduler& sScheduler,FutureTask<ResultParam>* sTask) // Creates a future for the given task, which must already be submitted to the given scheduler
+			:scheduler(&sScheduler),task(sTask)
+			{
+			}
+		
+		/* Methods: */
+		bool isValid(void) const // Returns true if the future refers to a computation
+			{
+			return task.getPointer()!=0;
+			}
+		bool isReady(void) const // Returns true if the computation has finished
+			{
+			return task->isFinished();
+			}
+		const ResultParam& get(void) const // Waits for the computation to finish and returns its result; executes other tasks while waiting; re-throws any exception from the computation as std::runtime_error
+			{
+			return task->getResult(*scheduler);
+			}
+		};
+	
+	private:
+	template <class ResultParam,class ArgumentParam>
+	class FunctionFutureTask:public FutureTask<ResultParam> // Class for future tasks calling a function with one argument
+		{
+		/* Elements: */
+		private:
+		ResultParam (*function)(ArgumentParam); // The called function
+		ArgumentParam argument; // The function's argument
+		
+		/* Protected methods from FutureTask: */
+		protected:
+		virtual ResultParam compute(void)
+			{
+			return function(argument);
+			}
+		
+		/* Constructors and destructors: */
+		public:
+		FunctionFutureTask(ResultParam (*sFunction)(ArgumentParam),ArgumentParam sArgument)
+			:function(sFunction),argument(sArgument)
+			{
+			}
+		};
+	
+	template <class ResultParam,class ObjectParam>
+	class MethodFutureTask:public FutureTask<ResultParam> // Class for future tasks calling a method without arguments on an object
+		{
+		/* Elements: */
+		private:
+		ObjectParam* object; // The object on which the method is called
+		ResultParam (ObjectParam::*method)(void); // The called method
+		
+		/* Protected methods from FutureTask: */
+		protected:
+		virtual ResultParam compute(void)
+			{
+			return (object->*method)();
+			}
+		
+		/* Constructors and destructors: */
+		public:
+		MethodFutureTask(ObjectParam* sObject,ResultParam (ObjectParam::*sMethod)(void))
+			:object(sObject),method(sMethod)
+			{
+			}
+		};
+	
+	template <class IndexParam,class FunctorParam>
+	class RangeTask:public Task // Class for tasks processing an index range of a parallel loop by recursive splitting
+		{
+		/* Elements: */
+		private:
+		IndexParam begin,end; // The index range processed by this task
+		IndexParam grainSize; // Maximum size of an index range that is not split further
+		FunctorParam& functor; // Functor called for unsplittable index ranges
+		
+		/* Constructors and destructors: */
+		public:
+		RangeTask(IndexParam sBegin,IndexParam sEnd,IndexParam sGrainSize,FunctorParam& sFunctor)
+			:begin(sBegin),end(sEnd),grainSize(sGrainSize),functor(sFunctor)
+			{
+			}
+		
+		/* Methods from Task: */
+		virtual void execute(TaskScheduler& scheduler)
+			{
+			/* Split off the upper halves of the range for other threads to steal while the range is too large: */
+			while(end-begin>grainSize)
+				{
+				IndexParam mid=begin+(end-begin)/2;
+				scheduler.submit(new RangeTask(mid,end,grainSize,functor),getCounter());
+				end=mid;
+				}
+			
+			/* Process the remaining range: */
+			functor(begin,end);
+			}
+		};
+	
+	template <class IndexParam,class ValueParam,class RangeFunctorParam>
+	class ReduceChunkFunctor // Functor class to reduce chunks of a parallel reduction into an array of partial results
+		{
+		/* Elements: */
+		private:
+		IndexParam begin,end; // The index range of the entire reduction
+		IndexParam chunkSize; // Size of each chunk
+		RangeFunctorParam& rangeFunctor; // Functor reducing an index range to a partial result
+		ValueParam* partials; // Array of partial results for all chunks
+		
+		/* Constructors and destructors: */
+		public:
+		ReduceChunkFunctor(IndexParam sBegin,IndexParam sEnd,IndexParam sChunkSize,RangeFunctorParam& sRangeFunctor,ValueParam* sPartials)
+			:begin(sBegin),end(sEnd),chunkSize(sChunkSize),rangeFunctor(sRangeFunctor),partials(sPartials)
+			{
+			}
+		
+		/* Methods: */
+		void operator()(size_t chunkBegin,size_t chunkEnd)
+			{
+			for(size_t chunk=chunkBegin;chunk<chunkEnd;++chunk)
+				{
+				IndexParam rangeBegin=begin+IndexParam(chunk)*chunkSize;
+				IndexParam rangeEnd=end-rangeBegin>chunkSize?rangeBegin+chunkSize:end;
+				partials[chunk]=rangeFunctor(rangeBegin,rangeEnd);
+				}
+			}
+		};
+	
+	struct TaskQueue // Structure for a task deque owned by a worker thread or shared by external threads
+		{
+		/* Elements: */
+		public:
+		Spinlock lock; // Lock serializing access to the deque
+		std::deque<Task*> tasks; // Queued tasks; owner pushes and pops at the back, thieves steal from the front
+		char padding[64]; // Padding to keep adjacent deques' locks in separate cache lines
+		};
+	
+	/* Elements: */
+	unsigned int numWorkers; // Number of worker threads
+	TaskQueue* queues; // Array of task deques for all worker threads, followed by the deque shared by external threads
+	Atomic<unsigned int> numQueuedTasks; // Total number of tasks in all deques
+	Atomic<unsigned int> numSleepers; // Number of worker or waiting threads currently blocked on the wake-up condition variable
+	Mutex sleepMutex; // Mutex protecting the wake-up condition variable
+	Cond wakeCond; // Condition variable to wake up blocked threads when new tasks are submitted or task groups finish
+	volatile bool shutdown; // Flag to shut down the worker threads
+	Thread* workers; // Array of worker threads
+	
+	/* Private methods: */
+	void* workerThreadMethod(unsigned int workerIndex); // Method running a worker thread
+	unsigned int getQueueIndex(void) const; // Returns the index of the deque belonging to the calling thread
+	Task* findTask(unsigned int queueIndex); // Pops a task from the given deque or steals a task from another deque; returns null if all deques are empty
+	void runTask(Task* task); // Executes the given task and signals its completion
+	
+	/* Constructors and destructors: */
+	public:
+	TaskScheduler(unsigned int sNumWorkers =0); // Creates a scheduler with the given number of worker threads; creates one less than the number of CPUs if zero, as threads waiting on tasks help executing them
+	private:
+	TaskScheduler(const TaskScheduler& source); // Prohibit copy constructor
+	TaskScheduler& operator=(const TaskScheduler& source); // Prohibit assignment operator
+	public:
+	~TaskScheduler(void); // Executes all pending tasks and shuts down the worker threads
+	
+	/* Methods: */
+	static TaskScheduler& getDefaultScheduler(void); // Returns a process-wide scheduler with the default number of worker threads
+	unsigned int getNumWorkers(void) const // Returns the number of worker threads
+		{
+		return numWorkers;
+		}
+	void submit(Task* task,TaskCounter* counter =0); // Submits the given task for execution; increments the given counter until the task finishes; task is deleted after execution unless referenced elsewhere
+	void wait(TaskCounter& counter); // Waits until all tasks counted by the given counter have finished; executes other tasks while waiting
+	template <class IndexParam,class FunctorParam>
+	void parallelFor(IndexParam begin,IndexParam end,IndexParam grainSize,FunctorParam& functor) // Calls functor(rangeBegin,rangeEnd) concurrently for disjoint sub-ranges of at most the given size covering [begin, end)
+		{
+		if(begin>=end)
+			return;
+		if(grainSize<IndexParam(1))
+			grainSize=IndexParam(1);
+		
+		/* Execute the root range task in the calling thread, and wait for all split-off tasks: */
+		TaskCounter counter;
+		RangeTask<IndexParam,FunctorParam>* root=new RangeTask<IndexParam,FunctorParam>(begin,end,grainSize,functor);
+		root->ref();
+		root->counter=&counter;
+		root->execute(*this);
+		root->unref();
+		wait(counter);
+		}
+	template <class IndexParam,class ValueParam,class RangeFunctorParam,class JoinFunctorParam>
+	ValueParam parallelReduce(IndexParam begin,IndexParam end,IndexParam grainSize,const ValueParam& identity,RangeFunctorParam& rangeFunctor,JoinFunctorParam& joinFunctor) // Reduces [begin, end) by calling rangeFunctor(rangeBegin,rangeEnd) concurrently on chunks of the given size, and joining the partial results in order using joinFunctor(value1,value2); result does not depend on the number of threads
+		{
+		if(begin>=end)
+			return identity;
+		if(grainSize<IndexParam(1))
+			grainSize=IndexParam(1);
+		
+		/* Reduce all chunks into an array of partial results: */
+		size_t numChunks=size_t((end-begin+grainSize-IndexParam(1))/grainSize);
+		std::vector<ValueParam> partials(numChunks,identity);
+		ReduceChunkFunctor<IndexParam,ValueParam,RangeFunctorParam> chunkFunctor(begin,end,grainSize,rangeFunctor,&partials[0]);
+		parallelFor(size_t(0),numChunks,size_t(1),chunkFunctor);
+		
+		/* Join the partial results in chunk order: */
+		ValueParam result=identity;
+		for(typename std::vector<ValueParam>::iterator pIt=partials.begin();pIt!=partials.end();++pIt)
+			result=joinFunctor(result,*pIt);
+		return result;
+		}
+	template <class ResultParam>
+	Future<ResultParam> async(FutureTask<ResultParam>* task) // Submits the given future task and returns a future for its result
+		{
+		Future<ResultParam> result(*this,task);
+		submit(task,&task->counter);
+		return result;
+		}
+	template <class ResultParam,class ArgumentParam>
+	Future<ResultParam> async(ResultParam (*function)(ArgumentParam),ArgumentParam argument) // Calls the given function with the given argument asynchronously and returns a future for its result
+		{
+		return async<ResultParam>(new FunctionFutureTask<ResultParam,ArgumentParam>(function,argument));
+		}
+	template <class ResultParam,class ObjectParam>
+	Future<ResultParam> async(ObjectParam* object,ResultParam (ObjectParam::*method)(void)) // Calls the given method on the given object asynchronously and returns a future for its result
+		{
+		return async<ResultParam>(new MethodFutureTask<ResultParam,ObjectParam>(object,method));
+		}
+	};
+
+}
+
+#endif
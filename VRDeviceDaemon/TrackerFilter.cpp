@@ -0,0 +1,491 @@
+/***********************************************************************
+TrackerFilter - Class to smooth and predict the states of all trackers
+managed by a device manager, and to gather per-tracker update latency
+and jitter statistics.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <VRDeviceDaemon/TrackerFilter.h>
+
+#include <stdio.h>
+#include <Misc/SizedTypes.h>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/ConfigurationFile.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline double timeDiff(TrackerFilter::TimeStamp ts1,TrackerFilter::TimeStamp ts0) // Returns the difference between two periodic time stamps in seconds
+	{
+	return double(Misc::SInt32(Misc::UInt32(ts1)-Misc::UInt32(ts0)))*1.0e-6;
+	}
+
+inline double oneEuroAlpha(double cutoff,double dt) // Returns the smoothing factor of a first-order low-pass filter
+	{
+	double tau=1.0/(2.0*Math::Constants<double>::pi*cutoff);
+	return 1.0/(1.0+tau/dt);
+	}
+
+void predictCovariance(int n,double dt,double q,double p[3][3]) // Advances a Kalman estimate covariance of order n by the given time step
+	{
+	/* Calculate F*P*F^T for the constant velocity or constant acceleration transition matrix: */
+	double f[3][3]={{1.0,dt,0.5*dt*dt},{0.0,1.0,dt},{0.0,0.0,1.0}};
+	double fp[3][3];
+	for(int i=0;i<n;++i)
+		for(int j=0;j<n;++j)
+			{
+			fp[i][j]=0.0;
+			for(int k=i;k<n;++k)
+				fp[i][j]+=f[i][k]*p[k][j];
+			}
+	for(int i=0;i<n;++i)
+		for(int j=0;j<n;++j)
+			{
+			p[i][j]=0.0;
+			for(int k=j;k<n;++k)
+				p[i][j]+=fp[i][k]*f[j][k];
+			}
+	
+	/* Add the process noise of white noise acting on the highest modeled derivative: */
+	double dt2=dt*dt;
+	double dt3=dt2*dt;
+	if(n==2)
+		{
+		p[0][0]+=q*dt3/3.0;
+		p[0][1]+=q*dt2/2.0;
+		p[1][0]+=q*dt2/2.0;
+		p[1][1]+=q*dt;
+		}
+	else
+		{
+		double dt4=dt3*dt;
+		double dt5=dt4*dt;
+		p[0][0]+=q*dt5/20.0;
+		p[0][1]+=q*dt4/8.0;
+		p[0][2]+=q*dt3/6.0;
+		p[1][0]+=q*dt4/8.0;
+		p[1][1]+=q*dt3/3.0;
+		p[1][2]+=q*dt2/2.0;
+		p[2][0]+=q*dt3/6.0;
+		p[2][1]+=q*dt2/2.0;
+		p[2][2]+=q*dt;
+		}
+	}
+
+void updateCovariance(int n,double r,double p[3][3],double k[3]) // Calculates the Kalman gain for a position measurement of the given variance and updates the estimate covariance
+	{
+	/* Calculate the Kalman gain: */
+	double s=p[0][0]+r;
+	for(int i=0;i<n;++i)
+		k[i]=p[i][0]/s;
+	
+	/* Update the estimate covariance: */
+	double p0[3];
+	for(int j=0;j<n;++j)
+		p0[j]=p[0][j];
+	for(int i=0;i<n;++i)
+		for(int j=0;j<n;++j)
+			p[i][j]-=k[i]*p0[j];
+	}
+
+void initCovariance(int n,double r,double q,double p[3][3]) // Initializes a Kalman estimate covariance after a reset
+	{
+	for(int i=0;i<3;++i)
+		for(int j=0;j<3;++j)
+			p[i][j]=0.0;
+	p[0][0]=r;
+	for(int i=1;i<n;++i)
+		p[i][i]=q;
+	}
+
+}
+
+/****************************************
+Methods of class TrackerFilter::Settings:
+****************************************/
+
+TrackerFilter::Settings::Settings(void)
+	:filterType(NONE),
+	 minCutoff(1.0),beta(0.0),derivativeCutoff(1.0),
+	 positionNoise(0.001),orientationNoise(0.001),
+	 positionProcessNoise(100.0),orientationProcessNoise(100.0),
+	 predictionTime(0.0),maxInterval(0.1)
+	{
+	}
+
+void TrackerFilter::Settings::read(const Misc::ConfigurationFileSection& configFileSection)
+	{
+	/* Read the filter type: */
+	std::string filterTypeName=configFileSection.retrieveString("./filterType","None");
+	if(filterTypeName=="None")
+		filterType=NONE;
+	else if(filterTypeName=="OneEuro")
+		filterType=ONEEURO;
+	else if(filterTypeName=="ConstantVelocity")
+		filterType=CONSTANTVELOCITY;
+	else if(filterTypeName=="ConstantAcceleration")
+		filterType=CONSTANTACCELERATION;
+	else
+		Misc::throwStdErr("TrackerFilter: Unrecognized filter type %s",filterTypeName.c_str());
+	
+	/* Read the filter parameters: */
+	minCutoff=configFileSection.retrieveValue<double>("./minCutoff",minCutoff);
+	beta=configFileSection.retrieveValue<double>("./beta",beta);
+	derivativeCutoff=configFileSection.retrieveValue<double>("./derivativeCutoff",derivativeCutoff);
+	positionNoise=configFileSection.retrieveValue<double>("./positionNoise",positionNoise);
+	orientationNoise=configFileSection.retrieveValue<double>("./orientationNoise",orientationNoise);
+	positionProcessNoise=configFileSection.retrieveValue<double>("./positionProcessNoise",positionProcessNoise);
+	orientationProcessNoise=configFileSection.retrieveValue<double>("./orientationProcessNoise",orientationProcessNoise);
+	predictionTime=configFileSection.retrieveValue<double>("./predictionTime",predictionTime);
+	maxInterval=configFileSection.retrieveValue<double>("./maxInterval",maxInterval);
+	}
+
+/******************************************
+Methods of class TrackerFilter::Statistics:
+******************************************/
+
+TrackerFilter::Statistics::Statistics(void)
+	:numUpdates(0),numIntervals(0),
+	 intervalSum(0.0),intervalSum2(0.0),
+	 latencySum(0.0),latencySum2(0.0),maxLatency(0.0),
+	 positionResidualSum2(0.0),orientationResidualSum2(0.0)
+	{
+	}
+
+double TrackerFilter::Statistics::getMeanInterval(void) const
+	{
+	return numIntervals>0?intervalSum/double(numIntervals):0.0;
+	}
+
+double TrackerFilter::Statistics::getIntervalJitter(void) const
+	{
+	if(numIntervals<2)
+		return 0.0;
+	double mean=intervalSum/double(numIntervals);
+	double var=(intervalSum2-mean*intervalSum)/double(numIntervals-1);
+	return var>0.0?Math::sqrt(var):0.0;
+	}
+
+double TrackerFilter::Statistics::getMeanLatency(void) const
+	{
+	return numUpdates>0?latencySum/double(numUpdates):0.0;
+	}
+
+double TrackerFilter::Statistics::getLatencyJitter(void) const
+	{
+	if(numUpdates<2)
+		return 0.0;
+	double mean=latencySum/double(numUpdates);
+	double var=(latencySum2-mean*latencySum)/double(numUpdates-1);
+	return var>0.0?Math::sqrt(var):0.0;
+	}
+
+double TrackerFilter::Statistics::getPositionResidual(void) const
+	{
+	return numUpdates>0?Math::sqrt(positionResidualSum2/double(numUpdates)):0.0;
+	}
+
+double TrackerFilter::Statistics::getOrientationResidual(void) const
+	{
+	return numUpdates>0?Math::sqrt(orientationResidualSum2/double(numUpdates)):0.0;
+	}
+
+/******************************
+Methods of class TrackerFilter:
+******************************/
+
+void TrackerFilter::resetFilter(int trackerIndex,const TrackerState& state)
+	{
+	const Settings& s=settings[trackerIndex];
+	Point p(state.positionOrientation.getOrigin());
+	Rotation r(state.positionOrientation.getRotation());
+	
+	if(s.filterType==ONEEURO)
+		{
+		/* Start the one-euro filter at rest at the raw state: */
+		OneEuroState& oe=oneEuroStates[trackerIndex];
+		oe.position=p;
+		oe.positionSpeed=Vector::zero;
+		oe.orientation=r;
+		oe.orientationSpeed=Vector::zero;
+		oe.linearVelocity=Vector(state.linearVelocity);
+		oe.angularVelocity=Vector(state.angularVelocity);
+		}
+	else if(s.filterType==CONSTANTVELOCITY||s.filterType==CONSTANTACCELERATION)
+		{
+		/* Start the Kalman filter at the raw state and the device-reported velocities: */
+		KalmanState& ks=kalmanStates[trackerIndex];
+		int n=s.filterType==CONSTANTVELOCITY?2:3;
+		ks.position=p;
+		ks.linearVelocity=Vector(state.linearVelocity);
+		ks.linearAcceleration=Vector::zero;
+		ks.orientation=r;
+		ks.angularVelocity=Vector(state.angularVelocity);
+		ks.angularAcceleration=Vector::zero;
+		initCovariance(n,Math::sqr(s.positionNoise),s.positionProcessNoise,ks.positionCov);
+		initCovariance(n,Math::sqr(s.orientationNoise),s.orientationProcessNoise,ks.orientationCov);
+		}
+	}
+
+void TrackerFilter::filterOneEuro(int trackerIndex,double dt,const TrackerFilter::TrackerState& state)
+	{
+	const Settings& s=settings[trackerIndex];
+	OneEuroState& oe=oneEuroStates[trackerIndex];
+	double derivativeAlpha=oneEuroAlpha(s.derivativeCutoff,dt);
+	
+	/* Filter the position with a cutoff frequency depending on the filtered speed: */
+	Vector dp=Point(state.positionOrientation.getOrigin())-oe.position;
+	oe.positionSpeed+=(dp/dt-oe.positionSpeed)*derivativeAlpha;
+	double alpha=oneEuroAlpha(s.minCutoff+s.beta*Geometry::mag(oe.positionSpeed),dt);
+	oe.position+=dp*alpha;
+	oe.linearVelocity+=(Vector(state.linearVelocity)-oe.linearVelocity)*alpha;
+	
+	/* Filter the orientation in the same way, using the incremental rotation as the difference: */
+	Vector dr=(Rotation(state.positionOrientation.getRotation())*Geometry::invert(oe.orientation)).getScaledAxis();
+	oe.orientationSpeed+=(dr/dt-oe.orientationSpeed)*derivativeAlpha;
+	alpha=oneEuroAlpha(s.minCutoff+s.beta*Geometry::mag(oe.orientationSpeed),dt);
+	oe.orientation.leftMultiply(Rotation::rotateScaledAxis(dr*alpha));
+	oe.orientation.renormalize();
+	oe.angularVelocity+=(Vector(state.angularVelocity)-oe.angularVelocity)*alpha;
+	}
+
+void TrackerFilter::filterKalman(int trackerIndex,double dt,const TrackerFilter::TrackerState& state)
+	{
+	const Settings& s=settings[trackerIndex];
+	KalmanState& ks=kalmanStates[trackerIndex];
+	bool acc=s.filterType==CONSTANTACCELERATION;
+	int n=acc?3:2;
+	double k[3];
+	
+	/*********************************************************************
+	All three axes of position and orientation share the same motion and
+	measurement models, and therefore the same covariance and gain; only
+	one scalar filter per tracker and quantity needs to be run.
+	*********************************************************************/
+	
+	/* Predict and correct the position: */
+	ks.position+=ks.linearVelocity*dt;
+	if(acc)
+		{
+		ks.position+=ks.linearAcceleration*(0.5*dt*dt);
+		ks.linearVelocity+=ks.linearAcceleration*dt;
+		}
+	predictCovariance(n,dt,s.positionProcessNoise,ks.positionCov);
+	updateCovariance(n,Math::sqr(s.positionNoise),ks.positionCov,k);
+	Vector dp=Point(state.positionOrientation.getOrigin())-ks.position;
+	ks.position+=dp*k[0];
+	ks.linearVelocity+=dp*k[1];
+	if(acc)
+		ks.linearAcceleration+=dp*k[2];
+	
+	/* Predict and correct the orientation, using incremental rotations in global space as the state: */
+	Vector rotStep=ks.angularVelocity*dt;
+	if(acc)
+		{
+		rotStep+=ks.angularAcceleration*(0.5*dt*dt);
+		ks.angularVelocity+=ks.angularAcceleration*dt;
+		}
+	ks.orientation.leftMultiply(Rotation::rotateScaledAxis(rotStep));
+	predictCovariance(n,dt,s.orientationProcessNoise,ks.orientationCov);
+	updateCovariance(n,Math::sqr(s.orientationNoise),ks.orientationCov,k);
+	Vector dr=(Rotation(state.positionOrientation.getRotation())*Geometry::invert(ks.orientation)).getScaledAxis();
+	ks.orientation.leftMultiply(Rotation::rotateScaledAxis(dr*k[0]));
+	ks.orientation.renormalize();
+	ks.angularVelocity+=dr*k[1];
+	if(acc)
+		ks.angularAcceleration+=dr*k[2];
+	}
+
+TrackerFilter::TrackerFilter(int sNumTrackers)
+	:numTrackers(sNumTrackers),
+	 settings(new Settings[numTrackers]),
+	 valids(new bool[numTrackers]),
+	 lastTimeStamps(new TimeStamp[numTrackers]),
+	 oneEuroStates(new OneEuroState[numTrackers]),
+	 kalmanStates(new KalmanState[numTrackers]),
+	 statistics(new Statistics[numTrackers])
+	{
+	for(int i=0;i<numTrackers;++i)
+		{
+		valids[i]=false;
+		lastTimeStamps[i]=0;
+		}
+	}
+
+TrackerFilter::~TrackerFilter(void)
+	{
+	delete[] settings;
+	delete[] valids;
+	delete[] lastTimeStamps;
+	delete[] oneEuroStates;
+	delete[] kalmanStates;
+	delete[] statistics;
+	}
+
+void TrackerFilter::setSettings(int trackerIndex,const TrackerFilter::Settings& newSettings)
+	{
+	settings[trackerIndex]=newSettings;
+	valids[trackerIndex]=false;
+	}
+
+void TrackerFilter::filter(int trackerIndex,TrackerFilter::TrackerState& state,TrackerFilter::TimeStamp timeStamp,TrackerFilter::TimeStamp arrivalTimeStamp)
+	{
+	const Settings& s=settings[trackerIndex];
+	Statistics& st=statistics[trackerIndex];
+	
+	/* Update the latency and update interval statistics: */
+	++st.numUpdates;
+	double latency=timeDiff(arrivalTimeStamp,timeStamp);
+	st.latencySum+=latency;
+	st.latencySum2+=latency*latency;
+	if(st.maxLatency<latency)
+		st.maxLatency=latency;
+	double dt=0.0;
+	if(valids[trackerIndex])
+		{
+		dt=timeDiff(timeStamp,lastTimeStamps[trackerIndex]);
+		if(dt>0.0)
+			{
+			++st.numIntervals;
+			st.intervalSum+=dt;
+			st.intervalSum2+=dt*dt;
+			}
+		}
+	lastTimeStamps[trackerIndex]=timeStamp;
+	
+	/* Update the filter state unless the new state is a duplicate: */
+	if(!valids[trackerIndex]||dt>s.maxInterval||dt<0.0)
+		{
+		resetFilter(trackerIndex,state);
+		valids[trackerIndex]=true;
+		}
+	else if(dt>0.0)
+		{
+		switch(s.filterType)
+			{
+			case ONEEURO:
+				filterOneEuro(trackerIndex,dt,state);
+				break;
+			
+			case CONSTANTVELOCITY:
+			case CONSTANTACCELERATION:
+				filterKalman(trackerIndex,dt,state);
+				break;
+			
+			default:
+				;
+			}
+		}
+	
+	/* Retrieve the current estimate: */
+	Point p;
+	Rotation r;
+	Vector lv,av;
+	Vector la=Vector::zero;
+	Vector aa=Vector::zero;
+	switch(s.filterType)
+		{
+		case ONEEURO:
+			{
+			const OneEuroState& oe=oneEuroStates[trackerIndex];
+			p=oe.position;
+			r=oe.orientation;
+			lv=oe.linearVelocity;
+			av=oe.angularVelocity;
+			break;
+			}
+		
+		case CONSTANTVELOCITY:
+		case CONSTANTACCELERATION:
+			{
+			const KalmanState& ks=kalmanStates[trackerIndex];
+			p=ks.position;
+			r=ks.orientation;
+			lv=ks.linearVelocity;
+			av=ks.angularVelocity;
+			if(s.filterType==CONSTANTACCELERATION)
+				{
+				la=ks.linearAcceleration;
+				aa=ks.angularAcceleration;
+				}
+			break;
+			}
+		
+		default:
+			p=Point(state.positionOrientation.getOrigin());
+			r=Rotation(state.positionOrientation.getRotation());
+			lv=Vector(state.linearVelocity);
+			av=Vector(state.angularVelocity);
+		}
+	
+	/* Accumulate the difference between the raw and filtered states: */
+	st.positionResidualSum2+=Geometry::sqrDist(Point(state.positionOrientation.getOrigin()),p);
+	st.orientationResidualSum2+=Math::sqr((Rotation(state.positionOrientation.getRotation())*Geometry::invert(r)).getAngle());
+	
+	/* Predict the estimate into the future: */
+	if(s.predictionTime!=0.0)
+		{
+		double t=s.predictionTime;
+		p+=lv*t+la*(0.5*t*t);
+		r.leftMultiply(Rotation::rotateScaledAxis(av*t+aa*(0.5*t*t)));
+		r.renormalize();
+		lv+=la*t;
+		av+=aa*t;
+		}
+	
+	/* Write the estimate back into the tracker state: */
+	state.positionOrientation=TrackerState::PositionOrientation(TrackerState::PositionOrientation::Vector(p-Point::origin),TrackerState::PositionOrientation::Rotation(r));
+	state.linearVelocity=TrackerState::LinearVelocity(lv);
+	state.angularVelocity=TrackerState::AngularVelocity(av);
+	}
+
+void TrackerFilter::reset(int trackerIndex)
+	{
+	valids[trackerIndex]=false;
+	}
+
+void TrackerFilter::resetStatistics(void)
+	{
+	for(int i=0;i<numTrackers;++i)
+		statistics[i]=Statistics();
+	}
+
+void TrackerFilter::printStatistics(const std::vector<std::string>& trackerNames) const
+	{
+	for(int i=0;i<numTrackers;++i)
+		{
+		const Statistics& st=statistics[i];
+		if(st.numUpdates>0)
+			{
+			printf("TrackerFilter: %s: %u updates, interval %.3f +- %.3f ms, latency %.3f +- %.3f ms (max %.3f ms), filter residual %g units, %g degrees\n",
+			       trackerNames[i].c_str(),st.numUpdates,
+			       st.getMeanInterval()*1000.0,st.getIntervalJitter()*1000.0,
+			       st.getMeanLatency()*1000.0,st.getLatencyJitter()*1000.0,st.maxLatency*1000.0,
+			       st.getPositionResidual(),Math::deg(st.getOrientationResidual()));
+			}
+		}
+	fflush(stdout);
+	}
@@ -0,0 +1,177 @@
+/***********************************************************************
+TrackerFilter - Class to smooth and predict the states of all trackers
+managed by a device manager, and to gather per-tracker update latency
+and jitter statistics.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef TRACKERFILTER_INCLUDED
+#define TRACKERFILTER_INCLUDED
+
+#include <string>
+#include <vector>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <Geometry/Rotation.h>
+#include <Vrui/Internal/VRDeviceState.h>
+
+/* Forward declarations: */
+namespace Misc {
+class ConfigurationFileSection;
+}
+
+class TrackerFilter
+	{
+	/* Embedded classes: */
+	public:
+	typedef Vrui::VRDeviceState::TrackerState TrackerState;
+	typedef Vrui::VRDeviceState::TimeStamp TimeStamp;
+	
+	enum FilterType // Enumerated type for filter algorithms
+		{
+		NONE, // Passes tracker states through unchanged, but still applies prediction
+		ONEEURO, // Adaptive low-pass filter with speed-dependent cutoff frequency
+		CONSTANTVELOCITY, // Kalman filter assuming piecewise constant linear and angular velocity
+		CONSTANTACCELERATION // Kalman filter assuming piecewise constant linear and angular acceleration
+		};
+	
+	struct Settings // Structure holding filter settings for a single tracker
+		{
+		/* Elements: */
+		public:
+		FilterType filterType; // Filter algorithm
+		double minCutoff; // Minimum cutoff frequency of one-euro filter in Hz
+		double beta; // Speed coefficient of one-euro filter
+		double derivativeCutoff; // Cutoff frequency of one-euro filter's speed estimate in Hz
+		double positionNoise; // Standard deviation of measured positions for Kalman filters in physical units
+		double orientationNoise; // Standard deviation of measured orientations for Kalman filters in radians
+		double positionProcessNoise; // Spectral density of unmodeled linear acceleration or jerk for Kalman filters
+		double orientationProcessNoise; // Spectral density of unmodeled angular acceleration or jerk for Kalman filters
+		double predictionTime; // Time in seconds by which to predict filtered states into the future
+		double maxInterval; // Maximum time between updates in seconds before the filter is reset
+		
+		/* Constructors and destructors: */
+		Settings(void); // Creates pass-through settings
+		
+		/* Methods: */
+		void read(const Misc::ConfigurationFileSection& configFileSection); // Overrides settings from the given configuration file section
+		};
+	
+	private:
+	typedef Geometry::Point<double,3> Point;
+	typedef Geometry::Vector<double,3> Vector;
+	typedef Geometry::Rotation<double,3> Rotation;
+	
+	struct OneEuroState // Structure holding one-euro filter state for a single tracker
+		{
+		/* Elements: */
+		public:
+		Point position; // Filtered position
+		Vector positionSpeed; // Filtered rate of change of position
+		Rotation orientation; // Filtered orientation
+		Vector orientationSpeed; // Filtered rate of change of orientation as scaled axis
+		Vector linearVelocity; // Filtered reported linear velocity
+		Vector angularVelocity; // Filtered reported angular velocity
+		};
+	
+	struct KalmanState // Structure holding Kalman filter state for a single tracker
+		{
+		/* Elements: */
+		public:
+		Point position; // Estimated position
+		Vector linearVelocity; // Estimated linear velocity
+		Vector linearAcceleration; // Estimated linear acceleration
+		Rotation orientation; // Estimated orientation
+		Vector angularVelocity; // Estimated angular velocity
+		Vector angularAcceleration; // Estimated angular acceleration
+		double positionCov[3][3]; // Estimate covariance per position axis; shared by all three axes
+		double orientationCov[3][3]; // Estimate covariance per orientation axis; shared by all three axes
+		};
+	
+	public:
+	struct Statistics // Structure holding update statistics for a single tracker
+		{
+		/* Elements: */
+		public:
+		unsigned int numUpdates; // Number of received updates
+		unsigned int numIntervals; // Number of measured update intervals
+		double intervalSum,intervalSum2; // Sum and sum of squares of update intervals in seconds
+		double latencySum,latencySum2; // Sum and sum of squares of latencies between sampling and arrival in seconds
+		double maxLatency; // Maximum latency in seconds
+		double positionResidualSum2; // Sum of squared distances between raw and filtered positions
+		double orientationResidualSum2; // Sum of squared angles between raw and filtered orientations
+		
+		/* Constructors and destructors: */
+		Statistics(void); // Creates empty statistics
+		
+		/* Methods: */
+		double getMeanInterval(void) const; // Returns the mean update interval in seconds
+		double getIntervalJitter(void) const; // Returns the standard deviation of update intervals in seconds
+		double getMeanLatency(void) const; // Returns the mean latency in seconds
+		double getLatencyJitter(void) const; // Returns the standard deviation of latencies in seconds
+		double getPositionResidual(void) const; // Returns the RMS distance between raw and filtered positions
+		double getOrientationResidual(void) const; // Returns the RMS angle between raw and filtered orientations in radians
+		};
+	
+	/* Elements: */
+	private:
+	int numTrackers; // Number of filtered trackers
+	Settings* settings; // Array of filter settings for each tracker
+	bool* valids; // Array of flags whether each tracker's filter state has been initialized
+	TimeStamp* lastTimeStamps; // Array of time stamps of each tracker's most recent update
+	OneEuroState* oneEuroStates; // Array of one-euro filter states for each tracker
+	KalmanState* kalmanStates; // Array of Kalman filter states for each tracker
+	Statistics* statistics; // Array of update statistics for each tracker
+	
+	/* Private methods: */
+	void resetFilter(int trackerIndex,const TrackerState& state); // Resets the given tracker's filter state to the given raw state
+	void filterOneEuro(int trackerIndex,double dt,const TrackerState& state); // Applies the one-euro filter
+	void filterKalman(int trackerIndex,double dt,const TrackerState& state); // Applies a Kalman filter
+	
+	/* Constructors and destructors: */
+	public:
+	TrackerFilter(int sNumTrackers); // Creates pass-through filters for the given number of trackers
+	private:
+	TrackerFilter(const TrackerFilter& source); // Prohibit copy constructor
+	TrackerFilter& operator=(const TrackerFilter& source); // Prohibit assignment operator
+	public:
+	~TrackerFilter(void);
+	
+	/* Methods: */
+	int getNumTrackers(void) const // Returns the number of filtered trackers
+		{
+		return numTrackers;
+		}
+	const Settings& getSettings(int trackerIndex) const // Returns the filter settings of the given tracker
+		{
+		return settings[trackerIndex];
+		}
+	void setSettings(int trackerIndex,const Settings& newSettings); // Sets the filter settings of the given tracker and resets its filter
+	void filter(int trackerIndex,TrackerState& state,TimeStamp timeStamp,TimeStamp arrivalTimeStamp); // Filters and predicts the given raw state sampled at the given time stamp in place
+	void reset(int trackerIndex); // Resets the given tracker's filter, e.g., after tracking was lost
+	const Statistics& getStatistics(int trackerIndex) const // Returns the update statistics of the given tracker
+		{
+		return statistics[trackerIndex];
+		}
+	void resetStatistics(void); // Resets the update statistics of all trackers
+	void printStatistics(const std::vector<std::string>& trackerNames) const; // Prints update statistics of all trackers that received updates to stdout
+	};
+
+#endif
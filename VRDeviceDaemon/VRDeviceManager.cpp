@@ -38,6 +38,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <VRDeviceDaemon/VRFactory.h>
 #include <VRDeviceDaemon/VRDevice.h>
 #include <VRDeviceDaemon/VRCalibrator.h>
+#include <VRDeviceDaemon/TrackerFilter.h>
 #include <VRDeviceDaemon/Config.h>
 
 /********************************
@@ -49,7 +50,8 @@ VRDeviceManager::VRDeviceManager(Misc::ConfigurationFile& configFile)
 	 calibratorFactories(configFile.retrieveString("./calibratorDirectory",VRDEVICEDAEMON_CONFIG_VRCALIBRATORSDIR)),
 	 numDevices(0),
 	 devices(0),trackerIndexBases(0),buttonIndexBases(0),valuatorIndexBases(0),
-	 fullTrackerReportMask(0x0),trackerReportMask(0x0),streamer(0)
+	 fullTrackerReportMask(0x0),trackerReportMask(0x0),streamer(0),
+	 trackerFilter(0),printTrackerStatistics(configFile.retrieveValue<bool>("./printTrackerStatistics",false))
 	{
 	/* Allocate device and base index arrays: */
 	typedef std::vector<std::string> StringList;
@@ -59,6 +61,7 @@ VRDeviceManager::VRDeviceManager(Misc::ConfigurationFile& configFile)
 	trackerIndexBases=new int[numDevices];
 	buttonIndexBases=new int[numDevices];
 	valuatorIndexBases=new int[numDevices];
+	StringList trackerFilterNames; // Names of configuration file sections containing filter settings for each tracker
 	
 	/* Initialize VR devices: */
 	for(currentDeviceIndex=0;currentDeviceIndex<numDevices;++currentDeviceIndex)
@@ -91,6 +94,25 @@ VRDeviceManager::VRDeviceManager(Misc::ConfigurationFile& configFile)
 				trackerNames[trackerIndex]=*dtnIt;
 			}
 		
+		/* Read the names of the device's tracker filters: */
+		trackerFilterNames.resize(trackerNames.size());
+		if(configFile.hasTag("./trackerFilter"))
+			{
+			/* Apply the same filter to all of the device's trackers: */
+			std::string deviceTrackerFilterName=configFile.retrieveString("./trackerFilter");
+			for(int trackerIndex=trackerIndexBases[currentDeviceIndex];trackerIndex<int(trackerNames.size());++trackerIndex)
+				trackerFilterNames[trackerIndex]=deviceTrackerFilterName;
+			}
+		if(configFile.hasTag("./trackerFilters"))
+			{
+			/* Override the filters of individual trackers: */
+			StringList deviceTrackerFilterNames=configFile.retrieveValue<StringList>("./trackerFilters");
+			int trackerIndex=trackerIndexBases[currentDeviceIndex];
+			int numTrackers=trackerNames.size();
+			for(StringList::iterator dtfnIt=deviceTrackerFilterNames.begin();dtfnIt!=deviceTrackerFilterNames.end()&&trackerIndex<numTrackers;++dtfnIt,++trackerIndex)
+				trackerFilterNames[trackerIndex]=*dtfnIt;
+			}
+		
 		/* Override device's button names: */
 		if(configFile.hasTag("./buttonNames"))
 			{
@@ -122,6 +144,28 @@ VRDeviceManager::VRDeviceManager(Misc::ConfigurationFile& configFile)
 	/* Set server state's layout: */
 	state.setLayout(trackerNames.size(),buttonNames.size(),valuatorNames.size());
 	
+	/* Create the tracker filter if any trackers are filtered or statistics are requested: */
+	bool haveTrackerFilters=printTrackerStatistics;
+	for(StringList::iterator tfnIt=trackerFilterNames.begin();tfnIt!=trackerFilterNames.end();++tfnIt)
+		if(!tfnIt->empty())
+			haveTrackerFilters=true;
+	if(haveTrackerFilters)
+		{
+		trackerFilter=new TrackerFilter(trackerNames.size());
+		for(int trackerIndex=0;trackerIndex<int(trackerFilterNames.size());++trackerIndex)
+			if(!trackerFilterNames[trackerIndex].empty())
+				{
+				/* Read the tracker's filter settings from the named section: */
+				#ifdef VERBOSE
+				printf("VRDeviceManager: Filtering tracker %s using filter %s\n",trackerNames[trackerIndex].c_str(),trackerFilterNames[trackerIndex].c_str());
+				fflush(stdout);
+				#endif
+				TrackerFilter::Settings settings;
+				settings.read(configFile.getSection(trackerFilterNames[trackerIndex].c_str()));
+				trackerFilter->setSettings(trackerIndex,settings);
+				}
+		}
+	
 	/* Read names of all virtual devices: */
 	StringList virtualDeviceNames=configFile.retrieveValue<StringList>("./virtualDeviceNames",StringList());
 	
@@ -165,6 +209,9 @@ VRDeviceManager::~VRDeviceManager(void)
 	delete[] buttonIndexBases;
 	delete[] valuatorIndexBases;
 	
+	/* Delete the tracker filter: */
+	delete trackerFilter;
+	
 	/* Delete virtual devices: */
 	for(std::vector<Vrui::VRDeviceDescriptor*>::iterator vdIt=virtualDevices.begin();vdIt!=virtualDevices.end();++vdIt)
 		delete *vdIt;
@@ -292,6 +339,10 @@ void VRDeviceManager::disableTracker(int trackerIndex)
 	/* Update the device state: */
 	state.setTrackerValid(trackerIndex,false);
 	
+	/* Restart the tracker's filter when it becomes valid again: */
+	if(trackerFilter!=0)
+		trackerFilter->reset(trackerIndex);
+	
 	/* Check if update notifications are requested: */
 	if(streamer!=0)
 		{
@@ -316,7 +367,15 @@ void VRDeviceManager::setTrackerState(int trackerIndex,const Vrui::VRDeviceState
 	Threads::Mutex::Lock stateLock(stateMutex);
 	
 	/* Update the device state: */
-	state.setTrackerState(trackerIndex,newTrackerState);
+	if(trackerFilter!=0)
+		{
+		/* Filter and predict the new tracker state: */
+		Vrui::VRDeviceState::TrackerState filteredTrackerState=newTrackerState;
+		trackerFilter->filter(trackerIndex,filteredTrackerState,newTimeStamp,getTimeStamp());
+		state.setTrackerState(trackerIndex,filteredTrackerState);
+		}
+	else
+		state.setTrackerState(trackerIndex,newTrackerState);
 	state.setTrackerTimeStamp(trackerIndex,newTimeStamp);
 	state.setTrackerValid(trackerIndex,true);
 	
@@ -365,6 +424,19 @@ void VRDeviceManager::setValuatorState(int valuatorIndex,Vrui::VRDeviceState::Va
 		}
 	}
 
+void VRDeviceManager::setUpdateSequenceNumber(Vrui::VRDeviceState::SequenceNumber newUpdateSequenceNumber)
+	{
+	Threads::Mutex::Lock stateLock(stateMutex);
+	state.setUpdateSequenceNumber(newUpdateSequenceNumber);
+	
+	/* Check if update notifications are requested: */
+	if(streamer!=0)
+		{
+		/* Notify streamer of the update sequence number update: */
+		streamer->updateSequenceNumberUpdated();
+		}
+	}
+
 void VRDeviceManager::updateState(void)
 	{
 	Threads::Mutex::Lock stateLock(stateMutex);
@@ -444,6 +516,11 @@ void VRDeviceManager::start(void)
 	printf("VRDeviceManager: Starting devices\n");
 	fflush(stdout);
 	#endif
+	if(trackerFilter!=0)
+		{
+		Threads::Mutex::Lock stateLock(stateMutex);
+		trackerFilter->resetStatistics();
+		}
 	for(int i=0;i<numDevices;++i)
 		devices[i]->start();
 	}
@@ -456,4 +533,11 @@ void VRDeviceManager::stop(void)
 	#endif
 	for(int i=0;i<numDevices;++i)
 		devices[i]->stop();
+	
+	if(printTrackerStatistics)
+		{
+		/* Print update statistics of all trackers: */
+		Threads::Mutex::Lock stateLock(stateMutex);
+		trackerFilter->printStatistics(trackerNames);
+		}
 	}
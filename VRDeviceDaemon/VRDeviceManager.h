@@ -43,6 +43,7 @@ class HMDConfiguration;
 }
 class VRDevice;
 class VRCalibrator;
+class TrackerFilter;
 
 class VRDeviceManager
 	{
@@ -100,6 +101,7 @@ class VRDeviceManager
 		virtual void trackerUpdated(int trackerIndex) =0; // Notifies the VR streamer that a single tracker has been updated
 		virtual void buttonUpdated(int buttonIndex) =0; // Notifies the VR streamer that a single button has been updated
 		virtual void valuatorUpdated(int valuatorIndex) =0; // Notifies the VR streamer that a single valuator has been updated
+		virtual void updateSequenceNumberUpdated(void) =0; // Notifies the VR streamer that the update sequence number has been updated
 		virtual void updateCompleted(void) =0; // Notifies the VR streamer that the device state has been updated completely
 		virtual void batteryStateUpdated(unsigned int deviceIndex) =0; // Notifies the VR streamer that a battery state has been updated
 		virtual void hmdConfigurationUpdated(const Vrui::HMDConfiguration* hmdConfiguration) =0; // Notifies the VR streamer that an HMD configuration has been updated
@@ -140,6 +142,8 @@ class VRDeviceManager
 	unsigned int fullTrackerReportMask; // Bitmask containing 1-bits for all used logical tracker indices
 	unsigned int trackerReportMask; // Bitmask of logical tracker indices that have reported state
 	VRStreamer* streamer; // Pointer to VR streamer receiving state update notifications
+	TrackerFilter* trackerFilter; // Filter smoothing and predicting tracker states and gathering tracker statistics; null if disabled
+	bool printTrackerStatistics; // Flag whether to print tracker update statistics when devices are stopped
 	
 	/* Constructors and destructors: */
 	public:
@@ -192,6 +196,7 @@ class VRDeviceManager
 	void setTrackerState(int trackerIndex,const Vrui::VRDeviceState::TrackerState& newTrackerState,Vrui::VRDeviceState::TimeStamp newTimeStamp); // Updates state of single tracker
 	void setButtonState(int buttonIndex,Vrui::VRDeviceState::ButtonState newButtonState); // Updates state of single button
 	void setValuatorState(int valuatorIndex,Vrui::VRDeviceState::ValuatorState newValuatorState); // Updates state of single valuator
+	void setUpdateSequenceNumber(Vrui::VRDeviceState::SequenceNumber newUpdateSequenceNumber); // Updates the sequence number of the most recent device state update
 	void updateState(void); // Tells device manager that the current state should be considered "complete"
 	void updateBatteryState(unsigned int virtualDeviceIndex,const Vrui::BatteryState& newBatteryState); // Updates the battery state of the given virtual device with the given new state
 	Threads::Mutex& getHmdConfigurationMutex(void) // Returns the mutex serializing access to the HMD configurations
@@ -54,7 +54,7 @@ Methods of class VRDeviceServer::ClientState:
 VRDeviceServer::ClientState::ClientState(VRDeviceServer* sServer,Comm::ListeningTCPSocket& listenSocket)
 	:server(sServer),
 	 pipe(listenSocket),
-	 state(START),protocolVersion(Vrui::VRDevicePipe::protocolVersionNumber),clientExpectsTimeStamps(true),
+	 state(START),protocolVersion(Vrui::VRDevicePipe::protocolVersionNumber),clientExpectsTimeStamps(true),clientExpectsSequenceNumbers(true),
 	 active(false),streaming(false)
 	{
 	#ifdef VERBOSE
@@ -241,6 +241,9 @@ bool VRDeviceServer::clientMessageCallback(Threads::EventDispatcher::ListenerKey
 						/* Check if the client expects tracker valid flags: */
 						client->clientExpectsValidFlags=client->protocolVersion>=5;
 						
+						/* Check if the client expects update sequence numbers: */
+						client->clientExpectsSequenceNumbers=client->protocolVersion>=10U;
+						
 						/* Check if the client knows about power and haptic features: */
 						if(client->protocolVersion>=6U)
 							{
@@ -302,7 +305,7 @@ bool VRDeviceServer::clientMessageCallback(Threads::EventDispatcher::ListenerKey
 						/* Send the current server state to the client: */
 						{
 						Threads::Mutex::Lock stateLock(thisPtr->stateMutex);
-						thisPtr->state.write(client->pipe,client->clientExpectsTimeStamps,client->clientExpectsValidFlags);
+						thisPtr->state.write(client->pipe,client->clientExpectsTimeStamps,client->clientExpectsValidFlags,client->clientExpectsSequenceNumbers);
 						}
 						
 						/* Finish the reply message: */
@@ -478,6 +481,14 @@ bool VRDeviceServer::writeStateUpdates(VRDeviceServer::ClientStateList::iterator
 			client->pipe.write<Vrui::VRDeviceState::ValuatorState>(state.getValuatorState(*uvIt));
 			}
 		
+		/* Send the update sequence number after the device states it belongs to: */
+		if(updatedSequenceNumber&&client->clientExpectsSequenceNumbers)
+			{
+			/* Send update sequence number message: */
+			client->pipe.writeMessage(Vrui::VRDevicePipe::UPDATESEQUENCE_UPDATE);
+			client->pipe.write<Vrui::VRDeviceState::SequenceNumber>(state.getUpdateSequenceNumber());
+			}
+		
 		/* Finish the message set: */
 		client->pipe.flush();
 		}
@@ -505,7 +516,7 @@ bool VRDeviceServer::writeServerState(VRDeviceServer::ClientStateList::iterator
 		client->pipe.writeMessage(Vrui::VRDevicePipe::PACKET_REPLY);
 		
 		/* Send server state: */
-		state.write(client->pipe,client->clientExpectsTimeStamps,client->clientExpectsValidFlags);
+		state.write(client->pipe,client->clientExpectsTimeStamps,client->clientExpectsValidFlags,client->clientExpectsSequenceNumbers);
 		client->pipe.flush();
 		}
 	catch(const std::runtime_error& err)
@@ -575,7 +586,7 @@ VRDeviceServer::VRDeviceServer(VRDeviceManager* sDeviceManager,const Misc::Confi
 	:VRDeviceManager::VRStreamer(sDeviceManager),
 	 listenSocket(configFile.retrieveValue<int>("./serverPort",-1),5),
 	 numActiveClients(0),numStreamingClients(0),
-	 haveUpdates(false),
+	 haveUpdates(false),updatedSequenceNumber(false),
 	 managerTrackerStateVersion(0U),streamingTrackerStateVersion(0U),
 	 managerBatteryStateVersion(0U),streamingBatteryStateVersion(0U),batteryStateVersions(0),
 	 managerHmdConfigurationVersion(0U),streamingHmdConfigurationVersion(0U),
@@ -632,6 +643,14 @@ void VRDeviceServer::valuatorUpdated(int valuatorIndex)
 	dispatcher.interrupt();
 	}
 
+void VRDeviceServer::updateSequenceNumberUpdated(void)
+	{
+	/* Remember that the update sequence number changed and wake up the run loop: */
+	haveUpdates=true;
+	updatedSequenceNumber=true;
+	dispatcher.interrupt();
+	}
+
 void VRDeviceServer::updateCompleted(void)
 	{
 	/* Update the version number of the device manager's tracking state and wake up the run loop: */
@@ -685,6 +704,7 @@ void VRDeviceServer::run(void)
 				updatedTrackers.clear();
 				updatedButtons.clear();
 				updatedValuators.clear();
+				updatedSequenceNumber=false;
 				}
 			
 			/* Check if a full state update needs to be sent: */
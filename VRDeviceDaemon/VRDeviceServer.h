@@ -56,6 +56,7 @@ class VRDeviceServer:public VRDeviceManager::VRStreamer
 		unsigned int protocolVersion; // Version of the VR device daemon protocol to use with this client
 		bool clientExpectsTimeStamps; // Flag whether the connected client expects to receive time stamp data
 		bool clientExpectsValidFlags; // Flag whether the connected client expects to receive tracker valid flags
+		bool clientExpectsSequenceNumbers; // Flag whether the connected client expects to receive update sequence numbers
 		bool active; // Flag whether the client is currently active
 		bool streaming; // Flag whether client is currently in streaming mode
 		
@@ -105,6 +106,7 @@ class VRDeviceServer:public VRDeviceManager::VRStreamer
 	std::vector<int> updatedTrackers; // List of trackers that have been updated since last status update was sent
 	std::vector<int> updatedButtons; // List of buttons that have been updated since last status update was sent
 	std::vector<int> updatedValuators; // List of valuators that have been updated since last status update was sent
+	bool updatedSequenceNumber; // Flag if the update sequence number has been updated since last status update was sent
 	unsigned int managerTrackerStateVersion; // Version number of tracker states in device manager
 	unsigned int streamingTrackerStateVersion; // Version number of tracker states most recently sent to streaming clients
 	unsigned int managerBatteryStateVersion; // Version number of device battery states in device manager
@@ -134,6 +136,7 @@ class VRDeviceServer:public VRDeviceManager::VRStreamer
 	virtual void trackerUpdated(int trackerIndex);
 	virtual void buttonUpdated(int buttonIndex);
 	virtual void valuatorUpdated(int valuatorIndex);
+	virtual void updateSequenceNumberUpdated(void);
 	virtual void updateCompleted(void);
 	virtual void batteryStateUpdated(unsigned int deviceIndex);
 	virtual void hmdConfigurationUpdated(const Vrui::HMDConfiguration* hmdConfiguration);
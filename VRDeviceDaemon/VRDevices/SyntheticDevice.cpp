@@ -0,0 +1,262 @@
+/***********************************************************************
+SyntheticDevice - Class for devices generating scripted or recorded
+tracker, button, and valuator states at configurable rates, to measure
+the throughput and latency of the device daemon's streaming path.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <VRDeviceDaemon/VRDevices/SyntheticDevice.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/ConfigurationFile.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <IO/ValueSource.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Realtime/Time.h>
+#include <Geometry/GeometryValueCoders.h>
+
+#include <VRDeviceDaemon/VRDeviceManager.h>
+
+/********************************
+Methods of class SyntheticDevice:
+********************************/
+
+void SyntheticDevice::readRecording(const char* recordingFileName)
+	{
+	/* Open the recording file: */
+	IO::ValueSource source(IO::openFile(recordingFileName));
+	source.skipWs();
+	
+	/*********************************************************************
+	Each non-empty line that does not start with a hash mark contains a
+	time stamp in seconds, followed by the positions (x, y, z) and
+	orientation quaternions (x, y, z, w) of one or more trackers.
+	*********************************************************************/
+	
+	unsigned int numRecordedTrackers=0;
+	while(!source.eof())
+		{
+		/* Read the next line: */
+		std::string line=source.readLine();
+		source.skipWs();
+		if(line.empty()||line[0]=='#')
+			continue;
+		
+		/* Parse all numbers from the line: */
+		std::vector<double> values;
+		const char* lPtr=line.c_str();
+		while(true)
+			{
+			char* endPtr;
+			double value=strtod(lPtr,&endPtr);
+			if(endPtr==lPtr)
+				break;
+			values.push_back(value);
+			lPtr=endPtr;
+			}
+		if(values.size()<8||(values.size()-1)%7!=0)
+			Misc::throwStdErr("SyntheticDevice: Malformed line in recording file %s",recordingFileName);
+		if(numRecordedTrackers==0)
+			numRecordedTrackers=(values.size()-1)/7;
+		else if((values.size()-1)/7!=numRecordedTrackers)
+			Misc::throwStdErr("SyntheticDevice: Mismatching number of trackers in recording file %s",recordingFileName);
+		
+		/* Store the frame: */
+		RecordedFrame frame;
+		frame.time=values[0];
+		if(!recording.empty()&&frame.time<=recording.back().time)
+			Misc::throwStdErr("SyntheticDevice: Non-increasing time stamps in recording file %s",recordingFileName);
+		for(unsigned int i=0;i<numRecordedTrackers;++i)
+			{
+			const double* v=&values[1+i*7];
+			Vector t=Vector(Scalar(v[0]),Scalar(v[1]),Scalar(v[2]));
+			Rotation r=Rotation::fromQuaternion(Scalar(v[3]),Scalar(v[4]),Scalar(v[5]),Scalar(v[6]));
+			frame.poses.push_back(PositionOrientation(t,r));
+			}
+		recording.push_back(frame);
+		}
+	
+	if(recording.size()<2)
+		Misc::throwStdErr("SyntheticDevice: Recording file %s contains fewer than two frames",recordingFileName);
+	}
+
+void SyntheticDevice::calcScriptedState(int trackerIndex,double time,SyntheticDevice::TrackerState& state) const
+	{
+	/* Move each tracker along its own phase-shifted Lissajous curve around the motion center: */
+	Scalar omega=Scalar(2)*Math::Constants<Scalar>::pi*motionFrequency;
+	Scalar angle=omega*Scalar(time)+Scalar(2)*Math::Constants<Scalar>::pi*Scalar(trackerIndex)/Scalar(numTrackers);
+	Scalar c=Math::cos(angle);
+	Scalar s=Math::sin(angle);
+	Scalar c2=Math::cos(Scalar(2)*angle);
+	Scalar s2=Math::sin(Scalar(2)*angle);
+	Vector offset(motionRadius*c,motionRadius*s,Scalar(0.5)*motionRadius*s2);
+	state.positionOrientation=PositionOrientation(motionCenter+offset-Point::origin,Rotation::rotateZ(angle));
+	state.linearVelocity=TrackerState::LinearVelocity(-motionRadius*omega*s,motionRadius*omega*c,motionRadius*omega*c2);
+	state.angularVelocity=TrackerState::AngularVelocity(0,0,omega);
+	}
+
+void SyntheticDevice::calcRecordedState(int trackerIndex,double time,SyntheticDevice::TrackerState& state) const
+	{
+	/* Wrap the time into the recording's time range: */
+	double t0=recording.front().time;
+	double length=recording.back().time-t0;
+	double t=t0+Math::mod(time,length);
+	
+	/* Find the pair of frames bracketing the time by binary search: */
+	size_t l=0;
+	size_t r=recording.size()-1;
+	while(r-l>1)
+		{
+		size_t m=(l+r)>>1;
+		if(recording[m].time<=t)
+			l=m;
+		else
+			r=m;
+		}
+	
+	/* Interpolate between the two frames: */
+	unsigned int recordedIndex=trackerIndex%recording[l].poses.size();
+	const PositionOrientation& p0=recording[l].poses[recordedIndex];
+	const PositionOrientation& p1=recording[r].poses[recordedIndex];
+	Scalar dt=Scalar(recording[r].time-recording[l].time);
+	Scalar w=Scalar(t-recording[l].time)/dt;
+	Vector dTrans=p1.getTranslation()-p0.getTranslation();
+	Vector dRot=(p1.getRotation()*Geometry::invert(p0.getRotation())).getScaledAxis();
+	state.positionOrientation=PositionOrientation(p0.getTranslation()+dTrans*w,Rotation::rotateScaledAxis(dRot*w)*p0.getRotation());
+	state.linearVelocity=TrackerState::LinearVelocity(dTrans/dt);
+	state.angularVelocity=TrackerState::AngularVelocity(dRot/dt);
+	}
+
+void SyntheticDevice::deviceThreadMethod(void)
+	{
+	/* Generate updates at fixed intervals of the monotonic clock: */
+	Realtime::TimeVector period(1.0/updateRate);
+	Realtime::TimePointMonotonic startTime;
+	Realtime::TimePointMonotonic nextUpdate=startTime;
+	Vrui::VRDeviceState::SequenceNumber sequenceNumber=0;
+	while(true)
+		{
+		/* Calculate the current time relative to the start of the generator: */
+		Realtime::TimePointMonotonic now;
+		double time=double(now-startTime);
+		
+		/* Send the update sequence number first, so that it is part of the next complete state: */
+		deviceManager->setUpdateSequenceNumber(sequenceNumber);
+		
+		/* Update all buttons and valuators: */
+		for(int i=0;i<numButtons;++i)
+			setButtonState(i,Math::mod(time*buttonFrequency+double(i)/double(numButtons),1.0)<0.5);
+		for(int i=0;i<numValuators;++i)
+			setValuatorState(i,Vrui::VRDeviceState::ValuatorState(Math::sin(2.0*Math::Constants<double>::pi*(time*valuatorFrequency+double(i)/double(numValuators)))));
+		
+		/* Update all trackers with the same generation time stamp: */
+		Vrui::VRDeviceState::TimeStamp timeStamp=deviceManager->getTimeStamp();
+		for(int i=0;i<numTrackers;++i)
+			{
+			TrackerState ts;
+			if(recording.empty())
+				calcScriptedState(i,time,ts);
+			else
+				calcRecordedState(i,time,ts);
+			setTrackerState(i,ts,timeStamp);
+			}
+		if(numTrackers==0)
+			updateState();
+		
+		++numUpdates;
+		++sequenceNumber;
+		
+		/* Sleep until the next update is due, skipping missed update periods: */
+		nextUpdate+=period;
+		Realtime::TimePointMonotonic afterUpdate;
+		while(nextUpdate<=afterUpdate)
+			{
+			nextUpdate+=period;
+			++numOverruns;
+			}
+		Realtime::TimePointMonotonic::sleep(nextUpdate);
+		}
+	}
+
+SyntheticDevice::SyntheticDevice(VRDevice::Factory* sFactory,VRDeviceManager* sDeviceManager,Misc::ConfigurationFile& configFile)
+	:VRDevice(sFactory,sDeviceManager,configFile),
+	 updateRate(configFile.retrieveValue<double>("./updateRate",1000.0)),
+	 motionCenter(configFile.retrieveValue<Point>("./motionCenter",Point::origin)),
+	 motionRadius(configFile.retrieveValue<Scalar>("./motionRadius",Scalar(12))),
+	 motionFrequency(configFile.retrieveValue<Scalar>("./motionFrequency",Scalar(0.5))),
+	 buttonFrequency(configFile.retrieveValue<double>("./buttonFrequency",1.0)),
+	 valuatorFrequency(configFile.retrieveValue<double>("./valuatorFrequency",0.25)),
+	 numUpdates(0),numOverruns(0)
+	{
+	if(updateRate<=0.0)
+		Misc::throwStdErr("SyntheticDevice: Invalid update rate %f",updateRate);
+	
+	/* Read device layout: */
+	setNumTrackers(configFile.retrieveValue<int>("./numTrackers",1),configFile);
+	setNumButtons(configFile.retrieveValue<int>("./numButtons",0),configFile);
+	setNumValuators(configFile.retrieveValue<int>("./numValuators",0),configFile);
+	
+	/* Read recorded tracker motion if requested: */
+	std::string recordingFileName=configFile.retrieveString("./recordingFileName","");
+	if(!recordingFileName.empty())
+		readRecording(recordingFileName.c_str());
+	}
+
+void SyntheticDevice::start(void)
+	{
+	/* Reset the update counters: */
+	numUpdates=0;
+	numOverruns=0;
+	
+	/* Start device update thread: */
+	startDeviceThread();
+	}
+
+void SyntheticDevice::stop(void)
+	{
+	/* Stop device update thread: */
+	stopDeviceThread();
+	
+	#ifdef VERBOSE
+	printf("SyntheticDevice: Sent %u updates, missed %u update periods\n",numUpdates,numOverruns);
+	fflush(stdout);
+	#endif
+	}
+
+/*************************************
+Object creation/destruction functions:
+*************************************/
+
+extern "C" VRDevice* createObjectSyntheticDevice(VRFactory<VRDevice>* factory,VRFactoryManager<VRDevice>* factoryManager,Misc::ConfigurationFile& configFile)
+	{
+	VRDeviceManager* deviceManager=static_cast<VRDeviceManager::DeviceFactoryManager*>(factoryManager)->getDeviceManager();
+	return new SyntheticDevice(factory,deviceManager,configFile);
+	}
+
+extern "C" void destroyObjectSyntheticDevice(VRDevice* device,VRFactory<VRDevice>* factory,VRFactoryManager<VRDevice>* factoryManager)
+	{
+	delete device;
+	}
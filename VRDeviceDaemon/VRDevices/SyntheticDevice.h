@@ -0,0 +1,80 @@
+/***********************************************************************
+SyntheticDevice - Class for devices generating scripted or recorded
+tracker, button, and valuator states at configurable rates, to measure
+the throughput and latency of the device daemon's streaming path.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Vrui VR Device Driver Daemon (VRDeviceDaemon).
+
+The Vrui VR Device Driver Daemon is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Vrui VR Device Driver Daemon is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Vrui VR Device Driver Daemon; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef SYNTHETICDEVICE_INCLUDED
+#define SYNTHETICDEVICE_INCLUDED
+
+#include <vector>
+#include <Vrui/Internal/VRDeviceState.h>
+
+#include <VRDeviceDaemon/VRDevice.h>
+
+class SyntheticDevice:public VRDevice
+	{
+	/* Embedded classes: */
+	private:
+	typedef Vrui::VRDeviceState::TrackerState TrackerState;
+	typedef TrackerState::PositionOrientation PositionOrientation;
+	typedef PositionOrientation::Scalar Scalar;
+	typedef PositionOrientation::Point Point;
+	typedef PositionOrientation::Vector Vector;
+	typedef PositionOrientation::Rotation Rotation;
+	
+	struct RecordedFrame // Structure for a frame of recorded tracker states
+		{
+		/* Elements: */
+		public:
+		double time; // Time of the frame relative to the beginning of the recording in seconds
+		std::vector<PositionOrientation> poses; // Recorded tracker poses
+		};
+	
+	/* Elements: */
+	double updateRate; // Update rate in Hz
+	Point motionCenter; // Center point of scripted tracker motion
+	Scalar motionRadius; // Radius of scripted tracker motion
+	Scalar motionFrequency; // Revolutions per second of scripted tracker motion
+	double buttonFrequency; // Number of press/release cycles per second of scripted buttons
+	double valuatorFrequency; // Number of oscillations per second of scripted valuators
+	std::vector<RecordedFrame> recording; // Recorded tracker motion replayed in a loop; scripted motion is used if empty
+	unsigned int numUpdates; // Number of updates sent since the device was started
+	unsigned int numOverruns; // Number of update periods that were missed since the device was started
+	
+	/* Private methods: */
+	void readRecording(const char* recordingFileName); // Reads recorded tracker motion from the given text file
+	void calcScriptedState(int trackerIndex,double time,TrackerState& state) const; // Calculates the scripted state of the given tracker at the given time
+	void calcRecordedState(int trackerIndex,double time,TrackerState& state) const; // Calculates the recorded state of the given tracker at the given time
+	
+	/* Protected methods: */
+	virtual void deviceThreadMethod(void);
+	
+	/* Constructors and destructors: */
+	public:
+	SyntheticDevice(VRDevice::Factory* sFactory,VRDeviceManager* sDeviceManager,Misc::ConfigurationFile& configFile);
+	
+	/* Methods: */
+	virtual void start(void);
+	virtual void stop(void);
+	};
+
+#endif
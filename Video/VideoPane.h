@@ -51,7 +51,7 @@ class VideoPane:public Widget
 		{
 		return texture;
 		}
-	Video::YpCbCr420Texture& getTexture(void) // Ditto
+	Video::YpCbCr420Texture& getTexture(void) // Ditto; call update() after changing the texture to invalidate the widget's cached visual representation
 		{
 		return texture;
 		}
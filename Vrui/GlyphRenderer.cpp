@@ -1,6 +1,6 @@
 /***********************************************************************
 GlyphRenderer - Class to quickly render several kinds of common glyphs.
-Copyright (c) 2004-2020 Oliver Kreylos
+Copyright (c) 2004-2021 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -23,16 +23,26 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/GlyphRenderer.h>
 
 #include <string.h>
+#include <math.h>
+#include <stddef.h>
 #include <Misc/ThrowStdErr.h>
+#include <Misc/PrintInteger.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
+#include <Math/Math.h>
 #include <Geometry/Point.h>
 #include <Geometry/Ray.h>
+#include <Geometry/Matrix.h>
 #include <Geometry/OrthonormalTransformation.h>
 #include <GL/GLValueCoders.h>
 #include <GL/GLGeometryWrappers.h>
 #include <GL/GLTransformationWrappers.h>
 #include <GL/GLModels.h>
+#include <GL/GLLightTracker.h>
+#include <GL/Extensions/GLARBDrawInstanced.h>
+#include <GL/Extensions/GLARBInstancedArrays.h>
+#include <GL/Extensions/GLARBVertexBufferObject.h>
+#include <GL/Extensions/GLARBVertexShader.h>
 #include <Images/ReadImageFile.h>
 #include <Vrui/Vrui.h>
 #include <Vrui/Viewer.h>
@@ -41,6 +51,165 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 namespace Vrui {
 
+namespace {
+
+/****************************************************************
+Helper class to convert model geometry into glyph triangle lists:
+****************************************************************/
+
+class GlyphMeshBuilder:public GLModelSink
+	{
+	/* Embedded classes: */
+	public:
+	typedef Geometry::OrthonormalTransformation<GLfloat,3> Transform; // Type for modeling transformations
+	
+	struct Vertex // Structure for interleaved triangle mesh vertices
+		{
+		/* Elements: */
+		public:
+		GLfloat normal[3]; // Vertex normal vector
+		GLfloat position[3]; // Vertex position
+		};
+	
+	/* Elements: */
+	private:
+	std::vector<Vertex>& vertices; // Triangle list receiving generated triangles
+	Transform transform; // Current modeling transformation
+	GLenum primitive; // Type of the current primitive
+	Transform::Vector currentNormal; // Current normal vector in model space
+	std::vector<Vertex> primitiveVertices; // Transformed vertices of the current primitive
+	
+	/* Private methods: */
+	void addTriangle(size_t i0,size_t i1,size_t i2)
+		{
+		vertices.push_back(primitiveVertices[i0]);
+		vertices.push_back(primitiveVertices[i1]);
+		vertices.push_back(primitiveVertices[i2]);
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	GlyphMeshBuilder(std::vector<Vertex>& sVertices)
+		:vertices(sVertices),transform(Transform::identity),primitive(GL_TRIANGLES),currentNormal(0.0f,0.0f,1.0f)
+		{
+		}
+	
+	/* Methods from GLModelSink: */
+	virtual void begin(GLenum newPrimitive)
+		{
+		primitive=newPrimitive;
+		primitiveVertices.clear();
+		}
+	virtual void normal(GLfloat x,GLfloat y,GLfloat z)
+		{
+		currentNormal=transform.transform(Transform::Vector(x,y,z));
+		}
+	virtual void vertex(GLfloat x,GLfloat y,GLfloat z)
+		{
+		Vertex v;
+		Transform::Point p=transform.transform(Transform::Point(x,y,z));
+		for(int i=0;i<3;++i)
+			{
+			v.normal[i]=currentNormal[i];
+			v.position[i]=p[i];
+			}
+		primitiveVertices.push_back(v);
+		}
+	virtual void end(void) // Converts the current primitive into triangles
+		{
+		size_t numVertices=primitiveVertices.size();
+		switch(primitive)
+			{
+			case GL_TRIANGLE_STRIP:
+				for(size_t i=2;i<numVertices;++i)
+					{
+					if(i%2==0)
+						addTriangle(i-2,i-1,i);
+					else
+						addTriangle(i-1,i-2,i);
+					}
+				break;
+			
+			case GL_TRIANGLE_FAN:
+				for(size_t i=2;i<numVertices;++i)
+					addTriangle(0,i-1,i);
+				break;
+			
+			case GL_QUADS:
+				for(size_t i=0;i+3<numVertices;i+=4)
+					{
+					addTriangle(i,i+1,i+2);
+					addTriangle(i,i+2,i+3);
+					}
+				break;
+			
+			case GL_QUAD_STRIP:
+				for(size_t i=0;i+3<numVertices;i+=2)
+					{
+					addTriangle(i,i+1,i+3);
+					addTriangle(i,i+3,i+2);
+					}
+				break;
+			
+			default:
+				for(size_t i=0;i+2<numVertices;i+=3)
+					addTriangle(i,i+1,i+2);
+			}
+		primitiveVertices.clear();
+		}
+	
+	/* New methods: */
+	void setTransform(const Transform& newTransform) // Sets the current modeling transformation
+		{
+		transform=newTransform;
+		}
+	};
+
+void buildGlyph(GlyphMeshBuilder& b,int glyphType,GLfloat glyphSize) // Builds the same geometry as Glyph::render as a triangle list
+	{
+	typedef GlyphMeshBuilder::Transform Transform;
+	
+	switch(glyphType)
+		{
+		case Glyph::CONE:
+			{
+			Transform t=Transform::rotate(Transform::Rotation::rotateX(Math::rad(-90.0f)));
+			t*=Transform::translate(Transform::Vector(0.0f,0.0f,-0.75f*glyphSize));
+			b.setTransform(t);
+			glDrawCone(0.25f*glyphSize,glyphSize,16,b);
+			break;
+			}
+		
+		case Glyph::CUBE:
+			glDrawCube(glyphSize,b);
+			break;
+		
+		case Glyph::SPHERE:
+			glDrawSphereIcosahedron(0.5f*glyphSize,8,b);
+			break;
+		
+		case Glyph::CROSSBALL:
+			{
+			glDrawSphereIcosahedron(0.4f*glyphSize,8,b);
+			glDrawCylinder(0.125f*glyphSize,1.1f*glyphSize,16,b);
+			Transform t=Transform::rotate(Transform::Rotation::rotateX(Math::rad(90.0f)));
+			b.setTransform(t);
+			glDrawCylinder(0.125f*glyphSize,1.1f*glyphSize,16,b);
+			t*=Transform::rotate(Transform::Rotation::rotateY(Math::rad(90.0f)));
+			b.setTransform(t);
+			glDrawCylinder(0.125f*glyphSize,1.1f*glyphSize,16,b);
+			break;
+			}
+		
+		case Glyph::BOX:
+			glDrawWireframeCube(glyphSize,glyphSize*0.075f,glyphSize*0.15f,b);
+			break;
+		}
+	b.setTransform(GlyphMeshBuilder::Transform::identity);
+	}
+
+}
+
 /**********************
 Methods of class Glyph:
 **********************/
@@ -197,21 +366,135 @@ Methods of class GlyphRenderer::DataItem:
 GlyphRenderer::DataItem::DataItem(GLContextData& sContextData)
 	:contextData(sContextData),
 	 glyphDisplayLists(glGenLists(Glyph::GLYPHS_END)),
-	 cursorTextureObjectId(0)
+	 cursorTextureObjectId(0),
+	 haveInstancing(GLARBDrawInstanced::isSupported()&&GLARBInstancedArrays::isSupported()&&GLARBVertexBufferObject::isSupported()&&GLARBShaderObjects::isSupported()&&GLARBVertexShader::isSupported()),
+	 meshBufferId(0),instanceBufferId(0),
+	 vertexShader(0),shaderProgram(0),
+	 lightStateVersion(0),
+	 batching(false)
 	{
 	glGenTextures(1,&cursorTextureObjectId);
+	
+	if(haveInstancing)
+		{
+		/* Initialize required OpenGL extensions: */
+		GLARBDrawInstanced::initExtension();
+		GLARBInstancedArrays::initExtension();
+		GLARBVertexBufferObject::initExtension();
+		GLARBShaderObjects::initExtension();
+		GLARBVertexShader::initExtension();
+		
+		/* Create the vertex buffers: */
+		glGenBuffersARB(1,&meshBufferId);
+		glGenBuffersARB(1,&instanceBufferId);
+		
+		/* Create the shader objects: */
+		vertexShader=glCreateShaderObjectARB(GL_VERTEX_SHADER_ARB);
+		shaderProgram=glCreateProgramObjectARB();
+		glAttachObjectARB(shaderProgram,vertexShader);
+		}
+	
+	for(int i=0;i<Glyph::GLYPHS_END;++i)
+		{
+		meshFirsts[i]=0;
+		meshSizes[i]=0;
+		}
+	for(int i=0;i<8;++i)
+		instanceAttributeIndices[i]=-1;
 	}
 
 GlyphRenderer::DataItem::~DataItem(void)
 	{
 	glDeleteLists(glyphDisplayLists,Glyph::GLYPHS_END);
 	glDeleteTextures(1,&cursorTextureObjectId);
+	if(haveInstancing)
+		{
+		glDeleteBuffersARB(1,&meshBufferId);
+		glDeleteBuffersARB(1,&instanceBufferId);
+		glDeleteObjectARB(vertexShader);
+		glDeleteObjectARB(shaderProgram);
+		}
 	}
 
 /******************************
 Methods of class GlyphRenderer:
 ******************************/
 
+void GlyphRenderer::compileShader(GlyphRenderer::DataItem* dataItem,const GLLightTracker& lightTracker) const
+	{
+	/* Create the glyph instancing vertex shader source code: */
+	std::string vertexShaderFunctions;
+	std::string vertexShaderDeclarations="\
+	attribute vec4 glyphTransform0,glyphTransform1,glyphTransform2;\n\
+	attribute vec4 glyphAmbient,glyphDiffuse,glyphSpecular,glyphEmission;\n\
+	attribute float glyphShininess;\n\
+	\n";
+	std::string vertexShaderMain="\
+	void main()\n\
+		{\n\
+		/* Transform the vertex and normal vector from glyph space to model space: */\n\
+		vec4 modelVertex=vec4(dot(glyphTransform0,gl_Vertex),dot(glyphTransform1,gl_Vertex),dot(glyphTransform2,gl_Vertex),1.0);\n\
+		vec3 modelNormal=vec3(dot(glyphTransform0.xyz,gl_Normal),dot(glyphTransform1.xyz,gl_Normal),dot(glyphTransform2.xyz,gl_Normal));\n\
+		\n\
+		/* Transform the vertex and normal vector to eye space: */\n\
+		vec4 vertex=gl_ModelViewMatrix*modelVertex;\n\
+		vec3 normal=normalize(gl_NormalMatrix*modelNormal);\n\
+		\n";
+	if(lightTracker.isLightingEnabled())
+		{
+		vertexShaderMain+="\
+		/* Initialize the color accumulators: */\n\
+		vec4 ambientDiffuseAccum=gl_LightModel.ambient*glyphAmbient+glyphEmission;\n\
+		vec4 specularAccum=vec4(0.0,0.0,0.0,0.0);\n\
+		\n\
+		/* Accumulate all enabled light sources: */\n";
+		
+		/* Create light application functions for all enabled light sources: */
+		for(int lightIndex=0;lightIndex<lightTracker.getMaxNumLights();++lightIndex)
+			if(lightTracker.getLightState(lightIndex).isEnabled())
+				{
+				/* Create the light accumulation function: */
+				vertexShaderFunctions+=lightTracker.createAccumulateLightFunction(lightIndex);
+				
+				/* Call the light application function from the vertex shader's main function: */
+				vertexShaderMain+="\
+				accumulateLight";
+				char liBuffer[12];
+				vertexShaderMain.append(Misc::print(lightIndex,liBuffer+11));
+				vertexShaderMain+="(vertex,normal,glyphAmbient,glyphDiffuse,glyphSpecular,glyphShininess,ambientDiffuseAccum,specularAccum);\n";
+				}
+		
+		vertexShaderMain+="\
+		\n\
+		/* Compute the final vertex color: */\n\
+		gl_FrontColor=vec4((ambientDiffuseAccum+specularAccum).rgb,glyphDiffuse.a);\n";
+		}
+	else
+		{
+		vertexShaderMain+="\
+		/* Use the glyph's diffuse color as vertex color: */\n\
+		gl_FrontColor=glyphDiffuse;\n";
+		}
+	vertexShaderMain+="\
+		\n\
+		/* Transform the vertex to clip space: */\n\
+		gl_ClipVertex=vertex;\n\
+		gl_Position=gl_ProjectionMatrix*vertex;\n\
+		}\n";
+	
+	/* Compile the vertex shader and link the glyph instancing shader program: */
+	glCompileShaderFromStrings(dataItem->vertexShader,3,vertexShaderFunctions.c_str(),vertexShaderDeclarations.c_str(),vertexShaderMain.c_str());
+	glLinkAndTestShader(dataItem->shaderProgram);
+	
+	/* Retrieve the shader program's per-instance attribute variable locations: */
+	static const char* attributeNames[8]={"glyphTransform0","glyphTransform1","glyphTransform2","glyphAmbient","glyphDiffuse","glyphSpecular","glyphEmission","glyphShininess"};
+	for(int i=0;i<8;++i)
+		dataItem->instanceAttributeIndices[i]=glGetAttribLocationARB(dataItem->shaderProgram,attributeNames[i]);
+	
+	/* Mark the shader program as up-to-date: */
+	dataItem->lightStateVersion=lightTracker.getVersion();
+	}
+
 GlyphRenderer::GlyphRenderer(GLfloat sGlyphSize,const std::string& cursorImageFileName,unsigned int sCursorNominalSize)
 	:GLObject(false),
 	 glyphSize(sGlyphSize),
@@ -293,6 +576,25 @@ void GlyphRenderer::initContext(GLContextData& contextData) const
 			glEndList();
 			}
 		}
+	
+	if(dataItem->haveInstancing)
+		{
+		/* Convert all 3D glyph types into triangle meshes: */
+		std::vector<GlyphMeshBuilder::Vertex> meshVertices;
+		GlyphMeshBuilder builder(meshVertices);
+		for(int glyphType=Glyph::CONE;glyphType<Glyph::GLYPHS_END;++glyphType)
+			{
+			dataItem->meshFirsts[glyphType]=GLint(meshVertices.size());
+			if(glyphType!=Glyph::CURSOR)
+				buildGlyph(builder,glyphType,glyphSize);
+			dataItem->meshSizes[glyphType]=GLsizei(meshVertices.size())-dataItem->meshFirsts[glyphType];
+			}
+		
+		/* Upload the triangle meshes into the mesh buffer: */
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->meshBufferId);
+		glBufferDataARB(GL_ARRAY_BUFFER_ARB,meshVertices.size()*sizeof(GlyphMeshBuilder::Vertex),&meshVertices[0],GL_STATIC_DRAW_ARB);
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+		}
 	}
 
 void GlyphRenderer::renderGlyph(const Glyph& glyph,const OGTransform& transformation,const GlyphRenderer::DataItem* contextDataItem) const
@@ -317,6 +619,36 @@ void GlyphRenderer::renderGlyph(const Glyph& glyph,const OGTransform& transforma
 			
 			glPopMatrix();
 			}
+		else if(contextDataItem->batching)
+			{
+			/* Add the glyph to its type's batch: */
+			std::vector<DataItem::Instance>& instances=contextDataItem->instances[glyph.glyphType];
+			instances.push_back(DataItem::Instance());
+			DataItem::Instance& instance=instances.back();
+			
+			/* Store the rows of the glyph's transformation matrix: */
+			Geometry::Matrix<GLfloat,3,3> rotation;
+			transformation.getRotation().writeMatrix(rotation);
+			GLfloat scaling=GLfloat(transformation.getScaling());
+			const OGTransform::Vector& translation=transformation.getTranslation();
+			for(int i=0;i<3;++i)
+				{
+				for(int j=0;j<3;++j)
+					instance.transform[i][j]=rotation(i,j)*scaling;
+				instance.transform[i][3]=GLfloat(translation[i]);
+				}
+			
+			/* Store the glyph's material properties: */
+			const GLMaterial& m=glyph.glyphMaterial;
+			for(int i=0;i<4;++i)
+				{
+				instance.ambient[i]=m.ambient[i];
+				instance.diffuse[i]=m.diffuse[i];
+				instance.specular[i]=m.specular[i];
+				instance.emission[i]=m.emission[i];
+				}
+			instance.shininess=m.shininess;
+			}
 		else
 			{
 			/* Render a 3D glyph: */
@@ -329,4 +661,111 @@ void GlyphRenderer::renderGlyph(const Glyph& glyph,const OGTransform& transforma
 		}
 	}
 
+void GlyphRenderer::beginBatch(const GlyphRenderer::DataItem* contextDataItem) const
+	{
+	/* Only collect glyphs if the OpenGL context supports instanced rendering: */
+	contextDataItem->batching=contextDataItem->haveInstancing;
+	}
+
+void GlyphRenderer::endBatch(const GlyphRenderer::DataItem* contextDataItem) const
+	{
+	if(!contextDataItem->batching)
+		return;
+	contextDataItem->batching=false;
+	
+	/* Count the collected glyphs: */
+	size_t numInstances=0;
+	for(int glyphType=Glyph::CONE;glyphType<Glyph::GLYPHS_END;++glyphType)
+		numInstances+=contextDataItem->instances[glyphType].size();
+	if(numInstances==0)
+		return;
+	
+	/* Check if the shader program is up-to-date: */
+	DataItem* dataItem=const_cast<DataItem*>(contextDataItem);
+	const GLLightTracker& lightTracker=*dataItem->contextData.getLightTracker();
+	if(dataItem->lightStateVersion!=lightTracker.getVersion())
+		{
+		/* Recompile the shader program: */
+		compileShader(dataItem,lightTracker);
+		}
+	
+	/* Upload all collected glyph instances into the instance buffer in glyph type order: */
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->instanceBufferId);
+	glBufferDataARB(GL_ARRAY_BUFFER_ARB,numInstances*sizeof(DataItem::Instance),0,GL_STREAM_DRAW_ARB);
+	size_t instanceOffsets[Glyph::GLYPHS_END];
+	size_t instanceOffset=0;
+	for(int glyphType=Glyph::CONE;glyphType<Glyph::GLYPHS_END;++glyphType)
+		{
+		std::vector<DataItem::Instance>& instances=dataItem->instances[glyphType];
+		instanceOffsets[glyphType]=instanceOffset;
+		if(!instances.empty())
+			{
+			glBufferSubDataARB(GL_ARRAY_BUFFER_ARB,instanceOffset*sizeof(DataItem::Instance),instances.size()*sizeof(DataItem::Instance),&instances[0]);
+			instanceOffset+=instances.size();
+			}
+		}
+	
+	/* Set up the glyph mesh vertex arrays: */
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->meshBufferId);
+	glNormalPointer(GL_FLOAT,sizeof(GlyphMeshBuilder::Vertex),static_cast<const char*>(0)+offsetof(GlyphMeshBuilder::Vertex,normal));
+	glVertexPointer(3,GL_FLOAT,sizeof(GlyphMeshBuilder::Vertex),static_cast<const char*>(0)+offsetof(GlyphMeshBuilder::Vertex,position));
+	
+	/* Set up the per-instance attribute arrays: */
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->instanceBufferId);
+	const GLint* aiPtr=dataItem->instanceAttributeIndices;
+	for(int i=0;i<8;++i)
+		if(aiPtr[i]>=0)
+			{
+			glEnableVertexAttribArrayARB(aiPtr[i]);
+			glVertexAttribDivisorARB(aiPtr[i],1);
+			}
+	
+	/* Activate the shader program: */
+	glUseProgramObjectARB(dataItem->shaderProgram);
+	
+	/* Draw each glyph type's instances with a single draw call: */
+	for(int glyphType=Glyph::CONE;glyphType<Glyph::GLYPHS_END;++glyphType)
+		{
+		std::vector<DataItem::Instance>& instances=dataItem->instances[glyphType];
+		if(!instances.empty())
+			{
+			/* Point the per-instance attribute arrays to this glyph type's instances: */
+			const char* base=static_cast<const char*>(0)+instanceOffsets[glyphType]*sizeof(DataItem::Instance);
+			for(int i=0;i<3;++i)
+				if(aiPtr[i]>=0)
+					glVertexAttribPointerARB(aiPtr[i],4,GL_FLOAT,GL_FALSE,sizeof(DataItem::Instance),base+offsetof(DataItem::Instance,transform)+i*4*sizeof(GLfloat));
+			if(aiPtr[3]>=0)
+				glVertexAttribPointerARB(aiPtr[3],4,GL_FLOAT,GL_FALSE,sizeof(DataItem::Instance),base+offsetof(DataItem::Instance,ambient));
+			if(aiPtr[4]>=0)
+				glVertexAttribPointerARB(aiPtr[4],4,GL_FLOAT,GL_FALSE,sizeof(DataItem::Instance),base+offsetof(DataItem::Instance,diffuse));
+			if(aiPtr[5]>=0)
+				glVertexAttribPointerARB(aiPtr[5],4,GL_FLOAT,GL_FALSE,sizeof(DataItem::Instance),base+offsetof(DataItem::Instance,specular));
+			if(aiPtr[6]>=0)
+				glVertexAttribPointerARB(aiPtr[6],4,GL_FLOAT,GL_FALSE,sizeof(DataItem::Instance),base+offsetof(DataItem::Instance,emission));
+			if(aiPtr[7]>=0)
+				glVertexAttribPointerARB(aiPtr[7],1,GL_FLOAT,GL_FALSE,sizeof(DataItem::Instance),base+offsetof(DataItem::Instance,shininess));
+			
+			/* Draw all instances: */
+			glDrawArraysInstancedARB(GL_TRIANGLES,dataItem->meshFirsts[glyphType],dataItem->meshSizes[glyphType],GLsizei(instances.size()));
+			
+			/* Clear the batch for the next frame, keeping its allocation: */
+			instances.clear();
+			}
+		}
+	
+	/* Restore OpenGL state: */
+	glUseProgramObjectARB(0);
+	for(int i=0;i<8;++i)
+		if(aiPtr[i]>=0)
+			{
+			glVertexAttribDivisorARB(aiPtr[i],0);
+			glDisableVertexAttribArrayARB(aiPtr[i]);
+			}
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+	glPopClientAttrib();
+	}
+
 }
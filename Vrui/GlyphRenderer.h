@@ -1,6 +1,6 @@
 /***********************************************************************
 GlyphRenderer - Class to quickly render several kinds of common glyphs.
-Copyright (c) 2004-2020 Oliver Kreylos
+Copyright (c) 2004-2021 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -24,10 +24,12 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #define VRUI_GLYPHRENDERER_INCLUDED
 
 #include <string>
+#include <vector>
 #include <GL/gl.h>
 #include <GL/GLMaterial.h>
 #include <GL/GLObject.h>
 #include <GL/GLContextData.h>
+#include <GL/Extensions/GLARBShaderObjects.h>
 #include <Images/RGBAImage.h>
 #include <Vrui/Geometry.h>
 
@@ -35,6 +37,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 namespace Misc {
 class ConfigurationFileSection;
 }
+class GLLightTracker;
 
 namespace Vrui {
 
@@ -96,11 +99,35 @@ class GlyphRenderer:public GLObject
 		{
 		friend class GlyphRenderer;
 		
-		/* Elements: */
+		/* Embedded classes: */
 		private:
+		struct Instance // Structure holding per-instance data of a batched 3D glyph
+			{
+			/* Elements: */
+			public:
+			GLfloat transform[3][4]; // Rows of the glyph's affine transformation matrix
+			GLfloat ambient[4]; // Ambient material color
+			GLfloat diffuse[4]; // Diffuse material color
+			GLfloat specular[4]; // Specular material color
+			GLfloat emission[4]; // Emissive material color
+			GLfloat shininess; // Specular lighting exponent
+			};
+		
+		/* Elements: */
 		GLContextData& contextData; // Reference to context data structure containing this data item
 		GLuint glyphDisplayLists; // Base ID for consecutive display lists to render glyphs
 		GLuint cursorTextureObjectId; // ID of texture object containing cursor glyph texture
+		bool haveInstancing; // Flag whether the OpenGL context supports instanced glyph rendering
+		GLuint meshBufferId; // ID of vertex buffer containing triangle meshes of all 3D glyph types
+		GLint meshFirsts[Glyph::GLYPHS_END]; // Index of the first vertex of each glyph type's triangle mesh
+		GLsizei meshSizes[Glyph::GLYPHS_END]; // Number of vertices in each glyph type's triangle mesh
+		GLuint instanceBufferId; // ID of vertex buffer to stream per-instance data of batched glyphs
+		GLhandleARB vertexShader; // Vertex shader to transform and illuminate glyph instances
+		GLhandleARB shaderProgram; // Shader program to render glyph instances
+		GLint instanceAttributeIndices[8]; // Indices of the shader program's per-instance attribute variables
+		unsigned int lightStateVersion; // Version number of the lighting state reflected in the shader program
+		mutable bool batching; // Flag whether 3D glyphs are currently collected into batches instead of being rendered immediately
+		mutable std::vector<Instance> instances[Glyph::GLYPHS_END]; // Lists of collected instances of each glyph type
 		
 		/* Constructors and destructors: */
 		DataItem(GLContextData& sContextData);
@@ -115,6 +142,9 @@ class GlyphRenderer:public GLObject
 	unsigned int cursorNominalSize; // Nominal size of cursor image
 	unsigned int cursorHotspot[2]; // Position of cursor image's hot spot
 	
+	/* Private methods: */
+	void compileShader(DataItem* dataItem,const GLLightTracker& lightTracker) const; // Compiles the glyph instancing shader program based on the current lighting state
+	
 	/* Constructors and destructors: */
 	public:
 	GlyphRenderer(GLfloat sGlyphSize,const std::string& cursorImageFileName,unsigned int sCursorNominalSize); // Initializes glyph renderer for given glyph size
@@ -130,7 +160,9 @@ class GlyphRenderer:public GLObject
 		/* Return pointer to context data item: */
 		return contextData.retrieveDataItem<DataItem>(this);
 		}
-	void renderGlyph(const Glyph& glyph,const OGTransform& transformation,const DataItem* contextDataItem) const; // Renders glyph into current OpenGL context
+	void renderGlyph(const Glyph& glyph,const OGTransform& transformation,const DataItem* contextDataItem) const; // Renders glyph into current OpenGL context, or adds it to the current batch
+	void beginBatch(const DataItem* contextDataItem) const; // Starts collecting 3D glyphs passed to renderGlyph into per-type batches; the modelview matrix must not change until endBatch
+	void endBatch(const DataItem* contextDataItem) const; // Renders all glyphs collected since beginBatch with one instanced draw call per glyph type
 	};
 
 }
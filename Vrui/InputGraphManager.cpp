@@ -1752,6 +1752,9 @@ void InputGraphManager::glRenderDevices(GLContextData& contextData) const
 	/* Get the glyph renderer's context data item: */
 	const GlyphRenderer::DataItem* glyphRendererContextDataItem=glyphRenderer->getContextDataItem(contextData);
 	
+	/* Collect all device glyphs into per-type batches: */
+	glyphRenderer->beginBatch(glyphRendererContextDataItem);
+	
 	/* Render all input devices in the first input graph level: */
 	for(const GraphInputDevice* gid=deviceLevels[0];gid!=0;gid=gid->levelSucc)
 		if(gid->enabled)
@@ -1787,6 +1790,9 @@ void InputGraphManager::glRenderDevices(GLContextData& contextData) const
 				glyphRenderer->renderGlyph(gid->deviceGlyph,transform,glyphRendererContextDataItem);
 				}
 		}
+	
+	/* Render all collected device glyphs: */
+	glyphRenderer->endBatch(glyphRendererContextDataItem);
 	}
 
 void InputGraphManager::glRenderTools(GLContextData& contextData) const
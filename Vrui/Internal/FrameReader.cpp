@@ -0,0 +1,229 @@
+/***********************************************************************
+FrameReader - Helper class to read back the contents of a VR window for
+movie frames and screenshots, asynchronously through a ring of pixel
+buffer objects if supported by the OpenGL context.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Vrui/Internal/FrameReader.h>
+
+#include <string.h>
+#include <stdexcept>
+#include <Misc/MessageLogger.h>
+#include <GL/Extensions/GLARBVertexBufferObject.h>
+#include <GL/Extensions/GLARBPixelBufferObject.h>
+#include <Images/RGBImage.h>
+#include <Images/WriteImageFile.h>
+#include <Vrui/Internal/MovieSaver.h>
+
+namespace Vrui {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+void setPackParameters(void) // Sets up the OpenGL pixel pipeline to read tightly packed RGB frames
+	{
+	glPixelStorei(GL_PACK_ALIGNMENT,1);
+	glPixelStorei(GL_PACK_SKIP_PIXELS,0);
+	glPixelStorei(GL_PACK_ROW_LENGTH,0);
+	glPixelStorei(GL_PACK_SKIP_ROWS,0);
+	}
+
+void writeScreenshot(const Images::RGBImage& image,const std::string& screenshotFileName) // Writes a screenshot image file
+	{
+	try
+		{
+		Images::writeImageFile(image,screenshotFileName.c_str());
+		}
+	catch(const std::runtime_error& err)
+		{
+		Misc::formattedUserError("Save Screenshot: Could not write screenshot file %s due to exception %s",screenshotFileName.c_str(),err.what());
+		}
+	}
+
+}
+
+/****************************
+Methods of class FrameReader:
+****************************/
+
+void FrameReader::finishSlot(FrameReader::Slot& slot)
+	{
+	/* Map the pixel buffer; this waits for the asynchronous read to complete: */
+	glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB,slot.bufferObjectId);
+	const unsigned char* pixels=static_cast<const unsigned char*>(glMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB,GL_READ_ONLY_ARB));
+	if(pixels!=0)
+		{
+		size_t frameDataSize=size_t(slot.frameSize[1])*size_t(slot.frameSize[0])*3;
+		
+		if(slot.movieSaver!=0)
+			{
+			/* Copy the frame into a fresh frame buffer of the movie saver: */
+			MovieSaver::FrameBuffer& frameBuffer=slot.movieSaver->startNewFrame();
+			frameBuffer.setFrameSize(slot.frameSize[0],slot.frameSize[1]);
+			frameBuffer.prepareWrite();
+			memcpy(frameBuffer.getBuffer(),pixels,frameDataSize);
+			slot.movieSaver->postNewFrame();
+			}
+		
+		if(!slot.screenshotFileName.empty())
+			{
+			/* Copy the frame into an RGB image and save it: */
+			Images::RGBImage image(slot.frameSize[0],slot.frameSize[1]);
+			memcpy(image.replacePixels(),pixels,frameDataSize);
+			writeScreenshot(image,slot.screenshotFileName);
+			}
+		
+		glUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB);
+		}
+	else
+		Misc::consoleError("FrameReader: Unable to map pixel buffer; dropping frame");
+	glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB,0);
+	
+	/* Update the readback statistics: */
+	++numFrames;
+	latencySum+=double(Realtime::TimePointMonotonic()-slot.readTime);
+	
+	/* Release the frame's destinations: */
+	slot.movieSaver=0;
+	slot.screenshotFileName.clear();
+	}
+
+FrameReader::FrameReader(unsigned int sNumSlots)
+	:async(sNumSlots>=2&&GLARBVertexBufferObject::isSupported()&&GLARBPixelBufferObject::isSupported()),
+	 numSlots(async?sNumSlots:0),slots(0),
+	 nextSlot(0),numPendingSlots(0),
+	 numFrames(0),stallTimeSum(0.0),latencySum(0.0)
+	{
+	if(async)
+		{
+		/* Initialize the required OpenGL extensions: */
+		GLARBVertexBufferObject::initExtension();
+		GLARBPixelBufferObject::initExtension();
+		
+		/* Create the pixel buffer ring; buffers will be allocated on first use: */
+		slots=new Slot[numSlots];
+		for(unsigned int i=0;i<numSlots;++i)
+			{
+			glGenBuffersARB(1,&slots[i].bufferObjectId);
+			slots[i].bufferSize=0;
+			slots[i].frameSize[0]=slots[i].frameSize[1]=0;
+			slots[i].movieSaver=0;
+			}
+		}
+	}
+
+FrameReader::~FrameReader(void)
+	{
+	if(async)
+		{
+		/* Deliver all pending frames: */
+		flush();
+		
+		/* Release the pixel buffers: */
+		for(unsigned int i=0;i<numSlots;++i)
+			glDeleteBuffersARB(1,&slots[i].bufferObjectId);
+		delete[] slots;
+		}
+	}
+
+void FrameReader::readFrame(int width,int height,MovieSaver* movieSaver,const char* screenshotFileName)
+	{
+	Realtime::TimePointMonotonic readStart;
+	
+	setPackParameters();
+	if(async)
+		{
+		/* The next slot is always free, as the ring is never allowed to fill up: */
+		Slot& slot=slots[nextSlot];
+		
+		/* Start reading the frame into the slot's pixel buffer: */
+		size_t frameDataSize=size_t(height)*size_t(width)*3;
+		glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB,slot.bufferObjectId);
+		if(slot.bufferSize!=frameDataSize)
+			{
+			/* Resize the pixel buffer: */
+			glBufferDataARB(GL_PIXEL_PACK_BUFFER_ARB,frameDataSize,0,GL_STREAM_READ_ARB);
+			slot.bufferSize=frameDataSize;
+			}
+		glReadPixels(0,0,width,height,GL_RGB,GL_UNSIGNED_BYTE,0);
+		glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB,0);
+		slot.frameSize[0]=width;
+		slot.frameSize[1]=height;
+		slot.movieSaver=movieSaver;
+		if(screenshotFileName!=0)
+			slot.screenshotFileName=screenshotFileName;
+		slot.readTime=readStart;
+		nextSlot=(nextSlot+1)%numSlots;
+		++numPendingSlots;
+		
+		/* Deliver the oldest pending frame if all other slots are in use: */
+		if(numPendingSlots>=numSlots)
+			{
+			finishSlot(slots[(nextSlot+numSlots-numPendingSlots)%numSlots]);
+			--numPendingSlots;
+			}
+		}
+	else
+		{
+		if(movieSaver!=0)
+			{
+			/* Read the frame directly into a fresh frame buffer of the movie saver: */
+			MovieSaver::FrameBuffer& frameBuffer=movieSaver->startNewFrame();
+			frameBuffer.setFrameSize(width,height);
+			frameBuffer.prepareWrite();
+			glReadPixels(0,0,width,height,GL_RGB,GL_UNSIGNED_BYTE,frameBuffer.getBuffer());
+			movieSaver->postNewFrame();
+			}
+		
+		if(screenshotFileName!=0)
+			{
+			/* Read the frame into an RGB image and save it: */
+			Images::RGBImage image(width,height);
+			image.glReadPixels(0,0);
+			writeScreenshot(image,screenshotFileName);
+			}
+		
+		++numFrames;
+		}
+	
+	/* Update the readback statistics: */
+	stallTimeSum+=double(Realtime::TimePointMonotonic()-readStart);
+	}
+
+void FrameReader::flush(void)
+	{
+	Realtime::TimePointMonotonic flushStart;
+	
+	/* Deliver all pending frames in the order in which they were read: */
+	while(numPendingSlots>0)
+		{
+		finishSlot(slots[(nextSlot+numSlots-numPendingSlots)%numSlots]);
+		--numPendingSlots;
+		}
+	
+	/* Update the readback statistics: */
+	stallTimeSum+=double(Realtime::TimePointMonotonic()-flushStart);
+	}
+
+}
@@ -0,0 +1,111 @@
+/***********************************************************************
+FrameReader - Helper class to read back the contents of a VR window for
+movie frames and screenshots, asynchronously through a ring of pixel
+buffer objects if supported by the OpenGL context.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef VRUI_INTERNAL_FRAMEREADER_INCLUDED
+#define VRUI_INTERNAL_FRAMEREADER_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <Realtime/Time.h>
+#include <GL/gl.h>
+
+/* Forward declarations: */
+namespace Vrui {
+class MovieSaver;
+}
+
+namespace Vrui {
+
+class FrameReader
+	{
+	/* Embedded classes: */
+	private:
+	struct Slot // Structure for a pixel buffer receiving the contents of a single frame
+		{
+		/* Elements: */
+		public:
+		GLuint bufferObjectId; // ID of the pixel buffer object
+		size_t bufferSize; // Currently allocated size of the pixel buffer object in bytes
+		int frameSize[2]; // Width and height of the frame being read
+		MovieSaver* movieSaver; // Movie saver receiving the frame, or null
+		std::string screenshotFileName; // Name of an image file receiving the frame, or empty
+		Realtime::TimePointMonotonic readTime; // Time at which reading the frame was started
+		};
+	
+	/* Elements: */
+	bool async; // Flag whether frames are read asynchronously through pixel buffer objects
+	unsigned int numSlots; // Number of pixel buffers in the ring
+	Slot* slots; // Ring of pixel buffers
+	unsigned int nextSlot; // Index of the pixel buffer that will receive the next frame
+	unsigned int numPendingSlots; // Number of pixel buffers whose frames have not been delivered yet
+	
+	/* Readback statistics: */
+	unsigned int numFrames; // Number of delivered frames
+	double stallTimeSum; // Total time the caller was blocked reading back and delivering frames in seconds
+	double latencySum; // Total time between starting to read frames and delivering them in seconds
+	
+	/* Private methods: */
+	void finishSlot(Slot& slot); // Retrieves the frame from the given pixel buffer and delivers it
+	
+	/* Constructors and destructors: */
+	public:
+	FrameReader(unsigned int sNumSlots); // Creates a frame reader for the current OpenGL context with the given number of pixel buffers; reads synchronously if fewer than two are requested or pixel buffer objects are not supported
+	private:
+	FrameReader(const FrameReader& source); // Prohibit copy constructor
+	FrameReader& operator=(const FrameReader& source); // Prohibit assignment operator
+	public:
+	~FrameReader(void); // Delivers all pending frames and releases the pixel buffers; must be called with the OpenGL context current
+	
+	/* Methods: */
+	bool isAsync(void) const // Returns true if frames are read asynchronously
+		{
+		return async;
+		}
+	unsigned int getLatency(void) const // Returns the number of frames by which delivery lags behind reading
+		{
+		return async?numSlots-1:0;
+		}
+	void readFrame(int width,int height,MovieSaver* movieSaver,const char* screenshotFileName); // Starts reading the current frame buffer contents for the given movie saver and/or screenshot file; either may be null
+	void flush(void); // Delivers all pending frames
+	bool hasPendingFrames(void) const // Returns true if there are frames that have not been delivered yet
+		{
+		return numPendingSlots!=0;
+		}
+	unsigned int getNumFrames(void) const // Returns the number of delivered frames
+		{
+		return numFrames;
+		}
+	double getMeanStallTime(void) const // Returns the average time the caller was blocked per delivered frame in seconds
+		{
+		return numFrames>0?stallTimeSum/double(numFrames):0.0;
+		}
+	double getMeanLatency(void) const // Returns the average time between reading and delivering a frame in seconds
+		{
+		return numFrames>0?latencySum/double(numFrames):0.0;
+		}
+	};
+
+}
+
+#endif
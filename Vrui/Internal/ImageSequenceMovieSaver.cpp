@@ -26,11 +26,14 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <ctype.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <stdexcept>
 #include <iostream>
 #include <Misc/PrintfTemplateTests.h>
 #include <Misc/ThrowStdErr.h>
+#include <Misc/MessageLogger.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
+#include <Realtime/Time.h>
 #include <Images/WriteImageFile.h>
 
 namespace Vrui {
@@ -43,14 +46,41 @@ void ImageSequenceMovieSaver::frameWritingThreadMethod(void)
 	{
 	/* Save frames until shut down: */
 	unsigned int frameIndex=0;
+	unsigned int imageIndex=0;
 	while(!done)
 		{
-		/* Add the most recent frame to the captured frame queue: */
 		{
-		Threads::MutexCond::Lock captureLock(captureCond);
-		frames.lockNewValue();
-		capturedFrames.push_back(frames.getLockedValue());
-		captureCond.signal();
+		Threads::Mutex::Lock queueLock(queueMutex);
+		
+		/* Check if a new frame was rendered since the last capture: */
+		if(frames.lockNewValue())
+			{
+			/* Take the new frame, and give its triple buffer slot a recycled frame buffer so that the renderer does not have to allocate a new one: */
+			FrameBuffer& lockedFrame=frames.getLockedValue();
+			lastFrame=lockedFrame;
+			lockedFrame=getFreeFrame(lastFrame.getFrameSize());
+			}
+		
+		if(lastFrame.getBuffer()!=0)
+			{
+			/* Wait for an encoder to make room in the queue unless full queues drop frames: */
+			while(!dropFrames&&!done&&capturedFrames.size()>=maxQueueSize)
+				spaceCond.wait(queueMutex);
+			
+			Threads::Mutex::Lock statisticsLock(statisticsMutex);
+			if(capturedFrames.size()<maxQueueSize)
+				{
+				/* Add the most recent frame to the captured frame queue: */
+				capturedFrames.push_back(CapturedFrame());
+				capturedFrames.back().frameIndex=imageIndex;
+				capturedFrames.back().frame=lastFrame;
+				++imageIndex;
+				frameCond.signal();
+				}
+			else if(!done)
+				++statistics.numDroppedFrames;
+			statistics.queueSize=capturedFrames.size();
+			}
 		}
 		
 		/* Wait for the next frame: */
@@ -64,21 +94,43 @@ void ImageSequenceMovieSaver::frameWritingThreadMethod(void)
 		}
 	}
 
-void* ImageSequenceMovieSaver::frameSavingThreadMethod(void)
+MovieSaver::FrameBuffer ImageSequenceMovieSaver::getFreeFrame(const int frameSize[2])
+	{
+	/* Find a pooled frame buffer of the requested size that is no longer referenced by anyone else: */
+	while(!freeFrames.empty())
+		{
+		FrameBuffer result=freeFrames.back();
+		freeFrames.pop_back();
+		if(result.getFrameSize()[0]==frameSize[0]&&result.getFrameSize()[1]==frameSize[1]&&!result.isShared())
+			return result;
+		}
+	
+	/* Allocate a new frame buffer: */
+	FrameBuffer result;
+	result.setFrameSize(frameSize[0],frameSize[1]);
+	return result;
+	}
+
+void* ImageSequenceMovieSaver::encoderThreadMethod(void)
 	{
-	unsigned int frameIndex=0;
 	while(true)
 		{
 		/* Wait for the next frame: */
-		FrameBuffer frame;
+		CapturedFrame frame;
 		{
-		Threads::MutexCond::Lock captureLock(captureCond);
+		Threads::Mutex::Lock queueLock(queueMutex);
 		while(!done&&capturedFrames.empty())
-			captureCond.wait(captureLock);
+			frameCond.wait(queueMutex);
 		if(capturedFrames.empty()) // Bail out if there will be no more frames
 			break;
 		frame=capturedFrames.front();
 		capturedFrames.pop_front();
+		spaceCond.signal();
+		
+		{
+		Threads::Mutex::Lock statisticsLock(statisticsMutex);
+		statistics.queueSize=capturedFrames.size();
+		}
 		
 		/* Print a progress report if movie saver is already shut down: */
 		if(done)
@@ -91,12 +143,41 @@ void* ImageSequenceMovieSaver::frameSavingThreadMethod(void)
 			}
 		}
 		
-		/* Write the next frame image file: */
+		/* Write the frame image file under the name reserved for it when it was captured: */
 		char frameName[1024];
-		snprintf(frameName,sizeof(frameName),frameNameTemplate.c_str(),frameIndex);
-		++frameIndex;
+		snprintf(frameName,sizeof(frameName),frameNameTemplate.c_str(),frame.frameIndex);
+		Realtime::TimePointMonotonic encodeStart;
+		try
+			{
+			Images::writeImageFile(frame.frame.getFrameSize()[0],frame.frame.getFrameSize()[1],frame.frame.getBuffer(),frameName);
+			}
+		catch(const std::exception& err)
+			{
+			/* Print a message, but carry on: */
+			Misc::formattedConsoleWarning("ImageSequenceMovieSaver: Unable to write movie frame %s due to exception %s",frameName,err.what());
+			}
+		catch(...)
+			{
+			/* Print a message, but carry on: */
+			Misc::formattedConsoleWarning("ImageSequenceMovieSaver: Unable to write movie frame %s due to spurious exception",frameName);
+			}
+		double encodeTime=double(Realtime::TimePointMonotonic()-encodeStart);
+		
+		{
+		/* Return the frame buffer to the pool: */
+		Threads::Mutex::Lock queueLock(queueMutex);
+		freeFrames.push_back(frame.frame);
+		frame.frame=FrameBuffer();
+		}
 		
-		Images::writeImageFile(frame.getFrameSize()[0],frame.getFrameSize()[1],frame.getBuffer(),frameName);
+		{
+		/* Update the pipeline statistics: */
+		Threads::Mutex::Lock statisticsLock(statisticsMutex);
+		++statistics.numWrittenFrames;
+		statistics.encodeTimeSum+=encodeTime;
+		if(statistics.maxEncodeTime<encodeTime)
+			statistics.maxEncodeTime=encodeTime;
+		}
 		}
 	
 	return 0;
@@ -105,14 +186,31 @@ void* ImageSequenceMovieSaver::frameSavingThreadMethod(void)
 ImageSequenceMovieSaver::ImageSequenceMovieSaver(const Misc::ConfigurationFileSection& configFileSection)
 	:MovieSaver(configFileSection),
 	 frameNameTemplate(baseDirectory->getPath(configFileSection.retrieveString("./movieFrameNameTemplate").c_str())),
+	 maxQueueSize(configFileSection.retrieveValue<unsigned int>("./movieQueueSize",16)),
+	 dropFrames(configFileSection.retrieveValue<bool>("./movieDropFrames",false)),
+	 numEncoderThreads(configFileSection.retrieveValue<int>("./movieNumEncoderThreads",0)),
+	 encoderThreads(0),
 	 done(false)
 	{
 	/* Check if the frame name template has the correct format: */
 	if(!Misc::isValidTemplate(frameNameTemplate,'u',1024))
 		Misc::throwStdErr("MovieSaver::MovieSaver: movie frame name template \"%s\" does not have exactly one %%u conversion",frameNameTemplate.c_str());
+	if(maxQueueSize<1)
+		maxQueueSize=1;
+	statistics.maxQueueSize=maxQueueSize;
+	
+	/* Use one encoder thread per CPU, leaving one for the renderer, if the number of encoder threads was not given: */
+	if(numEncoderThreads<=0)
+		{
+		numEncoderThreads=int(sysconf(_SC_NPROCESSORS_ONLN))-1;
+		if(numEncoderThreads<1)
+			numEncoderThreads=1;
+		}
 	
-	/* Start the image writing thread: */
-	frameSavingThread.start(this,&ImageSequenceMovieSaver::frameSavingThreadMethod);
+	/* Start the image writing threads: */
+	encoderThreads=new Threads::Thread[numEncoderThreads];
+	for(int i=0;i<numEncoderThreads;++i)
+		encoderThreads[i].start(this,&ImageSequenceMovieSaver::encoderThreadMethod);
 	}
 
 ImageSequenceMovieSaver::~ImageSequenceMovieSaver(void)
@@ -120,12 +218,18 @@ ImageSequenceMovieSaver::~ImageSequenceMovieSaver(void)
 	/* Stop sound recording at this moment: */
 	stopSound();
 	
-	/* Signal the frame capturing and saving threads to shut down: */
+	/* Signal the frame capturing and encoder threads to shut down: */
+	{
+	Threads::Mutex::Lock queueLock(queueMutex);
 	done=true;
-	captureCond.signal();
+	frameCond.broadcast();
+	spaceCond.broadcast();
+	}
 	
-	/* Wait until the frame saving thread has saved all frames and terminates: */
-	frameSavingThread.join();
+	/* Wait until the encoder threads have saved all frames and terminate: */
+	for(int i=0;i<numEncoderThreads;++i)
+		encoderThreads[i].join();
+	delete[] encoderThreads;
 	}
 
 }
@@ -26,7 +26,9 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <string>
 #include <deque>
-#include <Threads/MutexCond.h>
+#include <vector>
+#include <Threads/Mutex.h>
+#include <Threads/Cond.h>
 #include <Threads/Thread.h>
 #include <Vrui/Internal/MovieSaver.h>
 
@@ -34,12 +36,28 @@ namespace Vrui {
 
 class ImageSequenceMovieSaver:public MovieSaver
 	{
-	/* Elements: */
+	/* Embedded classes: */
 	private:
+	struct CapturedFrame // Structure for a captured frame waiting to be encoded
+		{
+		/* Elements: */
+		public:
+		unsigned int frameIndex; // Index of the frame in the image sequence
+		FrameBuffer frame; // The frame's image data
+		};
+	
+	/* Elements: */
 	std::string frameNameTemplate; // Template for creating image file names; must contain exactly one %d placeholder
-	Threads::MutexCond captureCond; // Condition variable to signal that a new frame has been captured and added to the queue
-	std::deque<FrameBuffer> capturedFrames; // Queue of frame buffers selected for writing
-	Threads::Thread frameSavingThread; // Thread to write captured frames to disk; in separate thread to avoid latency issues
+	size_t maxQueueSize; // Maximum number of captured frames waiting to be encoded
+	bool dropFrames; // Flag whether to drop captured frames if the queue is full, instead of waiting for an encoder
+	Threads::Mutex queueMutex; // Mutex protecting the captured frame queue and the free frame buffer pool
+	Threads::Cond frameCond; // Condition variable to signal that a new frame has been captured and added to the queue
+	Threads::Cond spaceCond; // Condition variable to signal that an encoder removed a frame from the queue
+	std::deque<CapturedFrame> capturedFrames; // Queue of frame buffers selected for writing
+	std::vector<FrameBuffer> freeFrames; // Pool of encoded frame buffers that can receive new frames
+	FrameBuffer lastFrame; // The most recently captured frame, to repeat it if no new frame was rendered in time
+	int numEncoderThreads; // Number of threads encoding captured frames in parallel
+	Threads::Thread* encoderThreads; // Array of threads writing captured frames to disk; in separate threads to avoid latency issues
 	volatile bool done; // Flag whether all frames have been captured
 	
 	/* Protected methods from MovieSaver: */
@@ -48,7 +66,8 @@ class ImageSequenceMovieSaver:public MovieSaver
 	
 	/* Private methods: */
 	private:
-	void* frameSavingThreadMethod(void); // Thread method to write captured frames to disk
+	FrameBuffer getFreeFrame(const int frameSize[2]); // Returns an unshared frame buffer of the given size from the pool, or a new one if there is none; must be called with queue mutex locked
+	void* encoderThreadMethod(void); // Thread method to write captured frames to disk
 	
 	/* Constructors and destructors: */
 	public:
@@ -711,7 +711,9 @@ LensCorrector::LensCorrector(VRWindow& sWindow,const WindowProperties& windowPro
 	 ipdDisplayDialog(0),ipdDisplayDialogTimeout(configFileSection.retrieveValue<double>("./ipdDisplayTimeout",2.0)),
 	 predistortionMultisamplingLevel(multisamplingLevel),
 	 predistortionStencilBufferSize(windowProperties.stencilBufferSize),
-	 warpReproject(false),warpCubicLookup(false),correctOledResponse(false),fixContrast(true)
+	 warpReproject(false),warpCubicLookup(false),
+	 warpReportDelta(false),warpReportInterval(1.0),lastWarpLatency(0.0),lastWarpAngle(0),
+	 correctOledResponse(false),fixContrast(true)
 	{
 	/* Initialize lens corrector state: */
 	for(int eye=0;eye<2;++eye)
@@ -973,6 +975,14 @@ LensCorrector::LensCorrector(VRWindow& sWindow,const WindowProperties& windowPro
 	if(vruiVerbose)
 		std::cout<<"\tReprojection "<<(warpReproject?"enabled":"disabled")<<std::endl;
 	
+	/* Retrieve head pose delta reporting settings: */
+	warpReportDelta=viewer!=0&&configFileSection.retrieveValue<bool>("./warpReportDelta",warpReportDelta);
+	warpReportInterval=configFileSection.retrieveValue<double>("./warpReportInterval",warpReportInterval);
+	warpDeltaStatistics.numFrames=0;
+	warpDeltaStatistics.latencySum=warpDeltaStatistics.latencyMax=0.0;
+	warpDeltaStatistics.angleSum=warpDeltaStatistics.angleMax=0.0;
+	warpDeltaStatistics.nextReportTime=0.0;
+	
 	/* Retrieve cubic look-up flag: */
 	warpCubicLookup=configFileSection.retrieveValue<bool>("./warpCubicLookup",warpCubicLookup);
 	
@@ -1435,15 +1445,49 @@ void LensCorrector::warp(void) const
 	/* Set up the warping shader: */
 	warpingShader.useProgram();
 	Geometry::Matrix<GLfloat,3,3> rotation;
-	if(warpReproject)
+	Rotation rot=Rotation::identity;
+	if(warpReproject||warpReportDelta)
 		{
 		/* Get the viewer's per-frame and up-to-date viewing transformations: */
 		TrackerState viewerTrans0=viewer->getHeadTransformation();
 		TrackerState viewerTrans1=viewer->peekHeadTransformation();
 		
 		/* Calculate the incremental reprojection rotation: */
-		Rotation rot=Geometry::invert(viewerTrans0.getRotation())*viewerTrans1.getRotation();
+		rot=Geometry::invert(viewerTrans0.getRotation())*viewerTrans1.getRotation();
+		
+		/* Measure the head pose delta between the start of the frame and now: */
+		double now=vruiState->appTime.peekTime();
+		lastWarpLatency=now-vruiState->lastFrame;
+		lastWarpAngle=Math::abs(rot.getAngle());
 		
+		if(warpReportDelta)
+			{
+			/* Accumulate the head pose delta: */
+			WarpDeltaStatistics& wds=warpDeltaStatistics;
+			++wds.numFrames;
+			wds.latencySum+=lastWarpLatency;
+			if(wds.latencyMax<lastWarpLatency)
+				wds.latencyMax=lastWarpLatency;
+			wds.angleSum+=double(lastWarpAngle);
+			if(wds.angleMax<double(lastWarpAngle))
+				wds.angleMax=double(lastWarpAngle);
+			
+			/* Print a report if the report interval has passed: */
+			if(now>=wds.nextReportTime)
+				{
+				std::cout<<"LensCorrector: Render-to-warp delta over "<<wds.numFrames<<" frames:";
+				std::cout<<" latency "<<wds.latencySum*1000.0/double(wds.numFrames)<<" ms mean, "<<wds.latencyMax*1000.0<<" ms max;";
+				std::cout<<" rotation "<<Math::deg(wds.angleSum/double(wds.numFrames))<<" deg mean, "<<Math::deg(wds.angleMax)<<" deg max"<<std::endl;
+				
+				wds.numFrames=0;
+				wds.latencySum=wds.latencyMax=0.0;
+				wds.angleSum=wds.angleMax=0.0;
+				wds.nextReportTime=now+warpReportInterval;
+				}
+			}
+		}
+	if(warpReproject)
+		{
 		// DEBUGGING
 		if(lensCorrectorDisableReproject)
 			rot=Rotation::identity;
@@ -98,6 +98,16 @@ class LensCorrector
 		GLint finalViewport[4]; // Viewport position and size of the distortion-corrected image in the final drawable
 		};
 	
+	struct WarpDeltaStatistics // Structure accumulating measured head pose deltas between rendering and warping
+		{
+		/* Elements: */
+		public:
+		unsigned int numFrames; // Number of frames accumulated since the last report
+		double latencySum,latencyMax; // Sum and maximum of times between frame start and warp in seconds
+		double angleSum,angleMax; // Sum and maximum of head rotation angles between frame start and warp in radians
+		double nextReportTime; // Application time at which to print the next report
+		};
+	
 	/* Elements: */
 	private:
 	VRWindow* window; // Pointer to the window to which this lens corrector is attached
@@ -118,6 +128,11 @@ class LensCorrector
 	int predistortionStencilBufferSize; // Bit depth of the optional pre-distortion stencil buffer
 	bool warpReproject; // Flag whether to use swap-time reprojection to reduce perceived latency
 	bool warpCubicLookup; // Flag whether to use bicubic interpolation instead of bilinear for texture look-up in the warping shader
+	bool warpReportDelta; // Flag whether to measure and report head pose deltas between rendering and warping
+	double warpReportInterval; // Interval between head pose delta reports in seconds
+	mutable double lastWarpLatency; // Time between the current frame's start and its warp in seconds
+	mutable Scalar lastWarpAngle; // Head rotation angle between the current frame's start and its warp in radians
+	mutable WarpDeltaStatistics warpDeltaStatistics; // Head pose delta statistics since the last report
 	GLint finalViewport[4]; // Viewport position and size covering the entire final drawable
 	GLuint predistortionFrameBufferId; // ID of the pre-distortion frame buffer
 	GLuint predistortionColorBufferIds[2]; // IDs of the left and right pre-distortion color image textures; double-buffering used for OLED response time correction
@@ -164,6 +179,14 @@ class LensCorrector
 		{
 		return warpReproject;
 		}
+	double getLastWarpLatency(void) const // Returns the time between the start and the warp of the most recent frame in seconds
+		{
+		return lastWarpLatency;
+		}
+	Scalar getLastWarpAngle(void) const // Returns the head rotation angle between the start and the warp of the most recent frame in radians
+		{
+		return lastWarpAngle;
+		}
 	void warp(void) const; // Warps the previously rendered left and right eye pre-distortion images into the final drawable
 	};
 
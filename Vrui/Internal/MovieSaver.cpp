@@ -139,6 +139,12 @@ int MovieSaver::waitForNextFrame(void)
 		++numSkippedFrames;
 		}
 	
+	if(numSkippedFrames>0)
+		{
+		Threads::Mutex::Lock statisticsLock(statisticsMutex);
+		statistics.numSkippedFrames+=numSkippedFrames;
+		}
+	
 	/* Sleep until the next frame is due: */
 	Misc::sleep(nextFrameTime-t);
 	nextFrameTime+=frameInterval;
@@ -27,6 +27,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <string>
 #include <Misc/Time.h>
 #include <IO/Directory.h>
+#include <Threads/Mutex.h>
 #include <Threads/Thread.h>
 #include <Threads/TripleBuffer.h>
 
@@ -85,6 +86,37 @@ class MovieSaver
 			{
 			return buffer;
 			}
+		bool isShared(void) const // Returns true if the frame's image data are shared with another frame buffer
+			{
+			return buffer!=0&&reinterpret_cast<const unsigned int*>(buffer)[-1]!=1;
+			}
+		};
+	
+	struct Statistics // Structure reporting the state of a movie saver's frame writing pipeline
+		{
+		/* Elements: */
+		public:
+		unsigned int numWrittenFrames; // Number of frames written to the movie so far
+		unsigned int numSkippedFrames; // Number of frames skipped because frame capture fell behind the frame rate
+		unsigned int numDroppedFrames; // Number of captured frames dropped because the encoding queue was full
+		unsigned int queueSize; // Number of captured frames currently waiting to be encoded
+		unsigned int maxQueueSize; // Maximum number of captured frames waiting to be encoded, or 0 if there is no queue
+		double encodeTimeSum; // Total time spent encoding written frames in seconds
+		double maxEncodeTime; // Maximum time spent encoding a single frame in seconds
+		
+		/* Constructors and destructors: */
+		Statistics(void) // Creates empty statistics
+			:numWrittenFrames(0),numSkippedFrames(0),numDroppedFrames(0),
+			 queueSize(0),maxQueueSize(0),
+			 encodeTimeSum(0.0),maxEncodeTime(0.0)
+			{
+			}
+		
+		/* Methods: */
+		double getMeanEncodeTime(void) const // Returns the average time spent encoding a frame in seconds
+			{
+			return numWrittenFrames>0?encodeTimeSum/double(numWrittenFrames):0.0;
+			}
 		};
 	
 	/* Elements: */
@@ -97,6 +129,8 @@ class MovieSaver
 	Sound::SoundRecorder* soundRecorder; // Pointer to a sound recorder if sound recording was started
 	Misc::Time nextFrameTime; // Time point at which the next frame needs to be written
 	bool firstFrame; // Flag to indicate the first saved frame
+	mutable Threads::Mutex statisticsMutex; // Mutex protecting the pipeline statistics
+	Statistics statistics; // Current pipeline statistics
 	
 	/* Private methods: */
 	void* frameWritingThreadWrapper(void);
@@ -119,6 +153,11 @@ class MovieSaver
 		return frames.startNewValue();
 		}
 	void postNewFrame(void); // Signals that the new frame has been received
+	Statistics getStatistics(void) const // Returns the current pipeline statistics; can be called from any thread
+		{
+		Threads::Mutex::Lock statisticsLock(statisticsMutex);
+		return statistics;
+		}
 	};
 
 }
@@ -0,0 +1,138 @@
+/***********************************************************************
+PluginPreloader - Class to load a list of plug-in DSOs in a background
+thread, and to initialize their classes in the main thread in small
+per-frame slices to avoid frame rate hitches mid-session.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Vrui/Internal/PluginPreloader.h>
+
+#include <dlfcn.h>
+#include <stdexcept>
+#include <iostream>
+#include <Misc/Timer.h>
+
+#include <Vrui/Internal/Vrui.h>
+
+namespace Vrui {
+
+/********************************
+Methods of class PluginPreloader:
+********************************/
+
+void* PluginPreloader::loaderThreadMethod(void)
+	{
+	/* Load all DSOs in list order, so that base classes listed first can provide symbols to derived classes listed later: */
+	for(std::vector<Item>::iterator iIt=items.begin();iIt!=items.end();++iIt)
+		{
+		/* Load the DSO with the same flags the plug-in manager will use later: */
+		Misc::Timer loadTimer;
+		iIt->dsoHandle=dlopen(iIt->dsoName.c_str(),RTLD_LAZY|RTLD_GLOBAL);
+		iIt->loadTime=loadTimer.peekTime();
+		
+		/* Hand the item to the main thread: */
+		{
+		Threads::MutexCond::Lock loadedLock(loadedCond);
+		++numLoaded;
+		loadedCond.signal();
+		}
+		}
+	
+	return 0;
+	}
+
+PluginPreloader::PluginPreloader(const char* sManagerName,PluginPreloader::InitializeClassFunction* sInitializeClassFunction,unsigned int sNumClassesPerSlice)
+	:managerName(sManagerName),
+	 initializeClassFunction(sInitializeClassFunction),
+	 numClassesPerSlice(sNumClassesPerSlice>0?sNumClassesPerSlice:1),
+	 numLoaded(0),numInitialized(0)
+	{
+	}
+
+PluginPreloader::~PluginPreloader(void)
+	{
+	/* Wait for the background thread to finish: */
+	if(!loaderThread.isJoined())
+		loaderThread.join();
+	
+	/* Release all DSOs whose classes were never initialized: */
+	for(size_t i=numInitialized;i<items.size();++i)
+		if(items[i].dsoHandle!=0)
+			dlclose(items[i].dsoHandle);
+	
+	delete initializeClassFunction;
+	}
+
+void PluginPreloader::addClass(const char* className,const std::string& dsoName)
+	{
+	Item newItem;
+	newItem.className=className;
+	newItem.dsoName=dsoName;
+	newItem.dsoHandle=0;
+	newItem.loadTime=0.0;
+	items.push_back(newItem);
+	}
+
+void PluginPreloader::start(void)
+	{
+	/* Start the background thread if there is anything to load: */
+	if(!items.empty())
+		loaderThread.start(this,&PluginPreloader::loaderThreadMethod);
+	}
+
+void PluginPreloader::initializeSlice(bool wait)
+	{
+	for(unsigned int slice=0;slice<numClassesPerSlice&&numInitialized<items.size();++slice)
+		{
+		/* Check if the next item's DSO has already been loaded: */
+		{
+		Threads::MutexCond::Lock loadedLock(loadedCond);
+		if(numInitialized==numLoaded)
+			{
+			if(!wait)
+				return;
+			while(numInitialized==numLoaded)
+				loadedCond.wait(loadedLock);
+			}
+		}
+		
+		/* Initialize the plug-in class, which finds its DSO already in memory: */
+		Item& item=items[numInitialized];
+		Misc::Timer initTimer;
+		try
+			{
+			(*initializeClassFunction)(item.className.c_str());
+			if(vruiVerbose&&vruiMaster)
+				std::cout<<"Vrui::"<<managerName<<": Preloaded class "<<item.className<<" (DSO load "<<item.loadTime*1000.0<<" ms in background, class initialization "<<initTimer.peekTime()*1000.0<<" ms)"<<std::endl;
+			}
+		catch(const std::runtime_error& err)
+			{
+			/* Print a warning and carry on: */
+			std::cerr<<vruiErrorHeader<<"Ignoring preloaded "<<managerName<<" class "<<item.className<<" due to exception "<<err.what()<<std::endl;
+			}
+		
+		/* Release the preloader's reference to the DSO; the class holds its own: */
+		if(item.dsoHandle!=0)
+			dlclose(item.dsoHandle);
+		++numInitialized;
+		}
+	}
+
+}
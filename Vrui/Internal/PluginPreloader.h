@@ -0,0 +1,87 @@
+/***********************************************************************
+PluginPreloader - Class to load a list of plug-in DSOs in a background
+thread, and to initialize their classes in the main thread in small
+per-frame slices to avoid frame rate hitches mid-session.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef VRUI_INTERNAL_PLUGINPRELOADER_INCLUDED
+#define VRUI_INTERNAL_PLUGINPRELOADER_INCLUDED
+
+#include <string>
+#include <vector>
+#include <Misc/FunctionCalls.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+
+namespace Vrui {
+
+class PluginPreloader
+	{
+	/* Embedded classes: */
+	public:
+	typedef Misc::FunctionCall<const char*> InitializeClassFunction; // Type for functions initializing a plug-in class of the given name in the main thread
+	
+	private:
+	struct Item // Structure describing a plug-in class to be preloaded
+		{
+		/* Elements: */
+		public:
+		std::string className; // Name of the plug-in class
+		std::string dsoName; // Full path of the DSO containing the plug-in class
+		void* dsoHandle; // Handle of the DSO after preloading, or null if preloading failed
+		double loadTime; // Time taken to load the DSO in the background thread in seconds
+		};
+	
+	/* Elements: */
+	std::string managerName; // Name of the plug-in manager for status messages
+	InitializeClassFunction* initializeClassFunction; // Function to initialize a preloaded plug-in class
+	unsigned int numClassesPerSlice; // Maximum number of plug-in classes to initialize per call to initializeSlice
+	std::vector<Item> items; // List of plug-in classes to preload
+	Threads::MutexCond loadedCond; // Condition variable signalled when the background thread finishes loading a DSO
+	size_t numLoaded; // Number of items whose DSOs have been loaded by the background thread
+	size_t numInitialized; // Number of items whose classes have been initialized by the main thread
+	Threads::Thread loaderThread; // Background thread loading plug-in DSOs
+	
+	/* Private methods: */
+	void* loaderThreadMethod(void); // Thread method loading all plug-in DSOs in order
+	
+	/* Constructors and destructors: */
+	public:
+	PluginPreloader(const char* sManagerName,InitializeClassFunction* sInitializeClassFunction,unsigned int sNumClassesPerSlice); // Creates an idle preloader for the given plug-in manager; preloader inherits function object
+	private:
+	PluginPreloader(const PluginPreloader& source); // Prohibit copy constructor
+	PluginPreloader& operator=(const PluginPreloader& source); // Prohibit assignment operator
+	public:
+	~PluginPreloader(void); // Waits for the background thread to finish and releases all preloaded DSOs
+	
+	/* Methods: */
+	void addClass(const char* className,const std::string& dsoName); // Adds a plug-in class contained in the DSO of the given full path to the preload list; must be called before start
+	void start(void); // Starts loading all plug-in DSOs in the background
+	bool isFinished(void) const // Returns true if all plug-in classes have been initialized
+		{
+		return numInitialized==items.size();
+		}
+	void initializeSlice(bool wait); // Initializes the next slice of preloaded plug-in classes; waits for DSOs that are still loading if flag is true
+	};
+
+}
+
+#endif
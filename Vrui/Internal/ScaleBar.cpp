@@ -224,6 +224,9 @@ void ScaleBar::calcSize(const NavTransform& newNavigationTransformation,const Ge
 	scaleLabel->setString(scaleLabelText);
 	GLLabel::Box::Vector scaleLabelSize=scaleLabel->getLabelSize();
 	scaleLabel->setOrigin(GLLabel::Box::Vector(-scaleLabelSize[0]*0.5f,-scaleLabelSize[1]*1.5f,0.0f));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ScaleBar::navigationChangedCallback(NavigationTransformationChangedCallbackData* cbData)
@@ -92,7 +92,7 @@ void* VRDeviceClient::streamReceiveThreadMethod(void)
 				/* Read server's state: */
 				{
 				Threads::Mutex::Lock stateLock(stateMutex);
-				state.read(pipe,serverHasTimeStamps,serverHasValidFlags);
+				state.read(pipe,serverHasTimeStamps,serverHasValidFlags,serverHasSequenceNumbers);
 				if(!serverHasTimeStamps)
 					{
 					/* Set all tracker time stamps to the current local time: */
@@ -180,6 +180,27 @@ void* VRDeviceClient::streamReceiveThreadMethod(void)
 				/* Signal packet reception: */
 				packetSignalCond.broadcast();
 				
+				/* Invoke packet notification callback: */
+				if(packetNotificationCallback!=0)
+					(*packetNotificationCallback)(this);
+				}
+			else if(message==VRDevicePipe::UPDATESEQUENCE_UPDATE)
+				{
+				/* Read an update sequence number packet: */
+				{
+				Threads::Mutex::Lock stateLock(stateMutex);
+				
+				VRDeviceState::SequenceNumber updateSequenceNumber=pipe.read<VRDeviceState::SequenceNumber>();
+				state.setUpdateSequenceNumber(updateSequenceNumber);
+				
+				#if DEBUG_PROTOCOL
+				std::cout<<"Received UPDATESEQUENCE_UPDATE, sequence number "<<updateSequenceNumber<<std::endl;
+				#endif
+				}
+				
+				/* Signal packet reception: */
+				packetSignalCond.broadcast();
+				
 				/* Invoke packet notification callback: */
 				if(packetNotificationCallback!=0)
 					(*packetNotificationCallback)(this);
@@ -348,6 +369,9 @@ void VRDeviceClient::initClient(void)
 		for(int i=0;i<state.getNumTrackers();++i)
 			state.setTrackerValid(i,true);
 	
+	/* Check if the server will send update sequence numbers: */
+	serverHasSequenceNumbers=serverProtocolVersionNumber>=10U;
+	
 	/* Check if the server maintains power and haptic features: */
 	if(serverProtocolVersionNumber>=6U)
 		{
@@ -359,7 +383,7 @@ void VRDeviceClient::initClient(void)
 
 VRDeviceClient::VRDeviceClient(const char* deviceServerName,int deviceServerPort)
 	:pipe(deviceServerName,deviceServerPort),
-	 serverProtocolVersionNumber(0),serverHasTimeStamps(false),
+	 serverProtocolVersionNumber(0),serverHasTimeStamps(false),serverHasValidFlags(false),serverHasSequenceNumbers(false),
 	 batteryStates(0),batteryStateUpdatedCallback(0),
 	 numHmdConfigurations(0),hmdConfigurations(0),hmdConfigurationUpdatedCallbacks(0),
 	 numPowerFeatures(0),numHapticFeatures(0),
@@ -371,7 +395,7 @@ VRDeviceClient::VRDeviceClient(const char* deviceServerName,int deviceServerPort
 
 VRDeviceClient::VRDeviceClient(const Misc::ConfigurationFileSection& configFileSection)
 	:pipe(configFileSection.retrieveString("./serverName").c_str(),configFileSection.retrieveValue<int>("./serverPort")),
-	 serverProtocolVersionNumber(0),serverHasTimeStamps(false),
+	 serverProtocolVersionNumber(0),serverHasTimeStamps(false),serverHasValidFlags(false),serverHasSequenceNumbers(false),
 	 batteryStates(0),batteryStateUpdatedCallback(0),
 	 numHmdConfigurations(0),hmdConfigurations(0),hmdConfigurationUpdatedCallbacks(0),
 	 numPowerFeatures(0),numHapticFeatures(0),
@@ -476,7 +500,7 @@ void VRDeviceClient::getPacket(void)
 			try
 				{
 				Threads::Mutex::Lock stateLock(stateMutex);
-				state.read(pipe,serverHasTimeStamps,serverHasValidFlags);
+				state.read(pipe,serverHasTimeStamps,serverHasValidFlags,serverHasSequenceNumbers);
 				if(!serverHasTimeStamps)
 					{
 					/* Set all tracker time stamps to the current local time: */
@@ -76,6 +76,7 @@ class VRDeviceClient
 	unsigned int serverProtocolVersionNumber; // Version number of server protocol
 	bool serverHasTimeStamps; // Flag whether the connected device server sends tracker state time stamps
 	bool serverHasValidFlags; // Flag whether the connected device server sends tracker valid flags
+	bool serverHasSequenceNumbers; // Flag whether the connected device server sends update sequence numbers
 	std::vector<VRDeviceDescriptor*> virtualDevices; // List of virtual input devices managed by the server
 	mutable Threads::Mutex stateMutex; // Mutex to serialize access to current state
 	VRDeviceState state; // Shadow of server's current state
@@ -112,6 +113,10 @@ class VRDeviceClient
 		{
 		return local;
 		}
+	bool hasSequenceNumbers(void) const // Returns true if the server sends update sequence numbers
+		{
+		return serverHasSequenceNumbers;
+		}
 	int getNumVirtualDevices(void) const // Returns the number of managed virtual input devices
 		{
 		return int(virtualDevices.size());
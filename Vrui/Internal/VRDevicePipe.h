@@ -54,7 +54,8 @@ class VRDevicePipe:public Comm::TCPPipe
 		HAPTICTICK_REQUEST, // Requests a haptic tick on a virtual input device
 		TRACKER_UPDATE, // Sends new state for a single tracker
 		BUTTON_UPDATE, // Sends new state for a single button
-		VALUATOR_UPDATE // Sends new state for a single valuator
+		VALUATOR_UPDATE, // Sends new state for a single valuator
+		UPDATESEQUENCE_UPDATE // Sends the sequence number of the most recent device state update
 		};
 	
 	/* Constructors and destructors: */
@@ -54,6 +54,7 @@ class VRDeviceState
 	typedef float ValuatorState; // Type for valuator states
 	typedef Misc::SInt32 TimeStamp; // Type for device state time stamps in microseconds
 	typedef bool ValidFlag; // Type for device valid flags
+	typedef Misc::UInt32 SequenceNumber; // Type for update sequence numbers attached to device states by their sources
 	
 	/* Elements: */
 	private:
@@ -65,6 +66,7 @@ class VRDeviceState
 	ButtonState* buttonStates; // Array of current button states
 	int numValuators; // Number of represented valuators
 	ValuatorState* valuatorStates; // Array of current valuator states
+	SequenceNumber updateSequenceNumber; // Sequence number of the most recent device state update, as assigned by the update's source
 	
 	/* Private methods: */
 	void initState(void)
@@ -81,6 +83,7 @@ class VRDeviceState
 			buttonStates[i]=false;
 		for(int i=0;i<numValuators;++i)
 			valuatorStates[i]=ValuatorState(0);
+		updateSequenceNumber=0;
 		}
 	
 	/* Constructors and destructors: */
@@ -89,7 +92,8 @@ class VRDeviceState
 		:numTrackers(0),trackerStates(0),
 		 trackerTimeStamps(0),trackerValids(0),
 		 numButtons(0),buttonStates(0),
-		 numValuators(0),valuatorStates(0)
+		 numValuators(0),valuatorStates(0),
+		 updateSequenceNumber(0)
 		{
 		}
 	VRDeviceState(int sNumTrackers,int sNumButtons,int sNumValuators) // Creates device state of given layout
@@ -192,6 +196,14 @@ class VRDeviceState
 		{
 		valuatorStates[valuatorIndex]=newValuatorState;
 		}
+	SequenceNumber getUpdateSequenceNumber(void) const // Returns the sequence number of the most recent device state update
+		{
+		return updateSequenceNumber;
+		}
+	void setUpdateSequenceNumber(SequenceNumber newUpdateSequenceNumber) // Updates the sequence number of the most recent device state update
+		{
+		updateSequenceNumber=newUpdateSequenceNumber;
+		}
 	const TrackerState* getTrackerStates(void) const // Returns array of tracker states
 		{
 		return trackerStates;
@@ -245,7 +257,7 @@ class VRDeviceState
 		int newNumValuators=source.read<int>();
 		setLayout(newNumTrackers,newNumButtons,newNumValuators);
 		}
-	void write(IO::File& sink,bool writeTimeStamps,bool writeValids) const // Writes device state to given data sink
+	void write(IO::File& sink,bool writeTimeStamps,bool writeValids,bool writeSequenceNumber =false) const // Writes device state to given data sink
 		{
 		Misc::FixedArrayMarshaller<TrackerState>::write(trackerStates,numTrackers,sink);
 		if(writeTimeStamps)
@@ -254,8 +266,10 @@ class VRDeviceState
 			Misc::FixedArrayMarshaller<Misc::UInt8>::write(trackerValids,numTrackers,sink);
 		Misc::FixedArrayMarshaller<Misc::UInt8>::write(buttonStates,numButtons,sink);
 		Misc::FixedArrayMarshaller<ValuatorState>::write(valuatorStates,numValuators,sink);
+		if(writeSequenceNumber)
+			sink.write<SequenceNumber>(updateSequenceNumber);
 		}
-	void read(IO::File& source,bool readTimeStamps,bool readValids) const // Reads device state from given data source
+	void read(IO::File& source,bool readTimeStamps,bool readValids,bool readSequenceNumber =false) // Reads device state from given data source
 		{
 		Misc::FixedArrayMarshaller<TrackerState>::read(trackerStates,numTrackers,source);
 		if(readTimeStamps)
@@ -264,6 +278,8 @@ class VRDeviceState
 			Misc::FixedArrayMarshaller<Misc::UInt8>::read(trackerValids,numTrackers,source);
 		Misc::FixedArrayMarshaller<Misc::UInt8>::read(buttonStates,numButtons,source);
 		Misc::FixedArrayMarshaller<ValuatorState>::read(valuatorStates,numValuators,source);
+		if(readSequenceNumber)
+			updateSequenceNumber=source.read<SequenceNumber>();
 		}
 	};
 
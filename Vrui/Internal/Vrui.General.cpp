@@ -82,6 +82,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <AL/ALContextData.h>
 #include <SceneGraph/GLRenderState.h>
 #include <SceneGraph/ALRenderState.h>
+#include <SceneGraph/TextureCache.h>
 #include <Vrui/Internal/Config.h>
 #include <Vrui/Internal/ScreenSaverInhibitor.h>
 #if VRUI_INTERNAL_CONFIG_HAVE_LIBDBUS
@@ -231,6 +232,16 @@ VruiState::DisplayStateMapper::DataItem::~DataItem(void)
 	/* Delete the screen protector display list (if it was created in the first place): */
 	if(screenProtectorDisplayListId!=0)
 		glDeleteLists(screenProtectorDisplayListId,1);
+	
+	/* Report transparent object sorting statistics: */
+	if(vruiVerbose&&vruiMaster&&transparentSortState.getNumPasses()>0)
+		{
+		double numPasses=double(transparentSortState.getNumPasses());
+		std::cout<<"Vrui: Transparency pass statistics over "<<transparentSortState.getNumPasses()<<" passes: ";
+		std::cout<<double(transparentSortState.getNumSortedObjects())/numPasses<<" sorted and "<<double(transparentSortState.getNumUnsortedObjects())/numPasses<<" unsorted objects per pass, ";
+		std::cout<<double(transparentSortState.getNumMoves())/numPasses<<" reorders per pass, ";
+		std::cout<<transparentSortState.getSortTime()*1.0e6/numPasses<<" us mean, "<<transparentSortState.getMaxSortTime()*1.0e6<<" us max sort time"<<std::endl;
+		}
 	}
 
 /**********************************************
@@ -703,6 +714,15 @@ VruiState::~VruiState(void)
 	/* Delete the scene graph manager: */
 	delete sceneGraphManager;
 	
+	/* Report texture cache statistics: */
+	if(vruiVerbose&&vruiMaster&&SceneGraph::TextureCache::haveCache())
+		{
+		SceneGraph::TextureCache::Statistics stats=SceneGraph::TextureCache::getCache().getStatistics();
+		std::cout<<"Vrui: Texture cache statistics: "<<stats.numHits<<" hits, "<<stats.numMisses<<" misses, "<<stats.numEvictions<<" evictions, ";
+		std::cout<<stats.numEntries<<" entries ("<<stats.numUnusedEntries<<" unused), ";
+		std::cout<<double(stats.cpuMemory)/(1024.0*1024.0)<<" MB image memory, "<<double(stats.gpuMemory)/(1024.0*1024.0)<<" MB texture memory"<<std::endl;
+		}
+	
 	/* Delete glyph management: */
 	delete glyphRenderer;
 	
@@ -800,6 +820,7 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	widgetManager->setStyleSheet(&uiStyleSheet);
 	widgetManager->setTimerEventScheduler(timerEventScheduler);
 	widgetManager->setDrawOverlayWidgets(configFileSection.retrieveValue<bool>("./drawOverlayWidgets",widgetManager->getDrawOverlayWidgets()));
+	widgetManager->setRenderCaching(configFileSection.retrieveValue<bool>("./widgetRenderCaching",widgetManager->getRenderCaching()));
 	widgetManager->getWidgetPopCallbacks().add(this,&VruiState::widgetPopCallback);
 	
 	/* Create a UI manager: */
@@ -1965,8 +1986,9 @@ void VruiState::display(DisplayState* displayState,GLContextData& contextData) c
 		/* Re-enable clipping planes: */
 		contextData.getClipPlaneTracker()->resume();
 		
-		/* Execute the transparency rendering pass: */
-		TransparentObject::transparencyPass(contextData);
+		/* Execute the transparency rendering pass in back-to-front order for the current eye: */
+		DisplayStateMapper::DataItem* dsmDataItem=contextData.retrieveDataItem<DisplayStateMapper::DataItem>(&displayStateMapper);
+		TransparentObject::transparencyPass(displayState->eyePosition,dsmDataItem->transparentSortState,contextData);
 		
 		/* Finally disable clipping planes: */
 		contextData.getClipPlaneTracker()->pause();
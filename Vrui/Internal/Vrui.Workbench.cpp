@@ -30,6 +30,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <fcntl.h>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <stdexcept>
@@ -56,6 +57,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Cluster/MulticastPipe.h>
 #include <Cluster/ThreadSynchronizer.h>
 #include <Cluster/Opener.h>
+#include <Cluster/FileCache.h>
 #include <Math/Constants.h>
 #include <Geometry/Point.h>
 #include <Geometry/Plane.h>
@@ -165,6 +167,112 @@ VruiErrorHeader vruiErrorHeader;
 
 namespace {
 
+struct VruiBenchmark // Structure to run a fixed number of frames with a fixed time step and collect per-frame timing statistics
+	{
+	/* Elements: */
+	public:
+	unsigned int numWarmupFrames; // Number of frames to run before collecting timings
+	unsigned int numFrames; // Number of frames for which to collect timings
+	double frameInterval; // Fixed application time step between frames, or 0.0 to use wall-clock time
+	std::string logFileName; // Name of CSV file to which to write per-frame timings, or empty string
+	unsigned int frameIndex; // Index of the current frame
+	Realtime::TimePointMonotonic frameStart; // Time point at which the current frame was started
+	Realtime::TimePointMonotonic updateEnd; // Time point at which the current frame's state update was finished
+	Realtime::TimePointMonotonic renderEnd; // Time point at which the current frame's rendering was finished
+	std::vector<double> appTimes; // Application times of all measured frames
+	std::vector<double> updateTimes; // Times spent updating the Vrui state in all measured frames
+	std::vector<double> renderTimes; // Times spent rendering in all measured frames
+	std::vector<double> swapTimes; // Times spent swapping buffers in all measured frames
+	std::vector<double> totalTimes; // Total times of all measured frames
+	
+	/* Constructors and destructors: */
+	VruiBenchmark(const Misc::ConfigurationFileSection& configFileSection,unsigned int sNumFrames)
+		:numWarmupFrames(configFileSection.retrieveValue<unsigned int>("./benchmarkNumWarmupFrames",10)),
+		 numFrames(sNumFrames),
+		 frameInterval(configFileSection.retrieveValue<double>("./benchmarkFrameInterval",1.0/60.0)),
+		 logFileName(configFileSection.retrieveString("./benchmarkLogFileName",std::string())),
+		 frameIndex(0)
+		{
+		appTimes.reserve(numFrames);
+		updateTimes.reserve(numFrames);
+		renderTimes.reserve(numFrames);
+		swapTimes.reserve(numFrames);
+		totalTimes.reserve(numFrames);
+		}
+	
+	/* Methods: */
+	void startFrame(void) // Starts a new frame right before the Vrui state is updated
+		{
+		/* Advance application time by the fixed time step unless an input device adapter already requested a frame time: */
+		if(frameInterval>0.0&&vruiState->synchFrameTime==0.0)
+			synchronize(vruiState->lastFrame+frameInterval,false);
+		
+		frameStart.set();
+		}
+	void finishUpdate(void) // Marks the end of the Vrui state update
+		{
+		updateEnd.set();
+		}
+	void finishRender(void) // Marks the end of rendering
+		{
+		renderEnd.set();
+		}
+	bool finishFrame(void) // Marks the end of buffer swapping; returns true if the benchmark is complete
+		{
+		Realtime::TimePointMonotonic frameEnd;
+		if(frameIndex>=numWarmupFrames)
+			{
+			/* Record the frame's timings: */
+			appTimes.push_back(vruiState->lastFrame);
+			updateTimes.push_back(double(updateEnd-frameStart));
+			renderTimes.push_back(double(renderEnd-updateEnd));
+			swapTimes.push_back(double(frameEnd-renderEnd));
+			totalTimes.push_back(double(frameEnd-frameStart));
+			}
+		++frameIndex;
+		
+		return frameIndex>=numWarmupFrames+numFrames;
+		}
+	static void printStatistics(const char* name,std::vector<double> times) // Prints percentile statistics of the given list of times
+		{
+		if(times.empty())
+			return;
+		
+		std::sort(times.begin(),times.end());
+		double sum=0.0;
+		for(std::vector<double>::iterator tIt=times.begin();tIt!=times.end();++tIt)
+			sum+=*tIt;
+		size_t n=times.size();
+		printf("%-8s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n",name,sum*1000.0/double(n),times[0]*1000.0,times[(n-1)*50/100]*1000.0,times[(n-1)*90/100]*1000.0,times[(n-1)*95/100]*1000.0,times[(n-1)*99/100]*1000.0,times[n-1]*1000.0);
+		}
+	void writeResults(void) const // Writes the per-frame timing log and prints timing statistics
+		{
+		if(!logFileName.empty())
+			{
+			/* Write all measured frames' timings to a CSV file: */
+			FILE* logFile=fopen(logFileName.c_str(),"w");
+			if(logFile!=0)
+				{
+				fprintf(logFile,"Frame,AppTime,Update,Render,Swap,Total\n");
+				for(size_t i=0;i<totalTimes.size();++i)
+					fprintf(logFile,"%u,%.6f,%.6f,%.6f,%.6f,%.6f\n",(unsigned int)(i),appTimes[i],updateTimes[i]*1000.0,renderTimes[i]*1000.0,swapTimes[i]*1000.0,totalTimes[i]*1000.0);
+				fclose(logFile);
+				}
+			else
+				std::cerr<<"Vrui: Unable to write benchmark log file "<<logFileName<<std::endl;
+			}
+		
+		/* Print timing statistics: */
+		printf("Vrui: Benchmark timings over %u frames after %u warm-up frames, in ms:\n",(unsigned int)(totalTimes.size()),numWarmupFrames);
+		printf("%-8s %10s %10s %10s %10s %10s %10s %10s\n","","mean","min","50%","90%","95%","99%","max");
+		printStatistics("Update",updateTimes);
+		printStatistics("Render",renderTimes);
+		printStatistics("Swap",swapTimes);
+		printStatistics("Total",totalTimes);
+		fflush(stdout);
+		}
+	};
+
 /***********************************
 Workbench-specific global variables:
 ***********************************/
@@ -193,12 +301,15 @@ int vruiNumSoundContexts=0;
 SoundContext** vruiSoundContexts=0;
 Cluster::Multiplexer* vruiMultiplexer=0;
 Cluster::MulticastPipe* vruiPipe=0;
+Cluster::FileCache* vruiFileCache=0;
 int vruiNumSlaves=0;
 pid_t* vruiSlavePids=0;
 int vruiSlaveArgc=0;
 char** vruiSlaveArgv=0;
 char** vruiSlaveArgvShadow=0;
 volatile bool vruiAsynchronousShutdown=false;
+unsigned int vruiBenchmarkNumFrames=0;
+VruiBenchmark* vruiBenchmark=0;
 
 /*****************************************
 Workbench-specific private Vrui functions:
@@ -215,6 +326,50 @@ void vruiTerminate(int)
 
 #endif
 
+/* Creates a node-local cache for blocks of shared files if one is configured: */
+void vruiCreateFileCache(void)
+	{
+	std::string fileCacheDirectory=vruiConfigFile->retrieveString("./fileCacheDirectory",std::string());
+	if(!fileCacheDirectory.empty())
+		{
+		try
+			{
+			size_t blockSize=vruiConfigFile->retrieveValue<unsigned int>("./fileCacheBlockSize",1024U*1024U);
+			vruiFileCache=new Cluster::FileCache(fileCacheDirectory.c_str(),blockSize);
+			Cluster::Opener::getOpener()->setFileCache(vruiFileCache);
+			}
+		catch(const std::runtime_error& err)
+			{
+			/* Continue without a file cache on this node: */
+			std::cerr<<"Vrui (node "<<vruiMultiplexer->getNodeIndex()<<"): Disabling file cache due to exception "<<err.what()<<std::endl;
+			}
+		}
+	}
+
+/* Reports file cache usage and destroys the node-local file cache: */
+void vruiDestroyFileCache(void)
+	{
+	if(vruiFileCache!=0)
+		{
+		/* Unregister the file cache from the Cluster::Opener object: */
+		Cluster::Opener::getOpener()->setFileCache(0);
+		
+		/* Report the file cache's hit rate and network usage: */
+		Cluster::FileCache::Statistics stats=vruiFileCache->getStatistics();
+		if(stats.numBlocks>0&&(vruiMaster||vruiVerbose))
+			{
+			double hitRate=double(stats.numHits)*100.0/double(stats.numBlocks);
+			if(vruiMaster)
+				std::cout<<"Vrui: File cache served "<<stats.numHits<<" of "<<stats.numBlocks<<" blocks ("<<hitRate<<"%) from slave caches; sent "<<stats.numBytesSent<<" of "<<stats.numBytes<<" bytes to slaves"<<std::endl;
+			else
+				std::cout<<"Vrui (node "<<vruiMultiplexer->getNodeIndex()<<"): Found "<<stats.numHits<<" of "<<stats.numBlocks<<" blocks ("<<hitRate<<"%) in local file cache; received "<<stats.numBytesSent<<" of "<<stats.numBytes<<" bytes from master"<<std::endl;
+			}
+		
+		delete vruiFileCache;
+		vruiFileCache=0;
+		}
+	}
+
 /* Generic cleanup function called in case of an error: */
 void vruiErrorShutdown(bool signalError)
 	{
@@ -286,6 +441,7 @@ void vruiErrorShutdown(bool signalError)
 		
 		/* Unregister the multiplexer from the Cluster::Opener object: */
 		Cluster::Opener::getOpener()->setMultiplexer(0);
+		vruiDestroyFileCache();
 		
 		/* Destroy the multiplexer: */
 		delete vruiPipe;
@@ -738,6 +894,7 @@ void init(int& argc,char**& argv,char**&)
 			
 			/* Register Vrui's cluster multiplexer with the Opener object of the Cluster library: */
 			Cluster::Opener::getOpener()->setMultiplexer(vruiMultiplexer);
+			vruiCreateFileCache();
 			}
 		catch(const std::runtime_error& err)
 			{
@@ -825,6 +982,9 @@ void init(int& argc,char**& argv,char**&)
 				std::cout<<"     to the given unit name and scale factor."<<std::endl;
 				std::cout<<"  -loadView <viewpoint file name>"<<std::endl;
 				std::cout<<"     Loads the initial viewing position from the given viewpoint file."<<std::endl;
+				std::cout<<"  -vruiBenchmark <number of frames>"<<std::endl;
+				std::cout<<"     Runs the given number of frames, plus warm-up frames, with a fixed"<<std::endl;
+				std::cout<<"     application time step, prints frame timing statistics, and exits."<<std::endl;
 				
 				/* Remove parameter from argument list: */
 				argc-=1;
@@ -1153,6 +1313,7 @@ void init(int& argc,char**& argv,char**&)
 				
 				/* Register Vrui's cluster multiplexer with the Opener object of the Cluster library: */
 				Cluster::Opener::getOpener()->setMultiplexer(vruiMultiplexer);
+				vruiCreateFileCache();
 				}
 			catch(const std::runtime_error& err)
 				{
@@ -1408,6 +1569,28 @@ void init(int& argc,char**& argv,char**&)
 					--argc;
 					}
 				}
+			else if(strcasecmp(argv[i]+1,"vruiBenchmark")==0)
+				{
+				/* Next parameter is number of frames to benchmark: */
+				if(i+1<argc)
+					{
+					/* Enable benchmark mode: */
+					vruiBenchmarkNumFrames=(unsigned int)(atoi(argv[i+1]));
+					
+					/* Remove parameters from argument list: */
+					argc-=2;
+					for(int j=i;j<argc;++j)
+						argv[j]=argv[j+2];
+					--i;
+					}
+				else
+					{
+					/* Ignore the vruiBenchmark parameter: */
+					if(vruiMaster)
+						std::cerr<<"Vrui: No number of frames given after -vruiBenchmark option"<<std::endl;
+					--argc;
+					}
+				}
 			}
 	
 	if(vruiVerbose&&vruiMaster)
@@ -1907,8 +2090,8 @@ void vruiInnerLoopMultiWindow(void)
 		vruiPrintTime(false);
 		#endif
 		
-		/* Handle all events, blocking if there are none unless in continuous mode: */
-		if(firstFrame||vruiState->updateContinuously)
+		/* Handle all events, blocking if there are none unless in continuous or benchmark mode: */
+		if(firstFrame||vruiState->updateContinuously||vruiBenchmark!=0)
 			{
 			/* Check for and handle events without blocking: */
 			vruiHandleAllEvents(false);
@@ -1936,6 +2119,8 @@ void vruiInnerLoopMultiWindow(void)
 			}
 		
 		/* Update the Vrui state: */
+		if(vruiBenchmark!=0)
+			vruiBenchmark->startFrame();
 		vruiState->update();
 		
 		/* Reset the AL thing manager: */
@@ -1951,6 +2136,9 @@ void vruiInnerLoopMultiWindow(void)
 		vruiPrintTime(false);
 		#endif
 		
+		if(vruiBenchmark!=0)
+			vruiBenchmark->finishUpdate();
+		
 		/* Reset the GL thing manager: */
 		GLContextData::resetThingManager();
 		
@@ -1963,6 +2151,8 @@ void vruiInnerLoopMultiWindow(void)
 			
 			/* Wait until all threads are done rendering: */
 			vruiRenderingBarrier.synchronize();
+			if(vruiBenchmark!=0)
+				vruiBenchmark->finishRender();
 			
 			if(vruiState->multiplexer!=0)
 				{
@@ -1993,6 +2183,18 @@ void vruiInnerLoopMultiWindow(void)
 					wgIt->window->draw();
 				}
 			
+			if(vruiBenchmark!=0)
+				{
+				/* Wait until all windows are done rendering: */
+				for(int i=0;i<vruiNumWindowGroups;++i)
+					for(std::vector<VruiWindowGroup::Window>::iterator wgIt=vruiWindowGroups[i].windows.begin();wgIt!=vruiWindowGroups[i].windows.end();++wgIt)
+						{
+						wgIt->window->makeCurrent();
+						glFinish();
+						}
+				vruiBenchmark->finishRender();
+				}
+			
 			if(vruiState->multiplexer!=0)
 				{
 				/* Synchronize with other nodes: */
@@ -2026,6 +2228,17 @@ void vruiInnerLoopMultiWindow(void)
 			for(int i=0;i<vruiNumWindows;++i)
 				vruiWindows[i]->draw();
 			
+			if(vruiBenchmark!=0)
+				{
+				/* Wait until all windows are done rendering: */
+				for(int i=0;i<vruiNumWindows;++i)
+					{
+					vruiWindows[i]->makeCurrent();
+					glFinish();
+					}
+				vruiBenchmark->finishRender();
+				}
+			
 			if(vruiState->multiplexer!=0)
 				{
 				/* Synchronize with other nodes: */
@@ -2048,19 +2261,29 @@ void vruiInnerLoopMultiWindow(void)
 			vruiPrintTime(true);
 			#endif
 			}
-		else if(vruiState->multiplexer!=0)
+		else
 			{
-			/* Synchronize with other nodes: */
-			vruiState->pipe->barrier();
+			if(vruiBenchmark!=0)
+				vruiBenchmark->finishRender();
 			
-			#if VRUI_INSTRUMENT_MAINLOOP
-			vruiPrintTime(false);
-			vruiPrintTime(true);
-			#endif
+			if(vruiState->multiplexer!=0)
+				{
+				/* Synchronize with other nodes: */
+				vruiState->pipe->barrier();
+				
+				#if VRUI_INSTRUMENT_MAINLOOP
+				vruiPrintTime(false);
+				vruiPrintTime(true);
+				#endif
+				}
 			}
 		
+		/* Check if the benchmark is complete: */
+		if(vruiBenchmark!=0&&vruiBenchmark->finishFrame())
+			keepRunning=false;
+		
 		/* Print current frame rate on head node's console for window-less Vrui processes: */
-		if(vruiNumWindows==0&&vruiMaster)
+		if(vruiNumWindows==0&&vruiMaster&&vruiBenchmark==0)
 			{
 			++numFrames;
 			Realtime::TimePointMonotonic now;
@@ -2075,7 +2298,7 @@ void vruiInnerLoopMultiWindow(void)
 		
 		firstFrame=false;
 		}
-	if(vruiNumWindows==0&&vruiMaster)
+	if(vruiNumWindows==0&&vruiMaster&&vruiBenchmark==0)
 		{
 		printf("\n");
 		fflush(stdout);
@@ -2096,8 +2319,8 @@ void vruiInnerLoopSingleWindow(void)
 		vruiPrintTime(false);
 		#endif
 		
-		/* Handle all events, blocking if there are none unless in continuous mode: */
-		if(firstFrame||vruiState->updateContinuously)
+		/* Handle all events, blocking if there are none unless in continuous or benchmark mode: */
+		if(firstFrame||vruiState->updateContinuously||vruiBenchmark!=0)
 			{
 			/* Check for and handle events without blocking: */
 			vruiHandleAllEvents(false);
@@ -2125,6 +2348,8 @@ void vruiInnerLoopSingleWindow(void)
 			}
 		
 		/* Update the Vrui state: */
+		if(vruiBenchmark!=0)
+			vruiBenchmark->startFrame();
 		vruiState->update();
 		
 		/* Reset the AL thing manager: */
@@ -2140,12 +2365,22 @@ void vruiInnerLoopSingleWindow(void)
 		vruiPrintTime(false);
 		#endif
 		
+		if(vruiBenchmark!=0)
+			vruiBenchmark->finishUpdate();
+		
 		/* Reset the GL thing manager: */
 		GLContextData::resetThingManager();
 		
 		/* Update rendering: */
 		vruiWindows[0]->draw();
 		
+		if(vruiBenchmark!=0)
+			{
+			/* Wait until the window is done rendering: */
+			glFinish();
+			vruiBenchmark->finishRender();
+			}
+		
 		if(vruiState->multiplexer!=0)
 			{
 			/* Synchronize with other nodes: */
@@ -2164,6 +2399,10 @@ void vruiInnerLoopSingleWindow(void)
 		vruiPrintTime(true);
 		#endif
 		
+		/* Check if the benchmark is complete: */
+		if(vruiBenchmark!=0&&vruiBenchmark->finishFrame())
+			keepRunning=false;
+		
 		firstFrame=false;
 		}
 	}
@@ -2208,6 +2447,15 @@ void mainLoop(void)
 	if(vruiVerbose&&vruiMaster)
 		std::cout<<" Ok"<<std::endl;
 	
+	/* Check if the main loop is to run in benchmark mode: */
+	if(vruiBenchmarkNumFrames==0)
+		vruiBenchmarkNumFrames=vruiConfigFile->retrieveValue<unsigned int>("./benchmarkNumFrames",0);
+	if(vruiBenchmarkNumFrames>0&&vruiMaster)
+		{
+		vruiBenchmark=new VruiBenchmark(vruiConfigFile->getCurrentSection(),vruiBenchmarkNumFrames);
+		std::cout<<"Vrui: Running benchmark for "<<vruiBenchmark->numWarmupFrames<<" + "<<vruiBenchmark->numFrames<<" frames"<<std::endl;
+		}
+	
 	/* Construct the set of file descriptors to watch for events: */
 	vruiReadFdSet.add(vruiEventPipe[0]);
 	for(int i=0;i<vruiNumWindowGroups;++i)
@@ -2245,13 +2493,21 @@ void mainLoop(void)
 	/* Perform the main loop until the quit command is entered: */
 	if(vruiVerbose&&vruiMaster)
 		std::cout<<"Vrui: Entering main loop"<<std::endl;
-	if(vruiMaster&&vruiNumWindows==0)
+	if(vruiMaster&&vruiNumWindows==0&&vruiBenchmark==0)
 		std::cout<<"Vrui: Enter \"quit\" to exit from main loop..."<<std::endl;
 	if(vruiNumWindows!=1)
 		vruiInnerLoopMultiWindow();
 	else
 		vruiInnerLoopSingleWindow();
 	
+	if(vruiBenchmark!=0)
+		{
+		/* Report the benchmark results: */
+		vruiBenchmark->writeResults();
+		delete vruiBenchmark;
+		vruiBenchmark=0;
+		}
+	
 	/* Perform first clean-up steps: */
 	if(vruiVerbose&&vruiMaster)
 		std::cout<<"Vrui: Exiting main loop..."<<std::flush;
@@ -2334,6 +2590,7 @@ void deinit(void)
 		
 		/* Unregister the multiplexer from the Cluster::Opener object: */
 		Cluster::Opener::getOpener()->setMultiplexer(0);
+		vruiDestroyFileCache();
 		
 		/* Destroy the multiplexer: */
 		if(vruiVerbose&&vruiMaster)
@@ -57,6 +57,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/GlyphRenderer.h>
 #include <Vrui/WindowProperties.h>
 #include <Vrui/DisplayState.h>
+#include <Vrui/TransparentObject.h>
 #include <Vrui/ToolManager.h>
 
 /* Forward declarations: */
@@ -127,6 +128,7 @@ struct VruiState
 			public:
 			DisplayState displayState; // The display state object
 			GLuint screenProtectorDisplayListId; // ID of display list to render screen protector grids
+			TransparentObject::SortState transparentSortState; // Back-to-front order of transparent objects in this context
 			
 			/* Constructors and destructors: */
 			DataItem(void);
@@ -259,7 +259,7 @@ void SceneGraphManager::updateDeviceNode(InputDevice* device,SceneGraph::GraphNo
 	DeviceSceneGraphMap::Iterator dsgmIt=deviceSceneGraphMap.findEntry(device);
 	if(!dsgmIt.isFinished())
 		{
-		DeviceSceneGraph& dsg=deviceSceneGraphMap.getEntry(device).getDest();
+		DeviceSceneGraph& dsg=dsgmIt->getDest();
 		
 		/* Notify the device scene graph root node of a child's update and cascade the update to the physical-space root if necessary: */
 		unsigned int devUpdateResult=dsg.root->cascadingUpdate(node,updateReason);
@@ -274,7 +274,7 @@ void SceneGraphManager::removeDeviceNode(InputDevice* device,SceneGraph::GraphNo
 	DeviceSceneGraphMap::Iterator dsgmIt=deviceSceneGraphMap.findEntry(device);
 	if(!dsgmIt.isFinished())
 		{
-		DeviceSceneGraph& dsg=deviceSceneGraphMap.getEntry(device).getDest();
+		DeviceSceneGraph& dsg=dsgmIt->getDest();
 		
 		/* Remove the given node from the device scene graph root: */
 		unsigned int devUpdateResult=dsg.root->removeChild(node);
@@ -62,6 +62,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/Internal/ToolKillZone.h>
 #include <Vrui/Internal/ToolKillZoneBox.h>
 #include <Vrui/Internal/ToolKillZoneFrustum.h>
+#include <Vrui/Internal/PluginPreloader.h>
 #include <Vrui/Internal/Config.h>
 
 namespace {
@@ -674,7 +675,8 @@ ToolManager::ToolManager(InputDeviceManager* sInputDeviceManager,const Misc::Con
 	 configFileSection(new Misc::ConfigurationFileSection(sConfigFileSection)),
 	 toolCreationDevice(0),toolCreationTool(0),
 	 toolMenuPopup(0),toolMenu(0),toolCreationState(0),callCreatedToolFrame(false),
-	 toolKillZone(0)
+	 toolKillZone(0),
+	 preloader(0)
 	{
 	typedef std::vector<std::string> StringList;
 	
@@ -750,10 +752,35 @@ ToolManager::ToolManager(InputDeviceManager* sInputDeviceManager,const Misc::Con
 		toolKillZone=new ToolKillZoneFrustum(*configFileSection);
 	else
 		Misc::throwStdErr("ToolManager: Unknown kill zone type \"%s\"",killZoneType.c_str());
+	
+	/* Start loading the DSOs of not-yet-loaded tool classes in the background: */
+	StringList preloadToolClassNames=configFileSection->retrieveValue<StringList>("./preloadToolClassNames",StringList());
+	if(!preloadToolClassNames.empty())
+		{
+		unsigned int preloadClassesPerFrame=configFileSection->retrieveValue<unsigned int>("./preloadClassesPerFrame",1U);
+		preloader=new PluginPreloader("ToolManager",Misc::createFunctionCall<const char*,ToolManager>(this,&ToolManager::addClass),preloadClassesPerFrame);
+		for(StringList::const_iterator ptcnIt=preloadToolClassNames.begin();ptcnIt!=preloadToolClassNames.end();++ptcnIt)
+			if(getFactory(ptcnIt->c_str())==0)
+				{
+				try
+					{
+					preloader->addClass(ptcnIt->c_str(),locateDso(ptcnIt->c_str()));
+					}
+				catch(const std::runtime_error& err)
+					{
+					/* Print a warning and carry on: */
+					Misc::formattedConsoleWarning("Vrui::ToolManager: Not preloading tool class %s due to exception %s",ptcnIt->c_str(),err.what());
+					}
+				}
+		preloader->start();
+		}
 	}
 
 ToolManager::~ToolManager(void)
 	{
+	/* Stop preloading tool classes: */
+	delete preloader;
+	
 	/* Destroy the tool kill zone: */
 	delete toolKillZone;
 	
@@ -1210,6 +1237,17 @@ void ToolManager::destroyTool(Tool* tool,bool destroyImmediately)
 
 void ToolManager::update(void)
 	{
+	/* Initialize the next slice of preloaded tool classes; cluster nodes must stay in lock-step: */
+	if(preloader!=0)
+		{
+		preloader->initializeSlice(getClusterMultiplexer()!=0);
+		if(preloader->isFinished())
+			{
+			delete preloader;
+			preloader=0;
+			}
+		}
+	
 	/* Process the tool management queue: */
 	for(ToolManagementQueue::iterator tmqIt=toolManagementQueue.begin();tmqIt!=toolManagementQueue.end();++tmqIt)
 		{
@@ -52,6 +52,7 @@ class MenuTool;
 class MutexMenu;
 class ToolKillZone;
 class ToolManagerToolCreationState;
+class PluginPreloader;
 }
 
 namespace Vrui {
@@ -134,6 +135,9 @@ class ToolManager:public Plugins::FactoryManager<ToolFactory>
 	ToolKillZone* toolKillZone; // Pointer to tool "kill zone"
 	Misc::CallbackList toolDestructionCallbacks; // List of callbacks to be called before a tool will be destroyed
 	
+	/* Tool class preloading state: */
+	PluginPreloader* preloader; // Helper to load tool class DSOs in the background and initialize their classes during update; null if nothing is preloaded
+	
 	/* Private methods: */
 	GLMotif::PopupMenu* createToolSubmenu(const Plugins::Factory& factory); // Returns submenu containing all subclasses of the given class
 	GLMotif::PopupMenu* createToolMenu(void); // Returns top level of tool selection menu
@@ -503,6 +503,26 @@ void JediTool::initContext(GLContextData& contextData) const
 	glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
 	}
 
+bool JediTool::getTransparentBounds(Point& center,Scalar& radius) const
+	{
+	/* Calculate the end points of the blade billboards on the previous and current frames: */
+	Point ends[4];
+	for(int i=0;i<2;++i)
+		{
+		ends[2*i]=origin[i]-axis[i]*(factory->baseOffset*scaleFactor);
+		ends[2*i+1]=ends[2*i]+axis[i]*(length[i]*scaleFactor);
+		}
+	
+	/* Bound the end points, and add the billboards' half width: */
+	center=Geometry::mid(Geometry::mid(ends[0],ends[1]),Geometry::mid(ends[2],ends[3]));
+	radius=Scalar(0);
+	for(int i=0;i<4;++i)
+		radius=Math::max(radius,Geometry::dist(center,ends[i]));
+	radius+=Math::div2(factory->lightsaberWidth*scaleFactor);
+	
+	return true;
+	}
+
 void JediTool::glRenderActionTransparent(GLContextData& contextData) const
 	{
 	if(active)
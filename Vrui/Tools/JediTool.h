@@ -138,6 +138,7 @@ class JediTool:public PointingTool,public GLObject,public TransparentObject,publ
 	virtual void initContext(GLContextData& contextData) const;
 	
 	/* Methods from TransparentObject: */
+	virtual bool getTransparentBounds(Point& center,Scalar& radius) const;
 	virtual void glRenderActionTransparent(GLContextData& contextData) const;
 	
 	/* Methods from class ALObject: */
@@ -22,6 +22,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Vrui/Tools/SketchingTool.h>
 
+#include <algorithm>
 #include <Misc/SelfDestructArray.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
@@ -35,6 +36,10 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <GL/GLColorTemplates.h>
 #include <GL/GLValueCoders.h>
 #include <GL/GLGeometryWrappers.h>
+#include <GL/GLContextData.h>
+#include <GL/GLVertexArrayParts.h>
+#include <GL/Extensions/GLARBVertexBufferObject.h>
+#include <GL/Extensions/GLEXTMultiDrawArrays.h>
 #include <GLMotif/StyleSheet.h>
 #include <GLMotif/WidgetManager.h>
 #include <GLMotif/PopupWindow.h>
@@ -512,6 +517,120 @@ void SketchingTool::BrushStroke::resetGLState(GLContextData& contextData)
 	glPopAttrib();
 	}
 
+/*************************************
+Methods of class SketchingTool::Batch:
+*************************************/
+
+template <class VertexParam>
+void SketchingTool::Batch<VertexParam>::add(SketchingTool::SketchObject* object,GLfloat drawListLineWidth,const std::vector<VertexParam>& objectVertices)
+	{
+	/* Find the draw list for the given line width, or create a new one: */
+	unsigned int drawListIndex;
+	for(drawListIndex=0;drawListIndex<drawLists.size()&&drawLists[drawListIndex].lineWidth!=drawListLineWidth;++drawListIndex)
+		;
+	if(drawListIndex==drawLists.size())
+		drawLists.push_back(DrawList(drawListLineWidth));
+	DrawList& dl=drawLists[drawListIndex];
+	
+	/* Append the object to the draw list: */
+	object->drawListIndex=int(drawListIndex);
+	object->drawIndex=dl.objects.size();
+	dl.firsts.push_back(GLint(vertices.size()));
+	dl.counts.push_back(GLsizei(objectVertices.size()));
+	dl.objects.push_back(object);
+	
+	/* Append the object's vertices to the shared vertex array: */
+	vertices.insert(vertices.end(),objectVertices.begin(),objectVertices.end());
+	}
+
+template <class VertexParam>
+void SketchingTool::Batch<VertexParam>::remove(SketchingTool::SketchObject* object)
+	{
+	if(object->drawListIndex<0)
+		return;
+	
+	/* Remove the object from its draw list by moving the list's last object into its place: */
+	DrawList& dl=drawLists[object->drawListIndex];
+	unsigned int index=object->drawIndex;
+	numStaleVertices+=dl.counts[index];
+	dl.firsts[index]=dl.firsts.back();
+	dl.firsts.pop_back();
+	dl.counts[index]=dl.counts.back();
+	dl.counts.pop_back();
+	dl.objects[index]=dl.objects.back();
+	dl.objects.pop_back();
+	if(index<dl.objects.size())
+		dl.objects[index]->drawIndex=index;
+	object->drawListIndex=-1;
+	
+	/* Check if the vertex array needs to be compacted: */
+	size_t numLiveVertices=vertices.size()-numStaleVertices;
+	if(numLiveVertices==0)
+		{
+		/* Drop all vertices: */
+		vertices.clear();
+		numStaleVertices=0;
+		++version;
+		}
+	else if(numStaleVertices>=65536&&numStaleVertices>numLiveVertices)
+		{
+		/* Copy the vertices of all remaining objects into a new vertex array: */
+		std::vector<VertexParam> newVertices;
+		newVertices.reserve(numLiveVertices);
+		for(typename std::vector<DrawList>::iterator dlIt=drawLists.begin();dlIt!=drawLists.end();++dlIt)
+			for(size_t i=0;i<dlIt->objects.size();++i)
+				{
+				GLint newFirst=GLint(newVertices.size());
+				newVertices.insert(newVertices.end(),vertices.begin()+dlIt->firsts[i],vertices.begin()+(dlIt->firsts[i]+dlIt->counts[i]));
+				dlIt->firsts[i]=newFirst;
+				}
+		vertices.swap(newVertices);
+		numStaleVertices=0;
+		++version;
+		}
+	}
+
+template <class VertexParam>
+void SketchingTool::Batch<VertexParam>::clear(void)
+	{
+	vertices.clear();
+	numStaleVertices=0;
+	++version;
+	drawLists.clear();
+	}
+
+/****************************************
+Methods of class SketchingTool::DataItem:
+****************************************/
+
+SketchingTool::DataItem::DataItem(void)
+	:haveVertexBuffers(GLARBVertexBufferObject::isSupported()),
+	 haveMultiDraw(GLEXTMultiDrawArrays::isSupported())
+	{
+	for(int i=0;i<2;++i)
+		{
+		vertexBufferIds[i]=0;
+		bufferSizes[i]=0;
+		numUploadedVertices[i]=0;
+		bufferVersions[i]=0;
+		}
+	
+	/* Initialize the required OpenGL extensions: */
+	if(haveVertexBuffers)
+		{
+		GLARBVertexBufferObject::initExtension();
+		glGenBuffersARB(2,vertexBufferIds);
+		}
+	if(haveMultiDraw)
+		GLEXTMultiDrawArrays::initExtension();
+	}
+
+SketchingTool::DataItem::~DataItem(void)
+	{
+	if(haveVertexBuffers)
+		glDeleteBuffersARB(2,vertexBufferIds);
+	}
+
 /**************************************
 Static elements of class SketchingTool:
 **************************************/
@@ -529,12 +648,187 @@ const SketchingTool::Color SketchingTool::colors[8]=
 Methods of class SketchingTool:
 ******************************/
 
+void SketchingTool::finishCurve(SketchingTool::Curve* curve)
+	{
+	/* Append the final control point to the curve's bounding box: */
+	curve->boundingBox.addPoint(curve->controlPoints.back().pos);
+	
+	/* Enter the curve's control points into the spatial index and create its vertices: */
+	std::vector<CurveVertex> vertices;
+	vertices.reserve(curve->controlPoints.size());
+	for(std::vector<Curve::ControlPoint>::const_iterator cpIt=curve->controlPoints.begin();cpIt!=curve->controlPoints.end();++cpIt)
+		{
+		controlPointGrid.insert(cpIt->pos,curve);
+		vertices.push_back(CurveVertex(curve->color,CurveVertex::Position(cpIt->pos)));
+		}
+	
+	/* Add the curve to the curve batch: */
+	curveBatch.add(curve,curve->lineWidth,vertices);
+	}
+
+void SketchingTool::finishBrushStroke(SketchingTool::BrushStroke* brushStroke)
+	{
+	/* Append the final control point to the brush stroke's bounding box: */
+	const BrushStroke::ControlPoint& last=brushStroke->controlPoints.back();
+	brushStroke->boundingBox.addPoint(last.pos+last.brushAxis);
+	brushStroke->boundingBox.addPoint(last.pos-last.brushAxis);
+	
+	/* Enter the brush stroke's control points into the spatial index and create its quad strip vertices: */
+	BrushStrokeVertex::Color color(brushStroke->color);
+	std::vector<BrushStrokeVertex> vertices;
+	vertices.reserve(brushStroke->controlPoints.size()*2);
+	for(std::vector<BrushStroke::ControlPoint>::const_iterator cpIt=brushStroke->controlPoints.begin();cpIt!=brushStroke->controlPoints.end();++cpIt)
+		{
+		controlPointGrid.insert(cpIt->pos,brushStroke);
+		BrushStrokeVertex::Normal normal(cpIt->normal);
+		vertices.push_back(BrushStrokeVertex(color,normal,BrushStrokeVertex::Position(cpIt->pos+cpIt->brushAxis)));
+		vertices.push_back(BrushStrokeVertex(color,normal,BrushStrokeVertex::Position(cpIt->pos-cpIt->brushAxis)));
+		}
+	
+	/* Add the brush stroke to the brush stroke batch; brush strokes ignore line width: */
+	brushStrokeBatch.add(brushStroke,0.0f,vertices);
+	}
+
+void SketchingTool::finishCurrentObjects(void)
+	{
+	if(currentCurve!=0)
+		finishCurve(currentCurve);
+	currentCurve=0;
+	currentPolyline=0;
+	if(currentBrushStroke!=0)
+		finishBrushStroke(currentBrushStroke);
+	currentBrushStroke=0;
+	}
+
+void SketchingTool::deleteCurve(SketchingTool::Curve* curve)
+	{
+	/* Remove the curve's control points from the spatial index: */
+	for(std::vector<Curve::ControlPoint>::const_iterator cpIt=curve->controlPoints.begin();cpIt!=curve->controlPoints.end();++cpIt)
+		controlPointGrid.remove(cpIt->pos,curve);
+	
+	/* Remove the curve from the curve batch: */
+	curveBatch.remove(curve);
+	
+	/* Remove the curve from the curve list: */
+	std::vector<Curve*>::iterator cIt=std::find(curves.begin(),curves.end(),curve);
+	*cIt=curves.back();
+	curves.pop_back();
+	
+	delete curve;
+	}
+
+void SketchingTool::deleteBrushStroke(SketchingTool::BrushStroke* brushStroke)
+	{
+	/* Remove the brush stroke's control points from the spatial index: */
+	for(std::vector<BrushStroke::ControlPoint>::const_iterator cpIt=brushStroke->controlPoints.begin();cpIt!=brushStroke->controlPoints.end();++cpIt)
+		controlPointGrid.remove(cpIt->pos,brushStroke);
+	
+	/* Remove the brush stroke from the brush stroke batch: */
+	brushStrokeBatch.remove(brushStroke);
+	
+	/* Remove the brush stroke from the brush stroke list: */
+	std::vector<BrushStroke*>::iterator bsIt=std::find(brushStrokes.begin(),brushStrokes.end(),brushStroke);
+	*bsIt=brushStrokes.back();
+	brushStrokes.pop_back();
+	
+	delete brushStroke;
+	}
+
+void SketchingTool::deleteAllSketchObjects(void)
+	{
+	/* Delete all sketching objects: */
+	for(std::vector<Curve*>::iterator cIt=curves.begin();cIt!=curves.end();++cIt)
+		delete *cIt;
+	curves.clear();
+	for(std::vector<Polyline*>::iterator pIt=polylines.begin();pIt!=polylines.end();++pIt)
+		delete *pIt;
+	polylines.clear();
+	for(std::vector<BrushStroke*>::iterator bsIt=brushStrokes.begin();bsIt!=brushStrokes.end();++bsIt)
+		delete *bsIt;
+	brushStrokes.clear();
+	
+	/* Clear the spatial index and the batches: */
+	controlPointGrid.clear();
+	curveBatch.clear();
+	brushStrokeBatch.clear();
+	}
+
+template <class VertexParam>
+void SketchingTool::renderBatch(const SketchingTool::Batch<VertexParam>& batch,GLenum primitive,bool setLineWidths,SketchingTool::DataItem* dataItem,int bufferIndex)
+	{
+	if(batch.vertices.empty())
+		return;
+	
+	GLVertexArrayParts::enable(VertexParam::getPartsMask());
+	
+	if(dataItem->haveVertexBuffers)
+		{
+		/* Bind the batch's vertex buffer: */
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->vertexBufferIds[bufferIndex]);
+		
+		/* Check if the vertex buffer is outdated: */
+		size_t numVertices=batch.vertices.size();
+		if(dataItem->bufferVersions[bufferIndex]!=batch.version||numVertices>dataItem->bufferSizes[bufferIndex])
+			{
+			/* Grow the vertex buffer if it is too small: */
+			if(numVertices>dataItem->bufferSizes[bufferIndex])
+				{
+				dataItem->bufferSizes[bufferIndex]=numVertices*2;
+				glBufferDataARB(GL_ARRAY_BUFFER_ARB,dataItem->bufferSizes[bufferIndex]*sizeof(VertexParam),0,GL_DYNAMIC_DRAW_ARB);
+				}
+			
+			/* Upload all vertices: */
+			glBufferSubDataARB(GL_ARRAY_BUFFER_ARB,0,numVertices*sizeof(VertexParam),&batch.vertices[0]);
+			}
+		else if(numVertices>dataItem->numUploadedVertices[bufferIndex])
+			{
+			/* Upload only the vertices of objects that were added since the last upload: */
+			size_t first=dataItem->numUploadedVertices[bufferIndex];
+			glBufferSubDataARB(GL_ARRAY_BUFFER_ARB,first*sizeof(VertexParam),(numVertices-first)*sizeof(VertexParam),&batch.vertices[first]);
+			}
+		dataItem->numUploadedVertices[bufferIndex]=numVertices;
+		dataItem->bufferVersions[bufferIndex]=batch.version;
+		
+		glVertexPointer(static_cast<const VertexParam*>(0));
+		}
+	else
+		{
+		/* Render directly from the batch's vertex array: */
+		glVertexPointer(&batch.vertices[0]);
+		}
+	
+	/* Render all draw lists: */
+	for(typename std::vector<DrawList>::const_iterator dlIt=batch.drawLists.begin();dlIt!=batch.drawLists.end();++dlIt)
+		if(!dlIt->objects.empty())
+			{
+			if(setLineWidths)
+				glLineWidth(dlIt->lineWidth);
+			if(dataItem->haveMultiDraw)
+				glMultiDrawArraysEXT(primitive,&dlIt->firsts[0],&dlIt->counts[0],GLsizei(dlIt->firsts.size()));
+			else
+				{
+				for(size_t i=0;i<dlIt->firsts.size();++i)
+					glDrawArrays(primitive,dlIt->firsts[i],dlIt->counts[i]);
+				}
+			}
+	
+	if(dataItem->haveVertexBuffers)
+		{
+		/* Protect the vertex buffer: */
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+		}
+	
+	GLVertexArrayParts::disable(VertexParam::getPartsMask());
+	}
+
 SketchingTool::SketchingTool(const ToolFactory* sFactory,const ToolInputAssignment& inputAssignment)
 	:UtilityTool(sFactory,inputAssignment),
+	 GLObject(false),
 	 controlDialogPopup(0),colorBox(0),
 	 sketchMode(CURVE),newLineWidth(3.0f),newColor(255,0,0),
 	 active(false),
-	 currentCurve(0),currentPolyline(0),currentBrushStroke(0)
+	 currentCurve(0),currentPolyline(0),currentBrushStroke(0),
+	 controlPointGrid(getPointPickDistance()*Scalar(2))
 	{
 	/* Get the style sheet: */
 	const GLMotif::StyleSheet* ss=getWidgetManager()->getStyleSheet();
@@ -616,6 +910,8 @@ SketchingTool::SketchingTool(const ToolFactory* sFactory,const ToolInputAssignme
 	
 	/* Pop up the control dialog: */
 	popupPrimaryWidget(controlDialogPopup);
+	
+	GLObject::init();
 	}
 
 SketchingTool::~SketchingTool(void)
@@ -623,12 +919,7 @@ SketchingTool::~SketchingTool(void)
 	delete controlDialogPopup;
 	
 	/* Delete all sketching objects: */
-	for(std::vector<Curve*>::iterator cIt=curves.begin();cIt!=curves.end();++cIt)
-		delete *cIt;
-	for(std::vector<Polyline*>::iterator pIt=polylines.begin();pIt!=polylines.end();++pIt)
-		delete *pIt;
-	for(std::vector<BrushStroke*>::iterator bsIt=brushStrokes.begin();bsIt!=brushStrokes.end();++bsIt)
-		delete *bsIt;
+	deleteAllSketchObjects();
 	}
 
 void SketchingTool::configure(const Misc::ConfigurationFileSection& configFileSection)
@@ -745,34 +1036,30 @@ void SketchingTool::buttonCallback(int,InputDevice::ButtonCallbackData* cbData)
 		switch(sketchMode)
 			{
 			case CURVE:
-				{
-				/* Append the final control point to the curve's bounding box: */
-				currentCurve->boundingBox.addPoint(currentCurve->controlPoints.back().pos);
-				
 				/* Finish the curve: */
+				if(currentCurve!=0)
+					finishCurve(currentCurve);
 				currentCurve=0;
 				break;
-				}
 			
 			case POLYLINE:
-				/* Add the final vertex to the polyline's bounding box: */
-				currentPolyline->boundingBox.addPoint(currentPolyline->vertices.back());
-				
-				/* Finish the polyline if the final vertex is the first vertex: */
-				if(currentPolyline->vertices.size()>1&&currentPolyline->vertices.front()==currentPolyline->vertices.back())
-					currentPolyline=0;
+				if(currentPolyline!=0)
+					{
+					/* Add the final vertex to the polyline's bounding box: */
+					currentPolyline->boundingBox.addPoint(currentPolyline->vertices.back());
+					
+					/* Finish the polyline if the final vertex is the first vertex: */
+					if(currentPolyline->vertices.size()>1&&currentPolyline->vertices.front()==currentPolyline->vertices.back())
+						currentPolyline=0;
+					}
 				break;
 			
 			case BRUSHSTROKE:
-				{
-				/* Append the final control point to the brush stroke's bounding box: */
-				currentBrushStroke->boundingBox.addPoint(currentBrushStroke->controlPoints.back().pos+currentBrushStroke->controlPoints.back().brushAxis);
-				currentBrushStroke->boundingBox.addPoint(currentBrushStroke->controlPoints.back().pos-currentBrushStroke->controlPoints.back().brushAxis);
-				
 				/* Finish the brush stroke: */
+				if(currentBrushStroke!=0)
+					finishBrushStroke(currentBrushStroke);
 				currentBrushStroke=0;
 				break;
-				}
 			
 			case ERASER:
 				break;
@@ -859,18 +1146,29 @@ void SketchingTool::frame(void)
 		if(currentCurve==0&&currentPolyline==0&&currentBrushStroke==0&&sketchMode==ERASER)
 			{
 			/* Delete all sketching objects inside the eraser's influence area: */
-			Scalar radius2=Math::sqr(getPointPickDistance());
+			Scalar radius=getPointPickDistance();
+			Scalar radius2=Math::sqr(radius);
 			
-			/* Check all sketching objects: */
-			for(std::vector<Curve*>::iterator cIt=curves.begin();cIt!=curves.end();++cIt)
-				if((*cIt)->pick(currentPoint,radius2))
-					{
-					/* Delete the curve: */
-					delete *cIt;
-					*cIt=curves.back();
-					curves.pop_back();
-					--cIt;
-					}
+			/* Adapt the spatial index's cell size if the eraser's size changed significantly due to navigation: */
+			Scalar cellSize=controlPointGrid.getCellSize();
+			if(controlPointGrid.getNumEntries()==0||radius>cellSize*Scalar(4)||radius*Scalar(8)<cellSize)
+				controlPointGrid.setCellSize(radius*Scalar(2));
+			
+			/* Find all curves and brush strokes that have control points inside the eraser's influence area: */
+			SketchObjectCollector collector;
+			controlPointGrid.processPointsInSphere(currentPoint,radius,collector);
+			std::sort(collector.objects.begin(),collector.objects.end());
+			std::vector<SketchObject*>::iterator end=std::unique(collector.objects.begin(),collector.objects.end());
+			for(std::vector<SketchObject*>::iterator soIt=collector.objects.begin();soIt!=end;++soIt)
+				{
+				Curve* c=dynamic_cast<Curve*>(*soIt);
+				if(c!=0)
+					deleteCurve(c);
+				else
+					deleteBrushStroke(static_cast<BrushStroke*>(*soIt));
+				}
+			
+			/* Check all polylines: */
 			for(std::vector<Polyline*>::iterator pIt=polylines.begin();pIt!=polylines.end();++pIt)
 				if((*pIt)->pick(currentPoint,radius2))
 					{
@@ -880,28 +1178,23 @@ void SketchingTool::frame(void)
 					polylines.pop_back();
 					--pIt;
 					}
-			for(std::vector<BrushStroke*>::iterator bsIt=brushStrokes.begin();bsIt!=brushStrokes.end();++bsIt)
-				if((*bsIt)->pick(currentPoint,radius2))
-					{
-					/* Delete the brush stroke: */
-					delete *bsIt;
-					*bsIt=brushStrokes.back();
-					brushStrokes.pop_back();
-					--bsIt;
-					}
 			}
 		}
 	}
 
 void SketchingTool::display(GLContextData& contextData) const
 	{
+	/* Get the context data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	
 	/* Go to navigational coordinates: */
 	goToNavigationalSpace(contextData);
 	
-	/* Render all sketching objects: */
+	/* Render all finished curves from the curve batch, and the current curve directly: */
 	Curve::setGLState(contextData);
-	for(std::vector<Curve*>::const_iterator cIt=curves.begin();cIt!=curves.end();++cIt)
-		(*cIt)->glRenderAction(contextData);
+	renderBatch(curveBatch,GL_LINE_STRIP,true,dataItem,0);
+	if(currentCurve!=0)
+		currentCurve->glRenderAction(contextData);
 	Curve::resetGLState(contextData);
 	
 	Polyline::setGLState(contextData);
@@ -909,9 +1202,11 @@ void SketchingTool::display(GLContextData& contextData) const
 		(*pIt)->glRenderAction(contextData);
 	Polyline::resetGLState(contextData);
 	
+	/* Render all finished brush strokes from the brush stroke batch, and the current brush stroke directly: */
 	BrushStroke::setGLState(contextData);
-	for(std::vector<BrushStroke*>::const_iterator bsIt=brushStrokes.begin();bsIt!=brushStrokes.end();++bsIt)
-		(*bsIt)->glRenderAction(contextData);
+	renderBatch(brushStrokeBatch,GL_QUAD_STRIP,false,dataItem,1);
+	if(currentBrushStroke!=0)
+		currentBrushStroke->glRenderAction(contextData);
 	BrushStroke::resetGLState(contextData);
 	
 	/* Go back to physical coordinates: */
@@ -936,12 +1231,18 @@ void SketchingTool::display(GLContextData& contextData) const
 		}
 	}
 
+void SketchingTool::initContext(GLContextData& contextData) const
+	{
+	/* Create a new data item and associate it with this object: */
+	DataItem* dataItem=new DataItem;
+	contextData.addDataItem(this,dataItem);
+	}
+
 void SketchingTool::sketchModeCallback(GLMotif::RadioBox::ValueChangedCallbackData* cbData)
 	{
 	/* Deactivate the tool just in case: */
 	active=false;
-	currentCurve=0;
-	currentPolyline=0;
+	finishCurrentObjects();
 	
 	/* Set the new sketch object type: */
 	switch(cbData->radioBox->getToggleIndex(cbData->newSelectedToggle))
@@ -1050,15 +1351,19 @@ void SketchingTool::loadCurvesCallback(GLMotif::FileSelectionDialog::OKCallbackD
 			newSketchObjects.back()->read(curvesSource);
 			}
 		
-		/* Distribute the new sketching objects to the per-type lists: */
-		curves.clear();
-		polylines.clear();
-		brushStrokes.clear();
+		/* Replace the current sketching objects: */
+		deleteAllSketchObjects();
+		
+		/* Distribute the new sketching objects to the per-type lists and enter them into the spatial index and batches: */
 		for(std::vector<SketchObject*>::iterator soIt=newSketchObjects.begin();soIt!=newSketchObjects.end();++soIt)
 			{
 			Curve* c=dynamic_cast<Curve*>(*soIt);
 			if(c!=0)
+				{
 				curves.push_back(c);
+				if(!c->controlPoints.empty())
+					finishCurve(c);
+				}
 			
 			Polyline* p=dynamic_cast<Polyline*>(*soIt);
 			if(p!=0)
@@ -1066,7 +1371,11 @@ void SketchingTool::loadCurvesCallback(GLMotif::FileSelectionDialog::OKCallbackD
 			
 			BrushStroke* bs=dynamic_cast<BrushStroke*>(*soIt);
 			if(bs!=0)
+				{
 				brushStrokes.push_back(bs);
+				if(!bs->controlPoints.empty())
+					finishBrushStroke(bs);
+				}
 			}
 		}
 	catch(const std::runtime_error& err)
@@ -1089,15 +1398,7 @@ void SketchingTool::deleteAllCurvesCallback(Misc::CallbackData* cbData)
 	currentBrushStroke=0;
 	
 	/* Delete all sketching objects: */
-	for(std::vector<Curve*>::iterator cIt=curves.begin();cIt!=curves.end();++cIt)
-		delete *cIt;
-	curves.clear();
-	for(std::vector<Polyline*>::iterator pIt=polylines.begin();pIt!=polylines.end();++pIt)
-		delete *pIt;
-	polylines.clear();
-	for(std::vector<BrushStroke*>::iterator bsIt=brushStrokes.begin();bsIt!=brushStrokes.end();++bsIt)
-		delete *bsIt;
-	brushStrokes.clear();
+	deleteAllSketchObjects();
 	}
 
 }
@@ -27,8 +27,11 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <vector>
 #include <Geometry/Point.h>
 #include <Geometry/Box.h>
+#include <Geometry/PointHashGrid.h>
 #include <GL/gl.h>
 #include <GL/GLColor.h>
+#include <GL/GLObject.h>
+#include <GL/GLGeometryVertex.h>
 #include <GLMotif/RadioBox.h>
 #include <GLMotif/NewButton.h>
 #include <GLMotif/TextFieldSlider.h>
@@ -77,7 +80,7 @@ class SketchingToolFactory:public ToolFactory
 	GLMotif::FileSelectionHelper* getCurvesSelectionHelper(void); // Returns pointer to a file selection helper for curve files
 	};
 
-class SketchingTool:public UtilityTool
+class SketchingTool:public UtilityTool,public GLObject
 	{
 	friend class SketchingToolFactory;
 	
@@ -93,11 +96,14 @@ class SketchingTool:public UtilityTool
 		GLfloat lineWidth; // Curve's cosmetic line width
 		Color color; // Curve's color
 		Box boundingBox; // Bounding box around the curve for selection purposes
+		int drawListIndex; // Index of the draw list rendering the object from a shared vertex buffer, or -1 if the object is not batched
+		unsigned int drawIndex; // Index of the object in its draw list
 		
 		/* Constructors and destructors: */
 		SketchObject(GLfloat sLineWidth,const Color& sColor)
 			:lineWidth(sLineWidth),color(sColor),
-			 boundingBox(Box::empty)
+			 boundingBox(Box::empty),
+			 drawListIndex(-1),drawIndex(0)
 			{
 			}
 		virtual ~SketchObject(void);
@@ -197,6 +203,77 @@ class SketchingTool:public UtilityTool
 		static void resetGLState(GLContextData& contextData); // Undoes changes to OpenGL
 		};
 	
+	typedef Geometry::PointHashGrid<Scalar,3,SketchObject*> ControlPointGrid; // Type for spatial indices mapping control points to their sketching objects
+	typedef GLGeometry::Vertex<void,0,GLubyte,4,void,GLfloat,3> CurveVertex; // Type for vertices of batched curves
+	typedef GLGeometry::Vertex<void,0,GLfloat,4,GLfloat,GLfloat,3> BrushStrokeVertex; // Type for vertices of batched brush strokes
+	
+	struct DrawList // Structure for a list of batched sketching objects sharing the same line width
+		{
+		/* Elements: */
+		public:
+		GLfloat lineWidth; // Line width of all objects in the list
+		std::vector<GLint> firsts; // Index of each object's first vertex in the shared vertex array
+		std::vector<GLsizei> counts; // Number of vertices of each object
+		std::vector<SketchObject*> objects; // The objects in the list
+		
+		/* Constructors and destructors: */
+		DrawList(GLfloat sLineWidth)
+			:lineWidth(sLineWidth)
+			{
+			}
+		};
+	
+	template <class VertexParam>
+	struct Batch // Structure collecting the vertices of finished sketching objects of one type in a shared, growable vertex array
+		{
+		/* Elements: */
+		public:
+		std::vector<VertexParam> vertices; // Vertices of all batched objects, including stale vertices of removed objects
+		size_t numStaleVertices; // Number of vertices belonging to removed objects
+		unsigned int version; // Version number of the vertex array; incremented whenever existing vertices are moved
+		std::vector<DrawList> drawLists; // Lists of batched objects grouped by line width
+		
+		/* Constructors and destructors: */
+		Batch(void)
+			:numStaleVertices(0),version(0)
+			{
+			}
+		
+		/* Methods: */
+		void add(SketchObject* object,GLfloat drawListLineWidth,const std::vector<VertexParam>& objectVertices); // Appends the given vertices of the given object to the batch, in the draw list of the given line width
+		void remove(SketchObject* object); // Removes the given object from the batch, compacting the vertex array if too many vertices are stale
+		void clear(void); // Removes all objects from the batch
+		};
+	
+	struct SketchObjectCollector // Functor class to collect the sketching objects owning control points found in the spatial index
+		{
+		/* Elements: */
+		public:
+		std::vector<SketchObject*> objects; // List of collected objects; may contain duplicates
+		
+		/* Methods: */
+		void operator()(const ControlPointGrid::Entry& entry)
+			{
+			objects.push_back(entry.value);
+			}
+		};
+	
+	struct DataItem:public GLObject::DataItem
+		{
+		/* Elements: */
+		public:
+		bool haveVertexBuffers; // Flag whether the OpenGL context supports vertex buffer objects
+		bool haveMultiDraw; // Flag whether the OpenGL context supports multi-draw calls
+		GLuint vertexBufferIds[2]; // IDs of the vertex buffers holding batched curve and brush stroke vertices
+		size_t bufferSizes[2]; // Allocated sizes of the vertex buffers in vertices
+		size_t numUploadedVertices[2]; // Number of batched vertices already uploaded into the vertex buffers
+		unsigned int bufferVersions[2]; // Batch versions of the vertex buffers' contents
+		
+		/* Constructors and destructors: */
+		DataItem(void);
+		virtual ~DataItem(void);
+		};
+	
 	public:
 	enum SketchMode // Enumerated type for sketching modes
 		{
@@ -223,6 +300,19 @@ class SketchingTool:public UtilityTool
 	BrushStroke* currentBrushStroke; // Pointer to the currently created brush stroke
 	Point lastPoint; // The last point appended to the current sketching object
 	Point currentPoint; // The current dragging position
+	ControlPointGrid controlPointGrid; // Spatial index of the control points of all finished curves and brush strokes
+	Batch<CurveVertex> curveBatch; // Batch of all finished curves
+	Batch<BrushStrokeVertex> brushStrokeBatch; // Batch of all finished brush strokes
+	
+	/* Private methods: */
+	void finishCurve(Curve* curve); // Enters a finished curve into the spatial index and the curve batch
+	void finishBrushStroke(BrushStroke* brushStroke); // Enters a finished brush stroke into the spatial index and the brush stroke batch
+	void finishCurrentObjects(void); // Finishes the currently created sketching objects
+	void deleteCurve(Curve* curve); // Removes the given curve from the spatial index, the curve batch, and the curve list, and deletes it
+	void deleteBrushStroke(BrushStroke* brushStroke); // Ditto for brush strokes
+	void deleteAllSketchObjects(void); // Deletes all sketching objects
+	template <class VertexParam>
+	static void renderBatch(const Batch<VertexParam>& batch,GLenum primitive,bool setLineWidths,DataItem* dataItem,int bufferIndex); // Renders all objects in the given batch
 	
 	/* Constructors and destructors: */
 	public:
@@ -237,6 +327,9 @@ class SketchingTool:public UtilityTool
 	virtual void frame(void);
 	virtual void display(GLContextData& contextData) const;
 	
+	/* Methods from GLObject: */
+	virtual void initContext(GLContextData& contextData) const;
+	
 	/* New methods: */
 	void sketchModeCallback(GLMotif::RadioBox::ValueChangedCallbackData* cbData);
 	void lineWidthSliderCallback(GLMotif::TextFieldSlider::ValueChangedCallbackData* cbData);
@@ -1,7 +1,7 @@
 /***********************************************************************
 TransparentObject - Base class for objects that require a second
 rendering pass with alpha blending enabled.
-Copyright (c) 2007 Oliver Kreylos
+Copyright (c) 2007-2021 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -23,14 +23,30 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Vrui/TransparentObject.h>
 
+#include <algorithm>
+#include <Misc/Timer.h>
+#include <Geometry/Point.h>
+
 namespace Vrui {
 
+/*********************************************
+Methods of class TransparentObject::SortState:
+*********************************************/
+
+TransparentObject::SortState::SortState(void)
+	:listVersion(0),
+	 numPasses(0),numSortedObjects(0),numUnsortedObjects(0),numMoves(0),
+	 sortTime(0.0),maxSortTime(0.0)
+	{
+	}
+
 /******************************************
 Static elements of class TransparentObject:
 ******************************************/
 
 TransparentObject* TransparentObject::head=0;
 TransparentObject* TransparentObject::tail=0;
+unsigned int TransparentObject::listVersion=1;
 
 /**********************************
 Methods of class TransparentObject:
@@ -46,6 +62,7 @@ TransparentObject::TransparentObject(void)
 	else
 		head=this;
 	tail=this;
+	++listVersion;
 	}
 
 TransparentObject::~TransparentObject(void)
@@ -59,6 +76,13 @@ TransparentObject::~TransparentObject(void)
 		succ->pred=pred;
 	else
 		tail=pred;
+	++listVersion;
+	}
+
+bool TransparentObject::getTransparentBounds(Point& center,Scalar& radius) const
+	{
+	/* Objects can not be sorted by default: */
+	return false;
 	}
 
 void TransparentObject::transparencyPass(GLContextData& contextData)
@@ -68,4 +92,79 @@ void TransparentObject::transparencyPass(GLContextData& contextData)
 		toPtr->glRenderActionTransparent(contextData);
 	}
 
+void TransparentObject::transparencyPass(const Point& eyePosition,TransparentObject::SortState& sortState,GLContextData& contextData)
+	{
+	Misc::Timer sortTimer;
+	std::vector<SortState::Entry>& sorted=sortState.sorted;
+	
+	/* Update the sort state's object lists if objects were added or removed since the last pass: */
+	bool listChanged=sortState.listVersion!=listVersion;
+	if(listChanged)
+		{
+		sorted.clear();
+		sortState.unsorted.clear();
+		for(const TransparentObject* toPtr=head;toPtr!=0;toPtr=toPtr->succ)
+			{
+			Point center;
+			Scalar radius;
+			if(toPtr->getTransparentBounds(center,radius))
+				{
+				SortState::Entry entry;
+				entry.object=toPtr;
+				entry.depth=Scalar(0);
+				sorted.push_back(entry);
+				}
+			else
+				sortState.unsorted.push_back(toPtr);
+			}
+		sortState.listVersion=listVersion;
+		}
+	
+	/* Calculate the current distance from the eye to the far side of each sortable object: */
+	for(std::vector<SortState::Entry>::iterator sIt=sorted.begin();sIt!=sorted.end();++sIt)
+		{
+		Point center;
+		Scalar radius;
+		sIt->object->getTransparentBounds(center,radius);
+		sIt->depth=Geometry::dist(eyePosition,center)+radius;
+		}
+	
+	if(listChanged)
+		{
+		/* Sort the new list from scratch: */
+		std::stable_sort(sorted.begin(),sorted.end());
+		}
+	else
+		{
+		/* Re-sort the previous pass's order, which is usually already close to sorted, using insertion sort: */
+		size_t numSorted=sorted.size();
+		for(size_t i=1;i<numSorted;++i)
+			{
+			SortState::Entry entry=sorted[i];
+			size_t j;
+			for(j=i;j>0&&entry<sorted[j-1];--j)
+				sorted[j]=sorted[j-1];
+			sorted[j]=entry;
+			sortState.numMoves+=i-j;
+			}
+		}
+	
+	/* Update the sort statistics: */
+	double passSortTime=sortTimer.peekTime();
+	++sortState.numPasses;
+	sortState.numSortedObjects+=sorted.size();
+	sortState.numUnsortedObjects+=sortState.unsorted.size();
+	sortState.sortTime+=passSortTime;
+	if(sortState.maxSortTime<passSortTime)
+		sortState.maxSortTime=passSortTime;
+	
+	/* Render all sortable objects from back to front: */
+	for(std::vector<SortState::Entry>::const_iterator sIt=sorted.begin();sIt!=sorted.end();++sIt)
+		sIt->object->glRenderActionTransparent(contextData);
+	
+	/* Render all unsortable objects in registration order: */
+	for(std::vector<const TransparentObject*>::const_iterator uIt=sortState.unsorted.begin();uIt!=sortState.unsorted.end();++uIt)
+		(*uIt)->glRenderActionTransparent(contextData);
+	}
+
 }
@@ -1,7 +1,7 @@
 /***********************************************************************
 TransparentObject - Base class for objects that require a second
 rendering pass with alpha blending enabled.
-Copyright (c) 2007 Oliver Kreylos
+Copyright (c) 2007-2021 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -24,6 +24,10 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_TRANSPARENTOBJECT_INCLUDED
 #define VRUI_TRANSPARENTOBJECT_INCLUDED
 
+#include <stddef.h>
+#include <vector>
+#include <Vrui/Geometry.h>
+
 /* Forward declarations: */
 class GLContextData;
 
@@ -31,10 +35,75 @@ namespace Vrui {
 
 class TransparentObject
 	{
+	/* Embedded classes: */
+	public:
+	class SortState // Class retaining the back-to-front order of transparent objects between rendering passes in one OpenGL context
+		{
+		friend class TransparentObject;
+		
+		/* Embedded classes: */
+		private:
+		struct Entry // Structure for sortable transparent objects
+			{
+			/* Elements: */
+			public:
+			const TransparentObject* object; // Pointer to the transparent object
+			Scalar depth; // Distance from the eye to the far side of the object's bounding sphere in the most recent pass
+			
+			/* Methods: */
+			bool operator<(const Entry& other) const // Orders entries from back to front
+				{
+				return depth>other.depth;
+				}
+			};
+		
+		/* Elements: */
+		std::vector<Entry> sorted; // List of sortable objects in back-to-front order of the most recent pass
+		std::vector<const TransparentObject*> unsorted; // List of objects that can not be sorted, in registration order
+		unsigned int listVersion; // Version number of the transparent object list reflected in the sorted and unsorted lists
+		unsigned int numPasses; // Number of sorted transparency passes executed with this sort state
+		size_t numSortedObjects; // Total number of sorted objects rendered in all passes
+		size_t numUnsortedObjects; // Total number of unsorted objects rendered in all passes
+		size_t numMoves; // Total number of positions sorted objects moved between passes
+		double sortTime; // Total time spent sorting objects in all passes in seconds
+		double maxSortTime; // Maximum time spent sorting objects in a single pass in seconds
+		
+		/* Constructors and destructors: */
+		public:
+		SortState(void); // Creates an empty sort state
+		
+		/* Methods: */
+		unsigned int getNumPasses(void) const // Returns the number of sorted transparency passes executed with this sort state
+			{
+			return numPasses;
+			}
+		size_t getNumSortedObjects(void) const // Returns the total number of sorted objects rendered in all passes
+			{
+			return numSortedObjects;
+			}
+		size_t getNumUnsortedObjects(void) const // Returns the total number of unsorted objects rendered in all passes
+			{
+			return numUnsortedObjects;
+			}
+		size_t getNumMoves(void) const // Returns the total number of positions sorted objects moved between passes
+			{
+			return numMoves;
+			}
+		double getSortTime(void) const // Returns the total time spent sorting objects in all passes in seconds
+			{
+			return sortTime;
+			}
+		double getMaxSortTime(void) const // Returns the maximum time spent sorting objects in a single pass in seconds
+			{
+			return maxSortTime;
+			}
+		};
+	
 	/* Elements: */
 	private:
 	static TransparentObject* head; // Head of the list of transparent objects
 	static TransparentObject* tail; // Tail of the list of transparent objects
+	static unsigned int listVersion; // Version number of the list of transparent objects, incremented whenever objects are added or removed
 	TransparentObject* pred; // Pointer to predecessor in the list
 	TransparentObject* succ; // Pointer to successor in the list
 	
@@ -44,12 +113,14 @@ class TransparentObject
 	virtual ~TransparentObject(void); // Removes the newly created object from Vrui's transparent rendering pass
 	
 	/* Methods: */
+	virtual bool getTransparentBounds(Point& center,Scalar& radius) const; // Returns a bounding sphere of the object's transparent geometry in physical coordinates for depth sorting, or false if the object can not be sorted; queried again for every rendering pass, so the bounds may change, but whether the method returns true or false must not change over the object's lifetime; default returns false
 	virtual void glRenderActionTransparent(GLContextData& contextData) const =0; // Rendering method
 	static bool needRenderPass(void) // Returns true if there are any registered transparent objects
 		{
 		return head!=0;
 		}
-	static void transparencyPass(GLContextData& contextData); // Calls the transparent rendering methods of all transparent objects; does not change OpenGL state
+	static void transparencyPass(GLContextData& contextData); // Calls the transparent rendering methods of all transparent objects in registration order; does not change OpenGL state
+	static void transparencyPass(const Point& eyePosition,SortState& sortState,GLContextData& contextData); // Calls the transparent rendering methods of all sortable transparent objects in back-to-front order as seen from the given eye position in physical coordinates, followed by those of all unsortable objects in registration order; does not change OpenGL state
 	};
 
 }
@@ -0,0 +1,129 @@
+/***********************************************************************
+CSVSourceBenchmark - Measures the cost of reading a large CSV table field
+by field and in bulk, and verifies that both methods return the same
+values, including for quoted fields that contain separators.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with the Virtual Reality User Interface Library; if not, write to
+the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Math/Random.h>
+#include <IO/FixedMemoryFile.h>
+#include <IO/CSVSource.h>
+
+IO::FilePtr createFile(const std::string& contents) // Returns a memory file containing the given contents
+	{
+	IO::FixedMemoryFile* file=new IO::FixedMemoryFile(contents.size());
+	memcpy(file->getMemory(),contents.data(),contents.size());
+	return file;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numRecords=1000000;
+	unsigned int numThreads=0;
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"r")==0&&argi+1<argc)
+				numRecords=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"t")==0&&argi+1<argc)
+				numThreads=(unsigned int)(atoi(argv[++argi]));
+			else
+				std::cerr<<"Ignoring command line option "<<argv[argi]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring command line argument "<<argv[argi]<<std::endl;
+		}
+	
+	/* Generate a table with unsigned int, int, double, float, string, and unused columns: */
+	std::string contents;
+	for(unsigned int i=0;i<numRecords;++i)
+		{
+		char record[256];
+		int remark=Math::randUniformCO(0,4);
+		const char* remarks[4]={"plain","\"with, comma\"","\"with \"\"quotes\"\"\"","\"with\nnewline\""};
+		snprintf(record,sizeof(record),"%u,%d,%.9f,%.4g,%s,unused\n",i,Math::randUniformCO(-1000000,1000000),Math::randUniformCO(-180.0,180.0),Math::randUniformCO(0.0,10.0),remarks[remark]);
+		contents.append(record);
+		}
+	std::cout<<numRecords<<" records, "<<double(contents.size())/(1024.0*1024.0)<<" MB"<<std::endl;
+	
+	/* Read the table field by field: */
+	std::vector<unsigned int> ids;
+	std::vector<int> values;
+	std::vector<double> positions;
+	std::vector<float> magnitudes;
+	std::vector<std::string> remarks;
+	Misc::Timer t1;
+	{
+	IO::CSVSource source(createFile(contents));
+	while(!source.eof())
+		{
+		ids.push_back(source.readField<unsigned int>());
+		values.push_back(source.readField<int>());
+		positions.push_back(source.readField<double>());
+		magnitudes.push_back(source.readField<float>());
+		remarks.push_back(source.readField<std::string>());
+		source.skipRecord();
+		}
+	}
+	double fieldTime=t1.peekTime();
+	
+	/* Read the table in bulk: */
+	std::vector<IO::CSVSource::Column> columns;
+	columns.push_back(IO::CSVSource::Column(IO::CSVSource::UnsignedIntColumn));
+	columns.push_back(IO::CSVSource::Column(IO::CSVSource::IntColumn));
+	columns.push_back(IO::CSVSource::Column(IO::CSVSource::DoubleColumn));
+	columns.push_back(IO::CSVSource::Column(IO::CSVSource::FloatColumn));
+	columns.push_back(IO::CSVSource::Column(IO::CSVSource::StringColumn));
+	Misc::Timer t2;
+	size_t numBulkRecords;
+	{
+	IO::CSVSource source(createFile(contents));
+	numBulkRecords=source.readColumns(columns,numThreads);
+	}
+	double bulkTime=t2.peekTime();
+	
+	/* Compare the results: */
+	unsigned int numMismatches=0;
+	if(numBulkRecords!=ids.size())
+		++numMismatches;
+	else
+		{
+		for(size_t i=0;i<numBulkRecords;++i)
+			if(columns[0].getUnsignedInts()[i]!=ids[i]||columns[1].getInts()[i]!=values[i]||columns[2].getDoubles()[i]!=positions[i]||columns[3].getFloats()[i]!=magnitudes[i]||columns[4].getStrings()[i]!=remarks[i])
+				++numMismatches;
+		}
+	
+	double mb=double(contents.size())/(1024.0*1024.0);
+	std::cout<<"CSVSource readField: "<<fieldTime*1000.0<<" ms, "<<mb/fieldTime<<" MB/s"<<std::endl;
+	std::cout<<"CSVSource readColumns: "<<bulkTime*1000.0<<" ms, "<<mb/bulkTime<<" MB/s, "<<numBulkRecords<<" records"<<std::endl;
+	if(numMismatches!=0)
+		std::cout<<numMismatches<<" records differ between field and bulk reading (INCORRECT)"<<std::endl;
+	
+	return numMismatches==0?0:1;
+	}
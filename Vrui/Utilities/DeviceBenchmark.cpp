@@ -0,0 +1,286 @@
+/***********************************************************************
+DeviceBenchmark - Program to measure end-to-end latency, jitter, and
+dropped updates of a Vrui VR Device Daemon streaming states generated by
+a SyntheticDevice device driver module.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <Misc/SizedTypes.h>
+#include <Misc/FunctionCalls.h>
+#include <Threads/Mutex.h>
+#include <Realtime/Time.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Vrui/Internal/VRDeviceState.h>
+#include <Vrui/Internal/VRDeviceClient.h>
+
+class StreamStatistics // Helper class to gather latency, jitter, and drop statistics from a device client's packet stream
+	{
+	/* Elements: */
+	private:
+	Threads::Mutex mutex; // Mutex protecting the statistics
+	bool trackSequenceNumbers; // Flag whether updates are counted and dropped updates detected via update sequence numbers
+	std::vector<Vrui::VRDeviceState::TimeStamp> lastTimeStamps; // Most recently seen time stamp of each tracker
+	bool haveSequenceNumber; // Flag whether a sequence number has been received
+	Vrui::VRDeviceState::SequenceNumber lastSequenceNumber; // Most recently received sequence number
+	bool haveLastUpdateTime; // Flag whether an update has been received
+	Realtime::TimePointMonotonic lastUpdateTime; // Arrival time of the most recent update
+	
+	/* Statistics of the current observation period: */
+	unsigned int numMessages; // Number of received messages
+	unsigned int numUpdates; // Number of received updates, as signaled by sequence numbers
+	unsigned int numDropped; // Number of updates that were skipped by the server or the connection
+	unsigned int numLatencies; // Number of measured tracker latencies
+	double latencySum,latencySum2; // Sum and sum of squares of tracker latencies in microseconds
+	double minLatency,maxLatency; // Latency range in microseconds
+	unsigned int numIntervals; // Number of measured update intervals
+	double intervalSum,intervalSum2; // Sum and sum of squares of update intervals in microseconds
+	
+	/* Constructors and destructors: */
+	public:
+	StreamStatistics(int sNumTrackers,bool sTrackSequenceNumbers)
+		:trackSequenceNumbers(sTrackSequenceNumbers),
+		 lastTimeStamps(sNumTrackers,0),
+		 haveSequenceNumber(false),lastSequenceNumber(0),
+		 haveLastUpdateTime(false)
+		{
+		reset();
+		}
+	
+	/* Methods: */
+	void reset(void) // Resets the statistics for the next observation period
+		{
+		numMessages=0;
+		numUpdates=0;
+		numDropped=0;
+		numLatencies=0;
+		latencySum=latencySum2=0.0;
+		minLatency=Math::Constants<double>::max;
+		maxLatency=0.0;
+		numIntervals=0;
+		intervalSum=intervalSum2=0.0;
+		}
+	void packetCallback(Vrui::VRDeviceClient* client) // Called from the device client's receiving thread when a message arrived
+		{
+		/* Take the arrival time stamp in the same format as the device daemon: */
+		Realtime::TimePointMonotonic now;
+		Vrui::VRDeviceState::TimeStamp nowTs=Vrui::VRDeviceState::TimeStamp(now.tv_sec*1000000+(now.tv_nsec+500)/1000);
+		
+		Threads::Mutex::Lock statisticsLock(mutex);
+		++numMessages;
+		
+		client->lockState();
+		const Vrui::VRDeviceState& state=client->getState();
+		
+		/* Measure the latency of all trackers that were updated since the last message: */
+		for(int i=0;i<int(lastTimeStamps.size());++i)
+			if(state.getTrackerValid(i)&&state.getTrackerTimeStamp(i)!=lastTimeStamps[i])
+				{
+				lastTimeStamps[i]=state.getTrackerTimeStamp(i);
+				double latency=double(Misc::SInt32(Misc::UInt32(nowTs)-Misc::UInt32(lastTimeStamps[i])));
+				++numLatencies;
+				latencySum+=latency;
+				latencySum2+=latency*latency;
+				if(minLatency>latency)
+					minLatency=latency;
+				if(maxLatency<latency)
+					maxLatency=latency;
+				}
+		
+		/* Check for a new sequence number: */
+		bool newUpdate=!trackSequenceNumbers;
+		if(trackSequenceNumbers)
+			{
+			Vrui::VRDeviceState::SequenceNumber sequenceNumber=state.getUpdateSequenceNumber();
+			if(!haveSequenceNumber||sequenceNumber!=lastSequenceNumber)
+				{
+				/* Count skipped sequence numbers as dropped updates: */
+				if(haveSequenceNumber)
+					numDropped+=(unsigned int)(sequenceNumber-lastSequenceNumber-1U);
+				lastSequenceNumber=sequenceNumber;
+				haveSequenceNumber=true;
+				newUpdate=true;
+				}
+			}
+		client->unlockState();
+		
+		if(newUpdate)
+			{
+			/* Measure the interval between updates: */
+			++numUpdates;
+			if(haveLastUpdateTime)
+				{
+				double interval=double(now-lastUpdateTime)*1.0e6;
+				++numIntervals;
+				intervalSum+=interval;
+				intervalSum2+=interval*interval;
+				}
+			lastUpdateTime=now;
+			haveLastUpdateTime=true;
+			}
+		}
+	void print(double periodLength) // Prints and resets the statistics of the current observation period
+		{
+		Threads::Mutex::Lock statisticsLock(mutex);
+		
+		std::cout<<std::fixed<<std::setprecision(1);
+		std::cout<<std::setw(8)<<double(numMessages)/periodLength<<" msg/s";
+		std::cout<<std::setw(8)<<double(numUpdates)/periodLength<<" upd/s";
+		if(trackSequenceNumbers)
+			std::cout<<std::setw(6)<<numDropped<<" dropped";
+		if(numLatencies>0)
+			{
+			double mean=latencySum/double(numLatencies);
+			double stddev=numLatencies>1?Math::sqrt(Math::max((latencySum2-mean*latencySum)/double(numLatencies-1),0.0)):0.0;
+			std::cout<<", latency "<<std::setw(8)<<mean<<" +- "<<std::setw(7)<<stddev<<" us ["<<minLatency<<", "<<maxLatency<<"]";
+			}
+		if(numIntervals>0)
+			{
+			double mean=intervalSum/double(numIntervals);
+			double stddev=numIntervals>1?Math::sqrt(Math::max((intervalSum2-mean*intervalSum)/double(numIntervals-1),0.0)):0.0;
+			std::cout<<", interval "<<std::setw(8)<<mean<<" +- "<<std::setw(7)<<stddev<<" us";
+			}
+		std::cout<<std::endl;
+		
+		reset();
+		}
+	};
+
+int main(int argc,char* argv[])
+	{
+	/* Parse command line: */
+	const char* serverNamePort="localhost:8555";
+	bool trackSequenceNumbers=true;
+	double reportInterval=1.0;
+	double runTime=10.0;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"noSeq")==0)
+				trackSequenceNumbers=false;
+			else if(strcasecmp(argv[i]+1,"interval")==0&&i+1<argc)
+				reportInterval=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"time")==0&&i+1<argc)
+				runTime=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"h")==0)
+				{
+				std::cout<<"Usage: "<<argv[0]<<" [-noSeq] [-interval <report interval>] [-time <run time>] [<serverName:serverPort>]"<<std::endl;
+				std::cout<<"\t-noSeq Do not track update sequence numbers"<<std::endl;
+				std::cout<<"\t-interval <report interval>"<<std::endl;
+				std::cout<<"\t\tTime between statistics reports in seconds"<<std::endl;
+				std::cout<<"\t-time <run time>"<<std::endl;
+				std::cout<<"\t\tTotal measurement time in seconds"<<std::endl;
+				return 0;
+				}
+			else
+				std::cerr<<"Ignoring command line option "<<argv[i]<<std::endl;
+			}
+		else
+			serverNamePort=argv[i];
+		}
+	if(reportInterval<=0.0||runTime<=0.0)
+		{
+		std::cerr<<"Invalid report interval or run time"<<std::endl;
+		return 1;
+		}
+	
+	/* Split the server name into hostname:port: */
+	const char* colonPtr=0;
+	for(const char* cPtr=serverNamePort;*cPtr!='\0';++cPtr)
+		if(*cPtr==':')
+			colonPtr=cPtr;
+	std::string serverName;
+	int portNumber=8555;
+	if(colonPtr!=0)
+		{
+		serverName=std::string(serverNamePort,colonPtr);
+		portNumber=atoi(colonPtr+1);
+		}
+	else
+		serverName=serverNamePort;
+	
+	/* Initialize device client: */
+	Vrui::VRDeviceClient* deviceClient=0;
+	try
+		{
+		deviceClient=new Vrui::VRDeviceClient(serverName.c_str(),portNumber);
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Caught exception "<<err.what()<<" while initializing VR device client"<<std::endl;
+		return 1;
+		}
+	if(!deviceClient->isLocal())
+		std::cout<<"Device server at "<<serverName<<':'<<portNumber<<" is running on a different host; latencies include clock offset estimation errors"<<std::endl;
+	
+	/* Determine the device layout: */
+	deviceClient->lockState();
+	int numTrackers=deviceClient->getState().getNumTrackers();
+	int numValuators=deviceClient->getState().getNumValuators();
+	deviceClient->unlockState();
+	if(trackSequenceNumbers&&!deviceClient->hasSequenceNumbers())
+		{
+		std::cout<<"Device server does not send update sequence numbers; counting messages as updates"<<std::endl;
+		trackSequenceNumbers=false;
+		}
+	std::cout<<"Streaming "<<numTrackers<<" trackers and "<<numValuators<<" valuators";
+	if(trackSequenceNumbers)
+		std::cout<<" with update sequence numbers";
+	std::cout<<std::endl;
+	
+	/* Stream device states and print statistics periodically: */
+	StreamStatistics statistics(numTrackers,trackSequenceNumbers);
+	int result=0;
+	try
+		{
+		deviceClient->activate();
+		deviceClient->startStream(Misc::createFunctionCall(&statistics,&StreamStatistics::packetCallback));
+		
+		Realtime::TimePointMonotonic startTime;
+		Realtime::TimePointMonotonic nextReport=startTime;
+		Realtime::TimeVector reportPeriod(reportInterval);
+		for(double elapsed=0.0;elapsed<runTime;elapsed+=reportInterval)
+			{
+			nextReport+=reportPeriod;
+			Realtime::TimePointMonotonic::sleep(nextReport);
+			statistics.print(reportInterval);
+			}
+		
+		deviceClient->stopStream();
+		deviceClient->deactivate();
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"Caught exception "<<err.what()<<" while streaming device states"<<std::endl;
+		result=1;
+		}
+	
+	delete deviceClient;
+	
+	return result;
+	}
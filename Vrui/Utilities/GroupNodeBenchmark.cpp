@@ -0,0 +1,149 @@
+/***********************************************************************
+GroupNodeBenchmark - Measures the cost of adding and removing large
+numbers of children to and from a scene graph group node.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <Misc/Timer.h>
+#include <SceneGraph/GraphNode.h>
+#include <SceneGraph/GroupNode.h>
+
+/**********************************************************************
+Minimal graph node class standing in for an application's annotation
+nodes:
+**********************************************************************/
+
+class AnnotationNode:public SceneGraph::GraphNode
+	{
+	/* Constructors and destructors: */
+	public:
+	AnnotationNode(PassMask sPassMask)
+		{
+		passMask=sPassMask;
+		}
+	
+	/* Methods from class Node: */
+	virtual const char* getClassName(void) const
+		{
+		return "Annotation";
+		}
+	
+	/* New methods: */
+	unsigned int changePassMask(PassMask newPassMask) // Changes the node's pass mask and returns the update result to be cascaded to the parent
+		{
+		return setPassMask(newPassMask);
+		}
+	};
+
+typedef Misc::Autopointer<AnnotationNode> AnnotationNodePointer;
+
+void printResult(const char* phase,int numChildren,double time)
+	{
+	std::cout<<phase<<": "<<time*1000.0<<" ms ("<<time*1.0e9/double(numChildren)<<" ns per child)"<<std::endl;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int numChildren=100000;
+	int batchSize=1000;
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"n")==0&&argi+1<argc)
+				numChildren=atoi(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"batch")==0&&argi+1<argc)
+				batchSize=atoi(argv[++argi]);
+			else
+				std::cerr<<"Ignoring command line option "<<argv[argi]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring command line argument "<<argv[argi]<<std::endl;
+		}
+	if(numChildren<1||batchSize<1)
+		{
+		std::cerr<<"Invalid number of children or batch size"<<std::endl;
+		return 1;
+		}
+	
+	/* Create the annotation nodes; every tenth node is transparent: */
+	std::vector<AnnotationNodePointer> nodes;
+	nodes.reserve(numChildren);
+	for(int i=0;i<numChildren;++i)
+		nodes.push_back(new AnnotationNode(i%10==0?SceneGraph::GraphNode::GLTransparentRenderPass:SceneGraph::GraphNode::GLRenderPass));
+	
+	SceneGraph::GroupNodePointer group=new SceneGraph::GroupNode;
+	
+	/* Add all nodes one at a time: */
+	Misc::Timer t;
+	for(int i=0;i<numChildren;++i)
+		group->addChild(*nodes[i]);
+	t.elapse();
+	printResult("addChild",numChildren,t.getTime());
+	
+	/* Toggle every node's pass mask and notify the group: */
+	for(int i=0;i<numChildren;++i)
+		{
+		unsigned int updateResult=nodes[i]->changePassMask(nodes[i]->getPassMask()^SceneGraph::GraphNode::CollisionPass);
+		group->cascadingUpdate(*nodes[i],updateResult);
+		}
+	t.elapse();
+	printResult("cascadingUpdate",numChildren,t.getTime());
+	
+	/* Remove all nodes one at a time, newest first: */
+	for(int i=numChildren-1;i>=0;--i)
+		group->removeChild(*nodes[i]);
+	t.elapse();
+	printResult("removeChild",numChildren,t.getTime());
+	
+	/* Add all nodes in batches through the addChildren field: */
+	for(int i=0;i<numChildren;i+=batchSize)
+		{
+		for(int j=i;j<numChildren&&j<i+batchSize;++j)
+			group->addChildren.appendValue(nodes[j]);
+		group->update();
+		}
+	t.elapse();
+	printResult("addChildren",numChildren,t.getTime());
+	
+	/* Remove all nodes in batches through the removeChildren field, oldest first: */
+	for(int i=0;i<numChildren;i+=batchSize)
+		{
+		for(int j=i;j<numChildren&&j<i+batchSize;++j)
+			group->removeChildren.appendValue(nodes[j]);
+		group->update();
+		}
+	t.elapse();
+	printResult("removeChildren",numChildren,t.getTime());
+	
+	/* Check that the group ended up empty: */
+	if(!group->getChildren().empty()||group->getPassMask()!=0x0U)
+		{
+		std::cerr<<"Group node is not empty after removing all children"<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
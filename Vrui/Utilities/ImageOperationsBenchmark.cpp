@@ -0,0 +1,431 @@
+/***********************************************************************
+ImageOperationsBenchmark - Measures the throughput of the basic image
+processing operations of the Images library against straightforward
+per-pixel reference loops, and verifies that both produce identical
+results.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+#include <Misc/Timer.h>
+#include <Math/Random.h>
+#include <GL/gl.h>
+#include <Images/BaseImage.h>
+
+/**************************************************************
+Reference implementations of the original per-pixel operations:
+**************************************************************/
+
+inline unsigned char grey(unsigned char r,unsigned char g,unsigned char b)
+	{
+	return (unsigned char)(((unsigned short)(r)*77U+(unsigned short)(g)*150U+(unsigned short)(b)*29U)>>8);
+	}
+
+inline unsigned short grey(unsigned short r,unsigned short g,unsigned short b)
+	{
+	return (unsigned short)(((unsigned int)(r)*77U+(unsigned int)(g)*150U+(unsigned int)(b)*29U)>>8);
+	}
+
+inline float grey(float r,float g,float b)
+	{
+	return r*0.299f+g*0.587f+b*0.114f;
+	}
+
+inline unsigned char average(unsigned char s00,unsigned char s01,unsigned char s10,unsigned char s11)
+	{
+	unsigned short sum0=(unsigned short)(s00)+(unsigned short)(s01);
+	unsigned short sum1=(unsigned short)(s10)+(unsigned short)(s11);
+	return (unsigned char)((sum0+sum1+2)>>2);
+	}
+
+inline unsigned short average(unsigned short s00,unsigned short s01,unsigned short s10,unsigned short s11)
+	{
+	unsigned int sum0=(unsigned int)(s00)+(unsigned int)(s01);
+	unsigned int sum1=(unsigned int)(s10)+(unsigned int)(s11);
+	return (unsigned short)((sum0+sum1+2)>>2);
+	}
+
+inline float average(float s00,float s01,float s10,float s11)
+	{
+	return (s00+s01+s10+s11)*0.25f;
+	}
+
+template <class ScalarParam>
+void referenceDropAlpha(const Images::BaseImage& source,Images::BaseImage& dest)
+	{
+	unsigned int nc=source.getNumChannels();
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
+	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.replacePixels());
+	size_t numPixels=size_t(source.getWidth())*size_t(source.getHeight());
+	for(size_t i=0;i<numPixels;++i,sPtr+=nc)
+		for(unsigned int j=0;j<nc-1;++j,++dPtr)
+			*dPtr=sPtr[j];
+	}
+
+template <class ScalarParam>
+void referenceAddAlpha(const Images::BaseImage& source,Images::BaseImage& dest,ScalarParam alpha)
+	{
+	unsigned int nc=source.getNumChannels();
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
+	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.replacePixels());
+	size_t numPixels=size_t(source.getWidth())*size_t(source.getHeight());
+	for(size_t i=0;i<numPixels;++i)
+		{
+		for(unsigned int j=0;j<nc;++j,++sPtr,++dPtr)
+			*dPtr=*sPtr;
+		*(dPtr++)=alpha;
+		}
+	}
+
+template <class ScalarParam>
+void referenceToGrey(const Images::BaseImage& source,Images::BaseImage& dest)
+	{
+	unsigned int nc=source.getNumChannels();
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
+	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.replacePixels());
+	size_t numPixels=size_t(source.getWidth())*size_t(source.getHeight());
+	for(size_t i=0;i<numPixels;++i,sPtr+=nc)
+		{
+		*(dPtr++)=grey(sPtr[0],sPtr[1],sPtr[2]);
+		if(nc==4)
+			*(dPtr++)=sPtr[3];
+		}
+	}
+
+template <class ScalarParam>
+void referenceToRgb(const Images::BaseImage& source,Images::BaseImage& dest)
+	{
+	unsigned int nc=source.getNumChannels();
+	const ScalarParam* sPtr=static_cast<const ScalarParam*>(source.getPixels());
+	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.replacePixels());
+	size_t numPixels=size_t(source.getWidth())*size_t(source.getHeight());
+	for(size_t i=0;i<numPixels;++i,sPtr+=nc)
+		{
+		for(int j=0;j<3;++j,++dPtr)
+			*dPtr=sPtr[0];
+		if(nc==2)
+			*(dPtr++)=sPtr[1];
+		}
+	}
+
+template <class ScalarParam>
+void referenceShrink(const Images::BaseImage& source,Images::BaseImage& dest)
+	{
+	unsigned int nc=source.getNumChannels();
+	const ScalarParam* sRow0Ptr=static_cast<const ScalarParam*>(source.getPixels());
+	const ptrdiff_t sStride=source.getWidth()*nc;
+	const ScalarParam* sRow1Ptr=sRow0Ptr+sStride;
+	ScalarParam* dPtr=static_cast<ScalarParam*>(dest.replacePixels());
+	for(unsigned int y=0;y<source.getHeight();y+=2,sRow0Ptr+=sStride*2,sRow1Ptr+=sStride*2)
+		{
+		const ScalarParam* s0Ptr=sRow0Ptr;
+		const ScalarParam* s1Ptr=sRow1Ptr;
+		for(unsigned int x=0;x<source.getWidth();x+=2,s0Ptr+=nc,s1Ptr+=nc)
+			for(unsigned int i=0;i<nc;++i,++s0Ptr,++s1Ptr,++dPtr)
+				*dPtr=average(s0Ptr[0],s0Ptr[nc],s1Ptr[0],s1Ptr[nc]);
+		}
+	}
+
+/****************************************
+Helper structures and benchmark functions:
+****************************************/
+
+enum Operation
+	{
+	DropAlpha,AddAlpha,ToGrey,ToRgb,Shrink,NumOperations
+	};
+
+const char* operationNames[NumOperations]=
+	{
+	"dropAlpha","addAlpha","toGrey","toRgb","shrink"
+	};
+
+struct PixelFormat // Structure describing a benchmarked pixel format
+	{
+	/* Elements: */
+	public:
+	const char* name;
+	unsigned int numChannels;
+	unsigned int channelSize;
+	GLenum format;
+	GLenum scalarType;
+	};
+
+const PixelFormat pixelFormats[]=
+	{
+	{"L8",1,8,GL_LUMINANCE,GL_UNSIGNED_BYTE},
+	{"RGB8",3,8,GL_RGB,GL_UNSIGNED_BYTE},
+	{"RGBA8",4,8,GL_RGBA,GL_UNSIGNED_BYTE},
+	{"RGBA16",4,16,GL_RGBA,GL_UNSIGNED_SHORT},
+	{"RGBAf",4,32,GL_RGBA,GL_FLOAT}
+	};
+
+bool isApplicable(Operation operation,GLenum format)
+	{
+	switch(operation)
+		{
+		case DropAlpha:
+			return format==GL_LUMINANCE_ALPHA||format==GL_RGBA;
+		
+		case AddAlpha:
+			return format==GL_LUMINANCE||format==GL_RGB;
+		
+		case ToRgb:
+			return format==GL_LUMINANCE||format==GL_LUMINANCE_ALPHA;
+		
+		case ToGrey:
+			return format==GL_RGB||format==GL_RGBA;
+		
+		default:
+			return true;
+		}
+	}
+
+Images::BaseImage runOperation(Operation operation,const Images::BaseImage& source)
+	{
+	switch(operation)
+		{
+		case DropAlpha:
+			return source.dropAlpha();
+		
+		case AddAlpha:
+			return source.addAlpha(1.0);
+		
+		case ToGrey:
+			return source.toGrey();
+		
+		case ToRgb:
+			return source.toRgb();
+		
+		default:
+			return source.shrink();
+		}
+	}
+
+template <class ScalarParam>
+void runReferenceTyped(Operation operation,const Images::BaseImage& source,Images::BaseImage& dest,ScalarParam opaque)
+	{
+	switch(operation)
+		{
+		case DropAlpha:
+			referenceDropAlpha<ScalarParam>(source,dest);
+			break;
+		
+		case AddAlpha:
+			referenceAddAlpha<ScalarParam>(source,dest,opaque);
+			break;
+		
+		case ToGrey:
+			referenceToGrey<ScalarParam>(source,dest);
+			break;
+		
+		case ToRgb:
+			referenceToRgb<ScalarParam>(source,dest);
+			break;
+		
+		default:
+			referenceShrink<ScalarParam>(source,dest);
+		}
+	}
+
+void runReference(Operation operation,const Images::BaseImage& source,Images::BaseImage& dest)
+	{
+	switch(source.getScalarType())
+		{
+		case GL_UNSIGNED_BYTE:
+			runReferenceTyped<unsigned char>(operation,source,dest,255U);
+			break;
+		
+		case GL_UNSIGNED_SHORT:
+			runReferenceTyped<unsigned short>(operation,source,dest,65535U);
+			break;
+		
+		default:
+			runReferenceTyped<float>(operation,source,dest,1.0f);
+		}
+	}
+
+Images::BaseImage createRandomImage(unsigned int width,unsigned int height,const PixelFormat& pf)
+	{
+	Images::BaseImage result(width,height,pf.numChannels,pf.channelSize/8,pf.format,pf.scalarType);
+	size_t numValues=size_t(width)*size_t(height)*pf.numChannels;
+	switch(pf.scalarType)
+		{
+		case GL_UNSIGNED_BYTE:
+			{
+			unsigned char* pPtr=static_cast<unsigned char*>(result.replacePixels());
+			for(size_t i=0;i<numValues;++i)
+				pPtr[i]=(unsigned char)(Math::randUniformCO(0,256));
+			break;
+			}
+		
+		case GL_UNSIGNED_SHORT:
+			{
+			unsigned short* pPtr=static_cast<unsigned short*>(result.replacePixels());
+			for(size_t i=0;i<numValues;++i)
+				pPtr[i]=(unsigned short)(Math::randUniformCO(0,65536));
+			break;
+			}
+		
+		default:
+			{
+			float* pPtr=static_cast<float*>(result.replacePixels());
+			for(size_t i=0;i<numValues;++i)
+				pPtr[i]=float(Math::randUniformCC(0.0,1.0));
+			}
+		}
+	
+	return result;
+	}
+
+bool isEqual(const Images::BaseImage& image1,const Images::BaseImage& image2)
+	{
+	if(image1.getWidth()!=image2.getWidth()||image1.getHeight()!=image2.getHeight()||image1.getNumChannels()!=image2.getNumChannels()||image1.getScalarType()!=image2.getScalarType())
+		return false;
+	return memcmp(image1.getPixels(),image2.getPixels(),size_t(image1.getRowStride())*image1.getHeight())==0;
+	}
+
+double throughput(const Images::BaseImage& image,double time)
+	{
+	return double(image.getWidth())*double(image.getHeight())*1.0e-6/time;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int size[2]={4096,4096};
+	int numRepeats=5;
+	int numThreads=int(sysconf(_SC_NPROCESSORS_ONLN));
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"size")==0&&argi+2<argc)
+				{
+				for(int i=0;i<2;++i)
+					size[i]=(unsigned int)(atoi(argv[++argi]));
+				}
+			else if(strcasecmp(argv[argi]+1,"r")==0&&argi+1<argc)
+				numRepeats=atoi(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"t")==0&&argi+1<argc)
+				numThreads=atoi(argv[++argi]);
+			else
+				std::cerr<<"Ignoring command line option "<<argv[argi]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring command line argument "<<argv[argi]<<std::endl;
+		}
+	if(size[0]<2||size[1]<2||size[0]%2!=0||size[1]%2!=0)
+		{
+		std::cerr<<"Image size must be even and at least 2x2"<<std::endl;
+		return 1;
+		}
+	if(numRepeats<1)
+		numRepeats=1;
+	if(numThreads<1)
+		numThreads=1;
+	std::cout<<"Processing "<<size[0]<<"x"<<size[1]<<" images "<<numRepeats<<" times using up to "<<numThreads<<" threads"<<std::endl;
+	
+	bool allEqual=true;
+	Misc::Timer t;
+	for(size_t pfi=0;pfi<sizeof(pixelFormats)/sizeof(PixelFormat);++pfi)
+		{
+		const PixelFormat& pf=pixelFormats[pfi];
+		std::cout<<pf.name<<":"<<std::endl;
+		Images::BaseImage source=createRandomImage(size[0],size[1],pf);
+		
+		for(int op=0;op<NumOperations;++op)
+			{
+			Operation operation=Operation(op);
+			if(!isApplicable(operation,pf.format))
+				continue;
+			
+			/* Run the library operation using a single thread: */
+			Images::BaseImage::setNumThreads(1);
+			Images::BaseImage result1;
+			t.elapse();
+			for(int r=0;r<numRepeats;++r)
+				result1=runOperation(operation,source);
+			t.elapse();
+			double time1=t.getTime()/double(numRepeats);
+			
+			/* Run the library operation using multiple threads: */
+			Images::BaseImage::setNumThreads(numThreads);
+			Images::BaseImage resultN;
+			t.elapse();
+			for(int r=0;r<numRepeats;++r)
+				resultN=runOperation(operation,source);
+			t.elapse();
+			double timeN=t.getTime()/double(numRepeats);
+			
+			/* Run the reference operation, allocating a new result image each time like the library does: */
+			Images::BaseImage reference;
+			t.elapse();
+			for(int r=0;r<numRepeats;++r)
+				{
+				reference=Images::BaseImage(result1.getWidth(),result1.getHeight(),result1.getNumChannels(),result1.getChannelSize(),result1.getFormat(),result1.getScalarType());
+				runReference(operation,source,reference);
+				}
+			t.elapse();
+			double timeRef=t.getTime()/double(numRepeats);
+			
+			bool equal=isEqual(reference,result1)&&isEqual(reference,resultN);
+			allEqual=allEqual&&equal;
+			std::cout<<"  "<<operationNames[op]<<": reference "<<timeRef*1000.0<<" ms ("<<throughput(source,timeRef)<<" Mpixels/s)";
+			std::cout<<", 1 thread "<<time1*1000.0<<" ms (speedup "<<timeRef/time1<<")";
+			std::cout<<", "<<numThreads<<" threads "<<timeN*1000.0<<" ms (speedup "<<timeRef/timeN<<")";
+			std::cout<<(equal?", results identical":", RESULTS DIFFER")<<std::endl;
+			}
+		
+		/* Benchmark resampling to half and double the image size with all filters: */
+		static const char* filterNames[]={"box","bilinear","Lanczos"};
+		for(int filter=0;filter<3;++filter)
+			for(int scale=0;scale<2;++scale)
+				{
+				unsigned int newWidth=scale==0?size[0]/2:size[0]*2;
+				unsigned int newHeight=scale==0?size[1]/2:size[1]*2;
+				
+				Images::BaseImage::setNumThreads(1);
+				Images::BaseImage result1;
+				t.elapse();
+				result1=source.resample(newWidth,newHeight,Images::BaseImage::ResampleFilter(filter));
+				t.elapse();
+				double time1=t.getTime();
+				
+				Images::BaseImage::setNumThreads(numThreads);
+				Images::BaseImage resultN;
+				t.elapse();
+				resultN=source.resample(newWidth,newHeight,Images::BaseImage::ResampleFilter(filter));
+				t.elapse();
+				double timeN=t.getTime();
+				
+				bool equal=isEqual(result1,resultN);
+				allEqual=allEqual&&equal;
+				std::cout<<"  resample "<<filterNames[filter]<<" to "<<newWidth<<"x"<<newHeight<<": 1 thread "<<time1*1000.0<<" ms ("<<throughput(result1,time1)<<" Mpixels/s)";
+				std::cout<<", "<<numThreads<<" threads "<<timeN*1000.0<<" ms (speedup "<<time1/timeN<<")";
+				std::cout<<(equal?", results identical":", RESULTS DIFFER")<<std::endl;
+				}
+		}
+	
+	return allEqual?0:1;
+	}
@@ -0,0 +1,360 @@
+/***********************************************************************
+JsonSourceBenchmark - Measures throughput and peak memory use of parsing
+a large generated GeoJSON file into JSON entity trees, into arena-based
+JSON documents, and into streams of parsing events, and verifies that
+all three methods see the same values.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with the Virtual Reality User Interface Library; if not, write to
+the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <iostream>
+#include <string>
+#include <Misc/SizedTypes.h>
+#include <Misc/Timer.h>
+#include <Math/Random.h>
+#include <IO/FixedMemoryFile.h>
+#include <IO/JsonEntityTypes.h>
+#include <IO/JsonSource.h>
+#include <IO/JsonDocument.h>
+
+struct Summary // Structure summarizing the values in a JSON file independently of member order
+	{
+	/* Elements: */
+	public:
+	size_t numValues[6]; // Number of null, boolean, number, string, array, and object values
+	size_t numTrues; // Number of true boolean values
+	Misc::UInt64 numberBits; // Exclusive or of the bit patterns of all numbers
+	size_t stringLength; // Total length of all strings and member names
+	
+	/* Constructors and destructors: */
+	Summary(void)
+		:numTrues(0),numberBits(0),stringLength(0)
+		{
+		for(int i=0;i<6;++i)
+			numValues[i]=0;
+		}
+	
+	/* Methods: */
+	void addNumber(double value)
+		{
+		Misc::UInt64 bits;
+		memcpy(&bits,&value,sizeof(bits));
+		numberBits^=bits;
+		}
+	bool operator==(const Summary& other) const
+		{
+		for(int i=0;i<6;++i)
+			if(numValues[i]!=other.numValues[i])
+				return false;
+		return numTrues==other.numTrues&&numberBits==other.numberBits&&stringLength==other.stringLength;
+		}
+	};
+
+class SummaryHandler:public IO::JsonSource::Handler // Class to summarize a JSON file from its parsing events
+	{
+	/* Elements: */
+	public:
+	Summary summary;
+	
+	/* Methods from class IO::JsonSource::Handler: */
+	virtual void null(void)
+		{
+		++summary.numValues[0];
+		}
+	virtual void boolean(bool value)
+		{
+		++summary.numValues[1];
+		if(value)
+			++summary.numTrues;
+		}
+	virtual void number(double value)
+		{
+		++summary.numValues[2];
+		summary.addNumber(value);
+		}
+	virtual void string(const std::string& value)
+		{
+		++summary.numValues[3];
+		summary.stringLength+=value.size();
+		}
+	virtual void endArray(size_t numItems)
+		{
+		++summary.numValues[4];
+		}
+	virtual void name(const std::string& name)
+		{
+		summary.stringLength+=name.size();
+		}
+	virtual void endObject(size_t numMembers)
+		{
+		++summary.numValues[5];
+		}
+	};
+
+void summarize(IO::JsonPointer entity,Summary& summary) // Summarizes a tree of JSON entities
+	{
+	if(entity==0)
+		{
+		++summary.numValues[0];
+		return;
+		}
+	
+	switch(entity->getType())
+		{
+		case IO::JsonEntity::BOOLEAN:
+			++summary.numValues[1];
+			if(IO::getBoolean(entity))
+				++summary.numTrues;
+			break;
+		
+		case IO::JsonEntity::NUMBER:
+			++summary.numValues[2];
+			summary.addNumber(IO::getNumber(entity));
+			break;
+		
+		case IO::JsonEntity::STRING:
+			++summary.numValues[3];
+			summary.stringLength+=IO::getString(entity).size();
+			break;
+		
+		case IO::JsonEntity::ARRAY:
+			{
+			++summary.numValues[4];
+			const IO::JsonArray::Array& array=IO::getArray(entity);
+			for(IO::JsonArray::Array::const_iterator aIt=array.begin();aIt!=array.end();++aIt)
+				summarize(*aIt,summary);
+			break;
+			}
+		
+		case IO::JsonEntity::OBJECT:
+			{
+			++summary.numValues[5];
+			const IO::JsonObject::Map& map=IO::getObject(entity);
+			for(IO::JsonObject::Map::ConstIterator mIt=map.begin();!mIt.isFinished();++mIt)
+				{
+				summary.stringLength+=mIt->getSource().size();
+				summarize(mIt->getDest(),summary);
+				}
+			break;
+			}
+		}
+	}
+
+void summarize(const IO::JsonDocument::Value& value,Summary& summary) // Summarizes an arena-based JSON document
+	{
+	switch(value.getType())
+		{
+		case IO::JsonDocument::NULLVALUE:
+			++summary.numValues[0];
+			break;
+		
+		case IO::JsonDocument::BOOLEAN:
+			++summary.numValues[1];
+			if(value.getBoolean())
+				++summary.numTrues;
+			break;
+		
+		case IO::JsonDocument::NUMBER:
+			++summary.numValues[2];
+			summary.addNumber(value.getNumber());
+			break;
+		
+		case IO::JsonDocument::STRING:
+			++summary.numValues[3];
+			summary.stringLength+=value.getStringLength();
+			break;
+		
+		case IO::JsonDocument::ARRAY:
+			++summary.numValues[4];
+			for(size_t i=0;i<value.getNumItems();++i)
+				summarize(value.getItem(i),summary);
+			break;
+		
+		case IO::JsonDocument::OBJECT:
+			++summary.numValues[5];
+			for(size_t i=0;i<value.getNumMembers();++i)
+				{
+				const IO::JsonDocument::Member& member=value.getMember(i);
+				summary.stringLength+=member.name.getStringLength();
+				summarize(member.value,summary);
+				}
+			break;
+		}
+	}
+
+IO::FilePtr createFile(const std::string& contents) // Returns a memory file containing the given contents
+	{
+	IO::FixedMemoryFile* file=new IO::FixedMemoryFile(contents.size());
+	memcpy(file->getMemory(),contents.data(),contents.size());
+	return file;
+	}
+
+long getPeakMemory(void) // Returns the peak resident set size of the calling process in KB
+	{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF,&usage);
+	return usage.ru_maxrss;
+	}
+
+int runMethod(int method,const std::string& contents,const Summary& reference) // Parses the given contents with the given method and reports throughput and peak memory
+	{
+	static const char* methodNames[3]={"JsonSource::parseEntity","JsonDocument","JsonSource::Handler"};
+	
+	long memoryBase=getPeakMemory();
+	Summary summary;
+	Misc::Timer t;
+	double parseTime;
+	size_t arenaSize=0;
+	switch(method)
+		{
+		case 0:
+			{
+			IO::JsonSource source(createFile(contents));
+			IO::JsonPointer root=source.parseEntity();
+			parseTime=t.peekTime();
+			summarize(root,summary);
+			break;
+			}
+		
+		case 1:
+			{
+			IO::JsonSource source(createFile(contents));
+			IO::JsonDocument document(source);
+			parseTime=t.peekTime();
+			arenaSize=document.getArenaSize();
+			summarize(document.getRoot(),summary);
+			break;
+			}
+		
+		default:
+			{
+			IO::JsonSource source(createFile(contents));
+			SummaryHandler handler;
+			source.parseEntity(handler);
+			parseTime=t.peekTime();
+			summary=handler.summary;
+			break;
+			}
+		}
+	long peakMemory=getPeakMemory()-memoryBase;
+	
+	double mb=double(contents.size())/(1024.0*1024.0);
+	std::cout<<methodNames[method]<<": "<<parseTime*1000.0<<" ms, "<<mb/parseTime<<" MB/s, peak memory +"<<double(peakMemory)/1024.0<<" MB";
+	if(method==1)
+		std::cout<<" (arena "<<double(arenaSize)/(1024.0*1024.0)<<" MB)";
+	std::cout<<std::endl;
+	if(!(summary==reference))
+		{
+		std::cout<<methodNames[method]<<" returned different values (INCORRECT)"<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numFeatures=200000;
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"f")==0&&argi+1<argc)
+				numFeatures=(unsigned int)(atoi(argv[++argi]));
+			else
+				std::cerr<<"Ignoring command line option "<<argv[argi]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring command line argument "<<argv[argi]<<std::endl;
+		}
+	
+	/* Generate a GeoJSON feature collection of points and line strings: */
+	std::string contents="{\"type\": \"FeatureCollection\",\n\"features\": [\n";
+	for(unsigned int i=0;i<numFeatures;++i)
+		{
+		char feature[1024];
+		int length=snprintf(feature,sizeof(feature),"{\"type\": \"Feature\", \"id\": %u, \"properties\": {\"name\": \"Feature \\\"%u\\\"\", \"magnitude\": %.3f, \"verified\": %s, \"remark\": null, \"tags\": [], \"links\": {}}, \"geometry\": ",i,i,Math::randUniformCO(0.0,10.0),Math::randUniformCO(0,2)!=0?"true":"false");
+		contents.append(feature,length);
+		if(i%4!=0)
+			{
+			length=snprintf(feature,sizeof(feature),"{\"type\": \"Point\", \"coordinates\": [%.6f, %.6f, %.1f]}",Math::randUniformCO(-180.0,180.0),Math::randUniformCO(-90.0,90.0),Math::randUniformCO(-700.0,0.0));
+			contents.append(feature,length);
+			}
+		else
+			{
+			contents.append("{\"type\": \"LineString\", \"coordinates\": [");
+			int numPoints=Math::randUniformCO(2,16);
+			for(int j=0;j<numPoints;++j)
+				{
+				length=snprintf(feature,sizeof(feature),j>0?", [%.6f, %.6f]":"[%.6f, %.6f]",Math::randUniformCO(-180.0,180.0),Math::randUniformCO(-90.0,90.0));
+				contents.append(feature,length);
+				}
+			contents.append("]}");
+			}
+		contents.append(i+1<numFeatures?"},\n":"}\n");
+		}
+	contents.append("]\n}\n");
+	std::cout<<numFeatures<<" features, "<<double(contents.size())/(1024.0*1024.0)<<" MB"<<std::endl;
+	
+	/* Summarize the file from its parsing events: */
+	Summary reference;
+	{
+	IO::JsonSource source(createFile(contents));
+	SummaryHandler handler;
+	source.parseEntity(handler);
+	reference=handler.summary;
+	}
+	
+	/* Run each parsing method in its own process to measure its peak memory use independently: */
+	int result=0;
+	for(int method=0;method<3;++method)
+		{
+		std::cout.flush();
+		pid_t child=fork();
+		if(child==0)
+			{
+			int childResult=runMethod(method,contents,reference);
+			std::cout.flush();
+			_exit(childResult);
+			}
+		else if(child>0)
+			{
+			int status;
+			waitpid(child,&status,0);
+			if(!WIFEXITED(status)||WEXITSTATUS(status)!=0)
+				result=1;
+			}
+		else
+			{
+			std::cerr<<"Unable to create benchmark process"<<std::endl;
+			return 1;
+			}
+		}
+	
+	return result;
+	}
@@ -0,0 +1,265 @@
+/***********************************************************************
+PointSearchBenchmark - Measures construction and nearest-neighbor query
+performance of the point search structures in the Templatized Geometry
+Library on random and clustered point sets.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Math/Random.h>
+#include <Geometry/Point.h>
+#include <Geometry/ValuedPoint.h>
+#include <Geometry/ClosePointSet.h>
+#include <Geometry/PointKdTree.h>
+#include <Geometry/PointOctree.h>
+#include <Geometry/ArrayKdTree.h>
+
+typedef float Scalar;
+typedef Geometry::Point<Scalar,3> Point;
+typedef Geometry::ValuedPoint<Point,int> StoredPoint;
+typedef Geometry::PointKdTree<Scalar,3,StoredPoint> KdTree;
+typedef Geometry::PointOctree<Scalar,StoredPoint> Octree;
+typedef Geometry::ArrayKdTree<StoredPoint> ArrayTree;
+typedef Geometry::ClosePointSet<StoredPoint> ClosePointSet;
+
+void createPoints(int numPoints,bool clustered,StoredPoint points[])
+	{
+	if(clustered)
+		{
+		/* Create a small number of tight Gaussian clusters of different sizes inside the unit cube: */
+		const int numClusters=32;
+		Point centers[numClusters];
+		double sigmas[numClusters];
+		for(int i=0;i<numClusters;++i)
+			{
+			for(int j=0;j<3;++j)
+				centers[i][j]=Scalar(Math::randUniformCC(0.1,0.9));
+			sigmas[i]=Math::randUniformCC(0.002,0.02);
+			}
+		for(int i=0;i<numPoints;++i)
+			{
+			int cluster=Math::randUniformCO(0,numClusters);
+			for(int j=0;j<3;++j)
+				points[i][j]=Scalar(Math::randNormal(centers[cluster][j],sigmas[cluster]));
+			points[i].value=i;
+			}
+		}
+	else
+		{
+		/* Create uniformly distributed points inside the unit cube: */
+		for(int i=0;i<numPoints;++i)
+			{
+			for(int j=0;j<3;++j)
+				points[i][j]=Scalar(Math::randUniformCO());
+			points[i].value=i;
+			}
+		}
+	}
+
+void printTime(const char* phase,double time,double referenceTime)
+	{
+	std::cout<<"  "<<phase<<": "<<time*1000.0<<" ms";
+	if(referenceTime>0.0)
+		std::cout<<" (speedup "<<referenceTime/time<<")";
+	std::cout<<std::endl;
+	}
+
+bool checkClosestPoints(int numQueries,const Point queries[],const StoredPoint* const results1[],const StoredPoint* const results2[])
+	{
+	/* Compare distances instead of pointers, to allow for ties: */
+	for(int i=0;i<numQueries;++i)
+		if(Geometry::sqrDist(queries[i],*results1[i])!=Geometry::sqrDist(queries[i],*results2[i]))
+			return false;
+	return true;
+	}
+
+bool checkClosePointSets(int numQueries,const ClosePointSet sets1[],const ClosePointSet sets2[])
+	{
+	for(int i=0;i<numQueries;++i)
+		{
+		if(sets1[i].getNumPoints()!=sets2[i].getNumPoints())
+			return false;
+		for(int j=0;j<sets1[i].getNumPoints();++j)
+			if(sets1[i].getSqrDist(j)!=sets2[i].getSqrDist(j))
+				return false;
+		}
+	return true;
+	}
+
+void runBenchmark(int numPoints,bool clustered,int numQueries,int numNeighbors,int numThreads)
+	{
+	std::cout<<(clustered?"Clustered":"Random")<<" point set with "<<numPoints<<" points:"<<std::endl;
+	
+	/* Create the point set and random query positions: */
+	StoredPoint* points=new StoredPoint[numPoints];
+	createPoints(numPoints,clustered,points);
+	std::vector<Point> randomQueries(numQueries);
+	for(int i=0;i<numQueries;++i)
+		for(int j=0;j<3;++j)
+			randomQueries[i][j]=Scalar(Math::randUniformCO());
+	
+	Misc::Timer t;
+	
+	/* Build point kd-trees with one and with multiple threads: */
+	StoredPoint* kdPoints=new StoredPoint[numPoints];
+	memcpy(kdPoints,points,numPoints*sizeof(StoredPoint));
+	t.elapse();
+	KdTree kdTree1(numPoints,kdPoints);
+	t.elapse();
+	double serialTime=t.getTime();
+	printTime("PointKdTree construction, 1 thread",serialTime,0.0);
+	memcpy(kdPoints,points,numPoints*sizeof(StoredPoint));
+	t.elapse();
+	KdTree kdTree(numPoints,kdPoints,numThreads);
+	t.elapse();
+	printTime("PointKdTree construction, multiple threads",t.getTime(),serialTime);
+	
+	/* Use the first points in implicit kd-tree order as coherent queries, as in normal estimation: */
+	int numCoherentQueries=numQueries<numPoints?numQueries:numPoints;
+	std::vector<Point> coherentQueries(numCoherentQueries);
+	for(int i=0;i<numCoherentQueries;++i)
+		coherentQueries[i]=kdPoints[i];
+	
+	/* Find closest points one query at a time and in batches: */
+	std::vector<const StoredPoint*> results1(numQueries),results2(numQueries);
+	t.elapse();
+	for(int i=0;i<numQueries;++i)
+		results1[i]=&kdTree.findClosestPoint(randomQueries[i]);
+	t.elapse();
+	serialTime=t.getTime();
+	printTime("PointKdTree closest point, single queries",serialTime,0.0);
+	kdTree.findClosestPoint(numQueries,&randomQueries[0],&results2[0],numThreads);
+	t.elapse();
+	printTime("PointKdTree closest point, batch query",t.getTime(),serialTime);
+	if(!checkClosestPoints(numQueries,&randomQueries[0],&results1[0],&results2[0]))
+		std::cout<<"  Batch query results do not match!"<<std::endl;
+	
+	/* Find sets of closest points one query at a time and in batches: */
+	std::vector<ClosePointSet> sets1(numCoherentQueries,ClosePointSet(numNeighbors));
+	std::vector<ClosePointSet> sets2(numCoherentQueries,ClosePointSet(numNeighbors));
+	t.elapse();
+	for(int i=0;i<numCoherentQueries;++i)
+		kdTree.findClosestPoints(coherentQueries[i],sets1[i]);
+	t.elapse();
+	serialTime=t.getTime();
+	printTime("PointKdTree closest points, single queries",serialTime,0.0);
+	kdTree.findClosestPoints(numCoherentQueries,&coherentQueries[0],&sets2[0],numThreads);
+	t.elapse();
+	printTime("PointKdTree closest points, batch query",t.getTime(),serialTime);
+	if(!checkClosePointSets(numCoherentQueries,&sets1[0],&sets2[0]))
+		std::cout<<"  Batch query results do not match!"<<std::endl;
+	
+	/* Build array kd-trees and find sets of closest points in batches: */
+	ArrayTree arrayTree;
+	t.elapse();
+	arrayTree.setPoints(numPoints,points,numThreads);
+	t.elapse();
+	printTime("ArrayKdTree construction, multiple threads",t.getTime(),0.0);
+	t.elapse();
+	for(int i=0;i<numCoherentQueries;++i)
+		arrayTree.findClosestPoints(coherentQueries[i],sets1[i]);
+	t.elapse();
+	serialTime=t.getTime();
+	printTime("ArrayKdTree closest points, single queries",serialTime,0.0);
+	arrayTree.findClosestPoints(numCoherentQueries,&coherentQueries[0],&sets2[0],numThreads);
+	t.elapse();
+	printTime("ArrayKdTree closest points, batch query",t.getTime(),serialTime);
+	if(!checkClosePointSets(numCoherentQueries,&sets1[0],&sets2[0]))
+		std::cout<<"  Batch query results do not match!"<<std::endl;
+	
+	/* Build octrees with one and with multiple threads; octrees adopt their point arrays: */
+	Point min(Scalar(-0.5),Scalar(-0.5),Scalar(-0.5));
+	Point max(Scalar(1.5),Scalar(1.5),Scalar(1.5));
+	StoredPoint* octPoints=new StoredPoint[numPoints];
+	memcpy(octPoints,points,numPoints*sizeof(StoredPoint));
+	t.elapse();
+	Octree octree1(min,max,numPoints,octPoints,16,32);
+	t.elapse();
+	serialTime=t.getTime();
+	printTime("PointOctree construction, 1 thread",serialTime,0.0);
+	octPoints=new StoredPoint[numPoints];
+	memcpy(octPoints,points,numPoints*sizeof(StoredPoint));
+	t.elapse();
+	Octree octree(min,max,numPoints,octPoints,16,32,numThreads);
+	t.elapse();
+	printTime("PointOctree construction, multiple threads",t.getTime(),serialTime);
+	
+	/* Find closest points one query at a time and in batches: */
+	t.elapse();
+	for(int i=0;i<numQueries;++i)
+		results1[i]=&octree.findClosestPoint(randomQueries[i]);
+	t.elapse();
+	serialTime=t.getTime();
+	printTime("PointOctree closest point, single queries",serialTime,0.0);
+	octree.findClosestPoint(numQueries,&randomQueries[0],&results2[0],numThreads);
+	t.elapse();
+	printTime("PointOctree closest point, batch query",t.getTime(),serialTime);
+	if(!checkClosestPoints(numQueries,&randomQueries[0],&results1[0],&results2[0]))
+		std::cout<<"  Batch query results do not match!"<<std::endl;
+	
+	delete[] kdPoints;
+	delete[] points;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int numPoints=1000000;
+	int numQueries=200000;
+	int numNeighbors=16;
+	int numThreads=int(sysconf(_SC_NPROCESSORS_ONLN));
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"n")==0&&argi+1<argc)
+				numPoints=atoi(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"q")==0&&argi+1<argc)
+				numQueries=atoi(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"k")==0&&argi+1<argc)
+				numNeighbors=atoi(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"t")==0&&argi+1<argc)
+				numThreads=atoi(argv[++argi]);
+			else
+				std::cerr<<"Ignoring command line option "<<argv[argi]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring command line argument "<<argv[argi]<<std::endl;
+		}
+	if(numPoints<1||numQueries<1||numNeighbors<1)
+		{
+		std::cerr<<"Invalid number of points, queries, or neighbors"<<std::endl;
+		return 1;
+		}
+	if(numThreads<1)
+		numThreads=1;
+	std::cout<<"Using "<<numThreads<<" threads"<<std::endl;
+	
+	/* Run the benchmark on random and clustered point sets: */
+	runBenchmark(numPoints,false,numQueries,numNeighbors,numThreads);
+	runBenchmark(numPoints,true,numQueries,numNeighbors,numThreads);
+	
+	return 0;
+	}
@@ -0,0 +1,180 @@
+/***********************************************************************
+PointTransformBenchmark - Measures the throughput of the scene graph's
+point transformation nodes when transforming large point sets one point
+at a time and in batches.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+#include <vector>
+#include <Misc/Autopointer.h>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Math/Random.h>
+#include <Geometry/Point.h>
+#include <SceneGraph/Geometry.h>
+#include <SceneGraph/PointTransformNode.h>
+#include <SceneGraph/ReferenceEllipsoidNode.h>
+#include <SceneGraph/AffinePointTransformNode.h>
+#include <SceneGraph/GeodeticToCartesianPointTransformNode.h>
+#include <SceneGraph/UTMPointTransformNode.h>
+
+typedef SceneGraph::Point Point;
+typedef SceneGraph::PointTransformNode::TPoint TPoint;
+
+class CopyConsumer:public SceneGraph::PointTransformNode::BatchConsumer // Class to copy batches of transformed points into a result array
+	{
+	/* Elements: */
+	private:
+	TPoint* result; // The result array
+	
+	/* Constructors and destructors: */
+	public:
+	CopyConsumer(TPoint* sResult)
+		:result(sResult)
+		{
+		}
+	
+	/* Methods from class SceneGraph::PointTransformNode::BatchConsumer: */
+	virtual void consumeBatch(size_t first,size_t numPoints,const TPoint transformedPoints[])
+		{
+		for(size_t i=0;i<numPoints;++i)
+			result[first+i]=transformedPoints[i];
+		}
+	};
+
+void runBenchmark(const char* name,const SceneGraph::PointTransformNode& transform,const std::vector<Point>& points,int numThreads)
+	{
+	std::cout<<name<<" with "<<points.size()<<" points:"<<std::endl;
+	size_t numPoints=points.size();
+	
+	Misc::Timer t;
+	
+	/* Transform all points individually through the virtual per-point method: */
+	std::vector<TPoint> result1(numPoints);
+	t.elapse();
+	for(size_t i=0;i<numPoints;++i)
+		result1[i]=transform.transformPoint(TPoint(points[i]));
+	t.elapse();
+	double timeSingle=t.getTime();
+	
+	/* Transform all points in a batch using a single thread: */
+	std::vector<TPoint> result2(numPoints);
+	t.elapse();
+	transform.transformPoints(numPoints,&points[0],&result2[0],1);
+	t.elapse();
+	double timeBatch=t.getTime();
+	
+	/* Transform all points in a batch using multiple threads: */
+	std::vector<TPoint> result3(numPoints);
+	t.elapse();
+	transform.transformPoints(numPoints,&points[0],&result3[0],numThreads);
+	t.elapse();
+	double timeThreaded=t.getTime();
+	
+	/* Transform all points in batches using multiple threads started once for all batches: */
+	std::vector<TPoint> result4(numPoints);
+	CopyConsumer consumer(&result4[0]);
+	t.elapse();
+	transform.transformPointBatches(numPoints,&points[0],262144,consumer,numThreads);
+	t.elapse();
+	double timeBatches=t.getTime();
+	
+	/* Compare the results: */
+	double maxDist=0.0;
+	for(size_t i=0;i<numPoints;++i)
+		{
+		maxDist=Math::max(maxDist,Geometry::dist(result1[i],result2[i]));
+		maxDist=Math::max(maxDist,Geometry::dist(result1[i],result3[i]));
+		maxDist=Math::max(maxDist,Geometry::dist(result1[i],result4[i]));
+		}
+	
+	std::cout<<"  Per-point: "<<timeSingle*1000.0<<" ms ("<<double(numPoints)*1.0e-6/timeSingle<<" Mpoints/s)"<<std::endl;
+	std::cout<<"  Batch, 1 thread: "<<timeBatch*1000.0<<" ms ("<<double(numPoints)*1.0e-6/timeBatch<<" Mpoints/s, speedup "<<timeSingle/timeBatch<<")"<<std::endl;
+	std::cout<<"  Batch, "<<numThreads<<" threads: "<<timeThreaded*1000.0<<" ms ("<<double(numPoints)*1.0e-6/timeThreaded<<" Mpoints/s, speedup "<<timeSingle/timeThreaded<<")"<<std::endl;
+	std::cout<<"  Batches of 262144, "<<numThreads<<" threads: "<<timeBatches*1000.0<<" ms ("<<double(numPoints)*1.0e-6/timeBatches<<" Mpoints/s, speedup "<<timeSingle/timeBatches<<")"<<std::endl;
+	std::cout<<"  Maximum deviation from per-point results: "<<maxDist<<std::endl;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int numPoints=4000000;
+	int numThreads=int(sysconf(_SC_NPROCESSORS_ONLN));
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"n")==0&&argi+1<argc)
+				numPoints=atoi(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"t")==0&&argi+1<argc)
+				numThreads=atoi(argv[++argi]);
+			else
+				std::cerr<<"Ignoring command line option "<<argv[argi]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring command line argument "<<argv[argi]<<std::endl;
+		}
+	if(numPoints<1)
+		{
+		std::cerr<<"Invalid number of points"<<std::endl;
+		return 1;
+		}
+	if(numThreads<1)
+		numThreads=1;
+	std::cout<<"Using "<<numThreads<<" threads"<<std::endl;
+	
+	/* Create random geodetic points in degrees and elevations in meters covering a city-sized area: */
+	std::vector<Point> geodeticPoints(numPoints);
+	for(int i=0;i<numPoints;++i)
+		geodeticPoints[i]=Point(Math::randUniformCC(-121.8,-121.6),Math::randUniformCC(38.5,38.6),Math::randUniformCC(0.0,100.0));
+	
+	/* Create random points in UTM zone 10 map coordinates covering the same area: */
+	std::vector<Point> mapPoints(numPoints);
+	for(int i=0;i<numPoints;++i)
+		mapPoints[i]=Point(Math::randUniformCC(6.0e5,6.2e5),Math::randUniformCC(4.26e6,4.27e6),Math::randUniformCC(0.0,100.0));
+	
+	/* Benchmark a geodetic to Cartesian transformation: */
+	Misc::Autopointer<SceneGraph::GeodeticToCartesianPointTransformNode> geodeticTransform=new SceneGraph::GeodeticToCartesianPointTransformNode;
+	geodeticTransform->degrees.setValue(true);
+	geodeticTransform->update();
+	runBenchmark("GeodeticToCartesianPointTransform",*geodeticTransform,geodeticPoints,numThreads);
+	
+	/* Benchmark a UTM unprojection: */
+	Misc::Autopointer<SceneGraph::UTMPointTransformNode> utmTransform=new SceneGraph::UTMPointTransformNode;
+	SceneGraph::ReferenceEllipsoidNodePointer utmEllipsoid=new SceneGraph::ReferenceEllipsoidNode;
+	utmEllipsoid->scale.setValue(1.0);
+	utmEllipsoid->update();
+	utmTransform->referenceEllipsoid.setValue(utmEllipsoid);
+	utmTransform->zone.setValue(10);
+	utmTransform->degrees.setValue(true);
+	utmTransform->update();
+	runBenchmark("UTMPointTransform",*utmTransform,mapPoints,numThreads);
+	
+	/* Benchmark an affine transformation: */
+	Misc::Autopointer<SceneGraph::AffinePointTransformNode> affineTransform=new SceneGraph::AffinePointTransformNode;
+	affineTransform->update();
+	runBenchmark("AffinePointTransform",*affineTransform,geodeticPoints,numThreads);
+	
+	return 0;
+	}
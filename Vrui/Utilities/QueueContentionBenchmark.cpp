@@ -0,0 +1,178 @@
+/***********************************************************************
+QueueContentionBenchmark - Measures the throughput of the mutex-based
+bounded queue and the lock-free single- and multi-producer/consumer
+queues under contention from varying numbers of producer and consumer
+threads.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Threads/Thread.h>
+#include <Threads/LimitedQueue.h>
+#include <Threads/SPSCQueue.h>
+#include <Threads/MPMCQueue.h>
+
+typedef unsigned long long Item; // Type for queue items, encoding producer index and sequence number
+
+struct ThreadResult // Structure for the results of a producer or consumer thread
+	{
+	/* Elements: */
+	public:
+	Item checksum; // Sum of all items popped by a consumer
+	bool ordered; // Flag whether a consumer received each producer's items in order
+	};
+
+template <class QueueParam>
+class Benchmark // Class to run a contention benchmark on a queue type
+	{
+	/* Elements: */
+	private:
+	QueueParam& queue; // The benchmarked queue
+	unsigned int numProducers,numConsumers; // Number of producer and consumer threads
+	size_t numItemsPerProducer; // Number of items pushed by each producer
+	size_t numItemsPerConsumer; // Number of items popped by each consumer
+	std::vector<ThreadResult> consumerResults; // Results of all consumers
+	
+	/* Private methods: */
+	void* producerThreadMethod(unsigned int producerIndex)
+		{
+		Item base=Item(producerIndex)<<40;
+		for(size_t i=0;i<numItemsPerProducer;++i)
+			queue.push(base+Item(i));
+		return 0;
+		}
+	void* consumerThreadMethod(unsigned int consumerIndex)
+		{
+		ThreadResult& result=consumerResults[consumerIndex];
+		result.checksum=0;
+		result.ordered=true;
+		std::vector<Item> lastItems(numProducers,~Item(0));
+		for(size_t i=0;i<numItemsPerConsumer;++i)
+			{
+			Item item=queue.pop();
+			result.checksum+=item;
+			
+			/* Check that items from the same producer arrive in order: */
+			unsigned int producer=(unsigned int)(item>>40);
+			if(lastItems[producer]!=~Item(0)&&lastItems[producer]>=item)
+				result.ordered=false;
+			lastItems[producer]=item;
+			}
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	Benchmark(QueueParam& sQueue,unsigned int sNumProducers,unsigned int sNumConsumers,size_t numItems)
+		:queue(sQueue),numProducers(sNumProducers),numConsumers(sNumConsumers),
+		 numItemsPerProducer(numItems/numProducers),numItemsPerConsumer(numItems/numConsumers),
+		 consumerResults(numConsumers)
+		{
+		}
+	
+	/* Methods: */
+	bool run(double& time) // Runs the benchmark; returns true if all items were received correctly
+		{
+		Misc::Timer t;
+		std::vector<Threads::Thread> consumers(numConsumers);
+		for(unsigned int i=0;i<numConsumers;++i)
+			consumers[i].start(this,&Benchmark::consumerThreadMethod,i);
+		std::vector<Threads::Thread> producers(numProducers);
+		for(unsigned int i=0;i<numProducers;++i)
+			producers[i].start(this,&Benchmark::producerThreadMethod,i);
+		for(unsigned int i=0;i<numProducers;++i)
+			producers[i].join();
+		for(unsigned int i=0;i<numConsumers;++i)
+			consumers[i].join();
+		time=t.peekTime();
+		
+		/* Check the results: */
+		Item expectedChecksum=0;
+		for(unsigned int p=0;p<numProducers;++p)
+			expectedChecksum+=(Item(p)<<40)*Item(numItemsPerProducer)+Item(numItemsPerProducer)*Item(numItemsPerProducer-1)/2;
+		Item checksum=0;
+		bool ordered=true;
+		for(unsigned int c=0;c<numConsumers;++c)
+			{
+			checksum+=consumerResults[c].checksum;
+			ordered=ordered&&consumerResults[c].ordered;
+			}
+		return checksum==expectedChecksum&&ordered;
+		}
+	};
+
+template <class QueueParam>
+bool runBenchmark(const char* name,unsigned int numProducers,unsigned int numConsumers,size_t numItems,size_t queueSize)
+	{
+	QueueParam queue(queueSize);
+	Benchmark<QueueParam> benchmark(queue,numProducers,numConsumers,numItems);
+	double time;
+	bool ok=benchmark.run(time);
+	std::cout<<"  "<<name<<": "<<time*1000.0<<" ms, "<<double(numItems)/time*1.0e-6<<" M items/s"<<(ok?"":" (INCORRECT)")<<std::endl;
+	return ok;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	size_t numItems=1000000;
+	size_t queueSize=1024;
+	unsigned int maxNumThreads=4;
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"n")==0&&argi+1<argc)
+				numItems=size_t(atol(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"q")==0&&argi+1<argc)
+				queueSize=size_t(atol(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"t")==0&&argi+1<argc)
+				maxNumThreads=(unsigned int)(atoi(argv[++argi]));
+			else
+				std::cerr<<"Ignoring command line option "<<argv[argi]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring command line argument "<<argv[argi]<<std::endl;
+		}
+	if(numItems<1||queueSize<1||maxNumThreads<1)
+		{
+		std::cerr<<"Invalid benchmark parameters"<<std::endl;
+		return 1;
+		}
+	
+	bool allOk=true;
+	for(unsigned int numProducers=1;numProducers<=maxNumThreads;numProducers*=2)
+		for(unsigned int numConsumers=1;numConsumers<=maxNumThreads;numConsumers*=2)
+			{
+			/* Round the number of items to a multiple of the numbers of producers and consumers: */
+			size_t n=numItems-numItems%(numProducers*numConsumers);
+			std::cout<<numProducers<<" producer(s), "<<numConsumers<<" consumer(s), "<<n<<" items, queue size "<<queueSize<<":"<<std::endl;
+			allOk=runBenchmark<Threads::LimitedQueue<Item> >("LimitedQueue",numProducers,numConsumers,n,queueSize)&&allOk;
+			if(numProducers==1&&numConsumers==1)
+				allOk=runBenchmark<Threads::SPSCQueue<Item> >("SPSCQueue   ",numProducers,numConsumers,n,queueSize)&&allOk;
+			allOk=runBenchmark<Threads::MPMCQueue<Item> >("MPMCQueue   ",numProducers,numConsumers,n,queueSize)&&allOk;
+			}
+	
+	return allOk?0:1;
+	}
@@ -0,0 +1,253 @@
+/***********************************************************************
+SketchIndexBenchmark - Measures the cost of picking and erasing large
+numbers of sketched strokes through a linear scan and through a spatial
+hash grid of control points, and optionally writes the generated strokes
+to a curve file to stress-test the curve editor tool's rendering.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Math/Random.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <Geometry/Box.h>
+#include <Geometry/PointHashGrid.h>
+
+typedef double Scalar;
+typedef Geometry::Point<Scalar,3> Point;
+typedef Geometry::Vector<Scalar,3> Vector;
+typedef Geometry::Box<Scalar,3> Box;
+
+struct Stroke // Structure for a generated stroke
+	{
+	/* Elements: */
+	public:
+	std::vector<Point> points; // The stroke's control points
+	Box boundingBox; // The stroke's bounding box
+	
+	/* Methods: */
+	bool pick(const Point& p,Scalar radius2) const // Picks the stroke the way the curve editor tool used to
+		{
+		if(boundingBox.sqrDist(p)>radius2)
+			return false;
+		for(std::vector<Point>::const_iterator pIt=points.begin();pIt!=points.end();++pIt)
+			if(Geometry::sqrDist(p,*pIt)<=radius2)
+				return true;
+		return false;
+		}
+	};
+
+typedef Geometry::PointHashGrid<Scalar,3,unsigned int> StrokeGrid;
+
+struct StrokeCollector // Functor class to collect the indices of strokes found in a stroke grid
+	{
+	/* Elements: */
+	public:
+	std::vector<unsigned int> strokes;
+	
+	/* Methods: */
+	void operator()(const StrokeGrid::Entry& entry)
+		{
+		strokes.push_back(entry.value);
+		}
+	};
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int numStrokes=20000;
+	int numStrokePoints=100;
+	int numQueries=10000;
+	Scalar radius=0.05;
+	const char* curveFileName=0;
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"n")==0&&argi+1<argc)
+				numStrokes=atoi(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"p")==0&&argi+1<argc)
+				numStrokePoints=atoi(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"q")==0&&argi+1<argc)
+				numQueries=atoi(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"r")==0&&argi+1<argc)
+				radius=Scalar(atof(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"o")==0&&argi+1<argc)
+				curveFileName=argv[++argi];
+			else
+				std::cerr<<"Ignoring command line option "<<argv[argi]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring command line argument "<<argv[argi]<<std::endl;
+		}
+	if(numStrokes<1||numStrokePoints<2||numQueries<1||radius<=Scalar(0))
+		{
+		std::cerr<<"Invalid benchmark parameters"<<std::endl;
+		return 1;
+		}
+	
+	/* Generate random-walk strokes inside a cube of side length 10: */
+	std::vector<Stroke> strokes(numStrokes);
+	for(int i=0;i<numStrokes;++i)
+		{
+		Stroke& s=strokes[i];
+		s.boundingBox=Box::empty;
+		Point p(Math::randUniformCC(0.0,10.0),Math::randUniformCC(0.0,10.0),Math::randUniformCC(0.0,10.0));
+		Vector dir(Math::randNormal(0.0,1.0),Math::randNormal(0.0,1.0),Math::randNormal(0.0,1.0));
+		dir.normalize();
+		for(int j=0;j<numStrokePoints;++j)
+			{
+			s.points.push_back(p);
+			s.boundingBox.addPoint(p);
+			dir+=Vector(Math::randNormal(0.0,0.3),Math::randNormal(0.0,0.3),Math::randNormal(0.0,0.3));
+			dir.normalize();
+			p+=dir*Scalar(0.01);
+			}
+		}
+	std::cout<<numStrokes<<" strokes with "<<numStrokePoints<<" control points each"<<std::endl;
+	
+	/* Generate random query points: */
+	std::vector<Point> queries(numQueries);
+	for(int i=0;i<numQueries;++i)
+		queries[i]=Point(Math::randUniformCC(0.0,10.0),Math::randUniformCC(0.0,10.0),Math::randUniformCC(0.0,10.0));
+	Scalar radius2=Math::sqr(radius);
+	
+	Misc::Timer t;
+	
+	/* Build the stroke grid: */
+	t.elapse();
+	StrokeGrid grid(radius*Scalar(2));
+	for(int i=0;i<numStrokes;++i)
+		for(std::vector<Point>::iterator pIt=strokes[i].points.begin();pIt!=strokes[i].points.end();++pIt)
+			grid.insert(*pIt,(unsigned int)(i));
+	t.elapse();
+	std::cout<<"Grid construction: "<<t.getTime()*1000.0<<" ms, "<<grid.getNumCells()<<" occupied cells"<<std::endl;
+	
+	/* Pick strokes by linear scan: */
+	std::vector<std::vector<unsigned int> > linearHits(numQueries);
+	t.elapse();
+	for(int q=0;q<numQueries;++q)
+		for(int i=0;i<numStrokes;++i)
+			if(strokes[i].pick(queries[q],radius2))
+				linearHits[q].push_back((unsigned int)(i));
+	t.elapse();
+	double timeLinear=t.getTime();
+	
+	/* Pick strokes through the grid: */
+	std::vector<std::vector<unsigned int> > gridHits(numQueries);
+	t.elapse();
+	for(int q=0;q<numQueries;++q)
+		{
+		StrokeCollector collector;
+		grid.processPointsInSphere(queries[q],radius,collector);
+		std::sort(collector.strokes.begin(),collector.strokes.end());
+		collector.strokes.erase(std::unique(collector.strokes.begin(),collector.strokes.end()),collector.strokes.end());
+		gridHits[q].swap(collector.strokes);
+		}
+	t.elapse();
+	double timeGrid=t.getTime();
+	
+	size_t numHits=0;
+	int numMismatches=0;
+	for(int q=0;q<numQueries;++q)
+		{
+		numHits+=linearHits[q].size();
+		if(linearHits[q]!=gridHits[q])
+			++numMismatches;
+		}
+	std::cout<<"Picking "<<numQueries<<" queries ("<<numHits<<" hits):"<<std::endl;
+	std::cout<<"  Linear scan: "<<timeLinear*1000.0<<" ms ("<<timeLinear*1.0e6/double(numQueries)<<" us/query)"<<std::endl;
+	std::cout<<"  Hash grid: "<<timeGrid*1000.0<<" ms ("<<timeGrid*1.0e6/double(numQueries)<<" us/query, speedup "<<timeLinear/timeGrid<<")"<<std::endl;
+	std::cout<<"  Mismatched queries: "<<numMismatches<<std::endl;
+	
+	/* Erase strokes by linear scan, emulating the curve editor tool's eraser: */
+	std::vector<unsigned int> liveStrokes(numStrokes);
+	for(int i=0;i<numStrokes;++i)
+		liveStrokes[i]=(unsigned int)(i);
+	size_t numErasedLinear=0;
+	t.elapse();
+	for(int q=0;q<numQueries;++q)
+		for(size_t i=0;i<liveStrokes.size();++i)
+			if(strokes[liveStrokes[i]].pick(queries[q],radius2))
+				{
+				liveStrokes[i]=liveStrokes.back();
+				liveStrokes.pop_back();
+				--i;
+				++numErasedLinear;
+				}
+	t.elapse();
+	double timeEraseLinear=t.getTime();
+	
+	/* Erase strokes through the grid: */
+	size_t numErasedGrid=0;
+	t.elapse();
+	for(int q=0;q<numQueries;++q)
+		{
+		StrokeCollector collector;
+		grid.processPointsInSphere(queries[q],radius,collector);
+		std::sort(collector.strokes.begin(),collector.strokes.end());
+		std::vector<unsigned int>::iterator end=std::unique(collector.strokes.begin(),collector.strokes.end());
+		for(std::vector<unsigned int>::iterator sIt=collector.strokes.begin();sIt!=end;++sIt)
+			{
+			for(std::vector<Point>::iterator pIt=strokes[*sIt].points.begin();pIt!=strokes[*sIt].points.end();++pIt)
+				grid.remove(*pIt,*sIt);
+			++numErasedGrid;
+			}
+		}
+	t.elapse();
+	double timeEraseGrid=t.getTime();
+	
+	std::cout<<"Erasing with "<<numQueries<<" queries:"<<std::endl;
+	std::cout<<"  Linear scan: "<<timeEraseLinear*1000.0<<" ms, "<<numErasedLinear<<" strokes erased"<<std::endl;
+	std::cout<<"  Hash grid: "<<timeEraseGrid*1000.0<<" ms, "<<numErasedGrid<<" strokes erased (speedup "<<timeEraseLinear/timeEraseGrid<<")"<<std::endl;
+	std::cout<<"  Remaining grid entries: "<<grid.getNumEntries()<<" (expected "<<(numStrokes-numErasedGrid)*numStrokePoints<<")"<<std::endl;
+	
+	if(curveFileName!=0)
+		{
+		/* Write all strokes to a curve file: */
+		FILE* curveFile=fopen(curveFileName,"w");
+		if(curveFile==0)
+			{
+			std::cerr<<"Unable to write curve file "<<curveFileName<<std::endl;
+			return 1;
+			}
+		fprintf(curveFile,"Vrui Curve Editor Tool Curve File\n%d\n",numStrokes);
+		for(int i=0;i<numStrokes;++i)
+			{
+			fprintf(curveFile,"\nCurve\n%g, %d %d %d\n%d\n",double(1+i%4),(i*53)%256,(i*97)%256,(i*151)%256,numStrokePoints);
+			for(int j=0;j<numStrokePoints;++j)
+				{
+				const Point& p=strokes[i].points[j];
+				fprintf(curveFile,"%g, %.8g %.8g %.8g\n",double(j)*0.01,p[0],p[1],p[2]);
+				}
+			}
+		fclose(curveFile);
+		std::cout<<"Wrote "<<numStrokes<<" strokes to curve file "<<curveFileName<<std::endl;
+		}
+	
+	return numMismatches==0&&numErasedLinear==numErasedGrid?0:1;
+	}
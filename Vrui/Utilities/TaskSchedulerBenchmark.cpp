@@ -0,0 +1,310 @@
+/***********************************************************************
+TaskSchedulerBenchmark - Compares running chunked parallel loops through
+a work-stealing task scheduler against the producer/consumer pattern of
+worker threads fed by a shared queue.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+#include <vector>
+#include <stdexcept>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Threads/Thread.h>
+#include <Threads/Queue.h>
+#include <Threads/TaskScheduler.h>
+
+/****************
+Benchmark kernel:
+****************/
+
+double processRange(const std::vector<double>& data,size_t begin,size_t end,int workPerItem) // Reduces a range of the data array with adjustable work per item
+	{
+	double result=0.0;
+	for(size_t i=begin;i<end;++i)
+		{
+		double x=data[i];
+		for(int j=0;j<workPerItem;++j)
+			x=Math::sin(x)+0.5;
+		result+=x;
+		}
+	return result;
+	}
+
+/**************************************
+Producer/consumer pattern with queues:
+**************************************/
+
+struct QueueJob // Structure for a chunk of work sent to a queue worker thread
+	{
+	/* Elements: */
+	public:
+	size_t chunkIndex; // Index of the chunk, or ~0 to shut down the worker thread
+	size_t begin,end; // Index range of the chunk
+	};
+
+class QueuePool // Class for a pool of worker threads fed by a shared job queue
+	{
+	/* Elements: */
+	private:
+	const std::vector<double>& data; // The processed data array
+	int workPerItem; // Amount of work per data item
+	std::vector<double>* partials; // Array of partial results for the current loop
+	Threads::Queue<QueueJob> jobs; // Queue of pending jobs
+	Threads::Queue<size_t> completions; // Queue of finished job indices
+	std::vector<Threads::Thread> workers; // Worker threads
+	
+	/* Private methods: */
+	void* workerThreadMethod(void)
+		{
+		while(true)
+			{
+			QueueJob job=jobs.pop();
+			if(job.chunkIndex==~size_t(0))
+				break;
+			(*partials)[job.chunkIndex]=processRange(data,job.begin,job.end,workPerItem);
+			completions.push(job.chunkIndex);
+			}
+		return 0;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	QueuePool(const std::vector<double>& sData,int sWorkPerItem,unsigned int numWorkers)
+		:data(sData),workPerItem(sWorkPerItem),partials(0),workers(numWorkers)
+		{
+		for(unsigned int i=0;i<numWorkers;++i)
+			workers[i].start(this,&QueuePool::workerThreadMethod);
+		}
+	~QueuePool(void)
+		{
+		QueueJob shutdown;
+		shutdown.chunkIndex=~size_t(0);
+		for(size_t i=0;i<workers.size();++i)
+			jobs.push(shutdown);
+		for(size_t i=0;i<workers.size();++i)
+			workers[i].join();
+		}
+	
+	/* Methods: */
+	double reduce(size_t chunkSize) // Reduces the data array in chunks of the given size
+		{
+		size_t numChunks=(data.size()+chunkSize-1)/chunkSize;
+		std::vector<double> chunkResults(numChunks);
+		partials=&chunkResults;
+		
+		/* Push all chunks into the job queue: */
+		for(size_t i=0;i<numChunks;++i)
+			{
+			QueueJob job;
+			job.chunkIndex=i;
+			job.begin=i*chunkSize;
+			job.end=job.begin+chunkSize<data.size()?job.begin+chunkSize:data.size();
+			jobs.push(job);
+			}
+		
+		/* Wait for all chunks to finish: */
+		for(size_t i=0;i<numChunks;++i)
+			completions.pop();
+		
+		/* Join the partial results in chunk order: */
+		double result=0.0;
+		for(size_t i=0;i<numChunks;++i)
+			result+=chunkResults[i];
+		return result;
+		}
+	};
+
+/********************************
+Functors for the task scheduler:
+********************************/
+
+struct RangeReducer // Functor to reduce a range of the data array
+	{
+	/* Elements: */
+	public:
+	const std::vector<double>& data;
+	int workPerItem;
+	
+	/* Constructors and destructors: */
+	RangeReducer(const std::vector<double>& sData,int sWorkPerItem)
+		:data(sData),workPerItem(sWorkPerItem)
+		{
+		}
+	
+	/* Methods: */
+	double operator()(size_t begin,size_t end) const
+		{
+		return processRange(data,begin,end,workPerItem);
+		}
+	};
+
+struct Adder // Functor to join two partial results
+	{
+	/* Methods: */
+	double operator()(double v1,double v2) const
+		{
+		return v1+v2;
+		}
+	};
+
+Threads::TaskScheduler* scheduler=0;
+
+unsigned int fibonacci(unsigned int n) // Calculates Fibonacci numbers by nested asynchronous calls
+	{
+	if(n<20)
+		return n<2?n:fibonacci(n-1)+fibonacci(n-2);
+	Threads::TaskScheduler::Future<unsigned int> f1=scheduler->async(fibonacci,n-1);
+	unsigned int f2=fibonacci(n-2);
+	return f1.get()+f2;
+	}
+
+unsigned int failingFunction(unsigned int n) // Function throwing an exception to test error propagation through futures
+	{
+	if(n==0U)
+		throw std::runtime_error("Expected error");
+	else if(n==1U)
+		throw std::logic_error("Expected logic error");
+	else
+		throw n;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	size_t numItems=1000000;
+	int workPerItem=4;
+	int numRounds=200;
+	unsigned int numThreads=0;
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"n")==0&&argi+1<argc)
+				numItems=size_t(atol(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"w")==0&&argi+1<argc)
+				workPerItem=atoi(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"r")==0&&argi+1<argc)
+				numRounds=atoi(argv[++argi]);
+			else if(strcasecmp(argv[argi]+1,"t")==0&&argi+1<argc)
+				numThreads=(unsigned int)(atoi(argv[++argi]));
+			else
+				std::cerr<<"Ignoring command line option "<<argv[argi]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring command line argument "<<argv[argi]<<std::endl;
+		}
+	if(numItems<1||workPerItem<1||numRounds<1)
+		{
+		std::cerr<<"Invalid benchmark parameters"<<std::endl;
+		return 1;
+		}
+	if(numThreads==0)
+		numThreads=(unsigned int)(sysconf(_SC_NPROCESSORS_ONLN));
+	
+	/* Create the data array: */
+	std::vector<double> data(numItems);
+	for(size_t i=0;i<numItems;++i)
+		data[i]=double(i%1000)*0.001;
+	
+	/* Create the queue-based pool and the task scheduler with the same total number of threads: */
+	QueuePool pool(data,workPerItem,numThreads);
+	Threads::TaskScheduler taskScheduler(numThreads>1?numThreads-1:1);
+	scheduler=&taskScheduler;
+	std::cout<<numItems<<" items, "<<workPerItem<<" work units per item, "<<numRounds<<" rounds, "<<numThreads<<" threads"<<std::endl;
+	
+	RangeReducer reducer(data,workPerItem);
+	Adder adder;
+	Misc::Timer t;
+	int numMismatches=0;
+	
+	/* Run the benchmark for a range of chunk sizes: */
+	size_t chunkSizes[]={65536,4096,256,16};
+	for(int cs=0;cs<4;++cs)
+		{
+		size_t chunkSize=chunkSizes[cs];
+		if(chunkSize>numItems)
+			continue;
+		
+		/* Run the loop serially: */
+		t.elapse();
+		double serialResult=0.0;
+		for(int round=0;round<numRounds;++round)
+			{
+			serialResult=0.0;
+			for(size_t begin=0;begin<numItems;begin+=chunkSize)
+				serialResult+=processRange(data,begin,begin+chunkSize<numItems?begin+chunkSize:numItems,workPerItem);
+			}
+		t.elapse();
+		double timeSerial=t.getTime();
+		
+		/* Run the loop through the queue-based pool: */
+		t.elapse();
+		double queueResult=0.0;
+		for(int round=0;round<numRounds;++round)
+			queueResult=pool.reduce(chunkSize);
+		t.elapse();
+		double timeQueue=t.getTime();
+		
+		/* Run the loop through the task scheduler: */
+		t.elapse();
+		double taskResult=0.0;
+		for(int round=0;round<numRounds;++round)
+			taskResult=taskScheduler.parallelReduce(size_t(0),numItems,chunkSize,0.0,reducer,adder);
+		t.elapse();
+		double timeTask=t.getTime();
+		
+		if(queueResult!=serialResult||taskResult!=serialResult)
+			++numMismatches;
+		
+		std::cout<<"Chunk size "<<chunkSize<<" ("<<(numItems+chunkSize-1)/chunkSize<<" chunks per round):"<<std::endl;
+		std::cout<<"  Serial         : "<<timeSerial*1000.0/double(numRounds)<<" ms/round"<<std::endl;
+		std::cout<<"  Queue pool     : "<<timeQueue*1000.0/double(numRounds)<<" ms/round (speedup "<<timeSerial/timeQueue<<")"<<std::endl;
+		std::cout<<"  Task scheduler : "<<timeTask*1000.0/double(numRounds)<<" ms/round (speedup "<<timeSerial/timeTask<<", "<<timeQueue/timeTask<<" vs. queue)"<<std::endl;
+		}
+	
+	/* Run nested parallelism through futures, which the queue-based pool cannot do without deadlocking: */
+	t.elapse();
+	unsigned int fib=fibonacci(30);
+	t.elapse();
+	std::cout<<"Nested futures: fibonacci(30)="<<fib<<" in "<<t.getTime()*1000.0<<" ms"<<std::endl;
+	if(fib!=832040U)
+		++numMismatches;
+	
+	/* Check error propagation through futures for runtime errors, other standard exceptions, and non-standard exceptions: */
+	for(unsigned int errorType=0U;errorType<3U;++errorType)
+		{
+		try
+			{
+			taskScheduler.async(failingFunction,errorType).get();
+			++numMismatches;
+			}
+		catch(const std::runtime_error& err)
+			{
+			std::cout<<"Caught error from future: "<<err.what()<<std::endl;
+			}
+		}
+	
+	std::cout<<"Mismatched results: "<<numMismatches<<std::endl;
+	return numMismatches==0?0:1;
+	}
@@ -0,0 +1,274 @@
+/***********************************************************************
+WidgetHitTestBenchmark - Measures the cost of localizing pointer events
+against a large number of popped-up dialog windows, and verifies the
+widget manager's results against an exhaustive search before and after
+re-laying out some of the dialogs.
+Copyright (c) 2021 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with the Virtual Reality User Interface Library; if not, write to
+the Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Math/Random.h>
+#include <Math/Constants.h>
+#include <GL/GLFont.h>
+#include <GLMotif/StyleSheet.h>
+#include <GLMotif/WidgetManager.h>
+#include <GLMotif/WidgetArranger.h>
+#include <GLMotif/Event.h>
+#include <GLMotif/PopupWindow.h>
+#include <GLMotif/RowColumn.h>
+#include <GLMotif/Button.h>
+
+typedef GLMotif::WidgetManager::Transformation Transformation;
+
+class FixedArranger:public GLMotif::WidgetArranger // Widget arranger that places top-level widgets exactly where requested
+	{
+	/* Methods from WidgetArranger: */
+	public:
+	virtual Transformation calcTopLevelTransform(GLMotif::Widget* topLevelWidget)
+		{
+		return Transformation::identity;
+		}
+	virtual Transformation calcTopLevelTransform(GLMotif::Widget* topLevelWidget,const Point& hotspot)
+		{
+		return Transformation::translateFromOriginTo(hotspot);
+		}
+	};
+
+GLMotif::Widget* findPrimaryWidgetExhaustive(GLMotif::WidgetManager& manager,const GLMotif::Ray& ray,GLMotif::Scalar& lambda) // Finds the closest primary widget hit by the given ray by testing all of them
+	{
+	lambda=Math::Constants<GLMotif::Scalar>::max;
+	GLMotif::Widget* result=0;
+	for(GLMotif::WidgetManager::PoppedWidgetIterator wIt=manager.beginPrimaryWidgets();wIt!=manager.endPrimaryWidgets();++wIt)
+		{
+		GLMotif::Ray widgetRay=ray;
+		widgetRay.inverseTransform(wIt.getWidgetToWorld());
+		GLMotif::Point intersection;
+		GLMotif::Scalar l=(*wIt)->intersectRay(widgetRay,intersection);
+		if(l>=GLMotif::Scalar(0)&&l<lambda&&(*wIt)->isInside(intersection))
+			{
+			result=*wIt;
+			lambda=l;
+			}
+		}
+	return result;
+	}
+
+GLMotif::Widget* findRecipientExhaustive(GLMotif::WidgetManager& manager,const GLMotif::Ray& ray) // Finds the widget receiving a pointer event along the given ray by asking all primary widgets
+	{
+	GLMotif::Event event(ray,false);
+	for(GLMotif::WidgetManager::PoppedWidgetIterator wIt=manager.beginPrimaryWidgets();wIt!=manager.endPrimaryWidgets();++wIt)
+		(*wIt)->findRecipient(event);
+	return event.getTargetWidget();
+	}
+
+unsigned int testRays(GLMotif::WidgetManager& manager,const std::vector<GLMotif::Ray>& rays,std::vector<GLMotif::RowColumn*>& buttonBoxes) // Localizes the given rays through the widget manager and exhaustively, and returns the number of differing results
+	{
+	unsigned int numRays=rays.size();
+	
+	/* Localize the rays exhaustively: */
+	std::vector<GLMotif::Widget*> exhaustiveResults;
+	exhaustiveResults.reserve(numRays);
+	Misc::Timer t1;
+	for(std::vector<GLMotif::Ray>::const_iterator rIt=rays.begin();rIt!=rays.end();++rIt)
+		{
+		GLMotif::Scalar lambda;
+		exhaustiveResults.push_back(findPrimaryWidgetExhaustive(manager,*rIt,lambda));
+		}
+	double exhaustiveTime=t1.peekTime();
+	
+	/* Localize the rays through the widget manager: */
+	std::vector<GLMotif::Widget*> managerResults;
+	managerResults.reserve(numRays);
+	Misc::Timer t2;
+	for(std::vector<GLMotif::Ray>::const_iterator rIt=rays.begin();rIt!=rays.end();++rIt)
+		{
+		GLMotif::Scalar lambda;
+		managerResults.push_back(manager.findPrimaryWidget(*rIt,lambda));
+		}
+	double managerTime=t2.peekTime();
+	
+	/* Deliver pointer motion events through the widget manager: */
+	std::vector<GLMotif::Widget*> motionTargets;
+	motionTargets.reserve(numRays);
+	unsigned int numTargets=0;
+	Misc::Timer t3;
+	for(std::vector<GLMotif::Ray>::const_iterator rIt=rays.begin();rIt!=rays.end();++rIt)
+		{
+		GLMotif::Event event(*rIt,false);
+		if(manager.pointerMotion(event))
+			++numTargets;
+		motionTargets.push_back(event.getTargetWidget());
+		}
+	double motionTime=t3.peekTime();
+	
+	/* Invalidate all cached child bounding boxes and find the pointer event targets exhaustively: */
+	for(std::vector<GLMotif::RowColumn*>::iterator bbIt=buttonBoxes.begin();bbIt!=buttonBoxes.end();++bbIt)
+		(*bbIt)->update();
+	std::vector<GLMotif::Widget*> exhaustiveTargets;
+	exhaustiveTargets.reserve(numRays);
+	for(std::vector<GLMotif::Ray>::const_iterator rIt=rays.begin();rIt!=rays.end();++rIt)
+		exhaustiveTargets.push_back(findRecipientExhaustive(manager,*rIt));
+	
+	/* Compare the results: */
+	unsigned int numHits=0;
+	unsigned int numMismatches=0;
+	for(unsigned int i=0;i<numRays;++i)
+		{
+		if(managerResults[i]!=0)
+			++numHits;
+		if(managerResults[i]!=exhaustiveResults[i]||motionTargets[i]!=exhaustiveTargets[i])
+			++numMismatches;
+		}
+	
+	std::cout<<"Exhaustive findPrimaryWidget: "<<exhaustiveTime*1.0e6/double(numRays)<<" us per ray"<<std::endl;
+	std::cout<<"WidgetManager findPrimaryWidget: "<<managerTime*1.0e6/double(numRays)<<" us per ray, "<<numHits<<" hits"<<std::endl;
+	std::cout<<"WidgetManager pointerMotion: "<<motionTime*1.0e6/double(numRays)<<" us per event, "<<numTargets<<" delivered"<<std::endl;
+	if(numMismatches!=0)
+		std::cout<<numMismatches<<" results differ from exhaustive search (INCORRECT)"<<std::endl;
+	
+	return numMismatches;
+	}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numDialogs=400;
+	unsigned int numButtons=24;
+	unsigned int numRays=20000;
+	const char* fontName="CenturySchoolbookBoldItalic";
+	for(int argi=1;argi<argc;++argi)
+		{
+		if(argv[argi][0]=='-')
+			{
+			if(strcasecmp(argv[argi]+1,"d")==0&&argi+1<argc)
+				numDialogs=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"b")==0&&argi+1<argc)
+				numButtons=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"r")==0&&argi+1<argc)
+				numRays=(unsigned int)(atoi(argv[++argi]));
+			else if(strcasecmp(argv[argi]+1,"font")==0&&argi+1<argc)
+				fontName=argv[++argi];
+			else
+				std::cerr<<"Ignoring command line option "<<argv[argi]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring command line argument "<<argv[argi]<<std::endl;
+		}
+	if(numDialogs<1||numButtons<1||numRays<1)
+		{
+		std::cerr<<"Invalid benchmark parameters"<<std::endl;
+		return 1;
+		}
+	
+	/* Create a widget manager: */
+	GLFont* font=new GLFont(fontName);
+	font->setTextHeight(1.0);
+	GLMotif::StyleSheet styleSheet;
+	styleSheet.setFont(font);
+	styleSheet.setSize(0.3f);
+	GLMotif::WidgetManager manager;
+	manager.setStyleSheet(&styleSheet);
+	manager.setArranger(new FixedArranger);
+	
+	/* Pop up dialogs of buttons on a grid of slightly staggered planes: */
+	unsigned int gridSize=1;
+	while(gridSize*gridSize<numDialogs)
+		++gridSize;
+	GLMotif::Scalar spacing(0);
+	std::vector<GLMotif::PopupWindow*> dialogs;
+	std::vector<GLMotif::RowColumn*> buttonBoxes;
+	for(unsigned int i=0;i<numDialogs;++i)
+		{
+		char name[32];
+		snprintf(name,sizeof(name),"Dialog%u",i);
+		GLMotif::PopupWindow* dialog=new GLMotif::PopupWindow(name,&manager,name);
+		GLMotif::RowColumn* buttons=new GLMotif::RowColumn("Buttons",dialog,false);
+		buttons->setOrientation(GLMotif::RowColumn::VERTICAL);
+		buttons->setPacking(GLMotif::RowColumn::PACK_GRID);
+		buttons->setNumMinorWidgets(4);
+		for(unsigned int j=0;j<numButtons;++j)
+			{
+			char label[32];
+			snprintf(label,sizeof(label),"Button %u",j);
+			new GLMotif::Button(label,buttons,label);
+			}
+		buttons->manageChild();
+		dialogs.push_back(dialog);
+		buttonBoxes.push_back(buttons);
+		
+		/* Lay out the dialogs on a grid large enough to hold the biggest one: */
+		if(spacing==GLMotif::Scalar(0))
+			{
+			GLMotif::Vector size=dialog->getExterior().size;
+			spacing=GLMotif::Scalar(Math::max(size[0],size[1]))*GLMotif::Scalar(1.25);
+			}
+		GLMotif::Point hotspot(GLMotif::Scalar(i%gridSize)*spacing,GLMotif::Scalar(i/gridSize)*spacing,GLMotif::Scalar(i%7)*GLMotif::Scalar(0.1));
+		manager.popupPrimaryWidget(dialog,hotspot);
+		}
+	GLMotif::Scalar extent=GLMotif::Scalar(gridSize)*spacing;
+	
+	/* Generate random rays pointing at the dialog grid: */
+	std::vector<GLMotif::Ray> rays;
+	rays.reserve(numRays);
+	for(unsigned int i=0;i<numRays;++i)
+		{
+		GLMotif::Point target(Math::randUniformCO(-spacing,extent),Math::randUniformCO(-spacing,extent),GLMotif::Scalar(0));
+		GLMotif::Point origin(target[0]+Math::randUniformCO(-spacing,spacing),target[1]+Math::randUniformCO(-spacing,spacing),extent);
+		rays.push_back(GLMotif::Ray(origin,target-origin));
+		}
+	std::cout<<numDialogs<<" dialogs with "<<numButtons<<" buttons each, "<<numRays<<" rays"<<std::endl;
+	
+	/* Test the initial dialog layout: */
+	unsigned int numMismatches=testRays(manager,rays,buttonBoxes);
+	
+	/* Re-lay out every other dialog by changing its title and button labels: */
+	for(unsigned int i=0;i<numDialogs;i+=2)
+		{
+		char title[32];
+		snprintf(title,sizeof(title),"Resized Dialog %u",i);
+		dialogs[i]->setTitleString(title);
+		GLMotif::RowColumn* buttons=buttonBoxes[i];
+		for(GLint j=0;j<GLint(numButtons);j+=3)
+			{
+			char label[32];
+			snprintf(label,sizeof(label),"Longer Button %d",j);
+			static_cast<GLMotif::Button*>(buttons->getChild(j))->setString(label);
+			}
+		}
+	std::cout<<"After resizing "<<(numDialogs+1)/2<<" dialogs:"<<std::endl;
+	numMismatches+=testRays(manager,rays,buttonBoxes);
+	
+	/* Clean up: */
+	while(manager.beginPrimaryWidgets()!=manager.endPrimaryWidgets())
+		{
+		GLMotif::Widget* dialog=*manager.beginPrimaryWidgets();
+		manager.popdownWidget(dialog);
+		delete dialog;
+		}
+	delete font;
+	
+	return numMismatches==0?0:1;
+	}
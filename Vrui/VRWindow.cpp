@@ -77,9 +77,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <GL/GLTransformationWrappers.h>
 #include <Images/Config.h>
 #include <Images/BaseImage.h>
-#include <Images/RGBImage.h>
 #include <Images/ReadImageFile.h>
-#include <Images/WriteImageFile.h>
 #include <GLMotif/WidgetManager.h>
 #include <Vrui/Vrui.h>
 #include <Vrui/InputDeviceManager.h>
@@ -94,6 +92,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/Internal/LensCorrector.h>
 #include <Vrui/Internal/ToolKillZone.h>
 #include <Vrui/Internal/MovieSaver.h>
+#include <Vrui/Internal/FrameReader.h>
 #include <Vrui/Internal/Vrui.h>
 #include <Vrui/Internal/Config.h>
 #if VRUI_INTERNAL_CONFIG_HAVE_XRANDR
@@ -703,7 +702,8 @@ VRWindow::VRWindow(GLContext* sContext,const OutputConfiguration& sOutputConfigu
 	 trackToolKillZone(false),
 	 dirty(true),resizeViewport(true),enabled(true),
 	 saveScreenshot(false),
-	 movieSaver(0),movieSaverRecording(configFileSection.retrieveValue<bool>("./saveMovieAutostart",false))
+	 movieSaver(0),movieSaverRecording(configFileSection.retrieveValue<bool>("./saveMovieAutostart",false)),
+	 frameReader(0)
 	{
 	/* Update the X window's event mask: */
 	{
@@ -1335,6 +1335,9 @@ VRWindow::VRWindow(GLContext* sContext,const OutputConfiguration& sOutputConfigu
 		Misc::formattedLogNote("VRWindow: Movie recording enabled; press %s to start recording",configFileSection.retrieveString("./pauseMovieSaverKey","Super+Pause").c_str());
 		}
 	
+	/* Create a helper to read back window contents, asynchronously through a ring of pixel buffers unless disabled: */
+	frameReader=new FrameReader(configFileSection.retrieveValue<unsigned int>("./numReadbackBuffers",3));
+	
 	#if SAVE_MOUSEMOVEMENTS
 	/* Open a file to save mouse movements: */
 	std::string mouseMovementsFileName=configFileSection.retrieveString("./saveMouseEventsFileName","");
@@ -1471,6 +1474,16 @@ void VRWindow::deinit(void)
 		}
 	delete lensCorrector;
 	delete showFpsFont;
+	
+	if(frameReader!=0)
+		{
+		/* Deliver any pending frames and report readback performance: */
+		frameReader->flush();
+		if(frameReader->getNumFrames()>0)
+			Misc::formattedLogNote("VRWindow: Read back %u frames %s; %.3f ms blocked and %.1f ms latency per frame",frameReader->getNumFrames(),frameReader->isAsync()?"asynchronously":"synchronously",frameReader->getMeanStallTime()*1000.0,frameReader->getMeanLatency()*1000.0);
+		delete frameReader;
+		frameReader=0;
+		}
 	}
 
 void VRWindow::updateViewerState(Viewer* viewer)
@@ -2478,65 +2491,46 @@ void VRWindow::draw(void)
 	/* Check for OpenGL errors: */
 	glPrintError();
 	
-	/* Take a screen shot if requested: */
-	if(saveScreenshot)
+	/* Read back the window's contents if a screen shot or a movie frame was requested: */
+	if(saveScreenshot||movieSaverRecording)
 		{
-		/* Create an RGB image of the same size as the window: */
-		Images::RGBImage image(getWindowWidth(),getWindowHeight());
-		
-		/* Read the window contents into an RGB image: */
-		image.glReadPixels(0,0);
-		
-		/* Save the image buffer to the given image file: */
-		Images::writeImageFile(image,screenshotImageFileName.c_str());
-		
-		#if SAVE_SCREENSHOT_PROJECTION
-		
-		/* Temporarily load the navigation-space modelview matrix: */
-		glMatrixMode(GL_MODELVIEW);
-		glPushMatrix();
-		glLoadIdentity();
-		glMultMatrix(displayState->mvnGl);
-		
-		/* Query the current projection and modelview matrices: */
-		GLdouble proj[16],mv[16];
-		glGetDoublev(GL_PROJECTION_MATRIX,proj);
-		glGetDoublev(GL_MODELVIEW_MATRIX,mv);
-		
-		glPopMatrix();
-		
-		/* Write the matrices to a projection file: */
-		{
-		IO::FilePtr projFile(IO::openFile((screenshotImageFileName+".proj").c_str(),IO::File::WriteOnly));
-		projFile->setEndianness(IO::File::LittleEndian);
-		projFile->write(proj,16);
-		projFile->write(mv,16);
-		}
-		
-		#endif
+		/* Start reading the window contents; they will be delivered to their destinations once the read completes: */
+		frameReader->readFrame(getWindowWidth(),getWindowHeight(),movieSaverRecording?movieSaver:0,saveScreenshot?screenshotImageFileName.c_str():0);
 		
-		saveScreenshot=false;
+		if(saveScreenshot)
+			{
+			#if SAVE_SCREENSHOT_PROJECTION
+			
+			/* Temporarily load the navigation-space modelview matrix: */
+			glMatrixMode(GL_MODELVIEW);
+			glPushMatrix();
+			glLoadIdentity();
+			glMultMatrix(displayState->mvnGl);
+			
+			/* Query the current projection and modelview matrices: */
+			GLdouble proj[16],mv[16];
+			glGetDoublev(GL_PROJECTION_MATRIX,proj);
+			glGetDoublev(GL_MODELVIEW_MATRIX,mv);
+			
+			glPopMatrix();
+			
+			/* Write the matrices to a projection file: */
+			{
+			IO::FilePtr projFile(IO::openFile((screenshotImageFileName+".proj").c_str(),IO::File::WriteOnly));
+			projFile->setEndianness(IO::File::LittleEndian);
+			projFile->write(proj,16);
+			projFile->write(mv,16);
+			}
+			
+			#endif
+			
+			saveScreenshot=false;
+			}
 		}
-	
-	/* Check if the window is currently saving a movie: */
-	if(movieSaverRecording)
+	else if(frameReader->hasPendingFrames())
 		{
-		/* Get a fresh frame buffer: */
-		MovieSaver::FrameBuffer& frameBuffer=movieSaver->startNewFrame();
-		
-		/* Update the frame buffer's size and prepare it for writing: */
-		frameBuffer.setFrameSize(getWindowWidth(),getWindowHeight());
-		frameBuffer.prepareWrite();
-		
-		/* Read the window contents into the movie saver's frame buffer: */
-		glPixelStorei(GL_PACK_ALIGNMENT,1);
-		glPixelStorei(GL_PACK_SKIP_PIXELS,0);
-		glPixelStorei(GL_PACK_ROW_LENGTH,0);
-		glPixelStorei(GL_PACK_SKIP_ROWS,0);
-		glReadPixels(0,0,getWindowWidth(),getWindowHeight(),GL_RGB,GL_UNSIGNED_BYTE,frameBuffer.getBuffer());
-		
-		/* Post the new frame: */
-		movieSaver->postNewFrame();
+		/* Deliver frames that were still being read when movie recording was paused: */
+		frameReader->flush();
 		}
 	
 	/* Window is now up-to-date: */
@@ -59,6 +59,7 @@ class VruiState;
 namespace Vrui {
 struct VruiWindowGroup;
 class LensCorrector;
+class FrameReader;
 }
 
 namespace Vrui {
@@ -163,6 +164,7 @@ class VRWindow:public GLWindow
 	std::string screenshotImageFileName; // Name of the image file into which to save the next screen shot
 	MovieSaver* movieSaver; // Pointer to a movie saver object if the window is supposed to write contents to a movie
 	bool movieSaverRecording; // Flag whether the movie saver is currently recording
+	FrameReader* frameReader; // Helper object to read back the window's contents for screen shots and movie frames
 	Time lastFrame; // Time at which the last frame was exposed in front-buffer rendering mode
 	
 	/* Private methods: */
@@ -243,6 +245,10 @@ class VRWindow:public GLWindow
 		{
 		return dirty;
 		}
+	const MovieSaver* getMovieSaver(void) const // Returns the movie saver writing this window's contents, or null if the window does not save a movie
+		{
+		return movieSaver;
+		}
 	void requestScreenshot(const char* sScreenshotImageFileName); // Asks the window to save its contents to the given image file on the next render pass
 	void draw(void); // Redraws the window's contents
 	void swapBuffers(void); // Overridden method from GLWindow
@@ -23,6 +23,8 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/VisletManager.h>
 
 #include <vector>
+#include <stdexcept>
+#include <Misc/MessageLogger.h>
 #include <Misc/ConfigurationFile.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/CompoundValueCoders.h>
@@ -31,6 +33,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <GLMotif/ToggleButton.h>
 #include <Vrui/Vrui.h>
 #include <Vrui/Internal/Config.h>
+#include <Vrui/Internal/PluginPreloader.h>
 
 namespace Vrui {
 
@@ -75,10 +78,17 @@ void VisletManager::visletMenuToggleButtonCallback(GLMotif::ToggleButton::ValueC
 		}
 	}
 
+void VisletManager::initializePreloadedClass(const char* className)
+	{
+	/* Load the vislet class, whose DSO is already in memory: */
+	loadClass(className);
+	}
+
 VisletManager::VisletManager(const Misc::ConfigurationFileSection& sConfigFileSection)
 	:Plugins::FactoryManager<VisletFactory>(sConfigFileSection.retrieveString("./visletDsoNameTemplate",VRUI_INTERNAL_CONFIG_VISLETDIR "/" VRUI_INTERNAL_CONFIG_VISLETNAMETEMPLATE)),
 	 configFileSection(sConfigFileSection),
-	 visletMenu(0)
+	 visletMenu(0),
+	 preloader(0)
 	{
 	typedef std::vector<std::string> StringList;
 	
@@ -89,10 +99,34 @@ VisletManager::VisletManager(const Misc::ConfigurationFileSection& sConfigFileSe
 		/* Add the path: */
 		getDsoLocator().addPath(*vspIt);
 		}
+	
+	/* Start loading the DSOs of vislet classes in the background: */
+	StringList preloadVisletClassNames=configFileSection.retrieveValue<StringList>("./preloadVisletClassNames",StringList());
+	if(!preloadVisletClassNames.empty())
+		{
+		unsigned int preloadClassesPerFrame=configFileSection.retrieveValue<unsigned int>("./preloadClassesPerFrame",1U);
+		preloader=new PluginPreloader("VisletManager",Misc::createFunctionCall(this,&VisletManager::initializePreloadedClass),preloadClassesPerFrame);
+		for(StringList::const_iterator pvcnIt=preloadVisletClassNames.begin();pvcnIt!=preloadVisletClassNames.end();++pvcnIt)
+			{
+			try
+				{
+				preloader->addClass(pvcnIt->c_str(),locateDso(pvcnIt->c_str()));
+				}
+			catch(const std::runtime_error& err)
+				{
+				/* Print a warning and carry on: */
+				Misc::formattedConsoleWarning("Vrui::VisletManager: Not preloading vislet class %s due to exception %s",pvcnIt->c_str(),err.what());
+				}
+			}
+		preloader->start();
+		}
 	}
 
 VisletManager::~VisletManager(void)
 	{
+	/* Stop preloading vislet classes: */
+	delete preloader;
+	
 	/* Destroy all loaded vislets: */
 	for(VisletList::iterator vIt=vislets.begin();vIt!=vislets.end();++vIt)
 		{
@@ -170,6 +204,17 @@ void VisletManager::updateVisletMenu(const Vislet* vislet)
 
 void VisletManager::frame(void)
 	{
+	/* Initialize the next slice of preloaded vislet classes; cluster nodes must stay in lock-step: */
+	if(preloader!=0)
+		{
+		preloader->initializeSlice(getClusterMultiplexer()!=0);
+		if(preloader->isFinished())
+			{
+			delete preloader;
+			preloader=0;
+			}
+		}
+	
 	/* Call all vislet's frame functions: */
 	for(VisletList::iterator vIt=vislets.begin();vIt!=vislets.end();++vIt)
 		if((*vIt)->isActive())
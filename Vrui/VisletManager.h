@@ -35,6 +35,9 @@ namespace GLMotif {
 class PopupMenu;
 }
 class ALContextData;
+namespace Vrui {
+class PluginPreloader;
+}
 
 namespace Vrui {
 
@@ -48,9 +51,11 @@ class VisletManager:public Plugins::FactoryManager<VisletFactory>
 	Misc::ConfigurationFileSection configFileSection; // The vislet manager's configuration file section - valid throughout the manager's entire lifetime
 	VisletList vislets; // List of all loaded vislets
 	GLMotif::PopupMenu* visletMenu; // Submenu to activate or deactivate individual vislets
+	PluginPreloader* preloader; // Helper to load vislet class DSOs in the background and initialize their classes during frame; null if nothing is preloaded
 	
 	/* Private methods: */
 	void visletMenuToggleButtonCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData);
+	void initializePreloadedClass(const char* className); // Initializes a vislet class whose DSO was preloaded in the background
 	
 	/* Constructors and destructors: */
 	public:
@@ -56,6 +56,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/Lightsource.h>
 #include <Vrui/Viewer.h>
 #include <Vrui/VRWindow.h>
+#include <Vrui/Internal/MovieSaver.h>
 #include <Vrui/InputGraphManager.h>
 #include <Vrui/VisletManager.h>
 
@@ -687,6 +688,36 @@ void Filming::saveSettingsCallback(GLMotif::FileSelectionDialog::OKCallbackData*
 		}
 	}
 
+void Filming::updateMovieStatus(void)
+	{
+	/* Accumulate the statistics of the movie savers of all windows on this node: */
+	bool haveMovieSaver=false;
+	MovieSaver::Statistics total;
+	for(int windowIndex=0;windowIndex<getNumWindows();++windowIndex)
+		if(getWindow(windowIndex)!=0&&getWindow(windowIndex)->getMovieSaver()!=0)
+			{
+			MovieSaver::Statistics stats=getWindow(windowIndex)->getMovieSaver()->getStatistics();
+			total.numWrittenFrames+=stats.numWrittenFrames;
+			total.numSkippedFrames+=stats.numSkippedFrames;
+			total.numDroppedFrames+=stats.numDroppedFrames;
+			total.queueSize+=stats.queueSize;
+			total.maxQueueSize+=stats.maxQueueSize;
+			total.encodeTimeSum+=stats.encodeTimeSum;
+			if(total.maxEncodeTime<stats.maxEncodeTime)
+				total.maxEncodeTime=stats.maxEncodeTime;
+			haveMovieSaver=true;
+			}
+	
+	/* Update the status label if the status changed: */
+	std::string status;
+	if(haveMovieSaver)
+		status=Misc::stringPrintf("%u written, %u skipped, %u dropped, queue %u/%u, %.1f ms/frame",total.numWrittenFrames,total.numSkippedFrames,total.numDroppedFrames,total.queueSize,total.maxQueueSize,total.getMeanEncodeTime()*1000.0);
+	else
+		status="No movie recording";
+	if(status!=movieStatusLabel->getString())
+		movieStatusLabel->setString(status.c_str());
+	}
+
 void Filming::buildFilmingControls(void)
 	{
 	/* Build the graphical user interface: */
@@ -828,6 +859,12 @@ void Filming::buildFilmingControls(void)
 	
 	ioBox->manageChild();
 	
+	/* Create a label to show the state of the windows' movie savers: */
+	new GLMotif::Label("MovieStatusTitle",filmingControls,"Movie Status");
+	movieStatusLabel=new GLMotif::Label("MovieStatusLabel",filmingControls,"");
+	movieStatusLabel->setHAlignment(GLFont::Left);
+	updateMovieStatus();
+	
 	filmingControls->manageChild();
 	}
 
@@ -855,7 +892,7 @@ Filming::Filming(int numArguments,const char* const arguments[])
 	 drawGrid(false),gridDragger(0),
 	 drawDevices(false),
 	 autoActivate(false),
-	 dialogWindow(0),showDialogWindowButton(0)
+	 dialogWindow(0),movieStatusLabel(0),showDialogWindowButton(0)
 	{
 	/* Parse the command line: */
 	for(int i=0;i<numArguments;++i)
@@ -998,6 +1035,10 @@ void Filming::frame(void)
 	{
 	/* Update the filming viewer: */
 	viewer->update();
+	
+	/* Update the movie status display: */
+	if(movieStatusLabel!=0)
+		updateMovieStatus();
 	}
 
 void Filming::display(GLContextData& contextData) const
@@ -45,6 +45,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 namespace GLMotif {
 class PopupWindow;
 class RowColumn;
+class Label;
 class Button;
 class FileSelectionHelper;
 }
@@ -204,6 +205,7 @@ class Filming:public Vrui::Vislet
 	GLMotif::HSVColorSelector* backgroundColorSelector; // Color selector to change the background color
 	GLMotif::ToggleButton* drawGridToggle;
 	GLMotif::ToggleButton* drawDevicesToggle;
+	GLMotif::Label* movieStatusLabel; // Label showing the state of the movie savers of all filming windows
 	GLMotif::Button* showDialogWindowButton; // Button to show the filming controls dialog window
 	
 	/* Private methods: */
@@ -219,6 +221,7 @@ class Filming:public Vrui::Vislet
 	void loadSettings(const char* settingsFileName);
 	void loadSettingsCallback(GLMotif::FileSelectionDialog::OKCallbackData* cbData);
 	void saveSettingsCallback(GLMotif::FileSelectionDialog::OKCallbackData* cbData);
+	void updateMovieStatus(void); // Updates the movie status display from the movie savers of all windows
 	void buildFilmingControls(void); // Creates the filming controls dialog window
 	void showDialogWindowCallback(Misc::CallbackData* cbData);
 	void toolCreationCallback(ToolManager::ToolCreationCallbackData* cbData); // Callback called when a new tool is created